@@ -116,58 +116,66 @@ gint at_util_call_compare(gconstpointer a, gconstpointer b)
 	return 0;
 }
 
+struct clcc_line {
+	int id;
+	int dir;
+	int status;
+	int type;
+	int mpty;
+	char number[OFONO_MAX_PHONE_NUMBER_LENGTH + 1];
+	int number_type;
+};
+
+/* +CLCC: <id>,<dir>,<stat>,<mode>,<mpty>[,<number>,<type>[,...]] */
+static const GAtField clcc_fields[] = {
+	G_AT_FIELD(NUMBER, 0, struct clcc_line, id),
+	G_AT_FIELD(NUMBER, 0, struct clcc_line, dir),
+	G_AT_FIELD(NUMBER, 0, struct clcc_line, status),
+	G_AT_FIELD(NUMBER, 0, struct clcc_line, type),
+	G_AT_FIELD(NUMBER, 0, struct clcc_line, mpty),
+	G_AT_FIELD(STRING, G_AT_FIELD_OPTIONAL, struct clcc_line, number),
+	G_AT_FIELD(NUMBER, G_AT_FIELD_OPTIONAL, struct clcc_line, number_type),
+};
+
+static const GAtGrammar clcc_grammar = G_AT_GRAMMAR(clcc_fields);
+
+static gboolean clcc_next(GAtResultIter *iter, struct clcc_line *line)
+{
+	line->number[0] = '\0';
+	line->number_type = 129;
+
+	return g_at_result_iter_parse(iter, "+CLCC:", &clcc_grammar, line) >= 0;
+}
+
 GSList *at_util_parse_clcc(GAtResult *result, unsigned int *ret_mpty_ids)
 {
 	GAtResultIter iter;
 	GSList *l = NULL;
-	int id, dir, status, type;
-	ofono_bool_t mpty;
+	struct clcc_line line;
 	struct ofono_call *call;
 	unsigned int mpty_ids = 0;
 
 	g_at_result_iter_init(&iter, result);
 
-	while (g_at_result_iter_next(&iter, "+CLCC:")) {
-		const char *str = "";
-		int number_type = 129;
-
-		if (!g_at_result_iter_next_number(&iter, &id))
-			continue;
-
-		if (id == 0)
+	while (clcc_next(&iter, &line)) {
+		if (line.id == 0)
 			continue;
 
-		if (!g_at_result_iter_next_number(&iter, &dir))
+		if (line.status > 5)
 			continue;
 
-		if (!g_at_result_iter_next_number(&iter, &status))
-			continue;
-
-		if (status > 5)
-			continue;
-
-		if (!g_at_result_iter_next_number(&iter, &type))
-			continue;
-
-		if (!g_at_result_iter_next_number(&iter, &mpty))
-			continue;
-
-		if (g_at_result_iter_next_string(&iter, &str))
-			g_at_result_iter_next_number(&iter, &number_type);
-
 		call = g_try_new(struct ofono_call, 1);
 		if (call == NULL)
 			break;
 
 		ofono_call_init(call);
 
-		call->id = id;
-		call->direction = dir;
-		call->status = status;
-		call->type = type;
-		strncpy(call->phone_number.number, str,
-				OFONO_MAX_PHONE_NUMBER_LENGTH);
-		call->phone_number.type = number_type;
+		call->id = line.id;
+		call->direction = line.dir;
+		call->status = line.status;
+		call->type = line.type;
+		strcpy(call->phone_number.number, line.number);
+		call->phone_number.type = line.number_type;
 
 		if (strlen(call->phone_number.number) > 0)
 			call->clip_validity = 0;
@@ -176,8 +184,8 @@ GSList *at_util_parse_clcc(GAtResult *result, unsigned int *ret_mpty_ids)
 
 		l = g_slist_insert_sorted(l, call, at_util_call_compare);
 
-		if (mpty)
-			mpty_ids |= 1 << id;
+		if (line.mpty)
+			mpty_ids |= 1 << line.id;
 	}
 
 	if (ret_mpty_ids)
@@ -186,71 +194,127 @@ GSList *at_util_parse_clcc(GAtResult *result, unsigned int *ret_mpty_ids)
 	return l;
 }
 
+struct reg_line {
+	int mode;
+	int status;
+	int lac;
+	int ci;
+	int tech;
+};
+
+/* +CREG: [<n>,]<stat>[,<lac>,<ci>[,<act>]], also +CGREG and +CEREG */
+static const GAtField reg_fields[] = {
+	G_AT_FIELD(NUMBER, 0, struct reg_line, mode),
+	G_AT_FIELD(NUMBER, 0, struct reg_line, status),
+	G_AT_FIELD(HEX, G_AT_FIELD_OPTIONAL, struct reg_line, lac),
+	G_AT_FIELD(HEX, G_AT_FIELD_OPTIONAL, struct reg_line, ci),
+	G_AT_FIELD(NUMBER, G_AT_FIELD_OPTIONAL, struct reg_line, tech),
+};
+
+static const GAtGrammar reg_grammar = G_AT_GRAMMAR(reg_fields);
+
+static const GAtGrammar reg_unsolicited_grammar = {
+	.num_fields = G_N_ELEMENTS(reg_fields) - 1,
+	.fields = reg_fields + 1,
+};
+
+/* These report <stat>, <lac> and <ci> unquoted */
+static gboolean reg_unquoted(unsigned int vendor)
+{
+	switch (vendor) {
+	case OFONO_VENDOR_GOBI:
+	case OFONO_VENDOR_ZTE:
+	case OFONO_VENDOR_HUAWEI:
+	case OFONO_VENDOR_NOVATEL:
+	case OFONO_VENDOR_SPEEDUP:
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static gboolean parse_reg_line(GAtResult *result, const char *prefix,
+				const GAtGrammar *grammar,
+				struct reg_line *line)
+{
+	GAtResultIter iter;
+
+	line->lac = -1;
+	line->ci = -1;
+	line->tech = -1;
+
+	g_at_result_iter_init(&iter, result);
+
+	if (g_at_result_iter_parse(&iter, prefix, grammar, line) < 0)
+		return FALSE;
+
+	/* Some firmware will report bogus lac/ci when unregistered */
+	if (line->status != 1 && line->status != 5) {
+		line->lac = -1;
+		line->ci = -1;
+		line->tech = -1;
+	}
+
+	return TRUE;
+}
+
 gboolean at_util_parse_reg_unsolicited(GAtResult *result, const char *prefix,
 					int *status,
 					int *lac, int *ci, int *tech,
 					unsigned int vendor)
 {
 	GAtResultIter iter;
-	int s;
-	int l = -1, c = -1, t = -1;
+	struct reg_line line;
 	const char *str;
 
+	if (!reg_unquoted(vendor)) {
+		if (!parse_reg_line(result, prefix, &reg_unsolicited_grammar,
+					&line))
+			return FALSE;
+
+		goto out;
+	}
+
+	line.lac = -1;
+	line.ci = -1;
+	line.tech = -1;
+
 	g_at_result_iter_init(&iter, result);
 
 	if (g_at_result_iter_next(&iter, prefix) == FALSE)
 		return FALSE;
 
-	if (g_at_result_iter_next_number(&iter, &s) == FALSE)
+	if (g_at_result_iter_next_number(&iter, &line.status) == FALSE)
 		return FALSE;
 
 	/* Some firmware will report bogus lac/ci when unregistered */
-	if (s != 1 && s != 5)
+	if (line.status != 1 && line.status != 5)
 		goto out;
 
-	switch (vendor) {
-	case OFONO_VENDOR_GOBI:
-	case OFONO_VENDOR_ZTE:
-	case OFONO_VENDOR_HUAWEI:
-	case OFONO_VENDOR_NOVATEL:
-	case OFONO_VENDOR_SPEEDUP:
-		if (g_at_result_iter_next_unquoted_string(&iter, &str) == TRUE)
-			l = strtol(str, NULL, 16);
-		else
-			goto out;
-
-		if (g_at_result_iter_next_unquoted_string(&iter, &str) == TRUE)
-			c = strtol(str, NULL, 16);
-		else
-			goto out;
-
-		break;
-	default:
-		if (g_at_result_iter_next_string(&iter, &str) == TRUE)
-			l = strtol(str, NULL, 16);
-		else
-			goto out;
+	if (g_at_result_iter_next_unquoted_string(&iter, &str) == TRUE)
+		line.lac = strtol(str, NULL, 16);
+	else
+		goto out;
 
-		if (g_at_result_iter_next_string(&iter, &str) == TRUE)
-			c = strtol(str, NULL, 16);
-		else
-			goto out;
-	}
+	if (g_at_result_iter_next_unquoted_string(&iter, &str) == TRUE)
+		line.ci = strtol(str, NULL, 16);
+	else
+		goto out;
 
-	g_at_result_iter_next_number(&iter, &t);
+	g_at_result_iter_next_number(&iter, &line.tech);
 
 out:
 	if (status)
-		*status = s;
+		*status = line.status;
 
 	if (lac)
-		*lac = l;
+		*lac = line.lac;
 
 	if (ci)
-		*ci = c;
+		*ci = line.ci;
 
 	if (tech)
-		*tech = t;
+		*tech = line.tech;
 
 	return TRUE;
 }
@@ -261,97 +325,82 @@ gboolean at_util_parse_reg(GAtResult *result, const char *prefix,
 				unsigned int vendor)
 {
 	GAtResultIter iter;
-	int m, s;
-	int l = -1, c = -1, t = -1;
+	struct reg_line line;
 	const char *str;
 
+	if (!reg_unquoted(vendor)) {
+		if (!parse_reg_line(result, prefix, &reg_grammar, &line))
+			return FALSE;
+
+		goto out;
+	}
+
 	g_at_result_iter_init(&iter, result);
 
 	while (g_at_result_iter_next(&iter, prefix)) {
 		gboolean r;
 
-		g_at_result_iter_next_number(&iter, &m);
+		line.lac = -1;
+		line.ci = -1;
+		line.tech = -1;
+
+		g_at_result_iter_next_number(&iter, &line.mode);
 
 		/* Sometimes we get an unsolicited CREG/CGREG here, skip it */
-		switch (vendor) {
-		case OFONO_VENDOR_ZTE:
-		case OFONO_VENDOR_HUAWEI:
-		case OFONO_VENDOR_NOVATEL:
-		case OFONO_VENDOR_SPEEDUP:
+		if (vendor == OFONO_VENDOR_GOBI) {
+			if (!g_at_result_iter_next_number(&iter, &line.status))
+				continue;
+		} else {
 			r = g_at_result_iter_next_unquoted_string(&iter, &str);
 
 			if (r == FALSE || strlen(str) != 1)
 				continue;
 
-			s = strtol(str, NULL, 10);
-
-			break;
-		default:
-			if (g_at_result_iter_next_number(&iter, &s) == FALSE)
-				continue;
-
-			break;
+			line.status = strtol(str, NULL, 10);
 		}
 
 		/* Some firmware will report bogus lac/ci when unregistered */
-		if (s != 1 && s != 5)
+		if (line.status != 1 && line.status != 5)
 			goto out;
 
-		switch (vendor) {
-		case OFONO_VENDOR_GOBI:
-		case OFONO_VENDOR_ZTE:
-		case OFONO_VENDOR_HUAWEI:
-		case OFONO_VENDOR_NOVATEL:
-		case OFONO_VENDOR_SPEEDUP:
-			r = g_at_result_iter_next_unquoted_string(&iter, &str);
+		r = g_at_result_iter_next_unquoted_string(&iter, &str);
 
-			if (r == TRUE)
-				l = strtol(str, NULL, 16);
-			else
-				goto out;
+		if (r == TRUE)
+			line.lac = strtol(str, NULL, 16);
+		else
+			goto out;
 
-			r = g_at_result_iter_next_unquoted_string(&iter, &str);
+		r = g_at_result_iter_next_unquoted_string(&iter, &str);
 
-			if (r == TRUE)
-				c = strtol(str, NULL, 16);
-			else
-				goto out;
+		if (r == TRUE)
+			line.ci = strtol(str, NULL, 16);
+		else
+			goto out;
 
-			break;
-		default:
-			if (g_at_result_iter_next_string(&iter, &str) == TRUE)
-				l = strtol(str, NULL, 16);
-			else
-				goto out;
-
-			if (g_at_result_iter_next_string(&iter, &str) == TRUE)
-				c = strtol(str, NULL, 16);
-			else
-				goto out;
-		}
+		g_at_result_iter_next_number(&iter, &line.tech);
 
-		g_at_result_iter_next_number(&iter, &t);
+		goto out;
+	}
 
-out:
-		if (mode)
-			*mode = m;
+	return FALSE;
 
-		if (status)
-			*status = s;
+out:
+	if (mode)
+		*mode = line.mode;
 
-		if (lac)
-			*lac = l;
+	if (status)
+		*status = line.status;
 
-		if (ci)
-			*ci = c;
+	if (lac)
+		*lac = line.lac;
 
-		if (tech)
-			*tech = t;
+	if (ci)
+		*ci = line.ci;
 
-		return TRUE;
-	}
+	if (tech)
+		*tech = line.tech;
 
-	return FALSE;
+	return TRUE;
 }
 
 gboolean at_util_parse_sms_index_delivery(GAtResult *result, const char *prefix,
@@ -34,6 +34,7 @@
 #include <ofono/log.h>
 #include <ofono/modem.h>
 #include <ofono/netreg.h>
+#include <ofono/devmon.h>
 
 #include "gatchat.h"
 #include "gatresult.h"
@@ -63,6 +64,9 @@ struct netreg_data {
 	struct ofono_network_time time;
 	guint nitz_timeout;
 	unsigned int vendor;
+	int creg_mode;
+	char cmer[24]; /* Set if indicator events were enabled */
+	unsigned int muted;
 };
 
 struct tech_query {
@@ -614,6 +618,8 @@ static void csq_notify(GAtResult *result, gpointer user_data)
 	int strength;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+CSQ:"))
@@ -632,6 +638,8 @@ static void calypso_csq_notify(GAtResult *result, gpointer user_data)
 	int strength;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "%CSQ:"))
@@ -650,6 +658,8 @@ static void option_osigq_notify(GAtResult *result, gpointer user_data)
 	int strength;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "_OSIGQ:"))
@@ -687,6 +697,8 @@ static void ifx_xreg_notify(GAtResult *result, gpointer user_data)
 	const char *band;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+XREG:"))
@@ -733,6 +745,8 @@ static void ifx_xciev_notify(GAtResult *result, gpointer user_data)
 	int ind;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+XCIEV:"))
@@ -757,6 +771,8 @@ static void ifx_xcsq_notify(GAtResult *result, gpointer user_data)
 	int rssi, ber, strength;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+XCSQ:"))
@@ -785,6 +801,8 @@ static void ciev_notify(GAtResult *result, gpointer user_data)
 	int strength, ind;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+CIEV:"))
@@ -816,6 +834,8 @@ static void telit_ciev_notify(GAtResult *result, gpointer user_data)
 	int strength;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+CIEV:"))
@@ -847,6 +867,8 @@ static void cinterion_ciev_notify(GAtResult *result, gpointer user_data)
 	int strength;
 	GAtResultIter iter;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "+CIEV:"))
@@ -1048,6 +1070,8 @@ static void huawei_rssi_notify(GAtResult *result, gpointer user_data)
 	GAtResultIter iter;
 	int strength;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "^RSSI:"))
@@ -1067,6 +1091,8 @@ static void huawei_mode_notify(GAtResult *result, gpointer user_data)
 	GAtResultIter iter;
 	int mode, submode;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "^MODE:"))
@@ -1095,6 +1121,8 @@ static void huawei_hcsq_notify(GAtResult *result, gpointer user_data)
 	GAtResultIter iter;
 	const char *mode;
 
+	ofono_devmon_indication_notify();
+
 	g_at_result_iter_init(&iter, result);
 
 	if (!g_at_result_iter_next(&iter, "^HCSQ:"))
@@ -1480,6 +1508,8 @@ static void creg_notify(GAtResult *result, gpointer user_data)
 	struct netreg_data *nd = ofono_netreg_get_data(netreg);
 	struct tech_query *tq;
 
+	ofono_devmon_indication_notify();
+
 	if (at_util_parse_reg_unsolicited(result, "+CREG:", &status,
 				&lac, &ci, &tech, nd->vendor) == FALSE)
 		return;
@@ -1701,6 +1731,12 @@ static void at_cmer_query_cb(ofono_bool_t ok, GAtResult *result,
 	if (build_cmer_string(buf, cmer_opts, nd) == FALSE)
 		goto error;
 
+	g_strlcpy(nd->cmer, buf, sizeof(nd->cmer));
+
+	/* Muted while the query was pending, see at_netreg_mute_indications */
+	if (nd->muted & OFONO_DEVMON_IND_SIGNAL_STRENGTH)
+		buf[strlen(buf) - 1] = '0';
+
 	g_at_chat_send(nd->chat, buf, cmer_prefix,
 			at_cmer_set_cb, netreg, NULL);
 
@@ -2051,12 +2087,16 @@ retry:
 	g_at_result_iter_close_list(&iter);
 
 	if (creg2) {
-		g_at_chat_send(nd->chat, "AT+CREG=2", none_prefix,
-				at_creg_set_cb, netreg, NULL);
+		nd->creg_mode = 2;
+		g_at_chat_send(nd->chat,
+				(nd->muted & OFONO_DEVMON_IND_LOCATION) ?
+				"AT+CREG=1" : "AT+CREG=2",
+				none_prefix, at_creg_set_cb, netreg, NULL);
 		return;
 	}
 
 	if (creg1) {
+		nd->creg_mode = 1;
 		g_at_chat_send(nd->chat, "AT+CREG=1", none_prefix,
 				at_creg_set_cb, netreg, NULL);
 		return;
@@ -2067,6 +2107,38 @@ error:
 	ofono_netreg_remove(netreg);
 }
 
+static void at_netreg_mute_indications(struct ofono_netreg *netreg,
+						unsigned int muted)
+{
+	struct netreg_data *nd = ofono_netreg_get_data(netreg);
+	unsigned int changed = nd->muted ^ muted;
+
+	nd->muted = muted;
+
+	/* Mode 1 still reports registration changes, without LAC and CI */
+	if ((changed & OFONO_DEVMON_IND_LOCATION) && nd->creg_mode == 2)
+		g_at_chat_send(nd->chat,
+				(muted & OFONO_DEVMON_IND_LOCATION) ?
+				"AT+CREG=1" : "AT+CREG=2",
+				none_prefix, NULL, NULL, NULL);
+
+	/*
+	 * build_cmer_string() puts the indicator event mode last.  Other
+	 * indicators, such as service and roaming, go quiet too but +CREG
+	 * covers those.  Vendor specific signal reports are left alone.
+	 */
+	if ((changed & OFONO_DEVMON_IND_SIGNAL_STRENGTH) && nd->cmer[0]) {
+		char buf[sizeof(nd->cmer)];
+
+		strcpy(buf, nd->cmer);
+
+		if (muted & OFONO_DEVMON_IND_SIGNAL_STRENGTH)
+			buf[strlen(buf) - 1] = '0';
+
+		g_at_chat_send(nd->chat, buf, none_prefix, NULL, NULL, NULL);
+	}
+}
+
 static int at_netreg_probe(struct ofono_netreg *netreg, unsigned int vendor,
 				void *data)
 {
@@ -2117,6 +2189,7 @@ static struct ofono_netreg_driver driver = {
 	.register_auto			= at_register_auto,
 	.register_manual		= at_register_manual,
 	.strength			= at_signal_strength,
+	.mute_indications		= at_netreg_mute_indications,
 };
 
 void at_netreg_init(void)
@@ -33,6 +33,8 @@
 
 #include <ell/ell.h>
 
+#include <ofono/log.h>
+
 #include "mbim.h"
 #include "mbim-message.h"
 #include "mbim-private.h"
@@ -434,6 +436,8 @@ static int receive_header(struct mbim_device *device, int fd)
 
 	l_util_hexdump(true, device->header + device->header_offset, len,
 				device->debug_handler, device->debug_data);
+	ofono_trace_data(device, true, device->header + device->header_offset,
+									len);
 	device->header_offset += len;
 
 	return true;
@@ -494,6 +498,7 @@ static bool command_write_handler(struct l_io *io, void *user_data)
 
 		l_util_hexdump(false, buf, written, device->debug_handler,
 				device->debug_data);
+		ofono_trace_data(device, false, buf, written);
 	} else {
 		/* TODO: Handle fragmented writes */
 		l_util_debug(device->debug_handler, device->debug_data,
@@ -601,6 +606,20 @@ static void dispatch_message(struct mbim_device *device, uint32_t type,
 	}
 }
 
+static void trace_readv(struct mbim_device *device,
+				const struct iovec *iov, uint32_t n_iov,
+				size_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_iov && len > 0; i++) {
+		size_t n = len < iov[i].iov_len ? len : iov[i].iov_len;
+
+		ofono_trace_data(device, true, iov[i].iov_base, n);
+		len -= n;
+	}
+}
+
 static bool command_read_handler(struct l_io *io, void *user_data)
 {
 	struct mbim_device *device = user_data;
@@ -664,6 +683,8 @@ static bool command_read_handler(struct l_io *io, void *user_data)
 		return false;
 	}
 
+	trace_readv(device, iov, n_iov, len);
+
 	device->segment_bytes_remaining -= len;
 
 	if (n_iov == 2) {
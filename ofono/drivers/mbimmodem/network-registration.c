@@ -32,6 +32,7 @@
 #include <ofono/log.h>
 #include <ofono/modem.h>
 #include <ofono/netreg.h>
+#include <ofono/devmon.h>
 
 #include "src/common.h"
 
@@ -39,6 +40,15 @@
 #include "drivers/mbimmodem/mbim-message.h"
 #include "drivers/mbimmodem/mbimmodem.h"
 
+/*
+ * Values for MBIM_SET_SIGNAL_STATE: 0 leaves the choice to the device,
+ * 0xffffffff turns threshold based reports off.  While muted we let the
+ * modem report the signal strength once an hour.
+ */
+#define SIGNAL_STATE_DEFAULT		0
+#define SIGNAL_STATE_DISABLE		0xffffffff
+#define SIGNAL_STATE_MUTED_INTERVAL	3600
+
 struct netreg_data {
 	struct mbim_device *device;
 	struct l_idle *delayed_register;
@@ -78,6 +88,8 @@ static void mbim_register_state_changed(struct mbim_message *message,
 
 	DBG("");
 
+	ofono_devmon_indication_notify();
+
 	if (!mbim_message_get_arguments(message, "uuuu",
 						&nw_error, &register_state,
 						&register_mode,
@@ -319,6 +331,8 @@ static void mbim_signal_state_changed(struct mbim_message *message, void *user)
 
 	DBG("");
 
+	ofono_devmon_indication_notify();
+
 	if (!mbim_message_get_arguments(message, "uuuu",
 						&strength, &error_rate,
 						&signal_strength_interval,
@@ -332,6 +346,32 @@ static void mbim_signal_state_changed(struct mbim_message *message, void *user)
 	ofono_netreg_strength_notify(netreg, convert_signal_strength(strength));
 }
 
+static void mbim_netreg_mute_indications(struct ofono_netreg *netreg,
+						unsigned int muted)
+{
+	struct netreg_data *nd = ofono_netreg_get_data(netreg);
+	struct mbim_message *message;
+
+	message = mbim_message_new(mbim_uuid_basic_connect,
+					MBIM_CID_SIGNAL_STATE,
+					MBIM_COMMAND_TYPE_SET);
+
+	if (muted & OFONO_DEVMON_IND_SIGNAL_STRENGTH)
+		mbim_message_set_arguments(message, "uuu",
+						SIGNAL_STATE_MUTED_INTERVAL,
+						SIGNAL_STATE_DISABLE,
+						SIGNAL_STATE_DISABLE);
+	else
+		mbim_message_set_arguments(message, "uuu",
+						SIGNAL_STATE_DEFAULT,
+						SIGNAL_STATE_DEFAULT,
+						SIGNAL_STATE_DEFAULT);
+
+	if (!mbim_device_send(nd->device, NETREG_GROUP, message,
+				NULL, NULL, NULL))
+		mbim_message_unref(message);
+}
+
 static void delayed_register(struct l_idle *idle, void *user_data)
 {
 	struct ofono_netreg *netreg = user_data;
@@ -403,6 +443,7 @@ static struct ofono_netreg_driver driver = {
 	.current_operator		= mbim_current_operator,
 	.register_auto			= mbim_register_auto,
 	.strength			= mbim_signal_strength,
+	.mute_indications		= mbim_netreg_mute_indications,
 };
 
 void mbim_netreg_init(void)
@@ -37,6 +37,7 @@
 
 #define QMI_NAS_SET_SYSTEM_SELECTION_PREF 51
 #define QMI_NAS_GET_SYSTEM_SELECTION_PREF 52
+#define QMI_NAS_GET_CELL_LOCATION_INFO	67	/* Serving/neighbour cells */
 
 /* Set NAS state report conditions */
 #define QMI_NAS_PARAM_REPORT_SIGNAL_STRENGTH	0x10
@@ -187,4 +188,68 @@ struct qmi_nas_home_network {
 
 #define QMI_NAS_RESULT_SYSTEM_SELECTION_PREF_MODE	0x11
 
+/* Get cell location info */
+#define QMI_NAS_RESULT_GERAN_CELL_INFO		0x10
+struct qmi_nas_geran_cell {
+	uint32_t cell_id;
+	uint8_t plmn[3];
+	uint16_t lac;
+	uint16_t arfcn;
+	uint8_t bsic;
+	uint16_t rx_level;
+} __attribute__((__packed__));
+struct qmi_nas_geran_cell_info {
+	uint32_t cell_id;			/* 0xffffffff if not camped */
+	uint8_t plmn[3];
+	uint16_t lac;
+	uint16_t arfcn;
+	uint8_t bsic;
+	uint32_t timing_advance;
+	uint16_t rx_level;
+	uint8_t count;
+	struct qmi_nas_geran_cell cell[0];
+} __attribute__((__packed__));
+
+#define QMI_NAS_RESULT_UMTS_CELL_INFO		0x11
+struct qmi_nas_umts_cell {
+	uint16_t uarfcn;
+	uint16_t psc;
+	int16_t rscp;				/* dBm */
+	int16_t ecio;
+} __attribute__((__packed__));
+struct qmi_nas_umts_cell_info {
+	uint16_t cell_id;			/* 0xffff if not camped */
+	uint8_t plmn[3];
+	uint16_t lac;
+	uint16_t uarfcn;
+	uint16_t psc;
+	int16_t rscp;
+	int16_t ecio;
+	uint8_t count;
+	struct qmi_nas_umts_cell cell[0];
+} __attribute__((__packed__));
+
+#define QMI_NAS_RESULT_LTE_INTRA_CELL_INFO	0x13
+struct qmi_nas_lte_cell {
+	uint16_t pci;
+	int16_t rsrq;				/* 0.1 dB */
+	int16_t rsrp;				/* 0.1 dBm */
+	int16_t rssi;				/* 0.1 dBm */
+	int16_t srxlev;
+} __attribute__((__packed__));
+struct qmi_nas_lte_cell_info {
+	uint8_t ue_in_idle;
+	uint8_t plmn[3];
+	uint16_t tac;
+	uint32_t global_cell_id;		/* 0xffffffff if not camped */
+	uint16_t earfcn;
+	uint16_t serving_pci;
+	uint8_t resel_priority;
+	uint8_t s_non_intra_search;
+	uint8_t serving_low_threshold;
+	uint8_t s_intra_search;
+	uint8_t count;
+	struct qmi_nas_lte_cell cell[0];
+} __attribute__((__packed__));
+
 int qmi_nas_rat_to_tech(uint8_t rat);
@@ -41,6 +41,7 @@
 
 #include "qmimodem.h"
 #include "src/common.h"
+#include "src/simutil.h"
 
 struct netmon_data {
 	struct qmi_service *nas;
@@ -217,6 +218,245 @@ out:
 	g_free(cbd);
 }
 
+static int clamp_range(int value, int min, int max)
+{
+	if (value < min)
+		return min;
+
+	if (value > max)
+		return max;
+
+	return value;
+}
+
+static void parse_plmn(const uint8_t *plmn, char *mcc, char *mnc)
+{
+	memset(mcc, 0, OFONO_MAX_MCC_LENGTH + 1);
+	memset(mnc, 0, OFONO_MAX_MNC_LENGTH + 1);
+
+	sim_parse_mcc_mnc(plmn, mcc, mnc);
+}
+
+static void notify_geran_cells(struct ofono_netmon *netmon,
+					struct qmi_result *result)
+{
+	const struct qmi_nas_geran_cell_info *info;
+	char mcc[OFONO_MAX_MCC_LENGTH + 1];
+	char mnc[OFONO_MAX_MNC_LENGTH + 1];
+	uint16_t len;
+	int i;
+
+	info = qmi_result_get(result, QMI_NAS_RESULT_GERAN_CELL_INFO, &len);
+	if (!info || len < sizeof(*info) || len < sizeof(*info) +
+					info->count * sizeof(info->cell[0]))
+		return;
+
+	if (GUINT32_FROM_LE(info->cell_id) != 0xffffffff) {
+		parse_plmn(info->plmn, mcc, mnc);
+		ofono_netmon_cell_list_notify(netmon, TRUE,
+				OFONO_NETMON_CELL_TYPE_GSM,
+				OFONO_NETMON_INFO_MCC, mcc,
+				OFONO_NETMON_INFO_MNC, mnc,
+				OFONO_NETMON_INFO_LAC,
+				(int) GUINT16_FROM_LE(info->lac),
+				OFONO_NETMON_INFO_CI,
+				(int) GUINT32_FROM_LE(info->cell_id),
+				OFONO_NETMON_INFO_ARFCN,
+				(int) GUINT16_FROM_LE(info->arfcn),
+				OFONO_NETMON_INFO_BSIC, (int) info->bsic,
+				OFONO_NETMON_INFO_RXLEV, clamp_range(
+					GUINT16_FROM_LE(info->rx_level), 0, 63),
+				OFONO_NETMON_INFO_INVALID);
+	}
+
+	for (i = 0; i < info->count; i++) {
+		const struct qmi_nas_geran_cell *cell = &info->cell[i];
+
+		parse_plmn(cell->plmn, mcc, mnc);
+		ofono_netmon_cell_list_notify(netmon, FALSE,
+				OFONO_NETMON_CELL_TYPE_GSM,
+				OFONO_NETMON_INFO_MCC, mcc,
+				OFONO_NETMON_INFO_MNC, mnc,
+				OFONO_NETMON_INFO_LAC,
+				(int) GUINT16_FROM_LE(cell->lac),
+				OFONO_NETMON_INFO_CI,
+				(int) GUINT32_FROM_LE(cell->cell_id),
+				OFONO_NETMON_INFO_ARFCN,
+				(int) GUINT16_FROM_LE(cell->arfcn),
+				OFONO_NETMON_INFO_BSIC, (int) cell->bsic,
+				OFONO_NETMON_INFO_RXLEV, clamp_range(
+					GUINT16_FROM_LE(cell->rx_level), 0, 63),
+				OFONO_NETMON_INFO_INVALID);
+	}
+}
+
+/* <rscp> in 27.007, Section 8.69: 0 is below -120 dBm, 96 -25 dBm */
+static int rscp_to_index(int16_t rscp)
+{
+	return clamp_range((int16_t) GUINT16_FROM_LE(rscp) + 121, 0, 96);
+}
+
+static void notify_umts_cells(struct ofono_netmon *netmon,
+					struct qmi_result *result)
+{
+	const struct qmi_nas_umts_cell_info *info;
+	char mcc[OFONO_MAX_MCC_LENGTH + 1];
+	char mnc[OFONO_MAX_MNC_LENGTH + 1];
+	uint16_t len;
+	int i;
+
+	info = qmi_result_get(result, QMI_NAS_RESULT_UMTS_CELL_INFO, &len);
+	if (!info || len < sizeof(*info) || len < sizeof(*info) +
+					info->count * sizeof(info->cell[0]))
+		return;
+
+	if (GUINT16_FROM_LE(info->cell_id) != 0xffff) {
+		parse_plmn(info->plmn, mcc, mnc);
+		ofono_netmon_cell_list_notify(netmon, TRUE,
+				OFONO_NETMON_CELL_TYPE_UMTS,
+				OFONO_NETMON_INFO_MCC, mcc,
+				OFONO_NETMON_INFO_MNC, mnc,
+				OFONO_NETMON_INFO_LAC,
+				(int) GUINT16_FROM_LE(info->lac),
+				OFONO_NETMON_INFO_CI,
+				(int) GUINT16_FROM_LE(info->cell_id),
+				OFONO_NETMON_INFO_ARFCN,
+				(int) GUINT16_FROM_LE(info->uarfcn),
+				OFONO_NETMON_INFO_PSC,
+				(int) GUINT16_FROM_LE(info->psc),
+				OFONO_NETMON_INFO_RSCP,
+				rscp_to_index(info->rscp),
+				OFONO_NETMON_INFO_INVALID);
+	}
+
+	for (i = 0; i < info->count; i++) {
+		const struct qmi_nas_umts_cell *cell = &info->cell[i];
+
+		ofono_netmon_cell_list_notify(netmon, FALSE,
+				OFONO_NETMON_CELL_TYPE_UMTS,
+				OFONO_NETMON_INFO_ARFCN,
+				(int) GUINT16_FROM_LE(cell->uarfcn),
+				OFONO_NETMON_INFO_PSC,
+				(int) GUINT16_FROM_LE(cell->psc),
+				OFONO_NETMON_INFO_RSCP,
+				rscp_to_index(cell->rscp),
+				OFONO_NETMON_INFO_INVALID);
+	}
+}
+
+/*
+ * Same scales as in get_rssi_cb, from tenths of a dB: RSRP 0 is below
+ * -140 dBm and 97 -43 dBm, RSRQ 0 is below -19.5 dB and 34 -2.5 dB.
+ */
+static int rsrp_to_index(int16_t rsrp)
+{
+	return clamp_range((int16_t) GUINT16_FROM_LE(rsrp) / 10 + 140, 0, 97);
+}
+
+static int rsrq_to_index(int16_t rsrq)
+{
+	return clamp_range(((int16_t) GUINT16_FROM_LE(rsrq) + 195) / 5, 0, 34);
+}
+
+static void notify_lte_cells(struct ofono_netmon *netmon,
+					struct qmi_result *result)
+{
+	const struct qmi_nas_lte_cell_info *info;
+	char mcc[OFONO_MAX_MCC_LENGTH + 1];
+	char mnc[OFONO_MAX_MNC_LENGTH + 1];
+	gboolean camped;
+	uint16_t len;
+	int i;
+
+	info = qmi_result_get(result, QMI_NAS_RESULT_LTE_INTRA_CELL_INFO,
+									&len);
+	if (!info || len < sizeof(*info) || len < sizeof(*info) +
+					info->count * sizeof(info->cell[0]))
+		return;
+
+	camped = GUINT32_FROM_LE(info->global_cell_id) != 0xffffffff;
+	parse_plmn(info->plmn, mcc, mnc);
+
+	/* The serving cell is measured along with the intra-frequency ones */
+	for (i = 0; i < info->count; i++) {
+		const struct qmi_nas_lte_cell *cell = &info->cell[i];
+
+		if (camped && GUINT16_FROM_LE(cell->pci) ==
+				GUINT16_FROM_LE(info->serving_pci)) {
+			ofono_netmon_cell_list_notify(netmon, TRUE,
+				OFONO_NETMON_CELL_TYPE_LTE,
+				OFONO_NETMON_INFO_MCC, mcc,
+				OFONO_NETMON_INFO_MNC, mnc,
+				OFONO_NETMON_INFO_TAC,
+				(int) GUINT16_FROM_LE(info->tac),
+				OFONO_NETMON_INFO_CI,
+				(int) GUINT32_FROM_LE(info->global_cell_id),
+				OFONO_NETMON_INFO_PCI,
+				(int) GUINT16_FROM_LE(cell->pci),
+				OFONO_NETMON_INFO_EARFCN,
+				(int) GUINT16_FROM_LE(info->earfcn),
+				OFONO_NETMON_INFO_RSRP,
+				rsrp_to_index(cell->rsrp),
+				OFONO_NETMON_INFO_RSRQ,
+				rsrq_to_index(cell->rsrq),
+				OFONO_NETMON_INFO_INVALID);
+			continue;
+		}
+
+		ofono_netmon_cell_list_notify(netmon, FALSE,
+				OFONO_NETMON_CELL_TYPE_LTE,
+				OFONO_NETMON_INFO_PCI,
+				(int) GUINT16_FROM_LE(cell->pci),
+				OFONO_NETMON_INFO_EARFCN,
+				(int) GUINT16_FROM_LE(info->earfcn),
+				OFONO_NETMON_INFO_RSRP,
+				rsrp_to_index(cell->rsrp),
+				OFONO_NETMON_INFO_RSRQ,
+				rsrq_to_index(cell->rsrq),
+				OFONO_NETMON_INFO_INVALID);
+	}
+}
+
+static void get_cell_location_cb(struct qmi_result *result, void *user_data)
+{
+	struct cb_data *cbd = user_data;
+	struct ofono_netmon *netmon = cbd->user;
+	ofono_netmon_cb_t cb = cbd->cb;
+
+	DBG("");
+
+	if (qmi_result_set_error(result, NULL)) {
+		CALLBACK_WITH_FAILURE(cb, cbd->data);
+		return;
+	}
+
+	notify_geran_cells(netmon, result);
+	notify_umts_cells(netmon, result);
+	notify_lte_cells(netmon, result);
+
+	CALLBACK_WITH_SUCCESS(cb, cbd->data);
+}
+
+static void qmi_netmon_request_cell_list(struct ofono_netmon *netmon,
+					ofono_netmon_cb_t cb,
+					void *user_data)
+{
+	struct netmon_data *data = ofono_netmon_get_data(netmon);
+	struct cb_data *cbd = cb_data_new(cb, user_data);
+
+	DBG("");
+
+	cbd->user = netmon;
+
+	if (qmi_service_send(data->nas, QMI_NAS_GET_CELL_LOCATION_INFO, NULL,
+					get_cell_location_cb, cbd, g_free) > 0)
+		return;
+
+	CALLBACK_WITH_FAILURE(cb, cbd->data);
+
+	g_free(cbd);
+}
+
 static void create_nas_cb(struct qmi_service *service, void *user_data)
 {
 	struct ofono_netmon *netmon = user_data;
@@ -273,6 +513,7 @@ static struct ofono_netmon_driver driver = {
 	.probe			= qmi_netmon_probe,
 	.remove			= qmi_netmon_remove,
 	.request_update		= qmi_netmon_request_update,
+	.request_cell_list	= qmi_netmon_request_cell_list,
 };
 
 void qmi_netmon_init(void)
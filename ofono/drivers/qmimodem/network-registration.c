@@ -31,6 +31,7 @@
 #include <ofono/log.h>
 #include <ofono/modem.h>
 #include <ofono/netreg.h>
+#include <ofono/devmon.h>
 
 #include "qmi.h"
 #include "nas.h"
@@ -42,6 +43,8 @@ struct netreg_data {
 	struct qmi_service *nas;
 	struct ofono_network_operator operator;
 	uint8_t current_rat;
+	unsigned int strength_bars;
+	unsigned int muted;
 };
 
 static bool extract_ss_info_time(
@@ -163,6 +166,8 @@ static void ss_info_notify(struct qmi_result *result, void *user_data)
 
 	DBG("");
 
+	ofono_devmon_indication_notify();
+
 	if (extract_ss_info_time(result, &net_time))
 		ofono_netreg_time_notify(netreg, &net_time);
 
@@ -430,6 +435,93 @@ static int dbm_to_strength(int8_t dbm)
 	return -1;
 }
 
+/* Boundaries between the levels of dbm_to_strength() */
+static const int8_t signal_thresholds[] = { -55, -65, -75, -85, -95 };
+
+/* Returns the length of the parameter, which ends after the last dbm */
+static uint16_t fill_signal_thresholds(
+			struct qmi_nas_param_event_signal_strength *ss,
+			unsigned int bars)
+{
+	unsigned int i;
+
+	memset(ss, 0, sizeof(*ss));
+	ss->report = 0x01;
+
+	for (i = 0; i < G_N_ELEMENTS(signal_thresholds); i++) {
+		int8_t dbm = signal_thresholds[i];
+
+		/* Crossing this one wouldn't change the number of bars */
+		if (bars && ofono_netreg_strength_bar(bars,
+						dbm_to_strength(dbm)) ==
+				ofono_netreg_strength_bar(bars,
+						dbm_to_strength(dbm + 1)))
+			continue;
+
+		ss->dbm[ss->count++] = dbm;
+	}
+
+	if (ss->count == 0)
+		ss->report = 0x00;
+
+	return sizeof(*ss) - sizeof(ss->dbm) + ss->count;
+}
+
+static void update_event_report(struct netreg_data *data)
+{
+	struct qmi_nas_param_event_signal_strength ss;
+	struct qmi_param *param;
+	uint8_t rf_info = 0x01;
+	uint16_t len;
+
+	if (!data->nas)
+		return;
+
+	if (data->muted & OFONO_DEVMON_IND_SIGNAL_STRENGTH) {
+		memset(&ss, 0, sizeof(ss));
+		len = sizeof(ss) - sizeof(ss.dbm);
+	} else {
+		len = fill_signal_thresholds(&ss, data->strength_bars);
+	}
+
+	if (data->muted & OFONO_DEVMON_IND_CELL_INFO)
+		rf_info = 0x00;
+
+	DBG("%u thresholds, rf info %u", ss.count, rf_info);
+
+	param = qmi_param_new();
+	if (!param)
+		return;
+
+	qmi_param_append(param, QMI_NAS_PARAM_REPORT_SIGNAL_STRENGTH,
+								len, &ss);
+	qmi_param_append_uint8(param, QMI_NAS_PARAM_REPORT_RF_INFO, rf_info);
+
+	if (qmi_service_send(data->nas, QMI_NAS_SET_EVENT, param,
+						NULL, NULL, NULL) > 0)
+		return;
+
+	qmi_param_free(param);
+}
+
+static void qmi_set_strength_policy(struct ofono_netreg *netreg,
+			const struct ofono_netreg_strength_policy *policy)
+{
+	struct netreg_data *data = ofono_netreg_get_data(netreg);
+
+	data->strength_bars = policy->bars;
+	update_event_report(data);
+}
+
+static void qmi_mute_indications(struct ofono_netreg *netreg,
+						unsigned int muted)
+{
+	struct netreg_data *data = ofono_netreg_get_data(netreg);
+
+	data->muted = muted;
+	update_event_report(data);
+}
+
 static void get_rssi_cb(struct qmi_result *result, void *user_data)
 {
 	struct cb_data *cbd = user_data;
@@ -485,6 +577,8 @@ static void event_notify(struct qmi_result *result, void *user_data)
 
 	DBG("");
 
+	ofono_devmon_indication_notify();
+
 	ss = qmi_result_get(result, QMI_NAS_NOTIFY_SIGNAL_STRENGTH, &len);
         if (ss) {
 		int strength;
@@ -531,9 +625,8 @@ static void create_nas_cb(struct qmi_service *service, void *user_data)
 	struct ofono_netreg *netreg = user_data;
 	struct netreg_data *data = ofono_netreg_get_data(netreg);
 	struct qmi_param *param;
-	struct qmi_nas_param_event_signal_strength ss = { .report = 0x01,
-				.count = 5, .dbm[0] = -55, .dbm[1] = -65,
-				.dbm[2] = -75, .dbm[3] = -85, .dbm[4] = -95 };
+	struct qmi_nas_param_event_signal_strength ss;
+	uint16_t len;
 
 	DBG("");
 
@@ -545,12 +638,14 @@ static void create_nas_cb(struct qmi_service *service, void *user_data)
 
 	data->nas = qmi_service_ref(service);
 
+	len = fill_signal_thresholds(&ss, 0);
+
 	param = qmi_param_new();
 	if (!param)
 		goto done;
 
 	qmi_param_append(param, QMI_NAS_PARAM_REPORT_SIGNAL_STRENGTH,
-							sizeof(ss), &ss);
+								len, &ss);
 	qmi_param_append_uint8(param, QMI_NAS_PARAM_REPORT_RF_INFO, 0x01);
 
 	if (qmi_service_send(data->nas, QMI_NAS_SET_EVENT, param,
@@ -614,6 +709,8 @@ static struct ofono_netreg_driver driver = {
 	.register_auto		= qmi_register_auto,
 	.register_manual	= qmi_register_manual,
 	.strength		= qmi_signal_strength,
+	.set_strength_policy	= qmi_set_strength_policy,
+	.mute_indications	= qmi_mute_indications,
 };
 
 void qmi_netreg_init(void)
@@ -658,6 +658,7 @@ static gboolean can_write_data(GIOChannel *channel, GIOCondition cond,
 
 	__hexdump('>', req->buf, bytes_written,
 				device->debug_func, device->debug_data);
+	ofono_trace_data(device, FALSE, req->buf, bytes_written);
 
 	__debug_msg(' ', req->buf, bytes_written,
 				device->debug_func, device->debug_data);
@@ -848,6 +849,7 @@ static gboolean received_data(GIOChannel *channel, GIOCondition cond,
 
 	__hexdump('<', buf, bytes_read,
 				device->debug_func, device->debug_data);
+	ofono_trace_data(device, TRUE, buf, bytes_read);
 
 	offset = 0;
 
@@ -68,7 +68,14 @@ enum ril_data_priv_flags {
  *
  * RIL_REQUEST_ALLOW_DATA isn't sent to the selected data SIM until all
  * requests are finished for the other SIM. It's not set at all if RIL
- * version is less than 10.
+ * version is less than 10. If the RIL can handle both SIMs at the same
+ * time (RIL_DATA_MANAGER_PARALLEL_SWITCH) then the new data SIM doesn't
+ * wait for the other one to tear down its data calls.
+ *
+ * The time it takes to switch data SIMs is measured from ril_data_allow()
+ * until the new SIM gets RIL_DATA_FLAG_ON. Capability switch transactions
+ * which happen in the meantime hold back the result until data is turned
+ * on again after the transaction (ril_data_manager_assert_data_on).
  *
  * Power on is requested with ril_radio_power_on while data is allowed or
  * any requests are pending for the SIM. Once data is disallowed and all
@@ -90,10 +97,20 @@ enum ril_data_settings_event_id {
 	SETTINGS_EVENT_COUNT
 };
 
+struct ril_data_switch {
+	struct ril_data *data;	/* The slot being switched on */
+	gint64 start;
+	gint64 teardown;	/* When the other slots became idle */
+	gint64 allow;		/* When ALLOW_DATA was queued */
+	gint64 caps;		/* Time spent in capability transactions */
+};
+
 struct ril_data_manager {
 	gint ref_count;
 	GSList *data_list;
 	enum ril_data_manager_flags flags;
+	struct ril_data_switch sw;
+	gint64 caps_start;
 };
 
 struct ril_data_priv {
@@ -125,11 +142,13 @@ struct ril_data_priv {
 enum ril_data_signal {
 	SIGNAL_ALLOW_CHANGED,
 	SIGNAL_CALLS_CHANGED,
+	SIGNAL_SWITCH_CHANGED,
 	SIGNAL_COUNT
 };
 
 #define SIGNAL_ALLOW_CHANGED_NAME   "ril-data-allow-changed"
 #define SIGNAL_CALLS_CHANGED_NAME   "ril-data-calls-changed"
+#define SIGNAL_SWITCH_CHANGED_NAME  "ril-data-switch-changed"
 
 static guint ril_data_signals[SIGNAL_COUNT] = { 0 };
 
@@ -191,6 +210,10 @@ struct ril_data_request_allow_data {
 };
 
 static void ril_data_manager_check_network_mode(struct ril_data_manager *dm);
+static void ril_data_manager_data_on(struct ril_data_manager *dm,
+						struct ril_data *data);
+static void ril_data_manager_switch_start(struct ril_data_manager *dm,
+						struct ril_data *data);
 static void ril_data_call_deact_cid(struct ril_data *data, int cid);
 static void ril_data_power_update(struct ril_data *self);
 static void ril_data_signal_emit(struct ril_data *self, enum ril_data_signal id)
@@ -1158,6 +1181,9 @@ static void ril_data_allow_cb(GRilIoChannel *io, int ril_status,
 		}
 
 		ril_data_check_allowed(data, was_allowed);
+		if (ad->allow) {
+			ril_data_manager_data_on(priv->dm, data);
+		}
 	}
 
 	ril_data_request_finish(req);
@@ -1217,6 +1243,13 @@ gulong ril_data_add_calls_changed_handler(struct ril_data *self,
 		SIGNAL_CALLS_CHANGED_NAME, G_CALLBACK(cb), arg) : 0;
 }
 
+gulong ril_data_add_switch_changed_handler(struct ril_data *self,
+					ril_data_cb_t cb, void *arg)
+{
+	return (G_LIKELY(self) && G_LIKELY(cb)) ? g_signal_connect(self,
+		SIGNAL_SWITCH_CHANGED_NAME, G_CALLBACK(cb), arg) : 0;
+}
+
 void ril_data_remove_handler(struct ril_data *self, gulong id)
 {
 	if (G_LIKELY(self) && G_LIKELY(id)) {
@@ -1502,6 +1535,7 @@ void ril_data_allow(struct ril_data *self, enum ril_data_role role)
 			} else {
 				priv->flags |= RIL_DATA_FLAG_ALLOWED;
 				priv->flags &= ~RIL_DATA_FLAG_ON;
+				ril_data_manager_switch_start(dm, self);
 
 				/*
 				 * Clear RIL_DATA_FLAG_ALLOWED for all
@@ -1516,6 +1550,9 @@ void ril_data_allow(struct ril_data *self, enum ril_data_role role)
 				ril_data_power_update(self);
 			}
 		} else {
+			if (dm->sw.data == self) {
+				dm->sw.data = NULL;
+			}
 			if (priv->flags & RIL_DATA_FLAG_ALLOWED) {
 				ril_data_disallow(self);
 				ril_data_manager_check_data(dm);
@@ -1605,6 +1642,9 @@ static void ril_data_dispose(GObject *object)
 	}
 
 	dm->data_list = g_slist_remove(dm->data_list, self);
+	if (dm->sw.data == self) {
+		dm->sw.data = NULL;
+	}
 	ril_data_manager_check_data(dm);
 	g_hash_table_destroy(priv->grab);
 	G_OBJECT_CLASS(ril_data_parent_class)->dispose(object);
@@ -1636,6 +1676,7 @@ static void ril_data_class_init(RilDataClass *klass)
 	g_type_class_add_private(klass, sizeof(struct ril_data_priv));
 	NEW_SIGNAL(klass,ALLOW);
 	NEW_SIGNAL(klass,CALLS);
+	NEW_SIGNAL(klass,SWITCH);
 }
 
 /*==========================================================================*
@@ -1679,13 +1720,19 @@ static gboolean ril_data_manager_handover(struct ril_data_manager *self)
 			(self->flags & RIL_DATA_MANAGER_3GLTE_HANDOVER));
 }
 
-static gboolean ril_data_manager_requests_pending(struct ril_data_manager *self)
+static gboolean ril_data_requests_pending(struct ril_data *self)
+{
+	return self->priv->pending_req || self->priv->req_queue;
+}
+
+static gboolean ril_data_manager_requests_pending
+			(struct ril_data_manager *self, struct ril_data *skip)
 {
 	GSList *l;
 
 	for (l= self->data_list; l; l = l->next) {
 		struct ril_data *data = l->data;
-		if (data->priv->pending_req || data->priv->req_queue) {
+		if (data != skip && ril_data_requests_pending(data)) {
 			return TRUE;
 		}
 	}
@@ -1693,6 +1740,40 @@ static gboolean ril_data_manager_requests_pending(struct ril_data_manager *self)
 	return FALSE;
 }
 
+static void ril_data_manager_switch_start(struct ril_data_manager *self,
+						struct ril_data *data)
+{
+	struct ril_data_switch *sw = &self->sw;
+
+	memset(sw, 0, sizeof(*sw));
+	sw->data = data;
+	sw->start = g_get_monotonic_time();
+}
+
+static void ril_data_manager_data_on(struct ril_data_manager *self,
+						struct ril_data *data)
+{
+	struct ril_data_switch *sw = &self->sw;
+
+	/* Wait for the capability switch (if any) to finish */
+	if (sw->data == data && !self->caps_start) {
+		struct ril_data_switch_timings *t = &data->last_switch;
+		const gint64 now = g_get_monotonic_time();
+
+		t->total = now - sw->start;
+		t->teardown = (sw->teardown ? sw->teardown : now) - sw->start;
+		t->caps = sw->caps;
+		t->allow = sw->allow ? (now - sw->allow) : 0;
+		sw->data = NULL;
+
+		DBG_(data, "switched in %d ms (teardown %d, caps %d, "
+			"allow %d)", (int)(t->total / 1000),
+			(int)(t->teardown / 1000), (int)(t->caps / 1000),
+			(int)(t->allow / 1000));
+		ril_data_signal_emit(data, SIGNAL_SWITCH_CHANGED);
+	}
+}
+
 static void ril_data_manager_check_network_mode(struct ril_data_manager *self)
 {
 	GSList *l;
@@ -1778,22 +1859,37 @@ static void ril_data_manager_switch_data_on(struct ril_data_manager *self,
 	}
 
 	if (priv->options.allow_data == RIL_ALLOW_DATA_ENABLED) {
+		if (self->sw.data == data) {
+			self->sw.allow = g_get_monotonic_time();
+		}
 		ril_data_request_queue(ril_data_allow_new(data, TRUE));
 	} else {
 		priv->flags |= RIL_DATA_FLAG_ON;
 		GASSERT(ril_data_allowed(data));
 		DBG_(data, "data on");
 		ril_data_signal_emit(data, SIGNAL_ALLOW_CHANGED);
+		ril_data_manager_data_on(self, data);
 	}
 }
 
 void ril_data_manager_check_data(struct ril_data_manager *self)
 {
+	struct ril_data *data = ril_data_manager_allowed(self);
+	const gboolean others_pending =
+		ril_data_manager_requests_pending(self, data);
+
+	if (self->sw.data && !self->sw.teardown && !others_pending) {
+		self->sw.teardown = g_get_monotonic_time();
+	}
+
 	/*
-	 * Don't do anything if there any requests pending.
+	 * Don't do anything if there any requests pending. If the RIL
+	 * allows that, the slot being switched on only waits for its
+	 * own requests, the other slots may still be tearing down their
+	 * data calls.
 	 */
-	if (!ril_data_manager_requests_pending(self)) {
-		struct ril_data *data = ril_data_manager_allowed(self);
+	if ((!data || !ril_data_requests_pending(data)) && (!others_pending ||
+			(self->flags & RIL_DATA_MANAGER_PARALLEL_SWITCH))) {
 		ril_data_manager_check_network_mode(self);
 		if (data && !(data->priv->flags & RIL_DATA_FLAG_ON)) {
 			ril_data_manager_switch_data_on(self, data);
@@ -1801,11 +1897,33 @@ void ril_data_manager_check_data(struct ril_data_manager *self)
 	}
 }
 
+void ril_data_manager_caps_started(struct ril_data_manager *self)
+{
+	if (self && !self->caps_start) {
+		self->caps_start = g_get_monotonic_time();
+	}
+}
+
 void ril_data_manager_assert_data_on(struct ril_data_manager *self)
 {
 	if (self) {
 		struct ril_data *data = ril_data_manager_allowed(self);
+		struct ril_data_switch *sw = &self->sw;
+		const gint64 now = g_get_monotonic_time();
+
+		/* This is where the capability switch ends */
+		if (self->caps_start) {
+			if (sw->data) {
+				sw->caps += now - MAX(self->caps_start,
+								sw->start);
+			}
+			self->caps_start = 0;
+		}
+
 		if (data) {
+			if (sw->data == data) {
+				sw->allow = now;
+			}
 			ril_data_request_queue(ril_data_allow_new(data, TRUE));
 		}
 	}
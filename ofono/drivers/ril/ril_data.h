@@ -48,15 +48,25 @@ struct ril_data_call_list {
 	GSList *calls;
 };
 
+/* Duration of the phases of the last data SIM switch, in microseconds */
+struct ril_data_switch_timings {
+	gint64 teardown;	/* Until the other slots were done */
+	gint64 caps;		/* Spent in radio capability transactions */
+	gint64 allow;		/* ALLOW_DATA for this slot */
+	gint64 total;
+};
+
 struct ril_data {
 	GObject object;
 	struct ril_data_priv *priv;
 	struct ril_data_call_list *data_calls;
+	struct ril_data_switch_timings last_switch;
 };
 
 enum ril_data_manager_flags {
 	RIL_DATA_MANAGER_3GLTE_HANDOVER = 0x01,
-	RIL_DATA_MANAGER_FORCE_GSM_ON_OTHER_SLOTS = 0x02
+	RIL_DATA_MANAGER_FORCE_GSM_ON_OTHER_SLOTS = 0x02,
+	RIL_DATA_MANAGER_PARALLEL_SWITCH = 0x04
 };
 
 enum ril_data_allow_data_opt {
@@ -91,6 +101,7 @@ struct ril_data_manager *ril_data_manager_ref(struct ril_data_manager *dm);
 void ril_data_manager_unref(struct ril_data_manager *dm);
 void ril_data_manager_check_data(struct ril_data_manager *dm);
 void ril_data_manager_assert_data_on(struct ril_data_manager *dm);
+void ril_data_manager_caps_started(struct ril_data_manager *dm);
 
 typedef void (*ril_data_cb_t)(struct ril_data *data, void *arg);
 typedef void (*ril_data_call_setup_cb_t)(struct ril_data *data,
@@ -113,6 +124,8 @@ gulong ril_data_add_allow_changed_handler(struct ril_data *data,
 					ril_data_cb_t cb, void *arg);
 gulong ril_data_add_calls_changed_handler(struct ril_data *data,
 					ril_data_cb_t cb, void *arg);
+gulong ril_data_add_switch_changed_handler(struct ril_data *data,
+					ril_data_cb_t cb, void *arg);
 void ril_data_remove_handler(struct ril_data *data, gulong id);
 
 void ril_data_allow(struct ril_data *data, enum ril_data_role role);
@@ -418,6 +418,8 @@ static void ril_gprs_context_activate_primary_cb(struct ril_data *data,
 
 		ril_gprs_context_set_active_call(gcd, call);
 		ofono_gprs_context_set_interface(gc, call->ifname);
+		ofono_gprs_context_set_mtu(gc, call->mtu > 0 ?
+					MIN(call->mtu, MAX_MTU) : 0);
 		ril_gprs_context_set_address(gc, call);
 		ril_gprs_context_set_gateway(gc, call);
 		ril_gprs_context_set_dns_servers(gc, call);
@@ -21,14 +21,19 @@
 
 #include "ofono.h"
 
+/*
+ * The cell info object keeps the cells the RIL pushes, so neither
+ * explicit requests nor the periodic updates wake up the modem.
+ */
 struct ril_netmon {
 	struct ofono_netmon *netmon;
 	struct sailfish_cell_info *cell_info;
 	guint register_id;
+	guint update_id;
 };
 
 /* This number must be in sync with ril_netmon_notify_ofono: */
-#define RIL_NETMON_MAX_OFONO_PARAMS (8)
+#define RIL_NETMON_MAX_OFONO_PARAMS (10)
 
 struct ril_netmon_ofono_param {
 	enum ofono_netmon_info type;
@@ -58,7 +63,9 @@ static void ril_netmon_format_mccmnc(char *s_mcc, char *s_mnc, int mcc, int mnc)
 	}
 }
 
+/* Serving cell alone (update) or any cell as a part of the cell list */
 static void ril_netmon_notify_ofono(struct ofono_netmon *netmon,
+		gboolean list, gboolean serving,
 		enum ofono_netmon_cell_type type, int mcc, int mnc,
 		struct ril_netmon_ofono_param *params, int nparams)
 {
@@ -73,7 +80,9 @@ static void ril_netmon_notify_ofono(struct ofono_netmon *netmon,
 	}
 
 	ril_netmon_format_mccmnc(s_mcc, s_mnc, mcc, mnc);
-	ofono_netmon_serving_cell_notify(netmon, type,
+
+	if (!list) {
+		ofono_netmon_serving_cell_notify(netmon, type,
 			OFONO_NETMON_INFO_MCC, s_mcc,
 			OFONO_NETMON_INFO_MNC, s_mnc,
 			params[0].type, params[0].value,
@@ -84,11 +93,31 @@ static void ril_netmon_notify_ofono(struct ofono_netmon *netmon,
 			params[5].type, params[5].value,
 			params[6].type, params[6].value,
 			params[7].type, params[7].value,
+			params[8].type, params[8].value,
+			params[9].type, params[9].value,
+			OFONO_NETMON_INFO_INVALID);
+		return;
+	}
+
+	ofono_netmon_cell_list_notify(netmon, serving, type,
+			OFONO_NETMON_INFO_MCC, s_mcc,
+			OFONO_NETMON_INFO_MNC, s_mnc,
+			params[0].type, params[0].value,
+			params[1].type, params[1].value,
+			params[2].type, params[2].value,
+			params[3].type, params[3].value,
+			params[4].type, params[4].value,
+			params[5].type, params[5].value,
+			params[6].type, params[6].value,
+			params[7].type, params[7].value,
+			params[8].type, params[8].value,
+			params[9].type, params[9].value,
 			OFONO_NETMON_INFO_INVALID);
 }
 
 static void ril_netmon_notify_gsm(struct ofono_netmon *netmon,
-				const struct sailfish_cell_info_gsm *gsm)
+		gboolean list, gboolean serving,
+		const struct sailfish_cell_info_gsm *gsm)
 {
 	struct ril_netmon_ofono_param params[RIL_NETMON_MAX_OFONO_PARAMS];
 	int n = 0;
@@ -123,12 +152,14 @@ static void ril_netmon_notify_gsm(struct ofono_netmon *netmon,
 		n++;
 	}
 
-	ril_netmon_notify_ofono(netmon, OFONO_NETMON_CELL_TYPE_GSM,
+	ril_netmon_notify_ofono(netmon, list, serving,
+					OFONO_NETMON_CELL_TYPE_GSM,
 					gsm->mcc, gsm->mnc, params, n);
 }
 
 static void ril_netmon_notify_wcdma(struct ofono_netmon *netmon,
-				const struct sailfish_cell_info_wcdma *wcdma)
+		gboolean list, gboolean serving,
+		const struct sailfish_cell_info_wcdma *wcdma)
 {
 	struct ril_netmon_ofono_param params[RIL_NETMON_MAX_OFONO_PARAMS];
 	int n = 0;
@@ -169,12 +200,14 @@ static void ril_netmon_notify_wcdma(struct ofono_netmon *netmon,
 		n++;
 	}
 
-	ril_netmon_notify_ofono(netmon, OFONO_NETMON_CELL_TYPE_UMTS,
+	ril_netmon_notify_ofono(netmon, list, serving,
+					OFONO_NETMON_CELL_TYPE_UMTS,
 					wcdma->mcc, wcdma->mnc, params, n);
 }
 
 static void ril_netmon_notify_lte(struct ofono_netmon *netmon,
-				const struct sailfish_cell_info_lte *lte)
+		gboolean list, gboolean serving,
+		const struct sailfish_cell_info_lte *lte)
 {
 	struct ril_netmon_ofono_param params[RIL_NETMON_MAX_OFONO_PARAMS];
 	int n = 0;
@@ -185,6 +218,18 @@ static void ril_netmon_notify_lte(struct ofono_netmon *netmon,
 		n++;
 	}
 
+	if (lte->pci != SAILFISH_CELL_INVALID_VALUE) {
+		params[n].type = OFONO_NETMON_INFO_PCI;
+		params[n].value = lte->pci;
+		n++;
+	}
+
+	if (lte->tac != SAILFISH_CELL_INVALID_VALUE) {
+		params[n].type = OFONO_NETMON_INFO_TAC;
+		params[n].value = lte->tac;
+		n++;
+	}
+
 	if (lte->earfcn != SAILFISH_CELL_INVALID_VALUE) {
 		params[n].type = OFONO_NETMON_INFO_EARFCN;
 		params[n].value = lte->earfcn;
@@ -221,40 +266,89 @@ static void ril_netmon_notify_lte(struct ofono_netmon *netmon,
 		n++;
 	}
 
-	ril_netmon_notify_ofono(netmon, OFONO_NETMON_CELL_TYPE_LTE,
+	ril_netmon_notify_ofono(netmon, list, serving,
+					OFONO_NETMON_CELL_TYPE_LTE,
 					lte->mcc, lte->mnc, params, n);
 }
 
+static void ril_netmon_notify_cell(struct ofono_netmon *netmon,
+			gboolean list, const struct sailfish_cell *cell)
+{
+	switch (cell->type) {
+	case SAILFISH_CELL_TYPE_GSM:
+		ril_netmon_notify_gsm(netmon, list, cell->registered,
+							&cell->info.gsm);
+		break;
+	case SAILFISH_CELL_TYPE_WCDMA:
+		ril_netmon_notify_wcdma(netmon, list, cell->registered,
+							&cell->info.wcdma);
+		break;
+	case SAILFISH_CELL_TYPE_LTE:
+		ril_netmon_notify_lte(netmon, list, cell->registered,
+							&cell->info.lte);
+		break;
+	default:
+		break;
+	}
+}
+
+static void ril_netmon_notify_serving(struct ril_netmon *nm)
+{
+	GSList *l;
+
+	for (l = nm->cell_info->cells; l; l = l->next) {
+		const struct sailfish_cell *cell = l->data;
+
+		if (cell->registered)
+			ril_netmon_notify_cell(nm->netmon, FALSE, cell);
+	}
+}
+
 static void ril_netmon_request_update(struct ofono_netmon *netmon,
 		ofono_netmon_cb_t cb, void *data)
 {
 	struct ril_netmon *nm = ril_netmon_get_data(netmon);
 	struct ofono_error error;
-	GSList *l;
 
-	for (l = nm->cell_info->cells; l; l = l->next) {
-		const struct sailfish_cell *cell = l->data;
+	ril_netmon_notify_serving(nm);
+	cb(ril_error_ok(&error), data);
+}
 
-		if (cell->registered) {
-			switch (cell->type) {
-			case SAILFISH_CELL_TYPE_GSM:
-				ril_netmon_notify_gsm(netmon,
-							&cell->info.gsm);
-				break;
-			case SAILFISH_CELL_TYPE_WCDMA:
-				ril_netmon_notify_wcdma(netmon,
-							&cell->info.wcdma);
-				break;
-			case SAILFISH_CELL_TYPE_LTE:
-				ril_netmon_notify_lte(netmon,
-							&cell->info.lte);
-				break;
-			default:
-				break;
-			}
-		}
+static gboolean ril_netmon_periodic_update_cb(gpointer user_data)
+{
+	ril_netmon_notify_serving(user_data);
+	return G_SOURCE_CONTINUE;
+}
+
+static void ril_netmon_enable_periodic_update(struct ofono_netmon *netmon,
+		unsigned int enable, unsigned int period,
+		ofono_netmon_cb_t cb, void *data)
+{
+	struct ril_netmon *nm = ril_netmon_get_data(netmon);
+	struct ofono_error error;
+
+	if (nm->update_id) {
+		g_source_remove(nm->update_id);
+		nm->update_id = 0;
 	}
 
+	if (enable)
+		nm->update_id = g_timeout_add_seconds(period,
+					ril_netmon_periodic_update_cb, nm);
+
+	cb(ril_error_ok(&error), data);
+}
+
+static void ril_netmon_request_cell_list(struct ofono_netmon *netmon,
+		ofono_netmon_cb_t cb, void *data)
+{
+	struct ril_netmon *nm = ril_netmon_get_data(netmon);
+	struct ofono_error error;
+	GSList *l;
+
+	for (l = nm->cell_info->cells; l; l = l->next)
+		ril_netmon_notify_cell(netmon, TRUE, l->data);
+
 	cb(ril_error_ok(&error), data);
 }
 
@@ -304,6 +398,10 @@ static void ril_netmon_remove(struct ofono_netmon *netmon)
 		g_source_remove(nm->register_id);
 	}
 
+	if (nm->update_id > 0) {
+		g_source_remove(nm->update_id);
+	}
+
 	sailfish_cell_info_unref(nm->cell_info);
 	g_slice_free(struct ril_netmon, nm);
 }
@@ -313,6 +411,8 @@ const struct ofono_netmon_driver ril_netmon_driver = {
 	.probe			= ril_netmon_probe,
 	.remove			= ril_netmon_remove,
 	.request_update		= ril_netmon_request_update,
+	.enable_periodic_update	= ril_netmon_enable_periodic_update,
+	.request_cell_list	= ril_netmon_request_cell_list,
 };
 
 /*
@@ -43,8 +43,6 @@
 		f(&e, ##args);				\
 	} while (0)
 
-#define SIM_EFPBR_FILEID 0x4F30
-
 #define UNUSED	0xFF
 
 #define EXT1_CP_SUBADDRESS	1
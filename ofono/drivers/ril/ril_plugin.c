@@ -117,6 +117,7 @@
 #define RILCONF_SETTINGS_3GHANDOVER         "3GLTEHandover"
 #define RILCONF_SETTINGS_GSM_NON_DATA_SLOTS "ForceGsmForNonDataSlots"
 #define RILCONF_SETTINGS_SET_RADIO_CAP      "SetRadioCapability"
+#define RILCONF_SETTINGS_PARALLEL_SWITCH    "ParallelDataSwitch"
 
 #define RILCONF_MODEM_PREFIX                "ril_"
 #define RILCONF_PATH_PREFIX                 "/" RILCONF_MODEM_PREFIX
@@ -244,12 +245,14 @@ typedef struct sailfish_slot_impl {
 	GRilIoChannel *io;
 	gulong io_event_id[IO_EVENT_COUNT];
 	gulong sim_card_state_event_id;
+	gulong data_switch_event_id;
 	gboolean received_sim_status;
 	guint serialize_id;
 	guint caps_check_id;
 	guint imei_req_id;
 	guint trace_id;
 	guint dump_id;
+	guint ring_id;
 	guint retry_id;
 } ril_slot;
 
@@ -393,8 +396,11 @@ static void ril_plugin_shutdown_slot(ril_slot *slot, gboolean kill_io)
 		}
 
 		if (slot->data) {
+			ril_data_remove_handler(slot->data,
+						slot->data_switch_event_id);
 			ril_data_allow(slot->data, RIL_DATA_ROLE_NONE);
 			ril_data_unref(slot->data);
+			slot->data_switch_event_id = 0;
 			slot->data = NULL;
 		}
 
@@ -427,8 +433,10 @@ static void ril_plugin_shutdown_slot(ril_slot *slot, gboolean kill_io)
 
 			grilio_channel_remove_logger(slot->io, slot->trace_id);
 			grilio_channel_remove_logger(slot->io, slot->dump_id);
+			grilio_channel_remove_logger(slot->io, slot->ring_id);
 			slot->trace_id = 0;
 			slot->dump_id = 0;
+			slot->ring_id = 0;
 
 			if (slot->caps_check_id) {
 				grilio_channel_cancel_request(slot->io,
@@ -737,6 +745,27 @@ static void ril_plugin_caps_switch_aborted(struct ril_radio_caps_manager *mgr,
 				"Capability switch transaction aborted");
 }
 
+static void ril_plugin_data_switch_changed(struct ril_data *data, void *user)
+{
+	ril_slot *slot = user;
+	const struct ril_data_switch_timings *t = &data->last_switch;
+	struct sailfish_data_switch_timings timings;
+
+	timings.teardown = t->teardown;
+	timings.caps = t->caps;
+	timings.allow = t->allow;
+	timings.total = t->total;
+	sailfish_manager_data_switch_done(slot->handle, &timings);
+}
+
+static void ril_plugin_trace_ring(GRilIoChannel *io, GRILIO_PACKET_TYPE type,
+	guint id, guint code, const void *data, guint data_len, void *user_data)
+{
+	/* Acks are sent to rild, just like requests */
+	ofono_trace_data(io, type != GRILIO_PACKET_REQ &&
+				type != GRILIO_PACKET_ACK, data, data_len);
+}
+
 static void ril_plugin_trace(GRilIoChannel *io, GRILIO_PACKET_TYPE type,
 	guint id, guint code, const void *data, guint data_len, void *user_data)
 {
@@ -1003,6 +1032,8 @@ static void ril_plugin_slot_connected(ril_slot *slot)
 	slot->data = ril_data_new(plugin->data_manager, log_prefix,
 		slot->radio, slot->network, slot->io, &slot->data_opt,
 		&slot->config, slot->vendor);
+	slot->data_switch_event_id = ril_data_add_switch_changed_handler(
+			slot->data, ril_plugin_data_switch_changed, slot);
 
 	GASSERT(!slot->cell_info);
 	if (slot->io->ril_version >= 9) {
@@ -1065,6 +1096,9 @@ static void ril_plugin_init_io(ril_slot *slot)
 		slot->io = grilio_channel_new(ofono_ril_transport_connect
 			(slot->transport_name, slot->transport_params));
 		if (slot->io) {
+			/* Costs next to nothing without the trace ring */
+			slot->ring_id = grilio_channel_add_logger(slot->io,
+						ril_plugin_trace_ring, slot);
 			ril_debug_trace_update(slot);
 			ril_debug_dump_update(slot);
 
@@ -1888,6 +1922,12 @@ static GSList *ril_plugin_parse_config_file(GKeyFile *file,
 				RIL_DATA_MANAGER_FORCE_GSM_ON_OTHER_SLOTS,
 				&ps->dm_flags);
 
+			/* ParallelDataSwitch */
+			ril_config_get_flag(file, group,
+				RILCONF_SETTINGS_PARALLEL_SWITCH,
+				RIL_DATA_MANAGER_PARALLEL_SWITCH,
+				&ps->dm_flags);
+
 			/* SetRadioCapability */
 			if (ril_config_get_enum(file, group,
 				RILCONF_SETTINGS_SET_RADIO_CAP, &ival,
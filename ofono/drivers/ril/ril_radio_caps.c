@@ -946,18 +946,9 @@ static void ril_radio_caps_manager_next_phase
 	}
 }
 
-static void ril_radio_caps_manager_data_off_done(GRilIoChannel *io,
-		int status, const void *req_data, guint len, void *user_data)
+static void ril_radio_caps_manager_data_off_check
+					(struct ril_radio_caps_manager *self)
 {
-	struct ril_radio_caps *caps = user_data;
-	struct ril_radio_caps_manager *self = caps->mgr;
-
-	GASSERT(caps->tx_pending > 0);
-	if (status != GRILIO_STATUS_OK) {
-		self->tx_failed = TRUE;
-	}
-	caps->tx_pending--;
-	DBG_(caps, "tx_pending=%d", caps->tx_pending);
 	if (!ril_radio_caps_manager_tx_pending(self)) {
 		if (self->tx_failed) {
 			DBG("failed to start the transaction");
@@ -972,6 +963,21 @@ static void ril_radio_caps_manager_data_off_done(GRilIoChannel *io,
 	}
 }
 
+static void ril_radio_caps_manager_data_off_done(GRilIoChannel *io,
+		int status, const void *req_data, guint len, void *user_data)
+{
+	struct ril_radio_caps *caps = user_data;
+	struct ril_radio_caps_manager *self = caps->mgr;
+
+	GASSERT(caps->tx_pending > 0);
+	if (status != GRILIO_STATUS_OK) {
+		self->tx_failed = TRUE;
+	}
+	caps->tx_pending--;
+	DBG_(caps, "tx_pending=%d", caps->tx_pending);
+	ril_radio_caps_manager_data_off_check(self);
+}
+
 static void ril_radio_caps_manager_data_off
 					(struct ril_radio_caps_manager *self,
 						 struct ril_radio_caps *caps)
@@ -1003,17 +1009,7 @@ static void ril_radio_caps_manager_deactivate_data_call_done(GRilIoChannel *io,
 	}
 	caps->tx_pending--;
 	DBG_(caps, "tx_pending=%d", caps->tx_pending);
-	if (!ril_radio_caps_manager_tx_pending(self)) {
-		if (self->tx_failed) {
-			DBG("failed to start the transaction");
-			ril_radio_caps_manager_recheck_later(self);
-			ril_radio_caps_manager_foreach(self,
-					ril_radio_caps_manager_cancel_cb);
-		} else {
-			ril_radio_caps_manager_foreach_tx(self,
-					ril_radio_caps_manager_data_off);
-		}
-	}
+	ril_radio_caps_manager_data_off_check(self);
 }
 
 static void ril_radio_caps_deactivate_data_call(struct ril_radio_caps *caps,
@@ -1055,14 +1051,16 @@ static void ril_radio_caps_manager_deactivate_all_cb
 static void ril_radio_caps_manager_deactivate_all
 					(struct ril_radio_caps_manager *self)
 {
+	/*
+	 * DEACTIVATE_DATA_CALL requests are blocking, ALLOW_DATA gets
+	 * submitted right after them without waiting for the completion.
+	 * That saves a round trip per modem.
+	 */
 	ril_radio_caps_manager_foreach_tx(self,
 				ril_radio_caps_manager_deactivate_all_cb);
-	if (!ril_radio_caps_manager_tx_pending(self)) {
-		/* No data calls, submit ALLOW_DATA requests right away */
-		ril_radio_caps_manager_foreach_tx(self,
-					ril_radio_caps_manager_data_off);
-		GASSERT(ril_radio_caps_manager_tx_pending(self));
-	}
+	ril_radio_caps_manager_foreach_tx(self,
+				ril_radio_caps_manager_data_off);
+	GASSERT(ril_radio_caps_manager_tx_pending(self));
 }
 
 static void ril_radio_caps_tx_wait_cb(GRilIoChannel *io, void *user_data)
@@ -1208,10 +1206,29 @@ static void ril_radio_caps_manager_start_transaction
 {
 	const GPtrArray *list = self->caps_list;
 	gboolean sim_io_active = FALSE;
-	guint i, count = 0;
+	guint i;
+
+	/*
+	 * Don't even start the transaction (which cancels the requests
+	 * queued for the modems and turns off data) if the capabilities
+	 * are already where they need to be.
+	 */
+	for (i = 0; i < list->len; i++) {
+		const struct ril_radio_caps *caps = list->pdata[i];
+
+		if (memcmp(&caps->new_cap, &caps->old_cap, sizeof(caps->cap))) {
+			break;
+		}
+	}
+
+	if (i == list->len) {
+		DBG("capabilities already match");
+		return;
+	}
 
 	/* Start the new request transaction */
 	ril_radio_caps_manager_next_transaction(self);
+	ril_data_manager_caps_started(self->data_manager);
 	DBG("transaction %d", self->tx_id);
 
 	for (i = 0; i < list->len; i++) {
@@ -1220,18 +1237,13 @@ static void ril_radio_caps_manager_start_transaction
 		if (memcmp(&caps->new_cap, &caps->old_cap, sizeof(caps->cap))) {
 			/* Mark it as taking part in this transaction */
 			caps->tx_id = self->tx_id;
-			count++;
 			if (caps->simcard->sim_io_active) {
 				sim_io_active = TRUE;
 			}
 		}
 	}
 
-	GASSERT(count);
-	if (!count) {
-		/* This is not supposed to happen */
-		DBG("nothing to do!");
-	} else if (sim_io_active) {
+	if (sim_io_active) {
 		DBG("waiting for SIM I/O to calm down");
 		ril_radio_caps_manager_foreach_tx(self,
 				ril_radio_caps_manager_start_sim_io_watch);
@@ -29,6 +29,9 @@
 #define FAC_LOCK_QUERY_RETRIES        (1)
 #define SIM_IO_TIMEOUT_SECS           (20)
 
+/* UPDATE BINARY and UPDATE RECORD carry up to 255 bytes (P3) */
+#define RIL_SIM_MAX_IO_DATA           (255)
+
 #define EF_STATUS_INVALIDATED 0
 #define EF_STATUS_VALID 1
 
@@ -287,7 +290,7 @@ static void ril_sim_append_path(struct ril_sim *sd, GRilIoRequest *req,
 {
 	const enum ril_app_type app_type = ril_sim_card_app_type(sd->card);
 	guchar db_path[6] = { 0x00 };
-	char *hex_path = NULL;
+	char hex_path[2 * sizeof(db_path) + 1];
 	int len;
 
 	if (path_len > 0 && path_len < 7) {
@@ -303,10 +306,9 @@ static void ril_sim_append_path(struct ril_sim *sd, GRilIoRequest *req,
 	}
 
 	if (len > 0) {
-		hex_path = encode_hex(db_path, len, 0);
+		encode_hex_own_buf(db_path, len, 0, hex_path);
 		grilio_request_append_utf8(req, hex_path);
 		DBG_(sd, "%s", hex_path);
-		g_free(hex_path);
 	} else if (fileid == SIM_EF_ICCID_FILEID || fileid == SIM_EFPL_FILEID) {
 		/*
 		 * Special catch-all for EF_ICCID (unique card ID)
@@ -610,10 +612,16 @@ static void ril_sim_write(struct ofono_sim *sim, guint cmd, int fileid,
 			ofono_sim_write_cb_t cb, void *data)
 {
 	struct ril_sim *sd = ril_sim_get_data(sim);
-	char *hex_data = encode_hex(value, length, 0);
+	char buf[2 * RIL_SIM_MAX_IO_DATA + 1];
+	char *hex_data = (length <= RIL_SIM_MAX_IO_DATA) ?
+		encode_hex_own_buf(value, length, 0, buf) :
+		encode_hex(value, length, 0);
+
 	ril_sim_request_io(sd, cmd, fileid, p1, p2, length, hex_data, path,
 		path_len, ril_sim_write_cb, ril_sim_cbd_io_new(sd, cb, data));
-	g_free(hex_data);
+	if (hex_data != buf) {
+		g_free(hex_data);
+	}
 }
 
 static void ril_sim_write_file_transparent(struct ofono_sim *sim, int fileid,
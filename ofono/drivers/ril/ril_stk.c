@@ -23,6 +23,9 @@
 #  define UI_LANG "/var/lib/environment/nemo/locale.conf"
 #endif
 
+/* BER-TLV objects exchanged with the card fit into a single APDU */
+#define RIL_STK_MAX_PDU (256)
+
 enum ril_stk_events {
 	STK_EVENT_PROACTIVE_COMMAND,
 	STK_EVENT_SESSION_END,
@@ -62,6 +65,18 @@ struct ril_stk_cbd *ril_stk_cbd_new(void *cb, void *data)
 	return cbd;
 }
 
+/* Decodes into buf unless the PDU is too large for it */
+static guchar *ril_stk_decode_pdu(const char *hex, guchar *buf, long *len)
+{
+	const long hex_len = hex ? strlen(hex) : 0;
+
+	if (hex_len / 2 <= RIL_STK_MAX_PDU) {
+		return decode_hex_own_buf(hex, hex_len, len, 0, buf);
+	} else {
+		return decode_hex(hex, hex_len, len, 0);
+	}
+}
+
 static void ril_stk_envelope_cb(GRilIoChannel *io, int status,
 				const void *data, guint len, void *user_data)
 {
@@ -83,11 +98,16 @@ static void ril_stk_envelope(struct ofono_stk *stk, int length,
 {
 	struct ril_stk *sd = ril_stk_get_data(stk);
 	GRilIoRequest *req = grilio_request_new();
-	char *hex_envelope = encode_hex(cmd, length, 0);
+	char buf[2 * RIL_STK_MAX_PDU + 1];
+	char *hex_envelope = (length <= RIL_STK_MAX_PDU) ?
+		encode_hex_own_buf(cmd, length, 0, buf) :
+		encode_hex(cmd, length, 0);
 
 	DBG("%s", hex_envelope);
 	grilio_request_append_utf8(req, hex_envelope);
-	g_free(hex_envelope);
+	if (hex_envelope != buf) {
+		g_free(hex_envelope);
+	}
 	grilio_queue_send_request_full(sd->q, req,
 			RIL_REQUEST_STK_SEND_ENVELOPE_COMMAND,
 			ril_stk_envelope_cb, ril_stk_cbd_free,
@@ -117,11 +137,16 @@ static void ril_stk_terminal_response(struct ofono_stk *stk, int length,
 {
 	struct ril_stk *sd = ril_stk_get_data(stk);
 	GRilIoRequest *req = grilio_request_new();
-	char *hex_tr = encode_hex(resp, length, 0);
+	char buf[2 * RIL_STK_MAX_PDU + 1];
+	char *hex_tr = (length <= RIL_STK_MAX_PDU) ?
+		encode_hex_own_buf(resp, length, 0, buf) :
+		encode_hex(resp, length, 0);
 
 	DBG("rilmodem terminal response: %s", hex_tr);
 	grilio_request_append_utf8(req, hex_tr);
-	g_free(hex_tr);
+	if (hex_tr != buf) {
+		g_free(hex_tr);
+	}
 	grilio_queue_send_request_full(sd->q, req,
 				RIL_REQUEST_STK_SEND_TERMINAL_RESPONSE,
 				ril_stk_terminal_response_cb,
@@ -150,6 +175,7 @@ static void ril_stk_pcmd_notify(GRilIoChannel *io, guint code,
 	struct ril_stk *sd = user_data;
 	GRilIoParser rilp;
 	char *pcmd;
+	guchar buf[RIL_STK_MAX_PDU];
 	guchar *pdu;
 	long len = 0;
 
@@ -158,11 +184,13 @@ static void ril_stk_pcmd_notify(GRilIoChannel *io, guint code,
 	pcmd = grilio_parser_get_utf8(&rilp);
 	DBG("pcmd: %s", pcmd);
 
-	pdu = decode_hex(pcmd, strlen(pcmd), &len, -1);
+	pdu = ril_stk_decode_pdu(pcmd, buf, &len);
 	g_free(pcmd);
 
 	ofono_stk_proactive_command_notify(sd->stk, len, pdu);
-	g_free(pdu);
+	if (pdu != buf) {
+		g_free(pdu);
+	}
 }
 
 static void ril_stk_event_notify(GRilIoChannel *io, guint code,
@@ -171,19 +199,22 @@ static void ril_stk_event_notify(GRilIoChannel *io, guint code,
 	struct ril_stk *sd = user_data;
 	GRilIoParser rilp;
 	char *pcmd = NULL;
+	guchar buf[RIL_STK_MAX_PDU];
 	guchar *pdu = NULL;
-	long len;
+	long len = 0;
 
 	/* Proactive command has been handled by the modem. */
 	GASSERT(code == RIL_UNSOL_STK_EVENT_NOTIFY);
 	grilio_parser_init(&rilp, data, data_len);
 	pcmd = grilio_parser_get_utf8(&rilp);
 	DBG("pcmd: %s", pcmd);
-	pdu = decode_hex(pcmd, strlen(pcmd), &len, -1);
+	pdu = ril_stk_decode_pdu(pcmd, buf, &len);
 	g_free(pcmd);
 
 	ofono_stk_proactive_command_handled_notify(sd->stk, len, pdu);
-	g_free(pdu);
+	if (pdu != buf) {
+		g_free(pdu);
+	}
 }
 
 static void ril_stk_session_end_notify(GRilIoChannel *io, guint code,
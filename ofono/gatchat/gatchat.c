@@ -1252,7 +1252,7 @@ static gboolean node_compare_by_group(struct at_notify_node *node,
 }
 
 static struct at_chat *create_chat(GIOChannel *channel, GIOFlags flags,
-					GAtSyntax *syntax)
+					gboolean threaded, GAtSyntax *syntax)
 {
 	struct at_chat *chat;
 
@@ -1271,7 +1271,9 @@ static struct at_chat *create_chat(GIOChannel *channel, GIOFlags flags,
 	chat->next_notify_id = 1;
 	chat->debugf = NULL;
 
-	if (flags & G_IO_FLAG_NONBLOCK)
+	if (threaded)
+		chat->io = g_at_io_new_threaded(channel);
+	else if (flags & G_IO_FLAG_NONBLOCK)
 		chat->io = g_at_io_new(channel);
 	else
 		chat->io = g_at_io_new_blocking(channel);
@@ -1308,7 +1310,7 @@ error:
 }
 
 static GAtChat *g_at_chat_new_common(GIOChannel *channel, GIOFlags flags,
-					GAtSyntax *syntax)
+					gboolean threaded, GAtSyntax *syntax)
 {
 	GAtChat *chat;
 
@@ -1316,7 +1318,7 @@ static GAtChat *g_at_chat_new_common(GIOChannel *channel, GIOFlags flags,
 	if (chat == NULL)
 		return NULL;
 
-	chat->parent = create_chat(channel, flags, syntax);
+	chat->parent = create_chat(channel, flags, threaded, syntax);
 	if (chat->parent == NULL) {
 		g_free(chat);
 		return NULL;
@@ -1330,12 +1332,19 @@ static GAtChat *g_at_chat_new_common(GIOChannel *channel, GIOFlags flags,
 
 GAtChat *g_at_chat_new(GIOChannel *channel, GAtSyntax *syntax)
 {
-	return g_at_chat_new_common(channel, G_IO_FLAG_NONBLOCK, syntax);
+	return g_at_chat_new_common(channel, G_IO_FLAG_NONBLOCK, FALSE,
+					syntax);
 }
 
 GAtChat *g_at_chat_new_blocking(GIOChannel *channel, GAtSyntax *syntax)
 {
-	return g_at_chat_new_common(channel, 0, syntax);
+	return g_at_chat_new_common(channel, 0, FALSE, syntax);
+}
+
+GAtChat *g_at_chat_new_threaded(GIOChannel *channel, GAtSyntax *syntax)
+{
+	return g_at_chat_new_common(channel, G_IO_FLAG_NONBLOCK, TRUE,
+					syntax);
 }
 
 GAtChat *g_at_chat_clone(GAtChat *clone)
@@ -56,6 +56,7 @@ typedef enum _GAtChatTerminator GAtChatTerminator;
 
 GAtChat *g_at_chat_new(GIOChannel *channel, GAtSyntax *syntax);
 GAtChat *g_at_chat_new_blocking(GIOChannel *channel, GAtSyntax *syntax);
+GAtChat *g_at_chat_new_threaded(GIOChannel *channel, GAtSyntax *syntax);
 
 GIOChannel *g_at_chat_get_channel(GAtChat *chat);
 GAtIO *g_at_chat_get_io(GAtChat *chat);
@@ -29,6 +29,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <sys/uio.h>
 
 #include <glib.h>
 
@@ -36,6 +37,40 @@
 #include "gatio.h"
 #include "gatutil.h"
 
+#define WORKER_SLOTS		32		/* must be a power of two */
+#define WORKER_SLOT_SIZE	2048
+#define WORKER_DISPATCH_BUDGET	4		/* read handler calls */
+
+struct io_worker_slot {
+	gsize len;				/* bytes in data */
+	gsize offset;				/* bytes already consumed */
+	unsigned char data[WORKER_SLOT_SIZE];
+};
+
+/*
+ * Single producer / single consumer queue between the worker thread
+ * (which reads the channel) and the main loop (which runs the parser).
+ * head is only written by the worker, tail only by the main thread.
+ */
+struct io_worker {
+	GThread *thread;			/* Reader thread */
+	GMainContext *context;			/* Reader thread context */
+	GMainLoop *loop;			/* Reader thread loop */
+	GSource *read_source;			/* Owned by the reader thread */
+	GSource *wakeup;			/* Main context source */
+	gint head;				/* Next slot to fill */
+	gint tail;				/* Next slot to consume */
+	gint pending;				/* Main thread has work to do */
+	gint stalled;				/* Reader waits for slots */
+	gint hangup;				/* Reader saw EOF or error */
+	struct io_worker_slot slots[WORKER_SLOTS];
+};
+
+struct io_worker_source {
+	GSource source;
+	struct io_worker *worker;
+};
+
 struct _GAtIO {
 	gint ref_count;				/* Ref count */
 	guint read_watch;			/* GSource read id, 0 if no */
@@ -55,6 +90,9 @@ struct _GAtIO {
 	GAtDisconnectFunc write_done_func;	/* tx empty notifier */
 	gpointer write_done_data;		/* tx empty data */
 	gboolean destroyed;			/* Re-entrancy guard */
+	struct io_worker *worker;		/* NULL unless threaded */
+	guint write_calls;			/* write syscalls issued */
+	guint64 write_bytes;			/* bytes written */
 };
 
 static void read_watcher_destroy_notify(gpointer user_data)
@@ -107,6 +145,7 @@ static gboolean received_data(GIOChannel *channel, GIOCondition cond,
 							toread, &rbytes, NULL);
 		g_at_util_debug_chat(TRUE, (char *)buf, rbytes,
 					io->debugf, io->debug_data);
+		g_at_util_trace(io, TRUE, buf, rbytes);
 
 		read_count++;
 
@@ -141,18 +180,68 @@ gsize g_at_io_write(GAtIO *io, const gchar *data, gsize count)
 
 	status = g_io_channel_write_chars(io->channel, data,
 						count, &bytes_written, NULL);
+	io->write_calls++;
 
 	if (status != G_IO_STATUS_NORMAL) {
 		g_source_remove(io->read_watch);
 		return 0;
 	}
 
+	io->write_bytes += bytes_written;
+
 	g_at_util_debug_chat(FALSE, data, bytes_written,
 				io->debugf, io->debug_data);
+	g_at_util_trace(io, FALSE, data, bytes_written);
 
 	return bytes_written;
 }
 
+gsize g_at_io_writev(GAtIO *io, const struct iovec *iov, int iovcnt)
+{
+	int fd = g_io_channel_unix_get_fd(io->channel);
+	ssize_t written;
+	gsize left;
+	int i;
+
+	do {
+		written = writev(fd, iov, iovcnt);
+		io->write_calls++;
+	} while (written < 0 && errno == EINTR);
+
+	if (written < 0) {
+		int err = errno;
+
+		/* The write watch will call us again once there is room */
+		if (err != EAGAIN)
+			g_source_remove(io->read_watch);
+
+		errno = err;
+		return 0;
+	}
+
+	io->write_bytes += written;
+
+	for (i = 0, left = written; i < iovcnt && left > 0; i++) {
+		gsize len = MIN(iov[i].iov_len, left);
+
+		g_at_util_debug_chat(FALSE, iov[i].iov_base, len,
+					io->debugf, io->debug_data);
+		g_at_util_trace(io, FALSE, iov[i].iov_base, len);
+		left -= len;
+	}
+
+	return written;
+}
+
+void g_at_io_get_write_stats(GAtIO *io, guint *calls, guint64 *bytes)
+{
+	if (calls)
+		*calls = io ? io->write_calls : 0;
+
+	if (bytes)
+		*bytes = io ? io->write_bytes : 0;
+}
+
 static void write_watcher_destroy_notify(gpointer user_data)
 {
 	GAtIO *io = user_data;
@@ -182,7 +271,302 @@ static gboolean can_write_data(GIOChannel *channel, GIOCondition cond,
 	return io->write_handler(io->write_data);
 }
 
-static GAtIO *create_io(GIOChannel *channel, GIOFlags flags)
+static gboolean worker_received_data(GIOChannel *channel, GIOCondition cond,
+					gpointer data);
+
+static void worker_add_watch(GAtIO *io)
+{
+	struct io_worker *w = io->worker;
+
+	w->read_source = g_io_create_watch(io->channel,
+				G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL);
+	g_source_set_callback(w->read_source,
+				(GSourceFunc) worker_received_data, io, NULL);
+	g_source_attach(w->read_source, w->context);
+}
+
+static gboolean worker_stop_reading(struct io_worker *w)
+{
+	g_source_unref(w->read_source);
+	w->read_source = NULL;
+
+	return FALSE;
+}
+
+static void worker_notify(struct io_worker *w)
+{
+	g_atomic_int_set(&w->pending, TRUE);
+	g_main_context_wakeup(g_main_context_default());
+}
+
+/* Runs in the worker thread */
+static gboolean worker_received_data(GIOChannel *channel, GIOCondition cond,
+					gpointer data)
+{
+	GAtIO *io = data;
+	struct io_worker *w = io->worker;
+	int fd = g_io_channel_unix_get_fd(channel);
+	gboolean committed = FALSE;
+	guint read_count = 0;
+	ssize_t rbytes = 0;
+	int err = 0;
+
+	if (cond & G_IO_NVAL)
+		goto hangup;
+
+	/* Regardless of condition, try to read all the data available */
+	while (read_count < io->max_read_attempts) {
+		guint head = g_atomic_int_get(&w->head);
+		struct io_worker_slot *slot;
+
+		if (head - (guint) g_atomic_int_get(&w->tail) == WORKER_SLOTS) {
+			/*
+			 * The parser is behind, stop polling until it has
+			 * consumed some data.  Re-check after publishing
+			 * the flag, the main thread may have just drained
+			 * the queue without seeing it.
+			 */
+			g_atomic_int_set(&w->stalled, TRUE);
+
+			if (head - (guint) g_atomic_int_get(&w->tail) ==
+					WORKER_SLOTS ||
+					!g_atomic_int_compare_and_exchange(
+						&w->stalled, TRUE, FALSE)) {
+				if (committed)
+					worker_notify(w);
+
+				return worker_stop_reading(w);
+			}
+		}
+
+		slot = &w->slots[head & (WORKER_SLOTS - 1)];
+
+		rbytes = read(fd, slot->data, WORKER_SLOT_SIZE);
+		read_count++;
+
+		if (rbytes < 0)
+			err = errno;
+
+		if (rbytes <= 0)
+			break;
+
+		slot->len = rbytes;
+		slot->offset = 0;
+		g_atomic_int_set(&w->head, head + 1);
+		committed = TRUE;
+	}
+
+	if (committed)
+		worker_notify(w);
+
+	if (cond & (G_IO_HUP | G_IO_ERR))
+		goto hangup;
+
+	if (rbytes == 0 || (rbytes < 0 && err != EAGAIN && err != EINTR))
+		goto hangup;
+
+	return TRUE;
+
+hangup:
+	g_atomic_int_set(&w->hangup, TRUE);
+	worker_notify(w);
+
+	return worker_stop_reading(w);
+}
+
+/* Runs in the worker thread */
+static gboolean worker_resume(gpointer user_data)
+{
+	GAtIO *io = user_data;
+	struct io_worker *w = io->worker;
+
+	if (w->read_source == NULL && !g_atomic_int_get(&w->hangup))
+		worker_add_watch(io);
+
+	return FALSE;
+}
+
+/* Runs in the worker thread */
+static gboolean worker_quit(gpointer user_data)
+{
+	struct io_worker *w = user_data;
+
+	if (w->read_source) {
+		g_source_destroy(w->read_source);
+		worker_stop_reading(w);
+	}
+
+	g_main_loop_quit(w->loop);
+
+	return FALSE;
+}
+
+static gpointer worker_thread(gpointer user_data)
+{
+	struct io_worker *w = user_data;
+
+	g_main_context_push_thread_default(w->context);
+	g_main_loop_run(w->loop);
+	g_main_context_pop_thread_default(w->context);
+
+	return NULL;
+}
+
+/*
+ * Moves as much data as fits from the worker queue into the read ring
+ * buffer.  Returns the number of bytes moved.
+ */
+static gsize worker_fill_ring_buffer(GAtIO *io)
+{
+	struct io_worker *w = io->worker;
+	guint tail = g_atomic_int_get(&w->tail);
+	guint head = g_atomic_int_get(&w->head);
+	gsize total = 0;
+
+	while (tail != head && ring_buffer_avail(io->buf) > 0) {
+		struct io_worker_slot *slot =
+			&w->slots[tail & (WORKER_SLOTS - 1)];
+		const unsigned char *data = slot->data + slot->offset;
+		gsize len = ring_buffer_write(io->buf, data,
+						slot->len - slot->offset);
+
+		g_at_util_debug_chat(TRUE, (const char *) data, len,
+					io->debugf, io->debug_data);
+		g_at_util_trace(io, TRUE, data, len);
+
+		slot->offset += len;
+		total += len;
+
+		if (slot->offset < slot->len)
+			break;
+
+		tail += 1;
+	}
+
+	g_atomic_int_set(&w->tail, tail);
+
+	return total;
+}
+
+/* Runs in the main thread */
+static gboolean worker_dispatch(gpointer user_data)
+{
+	GAtIO *io = user_data;
+	struct io_worker *w = io->worker;
+	guint budget = WORKER_DISPATCH_BUDGET;
+	gboolean consumed = FALSE;
+	gboolean empty;
+
+	g_atomic_int_set(&w->pending, FALSE);
+
+	while (budget > 0 && worker_fill_ring_buffer(io) > 0) {
+		consumed = TRUE;
+		budget -= 1;
+
+		if (io->read_handler)
+			io->read_handler(io->buf, io->read_data);
+
+		/* The read handler may have shut us down */
+		if (g_source_is_destroyed(w->wakeup))
+			return FALSE;
+	}
+
+	empty = g_atomic_int_get(&w->head) == g_atomic_int_get(&w->tail);
+
+	if (consumed && g_atomic_int_compare_and_exchange(&w->stalled,
+								TRUE, FALSE))
+		g_main_context_invoke(w->context, worker_resume, io);
+
+	if (!empty) {
+		/* We're overflowing the buffer, shutdown the channel */
+		if (ring_buffer_avail(io->buf) == 0)
+			return FALSE;
+
+		/* Give the other sources a chance before continuing */
+		g_atomic_int_set(&w->pending, TRUE);
+		return TRUE;
+	}
+
+	if (g_atomic_int_get(&w->hangup))
+		return FALSE;
+
+	return TRUE;
+}
+
+static void worker_wakeup_destroy_notify(gpointer user_data)
+{
+	GAtIO *io = user_data;
+	struct io_worker *w = io->worker;
+
+	g_main_context_invoke(w->context, worker_quit, w);
+	g_thread_join(w->thread);
+
+	g_main_loop_unref(w->loop);
+	g_main_context_unref(w->context);
+	g_source_unref(w->wakeup);
+	g_free(w);
+
+	io->worker = NULL;
+
+	read_watcher_destroy_notify(io);
+}
+
+static gboolean worker_wakeup_prepare(GSource *source, gint *timeout)
+{
+	struct io_worker *w = ((struct io_worker_source *) source)->worker;
+
+	*timeout = -1;
+
+	return g_atomic_int_get(&w->pending);
+}
+
+static gboolean worker_wakeup_check(GSource *source)
+{
+	struct io_worker *w = ((struct io_worker_source *) source)->worker;
+
+	return g_atomic_int_get(&w->pending);
+}
+
+static gboolean worker_wakeup_dispatch(GSource *source, GSourceFunc callback,
+					gpointer user_data)
+{
+	return callback(user_data);
+}
+
+static GSourceFuncs worker_wakeup_funcs = {
+	.prepare = worker_wakeup_prepare,
+	.check = worker_wakeup_check,
+	.dispatch = worker_wakeup_dispatch,
+};
+
+static guint worker_start(GAtIO *io)
+{
+	struct io_worker *w;
+	guint id;
+
+	w = g_try_new0(struct io_worker, 1);
+	if (w == NULL)
+		return 0;
+
+	io->worker = w;
+	w->context = g_main_context_new();
+	w->loop = g_main_loop_new(w->context, FALSE);
+	worker_add_watch(io);
+
+	w->wakeup = g_source_new(&worker_wakeup_funcs,
+					sizeof(struct io_worker_source));
+	((struct io_worker_source *) w->wakeup)->worker = w;
+	g_source_set_callback(w->wakeup, worker_dispatch, io,
+				worker_wakeup_destroy_notify);
+	id = g_source_attach(w->wakeup, NULL);
+
+	w->thread = g_thread_new("g_at_io", worker_thread, w);
+
+	return id;
+}
+
+static GAtIO *create_io(GIOChannel *channel, GIOFlags flags,
+				gboolean threaded)
 {
 	GAtIO *io;
 
@@ -213,6 +597,15 @@ static GAtIO *create_io(GIOChannel *channel, GIOFlags flags)
 		goto error;
 
 	io->channel = channel;
+
+	if (threaded) {
+		io->read_watch = worker_start(io);
+		if (io->read_watch == 0)
+			goto error;
+
+		return io;
+	}
+
 	io->read_watch = g_io_add_watch_full(channel, G_PRIORITY_DEFAULT,
 				G_IO_IN | G_IO_HUP | G_IO_ERR | G_IO_NVAL,
 				received_data, io,
@@ -231,12 +624,17 @@ error:
 
 GAtIO *g_at_io_new(GIOChannel *channel)
 {
-	return create_io(channel, G_IO_FLAG_NONBLOCK);
+	return create_io(channel, G_IO_FLAG_NONBLOCK, FALSE);
 }
 
 GAtIO *g_at_io_new_blocking(GIOChannel *channel)
 {
-	return create_io(channel, 0);
+	return create_io(channel, 0, FALSE);
+}
+
+GAtIO *g_at_io_new_threaded(GIOChannel *channel)
+{
+	return create_io(channel, G_IO_FLAG_NONBLOCK, TRUE);
 }
 
 GIOChannel *g_at_io_get_channel(GAtIO *io)
@@ -33,6 +33,7 @@ struct _GAtIO;
 typedef struct _GAtIO GAtIO;
 
 struct ring_buffer;
+struct iovec;
 
 typedef void (*GAtIOReadFunc)(struct ring_buffer *buffer, gpointer user_data);
 typedef gboolean (*GAtIOWriteFunc)(gpointer user_data);
@@ -40,6 +41,13 @@ typedef gboolean (*GAtIOWriteFunc)(gpointer user_data);
 GAtIO *g_at_io_new(GIOChannel *channel);
 GAtIO *g_at_io_new_blocking(GIOChannel *channel);
 
+/*
+ * Reads the channel on a dedicated thread with its own GMainContext.
+ * The read handler and all other callbacks are still invoked from the
+ * default main context.
+ */
+GAtIO *g_at_io_new_threaded(GIOChannel *channel);
+
 GIOChannel *g_at_io_get_channel(GAtIO *io);
 
 GAtIO *g_at_io_ref(GAtIO *io);
@@ -56,6 +64,16 @@ void g_at_io_drain_ring_buffer(GAtIO *io, guint len);
 
 gsize g_at_io_write(GAtIO *io, const gchar *data, gsize count);
 
+/*
+ * Writes the segments with a single writev on the channel's fd.  Returns
+ * the number of bytes written, 0 when nothing could be written; errno
+ * is EAGAIN if the channel is merely full.
+ */
+gsize g_at_io_writev(GAtIO *io, const struct iovec *iov, int iovcnt);
+
+/* Number of write syscalls issued and bytes written since creation */
+void g_at_io_get_write_stats(GAtIO *io, guint *calls, guint64 *bytes);
+
 gboolean g_at_io_set_disconnect_function(GAtIO *io,
 			GAtDisconnectFunc disconnect, gpointer user_data);
 
@@ -25,6 +25,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <glib.h>
 
@@ -242,7 +243,8 @@ gboolean g_at_result_iter_next_hexstring(GAtResultIter *iter,
 	*length = (end - pos) / 2;
 
 	for (; pos < end; pos += 2)
-		sscanf(line + pos, "%02hhx", bufpos++);
+		*bufpos++ = (g_ascii_xdigit_value(line[pos]) << 4) |
+				g_ascii_xdigit_value(line[pos + 1]);
 
 	if (line[end] == '"')
 		end += 1;
@@ -495,6 +497,216 @@ gboolean g_at_result_iter_close_list(GAtResultIter *iter)
 	return TRUE;
 }
 
+static void copy_field(char *str, int size, const char *field, int len)
+{
+	if (len >= size)
+		len = size - 1;
+
+	memcpy(str, field, len);
+	str[len] = '\0';
+}
+
+static int parse_field_string(const char *line, int pos, int len,
+				char *str, int size)
+{
+	int end;
+
+	/* Omitted string */
+	if (line[pos] == ',') {
+		str[0] = '\0';
+		return pos;
+	}
+
+	if (line[pos++] != '"')
+		return -1;
+
+	end = pos;
+
+	while (end < len && line[end] != '"')
+		end += 1;
+
+	if (line[end] != '"')
+		return -1;
+
+	copy_field(str, size, line + pos, end - pos);
+
+	/* Skip " */
+	return end + 1;
+}
+
+static int parse_field_unquoted_string(const char *line, int pos, int len,
+					char *str, int size)
+{
+	int end = pos;
+
+	if (line[pos] == '"' || line[pos] == ')')
+		return -1;
+
+	while (end < len && line[end] != ',' && line[end] != ')')
+		end += 1;
+
+	copy_field(str, size, line + pos, end - pos);
+
+	return end;
+}
+
+static int parse_field_hex(const char *line, int pos, int len, gint *number)
+{
+	int end;
+	gint value;
+
+	/* Omitted, same as an empty string */
+	if (line[pos] == ',') {
+		*number = 0;
+		return pos;
+	}
+
+	if (line[pos++] != '"')
+		return -1;
+
+	/*
+	 * Same as strtol() on the quoted string, which is what the callers
+	 * used before: leading spaces, a sign and 0x are accepted, parsing
+	 * stops at the first non hex digit and the rest is ignored.
+	 */
+	value = strtol(line + pos, NULL, 16);
+
+	end = pos;
+
+	while (end < len && line[end] != '"')
+		end += 1;
+
+	if (line[end] != '"')
+		return -1;
+
+	*number = value;
+
+	/* Skip " */
+	return end + 1;
+}
+
+static int parse_field(const char *line, int pos, int len,
+				const GAtField *field, char *out)
+{
+	int end = pos;
+	int value = 0;
+
+	switch (field->type) {
+	case G_AT_FIELD_NUMBER:
+		while (line[end] >= '0' && line[end] <= '9') {
+			value = value * 10 + (int)(line[end] - '0');
+			end += 1;
+		}
+
+		if (pos == end)
+			return -1;
+
+		*(gint *) (out + field->offset) = value;
+		return end;
+	case G_AT_FIELD_HEX:
+		return parse_field_hex(line, pos, len,
+					(gint *) (out + field->offset));
+	case G_AT_FIELD_STRING:
+		return parse_field_string(line, pos, len, out + field->offset,
+						field->size);
+	case G_AT_FIELD_UNQUOTED_STRING:
+		return parse_field_unquoted_string(line, pos, len,
+						out + field->offset,
+						field->size);
+	case G_AT_FIELD_SKIP:
+		end = skip_until(line, pos, ',');
+
+		if (end == pos && line[end] != ',')
+			return -1;
+
+		return end;
+	}
+
+	return -1;
+}
+
+static gint parse_fields(const char *line, int pos,
+				const GAtGrammar *grammar, gpointer out)
+{
+	int len = strlen(line);
+	guint i;
+
+	while (pos < len && line[pos] == ' ')
+		pos += 1;
+
+	for (i = 0; i < grammar->num_fields; i++) {
+		const GAtField *field = &grammar->fields[i];
+		int end = -1;
+
+		if (pos < len)
+			end = parse_field(line, pos, len, field, out);
+
+		if (end < 0)
+			return (field->flags & G_AT_FIELD_OPTIONAL) ? i : -1;
+
+		pos = skip_to_next_field(line, end, len);
+	}
+
+	return i;
+}
+
+/*
+ * Parses the fields of a single response line starting with prefix into
+ * out, as described by grammar.  Returns the number of fields parsed, or
+ * -1 if the prefix doesn't match or a mandatory field is missing, in which
+ * case out may have been partially written.
+ */
+gint g_at_result_parse_line(const char *line, const char *prefix,
+				const GAtGrammar *grammar, gpointer out)
+{
+	int prefix_len = prefix ? strlen(prefix) : 0;
+
+	if (line == NULL || grammar == NULL)
+		return -1;
+
+	if (prefix_len && strncmp(line, prefix, prefix_len))
+		return -1;
+
+	return parse_fields(line, prefix_len, grammar, out);
+}
+
+/*
+ * Moves to the next line starting with prefix that has all the mandatory
+ * fields of grammar and parses it into out, without copying it.  Lines
+ * that don't parse are skipped.  The whole line is consumed, so only
+ * g_at_result_iter_next and g_at_result_iter_parse make sense after it.
+ * Returns the number of fields parsed, -1 once out of lines.
+ */
+gint g_at_result_iter_parse(GAtResultIter *iter, const char *prefix,
+				const GAtGrammar *grammar, gpointer out)
+{
+	int prefix_len = prefix ? strlen(prefix) : 0;
+	const char *line;
+	gint r;
+
+	if (iter == NULL || grammar == NULL)
+		return -1;
+
+	if (iter->l == NULL)
+		return -1;
+
+	while ((iter->l = iter->l->next)) {
+		line = iter->l->data;
+
+		if (prefix_len && strncmp(line, prefix, prefix_len))
+			continue;
+
+		r = parse_fields(line, prefix_len, grammar, out);
+		if (r < 0)
+			continue;
+
+		iter->line_pos = strlen(line);
+		return r;
+	}
+
+	return -1;
+}
+
 const char *g_at_result_final_response(GAtResult *result)
 {
 	if (result == NULL)
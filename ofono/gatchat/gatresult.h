@@ -45,6 +45,50 @@ struct _GAtResultIter {
 
 typedef struct _GAtResultIter GAtResultIter;
 
+/*
+ * Static description of the fields of a response line, for parsing it in
+ * one pass straight into a struct.  Numbers and HEX fields are stored in
+ * gint members, strings are copied (truncated if need be) into char array
+ * members.  HEX is a quoted hexadecimal number, e.g. the <lac> of +CREG.
+ */
+enum _GAtFieldType {
+	G_AT_FIELD_NUMBER,
+	G_AT_FIELD_HEX,
+	G_AT_FIELD_STRING,
+	G_AT_FIELD_UNQUOTED_STRING,
+	G_AT_FIELD_SKIP,
+};
+
+typedef enum _GAtFieldType GAtFieldType;
+
+/*
+ * An optional field that is absent or can't be parsed ends the line, it
+ * and all the fields after it are left untouched
+ */
+#define G_AT_FIELD_OPTIONAL	0x01
+
+struct _GAtField {
+	guint8 type;
+	guint8 flags;
+	guint16 offset;
+	guint16 size;
+};
+
+typedef struct _GAtField GAtField;
+
+#define G_AT_FIELD(type, flags, st, member)				\
+	{ G_AT_FIELD_##type, flags, G_STRUCT_OFFSET(st, member),	\
+		sizeof(((st *) 0)->member) }
+
+struct _GAtGrammar {
+	guint num_fields;
+	const GAtField *fields;
+};
+
+typedef struct _GAtGrammar GAtGrammar;
+
+#define G_AT_GRAMMAR(fields) { G_N_ELEMENTS(fields), fields }
+
 void g_at_result_iter_init(GAtResultIter *iter, GAtResult *result);
 
 gboolean g_at_result_iter_next(GAtResultIter *iter, const char *prefix);
@@ -63,6 +107,11 @@ gboolean g_at_result_iter_next_number_default(GAtResultIter *iter, gint dflt,
 gboolean g_at_result_iter_next_hexstring(GAtResultIter *iter,
 		const guint8 **str, gint *length);
 
+gint g_at_result_iter_parse(GAtResultIter *iter, const char *prefix,
+				const GAtGrammar *grammar, gpointer out);
+gint g_at_result_parse_line(const char *line, const char *prefix,
+				const GAtGrammar *grammar, gpointer out);
+
 const char *g_at_result_iter_raw_line(GAtResultIter *iter);
 
 const char *g_at_result_final_response(GAtResult *result);
@@ -26,6 +26,8 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
+#include <sys/uio.h>
 
 #include <glib.h>
 
@@ -36,6 +38,8 @@
 #define BUF_SIZE 4096
 /* <cr><lf> + the max length of information text + <cr><lf> */
 #define MAX_TEXT_SIZE 2052
+/* Two segments per queued ring buffer */
+#define MAX_WRITE_IOV 16
 /* #define WRITE_SCHEDULER_DEBUG 1 */
 
 enum ParserState {
@@ -1110,55 +1114,81 @@ static void new_bytes(struct ring_buffer *rbuf, gpointer user_data)
 static gboolean can_write_data(gpointer data)
 {
 	GAtServer *server = data;
-	gsize bytes_written;
-	gsize towrite;
+	struct iovec iov[MAX_WRITE_IOV];
 	struct ring_buffer *write_buf;
-	unsigned char *buf;
+	gsize bytes_written;
+	GList *l;
+	int iovcnt = 0;
 #ifdef WRITE_SCHEDULER_DEBUG
-	int limiter;
+	gsize limiter = 5;
 #endif
 
 	if (!server->write_queue)
 		return FALSE;
 
-	/* Write data out from the head of the queue */
-	write_buf = g_queue_peek_head(server->write_queue);
+	/*
+	 * Gather everything queued since the last wakeup, both halves of
+	 * each ring buffer, so that a burst of results and unsolicited
+	 * lines goes out in a single syscall.
+	 */
+	for (l = server->write_queue->head; l && iovcnt + 2 <= MAX_WRITE_IOV;
+								l = l->next) {
+		int len, len_no_wrap;
+
+		write_buf = l->data;
+		len = ring_buffer_len(write_buf);
+		len_no_wrap = ring_buffer_len_no_wrap(write_buf);
 
-	buf = ring_buffer_read_ptr(write_buf, 0);
+		if (len == 0)
+			continue;
 
-	towrite = ring_buffer_len_no_wrap(write_buf);
+		iov[iovcnt].iov_base = ring_buffer_read_ptr(write_buf, 0);
+		iov[iovcnt].iov_len = len_no_wrap;
+		iovcnt++;
 
-#ifdef WRITE_SCHEDULER_DEBUG
-	limiter = towrite;
+		if (len > len_no_wrap) {
+			iov[iovcnt].iov_base =
+				ring_buffer_read_ptr(write_buf, len_no_wrap);
+			iov[iovcnt].iov_len = len - len_no_wrap;
+			iovcnt++;
+		}
+	}
 
-	if (limiter > 5)
-		limiter = 5;
-#endif
+	if (iovcnt == 0)
+		return FALSE;
 
-	bytes_written = g_at_io_write(server->io,
-			(char *)buf,
 #ifdef WRITE_SCHEDULER_DEBUG
-			limiter
-#else
-			towrite
+	iovcnt = 1;
+
+	if (iov[0].iov_len > limiter)
+		iov[0].iov_len = limiter;
 #endif
-			);
+
+	bytes_written = g_at_io_writev(server->io, iov, iovcnt);
 
 	if (bytes_written == 0)
-		return FALSE;
+		return errno == EAGAIN;
 
-	ring_buffer_drain(write_buf, bytes_written);
+	/* Drain what was written, freeing every buffer but the last */
+	while (bytes_written > 0) {
+		gsize len;
+
+		write_buf = g_queue_peek_head(server->write_queue);
+		len = MIN((gsize) ring_buffer_len(write_buf), bytes_written);
+
+		ring_buffer_drain(write_buf, len);
+		bytes_written -= len;
+
+		if (ring_buffer_len(write_buf) > 0 ||
+				g_queue_get_length(server->write_queue) == 1)
+			break;
 
-	/* All data in current buffer is written, free it
-	 * unless it's the last buffer in the queue.
-	 */
-	if ((ring_buffer_len(write_buf) == 0) &&
-			(g_queue_get_length(server->write_queue) > 1)) {
 		write_buf = g_queue_pop_head(server->write_queue);
 		ring_buffer_free(write_buf);
-		write_buf = g_queue_peek_head(server->write_queue);
 	}
 
+	write_buf = g_queue_peek_head(server->write_queue);
+
 	if (ring_buffer_len(write_buf) > 0)
 		return TRUE;
 
@@ -31,6 +31,19 @@
 
 #include "gatutil.h"
 
+static GAtTraceFunc trace_func;
+
+void g_at_util_set_trace_func(GAtTraceFunc func)
+{
+	trace_func = func;
+}
+
+void g_at_util_trace(gpointer io, gboolean in, const void *data, gsize len)
+{
+	if (trace_func && len)
+		trace_func(io, in, data, len);
+}
+
 void g_at_util_debug_chat(gboolean in, const char *str, gsize len,
 				GAtDebugFunc debugf, gpointer user_data)
 {
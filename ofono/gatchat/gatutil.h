@@ -39,6 +39,16 @@ void g_at_util_debug_hexdump(gboolean in, const unsigned char *buf, gsize len,
 
 gboolean g_at_util_setup_io(GIOChannel *io, GIOFlags flags);
 
+/*
+ * Process wide hook that gets to see all the raw data going through
+ * GAtIO, whether or not debugging is enabled for the channel.
+ */
+typedef void (*GAtTraceFunc)(gpointer io, gboolean in, const void *data,
+								gsize len);
+
+void g_at_util_set_trace_func(GAtTraceFunc func);
+void g_at_util_trace(gpointer io, gboolean in, const void *data, gsize len);
+
 #ifdef __cplusplus
 }
 #endif
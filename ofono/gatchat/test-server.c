@@ -45,6 +45,7 @@
 #include <sys/stat.h>
 
 #include "gatserver.h"
+#include "gatio.h"
 #include "gatppp.h"
 #include "ringbuffer.h"
 
@@ -1033,6 +1034,78 @@ static gboolean create_unix(const char *modem_path, const char *sock_path)
 	return TRUE;
 }
 
+#define BATCH_LINES 400
+
+/*
+ * Queue a burst of unsolicited results within one main loop iteration,
+ * spanning several write buffers, and check that it reaches the peer of
+ * a socketpair intact in a single write.
+ */
+static gboolean test_batching(void)
+{
+	GString *expected = g_string_new(NULL);
+	GIOChannel *io;
+	GAtServer *server;
+	char buf[1024];
+	GString *received = g_string_new(NULL);
+	guint64 bytes;
+	guint calls;
+	gboolean ok;
+	int sv[2];
+	int i;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+		g_print("Can't create socketpair: %s (%d)\n",
+						strerror(errno), errno);
+		return FALSE;
+	}
+
+	io = g_io_channel_unix_new(sv[0]);
+	g_io_channel_set_close_on_unref(io, TRUE);
+	server = g_at_server_new(io);
+	g_io_channel_unref(io);
+
+	if (server == NULL) {
+		close(sv[1]);
+		return FALSE;
+	}
+
+	for (i = 0; i < BATCH_LINES; i++) {
+		char line[32];
+
+		sprintf(line, "+CIEV: %d,%d", i % 7 + 1, i % 2);
+		g_at_server_send_unsolicited(server, line);
+		g_string_append_printf(expected, "\r\n%s\r\n", line);
+	}
+
+	g_at_server_send_unsolicited(server, "RING");
+	g_string_append(expected, "\r\nRING\r\n");
+
+	for (i = 0; i < 100 && received->len < expected->len; i++) {
+		ssize_t len;
+
+		g_main_context_iteration(NULL, FALSE);
+
+		while ((len = recv(sv[1], buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+			g_string_append_len(received, buf, len);
+	}
+
+	g_at_io_get_write_stats(g_at_server_get_io(server), &calls, &bytes);
+
+	g_print("%u bytes in %u writes\n", (unsigned int) bytes, calls);
+
+	ok = received->len == expected->len &&
+		!memcmp(received->str, expected->str, expected->len) &&
+		bytes == expected->len && calls == 1;
+
+	g_at_server_unref(server);
+	close(sv[1]);
+	g_string_free(received, TRUE);
+	g_string_free(expected, TRUE);
+
+	return ok;
+}
+
 static void test_server(int type)
 {
 	switch (type) {
@@ -1050,6 +1123,8 @@ static void test_server(int type)
 		if (create_unix("/phonesim1", DEFAULT_SOCK_PATH) == FALSE)
 			exit(1);
 		break;
+	case 3:
+		exit(test_batching() ? 0 : 1);
 	}
 }
 
@@ -1126,7 +1201,8 @@ static void usage(void)
 	g_print("Types:\n"
 		"\t0: Pseudo TTY port (default)\n"
 		"\t1: TCP sock at port 12346)\n"
-		"\t2: Unix sock at ./server_sock\n");
+		"\t2: Unix sock at ./server_sock\n"
+		"\t3: Check write batching over a socketpair\n");
 }
 
 int main(int argc, char **argv)
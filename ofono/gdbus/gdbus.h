@@ -74,6 +74,9 @@ typedef gboolean (*GDBusPropertyGetter)(const GDBusPropertyTable *property,
 
 typedef guint32 GDBusPendingPropertySet;
 
+typedef void (*GDBusAppendPropertiesFunction)(const char *path,
+				const char *interface, DBusMessageIter *dict);
+
 typedef void (*GDBusPropertySetter)(const GDBusPropertyTable *property,
 			DBusMessageIter *value, GDBusPendingPropertySet id,
 			void *data);
@@ -217,6 +220,8 @@ struct GDBusSecurityTable {
 
 void g_dbus_set_flags(int flags);
 int g_dbus_get_flags(void);
+void g_dbus_set_append_properties_function(
+				GDBusAppendPropertiesFunction function);
 
 gboolean g_dbus_register_interface(DBusConnection *connection,
 					const char *path, const char *name,
@@ -86,6 +86,7 @@ struct property_data {
 
 static int global_flags = 0;
 static struct generic_data *root;
+static GDBusAppendPropertiesFunction append_properties_function;
 static GSList *pending = NULL;
 
 static gboolean process_changes(gpointer user_data);
@@ -514,7 +515,7 @@ static void append_property(struct interface_data *iface,
 }
 
 static void append_properties(struct interface_data *data,
-							DBusMessageIter *iter)
+				const char *path, DBusMessageIter *iter)
 {
 	DBusMessageIter dict;
 	const GDBusPropertyTable *p;
@@ -539,19 +540,22 @@ static void append_properties(struct interface_data *data,
 		append_property(data, p, &dict);
 	}
 
+	/* Interfaces without a property table may provide their own */
+	if (data->properties == NULL && append_properties_function)
+		append_properties_function(path, data->name, &dict);
+
 	dbus_message_iter_close_container(iter, &dict);
 }
 
-static void append_interface(gpointer data, gpointer user_data)
+static void append_interface(struct interface_data *iface, const char *path,
+							DBusMessageIter *array)
 {
-	struct interface_data *iface = data;
-	DBusMessageIter *array = user_data;
 	DBusMessageIter entry;
 
 	dbus_message_iter_open_container(array, DBUS_TYPE_DICT_ENTRY, NULL,
 								&entry);
 	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &iface->name);
-	append_properties(data, &entry);
+	append_properties(iface, path, &entry);
 	dbus_message_iter_close_container(array, &entry);
 }
 
@@ -559,6 +563,7 @@ static void emit_interfaces_added(struct generic_data *data)
 {
 	DBusMessage *signal;
 	DBusMessageIter iter, array;
+	GSList *l;
 
 	if (root == NULL || data == root)
 		return;
@@ -583,7 +588,9 @@ static void emit_interfaces_added(struct generic_data *data)
 				DBUS_DICT_ENTRY_END_CHAR_AS_STRING
 				DBUS_DICT_ENTRY_END_CHAR_AS_STRING, &array);
 
-	g_slist_foreach(data->added, append_interface, &array);
+	for (l = data->added; l; l = l->next)
+		append_interface(l->data, data->path, &array);
+
 	g_slist_free(data->added);
 	data->added = NULL;
 
@@ -831,7 +838,7 @@ static DBusMessage *properties_get_all(DBusConnection *connection,
 
 	dbus_message_iter_init_append(reply, &iter);
 
-	append_properties(iface, &iter);
+	append_properties(iface, data->path, &iter);
 
 	return reply;
 }
@@ -1088,6 +1095,7 @@ static const GDBusMethodTable introspect_methods[] = {
 static void append_interfaces(struct generic_data *data, DBusMessageIter *iter)
 {
 	DBusMessageIter array;
+	GSList *l;
 
 	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
 				DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
@@ -1099,7 +1107,8 @@ static void append_interfaces(struct generic_data *data, DBusMessageIter *iter)
 				DBUS_DICT_ENTRY_END_CHAR_AS_STRING
 				DBUS_DICT_ENTRY_END_CHAR_AS_STRING, &array);
 
-	g_slist_foreach(data->interfaces, append_interface, &array);
+	for (l = data->interfaces; l; l = l->next)
+		append_interface(l->data, data->path, &array);
 
 	dbus_message_iter_close_container(iter, &array);
 }
@@ -1780,7 +1789,7 @@ gboolean g_dbus_get_properties(DBusConnection *connection, const char *path,
 	if (iface == NULL)
 		return FALSE;
 
-	append_properties(iface, iter);
+	append_properties(iface, path, iter);
 
 	return TRUE;
 }
@@ -1812,6 +1821,12 @@ gboolean g_dbus_detach_object_manager(DBusConnection *connection)
 	return TRUE;
 }
 
+void g_dbus_set_append_properties_function(
+				GDBusAppendPropertiesFunction function)
+{
+	append_properties_function = function;
+}
+
 void g_dbus_set_flags(int flags)
 {
 	global_flags = flags;
@@ -86,7 +86,6 @@ struct ril_s {
 	GHashTable *notify_list;		/* List of notification reg */
 	GRilDisconnectFunc user_disconnect;	/* user disconnect func */
 	gpointer user_disconnect_data;		/* user disconnect data */
-	guint read_so_far;			/* Number of bytes processed */
 	gboolean suspended;			/* Are we suspended? */
 	gboolean debug;
 	gboolean trace;
@@ -98,6 +97,7 @@ struct ril_s {
 	int slot;
 	GRilMsgIdToStrFunc req_to_string;
 	GRilMsgIdToStrFunc unsol_to_string;
+	guchar scratch[GRIL_BUFFER_SIZE];	/* Wrapped records */
 };
 
 struct _GRil {
@@ -456,69 +456,48 @@ static void handle_unsol_req(struct ril_s *p, struct ril_msg *message)
 
 static void dispatch(struct ril_s *p, struct ril_msg *message)
 {
-	int32_t *unsolicited_field, *id_num_field;
-	gchar *bufp = message->buf;
-	gchar *datap;
-	gsize data_len;
+	const gchar *bufp = message->buf;
+	gsize header_len;
 
-	/* This could be done with a struct/union... */
-	unsolicited_field = (int32_t *) (void *) bufp;
-	if (*unsolicited_field)
-		message->unsolicited = TRUE;
-	else
-		message->unsolicited = FALSE;
+	/* A record holds at least the unsolicited and req/serial fields */
+	if (message->buf_len < 8)
+		goto malformed;
 
+	/* This could be done with a struct/union... */
+	message->unsolicited = *((const int32_t *) (const void *) bufp) != 0;
 	bufp += 4;
 
-	id_num_field = (int32_t *) (void *) bufp;
 	if (message->unsolicited) {
-		message->req = (int) *id_num_field;
+		message->req = *((const int32_t *) (const void *) bufp);
 
 		/*
 		 * A RIL Unsolicited Event is two UINT32 fields ( unsolicited,
-		 * and req/ev ), so subtract the length of the header from the
-		 * overall length to calculate the length of the Event Data.
+		 * and req/ev ) followed by the Event Data.
 		 */
-		data_len = message->buf_len - 8;
+		header_len = 8;
 	} else {
-		message->serial_no = (int) *id_num_field;
-
-		bufp += 4;
-		message->error = *((int32_t *) (void *) bufp);
-
 		/*
 		 * A RIL Solicited Response is three UINT32 fields ( unsolicied,
-		 * serial_no and error ), so subtract the length of the header
-		 * from the overall length to calculate the length of the Event
-		 * Data.
+		 * serial_no and error ) followed by the Event Data.
 		 */
-		data_len = message->buf_len - 12;
-	}
+		header_len = 12;
 
-	/* advance to start of data.. */
-	bufp += 4;
+		if (message->buf_len < header_len)
+			goto malformed;
+
+		message->serial_no = *((const int32_t *) (const void *) bufp);
+		bufp += 4;
+		message->error = *((const int32_t *) (const void *) bufp);
+	}
 
 	/*
-	 * Now, use buffer for event data if present
+	 * The event data is parsed in place, handlers must not keep
+	 * message->buf around after they return.
 	 */
-	if (data_len) {
-		datap = g_try_malloc(data_len);
-		if (datap == NULL)
-			goto error;
-
-		/* Copy event bytes from message->buf into new buffer */
-		memcpy(datap, bufp, data_len);
-
-		/* Free buffer that includes header */
-		g_free(message->buf);
-
-		/* ...and replace with new buffer */
-		message->buf = datap;
-		message->buf_len = data_len;
+	if (message->buf_len > header_len) {
+		message->buf += header_len;
+		message->buf_len -= header_len;
 	} else {
-		/* Free buffer that includes header */
-		g_free(message->buf);
-
 		/* To know if there was no data when parsing */
 		message->buf = NULL;
 		message->buf_len = 0;
@@ -529,20 +508,60 @@ static void dispatch(struct ril_s *p, struct ril_msg *message)
 	else
 		handle_response(p, message);
 
-error:
-	g_free(message->buf);
-	g_free(message);
+	return;
+
+malformed:
+	ofono_error("Malformed RIL record of %u bytes", message->buf_len);
 }
 
-static struct ril_msg *read_fixed_record(struct ril_s *p,
-						const guchar *bytes, gsize *len)
+/*
+ * Returns a pointer to len bytes of the ring buffer starting at offset.
+ * Most of the time these are contiguous and 4-byte aligned and we can
+ * point straight into the ring buffer, otherwise they are assembled in
+ * the scratch buffer.
+ */
+static const guchar *ring_buffer_peek(struct ring_buffer *rbuf,
+					unsigned int offset, unsigned int len,
+					guchar *scratch)
 {
-	struct ril_msg *message;
-	unsigned message_len, plen;
+	unsigned int wrap = ring_buffer_len_no_wrap(rbuf);
+	const guchar *bytes = ring_buffer_read_ptr(rbuf, offset);
+	unsigned int head;
+
+	if (offset >= wrap || offset + len <= wrap) {
+		if (((uintptr_t) bytes & 3) == 0)
+			return bytes;
+
+		memcpy(scratch, bytes, len);
+		return scratch;
+	}
+
+	head = wrap - offset;
+	memcpy(scratch, bytes, head);
+	memcpy(scratch + head, ring_buffer_read_ptr(rbuf, wrap), len - head);
+
+	return scratch;
+}
+
+/*
+ * Looks for the next complete fixed length record in the ring buffer.
+ * On success fills in message (which points to the record bytes, not
+ * a copy) and returns the number of bytes to drain once the record has
+ * been dispatched.  Returns 0 if the record is not complete yet.
+ */
+static unsigned int read_fixed_record(struct ril_s *p,
+					struct ring_buffer *rbuf,
+					struct ril_msg *message)
+{
+	unsigned int len = ring_buffer_len(rbuf);
+	uint32_t plen;
+
+	if (len < 4)
+		return 0;
 
 	/* First four bytes are length in TCP byte order (Big Endian) */
-	plen = ntohl(*((uint32_t *) (void *) bytes));
-	bytes += 4;
+	memcpy(&plen, ring_buffer_peek(rbuf, 0, 4, p->scratch), 4);
+	plen = ntohl(plen);
 
 	/*
 	 * TODO: Verify that 8k is the max message size from rild.
@@ -562,74 +581,34 @@ static struct ril_msg *read_fixed_record(struct ril_s *p,
 
 	/*
 	 * If we don't have the whole fixed record in the ringbuffer
-	 * then return NULL & leave ringbuffer as is.
+	 * then leave ringbuffer as is and wait for the rest.
 	 */
+	if (len - 4 < plen)
+		return 0;
 
-	message_len = *len - 4;
-	if (message_len < plen)
-		return NULL;
-
-	message = g_malloc(sizeof(struct ril_msg));
-
-	/* allocate ril_msg->buffer */
+	memset(message, 0, sizeof(*message));
+	message->buf = (gchar *) ring_buffer_peek(rbuf, 4, plen, p->scratch);
 	message->buf_len = plen;
-	message->buf = g_malloc(plen);
 
-	/* Copy bytes into message buffer */
-	memmove(message->buf, (const void *) bytes, plen);
-
-	/* Indicate to caller size of record we extracted */
-	*len = plen + 4;
-	return message;
+	return plen + 4;
 }
 
 static void new_bytes(struct ring_buffer *rbuf, gpointer user_data)
 {
-	struct ril_msg *message;
 	struct ril_s *p = user_data;
-	unsigned int len = ring_buffer_len(rbuf);
-	unsigned int wrap = ring_buffer_len_no_wrap(rbuf);
-	guchar *buf = ring_buffer_read_ptr(rbuf, p->read_so_far);
+	struct ril_msg message;
+	unsigned int record_len;
 
 	p->in_read_handler = TRUE;
 
-	while (p->suspended == FALSE && (p->read_so_far < len)) {
-		gsize rbytes = MIN(len - p->read_so_far, wrap - p->read_so_far);
-
-		if (rbytes < 4) {
-			DBG("Not enough bytes for header length: len: %d", len);
-			return;
-		}
-
-		/*
-		 * This function attempts to read the next full length
-		 * fixed message from the stream.  if not all bytes are
-		 * available, it returns NULL.  otherwise it allocates
-		 * and returns a ril_message with the copied bytes, and
-		 * drains those bytes from the ring_buffer
-		 */
-		message = read_fixed_record(p, buf, &rbytes);
-
-		/* wait for the rest of the record... */
-		if (message == NULL)
-			break;
-
-		buf += rbytes;
-		p->read_so_far += rbytes;
-
-		/* TODO: need to better understand how wrap works! */
-		if (p->read_so_far == wrap) {
-			buf = ring_buffer_read_ptr(rbuf, p->read_so_far);
-			wrap = len;
-		}
-
-		dispatch(p, message);
-
-		ring_buffer_drain(rbuf, p->read_so_far);
-
-		len -= p->read_so_far;
-		wrap -= p->read_so_far;
-		p->read_so_far = 0;
+	/*
+	 * Each record is dispatched straight from the ring buffer and
+	 * drained afterwards, there's no per-message allocation.
+	 */
+	while (p->suspended == FALSE &&
+			(record_len = read_fixed_record(p, rbuf, &message))) {
+		dispatch(p, &message);
+		ring_buffer_drain(rbuf, record_len);
 	}
 
 	p->in_read_handler = FALSE;
@@ -84,6 +84,7 @@ enum ofono_dbus_access_voicecallmgr_method {
 enum ofono_dbus_access_connctx_method {
 	OFONO_DBUS_ACCESS_CONNCTX_SET_PROPERTY,
 	OFONO_DBUS_ACCESS_CONNCTX_PROVISION_CONTEXT,
+	OFONO_DBUS_ACCESS_CONNCTX_RESET_COUNTERS,
 	OFONO_DBUS_ACCESS_CONNCTX_METHOD_COUNT
 };
 
@@ -103,6 +104,7 @@ enum ofono_dbus_access_simmgr_method {
 	OFONO_DBUS_ACCESS_SIMMGR_RESET_PIN,
 	OFONO_DBUS_ACCESS_SIMMGR_LOCK_PIN,
 	OFONO_DBUS_ACCESS_SIMMGR_UNLOCK_PIN,
+	OFONO_DBUS_ACCESS_SIMMGR_READ_FILE,
 	OFONO_DBUS_ACCESS_SIMMGR_METHOD_COUNT
 };
 
@@ -147,6 +149,13 @@ int ofono_dbus_access_plugin_register
 void ofono_dbus_access_plugin_unregister
 			(const struct ofono_dbus_access_plugin *plugin);
 
+/*
+ * Verdicts are cached per sender until the sender leaves the bus.
+ * Plugins must call ofono_dbus_access_invalidate() whenever their
+ * policy changes, e.g. after reloading the configuration.
+ */
+void ofono_dbus_access_invalidate(void);
+
 const char *ofono_dbus_access_intf_name(enum ofono_dbus_access_intf intf);
 const char *ofono_dbus_access_method_name(enum ofono_dbus_access_intf intf,
 								int method);
@@ -0,0 +1,52 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifndef __OFONO_DEVMON_H
+#define __OFONO_DEVMON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <ofono/types.h>
+
+/*
+ * Classes of modem indications that nobody needs while the device is
+ * idle.  The device monitor decides which of them are muted, drivers
+ * that can turn them off in the modem are told through their atom's
+ * driver ops.
+ */
+enum ofono_devmon_ind {
+	OFONO_DEVMON_IND_SIGNAL_STRENGTH =	0x01,
+	OFONO_DEVMON_IND_LOCATION =		0x02,	/* LAC/CI updates */
+	OFONO_DEVMON_IND_CELL_INFO =		0x04,	/* RF and cell data */
+};
+
+#define OFONO_DEVMON_IND_ALL	(OFONO_DEVMON_IND_SIGNAL_STRENGTH | \
+				OFONO_DEVMON_IND_LOCATION | \
+				OFONO_DEVMON_IND_CELL_INFO)
+
+unsigned int ofono_devmon_get_muted(void);
+
+/* Called by drivers for each registration or signal indication */
+void ofono_devmon_indication_notify(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OFONO_DEVMON_H */
@@ -114,8 +114,19 @@ void ofono_gprs_context_set_type(struct ofono_gprs_context *gc,
 enum ofono_gprs_context_type ofono_gprs_context_get_type(
 						struct ofono_gprs_context *gc);
 
+/*
+ * Drivers that can't handle more than one activation or deactivation
+ * at a time across all gprs-context atoms of the modem (for example,
+ * because they share a single control channel that can't interleave
+ * them) set this, and the core feeds them one request at a time.
+ */
+void ofono_gprs_context_set_serialized(struct ofono_gprs_context *gc,
+						ofono_bool_t serialized);
+
 void ofono_gprs_context_set_interface(struct ofono_gprs_context *gc,
 					const char *interface);
+void ofono_gprs_context_set_mtu(struct ofono_gprs_context *gc,
+					unsigned int mtu);
 
 void ofono_gprs_context_set_ipv4_address(struct ofono_gprs_context *gc,
 						const char *address,
@@ -40,7 +40,7 @@ typedef void (*ofono_gprs_filter_check_cb_t)(ofono_bool_t allow, void *data);
  * even if struct ofono_gprs_filter gets extended with new callbacks.
  */
 
-#define OFONO_GPRS_FILTER_API_VERSION      (1)
+#define OFONO_GPRS_FILTER_API_VERSION      (2)
 
 /*
  * The filter callbacks either invoke the completion callback directly
@@ -50,6 +50,10 @@ typedef void (*ofono_gprs_filter_check_cb_t)(ofono_bool_t allow, void *data);
  * operation is cancelled, the associated completion callback must not
  * be invoked.
  *
+ * filter_activate_sync only allows or rejects the context, it can't
+ * change its settings the way filter_activate can. Either _sync callback
+ * is preferred over its asynchronous counterpart when both are set.
+ *
  * Please avoid making blocking D-Bus calls from the filter callbacks.
  */
 struct ofono_gprs_filter {
@@ -64,6 +68,10 @@ struct ofono_gprs_filter {
 	/* API version 1 */
 	unsigned int (*filter_check)(struct ofono_gprs *gprs,
 				ofono_gprs_filter_check_cb_t cb, void *data);
+	/* API version 2 */
+	ofono_bool_t (*filter_activate_sync)(struct ofono_gprs_context *gc,
+				const struct ofono_gprs_primary_context *ctx);
+	ofono_bool_t (*filter_check_sync)(struct ofono_gprs *gprs);
 };
 
 int ofono_gprs_filter_register(const struct ofono_gprs_filter *filter);
@@ -54,6 +54,7 @@ struct ofono_debug_desc {
 #define OFONO_DEBUG_FLAG_DEFAULT (0)
 #define OFONO_DEBUG_FLAG_PRINT   (1 << 0)
 #define OFONO_DEBUG_FLAG_HIDE_NAME (1 << 1)
+#define OFONO_DEBUG_FLAG_TRACE   (1 << 2)
 	unsigned int flags;
 	void (*notify)(struct ofono_debug_desc* desc);
 } __attribute__((aligned(OFONO_DEBUG_ALIGN)));
@@ -70,7 +71,8 @@ struct ofono_debug_desc {
 	static struct ofono_debug_desc __ofono_debug_desc OFONO_DEBUG_ATTR = { \
 		.file = __FILE__, .flags = OFONO_DEBUG_FLAG_DEFAULT, \
 	}; \
-	if (__ofono_debug_desc.flags & OFONO_DEBUG_FLAG_PRINT) \
+	if (__ofono_debug_desc.flags & \
+			(OFONO_DEBUG_FLAG_PRINT | OFONO_DEBUG_FLAG_TRACE)) \
 		ofono_dbg(&__ofono_debug_desc, "%s() " fmt, \
 					 __FUNCTION__ , ## arg); \
 } while (0)
@@ -79,6 +81,13 @@ extern void ofono_dbg(const struct ofono_debug_desc *desc,
 				const char *format, ...)
 				__attribute__((format(printf, 2, 3)));
 
+/*
+ * Records raw transport data in the trace ring, if there is one.  The
+ * channel pointer is only used to tell the transports apart.
+ */
+extern void ofono_trace_data(const void *channel, int in, const void *data,
+							unsigned int len);
+
 typedef void (*ofono_log_hook_cb_t)(const struct ofono_debug_desc *desc,
 			int priority, const char *format, va_list va);
 
@@ -43,6 +43,8 @@ struct ofono_netmon_driver {
 					unsigned int enable,
 					unsigned int period,
 					ofono_netmon_cb_t cb, void *data);
+	void (*request_cell_list)(struct ofono_netmon *netmon,
+					ofono_netmon_cb_t cb, void *data);
 };
 
 enum ofono_netmon_cell_type {
@@ -70,6 +72,8 @@ enum ofono_netmon_info {
 	OFONO_NETMON_INFO_EARFCN, /* int */
 	OFONO_NETMON_INFO_EBAND, /* int */
 	OFONO_NETMON_INFO_CQI, /* int */
+	OFONO_NETMON_INFO_PCI, /* int */
+	OFONO_NETMON_INFO_TAC, /* int */
 	OFONO_NETMON_INFO_INVALID,
 };
 
@@ -83,11 +87,22 @@ enum ofono_netmon_info {
  *					OFONO_NETMON_INFO_RSSI, rssi,
  *					OFONO_NETMON_INFO_RXLEV, rxlev,
  *					OFONO_NETMON_INFO_INVALID);
+ *
+ * Answers request_update, or reports a periodic update to the agent.
  */
 void ofono_netmon_serving_cell_notify(struct ofono_netmon *netmon,
 					enum ofono_netmon_cell_type type,
 					int info_type, ...);
 
+/*
+ * Same arguments as above, for a cell reported from request_cell_list,
+ * be it the serving cell or one the modem can see but is not camped on.
+ */
+void ofono_netmon_cell_list_notify(struct ofono_netmon *netmon,
+					ofono_bool_t serving,
+					enum ofono_netmon_cell_type type,
+					int info_type, ...);
+
 int ofono_netmon_driver_register(const struct ofono_netmon_driver *d);
 
 void ofono_netmon_driver_unregister(const struct ofono_netmon_driver *d);
@@ -62,6 +62,17 @@ typedef void (*ofono_netreg_status_cb_t)(const struct ofono_error *error,
 typedef void (*ofono_netreg_strength_cb_t)(const struct ofono_error *error,
 						int strength, void *data);
 
+/*
+ * Limits on which signal strength changes are worth reporting.  The core
+ * applies them to whatever the driver notifies, drivers may additionally
+ * pass them on to the modem so that it wakes us up less often.
+ */
+struct ofono_netreg_strength_policy {
+	unsigned int hysteresis;	/* Percentage points, 0 for any */
+	unsigned int bars;		/* Report bar changes only, or 0 */
+	unsigned int interval;		/* Minimum seconds between reports */
+};
+
 /* Network related functions, including registration status, operator selection
  * and signal strength indicators.
  *
@@ -86,9 +97,15 @@ struct ofono_netreg_driver {
 				ofono_netreg_register_cb_t cb, void *data);
 	void (*strength)(struct ofono_netreg *netreg,
 			ofono_netreg_strength_cb_t, void *data);
+	void (*set_strength_policy)(struct ofono_netreg *netreg,
+			const struct ofono_netreg_strength_policy *policy);
+	/* Mask of enum ofono_devmon_ind the modem may stop reporting */
+	void (*mute_indications)(struct ofono_netreg *netreg,
+					unsigned int muted);
 };
 
 void ofono_netreg_strength_notify(struct ofono_netreg *netreg, int strength);
+unsigned int ofono_netreg_strength_bar(unsigned int bars, int strength);
 void ofono_netreg_status_notify(struct ofono_netreg *netreg, int status,
 					int lac, int ci, int tech);
 void ofono_netreg_time_notify(struct ofono_netreg *netreg,
@@ -124,7 +124,7 @@ typedef void (*ofono_sms_filter_recv_datagram_cb_t)
  * even if struct ofono_sms_filter gets extended with new callbacks.
  */
 
-#define OFONO_SMS_FILTER_API_VERSION      (0)
+#define OFONO_SMS_FILTER_API_VERSION      (1)
 
 /*
  * The filter callbacks either invoke the completion callback directly
@@ -138,6 +138,10 @@ typedef void (*ofono_sms_filter_recv_datagram_cb_t)
  * valid until the filter calls the completion callback. The completion
  * callback is never NULL.
  *
+ * A _sync callback returns the verdict right away and is used instead
+ * of its asynchronous counterpart. It can't modify the message. There
+ * is no _sync variant of filter_send_datagram.
+ *
  * Please avoid making blocking D-Bus calls from the filter callbacks.
  */
 struct ofono_sms_filter {
@@ -172,6 +176,25 @@ struct ofono_sms_filter {
 				ofono_sms_filter_recv_datagram_cb_t cb,
 				void *data);
 	void (*cancel)(unsigned int id);
+	/* API version 1 */
+	enum ofono_sms_filter_result (*filter_send_text_sync)
+				(struct ofono_modem *modem,
+				const struct ofono_sms_address *addr,
+				const char *message);
+	enum ofono_sms_filter_result (*filter_recv_text_sync)
+				(struct ofono_modem *modem,
+				const struct ofono_uuid *uuid,
+				const char *message,
+				enum ofono_sms_class cls,
+				const struct ofono_sms_address *addr,
+				const struct ofono_sms_scts *scts);
+	enum ofono_sms_filter_result (*filter_recv_datagram_sync)
+				(struct ofono_modem *modem,
+				const struct ofono_uuid *uuid,
+				int dst_port, int src_port,
+				const unsigned char *buf, unsigned int len,
+				const struct ofono_sms_address *addr,
+				const struct ofono_sms_scts *scts);
 };
 
 int ofono_sms_filter_register(const struct ofono_sms_filter *filter);
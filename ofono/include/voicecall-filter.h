@@ -81,7 +81,7 @@ typedef void (*ofono_voicecall_filter_incoming_cb_t)
  * even if struct ofono_voicecall_filter gets extended with new callbacks.
  */
 
-#define OFONO_VOICECALL_FILTER_API_VERSION      (0)
+#define OFONO_VOICECALL_FILTER_API_VERSION      (1)
 
 /*
  * The filter callbacks either invoke the completion callback directly
@@ -91,6 +91,9 @@ typedef void (*ofono_voicecall_filter_incoming_cb_t)
  * operation is cancelled, the associated completion callback must not
  * be invoked.
  *
+ * filter_dial_sync and filter_incoming_sync return the verdict directly
+ * and take precedence over filter_dial and filter_incoming.
+ *
  * Please avoid making blocking D-Bus calls from the filter callbacks.
  */
 struct ofono_voicecall_filter {
@@ -107,6 +110,14 @@ struct ofono_voicecall_filter {
 				const struct ofono_call *call,
 				ofono_voicecall_filter_incoming_cb_t cb,
 				void *data);
+	/* API version 1 */
+	enum ofono_voicecall_filter_dial_result (*filter_dial_sync)
+				(struct ofono_voicecall *vc,
+				const struct ofono_phone_number *number,
+				enum ofono_clir_option clir);
+	enum ofono_voicecall_filter_incoming_result (*filter_incoming_sync)
+				(struct ofono_voicecall *vc,
+				const struct ofono_call *call);
 };
 
 void ofono_voicecall_filter_notify(struct ofono_voicecall *vc);
@@ -80,6 +80,7 @@ struct phonesim_data {
 	GAtChat *chat;
 	gboolean calypso;
 	gboolean use_mux;
+	gboolean threaded;
 	gboolean hfp;
 	struct hfp_slc_info hfp_info;
 	unsigned int hfp_watch;
@@ -705,6 +706,10 @@ static int phonesim_enable(struct ofono_modem *modem)
 	if (!g_strcmp0(value, "internal"))
 		data->use_mux = TRUE;
 
+	/* The multiplexer channels are not backed by a file descriptor */
+	if (!data->use_mux)
+		data->threaded = ofono_modem_get_boolean(modem, "Threaded");
+
 	sk = connect_socket(address, port);
 	if (sk < 0)
 		return sk;
@@ -720,7 +725,10 @@ static int phonesim_enable(struct ofono_modem *modem)
 	else
 		syntax = g_at_syntax_new_gsmv1();
 
-	data->chat = g_at_chat_new(io, syntax);
+	if (data->threaded)
+		data->chat = g_at_chat_new_threaded(io, syntax);
+	else
+		data->chat = g_at_chat_new(io, syntax);
 
 	g_at_syntax_unref(syntax);
 	g_io_channel_unref(io);
@@ -894,6 +902,14 @@ static void phonesim_post_online(struct ofono_modem *modem)
 	gprs = ofono_gprs_create(modem, 0, "atmodem", data->chat);
 	gc2 = ofono_gprs_context_create(modem, 0, "phonesim", data->chat);
 
+	if (ofono_modem_get_boolean(modem, "SerializedContexts")) {
+		if (gc1)
+			ofono_gprs_context_set_serialized(gc1, TRUE);
+
+		if (gc2)
+			ofono_gprs_context_set_serialized(gc2, TRUE);
+	}
+
 	if (gprs && gc1)
 		ofono_gprs_add_context(gprs, gc1);
 
@@ -1041,13 +1057,14 @@ static struct ofono_modem_driver localhfp_driver = {
 	.pre_sim	= localhfp_pre_sim,
 };
 
-static struct ofono_modem *create_modem(GKeyFile *keyfile, const char *group)
+static struct ofono_modem *create_modem(GKeyFile *keyfile, const char *group,
+						const char *name)
 {
 	const char *driver = "phonesim";
 	struct ofono_modem *modem;
 	char *value;
 
-	DBG("group %s", group);
+	DBG("group %s name %s", group, name);
 
 	value = g_key_file_get_string(keyfile, group, "Modem", NULL);
 
@@ -1056,7 +1073,7 @@ static struct ofono_modem *create_modem(GKeyFile *keyfile, const char *group)
 
 	g_free(value);
 
-	modem = ofono_modem_create(group, driver);
+	modem = ofono_modem_create(name, driver);
 	if (modem == NULL)
 		return NULL;
 
@@ -1086,6 +1103,12 @@ static struct ofono_modem *create_modem(GKeyFile *keyfile, const char *group)
 		g_free(value);
 	}
 
+	if (g_key_file_get_boolean(keyfile, group, "Threaded", NULL))
+		ofono_modem_set_boolean(modem, "Threaded", TRUE);
+
+	if (g_key_file_get_boolean(keyfile, group, "SerializedContexts", NULL))
+		ofono_modem_set_boolean(modem, "SerializedContexts", TRUE);
+
 	DBG("%p", modem);
 
 	return modem;
@@ -1122,15 +1145,34 @@ static void parse_config(const char *filename)
 	modems = g_key_file_get_groups(keyfile, NULL);
 
 	for (i = 0; modems[i]; i++) {
-		struct ofono_modem *modem;
+		int n, instances;
+
+		instances = g_key_file_get_integer(keyfile, modems[i],
+							"Instances", NULL);
+
+		/*
+		 * Instances = N connects N independent modems to the
+		 * same phonesim server, named <group>, <group>_1 ...
+		 */
+		for (n = 0; n < MAX(instances, 1); n++) {
+			struct ofono_modem *modem;
+			char *name;
+
+			if (n == 0)
+				name = g_strdup(modems[i]);
+			else
+				name = g_strdup_printf("%s_%d", modems[i], n);
+
+			modem = create_modem(keyfile, modems[i], name);
+			g_free(name);
 
-		modem = create_modem(keyfile, modems[i]);
-		if (modem == NULL)
-			continue;
+			if (modem == NULL)
+				break;
 
-		modem_list = g_slist_prepend(modem_list, modem);
+			modem_list = g_slist_prepend(modem_list, modem);
 
-		ofono_modem_register(modem);
+			ofono_modem_register(modem);
+		}
 	}
 
 	g_strfreev(modems);
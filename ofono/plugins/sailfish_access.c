@@ -170,6 +170,9 @@ static void sailfish_access_load_config()
 	da_policy_unref(default_policy);
 	g_free(default_policy_spec);
 	g_key_file_unref(config);
+
+	/* Verdicts made under the old rules are no longer valid */
+	ofono_dbus_access_invalidate();
 }
 
 static void sailfish_access_intf_free(gpointer user_data)
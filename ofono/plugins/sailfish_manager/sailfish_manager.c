@@ -70,6 +70,8 @@ struct sailfish_manager_priv {
 	char *mms_imsi;
 	GKeyFile *storage;
 	GHashTable *errors;
+	struct sailfish_slot_priv *switch_slot;
+	struct sailfish_data_switch_timings switch_timings;
 };
 
 struct sailfish_slot_driver_reg {
@@ -496,6 +498,9 @@ static void sailfish_slot_free(struct sailfish_slot_priv *s)
 	if (s->errors) {
 		g_hash_table_destroy(s->errors);
 	}
+	if (p->switch_slot == s) {
+		p->switch_slot = NULL;
+	}
 	sailfish_sim_info_unref(s->siminfo);
 	sailfish_sim_info_dbus_free(s->siminfo_dbus);
 	sailfish_cell_info_dbus_free(s->cellinfo_dbus);
@@ -526,6 +531,22 @@ void sailfish_manager_set_cell_info(struct sailfish_slot *s,
 	}
 }
 
+void sailfish_manager_data_switch_done(struct sailfish_slot *s,
+			const struct sailfish_data_switch_timings *timings)
+{
+	if (s && timings) {
+		struct sailfish_slot_priv *slot = sailfish_slot_priv_cast(s);
+		struct sailfish_manager_priv *p = slot->manager->plugin;
+
+		DBG("%s switched in %d ms", s->path,
+					(int)(timings->total / 1000));
+		p->switch_slot = slot;
+		p->switch_timings = *timings;
+		sailfish_manager_dbus_signal_data_switch(p->dbus, slot->index,
+								timings);
+	}
+}
+
 static gboolean sailfish_manager_update_dbus_block_proc
 			(struct sailfish_slot_driver_reg *r, void *data)
 {
@@ -1197,6 +1218,19 @@ static GHashTable *sailfish_manager_get_slot_errors
 	return sailfish_slot_priv_cast_const(s)->errors;
 }
 
+static const struct sailfish_slot *sailfish_manager_get_data_switch
+			(struct sailfish_manager *m,
+				struct sailfish_data_switch_timings *timings)
+{
+	struct sailfish_manager_priv *p = sailfish_manager_priv_cast(m);
+
+	if (p->switch_slot) {
+		*timings = p->switch_timings;
+		return &p->switch_slot->pub;
+	}
+	return NULL;
+}
+
 static void sailfish_slot_manager_has_started(struct sailfish_slot_manager *m)
 {
 	if (!m->started) {
@@ -1389,7 +1423,8 @@ static struct sailfish_manager_priv *sailfish_manager_priv_new()
 		.set_default_voice_imsi =
 				sailfish_manager_set_default_voice_imsi,
 		.set_default_data_imsi =
-				sailfish_manager_set_default_data_imsi
+				sailfish_manager_set_default_data_imsi,
+		.get_data_switch = sailfish_manager_get_data_switch
 	};
 
 	struct sailfish_manager_priv *p =
@@ -79,6 +79,14 @@ enum sailfish_data_role {
 	SAILFISH_DATA_ROLE_INTERNET     /* Data is allowed at full speed */
 };
 
+/* Phases of the data SIM switch, in microseconds */
+struct sailfish_data_switch_timings {
+	gint64 teardown;        /* Data calls on the other slots released */
+	gint64 caps;            /* Radio capability switch */
+	gint64 allow;           /* Data allowed for the new slot */
+	gint64 total;
+};
+
 /* Register/unregister the driver */
 struct sailfish_slot_driver_reg *sailfish_slot_driver_register
 				(const struct sailfish_slot_driver *d);
@@ -111,6 +119,8 @@ void sailfish_manager_error(struct sailfish_slot_manager *m, const char *key,
 						const char *message);
 void sailfish_manager_set_cell_info(struct sailfish_slot *s,
 						struct sailfish_cell_info *ci);
+void sailfish_manager_data_switch_done(struct sailfish_slot *s,
+			const struct sailfish_data_switch_timings *timings);
 
 /* Callbacks provided by slot plugins */
 struct sailfish_slot_driver {
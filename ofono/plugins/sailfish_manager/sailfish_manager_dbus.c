@@ -60,6 +60,7 @@ struct sailfish_manager_dbus {
 #define SF_DBUS_SIGNAL_MMS_MODEM_CHANGED           "MmsModemChanged"
 #define SF_DBUS_SIGNAL_READY_CHANGED               "ReadyChanged"
 #define SF_DBUS_SIGNAL_MODEM_ERROR                 "ModemError"
+#define SF_DBUS_SIGNAL_DATA_SWITCH_COMPLETED       "DataSwitchCompleted"
 #define SF_DBUS_IMSI_AUTO                          "auto"
 
 #define SF_DBUS_ERROR_SIGNATURE                    "si"
@@ -379,6 +380,38 @@ void sailfish_manager_dbus_signal_error(struct sailfish_manager_dbus *dbus,
 	sailfish_manager_dbus_emit_modem_error(dbus, "/", id, message);
 }
 
+static void sailfish_manager_dbus_append_data_switch(DBusMessageIter *it,
+				const char *path,
+				const struct sailfish_data_switch_timings *t)
+{
+	dbus_int64_t teardown = t->teardown;
+	dbus_int64_t caps = t->caps;
+	dbus_int64_t allow = t->allow;
+	dbus_int64_t total = t->total;
+
+	dbus_message_iter_append_basic(it, DBUS_TYPE_OBJECT_PATH, &path);
+	dbus_message_iter_append_basic(it, DBUS_TYPE_INT64, &teardown);
+	dbus_message_iter_append_basic(it, DBUS_TYPE_INT64, &caps);
+	dbus_message_iter_append_basic(it, DBUS_TYPE_INT64, &allow);
+	dbus_message_iter_append_basic(it, DBUS_TYPE_INT64, &total);
+}
+
+void sailfish_manager_dbus_signal_data_switch(struct sailfish_manager_dbus *d,
+			int index, const struct sailfish_data_switch_timings *t)
+{
+	if (d) {
+		DBusMessage *signal = dbus_message_new_signal(SF_DBUS_PATH,
+					SF_DBUS_INTERFACE,
+					SF_DBUS_SIGNAL_DATA_SWITCH_COMPLETED);
+		DBusMessageIter iter;
+
+		dbus_message_iter_init_append(signal, &iter);
+		sailfish_manager_dbus_append_data_switch(&iter,
+					d->manager->slots[index]->path, t);
+		g_dbus_send_message(d->conn, signal);
+	}
+}
+
 static DBusMessage *sailfish_manager_dbus_reply(DBusMessage *msg,
 				struct sailfish_manager_dbus *dbus,
 				sailfish_manager_dbus_append_fn append)
@@ -814,6 +847,22 @@ static DBusMessage *sailfish_manager_dbus_get_modem_errors
 				sailfish_manager_dbus_append_modem_errors);
 }
 
+static DBusMessage *sailfish_manager_dbus_get_data_switch_timings
+			(DBusConnection *conn, DBusMessage *msg, void *data)
+{
+	struct sailfish_manager_dbus *dbus = data;
+	struct sailfish_data_switch_timings timings = { 0, 0, 0, 0 };
+	const struct sailfish_slot *slot;
+	DBusMessage *reply = dbus_message_new_method_return(msg);
+	DBusMessageIter iter;
+
+	slot = dbus->cb->get_data_switch(dbus->manager, &timings);
+	dbus_message_iter_init_append(reply, &iter);
+	sailfish_manager_dbus_append_data_switch(&iter,
+				slot ? slot->path : SF_DBUS_PATH, &timings);
+	return reply;
+}
+
 static DBusMessage *sailfish_manager_dbus_get_errors(DBusConnection *conn,
 					DBusMessage *msg, void *data)
 {
@@ -986,6 +1035,12 @@ static DBusMessage *sailfish_manager_dbus_set_mms_sim(DBusConnection *conn,
 #define SF_DBUS_IMEISV_ARG              {"imeisv" , "as"}
 #define SF_DBUS_ERRORS_ARG              {"errors" , \
                                           "a(" SF_DBUS_ERROR_SIGNATURE ")"}
+#define SF_DBUS_DATA_SWITCH_ARGS \
+	{"modem", "o"}, \
+	{"teardown", "x"}, \
+	{"radioCaps", "x"}, \
+	{"allowData", "x"}, \
+	{"total", "x"}
 #define SF_DBUS_GET_ALL_ARGS \
 	SF_DBUS_VERSION_ARG, \
 	SF_DBUS_AVAILABLE_MODEMS_ARG, \
@@ -1086,6 +1141,9 @@ static const GDBusMethodTable sailfish_manager_dbus_methods[] = {
 	{ GDBUS_ASYNC_METHOD("GetErrors",
 			NULL, GDBUS_ARGS(SF_DBUS_ERRORS_ARG),
 			sailfish_manager_dbus_get_errors) },
+	{ GDBUS_ASYNC_METHOD("GetDataSwitchTimings",
+			NULL, GDBUS_ARGS(SF_DBUS_DATA_SWITCH_ARGS),
+			sailfish_manager_dbus_get_data_switch_timings) },
 	{ GDBUS_ASYNC_METHOD("SetEnabledModems",
 			GDBUS_ARGS({ "modems", "ao" }), NULL,
 			sailfish_manager_dbus_set_enabled_modems) },
@@ -1125,6 +1183,8 @@ static const GDBusSignalTable sailfish_manager_dbus_signals[] = {
 			GDBUS_ARGS({"path","o"},
 			{"error_id", "s"},
 			{"message", "s"})) },
+	{ GDBUS_SIGNAL(SF_DBUS_SIGNAL_DATA_SWITCH_COMPLETED,
+			GDBUS_ARGS(SF_DBUS_DATA_SWITCH_ARGS)) },
 	{ }
 };
 
@@ -49,6 +49,9 @@ struct sailfish_manager_dbus_cb {
 							const char *imsi);
 	void (*set_default_data_imsi)(struct sailfish_manager *m,
 							const char *imsi);
+	const struct sailfish_slot *(*get_data_switch)
+		(struct sailfish_manager *m,
+			struct sailfish_data_switch_timings *timings);
 };
 
 struct sailfish_manager_dbus *sailfish_manager_dbus_new
@@ -65,6 +68,8 @@ void sailfish_manager_dbus_signal_error(struct sailfish_manager_dbus *d,
 				const char *id, const char *message);
 void sailfish_manager_dbus_signal_modem_error(struct sailfish_manager_dbus *d,
 				int index, const char *id, const char *msg);
+void sailfish_manager_dbus_signal_data_switch(struct sailfish_manager_dbus *d,
+		int index, const struct sailfish_data_switch_timings *t);
 
 #endif /* SAILFISH_MANAGER_DBUS_H */
 
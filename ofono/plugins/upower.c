@@ -90,15 +90,79 @@ static void update_battery_level(double percentage_val)
 					GINT_TO_POINTER(battery_level));
 }
 
+/* UPower device State and WarningLevel values */
+#define UPOWER_STATE_CHARGING		1
+#define UPOWER_STATE_FULLY_CHARGED	4
+#define UPOWER_STATE_PENDING_CHARGE	5
+#define UPOWER_WARNING_LEVEL_LOW	3
+
+static gboolean parse_battery_props(DBusMessageIter *dict)
+{
+	while (dbus_message_iter_get_arg_type(dict) == DBUS_TYPE_DICT_ENTRY) {
+		DBusMessageIter entry, val;
+		const char *key;
+		int type;
+
+		dbus_message_iter_recurse(dict, &entry);
+
+		if (dbus_message_iter_get_arg_type(&entry) !=
+				DBUS_TYPE_STRING) {
+			ofono_error("%s: key type != STRING!", __func__);
+			return FALSE;
+		}
+
+		dbus_message_iter_get_basic(&entry, &key);
+
+		dbus_message_iter_next(&entry);
+		if (dbus_message_iter_get_arg_type(&entry) !=
+				DBUS_TYPE_VARIANT) {
+			ofono_error("%s: '%s' val != VARIANT", __func__, key);
+			return FALSE;
+		}
+
+		dbus_message_iter_recurse(&entry, &val);
+		type = dbus_message_iter_get_arg_type(&val);
+
+		if (g_str_equal(key, "Percentage") == TRUE &&
+				type == DBUS_TYPE_DOUBLE) {
+			double percentage_val;
+
+			dbus_message_iter_get_basic(&val, &percentage_val);
+			update_battery_level(percentage_val);
+		} else if (g_str_equal(key, "State") == TRUE &&
+				type == DBUS_TYPE_UINT32) {
+			dbus_uint32_t state;
+
+			dbus_message_iter_get_basic(&val, &state);
+			DBG("State: %u", state);
+
+			__ofono_devmon_set_charging(
+				state == UPOWER_STATE_CHARGING ||
+				state == UPOWER_STATE_FULLY_CHARGED ||
+				state == UPOWER_STATE_PENDING_CHARGE);
+		} else if (g_str_equal(key, "WarningLevel") == TRUE &&
+				type == DBUS_TYPE_UINT32) {
+			dbus_uint32_t level;
+
+			dbus_message_iter_get_basic(&val, &level);
+			DBG("WarningLevel: %u", level);
+
+			__ofono_devmon_set_battery_low(
+					level >= UPOWER_WARNING_LEVEL_LOW);
+		}
+
+		dbus_message_iter_next(dict);
+	}
+
+	return TRUE;
+}
+
 static gboolean battery_props_changed(DBusConnection *conn, DBusMessage *msg,
 				void *user_data)
 
 {
 	const char *iface;
 	DBusMessageIter iter, dict;
-	double percentage_val;
-	gboolean percentage_found = FALSE;
-	gboolean retval = FALSE;
 
 	DBG("");
 
@@ -106,77 +170,83 @@ static gboolean battery_props_changed(DBusConnection *conn, DBusMessage *msg,
 
 	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING) {
 		ofono_error("%s: iface != TYPE_STRING!", __func__);
-		goto done;
+		return FALSE;
 	}
 
 	dbus_message_iter_get_basic(&iter, &iface);
 
 	if (g_str_equal(iface, UPOWER_DEVICE_INTERFACE) != TRUE) {
 		ofono_error("%s: wrong iface: %s!", __func__, iface);
-		goto done;
+		return FALSE;
 	}
 
 	if (!dbus_message_iter_next(&iter)) {
 		ofono_error("%s: advance iter failed!", __func__);
-		goto done;
+		return FALSE;
 	}
 
 	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_ARRAY) {
 		ofono_error("%s: type != ARRAY!", __func__);
-		goto done;
+		return FALSE;
 	}
 
 	dbus_message_iter_recurse(&iter, &dict);
 
-	while (dbus_message_iter_get_arg_type(&dict) == DBUS_TYPE_DICT_ENTRY) {
-		DBusMessageIter entry, val;
-		const char *key;
+	/* Returning FALSE would remove the signal watch */
+	return parse_battery_props(&dict);
+}
 
-		dbus_message_iter_recurse(&dict, &entry);
+static void battery_get_all_reply(DBusPendingCall *call, void *user_data)
+{
+	DBusMessage *reply = dbus_pending_call_steal_reply(call);
+	DBusMessageIter iter, dict;
 
-		if (dbus_message_iter_get_arg_type(&entry) !=
-				DBUS_TYPE_STRING) {
-			ofono_error("%s: key type != STRING!", __func__);
-			goto done;
-		}
+	if (reply == NULL)
+		goto done;
 
-		dbus_message_iter_get_basic(&entry, &key);
+	if (dbus_message_get_type(reply) == DBUS_MESSAGE_TYPE_ERROR) {
+		ofono_error("%s: ERROR reply to GetAll", __func__);
+		goto done;
+	}
 
-		if (g_str_equal(key, "Percentage") != TRUE) {
-			dbus_message_iter_next(&dict);
-			continue;
-		}
+	if (dbus_message_iter_init(reply, &iter) == FALSE ||
+			dbus_message_iter_get_arg_type(&iter) !=
+							DBUS_TYPE_ARRAY) {
+		ofono_error("%s: type != ARRAY!", __func__);
+		goto done;
+	}
 
-		dbus_message_iter_next(&entry);
-		if (dbus_message_iter_get_arg_type(&entry) !=
-				DBUS_TYPE_VARIANT) {
-			ofono_error("%s: 'Percentage' val != VARIANT",
-								__func__);
-			goto done;
-		}
+	dbus_message_iter_recurse(&iter, &dict);
+	parse_battery_props(&dict);
 
-		dbus_message_iter_recurse(&entry, &val);
+done:
+	if (reply)
+		dbus_message_unref(reply);
 
-		if (dbus_message_iter_get_arg_type(&val) != DBUS_TYPE_DOUBLE) {
-			ofono_error("%s: 'Percentage' val != DOUBLE", __func__);
-			goto done;
-		}
+	dbus_pending_call_unref(call);
+}
 
-		dbus_message_iter_get_basic(&val, &percentage_val);
-		percentage_found = TRUE;
-		break;
-	}
+static void battery_get_all(void)
+{
+	const char *iface = UPOWER_DEVICE_INTERFACE;
+	DBusPendingCall *call;
+	DBusMessage *msg;
 
-	/* No errors found during parsing, so don't trigger cb removal */
-	retval = TRUE;
+	msg = dbus_message_new_method_call(UPOWER_SERVICE, battery_device_path,
+						DBUS_PROPERTIES_INTERFACE,
+						"GetAll");
+	if (msg == NULL)
+		return;
 
-	if (percentage_found == FALSE)
-		goto done;
+	dbus_message_append_args(msg, DBUS_TYPE_STRING, &iface,
+						DBUS_TYPE_INVALID);
 
-	update_battery_level(percentage_val);
+	if (dbus_connection_send_with_reply(connection, msg, &call, -1) &&
+								call)
+		dbus_pending_call_set_notify(call, battery_get_all_reply,
+								NULL, NULL);
 
-done:
-	return retval;
+	dbus_message_unref(msg);
 }
 
 static void emulator_hfp_watch(struct ofono_atom *atom,
@@ -288,6 +358,9 @@ static void enum_devices_reply(DBusPendingCall *call, void *user_data)
 						battery_props_changed,
 						NULL, NULL);
 
+	/* The signal only tells about changes */
+	battery_get_all();
+
 	modem_watch = __ofono_modemwatch_add(modemwatch, NULL, NULL);
 	__ofono_modem_foreach(call_modemwatch, NULL);
 
@@ -337,6 +410,10 @@ static void upower_disconnect(DBusConnection *conn, void *user_data)
 		g_free(battery_device_path);
 		battery_device_path = NULL;
 	}
+
+	/* Nothing to tell about power any more */
+	__ofono_devmon_set_charging(FALSE);
+	__ofono_devmon_set_battery_low(FALSE);
 }
 
 static int upower_init(void)
@@ -19,7 +19,34 @@
 #include <errno.h>
 #include <string.h>
 
+/*
+ * Verdicts are cached per sender, interface, method and argument. Unique
+ * bus names are never reused, so an entry stays valid until the peer
+ * leaves the bus or the policy changes. The least recently used entry
+ * is evicted when the cache is full.
+ */
+#define DBUS_ACCESS_CACHE_SIZE (256)
+
+struct dbus_access_key {
+	const char *sender;
+	const char *arg;
+	enum ofono_dbus_access_intf intf;
+	int method;
+	guint hash;
+};
+
+struct dbus_access_verdict {
+	struct dbus_access_key key;
+	GList link;
+	gboolean allowed;
+	/* Followed by the sender and the argument */
+};
+
 static GSList *dbus_access_plugins = NULL;
+static GHashTable *dbus_access_cache = NULL;
+static GQueue dbus_access_lru = G_QUEUE_INIT;
+static guint dbus_access_cache_hits = 0;
+static guint dbus_access_cache_misses = 0;
 
 const char *ofono_dbus_access_intf_name(enum ofono_dbus_access_intf intf)
 {
@@ -118,6 +145,8 @@ const char *ofono_dbus_access_method_name(enum ofono_dbus_access_intf intf,
 			return "SetProperty";
 		case OFONO_DBUS_ACCESS_CONNCTX_PROVISION_CONTEXT:
 			return "ProvisionContext";
+		case OFONO_DBUS_ACCESS_CONNCTX_RESET_COUNTERS:
+			return "ResetCounters";
 		case OFONO_DBUS_ACCESS_CONNCTX_METHOD_COUNT:
 			break;
 		}
@@ -148,6 +177,8 @@ const char *ofono_dbus_access_method_name(enum ofono_dbus_access_intf intf,
 			return "LockPin";
 		case OFONO_DBUS_ACCESS_SIMMGR_UNLOCK_PIN:
 			return "UnlockPin";
+		case OFONO_DBUS_ACCESS_SIMMGR_READ_FILE:
+			return "ReadFile";
 		case OFONO_DBUS_ACCESS_SIMMGR_METHOD_COUNT:
 			break;
 		}
@@ -182,7 +213,92 @@ const char *ofono_dbus_access_method_name(enum ofono_dbus_access_intf intf,
 	return NULL;
 }
 
-gboolean __ofono_dbus_access_method_allowed(const char *sender,
+static void dbus_access_key_init(struct dbus_access_key *key,
+			const char *sender, enum ofono_dbus_access_intf intf,
+			int method, const char *arg)
+{
+	key->sender = sender;
+	key->arg = arg;
+	key->intf = intf;
+	key->method = method;
+	key->hash = (g_str_hash(sender) * 31 + (arg ? g_str_hash(arg) : 0)) *
+						31 + (intf << 8) + method;
+}
+
+static guint dbus_access_key_hash(gconstpointer data)
+{
+	const struct dbus_access_key *key = data;
+
+	return key->hash;
+}
+
+static gboolean dbus_access_key_equal(gconstpointer a, gconstpointer b)
+{
+	const struct dbus_access_key *k1 = a;
+	const struct dbus_access_key *k2 = b;
+
+	return k1->hash == k2->hash && k1->intf == k2->intf &&
+				k1->method == k2->method &&
+				!strcmp(k1->sender, k2->sender) &&
+				!g_strcmp0(k1->arg, k2->arg);
+}
+
+static void dbus_access_cache_remove(struct dbus_access_verdict *v)
+{
+	g_queue_unlink(&dbus_access_lru, &v->link);
+	g_hash_table_remove(dbus_access_cache, &v->key);
+	g_free(v);
+}
+
+static void dbus_access_cache_add(const struct dbus_access_key *key,
+							gboolean allowed)
+{
+	const gsize sender_size = strlen(key->sender) + 1;
+	const gsize arg_size = key->arg ? strlen(key->arg) + 1 : 0;
+	struct dbus_access_verdict *v;
+	char *ptr;
+
+	if (!dbus_access_cache)
+		dbus_access_cache = g_hash_table_new(dbus_access_key_hash,
+							dbus_access_key_equal);
+	else if (dbus_access_lru.length >= DBUS_ACCESS_CACHE_SIZE)
+		dbus_access_cache_remove(dbus_access_lru.tail->data);
+
+	v = g_malloc0(sizeof(*v) + sender_size + arg_size);
+	ptr = (char *) (v + 1);
+	v->key = *key;
+	v->key.sender = memcpy(ptr, key->sender, sender_size);
+	v->key.arg = key->arg ? memcpy(ptr + sender_size, key->arg,
+							arg_size) : NULL;
+	v->link.data = v;
+	v->allowed = allowed;
+
+	g_hash_table_insert(dbus_access_cache, &v->key, v);
+	g_queue_push_head_link(&dbus_access_lru, &v->link);
+}
+
+static void dbus_access_cache_flush(void)
+{
+	GList *link;
+
+	if (!dbus_access_cache)
+		return;
+
+	DBG("%u hits, %u misses", dbus_access_cache_hits,
+						dbus_access_cache_misses);
+
+	while ((link = g_queue_pop_head_link(&dbus_access_lru)) != NULL)
+		g_free(link->data);
+
+	if (dbus_access_plugins) {
+		g_hash_table_remove_all(dbus_access_cache);
+	} else {
+		g_hash_table_destroy(dbus_access_cache);
+		dbus_access_cache = NULL;
+	}
+}
+
+static gboolean dbus_access_plugins_allowed(const char *sender,
 					enum ofono_dbus_access_intf intf,
 					int method, const char *arg)
 {
@@ -207,6 +323,67 @@ gboolean __ofono_dbus_access_method_allowed(const char *sender,
 	return TRUE;
 }
 
+gboolean __ofono_dbus_access_method_allowed(const char *sender,
+					enum ofono_dbus_access_intf intf,
+					int method, const char *arg)
+{
+	struct dbus_access_key key;
+	struct dbus_access_verdict *v;
+	gboolean allowed;
+
+	if (!dbus_access_plugins)
+		return TRUE;
+
+	if (!sender)
+		return dbus_access_plugins_allowed(sender, intf, method, arg);
+
+	dbus_access_key_init(&key, sender, intf, method, arg);
+	v = dbus_access_cache ? g_hash_table_lookup(dbus_access_cache, &key) :
+									NULL;
+
+	if (v) {
+		dbus_access_cache_hits++;
+		g_queue_unlink(&dbus_access_lru, &v->link);
+		g_queue_push_head_link(&dbus_access_lru, &v->link);
+		return v->allowed;
+	}
+
+	dbus_access_cache_misses++;
+	allowed = dbus_access_plugins_allowed(sender, intf, method, arg);
+	dbus_access_cache_add(&key, allowed);
+	return allowed;
+}
+
+void __ofono_dbus_access_peer_gone(const char *sender)
+{
+	GList *l = dbus_access_lru.head;
+
+	while (l) {
+		GList *next = l->next;
+		struct dbus_access_verdict *v = l->data;
+
+		if (!strcmp(v->key.sender, sender))
+			dbus_access_cache_remove(v);
+
+		l = next;
+	}
+}
+
+void __ofono_dbus_access_cache_stats(unsigned int *hits,
+						unsigned int *misses)
+{
+	if (hits)
+		*hits = dbus_access_cache_hits;
+
+	if (misses)
+		*misses = dbus_access_cache_misses;
+}
+
+void ofono_dbus_access_invalidate(void)
+{
+	dbus_access_cache_flush();
+}
+
 /**
  * Returns 0 if both are equal;
  * <0 if a comes before b;
@@ -240,6 +417,7 @@ int ofono_dbus_access_plugin_register
 		DBG("%s", plugin->name);
 		dbus_access_plugins = g_slist_insert_sorted(dbus_access_plugins,
 				(void*)plugin, ofono_dbus_access_plugin_sort);
+		dbus_access_cache_flush();
 		return 0;
 	}
 }
@@ -251,6 +429,7 @@ void ofono_dbus_access_plugin_unregister
 		DBG("%s", plugin->name);
 		dbus_access_plugins = g_slist_remove(dbus_access_plugins,
 								plugin);
+		dbus_access_cache_flush();
 	}
 }
 
@@ -32,6 +32,28 @@
 #define OFONO_ERROR_INTERFACE "org.ofono.Error"
 
 static DBusConnection *g_connection;
+static guint name_owner_watch;
+static ofono_dbus_peer_gone_cb_t peer_gone_cb;
+
+/*
+ * GetProperties replies of the busiest interfaces are marshalled once and
+ * copied until the next PropertyChanged signal on the same interface.
+ * Clients already rely on GetProperties plus the signals describing the
+ * full state, so the signal is also the point where the snapshot goes
+ * stale.  Owners drop the snapshot themselves on the rare changes that
+ * are not signalled.
+ */
+struct properties_snapshot {
+	char *interface;
+	ofono_dbus_properties_func append;
+	void *data;
+	DBusMessage *reply;
+};
+
+static GHashTable *snapshots;
+static unsigned int modems_serial;
+static unsigned int snapshot_hits;
+static unsigned int snapshot_misses;
 
 struct error_mapping_entry {
 	int error;
@@ -209,6 +231,193 @@ void ofono_dbus_dict_append_dict(DBusMessageIter *dict, const char *key,
 	dbus_message_iter_close_container(dict, &entry);
 }
 
+static struct properties_snapshot *snapshot_find(const char *path,
+						const char *interface,
+						GSList **list)
+{
+	GSList *l;
+
+	if (snapshots == NULL)
+		return NULL;
+
+	*list = g_hash_table_lookup(snapshots, path);
+
+	for (l = *list; l; l = l->next) {
+		struct properties_snapshot *snapshot = l->data;
+
+		if (g_str_equal(snapshot->interface, interface))
+			return snapshot;
+	}
+
+	return NULL;
+}
+
+static void snapshot_free(gpointer data)
+{
+	struct properties_snapshot *snapshot = data;
+
+	if (snapshot->reply)
+		dbus_message_unref(snapshot->reply);
+
+	g_free(snapshot->interface);
+	g_free(snapshot);
+}
+
+static void snapshot_list_free(gpointer key, gpointer value,
+							gpointer user_data)
+{
+	g_slist_free_full(value, snapshot_free);
+}
+
+void __ofono_dbus_properties_register(const char *path,
+					const char *interface,
+					ofono_dbus_properties_func append,
+					void *data)
+{
+	struct properties_snapshot *snapshot;
+	GSList *list = NULL;
+
+	if (snapshots == NULL)
+		snapshots = g_hash_table_new_full(g_str_hash, g_str_equal,
+							g_free, NULL);
+
+	snapshot = snapshot_find(path, interface, &list);
+	if (snapshot == NULL) {
+		snapshot = g_new0(struct properties_snapshot, 1);
+		snapshot->interface = g_strdup(interface);
+
+		g_hash_table_replace(snapshots, g_strdup(path),
+					g_slist_prepend(list, snapshot));
+	}
+
+	snapshot->append = append;
+	snapshot->data = data;
+	__ofono_dbus_properties_invalidate(path, interface);
+}
+
+void __ofono_dbus_properties_unregister(const char *path,
+					const char *interface)
+{
+	struct properties_snapshot *snapshot;
+	GSList *list;
+
+	__ofono_dbus_properties_invalidate(path, interface);
+
+	snapshot = snapshot_find(path, interface, &list);
+	if (snapshot == NULL)
+		return;
+
+	list = g_slist_remove(list, snapshot);
+	snapshot_free(snapshot);
+
+	if (list == NULL)
+		g_hash_table_remove(snapshots, path);
+	else
+		g_hash_table_replace(snapshots, g_strdup(path), list);
+}
+
+void __ofono_dbus_properties_invalidate(const char *path,
+					const char *interface)
+{
+	struct properties_snapshot *snapshot;
+	GSList *list;
+
+	/* GetModems carries the properties of every modem */
+	if (g_str_equal(interface, OFONO_MODEM_INTERFACE))
+		modems_serial++;
+
+	snapshot = snapshot_find(path, interface, &list);
+	if (snapshot == NULL || snapshot->reply == NULL)
+		return;
+
+	dbus_message_unref(snapshot->reply);
+	snapshot->reply = NULL;
+}
+
+DBusMessage *__ofono_dbus_snapshot_reply(DBusMessage *msg,
+						DBusMessage *snapshot)
+{
+	DBusMessage *reply;
+	const char *sender = dbus_message_get_sender(msg);
+
+	reply = dbus_message_copy(snapshot);
+	if (reply == NULL)
+		return NULL;
+
+	dbus_message_set_no_reply(reply, TRUE);
+
+	if (!dbus_message_set_reply_serial(reply,
+					dbus_message_get_serial(msg)) ||
+			(sender && !dbus_message_set_destination(reply,
+								sender))) {
+		dbus_message_unref(reply);
+		return NULL;
+	}
+
+	return reply;
+}
+
+DBusMessage *__ofono_dbus_properties_reply(DBusMessage *msg,
+						const char *path,
+						const char *interface)
+{
+	struct properties_snapshot *snapshot;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	GSList *list;
+
+	snapshot = snapshot_find(path, interface, &list);
+	if (snapshot == NULL)
+		return NULL;
+
+	if (snapshot->reply) {
+		snapshot_hits++;
+		return __ofono_dbus_snapshot_reply(msg, snapshot->reply);
+	}
+
+	snapshot->reply = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_RETURN);
+	if (snapshot->reply == NULL)
+		return NULL;
+
+	snapshot_misses++;
+
+	dbus_message_iter_init_append(snapshot->reply, &iter);
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+					OFONO_PROPERTIES_ARRAY_SIGNATURE,
+					&dict);
+	snapshot->append(&dict, snapshot->data);
+	dbus_message_iter_close_container(&iter, &dict);
+
+	return __ofono_dbus_snapshot_reply(msg, snapshot->reply);
+}
+
+unsigned int __ofono_dbus_modems_serial(void)
+{
+	return modems_serial;
+}
+
+void __ofono_dbus_properties_stats(unsigned int *hits, unsigned int *misses)
+{
+	if (hits)
+		*hits = snapshot_hits;
+
+	if (misses)
+		*misses = snapshot_misses;
+}
+
+/* Fills in GetManagedObjects and InterfacesAdded of the object manager */
+static void append_snapshot_properties(const char *path,
+					const char *interface,
+					DBusMessageIter *dict)
+{
+	struct properties_snapshot *snapshot;
+	GSList *list;
+
+	snapshot = snapshot_find(path, interface, &list);
+	if (snapshot)
+		snapshot->append(dict, snapshot->data);
+}
+
 int ofono_dbus_signal_property_changed(DBusConnection *conn,
 					const char *path,
 					const char *interface,
@@ -218,6 +427,8 @@ int ofono_dbus_signal_property_changed(DBusConnection *conn,
 	DBusMessage *signal;
 	DBusMessageIter iter;
 
+	__ofono_dbus_properties_invalidate(path, interface);
+
 	signal = dbus_message_new_signal(path, interface, "PropertyChanged");
 	if (signal == NULL) {
 		ofono_error("Unable to allocate new %s.PropertyChanged signal",
@@ -244,6 +455,8 @@ int ofono_dbus_signal_array_property_changed(DBusConnection *conn,
 	DBusMessage *signal;
 	DBusMessageIter iter;
 
+	__ofono_dbus_properties_invalidate(path, interface);
+
 	signal = dbus_message_new_signal(path, interface, "PropertyChanged");
 	if (signal == NULL) {
 		ofono_error("Unable to allocate new %s.PropertyChanged signal",
@@ -270,6 +483,8 @@ int ofono_dbus_signal_dict_property_changed(DBusConnection *conn,
 	DBusMessage *signal;
 	DBusMessageIter iter;
 
+	__ofono_dbus_properties_invalidate(path, interface);
+
 	signal = dbus_message_new_signal(path, interface, "PropertyChanged");
 	if (signal == NULL) {
 		ofono_error("Unable to allocate new %s.PropertyChanged signal",
@@ -485,10 +700,45 @@ static void dbus_gsm_set_connection(DBusConnection *conn)
 	g_connection = conn;
 }
 
+static gboolean name_owner_changed(DBusConnection *conn,
+					DBusMessage *msg, void *user_data)
+{
+	const char *name, *old_owner, *new_owner;
+
+	if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+					DBUS_TYPE_STRING, &old_owner,
+					DBUS_TYPE_STRING, &new_owner,
+					DBUS_TYPE_INVALID))
+		return TRUE;
+
+	if (peer_gone_cb && name[0] == ':' && new_owner[0] == '\0')
+		peer_gone_cb(name);
+
+	return TRUE;
+}
+
+/* Unique names are never reused, so whatever is kept per peer can go */
+void __ofono_dbus_set_peer_gone_cb(ofono_dbus_peer_gone_cb_t cb)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+
+	peer_gone_cb = cb;
+
+	if (name_owner_watch || conn == NULL)
+		return;
+
+	name_owner_watch = g_dbus_add_signal_watch(conn, DBUS_SERVICE_DBUS,
+					DBUS_PATH_DBUS, DBUS_INTERFACE_DBUS,
+					"NameOwnerChanged", name_owner_changed,
+					NULL, NULL);
+}
+
 int __ofono_dbus_init(DBusConnection *conn)
 {
 	dbus_gsm_set_connection(conn);
 
+	g_dbus_set_append_properties_function(append_snapshot_properties);
+
 	return 0;
 }
 
@@ -499,5 +749,22 @@ void __ofono_dbus_cleanup(void)
 	if (conn == NULL || !dbus_connection_get_is_connected(conn))
 		return;
 
+	if (name_owner_watch) {
+		g_dbus_remove_watch(conn, name_owner_watch);
+		name_owner_watch = 0;
+	}
+
+	peer_gone_cb = NULL;
+
+	g_dbus_set_append_properties_function(NULL);
+
+	if (snapshots) {
+		DBG("%u snapshot hits, %u misses", snapshot_hits,
+						snapshot_misses);
+		g_hash_table_foreach(snapshots, snapshot_list_free, NULL);
+		g_hash_table_destroy(snapshots);
+		snapshots = NULL;
+	}
+
 	dbus_gsm_set_connection(NULL);
 }
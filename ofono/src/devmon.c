@@ -0,0 +1,358 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+
+#include <glib.h>
+#include <gdbus.h>
+
+#include "ofono.h"
+
+/*
+ * The device monitor turns the power state of the device into the set
+ * of modem indications that can be muted.  The state comes from the
+ * upower plugin and from whoever knows about the display, through the
+ * DeviceMonitor interface.  Atoms watch the muted set and pass it on
+ * to their drivers.
+ */
+
+static struct ofono_watchlist *devmon_watches;
+static gboolean display_on = TRUE;
+static gboolean charging;
+static gboolean battery_low;
+static unsigned int devmon_muted;
+
+static guint64 indication_count;
+static guint64 muted_indication_count;
+static gint64 muted_since;
+static gint64 muted_time;
+
+static const char *devmon_ind_names[] = {
+	"signal-strength",
+	"location",
+	"cell-info",
+};
+
+static unsigned int devmon_policy(void)
+{
+	/* Power is cheap, keep everything up to date */
+	if (charging)
+		return 0;
+
+	if (!display_on || battery_low)
+		return OFONO_DEVMON_IND_ALL;
+
+	return 0;
+}
+
+static void append_muted(DBusMessageIter *iter)
+{
+	DBusMessageIter array;
+	unsigned int i;
+
+	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+					DBUS_TYPE_STRING_AS_STRING, &array);
+
+	for (i = 0; i < G_N_ELEMENTS(devmon_ind_names); i++)
+		if (devmon_muted & (1 << i))
+			dbus_message_iter_append_basic(&array,
+						DBUS_TYPE_STRING,
+						&devmon_ind_names[i]);
+
+	dbus_message_iter_close_container(iter, &array);
+}
+
+static void devmon_signal_muted(void)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+	const char *name = "MutedIndications";
+	DBusMessage *signal;
+	DBusMessageIter iter;
+	DBusMessageIter var;
+
+	signal = dbus_message_new_signal(OFONO_MANAGER_PATH,
+					OFONO_DEVICE_MONITOR_INTERFACE,
+					"PropertyChanged");
+	if (signal == NULL)
+		return;
+
+	dbus_message_iter_init_append(signal, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &name);
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_VARIANT,
+					DBUS_TYPE_ARRAY_AS_STRING
+					DBUS_TYPE_STRING_AS_STRING, &var);
+	append_muted(&var);
+	dbus_message_iter_close_container(&iter, &var);
+
+	g_dbus_send_message(conn, signal);
+}
+
+static void devmon_update(void)
+{
+	unsigned int muted = devmon_policy();
+	gint64 now = g_get_monotonic_time();
+	GSList *l;
+
+	if (muted == devmon_muted)
+		return;
+
+	DBG("muted 0x%02x -> 0x%02x", devmon_muted, muted);
+
+	if (devmon_muted)
+		muted_time += now - muted_since;
+
+	muted_since = now;
+	devmon_muted = muted;
+
+	devmon_signal_muted();
+
+	for (l = devmon_watches->items; l; l = l->next) {
+		struct ofono_watchlist_item *item = l->data;
+		ofono_devmon_muted_cb_t notify = item->notify;
+
+		notify(devmon_muted, item->notify_data);
+	}
+}
+
+static void devmon_set_flag(gboolean *flag, const char *name,
+							gboolean value)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+	dbus_bool_t val = value;
+
+	if (*flag == value)
+		return;
+
+	*flag = value;
+
+	ofono_dbus_signal_property_changed(conn, OFONO_MANAGER_PATH,
+					OFONO_DEVICE_MONITOR_INTERFACE,
+					name, DBUS_TYPE_BOOLEAN, &val);
+
+	devmon_update();
+}
+
+unsigned int ofono_devmon_get_muted(void)
+{
+	return devmon_muted;
+}
+
+void ofono_devmon_indication_notify(void)
+{
+	indication_count++;
+
+	if (devmon_muted)
+		muted_indication_count++;
+}
+
+unsigned int __ofono_devmon_add_watch(ofono_devmon_muted_cb_t cb,
+					void *data, ofono_destroy_func destroy)
+{
+	struct ofono_watchlist_item *item;
+
+	if (devmon_watches == NULL || cb == NULL)
+		return 0;
+
+	item = g_new0(struct ofono_watchlist_item, 1);
+
+	item->notify = cb;
+	item->notify_data = data;
+	item->destroy = destroy;
+
+	return __ofono_watchlist_add_item(devmon_watches, item);
+}
+
+gboolean __ofono_devmon_remove_watch(unsigned int id)
+{
+	if (devmon_watches == NULL)
+		return FALSE;
+
+	return __ofono_watchlist_remove_item(devmon_watches, id);
+}
+
+void __ofono_devmon_set_charging(ofono_bool_t value)
+{
+	devmon_set_flag(&charging, "Charging", value);
+}
+
+void __ofono_devmon_set_battery_low(ofono_bool_t value)
+{
+	devmon_set_flag(&battery_low, "BatteryLow", value);
+}
+
+static DBusMessage *devmon_get_properties(DBusConnection *conn,
+						DBusMessage *msg, void *data)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	DBusMessageIter dict;
+	DBusMessageIter entry;
+	DBusMessageIter var;
+	const char *key = "MutedIndications";
+	dbus_bool_t value;
+	dbus_uint64_t count;
+	dbus_uint32_t seconds;
+	gint64 total = muted_time;
+
+	reply = dbus_message_new_method_return(msg);
+	if (reply == NULL)
+		return NULL;
+
+	dbus_message_iter_init_append(reply, &iter);
+
+	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+					OFONO_PROPERTIES_ARRAY_SIGNATURE,
+					&dict);
+
+	value = display_on;
+	ofono_dbus_dict_append(&dict, "DisplayOn", DBUS_TYPE_BOOLEAN, &value);
+
+	value = charging;
+	ofono_dbus_dict_append(&dict, "Charging", DBUS_TYPE_BOOLEAN, &value);
+
+	value = battery_low;
+	ofono_dbus_dict_append(&dict, "BatteryLow", DBUS_TYPE_BOOLEAN, &value);
+
+	dbus_message_iter_open_container(&dict, DBUS_TYPE_DICT_ENTRY,
+						NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+	dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT,
+					DBUS_TYPE_ARRAY_AS_STRING
+					DBUS_TYPE_STRING_AS_STRING, &var);
+	append_muted(&var);
+	dbus_message_iter_close_container(&entry, &var);
+	dbus_message_iter_close_container(&dict, &entry);
+
+	count = indication_count;
+	ofono_dbus_dict_append(&dict, "IndicationCount", DBUS_TYPE_UINT64,
+				&count);
+
+	count = muted_indication_count;
+	ofono_dbus_dict_append(&dict, "MutedIndicationCount",
+				DBUS_TYPE_UINT64, &count);
+
+	if (devmon_muted)
+		total += g_get_monotonic_time() - muted_since;
+
+	seconds = total / G_USEC_PER_SEC;
+	ofono_dbus_dict_append(&dict, "MutedTime", DBUS_TYPE_UINT32,
+				&seconds);
+
+	dbus_message_iter_close_container(&iter, &dict);
+
+	return reply;
+}
+
+static DBusMessage *devmon_set_property(DBusConnection *conn,
+						DBusMessage *msg, void *data)
+{
+	DBusMessageIter iter;
+	DBusMessageIter var;
+	const char *property;
+	dbus_bool_t value;
+
+	if (!dbus_message_iter_init(msg, &iter))
+		return __ofono_error_invalid_args(msg);
+
+	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING)
+		return __ofono_error_invalid_args(msg);
+
+	dbus_message_iter_get_basic(&iter, &property);
+	dbus_message_iter_next(&iter);
+
+	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_VARIANT)
+		return __ofono_error_invalid_args(msg);
+
+	dbus_message_iter_recurse(&iter, &var);
+
+	if (dbus_message_iter_get_arg_type(&var) != DBUS_TYPE_BOOLEAN)
+		return __ofono_error_invalid_args(msg);
+
+	dbus_message_iter_get_basic(&var, &value);
+
+	if (g_str_equal(property, "DisplayOn"))
+		devmon_set_flag(&display_on, property, value);
+	else if (g_str_equal(property, "Charging"))
+		devmon_set_flag(&charging, property, value);
+	else if (g_str_equal(property, "BatteryLow"))
+		devmon_set_flag(&battery_low, property, value);
+	else
+		return __ofono_error_invalid_args(msg);
+
+	return dbus_message_new_method_return(msg);
+}
+
+static DBusMessage *devmon_reset_counters(DBusConnection *conn,
+						DBusMessage *msg, void *data)
+{
+	indication_count = 0;
+	muted_indication_count = 0;
+	muted_time = 0;
+	muted_since = g_get_monotonic_time();
+
+	return dbus_message_new_method_return(msg);
+}
+
+static const GDBusMethodTable devmon_methods[] = {
+	{ GDBUS_METHOD("GetProperties",
+			NULL, GDBUS_ARGS({ "properties", "a{sv}" }),
+			devmon_get_properties) },
+	{ GDBUS_METHOD("SetProperty",
+			GDBUS_ARGS({ "property", "s" }, { "value", "v" }),
+			NULL, devmon_set_property) },
+	{ GDBUS_METHOD("ResetCounters", NULL, NULL, devmon_reset_counters) },
+	{ }
+};
+
+static const GDBusSignalTable devmon_signals[] = {
+	{ GDBUS_SIGNAL("PropertyChanged",
+			GDBUS_ARGS({ "name", "s" }, { "value", "v" })) },
+	{ }
+};
+
+int __ofono_devmon_init(void)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+
+	devmon_watches = __ofono_watchlist_new(g_free);
+
+	if (!g_dbus_register_interface(conn, OFONO_MANAGER_PATH,
+					OFONO_DEVICE_MONITOR_INTERFACE,
+					devmon_methods, devmon_signals,
+					NULL, NULL, NULL)) {
+		ofono_error("Could not create %s interface",
+				OFONO_DEVICE_MONITOR_INTERFACE);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+void __ofono_devmon_cleanup(void)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+
+	g_dbus_unregister_interface(conn, OFONO_MANAGER_PATH,
+					OFONO_DEVICE_MONITOR_INTERFACE);
+
+	__ofono_watchlist_free(devmon_watches);
+	devmon_watches = NULL;
+}
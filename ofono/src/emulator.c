@@ -60,7 +60,9 @@ struct ofono_emulator {
 	int l_features;
 	int r_features;
 	GSList *indicators;
+	GSList *pending_indicators;	/* In the order they changed */
 	guint callsetup_source;
+	guint indicator_source;
 	int pns_id;
 	struct ofono_handsfree_card *card;
 	struct hfp_codec_info r_codecs[CODECS_COUNT];
@@ -85,6 +87,7 @@ struct indicator {
 	int min;
 	int max;
 	gboolean deferred;
+	gboolean pending;	/* Changed since the last flush */
 	gboolean active;
 	gboolean mandatory;
 };
@@ -398,6 +401,73 @@ static void notify_deferred_indicators(GAtServer *server, void *user_data)
 	}
 }
 
+/*
+ * Indicator changes are only sent from an idle callback so that several
+ * updates of the same indicator within one main loop iteration result
+ * in a single +CIEV carrying the last value, and the ones of different
+ * indicators end up in the same write.  They go out in the order the
+ * indicators first changed, as the HF may depend on the sequence of the
+ * call indicators.
+ */
+static void flush_indicators(struct ofono_emulator *em)
+{
+	gboolean pending = g_at_server_command_pending(em->server);
+	GSList *changed = em->pending_indicators;
+	char buf[20];
+	GSList *l;
+	struct indicator *ind;
+
+	if (em->indicator_source) {
+		g_source_remove(em->indicator_source);
+		em->indicator_source = 0;
+	}
+
+	em->pending_indicators = NULL;
+
+	for (l = changed; l; l = l->next) {
+		ind = l->data;
+		ind->pending = FALSE;
+
+		if (!(em->events_mode == 3 && em->events_ind && em->slc &&
+				ind->active))
+			continue;
+
+		if (pending) {
+			ind->deferred = TRUE;
+			continue;
+		}
+
+		sprintf(buf, "+CIEV: %d,%d",
+				g_slist_index(em->indicators, ind) + 1,
+				ind->value);
+		g_at_server_send_unsolicited(em->server, buf);
+	}
+
+	g_slist_free(changed);
+}
+
+static gboolean flush_indicators_cb(gpointer user_data)
+{
+	struct ofono_emulator *em = user_data;
+
+	em->indicator_source = 0;
+	flush_indicators(em);
+
+	return FALSE;
+}
+
+static void queue_indicator(struct ofono_emulator *em, struct indicator *ind)
+{
+	if (!ind->pending) {
+		ind->pending = TRUE;
+		em->pending_indicators = g_slist_append(em->pending_indicators,
+									ind);
+	}
+
+	if (em->indicator_source == 0)
+		em->indicator_source = g_idle_add(flush_indicators_cb, em);
+}
+
 static gboolean notify_ccwa(void *user_data)
 {
 	struct ofono_emulator *em = user_data;
@@ -1182,6 +1252,14 @@ static void emulator_unregister(struct ofono_atom *atom)
 		em->callsetup_source = 0;
 	}
 
+	if (em->indicator_source) {
+		g_source_remove(em->indicator_source);
+		em->indicator_source = 0;
+	}
+
+	g_slist_free(em->pending_indicators);
+	em->pending_indicators = NULL;
+
 	for (l = em->indicators; l; l = l->next) {
 		struct indicator *ind = l->data;
 
@@ -1603,8 +1681,6 @@ enum ofono_emulator_request_type ofono_emulator_request_get_type(
 void ofono_emulator_set_indicator(struct ofono_emulator *em,
 					const char *name, int value)
 {
-	int i;
-	char buf[20];
 	struct indicator *ind;
 	struct indicator *call_ind;
 	struct indicator *cs_ind;
@@ -1612,7 +1688,7 @@ void ofono_emulator_set_indicator(struct ofono_emulator *em,
 	gboolean callsetup;
 	gboolean waiting;
 
-	ind = find_indicator(em, name, &i);
+	ind = find_indicator(em, name, NULL);
 
 	if (ind == NULL || ind->value == value || value < ind->min
 			|| value > ind->max)
@@ -1636,13 +1712,7 @@ void ofono_emulator_set_indicator(struct ofono_emulator *em,
 	if (waiting)
 		notify_ccwa(em);
 
-	if (em->events_mode == 3 && em->events_ind && em->slc && ind->active) {
-		if (!g_at_server_command_pending(em->server)) {
-			sprintf(buf, "+CIEV: %d,%d", i, ind->value);
-			g_at_server_send_unsolicited(em->server, buf);
-		} else
-			ind->deferred = TRUE;
-	}
+	queue_indicator(em, ind);
 
 	/*
 	 * Ring timer should be started when:
@@ -1674,6 +1744,8 @@ void ofono_emulator_set_indicator(struct ofono_emulator *em,
 	}
 
 start_ring:
+	/* The first RING has to follow the +CIEV */
+	flush_indicators(em);
 	notify_ring(em);
 	em->callsetup_source = g_timeout_add_seconds(RING_TIMEOUT,
 							notify_ring, em);
@@ -1682,24 +1754,16 @@ start_ring:
 void __ofono_emulator_set_indicator_forced(struct ofono_emulator *em,
 						const char *name, int value)
 {
-	int i;
 	struct indicator *ind;
-	char buf[20];
 
-	ind = find_indicator(em, name, &i);
+	ind = find_indicator(em, name, NULL);
 
 	if (ind == NULL || value < ind->min || value > ind->max)
 		return;
 
 	ind->value = value;
 
-	if (em->events_mode == 3 && em->events_ind && em->slc && ind->active) {
-		if (!g_at_server_command_pending(em->server)) {
-			sprintf(buf, "+CIEV: %d,%d", i, ind->value);
-			g_at_server_send_unsolicited(em->server, buf);
-		} else
-			ind->deferred = TRUE;
-	}
+	queue_indicator(em, ind);
 }
 
 void __ofono_emulator_slc_condition(struct ofono_emulator *em,
@@ -24,6 +24,9 @@ struct gprs_filter_request_fn {
 	gboolean (*can_process)(const struct ofono_gprs_filter *filter);
 	guint (*process)(const struct ofono_gprs_filter *filter,
 					struct gprs_filter_request *req);
+	gboolean (*can_check)(const struct ofono_gprs_filter *filter);
+	gboolean (*check)(const struct ofono_gprs_filter *filter,
+					struct gprs_filter_request *req);
 	void (*complete)(struct gprs_filter_request *req, gboolean allow);
 	void (*free)(struct gprs_filter_request *req);
 };
@@ -169,21 +172,29 @@ static void gprs_filter_request_complete(struct gprs_filter_request *req,
 static void gprs_filter_request_process(struct gprs_filter_request *req)
 {
 	GSList *l = req->filter_link;
-	const struct ofono_gprs_filter *f = l->data;
 	const struct gprs_filter_request_fn *fn = req->fn;
 
-	while (f && !fn->can_process(f)) {
+	gprs_filter_request_ref(req);
+	while (l) {
+		const struct ofono_gprs_filter *f = l->data;
+
+		if (fn->can_check(f)) {
+			/* Synchronous verdict, no need to wait for it */
+			if (!fn->check(f, req)) {
+				DBG("%s not allowing %s", f->name, fn->name);
+				break;
+			}
+		} else if (fn->can_process(f)) {
+			req->filter_link = l;
+			req->pending_id = fn->process(f, req);
+			gprs_filter_request_unref(req);
+			return;
+		}
 		l = l->next;
-		f = l ? l->data : NULL;
 	}
 
-	gprs_filter_request_ref(req);
-	if (f) {
-		req->filter_link = l;
-		req->pending_id = fn->process(f, req);
-	} else {
-		gprs_filter_request_complete(req, TRUE);
-	}
+	/* Either all filters are fine with it or one of them said no */
+	gprs_filter_request_complete(req, !l);
 	gprs_filter_request_unref(req);
 }
 
@@ -200,11 +211,7 @@ static gboolean gprs_filter_request_continue_cb(gpointer data)
 
 	req->next_id = 0;
 	req->filter_link = req->filter_link->next;
-	if (req->filter_link) {
-		gprs_filter_request_process(req);
-	} else {
-		gprs_filter_request_complete(req, TRUE);
-	}
+	gprs_filter_request_process(req);
 	return G_SOURCE_REMOVE;
 }
 
@@ -277,6 +284,20 @@ static guint gprs_filter_request_activate_process
 				gprs_filter_request_activate_cb, act);
 }
 
+static gboolean gprs_filter_request_activate_can_check
+					(const struct ofono_gprs_filter *f)
+{
+	return f->api_version >= 2 && f->filter_activate_sync != NULL;
+}
+
+static gboolean gprs_filter_request_activate_check
+				(const struct ofono_gprs_filter *f,
+					struct gprs_filter_request *req)
+{
+	return f->filter_activate_sync(req->gc,
+			&gprs_filter_request_activate_cast(req)->ctx);
+}
+
 static void gprs_filter_request_activate_complete
 			(struct gprs_filter_request *req, gboolean allow)
 {
@@ -301,6 +322,8 @@ static struct gprs_filter_request *gprs_filter_request_activate_new
 		.name = "activate",
 		.can_process = gprs_filter_request_activate_can_process,
 		.process = gprs_filter_request_activate_process,
+		.can_check = gprs_filter_request_activate_can_check,
+		.check = gprs_filter_request_activate_check,
 		.complete = gprs_filter_request_activate_complete,
 		.free = gprs_filter_request_activate_free
 	};
@@ -353,6 +376,19 @@ static guint gprs_filter_request_check_process
 					gprs_filter_request_check_cast(req));
 }
 
+static gboolean gprs_filter_request_check_can_check
+					(const struct ofono_gprs_filter *f)
+{
+	return f->api_version >= 2 && f->filter_check_sync != NULL;
+}
+
+static gboolean gprs_filter_request_check_check
+				(const struct ofono_gprs_filter *f,
+					struct gprs_filter_request *req)
+{
+	return f->filter_check_sync(req->chain->gprs);
+}
+
 static void gprs_filter_request_check_complete
 			(struct gprs_filter_request *req, gboolean allow)
 {
@@ -372,6 +408,8 @@ static struct gprs_filter_request *gprs_filter_request_check_new
 		.name = "check",
 		.can_process = gprs_filter_request_check_can_process,
 		.process = gprs_filter_request_check_process,
+		.can_check = gprs_filter_request_check_can_check,
+		.check = gprs_filter_request_check_check,
 		.complete = gprs_filter_request_check_complete,
 		.free = gprs_filter_request_check_free
 	};
@@ -29,10 +29,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <stdlib.h>
-#include <sys/ioctl.h>
 #include <sys/socket.h>
-#include <net/if.h>
-#include <net/route.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <ctype.h>
@@ -49,6 +46,7 @@
 #include "simutil.h"
 #include "util.h"
 #include "watch_p.h"
+#include "if-config.h"
 
 #define GPRS_FLAG_ATTACHING 0x1
 #define GPRS_FLAG_RECHECK 0x2
@@ -61,6 +59,8 @@
 #define MAX_MESSAGE_CENTER_LENGTH 255
 #define MAX_CONTEXTS 256
 #define SUSPEND_TIMEOUT 8
+#define TRAFFIC_SAMPLE_INTERVAL 10
+#define TRAFFIC_SYNC_SAMPLES 30
 
 struct ofono_gprs {
 	GSList *contexts;
@@ -89,6 +89,10 @@ struct ofono_gprs {
 	struct ofono_atom *atom;
 	unsigned int spn_watch;
 	struct gprs_filter_chain *filters;
+	GSList *serial_queue;
+	struct pri_op *serial_op;
+	unsigned int deactivating;
+	ofono_bool_t deactivate_failed;
 };
 
 struct ipv4_settings {
@@ -109,6 +113,7 @@ struct ipv6_settings {
 
 struct context_settings {
 	char *interface;
+	unsigned int mtu;
 	struct ipv4_settings *ipv4;
 	struct ipv6_settings *ipv6;
 };
@@ -117,6 +122,7 @@ struct ofono_gprs_context {
 	struct ofono_gprs *gprs;
 	enum ofono_gprs_context_type type;
 	ofono_bool_t inuse;
+	ofono_bool_t serialized;
 	const struct ofono_gprs_context_driver *driver;
 	void *driver_data;
 	struct context_settings *settings;
@@ -138,6 +144,25 @@ struct pri_context {
 	struct ofono_gprs_primary_context context;
 	struct ofono_gprs_context *context_driver;
 	struct ofono_gprs *gprs;
+	struct if_counters traffic;
+	struct if_counters last_sample;
+	gboolean traffic_dirty;
+	guint64 quota;
+	guint64 usage_threshold;
+	struct context_settings *bearer;	/* Last good settings */
+	char *bearer_prepared;			/* Interface brought up early */
+};
+
+/*
+ * Contexts on different gprs-context atoms are activated and deactivated
+ * in parallel, except on the atoms whose driver can only handle one such
+ * request per modem.  Those wait for their turn in gprs->serial_queue.
+ */
+struct pri_op {
+	struct pri_context *ctx;
+	ofono_bool_t activate;
+	struct ofono_gprs_primary_context context;
+	ofono_gprs_context_cb_t cb;
 };
 
 /*
@@ -148,13 +173,19 @@ struct pri_context {
 #define gprs_attached_update(gprs) ofono_gprs_attached_update(gprs)
 
 static void gprs_netreg_update(struct ofono_gprs *gprs);
-static void gprs_deactivate_next(struct ofono_gprs *gprs);
 static void write_context_settings(struct ofono_gprs *gprs,
 						struct pri_context *context);
+static void write_context_traffic(struct ofono_gprs *gprs,
+						struct pri_context *context);
 
 static GSList *g_drivers = NULL;
 static GSList *g_context_drivers = NULL;
 
+/* Active contexts whose interface counters are being sampled */
+static GSList *g_traffic_contexts = NULL;
+static guint g_traffic_timer = 0;
+static unsigned int g_traffic_samples = 0;
+
 const char *packet_bearer_to_string(int bearer)
 {
 	switch (bearer) {
@@ -427,6 +458,7 @@ static void context_settings_free(struct context_settings *settings)
 
 	g_free(settings->interface);
 	settings->interface = NULL;
+	settings->mtu = 0;
 }
 
 static void context_settings_append_ipv4(struct context_settings *settings,
@@ -581,6 +613,9 @@ static void signal_settings(struct pri_context *ctx, const char *prop,
 	DBusMessageIter iter;
 	struct context_settings *settings;
 
+	__ofono_dbus_properties_invalidate(path,
+					OFONO_CONNECTION_CONTEXT_INTERFACE);
+
 	signal = dbus_message_new_signal(path,
 					OFONO_CONNECTION_CONTEXT_INTERFACE,
 					"PropertyChanged");
@@ -709,143 +744,207 @@ static gboolean pri_parse_proxy(struct pri_context *ctx, const char *proxy)
 	return TRUE;
 }
 
-static void pri_ifupdown(const char *interface, ofono_bool_t active)
+static guint64 pri_traffic_usage(const struct pri_context *ctx)
 {
-	struct ifreq ifr;
-	int sk;
+	return ctx->traffic.rx_bytes + ctx->traffic.tx_bytes;
+}
 
-	if (interface == NULL)
-		return;
+static void pri_traffic_store(struct pri_context *ctx)
+{
+	GKeyFile *settings = ctx->gprs->settings;
+
+	ctx->traffic_dirty = FALSE;
 
-	sk = socket(PF_INET, SOCK_DGRAM, 0);
-	if (sk < 0)
+	if (settings == NULL)
 		return;
 
-	memset(&ifr, 0, sizeof(ifr));
-	strncpy(ifr.ifr_name, interface, IFNAMSIZ);
+	write_context_traffic(ctx->gprs, ctx);
+	storage_sync(ctx->gprs->imsi, SETTINGS_STORE, settings);
+}
 
-	if (ioctl(sk, SIOCGIFFLAGS, &ifr) < 0)
-		goto done;
+static void pri_signal_counter(struct pri_context *ctx, const char *name,
+				unsigned long long old, unsigned long long val)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+	dbus_uint64_t value = val;
 
-	if (active == TRUE) {
-		if (ifr.ifr_flags & IFF_UP)
-			goto done;
-		ifr.ifr_flags |= IFF_UP;
-	} else {
-		if (!(ifr.ifr_flags & IFF_UP))
-			goto done;
-		ifr.ifr_flags &= ~IFF_UP;
-	}
+	if (old == val)
+		return;
 
-	if (ioctl(sk, SIOCSIFFLAGS, &ifr) < 0)
-		ofono_error("Failed to change interface flags");
+	ofono_dbus_signal_property_changed(conn, ctx->path,
+					OFONO_CONNECTION_CONTEXT_INTERFACE,
+					name, DBUS_TYPE_UINT64, &value);
+}
 
-done:
-	close(sk);
+static void pri_signal_usage(struct pri_context *ctx, const char *name)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+	dbus_uint64_t value = pri_traffic_usage(ctx);
+
+	g_dbus_emit_signal(conn, ctx->path, OFONO_CONNECTION_CONTEXT_INTERFACE,
+				name, DBUS_TYPE_UINT64, &value,
+				DBUS_TYPE_INVALID);
 }
 
-static void pri_set_ipv4_addr(const char *interface, const char *address)
+static void pri_traffic_changed(struct pri_context *ctx,
+					const struct if_counters *old)
 {
-	struct ifreq ifr;
-	struct sockaddr_in addr;
-	int sk;
+	guint64 before = old->rx_bytes + old->tx_bytes;
+	guint64 after = pri_traffic_usage(ctx);
+	guint64 threshold = ctx->usage_threshold;
 
-	if (interface == NULL)
-		return;
+	pri_signal_counter(ctx, "RxBytes", old->rx_bytes,
+						ctx->traffic.rx_bytes);
+	pri_signal_counter(ctx, "TxBytes", old->tx_bytes,
+						ctx->traffic.tx_bytes);
+	pri_signal_counter(ctx, "RxPackets", old->rx_packets,
+						ctx->traffic.rx_packets);
+	pri_signal_counter(ctx, "TxPackets", old->tx_packets,
+						ctx->traffic.tx_packets);
 
-	sk = socket(PF_INET, SOCK_DGRAM, 0);
-	if (sk < 0)
-		return;
+	if (threshold && after / threshold > before / threshold)
+		pri_signal_usage(ctx, "UsageThresholdReached");
 
-	memset(&ifr, 0, sizeof(ifr));
-	strncpy(ifr.ifr_name, interface, IFNAMSIZ);
+	if (ctx->quota && before < ctx->quota && after >= ctx->quota)
+		pri_signal_usage(ctx, "QuotaExceeded");
+}
 
-	if (ioctl(sk, SIOCGIFFLAGS, &ifr) < 0)
-		goto done;
+/* Interface counters start over if the interface gets recreated */
+static unsigned long long counter_delta(unsigned long long now,
+						unsigned long long last)
+{
+	return now >= last ? now - last : now;
+}
 
-	memset(&addr, 0, sizeof(addr));
-	addr.sin_family = AF_INET;
-	addr.sin_addr.s_addr = address ? inet_addr(address) : INADDR_ANY;
-	memcpy(&ifr.ifr_addr, &addr, sizeof(ifr.ifr_addr));
+static void pri_traffic_sample(struct pri_context *ctx)
+{
+	struct ofono_gprs_context *gc = ctx->context_driver;
+	struct if_counters *last = &ctx->last_sample;
+	struct if_counters old = ctx->traffic;
+	struct if_counters now;
 
-	if (ioctl(sk, SIOCSIFADDR, &ifr) < 0) {
-		ofono_error("Failed to set interface address");
-		goto done;
+	if (gc == NULL || gc->settings == NULL ||
+			if_config_get_counters(gc->settings->interface,
+								&now) < 0)
+		return;
+
+	ctx->traffic.rx_packets += counter_delta(now.rx_packets,
+							last->rx_packets);
+	ctx->traffic.tx_packets += counter_delta(now.tx_packets,
+							last->tx_packets);
+	ctx->traffic.rx_bytes += counter_delta(now.rx_bytes, last->rx_bytes);
+	ctx->traffic.tx_bytes += counter_delta(now.tx_bytes, last->tx_bytes);
+	*last = now;
+
+	if (memcmp(&old, &ctx->traffic, sizeof(old))) {
+		ctx->traffic_dirty = TRUE;
+		pri_traffic_changed(ctx, &old);
 	}
+}
 
-	if (address == NULL)
-		goto done;
+static gboolean pri_traffic_timeout(gpointer user_data)
+{
+	gboolean sync = (++g_traffic_samples % TRAFFIC_SYNC_SAMPLES) == 0;
+	GSList *l;
 
-	memset(&addr, 0, sizeof(addr));
-	addr.sin_family = AF_INET;
-	addr.sin_addr.s_addr = inet_addr("255.255.255.255");
-	memcpy(&ifr.ifr_netmask, &addr, sizeof(ifr.ifr_netmask));
+	for (l = g_traffic_contexts; l; l = l->next) {
+		struct pri_context *ctx = l->data;
 
-	if (ioctl(sk, SIOCSIFNETMASK, &ifr) < 0)
-		ofono_error("Failed to set interface netmask");
+		pri_traffic_sample(ctx);
 
-done:
-	close(sk);
+		if (sync && ctx->traffic_dirty)
+			pri_traffic_store(ctx);
+	}
+
+	return TRUE;
 }
 
-static void pri_setproxy(const char *interface, const char *proxy)
+static void pri_traffic_start(struct pri_context *ctx)
 {
-	struct rtentry rt;
-	struct sockaddr_in addr;
-	in_addr_t proxy_addr;
-	int sk;
+	const char *interface = ctx->context_driver->settings->interface;
 
-	if (interface == NULL)
+	if (g_slist_find(g_traffic_contexts, ctx))
 		return;
 
-	proxy_addr = inet_addr(proxy);
-	if (proxy_addr == INADDR_NONE)
-		return;
+	/* Whatever went through the interface before isn't ours */
+	if_config_get_counters(interface, &ctx->last_sample);
+
+	g_traffic_contexts = g_slist_prepend(g_traffic_contexts, ctx);
 
-	sk = socket(PF_INET, SOCK_DGRAM, 0);
-	if (sk < 0)
+	if (g_traffic_timer == 0)
+		g_traffic_timer = g_timeout_add_seconds(TRAFFIC_SAMPLE_INTERVAL,
+						pri_traffic_timeout, NULL);
+}
+
+static void pri_traffic_stop(struct pri_context *ctx)
+{
+	if (!g_slist_find(g_traffic_contexts, ctx))
 		return;
 
-	memset(&rt, 0, sizeof(rt));
-	rt.rt_flags = RTF_UP | RTF_HOST;
-	rt.rt_dev = (char *) interface;
+	pri_traffic_sample(ctx);
+	g_traffic_contexts = g_slist_remove(g_traffic_contexts, ctx);
 
-	memset(&addr, 0, sizeof(addr));
-	addr.sin_family = AF_INET;
-	addr.sin_addr.s_addr = proxy_addr;
-	memcpy(&rt.rt_dst, &addr, sizeof(rt.rt_dst));
+	if (ctx->traffic_dirty)
+		pri_traffic_store(ctx);
 
-	memset(&addr, 0, sizeof(addr));
-	addr.sin_family = AF_INET;
-	addr.sin_addr.s_addr = INADDR_ANY;
-	memcpy(&rt.rt_gateway, &addr, sizeof(rt.rt_gateway));
+	if (g_traffic_contexts == NULL && g_traffic_timer) {
+		g_source_remove(g_traffic_timer);
+		g_traffic_timer = 0;
+	}
+}
 
-	memset(&addr, 0, sizeof(addr));
-	addr.sin_family = AF_INET;
-	addr.sin_addr.s_addr = INADDR_ANY;
-	memcpy(&rt.rt_genmask, &addr, sizeof(rt.rt_genmask));
+static void pri_ifupdown(const char *interface, ofono_bool_t active)
+{
+	struct if_config *conf = if_config_new(interface);
 
-	if (ioctl(sk, SIOCADDRT, &rt) < 0)
-		ofono_error("Failed to add proxy host route");
+	if (conf == NULL)
+		return;
 
-	close(sk);
+	if_config_set_up(conf, active);
+	if_config_commit(conf);
+	if_config_free(conf);
+}
+
+/* Removes the MMS address, if any, and takes the interface down */
+static void pri_teardown_interface(const char *interface,
+					const char *address)
+{
+	struct if_config *conf = if_config_new(interface);
+
+	if (conf == NULL)
+		return;
+
+	if (address)
+		if_config_del_address(conf, address, 32);
+
+	if_config_set_up(conf, FALSE);
+	if_config_commit(conf);
+	if_config_free(conf);
 }
 
 static void pri_reset_context_settings(struct pri_context *ctx)
 {
 	struct context_settings *settings;
 	char *interface;
+	char *address = NULL;
 	gboolean signal_ipv4;
 	gboolean signal_ipv6;
 
 	if (ctx->context_driver == NULL)
 		return;
 
+	pri_traffic_stop(ctx);
+
 	settings = ctx->context_driver->settings;
 
 	interface = settings->interface;
 	settings->interface = NULL;
 
+	if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS && settings->ipv4) {
+		address = settings->ipv4->ip;
+		settings->ipv4->ip = NULL;
+	}
+
 	signal_ipv4 = settings->ipv4 != NULL;
 	signal_ipv6 = settings->ipv6 != NULL;
 
@@ -854,22 +953,23 @@ static void pri_reset_context_settings(struct pri_context *ctx)
 	pri_context_signal_settings(ctx, signal_ipv4, signal_ipv6);
 
 	if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS) {
-		pri_set_ipv4_addr(interface, NULL);
-
 		g_free(ctx->proxy_host);
 		ctx->proxy_host = NULL;
 		ctx->proxy_port = 0;
 	}
 
-	pri_ifupdown(interface, FALSE);
+	pri_teardown_interface(interface, address);
 
+	g_free(address);
 	g_free(interface);
 }
 
-static void pri_update_mms_context_settings(struct pri_context *ctx)
+static void pri_update_mms_context_settings(struct pri_context *ctx,
+						struct if_config *conf)
 {
 	struct ofono_gprs_context *gc = ctx->context_driver;
 	struct context_settings *settings = gc->settings;
+	struct in_addr proxy_addr;
 
 	if (ctx->message_proxy)
 		settings->ipv4->proxy = g_strdup(ctx->message_proxy);
@@ -879,10 +979,428 @@ static void pri_update_mms_context_settings(struct pri_context *ctx)
 
 	DBG("proxy %s port %u", ctx->proxy_host, ctx->proxy_port);
 
-	pri_set_ipv4_addr(settings->interface, settings->ipv4->ip);
+	if (settings->ipv4->ip)
+		if_config_add_address(conf, settings->ipv4->ip, 32);
+
+	if (ctx->proxy_host &&
+			inet_pton(AF_INET, ctx->proxy_host, &proxy_addr) == 1)
+		if_config_add_route(conf, ctx->proxy_host, 32, NULL);
+}
+
+/*
+ * Brings the interface up and, for MMS contexts, adds the address and
+ * the proxy host route, all in one netlink batch.
+ */
+static void pri_setup_interface(struct pri_context *ctx)
+{
+	struct context_settings *settings = ctx->context_driver->settings;
+	struct if_config *conf = if_config_new(settings->interface);
+
+	if (conf == NULL)
+		return;
+
+	if (settings->mtu)
+		if_config_set_mtu(conf, settings->mtu);
+
+	if_config_set_up(conf, TRUE);
+
+	if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS && settings->ipv4)
+		pri_update_mms_context_settings(ctx, conf);
+
+	if_config_commit(conf);
+	if_config_free(conf);
+}
+
+/*
+ * The settings of the last successful activation of a context are kept
+ * in the settings store together with the APN, protocol and
+ * authentication method they were obtained with.  After a modem reset
+ * they let the interface come up while the activation is still in
+ * progress, and let the connection manager register before the
+ * provisioning database has been consulted.  Once the network has
+ * confirmed the activation they are compared with what it gave us and
+ * replaced if anything has changed.
+ */
+static const char *bearer_keys[] = {
+	"BearerAccessPointName",
+	"BearerProtocol",
+	"BearerAuthenticationMethod",
+	"BearerInterface",
+	"BearerMTU",
+	"BearerIPv4Static",
+	"BearerIPv4Address",
+	"BearerIPv4Netmask",
+	"BearerIPv4Gateway",
+	"BearerIPv4DNS",
+	"BearerIPv6Address",
+	"BearerIPv6PrefixLength",
+	"BearerIPv6Gateway",
+	"BearerIPv6DNS",
+	NULL
+};
+
+static gboolean strv_equal(char **a, char **b)
+{
+	if (a == NULL || b == NULL)
+		return a == b;
+
+	for (; *a && *b; a++, b++)
+		if (strcmp(*a, *b))
+			return FALSE;
+
+	return *a == *b;
+}
+
+static gboolean context_settings_equal(const struct context_settings *a,
+					const struct context_settings *b)
+{
+	if (g_strcmp0(a->interface, b->interface) || a->mtu != b->mtu)
+		return FALSE;
+
+	if (!a->ipv4 != !b->ipv4 || !a->ipv6 != !b->ipv6)
+		return FALSE;
+
+	if (a->ipv4 && (a->ipv4->static_ip != b->ipv4->static_ip ||
+			g_strcmp0(a->ipv4->ip, b->ipv4->ip) ||
+			g_strcmp0(a->ipv4->netmask, b->ipv4->netmask) ||
+			g_strcmp0(a->ipv4->gateway, b->ipv4->gateway) ||
+			!strv_equal(a->ipv4->dns, b->ipv4->dns)))
+		return FALSE;
+
+	if (a->ipv6 && (a->ipv6->prefix_len != b->ipv6->prefix_len ||
+			g_strcmp0(a->ipv6->ip, b->ipv6->ip) ||
+			g_strcmp0(a->ipv6->gateway, b->ipv6->gateway) ||
+			!strv_equal(a->ipv6->dns, b->ipv6->dns)))
+		return FALSE;
+
+	return TRUE;
+}
+
+static struct context_settings *context_settings_dup(
+					const struct context_settings *src)
+{
+	struct context_settings *dst = g_new0(struct context_settings, 1);
+
+	dst->interface = g_strdup(src->interface);
+	dst->mtu = src->mtu;
+
+	if (src->ipv4) {
+		dst->ipv4 = g_new0(struct ipv4_settings, 1);
+		dst->ipv4->static_ip = src->ipv4->static_ip;
+		dst->ipv4->ip = g_strdup(src->ipv4->ip);
+		dst->ipv4->netmask = g_strdup(src->ipv4->netmask);
+		dst->ipv4->gateway = g_strdup(src->ipv4->gateway);
+		dst->ipv4->dns = g_strdupv(src->ipv4->dns);
+	}
+
+	if (src->ipv6) {
+		dst->ipv6 = g_new0(struct ipv6_settings, 1);
+		dst->ipv6->ip = g_strdup(src->ipv6->ip);
+		dst->ipv6->prefix_len = src->ipv6->prefix_len;
+		dst->ipv6->gateway = g_strdup(src->ipv6->gateway);
+		dst->ipv6->dns = g_strdupv(src->ipv6->dns);
+	}
+
+	return dst;
+}
+
+static void bearer_remove_keys(GKeyFile *settings, const char *group)
+{
+	const char **key;
+
+	for (key = bearer_keys; *key; key++)
+		g_key_file_remove_key(settings, group, *key, NULL);
+}
+
+static void bearer_set_string(GKeyFile *settings, const char *group,
+				const char *key, const char *value)
+{
+	if (value)
+		g_key_file_set_string(settings, group, key, value);
+}
+
+static void bearer_set_dns(GKeyFile *settings, const char *group,
+				const char *key, char **dns)
+{
+	if (dns)
+		g_key_file_set_string_list(settings, group, key,
+					(const gchar * const *) dns,
+					g_strv_length(dns));
+}
+
+static void write_context_bearer(struct ofono_gprs *gprs,
+					struct pri_context *ctx)
+{
+	GKeyFile *settings = gprs->settings;
+	const struct context_settings *bearer = ctx->bearer;
+	const char *group = ctx->key;
+
+	bearer_remove_keys(settings, group);
+
+	g_key_file_set_string(settings, group, "BearerAccessPointName",
+				ctx->context.apn);
+	g_key_file_set_string(settings, group, "BearerProtocol",
+				gprs_proto_to_string(ctx->context.proto));
+	g_key_file_set_string(settings, group, "BearerAuthenticationMethod",
+			gprs_auth_method_to_string(ctx->context.auth_method));
+	g_key_file_set_string(settings, group, "BearerInterface",
+				bearer->interface);
+
+	if (bearer->mtu)
+		g_key_file_set_integer(settings, group, "BearerMTU",
+					bearer->mtu);
+
+	if (bearer->ipv4) {
+		const struct ipv4_settings *ipv4 = bearer->ipv4;
+
+		g_key_file_set_boolean(settings, group, "BearerIPv4Static",
+					ipv4->static_ip);
+		bearer_set_string(settings, group, "BearerIPv4Address",
+					ipv4->ip);
+		bearer_set_string(settings, group, "BearerIPv4Netmask",
+					ipv4->netmask);
+		bearer_set_string(settings, group, "BearerIPv4Gateway",
+					ipv4->gateway);
+		bearer_set_dns(settings, group, "BearerIPv4DNS", ipv4->dns);
+	}
+
+	if (bearer->ipv6) {
+		const struct ipv6_settings *ipv6 = bearer->ipv6;
+
+		g_key_file_set_integer(settings, group,
+					"BearerIPv6PrefixLength",
+					ipv6->prefix_len);
+		bearer_set_string(settings, group, "BearerIPv6Address",
+					ipv6->ip);
+		bearer_set_string(settings, group, "BearerIPv6Gateway",
+					ipv6->gateway);
+		bearer_set_dns(settings, group, "BearerIPv6DNS", ipv6->dns);
+	}
+}
+
+static void read_context_bearer(struct ofono_gprs *gprs, const char *group,
+					struct pri_context *ctx)
+{
+	GKeyFile *settings = gprs->settings;
+	struct context_settings *bearer;
+	char *interface;
+	char *apn;
+	char *proto;
+	char *auth;
+	gboolean valid;
+	int mtu;
+
+	interface = g_key_file_get_string(settings, group,
+						"BearerInterface", NULL);
+	if (interface == NULL)
+		return;
+
+	apn = g_key_file_get_string(settings, group,
+					"BearerAccessPointName", NULL);
+	proto = g_key_file_get_string(settings, group,
+					"BearerProtocol", NULL);
+	auth = g_key_file_get_string(settings, group,
+					"BearerAuthenticationMethod", NULL);
+
+	valid = !g_strcmp0(apn, ctx->context.apn) &&
+		!g_strcmp0(proto, gprs_proto_to_string(ctx->context.proto)) &&
+		!g_strcmp0(auth, gprs_auth_method_to_string(
+						ctx->context.auth_method));
+
+	g_free(apn);
+	g_free(proto);
+	g_free(auth);
+
+	if (!valid) {
+		DBG("%s: dropping stale bearer", group);
+		bearer_remove_keys(settings, group);
+		g_free(interface);
+		return;
+	}
+
+	bearer = g_new0(struct context_settings, 1);
+	bearer->interface = interface;
+
+	mtu = g_key_file_get_integer(settings, group, "BearerMTU", NULL);
+	if (mtu > 0)
+		bearer->mtu = mtu;
+
+	if (g_key_file_has_key(settings, group, "BearerIPv4Static", NULL)) {
+		struct ipv4_settings *ipv4 = g_new0(struct ipv4_settings, 1);
+
+		ipv4->static_ip = g_key_file_get_boolean(settings, group,
+						"BearerIPv4Static", NULL);
+		ipv4->ip = g_key_file_get_string(settings, group,
+						"BearerIPv4Address", NULL);
+		ipv4->netmask = g_key_file_get_string(settings, group,
+						"BearerIPv4Netmask", NULL);
+		ipv4->gateway = g_key_file_get_string(settings, group,
+						"BearerIPv4Gateway", NULL);
+		ipv4->dns = g_key_file_get_string_list(settings, group,
+						"BearerIPv4DNS", NULL, NULL);
+		bearer->ipv4 = ipv4;
+	}
+
+	if (g_key_file_has_key(settings, group, "BearerIPv6PrefixLength",
+								NULL)) {
+		struct ipv6_settings *ipv6 = g_new0(struct ipv6_settings, 1);
+
+		ipv6->prefix_len = g_key_file_get_integer(settings, group,
+						"BearerIPv6PrefixLength", NULL);
+		ipv6->ip = g_key_file_get_string(settings, group,
+						"BearerIPv6Address", NULL);
+		ipv6->gateway = g_key_file_get_string(settings, group,
+						"BearerIPv6Gateway", NULL);
+		ipv6->dns = g_key_file_get_string_list(settings, group,
+						"BearerIPv6DNS", NULL, NULL);
+		bearer->ipv6 = ipv6;
+	}
+
+	DBG("%s: bearer on %s", group, interface);
+	ctx->bearer = bearer;
+}
+
+static void pri_bearer_free(struct pri_context *ctx)
+{
+	if (ctx->bearer == NULL)
+		return;
+
+	context_settings_free(ctx->bearer);
+	g_free(ctx->bearer);
+	ctx->bearer = NULL;
+}
+
+/* The APN or the credentials have changed, what we knew is useless */
+static void pri_bearer_forget(struct pri_context *ctx)
+{
+	if (ctx->bearer == NULL)
+		return;
+
+	DBG("%p", ctx);
+
+	pri_bearer_free(ctx);
+
+	if (ctx->gprs->settings)
+		bearer_remove_keys(ctx->gprs->settings, ctx->key);
+}
+
+static gboolean gprs_interface_in_use(struct ofono_gprs *gprs,
+					const char *interface,
+					struct pri_context *except)
+{
+	GSList *l;
+
+	for (l = gprs->contexts; l; l = l->next) {
+		struct pri_context *ctx = l->data;
+
+		if (ctx == except || ctx->context_driver == NULL)
+			continue;
+
+		if (!g_strcmp0(ctx->context_driver->settings->interface,
+								interface))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/*
+ * Brings up the interface that the context had last time, with its MTU,
+ * before the driver is asked to activate it.  Addresses are left alone
+ * until the network has confirmed them.
+ */
+static void pri_bearer_prepare(struct pri_context *ctx)
+{
+	const struct context_settings *bearer = ctx->bearer;
+	struct if_config *conf;
+
+	if (bearer == NULL || ctx->bearer_prepared)
+		return;
+
+	if (gprs_interface_in_use(ctx->gprs, bearer->interface, ctx))
+		return;
+
+	conf = if_config_new(bearer->interface);
+	if (conf == NULL)
+		return;
+
+	DBG("%p %s mtu %u", ctx, bearer->interface, bearer->mtu);
+
+	if (bearer->mtu)
+		if_config_set_mtu(conf, bearer->mtu);
+
+	if_config_set_up(conf, TRUE);
+
+	if (if_config_commit(conf) == 0)
+		ctx->bearer_prepared = g_strdup(bearer->interface);
+
+	if_config_free(conf);
+}
+
+/*
+ * Takes the prepared interface down again unless the activation has
+ * succeeded on it.
+ */
+static void pri_bearer_unprepare(struct pri_context *ctx, gboolean success)
+{
+	char *interface = ctx->bearer_prepared;
+	const char *actual = NULL;
+
+	if (interface == NULL)
+		return;
+
+	ctx->bearer_prepared = NULL;
+
+	if (success)
+		actual = ctx->context_driver->settings->interface;
+
+	if (g_strcmp0(interface, actual) &&
+			!gprs_interface_in_use(ctx->gprs, interface, ctx)) {
+		DBG("%p %s", ctx, interface);
+		pri_ifupdown(interface, FALSE);
+	}
+
+	g_free(interface);
+}
+
+/* Compares what the network gave us with the cached bearer */
+static void pri_bearer_update(struct pri_context *ctx)
+{
+	struct ofono_gprs *gprs = ctx->gprs;
+	const struct context_settings *settings = ctx->context_driver->settings;
+
+	pri_bearer_unprepare(ctx, TRUE);
+
+	if (gprs->settings == NULL || settings->interface == NULL)
+		return;
+
+	if (ctx->bearer) {
+		if (context_settings_equal(ctx->bearer, settings)) {
+			DBG("%p bearer as cached", ctx);
+			return;
+		}
+
+		DBG("%p bearer has changed", ctx);
+		pri_bearer_free(ctx);
+	}
+
+	ctx->bearer = context_settings_dup(settings);
+	write_context_bearer(gprs, ctx);
+	storage_sync(gprs->imsi, SETTINGS_STORE, gprs->settings);
+}
+
+static gboolean gprs_have_bearer(struct ofono_gprs *gprs)
+{
+	GSList *l;
+
+	for (l = gprs->contexts; l; l = l->next) {
+		struct pri_context *ctx = l->data;
+
+		if (ctx->bearer)
+			return TRUE;
+	}
 
-	if (ctx->proxy_host)
-		pri_setproxy(settings->interface, ctx->proxy_host);
+	return FALSE;
 }
 
 static gboolean pri_str_changed(const char *val, const char *newval)
@@ -919,6 +1437,7 @@ static void pri_settings_changed(struct pri_context *ctx)
 {
 	const char *path = __ofono_atom_get_path(ctx->gprs->atom);
 
+	pri_bearer_forget(ctx);
 	__ofono_watch_gprs_settings_changed(path, ctx->type, &ctx->context);
 }
 
@@ -1107,6 +1626,7 @@ static void append_context_properties(struct pri_context *ctx,
 	const char *proto = gprs_proto_to_string(ctx->context.proto);
 	const char *name = ctx->name;
 	dbus_bool_t value;
+	dbus_uint64_t counter;
 	const char *strvalue;
 	struct context_settings *settings;
 
@@ -1135,6 +1655,25 @@ static void append_context_properties(struct pri_context *ctx,
 	ofono_dbus_dict_append(dict, "AuthenticationMethod", DBUS_TYPE_STRING,
 				&strvalue);
 
+	counter = ctx->traffic.rx_bytes;
+	ofono_dbus_dict_append(dict, "RxBytes", DBUS_TYPE_UINT64, &counter);
+
+	counter = ctx->traffic.tx_bytes;
+	ofono_dbus_dict_append(dict, "TxBytes", DBUS_TYPE_UINT64, &counter);
+
+	counter = ctx->traffic.rx_packets;
+	ofono_dbus_dict_append(dict, "RxPackets", DBUS_TYPE_UINT64, &counter);
+
+	counter = ctx->traffic.tx_packets;
+	ofono_dbus_dict_append(dict, "TxPackets", DBUS_TYPE_UINT64, &counter);
+
+	counter = ctx->quota;
+	ofono_dbus_dict_append(dict, "Quota", DBUS_TYPE_UINT64, &counter);
+
+	counter = ctx->usage_threshold;
+	ofono_dbus_dict_append(dict, "UsageThreshold", DBUS_TYPE_UINT64,
+				&counter);
+
 	if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS) {
 		strvalue = ctx->message_proxy;
 		ofono_dbus_dict_append(dict, "MessageProxy",
@@ -1154,27 +1693,18 @@ static void append_context_properties(struct pri_context *ctx,
 	context_settings_append_ipv6_dict(settings, dict);
 }
 
+static void pri_append_properties(DBusMessageIter *dict, void *data)
+{
+	append_context_properties(data, dict);
+}
+
 static DBusMessage *pri_get_properties(DBusConnection *conn,
 					DBusMessage *msg, void *data)
 {
 	struct pri_context *ctx = data;
-	DBusMessage *reply;
-	DBusMessageIter iter;
-	DBusMessageIter dict;
-
-	reply = dbus_message_new_method_return(msg);
-	if (reply == NULL)
-		return NULL;
 
-	dbus_message_iter_init_append(reply, &iter);
-
-	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-					OFONO_PROPERTIES_ARRAY_SIGNATURE,
-					&dict);
-	append_context_properties(ctx, &dict);
-	dbus_message_iter_close_container(&iter, &dict);
-
-	return reply;
+	return __ofono_dbus_properties_reply(msg, ctx->path,
+					OFONO_CONNECTION_CONTEXT_INTERFACE);
 }
 
 static void pri_activate_callback(const struct ofono_error *error, void *data)
@@ -1189,6 +1719,7 @@ static void pri_activate_callback(const struct ofono_error *error, void *data)
 				telephony_error_to_str(error));
 		__ofono_dbus_pending_reply(&ctx->pending,
 					__ofono_error_failed(ctx->pending));
+		pri_bearer_unprepare(ctx, FALSE);
 		context_settings_free(ctx->context_driver->settings);
 		release_context(ctx);
 		return;
@@ -1200,12 +1731,11 @@ static void pri_activate_callback(const struct ofono_error *error, void *data)
 	__ofono_dbus_pending_reply(&ctx->pending,
 				dbus_message_new_method_return(ctx->pending));
 
-	if (gc->settings->interface != NULL) {
-		pri_ifupdown(gc->settings->interface, TRUE);
+	pri_bearer_update(ctx);
 
-		if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS &&
-				gc->settings->ipv4)
-			pri_update_mms_context_settings(ctx);
+	if (gc->settings->interface != NULL) {
+		pri_setup_interface(ctx);
+		pri_traffic_start(ctx);
 
 		pri_context_signal_settings(ctx, gc->settings->ipv4 != NULL,
 						gc->settings->ipv6 != NULL);
@@ -1287,15 +1817,18 @@ static void pri_read_settings_callback(const struct ofono_error *error,
 	if (error->type != OFONO_ERROR_TYPE_NO_ERROR) {
 		DBG("Reading context settings failed with error: %s",
 				telephony_error_to_str(error));
+		pri_bearer_unprepare(pri_ctx, FALSE);
 		context_settings_free(pri_ctx->context_driver->settings);
 		release_context(pri_ctx);
 		return;
 	}
 
 	pri_ctx->active = TRUE;
+	pri_bearer_update(pri_ctx);
 
 	if (gc->settings->interface != NULL) {
 		pri_ifupdown(gc->settings->interface, TRUE);
+		pri_traffic_start(pri_ctx);
 
 		pri_context_signal_settings(pri_ctx, gc->settings->ipv4 != NULL,
 						gc->settings->ipv6 != NULL);
@@ -1349,6 +1882,37 @@ static DBusMessage *pri_set_apn(struct pri_context *ctx, DBusConnection *conn,
 	return NULL;
 }
 
+static DBusMessage *pri_set_usage_limit(struct pri_context *ctx,
+					DBusConnection *conn, DBusMessage *msg,
+					const char *property, guint64 *limit,
+					guint64 value)
+{
+	GKeyFile *settings = ctx->gprs->settings;
+	dbus_uint64_t v = value;
+
+	if (*limit == value)
+		return dbus_message_new_method_return(msg);
+
+	*limit = value;
+
+	if (settings) {
+		g_key_file_set_uint64(settings, ctx->key, property, value);
+		storage_sync(ctx->gprs->imsi, SETTINGS_STORE, settings);
+	}
+
+	g_dbus_send_reply(conn, msg, DBUS_TYPE_INVALID);
+
+	ofono_dbus_signal_property_changed(conn, ctx->path,
+					OFONO_CONNECTION_CONTEXT_INTERFACE,
+					property, DBUS_TYPE_UINT64, &v);
+
+	/* A quota that has already been used up is exceeded right away */
+	if (limit == &ctx->quota && value && pri_traffic_usage(ctx) >= value)
+		pri_signal_usage(ctx, "QuotaExceeded");
+
+	return NULL;
+}
+
 static DBusMessage *pri_set_username(struct pri_context *ctx,
 					DBusConnection *conn, DBusMessage *msg,
 					const char *username)
@@ -1592,6 +2156,123 @@ struct pri_request_data {
 	DBusMessage *msg;
 };
 
+static void pri_op_done(const struct ofono_error *error, void *data);
+
+static void pri_op_start(struct pri_op *op)
+{
+	struct ofono_gprs_context *gc = op->ctx->context_driver;
+
+	if (op->activate)
+		gc->driver->activate_primary(gc, &op->context, pri_op_done,
+									op);
+	else
+		gc->driver->deactivate_primary(gc, op->ctx->context.cid,
+							pri_op_done, op);
+}
+
+static void gprs_serial_next(struct ofono_gprs *gprs)
+{
+	struct pri_op *op;
+
+	if (gprs->serial_op || gprs->serial_queue == NULL)
+		return;
+
+	op = gprs->serial_queue->data;
+	gprs->serial_queue = g_slist_delete_link(gprs->serial_queue,
+							gprs->serial_queue);
+	gprs->serial_op = op;
+	pri_op_start(op);
+}
+
+static void pri_op_done(const struct ofono_error *error, void *data)
+{
+	struct pri_op *op = data;
+	struct ofono_gprs *gprs = op->ctx->gprs;
+	gboolean serial = gprs->serial_op == op;
+
+	if (serial)
+		gprs->serial_op = NULL;
+
+	op->cb(error, op->ctx);
+	g_free(op);
+
+	if (serial)
+		gprs_serial_next(gprs);
+}
+
+static void pri_op_submit(struct pri_context *ctx,
+			const struct ofono_gprs_primary_context *context,
+			ofono_gprs_context_cb_t cb)
+{
+	struct ofono_gprs *gprs = ctx->gprs;
+	struct pri_op *op = g_new0(struct pri_op, 1);
+
+	op->ctx = ctx;
+	op->cb = cb;
+
+	if (context) {
+		op->activate = TRUE;
+		op->context = *context;
+	}
+
+	if (!ctx->context_driver->serialized) {
+		pri_op_start(op);
+		return;
+	}
+
+	DBG("%p queued", ctx);
+	gprs->serial_queue = g_slist_append(gprs->serial_queue, op);
+	gprs_serial_next(gprs);
+}
+
+static void pri_activate(struct pri_context *ctx,
+			const struct ofono_gprs_primary_context *context,
+			ofono_gprs_context_cb_t cb)
+{
+	pri_op_submit(ctx, context, cb);
+}
+
+static void pri_deactivate(struct pri_context *ctx,
+				ofono_gprs_context_cb_t cb)
+{
+	pri_op_submit(ctx, NULL, cb);
+}
+
+/*
+ * Fails the requests that haven't been passed to the driver yet, so that
+ * whoever is waiting for them gets a reply.
+ */
+static void pri_op_cancel(struct pri_context *ctx)
+{
+	struct ofono_gprs *gprs = ctx->gprs;
+	GSList *cancelled = NULL;
+	GSList *l = gprs->serial_queue;
+
+	while (l) {
+		struct pri_op *op = l->data;
+		GSList *next = l->next;
+
+		if (op->ctx == ctx) {
+			gprs->serial_queue = g_slist_delete_link(
+						gprs->serial_queue, l);
+			cancelled = g_slist_append(cancelled, op);
+		}
+
+		l = next;
+	}
+
+	/* The callbacks may queue new requests */
+	for (l = cancelled; l; l = l->next) {
+		struct pri_op *op = l->data;
+
+		DBG("%p cancelled", ctx);
+		CALLBACK_WITH_FAILURE(op->cb, op->ctx);
+		g_free(op);
+	}
+
+	g_slist_free(cancelled);
+}
+
 static struct pri_request_data *pri_request_new(struct pri_context *pri)
 {
 	struct pri_request_data *data = g_new0(struct pri_request_data, 1);
@@ -1622,10 +2303,8 @@ static void pri_activate_filt(const struct ofono_gprs_primary_context *ctx,
 
 	data->msg = NULL;
 	if (ctx) {
-		struct ofono_gprs_context *gc = pri->context_driver;
-
-		gc->driver->activate_primary(gc, ctx, pri_activate_callback,
-									pri);
+		pri_bearer_prepare(pri);
+		pri_activate(pri, ctx, pri_activate_callback);
 	} else if (pri->pending != NULL) {
 		__ofono_dbus_pending_reply(&pri->pending,
 				__ofono_error_access_denied(pri->pending));
@@ -1695,12 +2374,25 @@ static DBusMessage *pri_set_property(DBusConnection *conn,
 				gc, &ctx->context, pri_activate_filt,
 				pri_request_free, pri_request_new(ctx));
 		else
-			gc->driver->deactivate_primary(gc, ctx->context.cid,
-						pri_deactivate_callback, ctx);
+			pri_deactivate(ctx, pri_deactivate_callback);
 
 		return NULL;
 	}
 
+	if (g_str_equal(property, "Quota") ||
+			g_str_equal(property, "UsageThreshold")) {
+		dbus_uint64_t limit;
+
+		if (dbus_message_iter_get_arg_type(&var) != DBUS_TYPE_UINT64)
+			return __ofono_error_invalid_args(msg);
+
+		dbus_message_iter_get_basic(&var, &limit);
+
+		return pri_set_usage_limit(ctx, conn, msg, property,
+					property[0] == 'Q' ? &ctx->quota :
+					&ctx->usage_threshold, limit);
+	}
+
 	/* All other properties are read-only when context is active */
 	if (ctx->active == TRUE)
 		return __ofono_error_in_use(msg);
@@ -1778,6 +2470,23 @@ static DBusMessage *pri_set_property(DBusConnection *conn,
 	return __ofono_error_invalid_args(msg);
 }
 
+static DBusMessage *pri_reset_counters(DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	struct pri_context *ctx = data;
+	struct if_counters old = ctx->traffic;
+
+	if (!connctx_allow(msg, OFONO_DBUS_ACCESS_CONNCTX_RESET_COUNTERS,
+									NULL))
+		return __ofono_error_access_denied(msg);
+
+	memset(&ctx->traffic, 0, sizeof(ctx->traffic));
+	pri_traffic_store(ctx);
+	pri_traffic_changed(ctx, &old);
+
+	return dbus_message_new_method_return(msg);
+}
+
 static const GDBusMethodTable context_methods[] = {
 	{ GDBUS_METHOD("GetProperties",
 			NULL, GDBUS_ARGS({ "properties", "a{sv}" }),
@@ -1787,12 +2496,18 @@ static const GDBusMethodTable context_methods[] = {
 			NULL, pri_set_property) },
 	{ GDBUS_METHOD("ProvisionContext", NULL, NULL,
 			pri_provision_context) },
+	{ GDBUS_METHOD("ResetCounters", NULL, NULL,
+			pri_reset_counters) },
 	{ }
 };
 
 static const GDBusSignalTable context_signals[] = {
 	{ GDBUS_SIGNAL("PropertyChanged",
 			GDBUS_ARGS({ "name", "s" }, { "value", "v" })) },
+	{ GDBUS_SIGNAL("UsageThresholdReached",
+			GDBUS_ARGS({ "usage", "t" })) },
+	{ GDBUS_SIGNAL("QuotaExceeded",
+			GDBUS_ARGS({ "usage", "t" })) },
 	{ }
 };
 
@@ -1824,6 +2539,8 @@ static void pri_context_destroy(gpointer userdata)
 {
 	struct pri_context *ctx = userdata;
 
+	pri_bearer_free(ctx);
+	g_free(ctx->bearer_prepared);
 	g_free(ctx->proxy_host);
 	g_free(ctx->path);
 	g_free(ctx);
@@ -1853,6 +2570,10 @@ static gboolean context_dbus_register(struct pri_context *ctx)
 	ctx->path = g_strdup(path);
 	ctx->key = ctx->path + strlen(basepath) + 1;
 
+	__ofono_dbus_properties_register(ctx->path,
+					OFONO_CONNECTION_CONTEXT_INTERFACE,
+					pri_append_properties, ctx);
+
 	return TRUE;
 }
 
@@ -1861,19 +2582,27 @@ static gboolean context_dbus_unregister(struct pri_context *ctx)
 	DBusConnection *conn = ofono_dbus_get_connection();
 	char path[256];
 
+	pri_op_cancel(ctx);
+
 	if (ctx->active == TRUE) {
-		const char *interface =
-			ctx->context_driver->settings->interface;
+		struct context_settings *settings =
+			ctx->context_driver->settings;
+		const char *address = NULL;
 
-		if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS)
-			pri_set_ipv4_addr(interface, NULL);
+		pri_traffic_stop(ctx);
 
-		pri_ifupdown(interface, FALSE);
+		if (ctx->type == OFONO_GPRS_CONTEXT_TYPE_MMS && settings->ipv4)
+			address = settings->ipv4->ip;
+
+		pri_teardown_interface(settings->interface, address);
 	}
 
 	strcpy(path, ctx->path);
 	idmap_put(ctx->gprs->pid_map, ctx->id);
 
+	__ofono_dbus_properties_unregister(path,
+					OFONO_CONNECTION_CONTEXT_INTERFACE);
+
 	return g_dbus_unregister_interface(conn, path,
 					OFONO_CONNECTION_CONTEXT_INTERFACE);
 }
@@ -2157,51 +2886,43 @@ static void netreg_status_changed(int status, int lac, int ci, int tech,
 	gprs_netreg_update(gprs);
 }
 
-static DBusMessage *gprs_get_properties(DBusConnection *conn,
-					DBusMessage *msg, void *data)
+static void gprs_append_properties(DBusMessageIter *dict, void *data)
 {
 	struct ofono_gprs *gprs = data;
-	DBusMessage *reply;
-	DBusMessageIter iter;
-	DBusMessageIter dict;
 	dbus_bool_t value;
 
-	reply = dbus_message_new_method_return(msg);
-	if (reply == NULL)
-		return NULL;
-
-	dbus_message_iter_init_append(reply, &iter);
-
-	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-					OFONO_PROPERTIES_ARRAY_SIGNATURE,
-					&dict);
-
 	value = gprs->attached;
-	ofono_dbus_dict_append(&dict, "Attached", DBUS_TYPE_BOOLEAN, &value);
+	ofono_dbus_dict_append(dict, "Attached", DBUS_TYPE_BOOLEAN, &value);
 
 	if (gprs->bearer != -1) {
 		const char *bearer = packet_bearer_to_string(gprs->bearer);
 
-		ofono_dbus_dict_append(&dict, "Bearer",
+		ofono_dbus_dict_append(dict, "Bearer",
 					DBUS_TYPE_STRING, &bearer);
 	}
 
 	value = gprs->roaming_allowed;
-	ofono_dbus_dict_append(&dict, "RoamingAllowed",
+	ofono_dbus_dict_append(dict, "RoamingAllowed",
 				DBUS_TYPE_BOOLEAN, &value);
 
 	value = gprs->powered;
-	ofono_dbus_dict_append(&dict, "Powered", DBUS_TYPE_BOOLEAN, &value);
+	ofono_dbus_dict_append(dict, "Powered", DBUS_TYPE_BOOLEAN, &value);
 
 	if (gprs->attached) {
 		value = gprs->suspended;
-		ofono_dbus_dict_append(&dict, "Suspended",
+		ofono_dbus_dict_append(dict, "Suspended",
 				DBUS_TYPE_BOOLEAN, &value);
 	}
+}
 
-	dbus_message_iter_close_container(&iter, &dict);
+static DBusMessage *gprs_get_properties(DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	struct ofono_gprs *gprs = data;
 
-	return reply;
+	return __ofono_dbus_properties_reply(msg,
+					__ofono_atom_get_path(gprs->atom),
+					OFONO_CONNECTION_MANAGER_INTERFACE);
 }
 
 static gboolean gprs_allow(DBusMessage *msg,
@@ -2295,6 +3016,40 @@ static DBusMessage *gprs_set_property(DBusConnection *conn,
 	return dbus_message_new_method_return(msg);
 }
 
+static void write_context_traffic(struct ofono_gprs *gprs,
+					struct pri_context *context)
+{
+	g_key_file_set_uint64(gprs->settings, context->key,
+				"RxBytes", context->traffic.rx_bytes);
+	g_key_file_set_uint64(gprs->settings, context->key,
+				"TxBytes", context->traffic.tx_bytes);
+	g_key_file_set_uint64(gprs->settings, context->key,
+				"RxPackets", context->traffic.rx_packets);
+	g_key_file_set_uint64(gprs->settings, context->key,
+				"TxPackets", context->traffic.tx_packets);
+	g_key_file_set_uint64(gprs->settings, context->key,
+				"Quota", context->quota);
+	g_key_file_set_uint64(gprs->settings, context->key,
+				"UsageThreshold", context->usage_threshold);
+}
+
+static void read_context_traffic(struct ofono_gprs *gprs, const char *group,
+					struct pri_context *context)
+{
+	context->traffic.rx_bytes = g_key_file_get_uint64(gprs->settings,
+						group, "RxBytes", NULL);
+	context->traffic.tx_bytes = g_key_file_get_uint64(gprs->settings,
+						group, "TxBytes", NULL);
+	context->traffic.rx_packets = g_key_file_get_uint64(gprs->settings,
+						group, "RxPackets", NULL);
+	context->traffic.tx_packets = g_key_file_get_uint64(gprs->settings,
+						group, "TxPackets", NULL);
+	context->quota = g_key_file_get_uint64(gprs->settings, group,
+						"Quota", NULL);
+	context->usage_threshold = g_key_file_get_uint64(gprs->settings,
+						group, "UsageThreshold", NULL);
+}
+
 static void write_context_settings(struct ofono_gprs *gprs,
 					struct pri_context *context)
 {
@@ -2326,6 +3081,8 @@ static void write_context_settings(struct ofono_gprs *gprs,
 					"MessageCenter",
 					context->message_center);
 	}
+
+	write_context_traffic(gprs, context);
 }
 
 static struct pri_context *find_usable_context(struct ofono_gprs *gprs,
@@ -2470,6 +3227,7 @@ void ofono_gprs_cid_activated(struct ofono_gprs  *gprs, unsigned int cid,
 	 */
 	gprs->flags |= GPRS_FLAG_ATTACHING;
 
+	pri_bearer_prepare(pri_ctx);
 	gc->driver->read_settings(gc, cid, pri_read_settings_callback, pri_ctx);
 }
 
@@ -2623,11 +3381,8 @@ static DBusMessage *gprs_remove_context(DBusConnection *conn,
 		return __ofono_error_busy(msg);
 
 	if (ctx->active) {
-		struct ofono_gprs_context *gc = ctx->context_driver;
-
 		gprs->pending = dbus_message_ref(msg);
-		gc->driver->deactivate_primary(gc, ctx->context.cid,
-					gprs_deactivate_for_remove, ctx);
+		pri_deactivate(ctx, gprs_deactivate_for_remove);
 		return NULL;
 	}
 
@@ -2659,43 +3414,26 @@ static void gprs_deactivate_for_all(const struct ofono_error *error,
 	dbus_bool_t value;
 
 	if (error->type != OFONO_ERROR_TYPE_NO_ERROR) {
-		__ofono_dbus_pending_reply(&gprs->pending,
-					__ofono_error_failed(gprs->pending));
-		return;
-	}
-
-	pri_reset_context_settings(ctx);
-	release_context(ctx);
+		gprs->deactivate_failed = TRUE;
+	} else {
+		pri_reset_context_settings(ctx);
+		release_context(ctx);
 
-	value = ctx->active;
-	conn = ofono_dbus_get_connection();
-	ofono_dbus_signal_property_changed(conn, ctx->path,
+		value = ctx->active;
+		conn = ofono_dbus_get_connection();
+		ofono_dbus_signal_property_changed(conn, ctx->path,
 					OFONO_CONNECTION_CONTEXT_INTERFACE,
 					"Active", DBUS_TYPE_BOOLEAN, &value);
+	}
 
-	gprs_deactivate_next(gprs);
-}
-
-static void gprs_deactivate_next(struct ofono_gprs *gprs)
-{
-	GSList *l;
-	struct pri_context *ctx;
-	struct ofono_gprs_context *gc;
-
-	for (l = gprs->contexts; l; l = l->next) {
-		ctx = l->data;
-
-		if (ctx->active == FALSE)
-			continue;
-
-		gc = ctx->context_driver;
-		gc->driver->deactivate_primary(gc, ctx->context.cid,
-					gprs_deactivate_for_all, ctx);
-
+	if (--gprs->deactivating)
 		return;
-	}
 
-	__ofono_dbus_pending_reply(&gprs->pending,
+	if (gprs->deactivate_failed)
+		__ofono_dbus_pending_reply(&gprs->pending,
+					__ofono_error_failed(gprs->pending));
+	else
+		__ofono_dbus_pending_reply(&gprs->pending,
 				dbus_message_new_method_return(gprs->pending));
 }
 
@@ -2722,9 +3460,28 @@ static DBusMessage *gprs_deactivate_all(DBusConnection *conn,
 			return __ofono_error_busy(msg);
 	}
 
+	gprs->deactivating = 0;
+	gprs->deactivate_failed = FALSE;
+
+	for (l = gprs->contexts; l; l = l->next) {
+		ctx = l->data;
+
+		if (ctx->active)
+			gprs->deactivating++;
+	}
+
+	if (gprs->deactivating == 0)
+		return dbus_message_new_method_return(msg);
+
 	gprs->pending = dbus_message_ref(msg);
 
-	gprs_deactivate_next(gprs);
+	/* All at once, the callbacks may come before the loop is done */
+	for (l = gprs->contexts; l; l = l->next) {
+		ctx = l->data;
+
+		if (ctx->active)
+			pri_deactivate(ctx, gprs_deactivate_for_all);
+	}
 
 	return NULL;
 }
@@ -3337,6 +4094,14 @@ enum ofono_gprs_context_type ofono_gprs_context_get_type(
 	return gc->type;
 }
 
+void ofono_gprs_context_set_serialized(struct ofono_gprs_context *gc,
+						ofono_bool_t serialized)
+{
+	DBG("%s", serialized ? "yes" : "no");
+
+	gc->serialized = serialized;
+}
+
 void ofono_gprs_context_set_interface(struct ofono_gprs_context *gc,
 					const char *interface)
 {
@@ -3346,6 +4111,12 @@ void ofono_gprs_context_set_interface(struct ofono_gprs_context *gc,
 	settings->interface = g_strdup(interface);
 }
 
+void ofono_gprs_context_set_mtu(struct ofono_gprs_context *gc,
+					unsigned int mtu)
+{
+	gc->settings->mtu = mtu;
+}
+
 void ofono_gprs_context_set_ipv4_address(struct ofono_gprs_context *gc,
 						const char *address,
 						ofono_bool_t static_ip)
@@ -3510,6 +4281,10 @@ static void free_contexts(struct ofono_gprs *gprs)
 {
 	GSList *l;
 
+	/* Store the final counts while the settings are still open */
+	for (l = gprs->contexts; l; l = l->next)
+		pri_traffic_stop(l->data);
+
 	if (gprs->settings) {
 		storage_close(gprs->imsi, SETTINGS_STORE,
 				gprs->settings, TRUE);
@@ -3565,6 +4340,8 @@ static void gprs_unregister(struct ofono_atom *atom)
 
 	ofono_modem_remove_interface(modem,
 					OFONO_CONNECTION_MANAGER_INTERFACE);
+	__ofono_dbus_properties_unregister(path,
+					OFONO_CONNECTION_MANAGER_INTERFACE);
 	g_dbus_unregister_interface(conn, path,
 					OFONO_CONNECTION_MANAGER_INTERFACE);
 }
@@ -3599,6 +4376,7 @@ static void gprs_remove(struct ofono_atom *atom)
 		gprs->driver->remove(gprs);
 
 	__ofono_gprs_filter_chain_free(gprs->filters);
+	g_slist_free_full(gprs->serial_queue, g_free);
 	g_free(gprs);
 }
 
@@ -3769,6 +4547,9 @@ static gboolean load_context(struct ofono_gprs *gprs, const char *group)
 	if (msgcenter != NULL)
 		strcpy(context->message_center, msgcenter);
 
+	read_context_traffic(gprs, group, context);
+	read_context_bearer(gprs, group, context);
+
 	if (context_dbus_register(context) == FALSE)
 		goto error;
 
@@ -3872,8 +4653,6 @@ static void ofono_gprs_finish_register(struct ofono_gprs *gprs)
 	struct ofono_modem *modem = __ofono_atom_get_modem(gprs->atom);
 	const char *path = __ofono_atom_get_path(gprs->atom);
 
-	configure_remaining_contexts(gprs);
-
 	if (!g_dbus_register_interface(conn, path,
 					OFONO_CONNECTION_MANAGER_INTERFACE,
 					manager_methods, manager_signals, NULL,
@@ -3885,6 +4664,9 @@ static void ofono_gprs_finish_register(struct ofono_gprs *gprs)
 		return;
 	}
 
+	__ofono_dbus_properties_register(path,
+					OFONO_CONNECTION_MANAGER_INTERFACE,
+					gprs_append_properties, gprs);
 	ofono_modem_add_interface(modem,
 				OFONO_CONNECTION_MANAGER_INTERFACE);
 
@@ -3900,13 +4682,25 @@ static void spn_read_cb(const char *spn, const char *dc, void *data)
 	struct ofono_gprs *gprs	= data;
 	struct ofono_modem *modem = __ofono_atom_get_modem(gprs->atom);
 	struct ofono_sim *sim = __ofono_atom_find(OFONO_ATOM_TYPE_SIM, modem);
+	GSList *last = g_slist_last(gprs->contexts);
+	GSList *l;
 
 	provision_contexts(gprs, ofono_sim_get_mcc(sim),
 					ofono_sim_get_mnc(sim), spn);
 
 	ofono_sim_remove_spn_watch(sim, &gprs->spn_watch);
 
-	ofono_gprs_finish_register(gprs);
+	configure_remaining_contexts(gprs);
+
+	if (!__ofono_atom_get_registered(gprs->atom)) {
+		ofono_gprs_finish_register(gprs);
+		return;
+	}
+
+	/* Registered early from a cached bearer, announce the newcomers */
+	for (l = last ? last->next : gprs->contexts; l; l = l->next)
+		send_context_added_signal(gprs, l->data,
+						ofono_dbus_get_connection());
 }
 
 struct ofono_modem *ofono_gprs_get_modem(struct ofono_gprs *gprs)
@@ -3927,10 +4721,20 @@ void ofono_gprs_register(struct ofono_gprs *gprs)
 	if (all_contexts_configured(gprs))
 		goto finish;
 
+	/*
+	 * A bearer that has worked with this SIM before is all it takes
+	 * to reconnect, the provisioning can catch up once the SPN is in.
+	 */
+	if (gprs_have_bearer(gprs)) {
+		DBG("registering with cached bearer");
+		ofono_gprs_finish_register(gprs);
+	}
+
 	ofono_sim_add_spn_watch(sim, &gprs->spn_watch, spn_read_cb, gprs, NULL);
 	return;
 
 finish:
+	configure_remaining_contexts(gprs);
 	ofono_gprs_finish_register(gprs);
 }
 
@@ -0,0 +1,506 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include "if-config.h"
+
+#include <ofono/log.h>
+
+#include <glib.h>
+
+#include <unistd.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#define IF_CONFIG_MAX_STEPS	16
+#define IF_CONFIG_DESC_SIZE	64
+#define IF_CONFIG_ACK_TIMEOUT	1	/* seconds */
+#define IF_CONFIG_RECV_SIZE	8192
+
+/* Enough for IF_CONFIG_MAX_STEPS of the largest (route) message */
+#define IF_CONFIG_BUF_SIZE		2048
+
+struct if_config {
+	char *ifname;
+	int ifindex;
+	unsigned char buf[IF_CONFIG_BUF_SIZE];
+	unsigned int len;
+	unsigned int steps;
+	char desc[IF_CONFIG_MAX_STEPS][IF_CONFIG_DESC_SIZE];
+	struct if_config_stats stats;
+};
+
+struct if_config *if_config_new(const char *ifname)
+{
+	struct if_config *conf;
+	unsigned int ifindex;
+
+	if (ifname == NULL)
+		return NULL;
+
+	ifindex = if_nametoindex(ifname);
+	if (ifindex == 0) {
+		DBG("%s: %s", ifname, strerror(errno));
+		return NULL;
+	}
+
+	conf = g_new0(struct if_config, 1);
+	conf->ifname = g_strdup(ifname);
+	conf->ifindex = ifindex;
+
+	return conf;
+}
+
+void if_config_free(struct if_config *conf)
+{
+	if (conf == NULL)
+		return;
+
+	g_free(conf->ifname);
+	g_free(conf);
+}
+
+static struct nlmsghdr *if_config_msg(struct if_config *conf, int type,
+				int flags, const void *body, unsigned int size)
+{
+	struct nlmsghdr *nlh;
+
+	if (conf->steps == IF_CONFIG_MAX_STEPS) {
+		ofono_error("%s: too many interface changes", conf->ifname);
+		return NULL;
+	}
+
+	nlh = (struct nlmsghdr *) (conf->buf + conf->len);
+	memset(nlh, 0, NLMSG_SPACE(size));
+	nlh->nlmsg_len = NLMSG_LENGTH(size);
+	nlh->nlmsg_type = type;
+	nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+	nlh->nlmsg_seq = conf->steps + 1;
+	memcpy(NLMSG_DATA(nlh), body, size);
+
+	return nlh;
+}
+
+static void if_config_attr(struct nlmsghdr *nlh, int type, const void *data,
+							unsigned int size)
+{
+	struct rtattr *rta = (struct rtattr *)
+		((unsigned char *) nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+
+	rta->rta_type = type;
+	rta->rta_len = RTA_LENGTH(size);
+	memcpy(RTA_DATA(rta), data, size);
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + RTA_SPACE(size);
+}
+
+static void if_config_queue(struct if_config *conf, struct nlmsghdr *nlh,
+						const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(conf->desc[conf->steps], IF_CONFIG_DESC_SIZE, format, args);
+	va_end(args);
+
+	conf->len += NLMSG_ALIGN(nlh->nlmsg_len);
+	conf->steps++;
+}
+
+/* Returns the size of the address or a negative error */
+static int if_config_parse(const char *str, int prefixlen,
+				unsigned char *family, struct in6_addr *addr)
+{
+	int size;
+
+	if (str == NULL)
+		return -EINVAL;
+
+	if (inet_pton(AF_INET, str, addr) == 1) {
+		*family = AF_INET;
+		size = sizeof(struct in_addr);
+	} else if (inet_pton(AF_INET6, str, addr) == 1) {
+		*family = AF_INET6;
+		size = sizeof(struct in6_addr);
+	} else
+		return -EINVAL;
+
+	if (prefixlen < 0 || prefixlen > size * 8)
+		return -EINVAL;
+
+	return size;
+}
+
+void if_config_set_up(struct if_config *conf, int up)
+{
+	struct ifinfomsg ifi;
+	struct nlmsghdr *nlh;
+
+	memset(&ifi, 0, sizeof(ifi));
+	ifi.ifi_family = AF_UNSPEC;
+	ifi.ifi_index = conf->ifindex;
+	ifi.ifi_flags = up ? IFF_UP : 0;
+	ifi.ifi_change = IFF_UP;
+
+	nlh = if_config_msg(conf, RTM_NEWLINK, 0, &ifi, sizeof(ifi));
+	if (nlh)
+		if_config_queue(conf, nlh, up ? "up" : "down");
+}
+
+void if_config_set_mtu(struct if_config *conf, int mtu)
+{
+	struct ifinfomsg ifi;
+	struct nlmsghdr *nlh;
+	unsigned int value = mtu;
+
+	memset(&ifi, 0, sizeof(ifi));
+	ifi.ifi_family = AF_UNSPEC;
+	ifi.ifi_index = conf->ifindex;
+
+	nlh = if_config_msg(conf, RTM_NEWLINK, 0, &ifi, sizeof(ifi));
+	if (nlh == NULL)
+		return;
+
+	if_config_attr(nlh, IFLA_MTU, &value, sizeof(value));
+	if_config_queue(conf, nlh, "mtu %d", mtu);
+}
+
+static int if_config_address(struct if_config *conf, int type, int flags,
+				const char *address, int prefixlen,
+				const char *name)
+{
+	struct ifaddrmsg ifa;
+	struct in6_addr addr;
+	struct nlmsghdr *nlh;
+	int size;
+
+	memset(&ifa, 0, sizeof(ifa));
+
+	size = if_config_parse(address, prefixlen, &ifa.ifa_family, &addr);
+	if (size < 0)
+		return size;
+
+	ifa.ifa_prefixlen = prefixlen;
+	ifa.ifa_scope = RT_SCOPE_UNIVERSE;
+	ifa.ifa_index = conf->ifindex;
+
+	/*
+	 * Nobody else is on the other end of the bearer, waiting for
+	 * duplicate address detection would only delay the first packet.
+	 */
+	if (ifa.ifa_family == AF_INET6)
+		ifa.ifa_flags = IFA_F_NODAD;
+
+	nlh = if_config_msg(conf, type, flags, &ifa, sizeof(ifa));
+	if (nlh == NULL)
+		return -ENOSPC;
+
+	if_config_attr(nlh, IFA_LOCAL, &addr, size);
+	if_config_attr(nlh, IFA_ADDRESS, &addr, size);
+	if_config_queue(conf, nlh, "%s %s/%d", name, address, prefixlen);
+
+	return 0;
+}
+
+int if_config_add_address(struct if_config *conf, const char *address,
+							int prefixlen)
+{
+	return if_config_address(conf, RTM_NEWADDR,
+					NLM_F_CREATE | NLM_F_REPLACE,
+					address, prefixlen, "add");
+}
+
+int if_config_del_address(struct if_config *conf, const char *address,
+							int prefixlen)
+{
+	return if_config_address(conf, RTM_DELADDR, 0, address, prefixlen,
+								"del");
+}
+
+int if_config_add_route(struct if_config *conf, const char *dst, int prefixlen,
+							const char *gateway)
+{
+	struct rtmsg rtm;
+	struct in6_addr addr;
+	struct in6_addr gw;
+	unsigned char gw_family;
+	struct nlmsghdr *nlh;
+	unsigned int oif = conf->ifindex;
+	int size;
+
+	memset(&rtm, 0, sizeof(rtm));
+
+	size = if_config_parse(dst, prefixlen, &rtm.rtm_family, &addr);
+	if (size < 0)
+		return size;
+
+	if (gateway && (if_config_parse(gateway, 0, &gw_family, &gw) < 0 ||
+					gw_family != rtm.rtm_family))
+		return -EINVAL;
+
+	rtm.rtm_dst_len = prefixlen;
+	rtm.rtm_table = RT_TABLE_MAIN;
+	rtm.rtm_protocol = RTPROT_BOOT;
+	rtm.rtm_scope = gateway ? RT_SCOPE_UNIVERSE : RT_SCOPE_LINK;
+	rtm.rtm_type = RTN_UNICAST;
+
+	nlh = if_config_msg(conf, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_REPLACE,
+							&rtm, sizeof(rtm));
+	if (nlh == NULL)
+		return -ENOSPC;
+
+	if (prefixlen)
+		if_config_attr(nlh, RTA_DST, &addr, size);
+
+	if (gateway)
+		if_config_attr(nlh, RTA_GATEWAY, &gw, size);
+
+	if_config_attr(nlh, RTA_OIF, &oif, sizeof(oif));
+	if_config_queue(conf, nlh, "route %s/%d", dst, prefixlen);
+
+	return 0;
+}
+
+static int if_config_collect_acks(struct if_config *conf, int fd)
+{
+	unsigned char buf[IF_CONFIG_RECV_SIZE];
+	unsigned int acked = 0;
+	int err = 0;
+
+	while (acked < conf->steps) {
+		struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+		int len = recv(fd, buf, sizeof(buf), 0);
+
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+
+			ofono_error("%s: %u of %u changes unacknowledged",
+					conf->ifname, conf->steps - acked,
+					conf->steps);
+			return errno == EAGAIN ? -ETIMEDOUT : -errno;
+		}
+
+		for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+			const struct nlmsgerr *e = NLMSG_DATA(nlh);
+			unsigned int seq = nlh->nlmsg_seq;
+
+			if (nlh->nlmsg_type != NLMSG_ERROR || seq < 1 ||
+							seq > conf->steps)
+				continue;
+
+			acked++;
+
+			if (e->error == 0)
+				continue;
+
+			ofono_error("%s: %s failed: %s", conf->ifname,
+						conf->desc[seq - 1],
+						strerror(-e->error));
+			conf->stats.failed++;
+
+			if (err == 0)
+				err = e->error;
+		}
+	}
+
+	return err;
+}
+
+static int if_config_open(void)
+{
+	struct timeval tv = { IF_CONFIG_ACK_TIMEOUT, 0 };
+	int fd = socket(PF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+
+	if (fd < 0)
+		return -errno;
+
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	return fd;
+}
+
+static int if_config_send(int fd, const void *buf, unsigned int len)
+{
+	struct sockaddr_nl nl;
+
+	memset(&nl, 0, sizeof(nl));
+	nl.nl_family = AF_NETLINK;
+
+	if (sendto(fd, buf, len, 0, (struct sockaddr *) &nl, sizeof(nl)) < 0)
+		return -errno;
+
+	return 0;
+}
+
+int if_config_commit(struct if_config *conf)
+{
+	struct if_config_stats *stats = &conf->stats;
+	gint64 start, sent;
+	int fd;
+	int err;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->steps = conf->steps;
+
+	if (conf->steps == 0)
+		return 0;
+
+	start = g_get_monotonic_time();
+	sent = start;
+
+	fd = if_config_open();
+	if (fd < 0) {
+		err = fd;
+		goto done;
+	}
+
+	/* The kernel works through the whole batch before this returns */
+	err = if_config_send(fd, conf->buf, conf->len);
+	if (err < 0) {
+		ofono_error("%s: netlink send failed: %s", conf->ifname,
+							strerror(-err));
+	} else {
+		sent = g_get_monotonic_time();
+		err = if_config_collect_acks(conf, fd);
+	}
+
+	close(fd);
+
+done:
+	stats->total_us = g_get_monotonic_time() - start;
+	stats->send_us = sent - start;
+	stats->ack_us = stats->total_us - stats->send_us;
+
+	DBG("%s: %u change(s), %u failed, %ld us (send %ld, ack %ld)",
+			conf->ifname, stats->steps, stats->failed,
+			stats->total_us, stats->send_us, stats->ack_us);
+
+	conf->len = 0;
+	conf->steps = 0;
+
+	return err;
+}
+
+const struct if_config_stats *if_config_get_stats(const struct if_config *conf)
+{
+	return &conf->stats;
+}
+
+static gboolean if_config_parse_counters(const struct ifinfomsg *ifi,
+				unsigned int len, struct if_counters *counters)
+{
+	const struct rtattr *rta = IFLA_RTA(ifi);
+	struct rtnl_link_stats64 stats64;
+	struct rtnl_link_stats stats;
+	gboolean found = FALSE;
+
+	for (; RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+		if (rta->rta_type == IFLA_STATS64 &&
+				RTA_PAYLOAD(rta) >= sizeof(stats64)) {
+			/* Attributes are only 4-byte aligned */
+			memcpy(&stats64, RTA_DATA(rta), sizeof(stats64));
+			counters->rx_packets = stats64.rx_packets;
+			counters->tx_packets = stats64.tx_packets;
+			counters->rx_bytes = stats64.rx_bytes;
+			counters->tx_bytes = stats64.tx_bytes;
+			return TRUE;
+		}
+
+		if (rta->rta_type == IFLA_STATS &&
+				RTA_PAYLOAD(rta) >= sizeof(stats)) {
+			memcpy(&stats, RTA_DATA(rta), sizeof(stats));
+			counters->rx_packets = stats.rx_packets;
+			counters->tx_packets = stats.tx_packets;
+			counters->rx_bytes = stats.rx_bytes;
+			counters->tx_bytes = stats.tx_bytes;
+			found = TRUE;
+			/* Keep looking, IFLA_STATS64 is better */
+		}
+	}
+
+	return found;
+}
+
+int if_config_get_counters(const char *ifname, struct if_counters *counters)
+{
+	unsigned char buf[IF_CONFIG_RECV_SIZE];
+	struct {
+		struct nlmsghdr hdr;
+		struct ifinfomsg ifi;
+	} req;
+	struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+	int len;
+	int fd;
+	int err;
+
+	memset(counters, 0, sizeof(*counters));
+	memset(&req, 0, sizeof(req));
+	req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifi));
+	req.hdr.nlmsg_type = RTM_GETLINK;
+	req.hdr.nlmsg_flags = NLM_F_REQUEST;
+	req.hdr.nlmsg_seq = 1;
+	req.ifi.ifi_family = AF_UNSPEC;
+	req.ifi.ifi_index = ifname ? if_nametoindex(ifname) : 0;
+
+	if (req.ifi.ifi_index == 0)
+		return -ENODEV;
+
+	fd = if_config_open();
+	if (fd < 0)
+		return fd;
+
+	err = if_config_send(fd, &req, req.hdr.nlmsg_len);
+	if (err < 0)
+		goto done;
+
+	do {
+		len = recv(fd, buf, sizeof(buf), 0);
+	} while (len < 0 && errno == EINTR);
+
+	if (len < 0) {
+		err = -errno;
+		goto done;
+	}
+
+	err = -ENODATA;
+
+	for (; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+		if (nlh->nlmsg_type == NLMSG_ERROR) {
+			const struct nlmsgerr *e = NLMSG_DATA(nlh);
+
+			err = e->error;
+			break;
+		}
+
+		if (nlh->nlmsg_type == RTM_NEWLINK &&
+				if_config_parse_counters(NLMSG_DATA(nlh),
+						IFLA_PAYLOAD(nlh), counters)) {
+			err = 0;
+			break;
+		}
+	}
+
+done:
+	close(fd);
+	return err;
+}
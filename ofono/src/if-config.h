@@ -0,0 +1,61 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifndef IF_CONFIG_H
+#define IF_CONFIG_H
+
+/*
+ * Interface configuration over rtnetlink.  Changes are queued and then
+ * sent to the kernel as one batch by if_config_commit(), which waits for
+ * all of them to be acknowledged.  The kernel applies them in the order
+ * they were queued and carries on past the ones that fail.  Addresses
+ * and routes are given as IPv4 or IPv6 literals.
+ */
+
+struct if_config;
+
+struct if_config_stats {
+	unsigned int steps;		/* Changes in the last commit */
+	unsigned int failed;		/* How many of them failed */
+	long send_us;			/* Kernel applying the batch */
+	long ack_us;			/* Collecting the acks */
+	long total_us;			/* Whole commit */
+};
+
+struct if_counters {
+	unsigned long long rx_packets;
+	unsigned long long tx_packets;
+	unsigned long long rx_bytes;
+	unsigned long long tx_bytes;
+};
+
+struct if_config *if_config_new(const char *ifname);
+void if_config_free(struct if_config *conf);
+
+void if_config_set_up(struct if_config *conf, int up);
+void if_config_set_mtu(struct if_config *conf, int mtu);
+int if_config_add_address(struct if_config *conf, const char *address,
+							int prefixlen);
+int if_config_del_address(struct if_config *conf, const char *address,
+							int prefixlen);
+int if_config_add_route(struct if_config *conf, const char *dst, int prefixlen,
+							const char *gateway);
+
+int if_config_commit(struct if_config *conf);
+const struct if_config_stats *if_config_get_stats(const struct if_config *conf);
+
+int if_config_get_counters(const char *ifname, struct if_counters *counters);
+
+#endif /* IF_CONFIG_H */
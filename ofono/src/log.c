@@ -40,6 +40,8 @@
 
 ofono_log_hook_cb_t ofono_log_hook;
 static GString *ofono_debug_str;
+static ofono_log_trace_cb_t log_trace;
+static ofono_log_crash_cb_t log_crash;
 
 static const char *program_exec;
 static const char *program_path;
@@ -147,6 +149,12 @@ void ofono_dbg(const struct ofono_debug_desc *desc, const char *format, ...)
 {
 	va_list ap;
 
+	if (log_trace) {
+		va_start(ap, format);
+		log_trace(desc, format, ap);
+		va_end(ap);
+	}
+
 	if (!(desc->flags & OFONO_DEBUG_FLAG_PRINT))
 		return;
 
@@ -278,6 +286,9 @@ static void signal_handler(int signo)
 {
 	ofono_error("Aborting (signal %d) [%s]", signo, program_exec);
 
+	if (log_crash)
+		log_crash();
+
 	print_backtrace(2);
 
 	exit(EXIT_FAILURE);
@@ -335,6 +346,9 @@ void __ofono_log_enable(struct ofono_debug_desc *start,
 		return;
 
 	for (desc = start; desc < stop; desc++) {
+		if (log_trace)
+			desc->flags |= OFONO_DEBUG_FLAG_TRACE;
+
 		if (file != NULL || name != NULL) {
 			if (g_strcmp0(desc->file, file) == 0) {
 				if (desc->name == NULL)
@@ -353,6 +367,23 @@ void __ofono_log_enable(struct ofono_debug_desc *start,
 	}
 }
 
+void __ofono_log_set_trace(ofono_log_trace_cb_t trace,
+					ofono_log_crash_cb_t crash)
+{
+	struct ofono_debug_desc *desc;
+
+	log_trace = trace;
+	log_crash = crash;
+
+	/* Plugins get theirs from __ofono_log_enable() */
+	for (desc = __start___debug; desc < __stop___debug; desc++) {
+		if (trace)
+			desc->flags |= OFONO_DEBUG_FLAG_TRACE;
+		else
+			desc->flags &= ~OFONO_DEBUG_FLAG_TRACE;
+	}
+}
+
 int __ofono_log_init(const char *program, const char *debug,
 						ofono_bool_t detach,
 						ofono_bool_t backtrace)
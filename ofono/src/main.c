@@ -37,8 +37,11 @@
 #endif
 
 #include "ofono.h"
+#include "storage.h"
 
 #define SHUTDOWN_GRACE_SECONDS 10
+#define TRACE_DEFAULT_KBYTES 64
+#define TRACE_FILE STORAGEDIR "/trace"
 
 static GMainLoop *event_loop;
 
@@ -83,6 +86,12 @@ static gboolean signal_handler(GIOChannel *channel, GIOCondition cond,
 
 		__terminated = 1;
 		break;
+	case SIGUSR1:
+		if (__ofono_trace_save(TRACE_FILE) == 0)
+			ofono_info("Trace saved to %s", TRACE_FILE);
+		else
+			ofono_warn("Failed to save trace to %s", TRACE_FILE);
+		break;
 	}
 
 	return TRUE;
@@ -98,6 +107,7 @@ static guint setup_signalfd(void)
 	sigemptyset(&mask);
 	sigaddset(&mask, SIGINT);
 	sigaddset(&mask, SIGTERM);
+	sigaddset(&mask, SIGUSR1);
 
 	if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0) {
 		perror("Failed to set signal mask");
@@ -138,6 +148,8 @@ static gchar *option_noplugin = NULL;
 static gboolean option_detach = TRUE;
 static gboolean option_version = FALSE;
 static gboolean option_backtrace = TRUE;
+static gint option_trace = TRACE_DEFAULT_KBYTES;
+static gchar *option_capture = NULL;
 
 static gboolean parse_debug(const char *key, const char *value,
 					gpointer user_data, GError **error)
@@ -175,6 +187,12 @@ static GOptionEntry options[] = {
 	{ "nobacktrace", 0, G_OPTION_FLAG_REVERSE,
 				G_OPTION_ARG_NONE, &option_backtrace,
 				"Don't print out backtrace information" },
+	{ "trace", 't', 0, G_OPTION_ARG_INT, &option_trace,
+				"Size of the trace buffer in KiB, 0 to disable",
+				"SIZE" },
+	{ "capture", 0, 0, G_OPTION_ARG_FILENAME, &option_capture,
+				"Record modem traffic for tools/replay",
+				"FILE" },
 	{ NULL },
 };
 
@@ -276,9 +294,20 @@ int main(int argc, char **argv)
 
 	signal = setup_signalfd();
 
+	/* Must come first, so that all debug descriptors get traced */
+	__ofono_trace_init(MAX(option_trace, 0));
+
 	__ofono_log_init(argv[0], option_debug, option_detach,
 							option_backtrace);
 
+	if (option_capture) {
+		int err = __ofono_trace_capture_start(option_capture);
+
+		if (err < 0)
+			ofono_error("Unable to capture to %s: %s",
+					option_capture, strerror(-err));
+	}
+
 	dbus_error_init(&error);
 
 	conn = g_dbus_setup_bus(DBUS_BUS_SYSTEM, OFONO_SERVICE, &error);
@@ -298,11 +327,14 @@ int main(int argc, char **argv)
 					NULL, NULL);
 
 	__ofono_dbus_init(conn);
+	__ofono_dbus_set_peer_gone_cb(__ofono_dbus_access_peer_gone);
 
 	__ofono_modemwatch_init();
 
 	__ofono_manager_init();
 
+	__ofono_devmon_init();
+
 	__ofono_plugin_init(option_plugin, option_noplugin);
 
 	g_free(option_plugin);
@@ -310,8 +342,13 @@ int main(int argc, char **argv)
 
 	g_main_loop_run(event_loop);
 
+	/* Plugins take their format strings with them */
+	__ofono_trace_cleanup();
+
 	__ofono_plugin_cleanup();
 
+	__ofono_devmon_cleanup();
+
 	__ofono_manager_cleanup();
 
 	__ofono_modemwatch_cleanup();
@@ -330,6 +367,11 @@ cleanup:
 
 	__ofono_log_cleanup(option_backtrace);
 
+	__ofono_trace_cleanup();
+
+	__ofono_trace_capture_stop();
+
+	g_free(option_capture);
 	g_free(option_debug);
 
 	return 0;
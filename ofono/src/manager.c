@@ -24,11 +24,15 @@
 #endif
 
 #include <string.h>
+#include <unistd.h>
 #include <glib.h>
 #include <gdbus.h>
 
 #include "ofono.h"
 
+static DBusMessage *modems_snapshot;
+static unsigned int modems_snapshot_serial;
+
 static void append_modem(struct ofono_modem *modem, void *userdata)
 {
 	DBusMessageIter *array = userdata;
@@ -54,15 +58,22 @@ static void append_modem(struct ofono_modem *modem, void *userdata)
 static DBusMessage *manager_get_modems(DBusConnection *conn,
 					DBusMessage *msg, void *data)
 {
-	DBusMessage *reply;
+	unsigned int serial = __ofono_dbus_modems_serial();
 	DBusMessageIter iter;
 	DBusMessageIter array;
 
-	reply = dbus_message_new_method_return(msg);
-	if (reply == NULL)
+	if (modems_snapshot && modems_snapshot_serial == serial)
+		return __ofono_dbus_snapshot_reply(msg, modems_snapshot);
+
+	if (modems_snapshot)
+		dbus_message_unref(modems_snapshot);
+
+	modems_snapshot = dbus_message_new(DBUS_MESSAGE_TYPE_METHOD_RETURN);
+	if (modems_snapshot == NULL)
 		return NULL;
 
-	dbus_message_iter_init_append(reply, &iter);
+	modems_snapshot_serial = serial;
+	dbus_message_iter_init_append(modems_snapshot, &iter);
 
 	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
 					DBUS_STRUCT_BEGIN_CHAR_AS_STRING
@@ -77,6 +88,27 @@ static DBusMessage *manager_get_modems(DBusConnection *conn,
 	__ofono_modem_foreach(append_modem, &array);
 	dbus_message_iter_close_container(&iter, &array);
 
+	return __ofono_dbus_snapshot_reply(msg, modems_snapshot);
+}
+
+static DBusMessage *manager_dump_trace(DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	DBusMessage *reply;
+	int fd;
+
+	fd = __ofono_trace_dump_fd();
+	if (fd < 0)
+		return __ofono_error_not_available(msg);
+
+	reply = dbus_message_new_method_return(msg);
+	if (reply)
+		dbus_message_append_args(reply, DBUS_TYPE_UNIX_FD, &fd,
+							DBUS_TYPE_INVALID);
+
+	/* The message holds its own duplicate */
+	close(fd);
+
 	return reply;
 }
 
@@ -84,6 +116,9 @@ static const GDBusMethodTable manager_methods[] = {
 	{ GDBUS_METHOD("GetModems",
 				NULL, GDBUS_ARGS({ "modems", "a(oa{sv})" }),
 				manager_get_modems) },
+	{ GDBUS_METHOD("DumpTrace",
+				NULL, GDBUS_ARGS({ "fd", "h" }),
+				manager_dump_trace) },
 	{ }
 };
 
@@ -108,6 +143,9 @@ int __ofono_manager_init(void)
 	if (ret == FALSE)
 		return -1;
 
+	/* Lets clients fetch all objects and properties in one go */
+	g_dbus_attach_object_manager(conn);
+
 	return 0;
 }
 
@@ -115,6 +153,12 @@ void __ofono_manager_cleanup(void)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
 
+	g_dbus_detach_object_manager(conn);
 	g_dbus_unregister_interface(conn, OFONO_MANAGER_PATH,
 					OFONO_MANAGER_INTERFACE);
+
+	if (modems_snapshot) {
+		dbus_message_unref(modems_snapshot);
+		modems_snapshot = NULL;
+	}
 }
@@ -873,27 +873,18 @@ void __ofono_modem_append_properties(struct ofono_modem *modem,
 	ofono_dbus_dict_append(dict, "Type", DBUS_TYPE_STRING, &strtype);
 }
 
+static void modem_append_properties(DBusMessageIter *dict, void *data)
+{
+	__ofono_modem_append_properties(data, dict);
+}
+
 static DBusMessage *modem_get_properties(DBusConnection *conn,
 						DBusMessage *msg, void *data)
 {
 	struct ofono_modem *modem = data;
-	DBusMessage *reply;
-	DBusMessageIter iter;
-	DBusMessageIter dict;
-
-	reply = dbus_message_new_method_return(msg);
-	if (reply == NULL)
-		return NULL;
-
-	dbus_message_iter_init_append(reply, &iter);
-
-	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-					OFONO_PROPERTIES_ARRAY_SIGNATURE,
-					&dict);
-	__ofono_modem_append_properties(modem, &dict);
-	dbus_message_iter_close_container(&iter, &dict);
 
-	return reply;
+	return __ofono_dbus_properties_reply(msg, modem->path,
+						OFONO_MODEM_INTERFACE);
 }
 
 static int set_powered(struct ofono_modem *modem, ofono_bool_t powered)
@@ -930,6 +921,16 @@ static int set_powered(struct ofono_modem *modem, ofono_bool_t powered)
 	return err;
 }
 
+/*
+ * Lockdown is only signalled once the modem has been powered down, or
+ * not at all if that times out, so drop the snapshot on every write.
+ */
+static void lockdown_set(struct ofono_modem *modem, ofono_bool_t lockdown)
+{
+	modem->lockdown = lockdown;
+	__ofono_dbus_properties_invalidate(modem->path, OFONO_MODEM_INTERFACE);
+}
+
 static void lockdown_remove(struct ofono_modem *modem)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
@@ -942,7 +943,7 @@ static void lockdown_remove(struct ofono_modem *modem)
 	g_free(modem->lock_owner);
 	modem->lock_owner = NULL;
 
-	modem->lockdown = FALSE;
+	lockdown_set(modem, FALSE);
 }
 
 static gboolean set_powered_timeout(gpointer user)
@@ -1045,7 +1046,7 @@ static DBusMessage *set_property_lockdown(struct ofono_modem *modem,
 		return __ofono_error_failed(msg);
 	}
 
-	modem->lockdown = lockdown;
+	lockdown_set(modem, lockdown);
 
 	if (modem->powered == FALSE)
 		goto done;
@@ -1347,6 +1348,9 @@ void ofono_modem_add_interface(struct ofono_modem *modem,
 							g_strdup(feature));
 	}
 
+	/* The signal is batched, the snapshot must not wait for it */
+	__ofono_dbus_properties_invalidate(modem->path, OFONO_MODEM_INTERFACE);
+
 	if (modem->interface_update != 0)
 		return;
 
@@ -1384,6 +1388,8 @@ void ofono_modem_remove_interface(struct ofono_modem *modem,
 		}
 	}
 
+	__ofono_dbus_properties_invalidate(modem->path, OFONO_MODEM_INTERFACE);
+
 	if (modem->interface_update != 0)
 		return;
 
@@ -1680,6 +1686,7 @@ struct ofono_devinfo *ofono_devinfo_create(struct ofono_modem *modem,
 static void devinfo_unregister(struct ofono_atom *atom)
 {
 	struct ofono_devinfo *info = __ofono_atom_get_data(atom);
+	struct ofono_modem *modem = __ofono_atom_get_modem(atom);
 
 	g_free(info->manufacturer);
 	info->manufacturer = NULL;
@@ -1695,6 +1702,9 @@ static void devinfo_unregister(struct ofono_atom *atom)
 
 	g_free(info->svn);
 	info->svn = NULL;
+
+	/* The modem properties lose these without a signal */
+	__ofono_dbus_properties_invalidate(modem->path, OFONO_MODEM_INTERFACE);
 }
 
 void ofono_devinfo_register(struct ofono_devinfo *info)
@@ -2079,6 +2089,9 @@ int ofono_modem_register(struct ofono_modem *modem)
 		return -EIO;
 	}
 
+	__ofono_dbus_properties_register(modem->path, OFONO_MODEM_INTERFACE,
+						modem_append_properties, modem);
+
 	g_free(modem->driver_type);
 	modem->driver_type = NULL;
 
@@ -2160,6 +2173,7 @@ static void modem_unregister(struct ofono_modem *modem)
 					&modem->lockdown);
 	}
 
+	__ofono_dbus_properties_unregister(modem->path, OFONO_MODEM_INTERFACE);
 	g_dbus_unregister_interface(conn, modem->path, OFONO_MODEM_INTERFACE);
 
 	if (modem->driver && modem->driver->remove)
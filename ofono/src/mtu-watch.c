@@ -14,6 +14,7 @@
  */
 
 #include "mtu-watch.h"
+#include "if-config.h"
 
 #include <ofono/log.h>
 
@@ -22,8 +23,8 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
-#include <sys/ioctl.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <net/if.h>
 
 #include <linux/netlink.h>
@@ -41,21 +42,13 @@ struct mtu_watch {
 
 static void mtu_watch_limit_mtu(struct mtu_watch *self)
 {
-	int fd = socket(PF_INET, SOCK_DGRAM, 0);
-	if (fd >= 0) {
-		struct ifreq ifr;
-		memset(&ifr, 0, sizeof(ifr));
-		strncpy(ifr.ifr_name, self->ifname, IFNAMSIZ);
-		if (ioctl(fd, SIOCGIFMTU, &ifr) < 0 ||
-					ifr.ifr_mtu > self->max_mtu) {
-			DBG("%s mtu %d => %d", self->ifname, ifr.ifr_mtu,
-								self->max_mtu);
-			ifr.ifr_mtu = self->max_mtu;
-			if (ioctl(fd, SIOCSIFMTU, &ifr) < 0) {
-				ofono_error("Failed to set MTU");
-			}
-		}
-		close(fd);
+	struct if_config *conf = if_config_new(self->ifname);
+
+	if (conf) {
+		DBG("%s => %d", self->ifname, self->max_mtu);
+		if_config_set_mtu(conf, self->max_mtu);
+		if_config_commit(conf);
+		if_config_free(conf);
 	}
 }
 
@@ -146,6 +139,33 @@ static gboolean mtu_watch_open_socket(struct mtu_watch *self)
 	return FALSE;
 }
 
+/* The reply comes back as RTM_NEWLINK, just like a change would */
+static void mtu_watch_query(struct mtu_watch *self)
+{
+	struct {
+		struct nlmsghdr hdr;
+		struct ifinfomsg ifi;
+	} req;
+	struct sockaddr_nl nl;
+
+	memset(&req, 0, sizeof(req));
+	req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifi));
+	req.hdr.nlmsg_type = RTM_GETLINK;
+	req.hdr.nlmsg_flags = NLM_F_REQUEST;
+	req.ifi.ifi_family = AF_UNSPEC;
+	req.ifi.ifi_index = if_nametoindex(self->ifname);
+
+	if (!req.ifi.ifi_index)
+		return;
+
+	memset(&nl, 0, sizeof(nl));
+	nl.nl_family = AF_NETLINK;
+	if (sendto(self->fd, &req, req.hdr.nlmsg_len, 0,
+			(struct sockaddr*)&nl, sizeof(nl)) < 0) {
+		DBG("%s error %d", self->ifname, errno);
+	}
+}
+
 static gboolean mtu_watch_start(struct mtu_watch *self)
 {
 	if (self->fd >= 0) {
@@ -209,8 +229,9 @@ void mtu_watch_set_ifname(struct mtu_watch *self, const char *ifname)
 		g_free(self->ifname);
 		if (ifname) {
 			self->ifname = g_strdup(ifname);
-			mtu_watch_limit_mtu(self);
-			mtu_watch_start(self);
+			if (mtu_watch_start(self)) {
+				mtu_watch_query(self);
+			}
 		} else {
 			self->ifname = NULL;
 			mtu_watch_stop(self);
@@ -36,13 +36,54 @@
 #include "ofono.h"
 #include "netmonagent.h"
 
-#define CELL_INFO_DICT_APPEND(p_dict, key, info, type, dbus_type)	do { \
-	type value; \
-	if (info < 0) \
-		break; \
-	value = (type) info; \
-	ofono_dbus_dict_append(p_dict, key, dbus_type, &value); \
-} while (0)
+/* Measurements kept per modem for GetHistory */
+#define NETMON_HISTORY_SIZE 256
+
+/* What a single cell measurement is kept as */
+struct netmon_record {
+	guint64 seq;				/* Starts at 1 */
+	guint64 timestamp;			/* Wall clock, microseconds */
+	guint8 type;				/* ofono_netmon_cell_type */
+	guint8 serving;
+	guint8 cell_list;			/* For GetCellsInformation */
+	char mcc[OFONO_MAX_MCC_LENGTH + 1];
+	char mnc[OFONO_MAX_MNC_LENGTH + 1];
+	gint32 info[OFONO_NETMON_INFO_INVALID];	/* Negative if unknown */
+};
+
+struct netmon_info_key {
+	const char *name;
+	int type;
+};
+
+/* D-Bus key and type of each integer enum ofono_netmon_info value */
+static const struct netmon_info_key info_keys[] = {
+	[OFONO_NETMON_INFO_LAC] = { "LocationAreaCode", DBUS_TYPE_UINT16 },
+	[OFONO_NETMON_INFO_CI] = { "CellId", DBUS_TYPE_UINT32 },
+	[OFONO_NETMON_INFO_ARFCN] = { "ARFCN", DBUS_TYPE_UINT16 },
+	[OFONO_NETMON_INFO_BSIC] = { "BSIC", DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_RXLEV] = { "ReceivedSignalStrength",
+							DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_BER] = { "BitErrorRate", DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_RSSI] = { "Strength", DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_TIMING_ADVANCE] = { "TimingAdvance",
+							DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_PSC] = { "PrimaryScramblingCode",
+							DBUS_TYPE_UINT16 },
+	[OFONO_NETMON_INFO_RSCP] = { "ReceivedSignalCodePower",
+							DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_ECN0] = { "ReceivedEnergyRatio", DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_RSRQ] = { "ReferenceSignalReceivedQuality",
+							DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_RSRP] = { "ReferenceSignalReceivedPower",
+							DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_EARFCN] = { "EARFCN", DBUS_TYPE_UINT16 },
+	[OFONO_NETMON_INFO_EBAND] = { "EBand", DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_CQI] = { "ChannelQualityIndicator",
+							DBUS_TYPE_BYTE },
+	[OFONO_NETMON_INFO_PCI] = { "PhysicalCellId", DBUS_TYPE_UINT16 },
+	[OFONO_NETMON_INFO_TAC] = { "TrackingAreaCode", DBUS_TYPE_UINT16 },
+};
 
 static GSList *g_drivers = NULL;
 
@@ -50,9 +91,13 @@ struct ofono_netmon {
 	const struct ofono_netmon_driver *driver;
 	DBusMessage *pending;
 	DBusMessage *reply;
+	DBusMessage *pending_cells;
+	guint64 cells_seq;			/* First record of the list */
 	void *driver_data;
 	struct ofono_atom *atom;
 	struct netmon_agent *agent;
+	struct netmon_record *history;
+	guint64 next_seq;
 };
 
 static const char *cell_type_to_tech_name(enum ofono_netmon_cell_type type)
@@ -69,191 +114,208 @@ static const char *cell_type_to_tech_name(enum ofono_netmon_cell_type type)
 	return NULL;
 }
 
-void ofono_netmon_serving_cell_notify(struct ofono_netmon *netmon,
+static struct netmon_record *netmon_record_cell(struct ofono_netmon *netmon,
 					enum ofono_netmon_cell_type type,
-					int info_type, ...)
+					gboolean serving,
+					int info_type, va_list args)
 {
-	va_list arglist;
-	DBusMessage *agent_notify = NULL;
-	DBusMessageIter iter;
-	DBusMessageIter dict;
-	enum ofono_netmon_info next_info_type = info_type;
-	const char *technology = cell_type_to_tech_name(type);
-	char *mcc;
-	char *mnc;
-	int intval;
-
-	if (netmon->pending != NULL) {
-		netmon->reply = dbus_message_new_method_return(netmon->pending);
-		dbus_message_iter_init_append(netmon->reply, &iter);
-	} else if (netmon->agent != NULL) {
-		agent_notify = netmon_agent_new_method_call(netmon->agent,
-					"ServingCellInformationChanged");
-
-		dbus_message_iter_init_append(agent_notify, &iter);
-	} else
-		return;
-
-	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-					OFONO_PROPERTIES_ARRAY_SIGNATURE,
-					&dict);
-
-	va_start(arglist, info_type);
-
-	if (technology == NULL)
-		goto done;
-
-	ofono_dbus_dict_append(&dict, "Technology",
-						DBUS_TYPE_STRING, &technology);
-
-	while (next_info_type != OFONO_NETMON_INFO_INVALID) {
-		switch (next_info_type) {
+	struct netmon_record *rec;
+	const char *str;
+	int i;
+
+	rec = &netmon->history[netmon->next_seq % NETMON_HISTORY_SIZE];
+	rec->seq = ++netmon->next_seq;
+	rec->timestamp = g_get_real_time();
+	rec->type = type;
+	rec->serving = serving;
+	rec->cell_list = FALSE;
+	rec->mcc[0] = '\0';
+	rec->mnc[0] = '\0';
+
+	for (i = 0; i < OFONO_NETMON_INFO_INVALID; i++)
+		rec->info[i] = -1;
+
+	while (info_type != OFONO_NETMON_INFO_INVALID) {
+		switch (info_type) {
 		case OFONO_NETMON_INFO_MCC:
-			mcc = va_arg(arglist, char *);
+			str = va_arg(args, const char *);
 
-			if (mcc && strlen(mcc))
-				ofono_dbus_dict_append(&dict,
-						"MobileCountryCode",
-						DBUS_TYPE_STRING, &mcc);
+			if (str)
+				g_strlcpy(rec->mcc, str, sizeof(rec->mcc));
 			break;
 
 		case OFONO_NETMON_INFO_MNC:
-			mnc = va_arg(arglist, char *);
+			str = va_arg(args, const char *);
 
-			if (mnc && strlen(mnc))
-				ofono_dbus_dict_append(&dict,
-						"MobileNetworkCode",
-						DBUS_TYPE_STRING, &mnc);
+			if (str)
+				g_strlcpy(rec->mnc, str, sizeof(rec->mnc));
 			break;
 
-		case OFONO_NETMON_INFO_LAC:
-			intval = va_arg(arglist, int);
+		default:
+			i = va_arg(args, int);
 
-			CELL_INFO_DICT_APPEND(&dict, "LocationAreaCode",
-					intval, uint16_t, DBUS_TYPE_UINT16);
+			if ((unsigned int) info_type <
+					OFONO_NETMON_INFO_INVALID)
+				rec->info[info_type] = i;
 			break;
+		}
 
-		case OFONO_NETMON_INFO_CI:
-			intval = va_arg(arglist, int);
-
-			CELL_INFO_DICT_APPEND(&dict, "CellId",
-					intval, uint32_t, DBUS_TYPE_UINT32);
-			break;
+		info_type = va_arg(args, int);
+	}
 
-		case OFONO_NETMON_INFO_ARFCN:
-			intval = va_arg(arglist, int);
+	return rec;
+}
 
-			CELL_INFO_DICT_APPEND(&dict, "ARFCN",
-					intval, uint16_t, DBUS_TYPE_UINT16);
-			break;
+static void append_record_dict(DBusMessageIter *iter,
+				const struct netmon_record *rec,
+				gboolean history)
+{
+	const char *technology = cell_type_to_tech_name(rec->type);
+	DBusMessageIter dict;
+	const char *str;
+	unsigned int i;
 
-		case OFONO_NETMON_INFO_BSIC:
-			intval = va_arg(arglist, int);
+	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+					OFONO_PROPERTIES_ARRAY_SIGNATURE,
+					&dict);
 
-			CELL_INFO_DICT_APPEND(&dict, "BSIC",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+	if (technology == NULL)
+		goto done;
 
-		case OFONO_NETMON_INFO_RXLEV:
-			intval = va_arg(arglist, int);
+	if (history) {
+		dbus_bool_t serving = rec->serving;
 
-			CELL_INFO_DICT_APPEND(&dict, "ReceivedSignalStrength",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+		ofono_dbus_dict_append(&dict, "Sequence",
+					DBUS_TYPE_UINT64, &rec->seq);
+		ofono_dbus_dict_append(&dict, "Timestamp",
+					DBUS_TYPE_UINT64, &rec->timestamp);
+		ofono_dbus_dict_append(&dict, "Serving",
+					DBUS_TYPE_BOOLEAN, &serving);
+	}
 
-		case OFONO_NETMON_INFO_TIMING_ADVANCE:
-			intval = va_arg(arglist, int);
+	ofono_dbus_dict_append(&dict, "Technology",
+					DBUS_TYPE_STRING, &technology);
 
-			CELL_INFO_DICT_APPEND(&dict, "TimingAdvance",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+	if (rec->mcc[0]) {
+		str = rec->mcc;
+		ofono_dbus_dict_append(&dict, "MobileCountryCode",
+					DBUS_TYPE_STRING, &str);
+	}
 
-		case OFONO_NETMON_INFO_PSC:
-			intval = va_arg(arglist, int);
+	if (rec->mnc[0]) {
+		str = rec->mnc;
+		ofono_dbus_dict_append(&dict, "MobileNetworkCode",
+					DBUS_TYPE_STRING, &str);
+	}
 
-			CELL_INFO_DICT_APPEND(&dict, "PrimaryScramblingCode",
-					intval, uint16_t, DBUS_TYPE_UINT16);
-			break;
+	for (i = 0; i < G_N_ELEMENTS(info_keys); i++) {
+		const struct netmon_info_key *key = &info_keys[i];
+		int value = rec->info[i];
+		dbus_uint32_t u32 = value;
+		dbus_uint16_t u16 = value;
+		unsigned char byte = value;
 
-		case OFONO_NETMON_INFO_BER:
-			intval = va_arg(arglist, int);
+		if (key->name == NULL || value < 0)
+			continue;
 
-			CELL_INFO_DICT_APPEND(&dict, "BitErrorRate",
-					intval, uint8_t, DBUS_TYPE_BYTE);
+		switch (key->type) {
+		case DBUS_TYPE_UINT32:
+			ofono_dbus_dict_append(&dict, key->name, key->type,
+									&u32);
 			break;
-
-		case OFONO_NETMON_INFO_RSSI:
-			intval = va_arg(arglist, int);
-
-			CELL_INFO_DICT_APPEND(&dict, "Strength",
-					intval, uint8_t, DBUS_TYPE_BYTE);
+		case DBUS_TYPE_UINT16:
+			ofono_dbus_dict_append(&dict, key->name, key->type,
+									&u16);
 			break;
-
-		case OFONO_NETMON_INFO_RSCP:
-			intval = va_arg(arglist, int);
-
-			CELL_INFO_DICT_APPEND(&dict, "ReceivedSignalCodePower",
-					intval, uint8_t, DBUS_TYPE_BYTE);
+		default:
+			ofono_dbus_dict_append(&dict, key->name, key->type,
+									&byte);
 			break;
+		}
+	}
 
-		case OFONO_NETMON_INFO_ECN0:
-			intval = va_arg(arglist, int);
+done:
+	dbus_message_iter_close_container(iter, &dict);
+}
 
-			CELL_INFO_DICT_APPEND(&dict, "ReceivedEnergyRatio",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+void ofono_netmon_serving_cell_notify(struct ofono_netmon *netmon,
+					enum ofono_netmon_cell_type type,
+					int info_type, ...)
+{
+	const struct netmon_record *rec;
+	DBusMessage *agent_notify;
+	DBusMessageIter iter;
+	va_list arglist;
 
-		case OFONO_NETMON_INFO_RSRQ:
-			intval = va_arg(arglist, int);
+	va_start(arglist, info_type);
+	rec = netmon_record_cell(netmon, type, TRUE, info_type, arglist);
+	va_end(arglist);
 
-			CELL_INFO_DICT_APPEND(&dict,
-					"ReferenceSignalReceivedQuality",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+	if (netmon->pending != NULL) {
+		if (netmon->reply)
+			dbus_message_unref(netmon->reply);
 
-		case OFONO_NETMON_INFO_RSRP:
-			intval = va_arg(arglist, int);
+		netmon->reply = dbus_message_new_method_return(netmon->pending);
+		dbus_message_iter_init_append(netmon->reply, &iter);
+		append_record_dict(&iter, rec, FALSE);
+	} else if (netmon->agent != NULL) {
+		agent_notify = netmon_agent_new_method_call(netmon->agent,
+					"ServingCellInformationChanged");
 
-			CELL_INFO_DICT_APPEND(&dict,
-					"ReferenceSignalReceivedPower",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+		dbus_message_iter_init_append(agent_notify, &iter);
+		append_record_dict(&iter, rec, FALSE);
+		netmon_agent_send_no_reply(netmon->agent, agent_notify);
+	}
+}
 
-		case OFONO_NETMON_INFO_EARFCN:
-			intval = va_arg(arglist, int);
+void ofono_netmon_cell_list_notify(struct ofono_netmon *netmon,
+					ofono_bool_t serving,
+					enum ofono_netmon_cell_type type,
+					int info_type, ...)
+{
+	struct netmon_record *rec;
+	va_list arglist;
 
-			CELL_INFO_DICT_APPEND(&dict, "EARFCN",
-					intval, uint16_t, DBUS_TYPE_UINT16);
-			break;
+	va_start(arglist, info_type);
+	rec = netmon_record_cell(netmon, type, serving, info_type, arglist);
+	va_end(arglist);
 
-		case OFONO_NETMON_INFO_EBAND:
-			intval = va_arg(arglist, int);
+	/* Cells reported outside of a request only go to the history */
+	rec->cell_list = netmon->pending_cells != NULL;
+}
 
-			CELL_INFO_DICT_APPEND(&dict, "EBand",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+/*
+ * Appends the records starting with sequence number seq, or with the
+ * oldest one still kept if that has been overwritten already.  With
+ * cell_list set, only the cells reported for GetCellsInformation.
+ */
+static void append_history(struct ofono_netmon *netmon,
+				DBusMessageIter *iter, guint64 seq,
+				gboolean cell_list)
+{
+	const struct netmon_record *rec;
+	DBusMessageIter array;
+	guint64 oldest = 1;
 
-		case OFONO_NETMON_INFO_CQI:
-			intval = va_arg(arglist, int);
+	if (netmon->next_seq > NETMON_HISTORY_SIZE)
+		oldest = netmon->next_seq - NETMON_HISTORY_SIZE + 1;
 
-			CELL_INFO_DICT_APPEND(&dict, "ChannelQualityIndicator",
-					intval, uint8_t, DBUS_TYPE_BYTE);
-			break;
+	if (seq < oldest)
+		seq = oldest;
 
-		case OFONO_NETMON_INFO_INVALID:
-			break;
-		}
+	dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+					"a{sv}", &array);
 
-		next_info_type = va_arg(arglist, int);
-	}
+	for (; seq <= netmon->next_seq; seq++) {
+		rec = &netmon->history[(seq - 1) % NETMON_HISTORY_SIZE];
 
-done:
-	va_end(arglist);
+		if (cell_list && !rec->cell_list)
+			continue;
 
-	dbus_message_iter_close_container(&iter, &dict);
+		append_record_dict(&array, rec, TRUE);
+	}
 
-	if (agent_notify)
-		netmon_agent_send_no_reply(netmon->agent, agent_notify);
+	dbus_message_iter_close_container(iter, &array);
 }
 
 static void serving_cell_info_callback(const struct ofono_error *error,
@@ -302,6 +364,70 @@ static DBusMessage *netmon_get_serving_cell_info(DBusConnection *conn,
 	return NULL;
 }
 
+static void cells_info_callback(const struct ofono_error *error, void *data)
+{
+	struct ofono_netmon *netmon = data;
+	DBusMessage *reply;
+	DBusMessageIter iter;
+
+	if (error->type != OFONO_ERROR_TYPE_NO_ERROR) {
+		reply = __ofono_error_failed(netmon->pending_cells);
+		__ofono_dbus_pending_reply(&netmon->pending_cells, reply);
+		return;
+	}
+
+	reply = dbus_message_new_method_return(netmon->pending_cells);
+	dbus_message_iter_init_append(reply, &iter);
+	append_history(netmon, &iter, netmon->cells_seq, TRUE);
+
+	__ofono_dbus_pending_reply(&netmon->pending_cells, reply);
+}
+
+static DBusMessage *netmon_get_cells_info(DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	struct ofono_netmon *netmon = data;
+
+	if (!netmon->driver || !netmon->driver->request_cell_list)
+		return __ofono_error_not_implemented(msg);
+
+	if (netmon->pending_cells)
+		return __ofono_error_busy(msg);
+
+	netmon->pending_cells = dbus_message_ref(msg);
+	netmon->cells_seq = netmon->next_seq + 1;
+
+	netmon->driver->request_cell_list(netmon, cells_info_callback, netmon);
+
+	return NULL;
+}
+
+static DBusMessage *netmon_get_history(DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	struct ofono_netmon *netmon = data;
+	DBusMessage *reply;
+	DBusMessageIter iter;
+	dbus_uint64_t cursor;
+	dbus_uint64_t next;
+
+	if (dbus_message_get_args(msg, NULL, DBUS_TYPE_UINT64, &cursor,
+					DBUS_TYPE_INVALID) == FALSE)
+		return __ofono_error_invalid_args(msg);
+
+	reply = dbus_message_new_method_return(msg);
+	if (reply == NULL)
+		return NULL;
+
+	next = netmon->next_seq + 1;
+
+	dbus_message_iter_init_append(reply, &iter);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT64, &next);
+	append_history(netmon, &iter, cursor, FALSE);
+
+	return reply;
+}
+
 static void periodic_updates_enabled_cb(const struct ofono_error *error,
 					void *data)
 {
@@ -407,6 +533,13 @@ static const GDBusMethodTable netmon_methods[] = {
 	{ GDBUS_ASYNC_METHOD("GetServingCellInformation",
 			NULL, GDBUS_ARGS({ "cellinfo", "a{sv}" }),
 			netmon_get_serving_cell_info) },
+	{ GDBUS_ASYNC_METHOD("GetCellsInformation",
+			NULL, GDBUS_ARGS({ "cells", "aa{sv}" }),
+			netmon_get_cells_info) },
+	{ GDBUS_METHOD("GetHistory",
+			GDBUS_ARGS({ "cursor", "t" }),
+			GDBUS_ARGS({ "next", "t" }, { "cells", "aa{sv}" }),
+			netmon_get_history) },
 	{ GDBUS_METHOD("RegisterAgent",
 			GDBUS_ARGS({ "path", "o"}, { "period", "u"}), NULL,
 			netmon_register_agent) },
@@ -455,6 +588,7 @@ static void netmon_remove(struct ofono_atom *atom)
 	if (netmon->driver && netmon->driver->remove)
 		netmon->driver->remove(netmon);
 
+	g_free(netmon->history);
 	g_free(netmon);
 }
 
@@ -472,6 +606,7 @@ struct ofono_netmon *ofono_netmon_create(struct ofono_modem *modem,
 	if (netmon == NULL)
 		return NULL;
 
+	netmon->history = g_new0(struct netmon_record, NETMON_HISTORY_SIZE);
 	netmon->atom = __ofono_modem_add_atom(modem, OFONO_ATOM_TYPE_NETMON,
 						netmon_remove, netmon);
 
@@ -60,10 +60,17 @@ struct ofono_netreg {
 	char *base_station;
 	struct network_operator_data *current_operator;
 	GSList *operator_list;
+	GHashTable *operator_table; /* operator_list entries by PLMN key */
 	struct ofono_network_registration_ops *ops;
 	int flags;
 	struct ofono_dbus_queue *q;
-	int signal_strength;
+	int signal_strength;		/* Latest value from the driver */
+	int reported_strength;		/* What the clients have been told */
+	struct ofono_netreg_strength_policy strength_policy;
+	gint64 strength_reported_at;
+	guint strength_timer;
+	unsigned int strength_updates;
+	unsigned int strength_reports;
 	struct sim_spdi *spdi;
 	struct sim_eons *eons;
 	struct ofono_sim *sim;
@@ -76,19 +83,114 @@ struct ofono_netreg {
 	struct ofono_atom *atom;
 	unsigned int hfp_watch;
 	unsigned int spn_watch;
+	unsigned int devmon_watch;
+	unsigned int muted;
 };
 
 struct network_operator_data {
-	char name[OFONO_MAX_OPERATOR_NAME_LENGTH + 1];
+	const char *name; /* from operator_names */
+	char *path; /* NULL until registered on D-Bus */
+	guint32 key; /* see network_operator_key() */
 	char mcc[OFONO_MAX_MCC_LENGTH + 1];
 	char mnc[OFONO_MAX_MNC_LENGTH + 1];
 	int status;
+	gboolean seen;
 	unsigned int techs;
 	const struct sim_eons_operator_info *eons_info;
 	struct ofono_netreg *netreg;
 };
 
+/*
+ * Operator names are shared by all modems, the same handful of PLMNs
+ * tends to show up in the scan results of each of them.
+ */
+struct operator_name {
+	unsigned int refcount;
+	char name[1];
+};
+
 static GSList *g_drivers = NULL;
+static GHashTable *operator_names = NULL;
+
+static const char *operator_name_ref(const char *name)
+{
+	char buf[OFONO_MAX_OPERATOR_NAME_LENGTH + 1];
+	struct operator_name *entry;
+	size_t len;
+
+	g_strlcpy(buf, name, sizeof(buf));
+
+	if (operator_names == NULL)
+		operator_names = g_hash_table_new(g_str_hash, g_str_equal);
+
+	entry = g_hash_table_lookup(operator_names, buf);
+	if (entry) {
+		entry->refcount++;
+		return entry->name;
+	}
+
+	len = strlen(buf);
+	entry = g_malloc(sizeof(struct operator_name) + len);
+	entry->refcount = 1;
+	memcpy(entry->name, buf, len + 1);
+
+	g_hash_table_insert(operator_names, entry->name, entry);
+
+	return entry->name;
+}
+
+static void operator_name_unref(const char *name)
+{
+	struct operator_name *entry;
+
+	if (name == NULL || operator_names == NULL)
+		return;
+
+	entry = g_hash_table_lookup(operator_names, name);
+	if (entry == NULL || --entry->refcount > 0)
+		return;
+
+	g_hash_table_remove(operator_names, entry->name);
+	g_free(entry);
+
+	if (g_hash_table_size(operator_names) == 0) {
+		g_hash_table_destroy(operator_names);
+		operator_names = NULL;
+	}
+}
+
+/*
+ * Packs MCC and MNC into a single integer: bits 0-9 hold the MNC, bit
+ * 10 is set for three digit MNCs and bits 11-20 hold the MCC.  Bit 21
+ * is always set, so that 0 can stand for "no valid PLMN".
+ */
+static guint32 network_operator_key(const char *mcc, const char *mnc)
+{
+	guint32 mcc_val = 0;
+	guint32 mnc_val = 0;
+	size_t mnc_len = strlen(mnc);
+	int i;
+
+	if (strlen(mcc) != 3 || mnc_len < 2 || mnc_len > 3)
+		return 0;
+
+	for (i = 0; i < 3; i++) {
+		if (!g_ascii_isdigit(mcc[i]))
+			return 0;
+
+		mcc_val = mcc_val * 10 + mcc[i] - '0';
+	}
+
+	for (i = 0; mnc[i]; i++) {
+		if (!g_ascii_isdigit(mnc[i]))
+			return 0;
+
+		mnc_val = mnc_val * 10 + mnc[i] - '0';
+	}
+
+	return (1 << 21) | (mcc_val << 11) |
+			(mnc_len == 3 ? 1 << 10 : 0) | mnc_val;
+}
 
 static const char *registration_mode_to_string(int mode)
 {
@@ -239,10 +341,11 @@ static struct network_operator_data *
 
 	opd = g_new0(struct network_operator_data, 1);
 
-	memcpy(&opd->name, op->name, sizeof(opd->name));
+	opd->name = operator_name_ref(op->name);
 	memcpy(&opd->mcc, op->mcc, sizeof(opd->mcc));
 	memcpy(&opd->mnc, op->mnc, sizeof(opd->mnc));
 
+	opd->key = network_operator_key(opd->mcc, opd->mnc);
 	opd->status = op->status;
 
 	if (op->tech != -1)
@@ -255,6 +358,8 @@ static void network_operator_destroy(gpointer user_data)
 {
 	struct network_operator_data *op = user_data;
 
+	operator_name_unref(op->name);
+	g_free(op->path);
 	g_free(op);
 }
 
@@ -272,40 +377,47 @@ static gint network_operator_compare(gconstpointer a, gconstpointer b)
 	return comp1 != 0 ? comp1 : comp2;
 }
 
-static gint network_operator_data_compare(gconstpointer a, gconstpointer b)
+static struct network_operator_data *network_operator_lookup(
+					struct ofono_netreg *netreg,
+					const struct ofono_network_operator *op)
 {
-	const struct network_operator_data *opa = a;
-	const struct network_operator_data *opb = b;
+	guint32 key = network_operator_key(op->mcc, op->mnc);
+	GSList *l;
 
-	int comp1;
-	int comp2;
+	if (key != 0) {
+		if (netreg->operator_table == NULL)
+			return NULL;
 
-	comp1 = strcmp(opa->mcc, opb->mcc);
-	comp2 = strcmp(opa->mnc, opb->mnc);
+		return g_hash_table_lookup(netreg->operator_table,
+						GUINT_TO_POINTER(key));
+	}
 
-	return comp1 != 0 ? comp1 : comp2;
+	/* Not a proper PLMN, e.g. only the operator name is known */
+	l = g_slist_find_custom(netreg->operator_list, op,
+					network_operator_compare);
+
+	return l ? l->data : NULL;
 }
 
-static const char *network_operator_build_path(struct ofono_netreg *netreg,
-							const char *mcc,
-							const char *mnc)
+static void operator_table_add(struct ofono_netreg *netreg,
+				struct network_operator_data *opd)
 {
-	static char path[256];
+	if (opd->path == NULL || opd->key == 0)
+		return;
 
-	snprintf(path, sizeof(path), "%s/operator/%s%s",
-			__ofono_atom_get_path(netreg->atom),
-			mcc, mnc);
+	if (netreg->operator_table == NULL)
+		netreg->operator_table = g_hash_table_new(g_direct_hash,
+								g_direct_equal);
 
-	return path;
+	g_hash_table_insert(netreg->operator_table,
+				GUINT_TO_POINTER(opd->key), opd);
 }
 
 static void set_network_operator_status(struct network_operator_data *opd,
 					int status)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
-	struct ofono_netreg *netreg = opd->netreg;
 	const char *status_str;
-	const char *path;
 
 	if (opd->status == status)
 		return;
@@ -313,13 +425,12 @@ static void set_network_operator_status(struct network_operator_data *opd,
 	opd->status = status;
 
 	/* Don't emit for the case where only operator name is reported */
-	if (opd->mcc[0] == '\0' && opd->mnc[0] == '\0')
+	if (opd->path == NULL)
 		return;
 
 	status_str = network_operator_status_to_string(status);
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
 
-	ofono_dbus_signal_property_changed(conn, path,
+	ofono_dbus_signal_property_changed(conn, opd->path,
 					OFONO_NETWORK_OPERATOR_INTERFACE,
 					"Status", DBUS_TYPE_STRING,
 					&status_str);
@@ -329,18 +440,19 @@ static void set_network_operator_techs(struct network_operator_data *opd,
 					unsigned int techs)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
-	struct ofono_netreg *netreg = opd->netreg;
 	char **technologies;
-	const char *path;
 
 	if (opd->techs == techs)
 		return;
 
 	opd->techs = techs;
+
+	if (opd->path == NULL)
+		return;
+
 	technologies = network_operator_technologies(opd);
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
 
-	ofono_dbus_signal_array_property_changed(conn, path,
+	ofono_dbus_signal_array_property_changed(conn, opd->path,
 					OFONO_NETWORK_REGISTRATION_INTERFACE,
 					"Technologies", DBUS_TYPE_STRING,
 					&technologies);
@@ -428,16 +540,16 @@ static void set_network_operator_name(struct network_operator_data *opd,
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
 	struct ofono_netreg *netreg = opd->netreg;
-	const char *path;
+	const char *oldname = opd->name;
 
-	if (name[0] == '\0')
+	if (name[0] == '\0' || name == oldname)
 		return;
 
-	if (!strncmp(opd->name, name, OFONO_MAX_OPERATOR_NAME_LENGTH))
+	if (!strncmp(oldname, name, OFONO_MAX_OPERATOR_NAME_LENGTH))
 		return;
 
-	strncpy(opd->name, name, OFONO_MAX_OPERATOR_NAME_LENGTH);
-	opd->name[OFONO_MAX_OPERATOR_NAME_LENGTH] = '\0';
+	opd->name = operator_name_ref(name);
+	operator_name_unref(oldname);
 
 	/*
 	 * If we have Enhanced Operator Name info on the SIM, we always use
@@ -450,14 +562,12 @@ static void set_network_operator_name(struct network_operator_data *opd,
 		netreg_emit_operator_display_name(netreg);
 
 	/* Don't emit when only operator name is reported */
-	if (opd->mcc[0] == '\0' && opd->mnc[0] == '\0')
+	if (opd->path == NULL)
 		return;
 
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
-
-	ofono_dbus_signal_property_changed(conn, path,
+	ofono_dbus_signal_property_changed(conn, opd->path,
 					OFONO_NETWORK_OPERATOR_INTERFACE,
-					"Name", DBUS_TYPE_STRING, &name);
+					"Name", DBUS_TYPE_STRING, &opd->name);
 }
 
 static void set_network_operator_eons_info(struct network_operator_data *opd,
@@ -466,7 +576,7 @@ static void set_network_operator_eons_info(struct network_operator_data *opd,
 	DBusConnection *conn = ofono_dbus_get_connection();
 	struct ofono_netreg *netreg = opd->netreg;
 	const struct sim_eons_operator_info *old_eons_info = opd->eons_info;
-	const char *path;
+	const char *path = opd->path;
 	const char *oldname;
 	const char *newname;
 	const char *oldinfo;
@@ -475,7 +585,6 @@ static void set_network_operator_eons_info(struct network_operator_data *opd,
 	if (old_eons_info == NULL && eons_info == NULL)
 		return;
 
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
 	opd->eons_info = eons_info;
 
 	if (old_eons_info && old_eons_info->longname)
@@ -489,7 +598,8 @@ static void set_network_operator_eons_info(struct network_operator_data *opd,
 		newname = opd->name;
 
 	if (oldname != newname && strcmp(oldname, newname)) {
-		ofono_dbus_signal_property_changed(conn, path,
+		if (path)
+			ofono_dbus_signal_property_changed(conn, path,
 					OFONO_NETWORK_OPERATOR_INTERFACE,
 					"Name", DBUS_TYPE_STRING, &newname);
 
@@ -507,7 +617,7 @@ static void set_network_operator_eons_info(struct network_operator_data *opd,
 	else
 		newinfo = "";
 
-	if (oldinfo != newinfo && strcmp(oldinfo, newinfo))
+	if (path && oldinfo != newinfo && strcmp(oldinfo, newinfo))
 		ofono_dbus_signal_property_changed(conn, path,
 					OFONO_NETWORK_OPERATOR_INTERFACE,
 					"AdditionalInformation",
@@ -630,17 +740,21 @@ static gboolean network_operator_dbus_register(struct ofono_netreg *netreg,
 					struct network_operator_data *opd)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
-	const char *path;
 
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
+	opd->path = g_strdup_printf("%s/operator/%s%s",
+					__ofono_atom_get_path(netreg->atom),
+					opd->mcc, opd->mnc);
 
-	if (!g_dbus_register_interface(conn, path,
+	if (!g_dbus_register_interface(conn, opd->path,
 					OFONO_NETWORK_OPERATOR_INTERFACE,
 					network_operator_methods,
 					network_operator_signals,
 					NULL, opd,
 					network_operator_destroy)) {
-		ofono_error("Could not register NetworkOperator %s", path);
+		ofono_error("Could not register NetworkOperator %s",
+								opd->path);
+		g_free(opd->path);
+		opd->path = NULL;
 		return FALSE;
 	}
 
@@ -658,41 +772,56 @@ static gboolean network_operator_dbus_unregister(struct ofono_netreg *netreg,
 					struct network_operator_data *opd)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
-	const char *path;
+	char *path = opd->path;
+	gboolean ret;
 
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
-
-	return g_dbus_unregister_interface(conn, path,
+	/* opd is gone once the interface is, keep the path until then */
+	opd->path = NULL;
+	ret = g_dbus_unregister_interface(conn, path,
 					OFONO_NETWORK_OPERATOR_INTERFACE);
+	g_free(path);
+
+	return ret;
 }
 
 static GSList *compress_operator_list(const struct ofono_network_operator *list,
 					int total)
 {
+	GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
 	GSList *oplist = 0;
 	GSList *o;
 	int i;
 	struct network_operator_data *opd;
 
 	for (i = 0; i < total; i++) {
-		o = NULL;
+		guint32 key;
 
 		if (list[i].mcc[0] == '\0' || list[i].mnc[0] == '\0')
 			continue;
 
-		if (oplist)
+		key = network_operator_key(list[i].mcc, list[i].mnc);
+
+		if (key != 0)
+			opd = g_hash_table_lookup(seen, GUINT_TO_POINTER(key));
+		else {
 			o = g_slist_find_custom(oplist, &list[i],
 						network_operator_compare);
+			opd = o ? o->data : NULL;
+		}
 
-		if (o == NULL) {
+		if (opd == NULL) {
 			opd = network_operator_create(&list[i]);
 			oplist = g_slist_prepend(oplist, opd);
-		} else if (o && list[i].tech != -1) {
-			opd = o->data;
+
+			if (key != 0)
+				g_hash_table_insert(seen,
+						GUINT_TO_POINTER(key), opd);
+		} else if (list[i].tech != -1)
 			opd->techs |= 1 << list[i].tech;
-		}
 	}
 
+	g_hash_table_destroy(seen);
+
 	if (oplist)
 		oplist = g_slist_reverse(oplist);
 
@@ -713,98 +842,90 @@ static gboolean update_operator_list(struct ofono_netreg *netreg, int total,
 
 	for (c = compressed; c; c = c->next) {
 		struct network_operator_data *copd = c->data;
+		struct network_operator_data *opd;
+		struct ofono_network_operator op;
 
-		o = g_slist_find_custom(netreg->operator_list, copd,
-					network_operator_data_compare);
-
-		if (o) { /* Update and move to a new list */
-			set_network_operator_status(o->data, copd->status);
-			set_network_operator_techs(o->data, copd->techs);
-			set_network_operator_name(o->data, copd->name);
-
-			n = g_slist_prepend(n, o->data);
-			netreg->operator_list =
-				g_slist_remove(netreg->operator_list, o->data);
-		} else {
-			/* New operator */
-			struct network_operator_data *opd;
-
-			opd = g_memdup(copd,
-					sizeof(struct network_operator_data));
+		memcpy(op.mcc, copd->mcc, sizeof(op.mcc));
+		memcpy(op.mnc, copd->mnc, sizeof(op.mnc));
+		opd = network_operator_lookup(netreg, &op);
 
-			if (!network_operator_dbus_register(netreg, opd)) {
-				g_free(opd);
-				continue;
-			}
+		if (opd) { /* Update and move to a new list */
+			set_network_operator_status(opd, copd->status);
+			set_network_operator_techs(opd, copd->techs);
+			set_network_operator_name(opd, copd->name);
 
+			opd->seen = TRUE;
 			n = g_slist_prepend(n, opd);
+			network_operator_destroy(copd);
+		} else if (network_operator_dbus_register(netreg, copd)) {
+			/* New operator */
+			n = g_slist_prepend(n, copd);
 			changed = TRUE;
-		}
+		} else
+			network_operator_destroy(copd);
 	}
 
-	g_slist_free_full(compressed, g_free);
+	g_slist_free(compressed);
 
 	if (n)
 		n = g_slist_reverse(n);
 
-	if (netreg->operator_list)
-		changed = TRUE;
-
 	for (o = netreg->operator_list; o; o = o->next) {
 		struct network_operator_data *op = o->data;
-		if (op != op->netreg->current_operator)
-			network_operator_dbus_unregister(netreg, op);
-		else
+
+		if (op->seen) {
+			op->seen = FALSE;
+			continue;
+		}
+
+		changed = TRUE;
+
+		if (op == netreg->current_operator)
 			current_op = op;
+		else if (op->path == NULL)
+			network_operator_destroy(op);
+		else
+			network_operator_dbus_unregister(netreg, op);
 	}
 
-	if (current_op) {
+	if (current_op)
 		n = g_slist_prepend(n, current_op);
-		netreg->operator_list =
-			g_slist_remove(netreg->operator_list, current_op);
-	}
 
 	g_slist_free(netreg->operator_list);
 
 	netreg->operator_list = n;
 
+	if (netreg->operator_table)
+		g_hash_table_remove_all(netreg->operator_table);
+
+	for (o = netreg->operator_list; o; o = o->next)
+		operator_table_add(netreg, o->data);
+
 	return changed;
 }
 
-static DBusMessage *network_get_properties(DBusConnection *conn,
-						DBusMessage *msg, void *data)
+static void netreg_append_properties(DBusMessageIter *dict, void *data)
 {
 	struct ofono_netreg *netreg = data;
-	DBusMessage *reply;
-	DBusMessageIter iter;
-	DBusMessageIter dict;
-
 	const char *status = registration_status_to_string(netreg->status);
 	const char *operator;
 	const char *mode = registration_mode_to_string(netreg->mode);
+	unsigned char hysteresis;
+	unsigned char bars;
+	dbus_uint16_t interval;
 
-	reply = dbus_message_new_method_return(msg);
-	if (reply == NULL)
-		return NULL;
-
-	dbus_message_iter_init_append(reply, &iter);
-
-	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-					OFONO_PROPERTIES_ARRAY_SIGNATURE,
-					&dict);
-
-	ofono_dbus_dict_append(&dict, "Status", DBUS_TYPE_STRING, &status);
-	ofono_dbus_dict_append(&dict, "Mode", DBUS_TYPE_STRING, &mode);
+	ofono_dbus_dict_append(dict, "Status", DBUS_TYPE_STRING, &status);
+	ofono_dbus_dict_append(dict, "Mode", DBUS_TYPE_STRING, &mode);
 
 	if (netreg->location != -1) {
 		dbus_uint16_t location = netreg->location;
-		ofono_dbus_dict_append(&dict, "LocationAreaCode",
+		ofono_dbus_dict_append(dict, "LocationAreaCode",
 					DBUS_TYPE_UINT16, &location);
 	}
 
 	if (netreg->cellid != -1) {
 		dbus_uint32_t cellid = netreg->cellid;
-		ofono_dbus_dict_append(&dict, "CellId",
+		ofono_dbus_dict_append(dict, "CellId",
 					DBUS_TYPE_UINT32, &cellid);
 	}
 
@@ -812,41 +933,58 @@ static DBusMessage *network_get_properties(DBusConnection *conn,
 		const char *technology =
 			registration_tech_to_string(netreg->technology);
 
-		ofono_dbus_dict_append(&dict, "Technology", DBUS_TYPE_STRING,
+		ofono_dbus_dict_append(dict, "Technology", DBUS_TYPE_STRING,
 					&technology);
 	}
 
 	if (netreg->current_operator) {
 		if (netreg->current_operator->mcc[0] != '\0') {
 			const char *mcc = netreg->current_operator->mcc;
-			ofono_dbus_dict_append(&dict, "MobileCountryCode",
+			ofono_dbus_dict_append(dict, "MobileCountryCode",
 						DBUS_TYPE_STRING, &mcc);
 		}
 
 		if (netreg->current_operator->mnc[0] != '\0') {
 			const char *mnc = netreg->current_operator->mnc;
-			ofono_dbus_dict_append(&dict, "MobileNetworkCode",
+			ofono_dbus_dict_append(dict, "MobileNetworkCode",
 						DBUS_TYPE_STRING, &mnc);
 		}
 	}
 
 	operator = get_operator_display_name(netreg);
-	ofono_dbus_dict_append(&dict, "Name", DBUS_TYPE_STRING, &operator);
+	ofono_dbus_dict_append(dict, "Name", DBUS_TYPE_STRING, &operator);
 
-	if (netreg->signal_strength != -1) {
-		unsigned char strength = netreg->signal_strength;
+	if (netreg->reported_strength != -1) {
+		unsigned char strength = netreg->reported_strength;
 
-		ofono_dbus_dict_append(&dict, "Strength", DBUS_TYPE_BYTE,
+		ofono_dbus_dict_append(dict, "Strength", DBUS_TYPE_BYTE,
 					&strength);
 	}
 
+	hysteresis = netreg->strength_policy.hysteresis;
+	ofono_dbus_dict_append(dict, "StrengthHysteresis", DBUS_TYPE_BYTE,
+				&hysteresis);
+
+	bars = netreg->strength_policy.bars;
+	ofono_dbus_dict_append(dict, "StrengthBars", DBUS_TYPE_BYTE, &bars);
+
+	interval = netreg->strength_policy.interval;
+	ofono_dbus_dict_append(dict, "StrengthInterval", DBUS_TYPE_UINT16,
+				&interval);
+
 	if (netreg->base_station)
-		ofono_dbus_dict_append(&dict, "BaseStation", DBUS_TYPE_STRING,
+		ofono_dbus_dict_append(dict, "BaseStation", DBUS_TYPE_STRING,
 					&netreg->base_station);
+}
 
-	dbus_message_iter_close_container(&iter, &dict);
+static DBusMessage *network_get_properties(DBusConnection *conn,
+						DBusMessage *msg, void *data)
+{
+	struct ofono_netreg *netreg = data;
 
-	return reply;
+	return __ofono_dbus_properties_reply(msg,
+					__ofono_atom_get_path(netreg->atom),
+					OFONO_NETWORK_REGISTRATION_INTERFACE);
 }
 
 static DBusMessage *network_register_fn(DBusMessage *msg, void *data)
@@ -879,12 +1017,10 @@ static void append_operator_struct(struct ofono_netreg *netreg,
 					DBusMessageIter *iter)
 {
 	DBusMessageIter entry, dict;
-	const char *path;
-
-	path = network_operator_build_path(netreg, opd->mcc, opd->mnc);
 
 	dbus_message_iter_open_container(iter, DBUS_TYPE_STRUCT, NULL, &entry);
-	dbus_message_iter_append_basic(&entry, DBUS_TYPE_OBJECT_PATH, &path);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_OBJECT_PATH,
+								&opd->path);
 	dbus_message_iter_open_container(&entry, DBUS_TYPE_ARRAY,
 					OFONO_PROPERTIES_ARRAY_SIGNATURE,
 					&dict);
@@ -896,19 +1032,8 @@ static void append_operator_struct(struct ofono_netreg *netreg,
 static void append_operator_struct_list(struct ofono_netreg *netreg,
 					DBusMessageIter *array)
 {
-	DBusConnection *conn = ofono_dbus_get_connection();
-	char **children;
-	char path[256];
 	GSList *l;
 
-	snprintf(path, sizeof(path), "%s/operator",
-			__ofono_atom_get_path(netreg->atom));
-
-	if (!dbus_connection_list_registered(conn, path, &children)) {
-		DBG("Unable to obtain registered NetworkOperator(s)");
-		return;
-	}
-
 	/*
 	 * Quoting 27.007: "The list of operators shall be in order: home
 	 * network, networks referenced in SIM or active application in the
@@ -920,19 +1045,11 @@ static void append_operator_struct_list(struct ofono_netreg *netreg,
 	 */
 	for (l = netreg->operator_list; l; l = l->next) {
 		struct network_operator_data *opd = l->data;
-		char mnc[OFONO_MAX_MNC_LENGTH + 1];
-		char mcc[OFONO_MAX_MCC_LENGTH + 1];
-		int j;
-
-		for (j = 0; children[j]; j++) {
-			sscanf(children[j], "%3[0-9]%[0-9]", mcc, mnc);
 
-			if (!strcmp(opd->mcc, mcc) && !strcmp(opd->mnc, mnc))
-				append_operator_struct(netreg, opd, array);
-		}
+		/* Only the operators that are registered on D-Bus */
+		if (opd->path)
+			append_operator_struct(netreg, opd, array);
 	}
-
-	dbus_free_string_array(children);
 }
 
 static void network_signal_operators_changed(struct ofono_netreg *netreg)
@@ -1064,10 +1181,104 @@ static DBusMessage *network_get_operators(DBusConnection *conn,
 	return reply;
 }
 
+static void strength_update(struct ofono_netreg *netreg);
+
+static void strength_policy_changed(struct ofono_netreg *netreg,
+					const char *name, int type,
+					const void *value)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+	const char *path = __ofono_atom_get_path(netreg->atom);
+
+	ofono_dbus_signal_property_changed(conn, path,
+					OFONO_NETWORK_REGISTRATION_INTERFACE,
+					name, type, value);
+
+	if (netreg->driver->set_strength_policy)
+		netreg->driver->set_strength_policy(netreg,
+						&netreg->strength_policy);
+
+	/* Let a pending report go out under the new rules */
+	if (netreg->strength_timer) {
+		g_source_remove(netreg->strength_timer);
+		netreg->strength_timer = 0;
+	}
+
+	strength_update(netreg);
+}
+
+static DBusMessage *network_set_property(DBusConnection *conn,
+						DBusMessage *msg, void *data)
+{
+	struct ofono_netreg *netreg = data;
+	struct ofono_netreg_strength_policy *policy = &netreg->strength_policy;
+	DBusMessageIter iter;
+	DBusMessageIter var;
+	const char *property;
+
+	if (!dbus_message_iter_init(msg, &iter))
+		return __ofono_error_invalid_args(msg);
+
+	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_STRING)
+		return __ofono_error_invalid_args(msg);
+
+	dbus_message_iter_get_basic(&iter, &property);
+	dbus_message_iter_next(&iter);
+
+	if (dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_VARIANT)
+		return __ofono_error_invalid_args(msg);
+
+	dbus_message_iter_recurse(&iter, &var);
+
+	if (g_str_equal(property, "StrengthHysteresis") ||
+			g_str_equal(property, "StrengthBars")) {
+		unsigned char value;
+		unsigned int *field;
+
+		if (dbus_message_iter_get_arg_type(&var) != DBUS_TYPE_BYTE)
+			return __ofono_error_invalid_args(msg);
+
+		dbus_message_iter_get_basic(&var, &value);
+
+		if (value > 100)
+			return __ofono_error_invalid_args(msg);
+
+		if (g_str_equal(property, "StrengthBars"))
+			field = &policy->bars;
+		else
+			field = &policy->hysteresis;
+
+		if (*field != value) {
+			*field = value;
+			strength_policy_changed(netreg, property,
+						DBUS_TYPE_BYTE, &value);
+		}
+	} else if (g_str_equal(property, "StrengthInterval")) {
+		dbus_uint16_t value;
+
+		if (dbus_message_iter_get_arg_type(&var) != DBUS_TYPE_UINT16)
+			return __ofono_error_invalid_args(msg);
+
+		dbus_message_iter_get_basic(&var, &value);
+
+		if (policy->interval != value) {
+			policy->interval = value;
+			strength_policy_changed(netreg, property,
+						DBUS_TYPE_UINT16, &value);
+		}
+	} else
+		return __ofono_error_invalid_args(msg);
+
+	return dbus_message_new_method_return(msg);
+}
+
 static const GDBusMethodTable network_registration_methods[] = {
 	{ GDBUS_METHOD("GetProperties",
 			NULL, GDBUS_ARGS({ "properties", "a{sv}" }),
 			network_get_properties) },
+	{ GDBUS_METHOD("SetProperty",
+			GDBUS_ARGS({ "property", "s" }, { "value", "v" }),
+			NULL, network_set_property) },
 	{ GDBUS_ASYNC_METHOD("Register",
 				NULL, NULL, network_register) },
 	{ GDBUS_METHOD("GetOperators",
@@ -1112,8 +1323,12 @@ static void set_registration_location(struct ofono_netreg *netreg, int lac)
 
 	netreg->location = lac;
 
-	if (netreg->location == -1)
+	/* The property goes away without a signal */
+	if (netreg->location == -1) {
+		__ofono_dbus_properties_invalidate(path,
+					OFONO_NETWORK_REGISTRATION_INTERFACE);
 		return;
+	}
 
 	ofono_dbus_signal_property_changed(conn, path,
 					OFONO_NETWORK_REGISTRATION_INTERFACE,
@@ -1129,8 +1344,11 @@ static void set_registration_cellid(struct ofono_netreg *netreg, int ci)
 
 	netreg->cellid = ci;
 
-	if (netreg->cellid == -1)
+	if (netreg->cellid == -1) {
+		__ofono_dbus_properties_invalidate(path,
+					OFONO_NETWORK_REGISTRATION_INTERFACE);
 		return;
+	}
 
 	ofono_dbus_signal_property_changed(conn, path,
 					OFONO_NETWORK_REGISTRATION_INTERFACE,
@@ -1145,8 +1363,11 @@ static void set_registration_technology(struct ofono_netreg *netreg, int tech)
 
 	netreg->technology = tech;
 
-	if (netreg->technology == -1)
+	if (netreg->technology == -1) {
+		__ofono_dbus_properties_invalidate(path,
+					OFONO_NETWORK_REGISTRATION_INTERFACE);
 		return;
+	}
 
 	ofono_dbus_signal_property_changed(conn, path,
 					OFONO_NETWORK_REGISTRATION_INTERFACE,
@@ -1260,7 +1481,7 @@ static void current_operator_callback(const struct ofono_error *error,
 	DBusConnection *conn = ofono_dbus_get_connection();
 	struct ofono_netreg *netreg = data;
 	const char *path = __ofono_atom_get_path(netreg->atom);
-	GSList *op = NULL;
+	struct network_operator_data *found = NULL;
 
 	DBG("%p, %p", netreg, netreg->current_operator);
 
@@ -1286,11 +1507,10 @@ static void current_operator_callback(const struct ofono_error *error,
 	reset_available(netreg->current_operator, current);
 
 	if (current)
-		op = g_slist_find_custom(netreg->operator_list, current,
-					network_operator_compare);
+		found = network_operator_lookup(netreg, current);
 
-	if (op) {
-		struct network_operator_data *opd = op->data;
+	if (found) {
+		struct network_operator_data *opd = found;
 		unsigned int techs = opd->techs;
 
 		if (current->tech != -1) {
@@ -1301,10 +1521,10 @@ static void current_operator_callback(const struct ofono_error *error,
 		set_network_operator_status(opd, OPERATOR_STATUS_CURRENT);
 		set_network_operator_name(opd, current->name);
 
-		if (netreg->current_operator == op->data)
+		if (netreg->current_operator == opd)
 			return;
 
-		netreg->current_operator = op->data;
+		netreg->current_operator = opd;
 		goto emit;
 	}
 
@@ -1315,7 +1535,7 @@ static void current_operator_callback(const struct ofono_error *error,
 
 		if (opd->mcc[0] != '\0' && opd->mnc[0] != '\0' &&
 				!network_operator_dbus_register(netreg, opd)) {
-			g_free(opd);
+			network_operator_destroy(opd);
 			return;
 		} else
 			opd->netreg = netreg;
@@ -1323,6 +1543,7 @@ static void current_operator_callback(const struct ofono_error *error,
 		netreg->current_operator = opd;
 		netreg->operator_list = g_slist_append(netreg->operator_list,
 							opd);
+		operator_table_add(netreg, opd);
 	} else {
 		/* We don't free this here because operator is registered */
 		/* Taken care of elsewhere */
@@ -1385,6 +1606,17 @@ static void notify_emulator_status(struct ofono_atom *atom, void *data)
 	}
 }
 
+static void strength_reset(struct ofono_netreg *netreg)
+{
+	if (netreg->strength_timer) {
+		g_source_remove(netreg->strength_timer);
+		netreg->strength_timer = 0;
+	}
+
+	netreg->signal_strength = -1;
+	netreg->reported_strength = -1;
+}
+
 void ofono_netreg_status_notify(struct ofono_netreg *netreg, int status,
 			int lac, int ci, int tech)
 {
@@ -1433,7 +1665,12 @@ void ofono_netreg_status_notify(struct ofono_netreg *netreg, int status,
 		current_operator_callback(&error, NULL, netreg);
 		__ofono_netreg_set_base_station_name(netreg, NULL);
 
-		netreg->signal_strength = -1;
+		strength_reset(netreg);
+
+		/* Strength and BaseStation are dropped silently */
+		__ofono_dbus_properties_invalidate(
+					__ofono_atom_get_path(netreg->atom),
+					OFONO_NETWORK_REGISTRATION_INTERFACE);
 	}
 
 	notify_status_watches(netreg);
@@ -1562,29 +1799,57 @@ static void notify_emulator_strength(struct ofono_atom *atom, void *data)
 	ofono_emulator_set_indicator(em, OFONO_EMULATOR_IND_SIGNAL, val);
 }
 
-void ofono_netreg_strength_notify(struct ofono_netreg *netreg, int strength)
+unsigned int ofono_netreg_strength_bar(unsigned int bars, int strength)
+{
+	if (bars == 0 || strength <= 0)
+		return 0;
+
+	/* 0..100 maps onto 0..bars-1, each bar being equally wide */
+	return MIN(strength, 100) * bars / 101;
+}
+
+static gboolean strength_change_wanted(struct ofono_netreg *netreg)
+{
+	const struct ofono_netreg_strength_policy *policy =
+						&netreg->strength_policy;
+	int strength = netreg->signal_strength;
+	int reported = netreg->reported_strength;
+
+	if (strength == reported)
+		return FALSE;
+
+	/* Gaining or losing the signal is always worth reporting */
+	if (strength == -1 || reported == -1)
+		return TRUE;
+
+	if (policy->bars && ofono_netreg_strength_bar(policy->bars, strength) ==
+			ofono_netreg_strength_bar(policy->bars, reported))
+		return FALSE;
+
+	return ABS(strength - reported) >= (int) policy->hysteresis;
+}
+
+static void strength_report(struct ofono_netreg *netreg)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
 	struct ofono_modem *modem;
 
-	if (netreg->signal_strength == strength)
-		return;
-
-	/*
-	 * Theoretically we can get signal strength even when not registered
-	 * to any network.  However, what do we do with it in that case?
-	 */
-	if (netreg->status != NETWORK_REGISTRATION_STATUS_REGISTERED &&
-			netreg->status != NETWORK_REGISTRATION_STATUS_ROAMING)
-		return;
+	if (netreg->strength_timer) {
+		g_source_remove(netreg->strength_timer);
+		netreg->strength_timer = 0;
+	}
 
-	DBG("strength %d", strength);
+	netreg->reported_strength = netreg->signal_strength;
+	netreg->strength_reported_at = g_get_monotonic_time();
+	netreg->strength_reports++;
 
-	netreg->signal_strength = strength;
+	DBG("strength %d (%u of %u updates reported)",
+			netreg->reported_strength, netreg->strength_reports,
+			netreg->strength_updates);
 
-	if (strength != -1) {
+	if (netreg->reported_strength != -1) {
 		const char *path = __ofono_atom_get_path(netreg->atom);
-		unsigned char strength_byte = netreg->signal_strength;
+		unsigned char strength_byte = netreg->reported_strength;
 
 		ofono_dbus_signal_property_changed(conn, path,
 					OFONO_NETWORK_REGISTRATION_INTERFACE,
@@ -1596,7 +1861,68 @@ void ofono_netreg_strength_notify(struct ofono_netreg *netreg, int strength)
 	__ofono_modem_foreach_registered_atom(modem,
 				OFONO_ATOM_TYPE_EMULATOR_HFP,
 				notify_emulator_strength,
-				GINT_TO_POINTER(netreg->signal_strength));
+				GINT_TO_POINTER(netreg->reported_strength));
+}
+
+static gboolean strength_timeout(gpointer user_data)
+{
+	struct ofono_netreg *netreg = user_data;
+
+	netreg->strength_timer = 0;
+
+	/* The latest value may have gone back to what was reported */
+	if (strength_change_wanted(netreg))
+		strength_report(netreg);
+
+	return FALSE;
+}
+
+static void strength_update(struct ofono_netreg *netreg)
+{
+	guint interval = netreg->strength_policy.interval;
+	gint64 elapsed;
+
+	if (!strength_change_wanted(netreg))
+		return;
+
+	if (interval && netreg->signal_strength != -1 &&
+			netreg->reported_strength != -1) {
+		/* Whatever is the latest value goes out once it fires */
+		if (netreg->strength_timer)
+			return;
+
+		elapsed = g_get_monotonic_time() -
+					netreg->strength_reported_at;
+
+		if (elapsed < (gint64) interval * G_USEC_PER_SEC) {
+			guint ms = interval * 1000 - elapsed / 1000;
+
+			netreg->strength_timer = g_timeout_add(ms,
+						strength_timeout, netreg);
+			return;
+		}
+	}
+
+	strength_report(netreg);
+}
+
+void ofono_netreg_strength_notify(struct ofono_netreg *netreg, int strength)
+{
+	if (netreg->signal_strength == strength)
+		return;
+
+	/*
+	 * Theoretically we can get signal strength even when not registered
+	 * to any network.  However, what do we do with it in that case?
+	 */
+	if (netreg->status != NETWORK_REGISTRATION_STATUS_REGISTERED &&
+			netreg->status != NETWORK_REGISTRATION_STATUS_ROAMING)
+		return;
+
+	netreg->signal_strength = strength;
+	netreg->strength_updates++;
+
+	strength_update(netreg);
 }
 
 static void sim_opl_read_cb(int ok, int length, int record,
@@ -1849,23 +2175,38 @@ static void netreg_unregister(struct ofono_atom *atom)
 
 	__ofono_modem_remove_atom_watch(modem, netreg->hfp_watch);
 
+	if (netreg->strength_timer) {
+		g_source_remove(netreg->strength_timer);
+		netreg->strength_timer = 0;
+	}
+
+	if (netreg->devmon_watch) {
+		__ofono_devmon_remove_watch(netreg->devmon_watch);
+		netreg->devmon_watch = 0;
+	}
+
 	__ofono_watchlist_free(netreg->status_watches);
 	netreg->status_watches = NULL;
 
 	for (l = netreg->operator_list; l; l = l->next) {
 		struct network_operator_data *opd = l->data;
 
-		if (opd->mcc[0] == '\0' && opd->mnc[0] == '\0') {
-			g_free(opd);
+		if (opd->path == NULL) {
+			network_operator_destroy(opd);
 			continue;
 		}
 
-		network_operator_dbus_unregister(netreg, l->data);
+		network_operator_dbus_unregister(netreg, opd);
 	}
 
 	g_slist_free(netreg->operator_list);
 	netreg->operator_list = NULL;
 
+	if (netreg->operator_table) {
+		g_hash_table_destroy(netreg->operator_table);
+		netreg->operator_table = NULL;
+	}
+
 	if (netreg->base_station) {
 		g_free(netreg->base_station);
 		netreg->base_station = NULL;
@@ -1890,6 +2231,8 @@ static void netreg_unregister(struct ofono_atom *atom)
 
 	netreg->sim = NULL;
 
+	__ofono_dbus_properties_unregister(path,
+					OFONO_NETWORK_REGISTRATION_INTERFACE);
 	g_dbus_unregister_interface(conn, path,
 					OFONO_NETWORK_REGISTRATION_INTERFACE);
 	ofono_modem_remove_interface(modem,
@@ -1937,6 +2280,7 @@ struct ofono_netreg *ofono_netreg_create(struct ofono_modem *modem,
 	netreg->cellid = -1;
 	netreg->technology = -1;
 	netreg->signal_strength = -1;
+	netreg->reported_strength = -1;
 
 	netreg->atom = __ofono_modem_add_atom(modem, OFONO_ATOM_TYPE_NETREG,
 						netreg_remove, netreg);
@@ -2105,11 +2449,30 @@ static void emulator_hfp_init(struct ofono_atom *atom, void *data)
 
 	notify_emulator_status(atom, GINT_TO_POINTER(netreg->status));
 	notify_emulator_strength(atom,
-				GINT_TO_POINTER(netreg->signal_strength));
+				GINT_TO_POINTER(netreg->reported_strength));
 
 	ofono_emulator_add_handler(em, "+COPS", emulator_cops_cb, data, NULL);
 }
 
+static void netreg_devmon_muted(unsigned int muted, void *data)
+{
+	struct ofono_netreg *netreg = data;
+	unsigned int unmuted = netreg->muted & ~muted;
+
+	if (netreg->muted == muted)
+		return;
+
+	DBG("muted 0x%02x", muted);
+
+	netreg->muted = muted;
+	netreg->driver->mute_indications(netreg, muted);
+
+	/* Catch up with whatever the modem kept quiet about */
+	if (unmuted && netreg->driver->registration_status)
+		netreg->driver->registration_status(netreg,
+					registration_status_callback, netreg);
+}
+
 static void emulator_hfp_watch(struct ofono_atom *atom,
 				enum ofono_atom_watch_condition cond,
 				void *data)
@@ -2135,6 +2498,10 @@ void ofono_netreg_register(struct ofono_netreg *netreg)
 		return;
 	}
 
+	__ofono_dbus_properties_register(path,
+					OFONO_NETWORK_REGISTRATION_INTERFACE,
+					netreg_append_properties, netreg);
+
 	netreg->status_watches = __ofono_watchlist_new(g_free);
 	netreg->q = __ofono_dbus_queue_new();
 
@@ -2144,6 +2511,12 @@ void ofono_netreg_register(struct ofono_netreg *netreg)
 		netreg->driver->registration_status(netreg,
 					init_registration_status, netreg);
 
+	if (netreg->driver->mute_indications != NULL) {
+		netreg->devmon_watch = __ofono_devmon_add_watch(
+					netreg_devmon_muted, netreg, NULL);
+		netreg_devmon_muted(ofono_devmon_get_muted(), netreg);
+	}
+
 	netreg->sim = __ofono_atom_find(OFONO_ATOM_TYPE_SIM, modem);
 	if (netreg->sim != NULL) {
 		/* Assume that if sim atom exists, it is ready */
@@ -46,11 +46,29 @@ void __ofono_log_cleanup(ofono_bool_t backtrace);
 void __ofono_log_enable(struct ofono_debug_desc *start,
 					struct ofono_debug_desc *stop);
 
+typedef void (*ofono_log_trace_cb_t)(const struct ofono_debug_desc *desc,
+					const char *format, va_list ap);
+typedef void (*ofono_log_crash_cb_t)(void);
+
+void __ofono_log_set_trace(ofono_log_trace_cb_t trace,
+					ofono_log_crash_cb_t crash);
+
+int __ofono_trace_init(unsigned int kbytes);
+void __ofono_trace_cleanup(void);
+int __ofono_trace_write(int fd);
+int __ofono_trace_save(const char *path);
+int __ofono_trace_dump_fd(void);
+int __ofono_trace_capture_start(const char *path);
+void __ofono_trace_capture_stop(void);
+
 #include <ofono/dbus.h>
 
 int __ofono_dbus_init(DBusConnection *conn);
 void __ofono_dbus_cleanup(void);
 
+typedef void (*ofono_dbus_peer_gone_cb_t)(const char *name);
+void __ofono_dbus_set_peer_gone_cb(ofono_dbus_peer_gone_cb_t cb);
+
 DBusMessage *__ofono_error_invalid_args(DBusMessage *msg);
 DBusMessage *__ofono_error_invalid_format(DBusMessage *msg);
 DBusMessage *__ofono_error_not_implemented(DBusMessage *msg);
@@ -79,6 +97,24 @@ DBusMessage *__ofono_error_from_error(const struct ofono_error *error,
 
 void __ofono_dbus_pending_reply(DBusMessage **msg, DBusMessage *reply);
 
+typedef void (*ofono_dbus_properties_func)(DBusMessageIter *dict, void *data);
+
+void __ofono_dbus_properties_register(const char *path,
+					const char *interface,
+					ofono_dbus_properties_func append,
+					void *data);
+void __ofono_dbus_properties_unregister(const char *path,
+					const char *interface);
+void __ofono_dbus_properties_invalidate(const char *path,
+					const char *interface);
+DBusMessage *__ofono_dbus_properties_reply(DBusMessage *msg,
+						const char *path,
+						const char *interface);
+DBusMessage *__ofono_dbus_snapshot_reply(DBusMessage *msg,
+						DBusMessage *snapshot);
+unsigned int __ofono_dbus_modems_serial(void);
+void __ofono_dbus_properties_stats(unsigned int *hits, unsigned int *misses);
+
 struct ofono_watchlist_item {
 	unsigned int id;
 	void *notify;
@@ -233,6 +269,18 @@ unsigned int __ofono_modemwatch_add(ofono_modemwatch_cb_t cb, void *user,
 					ofono_destroy_func destroy);
 gboolean __ofono_modemwatch_remove(unsigned int id);
 
+#include <ofono/devmon.h>
+
+typedef void (*ofono_devmon_muted_cb_t)(unsigned int muted, void *data);
+
+int __ofono_devmon_init(void);
+void __ofono_devmon_cleanup(void);
+unsigned int __ofono_devmon_add_watch(ofono_devmon_muted_cb_t cb,
+					void *data, ofono_destroy_func destroy);
+gboolean __ofono_devmon_remove_watch(unsigned int id);
+void __ofono_devmon_set_charging(ofono_bool_t value);
+void __ofono_devmon_set_battery_low(ofono_bool_t value);
+
 typedef void (*ofono_modem_online_notify_func)(struct ofono_modem *modem,
 						ofono_bool_t online,
 						void *data);
@@ -437,6 +485,9 @@ unsigned char *__ofono_sim_session_get_aid(
 
 const char *__ofono_sim_get_impi(struct ofono_sim *sim);
 
+void __ofono_sim_prefetch_icons(struct ofono_sim *sim,
+				const unsigned char *ids, unsigned int n);
+
 #include <ofono/stk.h>
 
 typedef void (*__ofono_sms_sim_download_cb_t)(ofono_bool_t ok,
@@ -676,6 +727,9 @@ void __ofono_voicecall_filter_chain_incoming(struct voicecall_filter_chain *c,
 gboolean __ofono_dbus_access_method_allowed(const char *sender,
 					enum ofono_dbus_access_intf iface,
 					int method, const char *arg);
+void __ofono_dbus_access_peer_gone(const char *sender);
+void __ofono_dbus_access_cache_stats(unsigned int *hits,
+						unsigned int *misses);
 
 #include <ofono/sim-mnclength.h>
 
@@ -687,4 +741,5 @@ int mnclength(int mcc, int mnc);
 #include <ofono/ims.h>
 
 void __ofono_set_config_dir(const char *dir);
+void __ofono_set_storage_dir(const char *dir);
 void config_merge_files(GKeyFile *conf, const char *file);
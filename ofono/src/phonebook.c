@@ -29,6 +29,8 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
 
 #include <glib.h>
 #include <gdbus.h>
@@ -36,11 +38,22 @@
 #include "ofono.h"
 
 #include "common.h"
+#include "simutil.h"
+#include "storage.h"
 
 #define LEN_MAX 128
 #define TYPE_INTERNATIONAL 145
 
 #define PHONEBOOK_FLAG_CACHED 0x1
+#define PHONEBOOK_FLAG_STALE 0x2
+#define PHONEBOOK_FLAG_FAILED 0x4
+#define PHONEBOOK_FLAG_STAMPED 0x8
+#define PHONEBOOK_FLAG_RESTAMP 0x10
+
+#define PHONEBOOK_CACHE_PATH "%s/%s/phonebook"
+#define PHONEBOOK_CACHE_MODE 0600
+
+#define PHONEBOOK_STREAM_CHUNK 16384
 
 static GSList *g_drivers = NULL;
 
@@ -54,10 +67,24 @@ enum phonebook_number_type {
 
 struct ofono_phonebook {
 	GSList *pending;
+	GSList *pending_streams; /* ImportFd calls waiting for the export */
+	GSList *streams; /* vCards being written to the client's fd */
 	int storage_index; /* go through all supported storage */
 	int flags;
 	GString *vcards; /* entries with vcard 3.0 format */
+	GBytes *cache; /* SM entries of the last complete export */
+	GBytes *loaded; /* SM entries from the disk, not yet revalidated */
+	guint32 loaded_stamp;
+	guint32 stamp; /* of the SM phonebook files as they are now */
+	int stamp_file; /* index of the file being read, -1 when idle */
+	gsize sm_len; /* length of the SM part of vcards */
+	char *iccid;
+	unsigned int iccid_watch;
+	struct ofono_sim *sim;
 	GSList *merge_list; /* cache the entries that may need a merge */
+	GHashTable *merge_table; /* merge_list entries by name */
+	char *imsi;
+	struct ofono_sim_context *sim_context;
 	const struct ofono_phonebook_driver *driver;
 	void *driver_data;
 	struct ofono_atom *atom;
@@ -78,6 +105,26 @@ struct phonebook_person {
 	char *sip_uri;
 };
 
+struct phonebook_stream {
+	struct ofono_phonebook *pb;
+	DBusMessage *msg;
+	int fd;
+	guint watch;
+	GBytes *data;
+	gsize offset;
+};
+
+/*
+ * SIM files the exported SM entries depend on.  USIM phonebooks keep
+ * their ADN, ANR, EMAIL and SNE files under DFphonebook at locations
+ * only EFpbr knows, so there is nothing to watch and they aren't cached.
+ */
+static const int phonebook_sim_files[] = {
+	SIM_EFADN_FILEID,
+	SIM_EFEXT1_FILEID,
+};
+
+/* Only the SIM storage, the first one, is ever cached */
 static const char *storage_support[] = { "SM", "ME", NULL };
 static void export_phonebook(struct ofono_phonebook *pb);
 
@@ -276,18 +323,19 @@ static void destroy_merged_entry(gpointer pointer)
 	g_free(person);
 }
 
-static DBusMessage *generate_export_entries_reply(struct ofono_phonebook *pb,
+static DBusMessage *generate_export_entries_reply(GBytes *vcards,
 							DBusMessage *msg)
 {
 	DBusMessage *reply;
 	DBusMessageIter iter;
+	const char *str = g_bytes_get_data(vcards, NULL);
 
 	reply = dbus_message_new_method_return(msg);
 	if (reply == NULL)
 		return NULL;
 
 	dbus_message_iter_init_append(reply, &iter);
-	dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, pb->vcards);
+	dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &str);
 
 	return reply;
 }
@@ -369,23 +417,21 @@ void ofono_phonebook_entry(struct ofono_phonebook *phonebook, int index,
 	 * are deemed as entries of one person.
 	 */
 	if (need_merge(text)) {
-		GSList *l;
 		size_t len_text = strlen(text) - 2;
+		char *name = g_strndup(text, len_text);
 		struct phonebook_person *person;
 
-		for (l = phonebook->merge_list; l; l = l->next) {
-			person = l->data;
-			if (!strncmp(text, person->text, len_text) &&
-					(strlen(person->text) == len_text))
-				break;
-		}
+		person = g_hash_table_lookup(phonebook->merge_table, name);
 
-		if (l == NULL) {
+		if (person == NULL) {
 			person = g_new0(struct phonebook_person, 1);
 			phonebook->merge_list =
 				g_slist_prepend(phonebook->merge_list, person);
-			person->text = g_strndup(text, len_text);
-		}
+			person->text = name;
+			g_hash_table_insert(phonebook->merge_table,
+						person->text, person);
+		} else
+			g_free(name);
 
 		merge_field_number(&(person->number_list), number, type,
 					text[len_text + 1]);
@@ -419,17 +465,23 @@ static void export_phonebook_cb(const struct ofono_error *error, void *data)
 {
 	struct ofono_phonebook *phonebook = data;
 
-	if (error->type != OFONO_ERROR_TYPE_NO_ERROR)
+	if (error->type != OFONO_ERROR_TYPE_NO_ERROR) {
 		ofono_error("export_entries_one_storage_cb with %s failed",
 				storage_support[phonebook->storage_index]);
+		phonebook->flags |= PHONEBOOK_FLAG_FAILED;
+	}
 
 	/* convert the collected entries that are already merged to vcard */
 	phonebook->merge_list = g_slist_reverse(phonebook->merge_list);
 	g_slist_foreach(phonebook->merge_list, print_merged_entry,
 				phonebook->vcards);
+	g_hash_table_remove_all(phonebook->merge_table);
 	g_slist_free_full(phonebook->merge_list, destroy_merged_entry);
 	phonebook->merge_list = NULL;
 
+	if (phonebook->storage_index == 0)
+		phonebook->sm_len = phonebook->vcards->len;
+
 	phonebook->storage_index++;
 	export_phonebook(phonebook);
 	return;
@@ -438,8 +490,8 @@ static void export_phonebook_cb(const struct ofono_error *error, void *data)
 static void phonebook_reply(gpointer data, gpointer user_data)
 {
 	DBusMessage *msg = data;
-	struct ofono_phonebook *phonebook = user_data;
-	DBusMessage *reply = generate_export_entries_reply(phonebook, msg);
+	GBytes *vcards = user_data;
+	DBusMessage *reply = generate_export_entries_reply(vcards, msg);
 
 	__ofono_dbus_pending_reply(&msg, reply);
 }
@@ -451,6 +503,334 @@ static void phonebook_cancel(gpointer data)
 	__ofono_dbus_pending_reply(&msg, __ofono_error_canceled(msg));
 }
 
+static void phonebook_stream_free(gpointer data)
+{
+	struct phonebook_stream *stream = data;
+
+	if (stream->msg)
+		__ofono_dbus_pending_reply(&stream->msg,
+					__ofono_error_canceled(stream->msg));
+
+	if (stream->data)
+		g_bytes_unref(stream->data);
+
+	close(stream->fd);
+	g_free(stream);
+}
+
+static void phonebook_stream_destroy(gpointer data)
+{
+	struct phonebook_stream *stream = data;
+	struct ofono_phonebook *pb = stream->pb;
+
+	pb->streams = g_slist_remove(pb->streams, stream);
+	phonebook_stream_free(stream);
+}
+
+static gboolean phonebook_stream_write(GIOChannel *io, GIOCondition cond,
+							gpointer user_data)
+{
+	struct phonebook_stream *stream = user_data;
+	gsize size;
+	const char *data = g_bytes_get_data(stream->data, &size);
+	ssize_t written;
+
+	if (cond & (G_IO_ERR | G_IO_HUP | G_IO_NVAL))
+		goto done;
+
+	written = write(stream->fd, data + stream->offset,
+			MIN(size - stream->offset, PHONEBOOK_STREAM_CHUNK));
+
+	if (written < 0) {
+		if (errno == EAGAIN || errno == EINTR)
+			return TRUE;
+
+		DBG("write failed: %s", strerror(errno));
+		goto done;
+	}
+
+	stream->offset += written;
+
+	if (stream->offset < size)
+		return TRUE;
+
+done:
+	stream->watch = 0;
+	return FALSE;
+}
+
+static void phonebook_stream_start(gpointer data, gpointer user_data)
+{
+	struct phonebook_stream *stream = data;
+	struct ofono_phonebook *pb = stream->pb;
+	DBusMessage *reply = dbus_message_new_method_return(stream->msg);
+	GIOChannel *io;
+
+	__ofono_dbus_pending_reply(&stream->msg, reply);
+
+	stream->data = g_bytes_ref(user_data);
+
+	io = g_io_channel_unix_new(stream->fd);
+	stream->watch = g_io_add_watch_full(io, G_PRIORITY_DEFAULT,
+				G_IO_OUT | G_IO_ERR | G_IO_HUP | G_IO_NVAL,
+				phonebook_stream_write, stream,
+				phonebook_stream_destroy);
+	g_io_channel_unref(io);
+
+	pb->streams = g_slist_prepend(pb->streams, stream);
+}
+
+/*
+ * The cache on the disk holds the SM entries only, after a header with
+ * the ICCID of the card and a stamp of the contents of EFadn and EFext1.
+ * It is used only once the stamp has been checked against the card.
+ */
+static const int phonebook_stamp_files[] = {
+	SIM_EFADN_FILEID,
+	SIM_EFEXT1_FILEID,
+};
+
+/* The SM entries are cached only while the SIM files are watched */
+static gboolean phonebook_cacheable(struct ofono_phonebook *pb)
+{
+	return pb->sim_context &&
+		ofono_sim_get_phase(pb->sim) != OFONO_SIM_PHASE_3G;
+}
+
+static gboolean phonebook_persistent(struct ofono_phonebook *pb)
+{
+	return pb->imsi && pb->iccid && phonebook_cacheable(pb);
+}
+
+static void phonebook_cache_load(struct ofono_phonebook *pb)
+{
+	char *path = g_strdup_printf(PHONEBOOK_CACHE_PATH,
+					ofono_storage_dir(), pb->imsi);
+	char *contents;
+	char *body;
+	char **header = NULL;
+	gsize len;
+
+	if (!g_file_get_contents(path, &contents, &len, NULL))
+		goto out;
+
+	body = memchr(contents, '\n', len);
+
+	if (body) {
+		*body++ = '\0';
+		header = g_strsplit(contents, " ", 2);
+	}
+
+	if (header && g_strv_length(header) == 2 &&
+			!g_strcmp0(header[0], pb->iccid) &&
+			g_utf8_validate(body, contents + len - body, NULL)) {
+		DBG("%s: %" G_GSIZE_FORMAT " bytes", path, len);
+		pb->loaded = g_bytes_new(body, contents + len - body);
+		pb->loaded_stamp = strtoul(header[1], NULL, 16);
+	} else {
+		unlink(path);
+	}
+
+	g_strfreev(header);
+	g_free(contents);
+
+out:
+	g_free(path);
+}
+
+static void phonebook_cache_store(struct ofono_phonebook *pb)
+{
+	gsize len;
+	const char *data = g_bytes_get_data(pb->cache, &len);
+	char *header;
+	GString *buf;
+
+	if (!phonebook_persistent(pb))
+		return;
+
+	header = g_strdup_printf("%s %08x\n", pb->iccid, pb->stamp);
+	buf = g_string_new(header);
+	g_string_append_len(buf, data, len);
+
+	if (write_file((unsigned char *) buf->str, buf->len,
+				PHONEBOOK_CACHE_MODE, PHONEBOOK_CACHE_PATH,
+				ofono_storage_dir(), pb->imsi) < 0)
+		ofono_error("Failed to store the phonebook cache");
+
+	g_string_free(buf, TRUE);
+	g_free(header);
+}
+
+static void phonebook_cache_drop(struct ofono_phonebook *pb)
+{
+	char *path;
+
+	pb->flags &= ~PHONEBOOK_FLAG_CACHED;
+
+	if (pb->cache) {
+		g_bytes_unref(pb->cache);
+		pb->cache = NULL;
+	}
+
+	if (pb->loaded) {
+		g_bytes_unref(pb->loaded);
+		pb->loaded = NULL;
+	}
+
+	if (pb->imsi == NULL)
+		return;
+
+	path = g_strdup_printf(PHONEBOOK_CACHE_PATH, ofono_storage_dir(),
+								pb->imsi);
+	unlink(path);
+	g_free(path);
+}
+
+static void phonebook_stamp_done(struct ofono_phonebook *pb)
+{
+	DBG("%08x", pb->stamp);
+
+	pb->flags |= PHONEBOOK_FLAG_STAMPED;
+
+	/* An export finished while the files were being read */
+	if (pb->flags & PHONEBOOK_FLAG_CACHED) {
+		phonebook_cache_store(pb);
+		return;
+	}
+
+	if (pb->loaded == NULL)
+		return;
+
+	if (pb->loaded_stamp == pb->stamp) {
+		pb->cache = pb->loaded;
+		pb->loaded = NULL;
+		pb->flags |= PHONEBOOK_FLAG_CACHED;
+	} else {
+		DBG("SIM phonebook changed since it was cached");
+		phonebook_cache_drop(pb);
+	}
+}
+
+static void phonebook_stamp_next(struct ofono_phonebook *pb);
+
+static void phonebook_stamp_read_cb(int ok, int total_length, int record,
+					const unsigned char *data,
+					int record_length, void *userdata)
+{
+	struct ofono_phonebook *pb = userdata;
+	int id = phonebook_stamp_files[pb->stamp_file];
+	int i;
+
+	if (ok) {
+		/* FNV-1a */
+		for (i = 0; i < record_length; i++)
+			pb->stamp = (pb->stamp ^ data[i]) * 16777619;
+
+		if (record_length && record < total_length / record_length)
+			return;
+	} else if (id == SIM_EFADN_FILEID &&
+			!(pb->flags & PHONEBOOK_FLAG_RESTAMP)) {
+		/* Nothing to check the cache against */
+		pb->stamp_file = -1;
+		phonebook_cache_drop(pb);
+		return;
+	} else {
+		pb->stamp = (pb->stamp ^ id) * 16777619;
+	}
+
+	pb->stamp_file++;
+	phonebook_stamp_next(pb);
+}
+
+static void phonebook_stamp_next(struct ofono_phonebook *pb)
+{
+	if (pb->flags & PHONEBOOK_FLAG_RESTAMP) {
+		pb->flags &= ~PHONEBOOK_FLAG_RESTAMP;
+		pb->stamp_file = 0;
+		pb->stamp = 2166136261U;
+	}
+
+	if (pb->stamp_file == (int) G_N_ELEMENTS(phonebook_stamp_files)) {
+		pb->stamp_file = -1;
+		phonebook_stamp_done(pb);
+		return;
+	}
+
+	if (ofono_sim_read(pb->sim_context,
+				phonebook_stamp_files[pb->stamp_file],
+				OFONO_SIM_FILE_STRUCTURE_FIXED,
+				phonebook_stamp_read_cb, pb) < 0) {
+		pb->stamp_file = -1;
+		phonebook_cache_drop(pb);
+	}
+}
+
+static void phonebook_stamp_start(struct ofono_phonebook *pb)
+{
+	pb->flags &= ~PHONEBOOK_FLAG_STAMPED;
+
+	if (!phonebook_persistent(pb))
+		return;
+
+	pb->flags |= PHONEBOOK_FLAG_RESTAMP;
+
+	/* Otherwise it starts over once the read in progress is done */
+	if (pb->stamp_file < 0)
+		phonebook_stamp_next(pb);
+}
+
+static void phonebook_sim_file_changed(int id, void *userdata)
+{
+	struct ofono_phonebook *pb = userdata;
+
+	DBG("%04x", id);
+
+	phonebook_cache_drop(pb);
+	phonebook_stamp_start(pb);
+
+	/* An export in progress may have read the old contents */
+	if (pb->pending || pb->pending_streams)
+		pb->flags |= PHONEBOOK_FLAG_STALE;
+}
+
+static void export_phonebook_done(struct ofono_phonebook *phonebook)
+{
+	gsize len = phonebook->vcards->len;
+	GBytes *vcards;
+
+	/* Only a complete export of up to date files is worth keeping */
+	if (phonebook_cacheable(phonebook) &&
+			!(phonebook->flags & (PHONEBOOK_FLAG_CACHED |
+						PHONEBOOK_FLAG_STALE |
+						PHONEBOOK_FLAG_FAILED))) {
+		if (phonebook->loaded) {
+			g_bytes_unref(phonebook->loaded);
+			phonebook->loaded = NULL;
+		}
+
+		phonebook->cache = g_bytes_new(phonebook->vcards->str,
+							phonebook->sm_len);
+		phonebook->flags |= PHONEBOOK_FLAG_CACHED;
+
+		if (phonebook->flags & PHONEBOOK_FLAG_STAMPED)
+			phonebook_cache_store(phonebook);
+	}
+
+	vcards = g_bytes_new_take(g_string_free(phonebook->vcards, FALSE), len);
+	phonebook->vcards = NULL;
+
+	g_slist_foreach(phonebook->pending, phonebook_reply, vcards);
+	g_slist_free(phonebook->pending);
+	phonebook->pending = NULL;
+
+	g_slist_foreach(phonebook->pending_streams, phonebook_stream_start,
+				vcards);
+	g_slist_free(phonebook->pending_streams);
+	phonebook->pending_streams = NULL;
+
+	g_bytes_unref(vcards);
+}
+
 static void export_phonebook(struct ofono_phonebook *phonebook)
 {
 	const char *pb = storage_support[phonebook->storage_index];
@@ -461,35 +841,74 @@ static void export_phonebook(struct ofono_phonebook *phonebook)
 		return;
 	}
 
-	g_slist_foreach(phonebook->pending, phonebook_reply, phonebook);
-	g_slist_free(phonebook->pending);
-	phonebook->pending = NULL;
-	phonebook->flags |= PHONEBOOK_FLAG_CACHED;
+	export_phonebook_done(phonebook);
 }
 
-static DBusMessage *import_entries(DBusConnection *conn, DBusMessage *msg,
-					void *data)
+static void export_phonebook_start(struct ofono_phonebook *phonebook)
 {
-	struct ofono_phonebook *phonebook = data;
-	DBusMessage *reply;
+	/* Already running? */
+	if (phonebook->vcards)
+		return;
+
+	phonebook->flags &= ~(PHONEBOOK_FLAG_STALE | PHONEBOOK_FLAG_FAILED);
 
+	/* The ME storage is always read, it has no change notifications */
 	if (phonebook->flags & PHONEBOOK_FLAG_CACHED) {
-		reply = generate_export_entries_reply(phonebook, msg);
-		g_dbus_send_message(conn, reply);
-		return NULL;
-	}
+		gsize len;
+		const char *data = g_bytes_get_data(phonebook->cache, &len);
 
-	if (phonebook->pending) {
-		phonebook->pending = g_slist_append(phonebook->pending,
-							dbus_message_ref(msg));
+		phonebook->vcards = g_string_new_len(data, len);
+		phonebook->sm_len = len;
+		phonebook->storage_index = 1;
 	} else {
-		phonebook->pending = g_slist_append(NULL,
-							dbus_message_ref(msg));
-		g_string_set_size(phonebook->vcards, 0);
+		phonebook->vcards = g_string_new(NULL);
+		phonebook->sm_len = 0;
 		phonebook->storage_index = 0;
-		export_phonebook(phonebook);
 	}
 
+	export_phonebook(phonebook);
+}
+
+static DBusMessage *import_entries(DBusConnection *conn, DBusMessage *msg,
+					void *data)
+{
+	struct ofono_phonebook *phonebook = data;
+
+	phonebook->pending = g_slist_append(phonebook->pending,
+						dbus_message_ref(msg));
+	export_phonebook_start(phonebook);
+
+	return NULL;
+}
+
+static DBusMessage *import_entries_fd(DBusConnection *conn, DBusMessage *msg,
+					void *data)
+{
+	struct ofono_phonebook *phonebook = data;
+	struct phonebook_stream *stream;
+	int fd;
+
+	if (!dbus_connection_can_send_type(conn, DBUS_TYPE_UNIX_FD))
+		return __ofono_error_not_supported(msg);
+
+	if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_UNIX_FD, &fd,
+					DBUS_TYPE_INVALID))
+		return __ofono_error_invalid_args(msg);
+
+	if (fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) {
+		close(fd);
+		return __ofono_error_invalid_args(msg);
+	}
+
+	stream = g_new0(struct phonebook_stream, 1);
+	stream->pb = phonebook;
+	stream->fd = fd;
+	stream->msg = dbus_message_ref(msg);
+
+	phonebook->pending_streams = g_slist_append(phonebook->pending_streams,
+							stream);
+	export_phonebook_start(phonebook);
+
 	return NULL;
 }
 
@@ -497,6 +916,9 @@ static const GDBusMethodTable phonebook_methods[] = {
 	{ GDBUS_ASYNC_METHOD("Import",
 			NULL, GDBUS_ARGS({ "entries", "s" }),
 			import_entries) },
+	{ GDBUS_ASYNC_METHOD("ImportFd",
+			GDBUS_ARGS({ "fd", "h" }), NULL,
+			import_entries_fd) },
 	{ }
 };
 
@@ -535,6 +957,28 @@ static void phonebook_unregister(struct ofono_atom *atom)
 		pb->pending = NULL;
 	}
 
+	if (pb->pending_streams) {
+		g_slist_free_full(pb->pending_streams, phonebook_stream_free);
+		pb->pending_streams = NULL;
+	}
+
+	/* Removing the watch frees the stream */
+	while (pb->streams) {
+		struct phonebook_stream *stream = pb->streams->data;
+
+		g_source_remove(stream->watch);
+	}
+
+	if (pb->sim_context) {
+		ofono_sim_context_free(pb->sim_context);
+		pb->sim_context = NULL;
+	}
+
+	if (pb->iccid_watch) {
+		ofono_sim_remove_iccid_watch(pb->sim, pb->iccid_watch);
+		pb->iccid_watch = 0;
+	}
+
 	ofono_modem_remove_interface(modem, OFONO_PHONEBOOK_INTERFACE);
 	g_dbus_unregister_interface(conn, path, OFONO_PHONEBOOK_INTERFACE);
 }
@@ -551,7 +995,18 @@ static void phonebook_remove(struct ofono_atom *atom)
 	if (pb->driver && pb->driver->remove)
 		pb->driver->remove(pb);
 
-	g_string_free(pb->vcards, TRUE);
+	if (pb->vcards)
+		g_string_free(pb->vcards, TRUE);
+
+	if (pb->cache)
+		g_bytes_unref(pb->cache);
+
+	if (pb->loaded)
+		g_bytes_unref(pb->loaded);
+
+	g_hash_table_destroy(pb->merge_table);
+	g_free(pb->iccid);
+	g_free(pb->imsi);
 	g_free(pb);
 }
 
@@ -570,7 +1025,8 @@ struct ofono_phonebook *ofono_phonebook_create(struct ofono_modem *modem,
 	if (pb == NULL)
 		return NULL;
 
-	pb->vcards = g_string_new(NULL);
+	pb->merge_table = g_hash_table_new(g_str_hash, g_str_equal);
+	pb->stamp_file = -1;
 	pb->atom = __ofono_modem_add_atom(modem, OFONO_ATOM_TYPE_PHONEBOOK,
 						phonebook_remove, pb);
 
@@ -590,11 +1046,21 @@ struct ofono_phonebook *ofono_phonebook_create(struct ofono_modem *modem,
 	return pb;
 }
 
+static void phonebook_iccid_changed(const char *iccid, void *data)
+{
+	struct ofono_phonebook *pb = data;
+
+	g_free(pb->iccid);
+	pb->iccid = g_strdup(iccid);
+}
+
 void ofono_phonebook_register(struct ofono_phonebook *pb)
 {
 	DBusConnection *conn = ofono_dbus_get_connection();
 	const char *path = __ofono_atom_get_path(pb->atom);
 	struct ofono_modem *modem = __ofono_atom_get_modem(pb->atom);
+	struct ofono_sim *sim = __ofono_atom_find(OFONO_ATOM_TYPE_SIM, modem);
+	unsigned int i;
 
 	if (!g_dbus_register_interface(conn, path, OFONO_PHONEBOOK_INTERFACE,
 					phonebook_methods, phonebook_signals,
@@ -607,6 +1073,30 @@ void ofono_phonebook_register(struct ofono_phonebook *pb)
 
 	ofono_modem_add_interface(modem, OFONO_PHONEBOOK_INTERFACE);
 
+	/*
+	 * The SM entries are kept per IMSI until the SIM tells us that one
+	 * of the phonebook files has changed.
+	 */
+	if (sim && ofono_sim_get_imsi(sim)) {
+		pb->sim = sim;
+		pb->imsi = g_strdup(ofono_sim_get_imsi(sim));
+		pb->sim_context = ofono_sim_context_create(sim);
+		pb->iccid_watch = ofono_sim_add_iccid_watch(sim,
+						phonebook_iccid_changed,
+						pb, NULL);
+
+		for (i = 0; i < G_N_ELEMENTS(phonebook_sim_files); i++)
+			ofono_sim_add_file_watch(pb->sim_context,
+						phonebook_sim_files[i],
+						phonebook_sim_file_changed,
+						pb, NULL);
+
+		if (phonebook_persistent(pb)) {
+			phonebook_cache_load(pb);
+			phonebook_stamp_start(pb);
+		}
+	}
+
 	__ofono_atom_register(pb->atom, phonebook_unregister);
 }
 
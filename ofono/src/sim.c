@@ -125,6 +125,12 @@ struct ofono_sim {
 
 	unsigned char *iidf_image;
 	unsigned int *iidf_watch_ids;
+	GHashTable *icons;
+	GSList *icon_queue;
+	GSList *icon_requests;
+	unsigned char icon_loading;
+	bool icon_discard;
+	GSList *file_reads;
 
 	DBusMessage *pending;
 	const struct ofono_sim_driver *driver;
@@ -460,13 +466,9 @@ void ofono_sim_remove_imsi_watch(struct ofono_sim *sim, unsigned int id)
 	__ofono_watchlist_remove_item(sim->imsi_watches, id);
 }
 
-static DBusMessage *sim_get_properties(DBusConnection *conn,
-					DBusMessage *msg, void *data)
+static void sim_append_properties(DBusMessageIter *dict, void *data)
 {
 	struct ofono_sim *sim = data;
-	DBusMessage *reply;
-	DBusMessageIter iter;
-	DBusMessageIter dict;
 	char **own_numbers;
 	char **service_numbers;
 	char **locked_pins;
@@ -477,94 +479,96 @@ static DBusMessage *sim_get_properties(DBusConnection *conn,
 	dbus_bool_t fdn;
 	dbus_bool_t bdn;
 
-	reply = dbus_message_new_method_return(msg);
-	if (reply == NULL)
-		return NULL;
-
-	dbus_message_iter_init_append(reply, &iter);
-
-	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-					OFONO_PROPERTIES_ARRAY_SIGNATURE,
-					&dict);
-
-	ofono_dbus_dict_append(&dict, "Present", DBUS_TYPE_BOOLEAN, &present);
+	ofono_dbus_dict_append(dict, "Present", DBUS_TYPE_BOOLEAN, &present);
 
 	if (!present)
-		goto done;
+		return;
 
 	if (sim->iccid)
-		ofono_dbus_dict_append(&dict, "CardIdentifier",
+		ofono_dbus_dict_append(dict, "CardIdentifier",
 					DBUS_TYPE_STRING, &sim->iccid);
 
 	if (sim->imsi)
-		ofono_dbus_dict_append(&dict, "SubscriberIdentity",
+		ofono_dbus_dict_append(dict, "SubscriberIdentity",
 					DBUS_TYPE_STRING, &sim->imsi);
 
 	if (sim->spn)
-		ofono_dbus_dict_append(&dict, "ServiceProviderName",
+		ofono_dbus_dict_append(dict, "ServiceProviderName",
 					DBUS_TYPE_STRING, &sim->spn);
 
 	if (sim->impi)
-		ofono_dbus_dict_append(&dict, "ImsPrivateIdentity",
+		ofono_dbus_dict_append(dict, "ImsPrivateIdentity",
 					DBUS_TYPE_STRING, &sim->impi);
 
 	fdn = sim->fixed_dialing;
-	ofono_dbus_dict_append(&dict, "FixedDialing", DBUS_TYPE_BOOLEAN, &fdn);
+	ofono_dbus_dict_append(dict, "FixedDialing", DBUS_TYPE_BOOLEAN, &fdn);
 
 	bdn = sim->barred_dialing;
-	ofono_dbus_dict_append(&dict, "BarredDialing", DBUS_TYPE_BOOLEAN, &bdn);
+	ofono_dbus_dict_append(dict, "BarredDialing", DBUS_TYPE_BOOLEAN, &bdn);
 
 	if (sim->mcc[0] != '\0' && sim->mnc[0] != '\0') {
 		const char *str;
 		str = sim->mcc;
-		ofono_dbus_dict_append(&dict, "MobileCountryCode",
+		ofono_dbus_dict_append(dict, "MobileCountryCode",
 					DBUS_TYPE_STRING, &str);
 
 		str = sim->mnc;
-		ofono_dbus_dict_append(&dict, "MobileNetworkCode",
+		ofono_dbus_dict_append(dict, "MobileNetworkCode",
 					DBUS_TYPE_STRING, &str);
 	}
 
 	own_numbers = get_own_numbers(sim->own_numbers);
 
-	ofono_dbus_dict_append_array(&dict, "SubscriberNumbers",
+	ofono_dbus_dict_append_array(dict, "SubscriberNumbers",
 					DBUS_TYPE_STRING, &own_numbers);
 	g_strfreev(own_numbers);
 
 	locked_pins = get_locked_pins(sim);
-	ofono_dbus_dict_append_array(&dict, "LockedPins",
+	ofono_dbus_dict_append_array(dict, "LockedPins",
 					DBUS_TYPE_STRING, &locked_pins);
 	g_strfreev(locked_pins);
 
 	if (sim->service_numbers && sim->sdn_ready) {
 		service_numbers = get_service_numbers(sim->service_numbers);
 
-		ofono_dbus_dict_append_dict(&dict, "ServiceNumbers",
+		ofono_dbus_dict_append_dict(dict, "ServiceNumbers",
 						DBUS_TYPE_STRING,
 						&service_numbers);
 		g_strfreev(service_numbers);
 	}
 
 	if (sim->language_prefs)
-		ofono_dbus_dict_append_array(&dict, "PreferredLanguages",
+		ofono_dbus_dict_append_array(dict, "PreferredLanguages",
 						DBUS_TYPE_STRING,
 						&sim->language_prefs);
 
 	pin_name = sim_passwd_name(sim->pin_type);
-	ofono_dbus_dict_append(&dict, "PinRequired",
+	ofono_dbus_dict_append(dict, "PinRequired",
 				DBUS_TYPE_STRING,
 				(void *) &pin_name);
 
 	get_pin_retries(sim, &pin_retries_dict, &dbus_retries);
-	ofono_dbus_dict_append_dict(&dict, "Retries", DBUS_TYPE_BYTE,
+	ofono_dbus_dict_append_dict(dict, "Retries", DBUS_TYPE_BYTE,
 							&pin_retries_dict);
 	g_free(pin_retries_dict);
 	g_free(dbus_retries);
+}
 
-done:
-	dbus_message_iter_close_container(&iter, &dict);
+static DBusMessage *sim_get_properties(DBusConnection *conn,
+					DBusMessage *msg, void *data)
+{
+	struct ofono_sim *sim = data;
 
-	return reply;
+	return __ofono_dbus_properties_reply(msg,
+					__ofono_atom_get_path(sim->atom),
+					OFONO_SIM_MANAGER_INTERFACE);
+}
+
+/* For state that is dropped without a PropertyChanged signal */
+static void sim_properties_invalidate(struct ofono_sim *sim)
+{
+	__ofono_dbus_properties_invalidate(__ofono_atom_get_path(sim->atom),
+						OFONO_SIM_MANAGER_INTERFACE);
 }
 
 static void sim_pin_retries_query_cb(const struct ofono_error *error,
@@ -1012,37 +1016,194 @@ static DBusMessage *sim_enter_pin(DBusConnection *conn, DBusMessage *msg,
 	return NULL;
 }
 
-static void sim_get_image_cb(struct ofono_sim *sim,
-				unsigned char id, char *xpm, gboolean cache)
+/*
+ * Rendered icons stay in memory while the SIM is in use, in front of the
+ * XPM cache on disk.  The RGBA pixels are rendered only when the image is
+ * read from the SIM, since the disk cache keeps the XPM form only.
+ */
+struct sim_icon {
+	char *xpm;
+	unsigned char *rgba;
+	unsigned int width;
+	unsigned int height;
+};
+
+static void sim_icon_free(gpointer data)
 {
-	DBusMessage *reply;
-	DBusMessageIter iter, array;
-	int xpm_len;
+	struct sim_icon *icon = data;
 
-	if (xpm == NULL) {
-		reply = __ofono_error_failed(sim->pending);
-		__ofono_dbus_pending_reply(&sim->pending, reply);
-		return;
+	g_free(icon->xpm);
+	g_free(icon->rgba);
+	g_free(icon);
+}
+
+/* Icon ids are the EFimg record numbers, starting from 1 */
+static struct sim_icon *sim_icon_lookup(struct ofono_sim *sim,
+						unsigned char id)
+{
+	if (sim->icons == NULL)
+		return NULL;
+
+	return g_hash_table_lookup(sim->icons, GUINT_TO_POINTER(id));
+}
+
+static struct sim_icon *sim_icon_get(struct ofono_sim *sim, unsigned char id)
+{
+	struct sim_icon *icon;
+
+	if (sim->icons == NULL)
+		sim->icons = g_hash_table_new_full(g_direct_hash,
+							g_direct_equal, NULL,
+							sim_icon_free);
+
+	icon = g_hash_table_lookup(sim->icons, GUINT_TO_POINTER(id));
+	if (icon == NULL) {
+		icon = g_new0(struct sim_icon, 1);
+		g_hash_table_insert(sim->icons, GUINT_TO_POINTER(id), icon);
 	}
 
-	xpm_len = strlen(xpm);
+	return icon;
+}
 
-	reply = dbus_message_new_method_return(sim->pending);
+static gboolean sim_icon_ready(const struct sim_icon *icon, gboolean rgba)
+{
+	if (icon == NULL)
+		return FALSE;
+
+	return rgba ? icon->rgba != NULL : icon->xpm != NULL;
+}
+
+static gboolean sim_icon_request_rgba(DBusMessage *msg)
+{
+	return dbus_message_is_method_call(msg, OFONO_SIM_MANAGER_INTERFACE,
+						"GetIconRGBA");
+}
+
+static unsigned char sim_icon_request_id(DBusMessage *msg)
+{
+	unsigned char id = 0;
+
+	dbus_message_get_args(msg, NULL, DBUS_TYPE_BYTE, &id,
+					DBUS_TYPE_INVALID);
+
+	return id;
+}
+
+static DBusMessage *sim_icon_reply(DBusMessage *msg,
+					const struct sim_icon *icon)
+{
+	DBusMessage *reply;
+	DBusMessageIter iter, array;
+	const unsigned char *data;
+	int len;
+
+	reply = dbus_message_new_method_return(msg);
 	dbus_message_iter_init_append(reply, &iter);
 
+	if (sim_icon_request_rgba(msg)) {
+		dbus_uint16_t width = icon->width;
+		dbus_uint16_t height = icon->height;
+
+		dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT16,
+								&width);
+		dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT16,
+								&height);
+		data = icon->rgba;
+		len = icon->width * icon->height * 4;
+	} else {
+		data = (const unsigned char *) icon->xpm;
+		len = strlen(icon->xpm);
+	}
+
 	dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
 					DBUS_TYPE_BYTE_AS_STRING, &array);
-
 	dbus_message_iter_append_fixed_array(&array, DBUS_TYPE_BYTE,
-						&xpm, xpm_len);
+						&data, len);
 	dbus_message_iter_close_container(&iter, &array);
 
-	__ofono_dbus_pending_reply(&sim->pending, reply);
+	return reply;
+}
 
-	if (cache)
-		sim_fs_cache_image(sim->simfs, (const char *) xpm, id);
+/* Answers everyone waiting for the icon, with Failed if it's not there */
+static void sim_icon_requests_done(struct ofono_sim *sim, unsigned char id)
+{
+	struct sim_icon *icon = sim_icon_lookup(sim, id);
+	GSList *l = sim->icon_requests;
 
-	g_free(xpm);
+	while (l) {
+		GSList *next = l->next;
+		DBusMessage *msg = l->data;
+		DBusMessage *reply;
+
+		if (id == 0 || sim_icon_request_id(msg) == id) {
+			if (sim_icon_ready(icon, sim_icon_request_rgba(msg)))
+				reply = sim_icon_reply(msg, icon);
+			else
+				reply = __ofono_error_failed(msg);
+
+			sim->icon_requests =
+				g_slist_delete_link(sim->icon_requests, l);
+			__ofono_dbus_pending_reply(&msg, reply);
+		}
+
+		l = next;
+	}
+}
+
+static gboolean sim_icon_rgba_wanted(struct ofono_sim *sim, unsigned char id)
+{
+	GSList *l;
+
+	for (l = sim->icon_requests; l; l = l->next) {
+		DBusMessage *msg = l->data;
+
+		if (sim_icon_request_id(msg) == id &&
+				sim_icon_request_rgba(msg))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void sim_icon_load_next(struct ofono_sim *sim);
+
+static void sim_icon_loaded(struct ofono_sim *sim,
+				const unsigned char *data, unsigned int length,
+				const unsigned char *clut,
+				unsigned short clut_len)
+{
+	unsigned char id = sim->icon_loading;
+	unsigned char *efimg;
+	struct sim_icon *icon;
+	char *xpm;
+
+	sim->icon_loading = 0;
+
+	/* EFimg or the image file changed while we were reading it */
+	if (sim->icon_discard) {
+		sim->icon_discard = false;
+		data = NULL;
+	}
+
+	if (data != NULL) {
+		efimg = &sim->efimg[(id - 1) * 9];
+		icon = sim_icon_get(sim, id);
+
+		xpm = stk_image_to_xpm(data, length, efimg[2], clut, clut_len);
+		if (xpm != NULL) {
+			g_free(icon->xpm);
+			icon->xpm = xpm;
+			sim_fs_cache_image(sim->simfs, xpm, id - 1);
+		}
+
+		g_free(icon->rgba);
+		icon->rgba = stk_image_to_rgba(data, length, efimg[2],
+						clut, clut_len,
+						&icon->width, &icon->height);
+	}
+
+	sim_icon_requests_done(sim, id);
+	sim_icon_load_next(sim);
 }
 
 static void sim_iidf_read_clut_cb(int ok, int length, int record,
@@ -1050,24 +1211,18 @@ static void sim_iidf_read_clut_cb(int ok, int length, int record,
 					int record_length, void *userdata)
 {
 	struct ofono_sim *sim = userdata;
-	unsigned char id;
 	unsigned char *efimg;
 	unsigned short iidf_len;
 	unsigned short clut_len;
-	char *xpm;
 
 	DBG("ok: %d", ok);
 
-	dbus_message_get_args(sim->pending, NULL, DBUS_TYPE_BYTE, &id,
-					DBUS_TYPE_INVALID);
-	id -= 1;
-	efimg = &sim->efimg[id * 9];
-
-	if (!ok) {
-		sim_get_image_cb(sim, id, NULL, FALSE);
+	if (!ok || sim->icon_discard) {
+		sim_icon_loaded(sim, NULL, 0, NULL, 0);
 		goto done;
 	}
 
+	efimg = &sim->efimg[(sim->icon_loading - 1) * 9];
 	iidf_len = efimg[7] << 8 | efimg[8];
 
 	if (sim->iidf_image[3] == 0)
@@ -1075,9 +1230,7 @@ static void sim_iidf_read_clut_cb(int ok, int length, int record,
 	else
 		clut_len = sim->iidf_image[3] * 3;
 
-	xpm = stk_image_to_xpm(sim->iidf_image, iidf_len, efimg[2],
-					data, clut_len);
-	sim_get_image_cb(sim, id, xpm, TRUE);
+	sim_icon_loaded(sim, sim->iidf_image, iidf_len, data, clut_len);
 
 done:
 	g_free(sim->iidf_image);
@@ -1089,7 +1242,6 @@ static void sim_iidf_read_cb(int ok, int length, int record,
 				int record_length, void *userdata)
 {
 	struct ofono_sim *sim = userdata;
-	unsigned char id;
 	unsigned char *efimg;
 	unsigned short iidf_id;
 	unsigned short offset;
@@ -1099,19 +1251,20 @@ static void sim_iidf_read_cb(int ok, int length, int record,
 
 	DBG("ok: %d", ok);
 
-	dbus_message_get_args(sim->pending, NULL, DBUS_TYPE_BYTE, &id,
-					DBUS_TYPE_INVALID);
-	id -= 1;
-	efimg = &sim->efimg[id * 9];
-
-	if (!ok) {
-		sim_get_image_cb(sim, id, NULL, FALSE);
+	if (!ok || sim->icon_discard) {
+		sim_icon_loaded(sim, NULL, 0, NULL, 0);
 		return;
 	}
 
+	efimg = &sim->efimg[(sim->icon_loading - 1) * 9];
+
 	if (efimg[2] == STK_IMG_SCHEME_BASIC) {
-		char *xpm = stk_image_to_xpm(data, length, efimg[2], NULL, 0);
-		sim_get_image_cb(sim, id, xpm, TRUE);
+		sim_icon_loaded(sim, data, length, NULL, 0);
+		return;
+	}
+
+	if (length < 6) {
+		sim_icon_loaded(sim, NULL, 0, NULL, 0);
 		return;
 	}
 
@@ -1139,54 +1292,135 @@ static void sim_image_data_changed(int id, void *userdata)
 	/* TODO: notify D-bus clients */
 }
 
-static void sim_get_image(struct ofono_sim *sim, unsigned char id,
-				gpointer user_data)
+static void sim_icon_load(struct ofono_sim *sim, unsigned char id)
 {
+	gboolean rgba = sim_icon_rgba_wanted(sim, id);
+	struct sim_icon *icon;
 	unsigned char *efimg;
-	char *image;
 	unsigned short iidf_id;
 	unsigned short iidf_offset;
 	unsigned short iidf_len;
+	unsigned char path[6];
+	unsigned int path_len;
 
-	if (sim->efimg_length <= id * 9) {
-		sim_get_image_cb(sim, id, NULL, FALSE);
+	if (sim->efimg == NULL || sim->efimg_length < id * 9) {
+		sim_icon_requests_done(sim, id);
 		return;
 	}
 
-	image = sim_fs_get_cached_image(sim->simfs, id);
-	if (image != NULL)
-		sim_get_image_cb(sim, id, image, FALSE);
-
-	efimg = &sim->efimg[id * 9];
-
+	efimg = &sim->efimg[(id - 1) * 9];
 	iidf_id = efimg[3] << 8 | efimg[4];
 	iidf_offset = efimg[5] << 8 | efimg[6];
 	iidf_len = efimg[7] << 8 | efimg[8];
 
+	if (sim->iidf_watch_ids[id - 1] == 0)
+		sim->iidf_watch_ids[id - 1] =
+			ofono_sim_add_file_watch(sim->context, iidf_id,
+						sim_image_data_changed,
+						sim, NULL);
+
+	icon = sim_icon_get(sim, id);
+
+	if (icon->xpm == NULL && !rgba)
+		icon->xpm = sim_fs_get_cached_image(sim->simfs, id - 1);
+
+	if (sim_icon_ready(icon, rgba)) {
+		sim_icon_requests_done(sim, id);
+		return;
+	}
+
+	sim->icon_loading = id;
+
+	/* The path it the same between 2G and 3G */
+	path_len = sim_ef_db_get_path_3g(SIM_EFIMG_FILEID, path);
+
 	/* read the image data */
-	if (image == NULL) {
-		unsigned char path[6];
-		unsigned int path_len;
+	ofono_sim_read_bytes(sim->context, iidf_id, iidf_offset,
+				iidf_len, path, path_len,
+				sim_iidf_read_cb, sim);
+}
+
+/* Images are read from the SIM one at a time, in the order requested */
+static void sim_icon_load_next(struct ofono_sim *sim)
+{
+	while (sim->icon_loading == 0 && sim->icon_queue) {
+		unsigned char id = GPOINTER_TO_UINT(sim->icon_queue->data);
+
+		sim->icon_queue = g_slist_delete_link(sim->icon_queue,
+							sim->icon_queue);
+		sim_icon_load(sim, id);
+	}
+}
+
+static void sim_icon_queue(struct ofono_sim *sim, unsigned char id)
+{
+	if (id == sim->icon_loading)
+		return;
+
+	if (g_slist_find(sim->icon_queue, GUINT_TO_POINTER(id)))
+		return;
+
+	sim->icon_queue = g_slist_append(sim->icon_queue,
+						GUINT_TO_POINTER(id));
+}
+
+/* Drops the icon from memory, id 0 drops them all */
+static void sim_icon_forget(struct ofono_sim *sim, unsigned char id)
+{
+	if (sim->icon_loading && (id == 0 || id == sim->icon_loading))
+		sim->icon_discard = true;
 
-		/* The path it the same between 2G and 3G */
-		path_len = sim_ef_db_get_path_3g(SIM_EFIMG_FILEID, path);
-		ofono_sim_read_bytes(sim->context, iidf_id, iidf_offset,
-					iidf_len, path, path_len,
-					sim_iidf_read_cb, sim);
+	if (sim->icons == NULL)
+		return;
+
+	if (id == 0)
+		g_hash_table_remove_all(sim->icons);
+	else
+		g_hash_table_remove(sim->icons, GUINT_TO_POINTER(id));
+}
+
+/* Pending reads are cancelled together with the SIM context */
+static void sim_icons_free(struct ofono_sim *sim)
+{
+	g_slist_free(sim->icon_queue);
+	sim->icon_queue = NULL;
+	sim->icon_loading = 0;
+	sim->icon_discard = false;
+
+	if (sim->icons) {
+		g_hash_table_destroy(sim->icons);
+		sim->icons = NULL;
 	}
 
-	if (sim->iidf_watch_ids[id] > 0)
+	sim_icon_requests_done(sim, 0);
+}
+
+void __ofono_sim_prefetch_icons(struct ofono_sim *sim,
+				const unsigned char *ids, unsigned int n)
+{
+	unsigned int i;
+
+	if (sim == NULL || sim->efimg == NULL)
 		return;
 
-	sim->iidf_watch_ids[id] = ofono_sim_add_file_watch(sim->context,
-					iidf_id, sim_image_data_changed,
-					sim, NULL);
+	for (i = 0; i < n; i++) {
+		if (ids[i] == 0)
+			continue;
+
+		if (sim_icon_ready(sim_icon_lookup(sim, ids[i]), FALSE))
+			continue;
+
+		sim_icon_queue(sim, ids[i]);
+	}
+
+	sim_icon_load_next(sim);
 }
 
 static DBusMessage *sim_get_icon(DBusConnection *conn,
 					DBusMessage *msg, void *data)
 {
 	struct ofono_sim *sim = data;
+	struct sim_icon *icon;
 	unsigned char id;
 
 	if (dbus_message_get_args(msg, NULL, DBUS_TYPE_BYTE, &id,
@@ -1197,19 +1431,134 @@ static DBusMessage *sim_get_icon(DBusConnection *conn,
 	if (id == 0)
 		return __ofono_error_invalid_args(msg);
 
-	if (sim->pending)
-		return __ofono_error_busy(msg);
-
 	if (sim->efimg == NULL)
 		return __ofono_error_not_implemented(msg);
 
-	sim->pending = dbus_message_ref(msg);
+	icon = sim_icon_lookup(sim, id);
+	if (sim_icon_ready(icon, sim_icon_request_rgba(msg)))
+		return sim_icon_reply(msg, icon);
 
-	sim_get_image(sim, id - 1, sim);
+	sim->icon_requests = g_slist_append(sim->icon_requests,
+						dbus_message_ref(msg));
+	sim_icon_queue(sim, id);
+	sim_icon_load_next(sim);
 
 	return NULL;
 }
 
+/* A ReadFile call waiting for the first block of the EF */
+struct sim_file_read {
+	struct ofono_sim *sim;
+	DBusMessage *msg;
+};
+
+static void sim_file_read_free(gpointer pointer)
+{
+	struct sim_file_read *req = pointer;
+
+	if (req->msg)
+		__ofono_dbus_pending_reply(&req->msg,
+					__ofono_error_failed(req->msg));
+
+	g_free(req);
+}
+
+static void sim_file_read_cb(int ok, int fd, int total_length,
+				int record_length, void *userdata)
+{
+	struct sim_file_read *req = userdata;
+	struct ofono_sim *sim = req->sim;
+	DBusMessage *reply;
+	dbus_uint32_t length = total_length;
+	dbus_uint16_t reclen = record_length;
+
+	sim->file_reads = g_slist_remove(sim->file_reads, req);
+
+	if (!ok) {
+		sim_file_read_free(req);
+		return;
+	}
+
+	/* The message holds its own duplicate of the fd */
+	reply = dbus_message_new_method_return(req->msg);
+	dbus_message_append_args(reply, DBUS_TYPE_UNIX_FD, &fd,
+					DBUS_TYPE_UINT32, &length,
+					DBUS_TYPE_UINT16, &reclen,
+					DBUS_TYPE_INVALID);
+	__ofono_dbus_pending_reply(&req->msg, reply);
+	close(fd);
+
+	sim_file_read_free(req);
+}
+
+static DBusMessage *sim_read_file(DBusConnection *conn, DBusMessage *msg,
+					void *data)
+{
+	struct ofono_sim *sim = data;
+	struct sim_file_read *req;
+	enum ofono_sim_file_structure structure;
+	const char *str;
+	unsigned char *path;
+	int path_len;
+	dbus_uint16_t id;
+	DBusMessageIter iter, array;
+
+	if (!sim_allow(msg, OFONO_DBUS_ACCESS_SIMMGR_READ_FILE, NULL))
+		return __ofono_error_access_denied(msg);
+
+	if (!dbus_connection_can_send_type(conn, DBUS_TYPE_UNIX_FD))
+		return __ofono_error_not_supported(msg);
+
+	if (!dbus_message_iter_init(msg, &iter))
+		return __ofono_error_invalid_args(msg);
+
+	if (!dbus_message_has_signature(msg, "qsay"))
+		return __ofono_error_invalid_args(msg);
+
+	dbus_message_iter_get_basic(&iter, &id);
+	dbus_message_iter_next(&iter);
+	dbus_message_iter_get_basic(&iter, &str);
+	dbus_message_iter_next(&iter);
+	dbus_message_iter_recurse(&iter, &array);
+	dbus_message_iter_get_fixed_array(&array, &path, &path_len);
+
+	if (!strcmp(str, "transparent"))
+		structure = OFONO_SIM_FILE_STRUCTURE_TRANSPARENT;
+	else if (!strcmp(str, "fixed"))
+		structure = OFONO_SIM_FILE_STRUCTURE_FIXED;
+	else if (!strcmp(str, "cyclic"))
+		structure = OFONO_SIM_FILE_STRUCTURE_CYCLIC;
+	else
+		return __ofono_error_invalid_format(msg);
+
+	if (path_len > 6)
+		return __ofono_error_invalid_format(msg);
+
+	if (sim->context == NULL)
+		return __ofono_error_not_available(msg);
+
+	req = g_new0(struct sim_file_read, 1);
+	req->sim = sim;
+
+	if (sim_fs_read_fd(sim->context, id, structure, path, path_len,
+					sim_file_read_cb, req) < 0) {
+		g_free(req);
+		return __ofono_error_failed(msg);
+	}
+
+	req->msg = dbus_message_ref(msg);
+	sim->file_reads = g_slist_prepend(sim->file_reads, req);
+
+	return NULL;
+}
+
+/* Reads in progress are cancelled together with the SIM context */
+static void sim_file_reads_free(struct ofono_sim *sim)
+{
+	g_slist_free_full(sim->file_reads, sim_file_read_free);
+	sim->file_reads = NULL;
+}
+
 static DBusMessage *sim_reset_pin(DBusConnection *conn, DBusMessage *msg,
 					void *data)
 {
@@ -1281,6 +1630,17 @@ static const GDBusMethodTable sim_methods[] = {
 			GDBUS_ARGS({ "id", "y" }),
 			GDBUS_ARGS({ "icon", "ay" }),
 			sim_get_icon) },
+	{ GDBUS_ASYNC_METHOD("GetIconRGBA",
+			GDBUS_ARGS({ "id", "y" }),
+			GDBUS_ARGS({ "width", "q" }, { "height", "q" },
+					{ "pixels", "ay" }),
+			sim_get_icon) },
+	{ GDBUS_ASYNC_METHOD("ReadFile",
+			GDBUS_ARGS({ "id", "q" }, { "structure", "s" },
+					{ "path", "ay" }),
+			GDBUS_ARGS({ "fd", "h" }, { "length", "u" },
+					{ "record_length", "q" }),
+			sim_read_file) },
 	{ }
 };
 
@@ -1549,6 +1909,8 @@ static void sim_efimg_changed(int id, void *userdata)
 		sim->iidf_watch_ids = NULL;
 	}
 
+	sim_icon_forget(sim, 0);
+
 	ofono_sim_read(sim->context, SIM_EFIMG_FILEID,
 			OFONO_SIM_FILE_STRUCTURE_FIXED, sim_efimg_read_cb, sim);
 
@@ -2325,6 +2687,7 @@ static void sim_iccid_changed(int id, void *userdata)
 	if (sim->iccid) {
 		g_free(sim->iccid);
 		sim->iccid = NULL;
+		sim_properties_invalidate(sim);
 	}
 
 	ofono_sim_read(sim->early_context, SIM_EF_ICCID_FILEID,
@@ -2345,6 +2708,7 @@ static void sim_efli_efpl_changed(int id, void *userdata)
 	if (sim->language_prefs) {
 		g_strfreev(sim->language_prefs);
 		sim->language_prefs = NULL;
+		sim_properties_invalidate(sim);
 	}
 
 	sim->language_prefs_update = true;
@@ -2653,6 +3017,8 @@ static void sim_free_early_state(struct ofono_sim *sim)
 		ofono_sim_context_free(sim->early_context);
 		sim->early_context = NULL;
 	}
+
+	sim_properties_invalidate(sim);
 }
 
 static void sim_spn_close(struct ofono_sim *sim)
@@ -2749,6 +3115,8 @@ static void sim_free_main_state(struct ofono_sim *sim)
 
 	g_free(sim->iidf_image);
 	sim->iidf_image = NULL;
+	sim_icons_free(sim);
+	sim_file_reads_free(sim);
 
 	sim->fixed_dialing = false;
 	sim->barred_dialing = false;
@@ -2781,6 +3149,8 @@ static void sim_free_main_state(struct ofono_sim *sim)
 
 	sim->initialized = false;
 	sim->wait_initialized = false;
+
+	sim_properties_invalidate(sim);
 }
 
 static void sim_free_state(struct ofono_sim *sim)
@@ -3042,6 +3412,8 @@ notify:
 						OFONO_SIM_MANAGER_INTERFACE,
 						"ServiceProviderName",
 						DBUS_TYPE_STRING, &sim->spn);
+	else
+		sim_properties_invalidate(sim);
 
 	spn_watches_notify(sim);
 }
@@ -3326,6 +3698,7 @@ static void sim_unregister(struct ofono_atom *atom)
 	__ofono_watchlist_free(sim->spn_watches);
 	sim->spn_watches = NULL;
 
+	__ofono_dbus_properties_unregister(path, OFONO_SIM_MANAGER_INTERFACE);
 	g_dbus_unregister_interface(conn, path, OFONO_SIM_MANAGER_INTERFACE);
 	ofono_modem_remove_interface(modem, OFONO_SIM_MANAGER_INTERFACE);
 }
@@ -3455,6 +3828,8 @@ void ofono_sim_register(struct ofono_sim *sim)
 		return;
 	}
 
+	__ofono_dbus_properties_register(path, OFONO_SIM_MANAGER_INTERFACE,
+						sim_append_properties, sim);
 	ofono_modem_add_interface(modem, OFONO_SIM_MANAGER_INTERFACE);
 	sim->iccid_watches = __ofono_watchlist_new(g_free);
 	sim->imsi_watches = __ofono_watchlist_new(g_free);
@@ -3553,10 +3928,11 @@ static void sim_file_changed_flush(struct ofono_sim *sim, int id)
 {
 	int i, imgid;
 
-	if (id == SIM_EFIMG_FILEID)
+	if (id == SIM_EFIMG_FILEID) {
 		/* All cached images become invalid */
 		sim_fs_image_cache_flush(sim->simfs);
-	else if (sim->efimg) {
+		sim_icon_forget(sim, 0);
+	} else if (sim->efimg) {
 		/*
 		 * Data and CLUT for image instances stored in the changed
 		 * file need to be re-read.
@@ -3565,8 +3941,11 @@ static void sim_file_changed_flush(struct ofono_sim *sim, int id)
 			imgid = (sim->efimg[i * 9 + 3] << 8) |
 				sim->efimg[i * 9 + 4];
 
-			if (imgid == id)
-				sim_fs_image_cache_flush_file(sim->simfs, i);
+			if (imgid != id)
+				continue;
+
+			sim_fs_image_cache_flush_file(sim->simfs, i);
+			sim_icon_forget(sim, i + 1);
 		}
 	}
 
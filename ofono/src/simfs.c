@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <sys/socket.h>
 
 #include "ofono.h"
 
@@ -55,6 +56,7 @@
 static gboolean sim_fs_op_next(gpointer user_data);
 static gboolean sim_fs_op_read_record(gpointer user);
 static gboolean sim_fs_op_read_block(gpointer user_data);
+static void sim_fs_fd_stream_free(gpointer pointer);
 
 struct sim_fs_op {
 	int id;
@@ -70,6 +72,7 @@ struct sim_fs_op {
 	unsigned char path_len;
 	gconstpointer cb;
 	gboolean is_read;
+	gboolean stream;
 	void *userdata;
 	struct ofono_sim_context *context;
 };
@@ -77,6 +80,7 @@ struct sim_fs_op {
 struct ofono_sim_context {
 	struct sim_fs *fs;
 	struct ofono_watchlist *file_watches;
+	GSList *fd_streams;
 };
 
 struct sim_fs {
@@ -209,6 +213,8 @@ void sim_fs_context_free(struct ofono_sim_context *context)
 	if (context->file_watches)
 		__ofono_watchlist_free(context->file_watches);
 
+	g_slist_free_full(context->fd_streams, sim_fs_fd_stream_free);
+
 	fs->contexts = g_slist_remove(fs->contexts, context);
 	g_free(context);
 }
@@ -421,9 +427,15 @@ static void sim_fs_op_read_block_cb(const struct ofono_error *error,
 	DBG("bufoff: %d, dataoff: %d, tocopy: %d",
 				bufoff, dataoff, tocopy);
 
-	memcpy(op->buffer + bufoff, data + dataoff, tocopy);
 	cache_block(fs, op->current, 256, data, len);
 
+	if (op->stream == FALSE)
+		memcpy(op->buffer + bufoff, data + dataoff, tocopy);
+	else if (op->cb != NULL)
+		((ofono_sim_file_read_cb_t) op->cb)(1, op->num_bytes,
+					op->current - start_block + 1,
+					data + dataoff, tocopy, op->userdata);
+
 	if (op->cb == NULL) {
 		sim_fs_end_current(fs);
 		return;
@@ -434,8 +446,9 @@ static void sim_fs_op_read_block_cb(const struct ofono_error *error,
 	if (op->current > end_block) {
 		ofono_sim_file_read_cb_t cb = op->cb;
 
-		cb(1, op->num_bytes, 0, op->buffer,
-				op->record_length, op->userdata);
+		if (op->stream == FALSE)
+			cb(1, op->num_bytes, 0, op->buffer,
+					op->record_length, op->userdata);
 
 		sim_fs_end_current(fs);
 	} else {
@@ -450,6 +463,7 @@ static gboolean sim_fs_op_read_block(gpointer user_data)
 	int start_block;
 	int end_block;
 	unsigned short read_bytes;
+	unsigned char block[256];
 
 	fs->op_source = 0;
 
@@ -461,7 +475,7 @@ static gboolean sim_fs_op_read_block(gpointer user_data)
 	start_block = op->offset / 256;
 	end_block = (op->offset + (op->num_bytes - 1)) / 256;
 
-	if (op->current == start_block) {
+	if (op->current == start_block && op->stream == FALSE) {
 		op->buffer = g_try_new0(unsigned char, op->num_bytes);
 
 		if (op->buffer == NULL) {
@@ -499,8 +513,24 @@ static gboolean sim_fs_op_read_block(gpointer user_data)
 		if (lseek(fs->fd, seekoff, SEEK_SET) == (off_t) -1)
 			break;
 
-		if (TFR(read(fs->fd, op->buffer + bufoff, toread)) != toread)
-			break;
+		if (op->stream == FALSE) {
+			if (TFR(read(fs->fd, op->buffer + bufoff, toread)) !=
+					toread)
+				break;
+		} else {
+			if (TFR(read(fs->fd, block, toread)) != toread)
+				break;
+
+			((ofono_sim_file_read_cb_t) op->cb)(1, op->num_bytes,
+					op->current - start_block + 1,
+					block, toread, op->userdata);
+
+			/* The consumer went away */
+			if (op->cb == NULL) {
+				sim_fs_end_current(fs);
+				return FALSE;
+			}
+		}
 
 		op->current += 1;
 	}
@@ -508,8 +538,9 @@ static gboolean sim_fs_op_read_block(gpointer user_data)
 	if (op->current > end_block) {
 		ofono_sim_file_read_cb_t cb = op->cb;
 
-		cb(1, op->num_bytes, 0, op->buffer,
-				op->record_length, op->userdata);
+		if (op->stream == FALSE)
+			cb(1, op->num_bytes, 0, op->buffer,
+					op->record_length, op->userdata);
 
 		sim_fs_end_current(fs);
 
@@ -1078,11 +1109,12 @@ int sim_fs_read_info(struct ofono_sim_context *context, int id,
 	return 0;
 }
 
-int sim_fs_read(struct ofono_sim_context *context, int id,
-		enum ofono_sim_file_structure expected_type,
-		unsigned short offset, unsigned short num_bytes,
-		const unsigned char *path, unsigned int path_len,
-		ofono_sim_file_read_cb_t cb, void *data)
+static int sim_fs_read_op(struct ofono_sim_context *context, int id,
+				enum ofono_sim_file_structure expected_type,
+				unsigned short offset, unsigned short num_bytes,
+				const unsigned char *path,
+				unsigned int path_len, gboolean stream,
+				ofono_sim_file_read_cb_t cb, void *data)
 {
 	struct sim_fs *fs = context->fs;
 	struct sim_fs_op *op;
@@ -1121,6 +1153,7 @@ int sim_fs_read(struct ofono_sim_context *context, int id,
 	op->offset = offset;
 	op->num_bytes = num_bytes;
 	op->info_only = FALSE;
+	op->stream = stream;
 	op->context = context;
 	memcpy(op->path, path, path_len);
 	op->path_len = path_len;
@@ -1133,6 +1166,276 @@ int sim_fs_read(struct ofono_sim_context *context, int id,
 	return 0;
 }
 
+int sim_fs_read(struct ofono_sim_context *context, int id,
+		enum ofono_sim_file_structure expected_type,
+		unsigned short offset, unsigned short num_bytes,
+		const unsigned char *path, unsigned int path_len,
+		ofono_sim_file_read_cb_t cb, void *data)
+{
+	return sim_fs_read_op(context, id, expected_type, offset, num_bytes,
+				path, path_len, FALSE, cb, data);
+}
+
+/*
+ * Reads the whole EF like sim_fs_read, but passes on each block of a
+ * transparent file as soon as it arrives instead of collecting the file
+ * in one buffer.  The record argument of the callback counts the blocks
+ * from 1 and record_length is the size of the block.  Record based files
+ * are delivered one record at a time, the same as with sim_fs_read.
+ * The read is complete once total_length bytes have been passed on.
+ */
+int sim_fs_read_stream(struct ofono_sim_context *context, int id,
+			enum ofono_sim_file_structure expected_type,
+			const unsigned char *path, unsigned int path_len,
+			ofono_sim_file_read_cb_t cb, void *data)
+{
+	return sim_fs_read_op(context, id, expected_type, 0, 0,
+				path, path_len, TRUE, cb, data);
+}
+
+/*
+ * A stream of sim_fs_read_fd.  The read can't be taken back once queued,
+ * so the stream lives until the read is over even if the reader has
+ * closed its end of the socket.
+ */
+struct sim_fs_fd_stream {
+	struct ofono_sim_context *context;
+	enum ofono_sim_file_structure structure;
+	sim_fs_read_fd_cb_t cb;
+	void *userdata;
+	int read_fd;
+	int fd;
+	guint watch;
+	GByteArray *out;
+	int received;
+	gboolean reading;
+};
+
+static void sim_fs_fd_stream_free(gpointer pointer)
+{
+	struct sim_fs_fd_stream *stream = pointer;
+
+	if (stream->watch)
+		g_source_remove(stream->watch);
+
+	if (stream->read_fd >= 0)
+		close(stream->read_fd);
+
+	if (stream->fd >= 0)
+		close(stream->fd);
+
+	g_byte_array_free(stream->out, TRUE);
+	g_free(stream);
+}
+
+/* Frees the stream once the read is over and the data is out */
+static void sim_fs_fd_stream_check(struct sim_fs_fd_stream *stream)
+{
+	struct ofono_sim_context *context = stream->context;
+
+	if (stream->reading)
+		return;
+
+	if (stream->fd >= 0 && stream->out->len > 0)
+		return;
+
+	if (stream->read_fd >= 0 && stream->cb)
+		stream->cb(0, -1, 0, 0, stream->userdata);
+
+	context->fd_streams = g_slist_remove(context->fd_streams, stream);
+	sim_fs_fd_stream_free(stream);
+}
+
+static void sim_fs_fd_stream_close(struct sim_fs_fd_stream *stream)
+{
+	if (stream->watch) {
+		g_source_remove(stream->watch);
+		stream->watch = 0;
+	}
+
+	if (stream->fd >= 0) {
+		close(stream->fd);
+		stream->fd = -1;
+	}
+
+	g_byte_array_set_size(stream->out, 0);
+}
+
+/*
+ * Returns FALSE if the reader is gone.  MSG_NOSIGNAL turns a closed
+ * socket into EPIPE instead of a SIGPIPE, which would end the daemon.
+ */
+static gboolean sim_fs_fd_stream_flush(struct sim_fs_fd_stream *stream)
+{
+	ssize_t written;
+
+	while (stream->out->len > 0) {
+		written = send(stream->fd, stream->out->data,
+				stream->out->len, MSG_NOSIGNAL);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+
+			if (errno == EAGAIN)
+				return TRUE;
+
+			DBG("send failed: %s", strerror(errno));
+			return FALSE;
+		}
+
+		g_byte_array_remove_range(stream->out, 0, written);
+	}
+
+	return TRUE;
+}
+
+static gboolean sim_fs_fd_stream_write(GIOChannel *io, GIOCondition cond,
+							gpointer user_data)
+{
+	struct sim_fs_fd_stream *stream = user_data;
+
+	if ((cond & (G_IO_ERR | G_IO_HUP | G_IO_NVAL)) ||
+			!sim_fs_fd_stream_flush(stream)) {
+		stream->watch = 0;
+		sim_fs_fd_stream_close(stream);
+		sim_fs_fd_stream_check(stream);
+		return FALSE;
+	}
+
+	if (stream->out->len > 0)
+		return TRUE;
+
+	stream->watch = 0;
+	sim_fs_fd_stream_check(stream);
+	return FALSE;
+}
+
+static void sim_fs_fd_stream_push(struct sim_fs_fd_stream *stream,
+					const unsigned char *data, int len)
+{
+	GIOChannel *io;
+
+	if (stream->fd < 0)
+		return;
+
+	g_byte_array_append(stream->out, data, len);
+
+	if (stream->watch)
+		return;
+
+	if (!sim_fs_fd_stream_flush(stream)) {
+		sim_fs_fd_stream_close(stream);
+		return;
+	}
+
+	if (stream->out->len == 0)
+		return;
+
+	io = g_io_channel_unix_new(stream->fd);
+	stream->watch = g_io_add_watch(io, G_IO_OUT | G_IO_ERR |
+						G_IO_HUP | G_IO_NVAL,
+						sim_fs_fd_stream_write, stream);
+	g_io_channel_unref(io);
+}
+
+static void sim_fs_fd_stream_cb(int ok, int total_length, int record,
+				const unsigned char *data,
+				int record_length, void *userdata)
+{
+	struct sim_fs_fd_stream *stream = userdata;
+	int reclen = record_length;
+	int fd;
+
+	if (!ok) {
+		stream->reading = FALSE;
+
+		/* Cut short, the reader sees fewer bytes than announced */
+		sim_fs_fd_stream_close(stream);
+		sim_fs_fd_stream_check(stream);
+		return;
+	}
+
+	/* Blocks of transparent EFs come with their size as record_length */
+	if (stream->structure == OFONO_SIM_FILE_STRUCTURE_TRANSPARENT)
+		reclen = 0;
+
+	sim_fs_fd_stream_push(stream, data, record_length);
+	stream->received += record_length;
+
+	if (stream->read_fd >= 0) {
+		fd = stream->read_fd;
+		stream->read_fd = -1;
+		stream->cb(1, fd, total_length, reclen, stream->userdata);
+	}
+
+	if (stream->received < total_length)
+		return;
+
+	stream->reading = FALSE;
+	sim_fs_fd_stream_check(stream);
+}
+
+/*
+ * Reads the whole EF like sim_fs_read_stream and writes it to a socket
+ * as it comes in.  Once the first block or record is in, the callback
+ * gets the read end of the socket, which it then owns, along with the
+ * file length and, for record based files, the record length.  If the
+ * read fails before that, the callback gets ok set to 0 and an fd of -1.
+ * If it fails later, the socket is closed early.  The callback is not
+ * called if the read can't be queued or the context is freed first.
+ */
+int sim_fs_read_fd(struct ofono_sim_context *context, int id,
+			enum ofono_sim_file_structure expected_type,
+			const unsigned char *path, unsigned int path_len,
+			sim_fs_read_fd_cb_t cb, void *data)
+{
+	struct sim_fs_fd_stream *stream;
+	int fds[2];
+	int err;
+
+	if (cb == NULL)
+		return -EINVAL;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+		return -errno;
+
+	/* The reader only reads */
+	shutdown(fds[0], SHUT_WR);
+	shutdown(fds[1], SHUT_RD);
+
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+	fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+	stream = g_new0(struct sim_fs_fd_stream, 1);
+	stream->context = context;
+	stream->structure = expected_type;
+	stream->read_fd = fds[0];
+	stream->fd = fds[1];
+	stream->out = g_byte_array_new();
+	stream->reading = TRUE;
+
+	context->fd_streams = g_slist_prepend(context->fd_streams, stream);
+
+	err = sim_fs_read_stream(context, id, expected_type, path, path_len,
+					sim_fs_fd_stream_cb, stream);
+	if (err < 0) {
+		/* simfs may have failed the read through the callback */
+		if (g_slist_find(context->fd_streams, stream)) {
+			stream->reading = FALSE;
+			sim_fs_fd_stream_check(stream);
+		}
+
+		return err;
+	}
+
+	/* The read is queued, nothing has been delivered yet */
+	stream->cb = cb;
+	stream->userdata = data;
+
+	return 0;
+}
+
 int sim_fs_read_record(struct ofono_sim_context *context, int id,
 			enum ofono_sim_file_structure expected_type,
 			int record, int record_length,
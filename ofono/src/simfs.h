@@ -25,6 +25,9 @@ typedef void (*sim_fs_read_info_cb_t)(int ok, unsigned char file_status,
 					int total_length, int record_length,
 					void *userdata);
 
+typedef void (*sim_fs_read_fd_cb_t)(int ok, int fd, int total_length,
+					int record_length, void *userdata);
+
 struct sim_fs *sim_fs_new(struct ofono_sim *sim,
 				const struct ofono_sim_driver *driver);
 struct ofono_sim_context *sim_fs_context_new(struct sim_fs *fs);
@@ -48,6 +51,16 @@ int sim_fs_read(struct ofono_sim_context *context, int id,
 		const unsigned char *path, unsigned int len,
 		ofono_sim_file_read_cb_t cb, void *data);
 
+int sim_fs_read_stream(struct ofono_sim_context *context, int id,
+			enum ofono_sim_file_structure expected_type,
+			const unsigned char *path, unsigned int len,
+			ofono_sim_file_read_cb_t cb, void *data);
+
+int sim_fs_read_fd(struct ofono_sim_context *context, int id,
+			enum ofono_sim_file_structure expected_type,
+			const unsigned char *path, unsigned int len,
+			sim_fs_read_fd_cb_t cb, void *data);
+
 int sim_fs_read_record(struct ofono_sim_context *context, int id,
 			enum ofono_sim_file_structure expected_type,
 			int record, int record_length,
@@ -27,6 +27,7 @@ enum sim_fileid {
 	SIM_EF_ICCID_FILEID =			0x2FE2,
 	SIM_MF_FILEID =				0x3F00,
 	SIM_EFIMG_FILEID =			0x4F20,
+	SIM_EFPBR_FILEID =			0x4F30,
 	SIM_DFPHONEBOOK_FILEID =		0x5F3A,
 	SIM_EFLI_FILEID =			0x6F05,
 	SIM_EFARR_FILEID =			0x6F06,
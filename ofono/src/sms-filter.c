@@ -55,12 +55,53 @@ ASSERT_ENUM_(SMS_CLASS_2);
 ASSERT_ENUM_(SMS_CLASS_3);
 ASSERT_ENUM_(SMS_CLASS_UNSPECIFIED);
 
+/*
+ * Nor do we convert the structures, the filters and the handlers look
+ * at the same bytes through the union members. Assert that the layouts
+ * are identical.
+ */
+#define ASSERT_FIELD_(type,field) \
+    G_STATIC_ASSERT(G_STRUCT_OFFSET(struct type, field) == \
+	G_STRUCT_OFFSET(struct ofono_##type, field) && \
+	sizeof(((struct type *)0)->field) == \
+	sizeof(((struct ofono_##type *)0)->field))
+
+G_STATIC_ASSERT(sizeof(struct sms_address) ==
+				sizeof(struct ofono_sms_address));
+ASSERT_FIELD_(sms_address, number_type);
+ASSERT_FIELD_(sms_address, numbering_plan);
+ASSERT_FIELD_(sms_address, address);
+
+G_STATIC_ASSERT(sizeof(struct sms_scts) == sizeof(struct ofono_sms_scts));
+ASSERT_FIELD_(sms_scts, year);
+ASSERT_FIELD_(sms_scts, month);
+ASSERT_FIELD_(sms_scts, day);
+ASSERT_FIELD_(sms_scts, hour);
+ASSERT_FIELD_(sms_scts, minute);
+ASSERT_FIELD_(sms_scts, second);
+ASSERT_FIELD_(sms_scts, has_timezone);
+ASSERT_FIELD_(sms_scts, timezone);
+
+union sms_filter_address {
+	struct sms_address sms;
+	struct ofono_sms_address ofono;
+};
+
+union sms_filter_scts {
+	struct sms_scts sms;
+	struct ofono_sms_scts ofono;
+};
+
 struct sms_filter_message;
 struct sms_filter_message_fn {
 	const char *name;
 	gboolean (*can_process)(const struct ofono_sms_filter *filter);
 	guint (*process)(const struct ofono_sms_filter *filter,
 					struct sms_filter_message *msg);
+	gboolean (*can_check)(const struct ofono_sms_filter *filter);
+	enum ofono_sms_filter_result (*check)
+				(const struct ofono_sms_filter *filter,
+					struct sms_filter_message *msg);
 	void (*passthrough)(struct sms_filter_message *msg);
 	void (*destroy)(struct sms_filter_message *msg);
 	void (*free)(struct sms_filter_message *msg);
@@ -82,7 +123,7 @@ struct sms_filter_chain_send_text {
 	ofono_destroy_func destroy;
 	void *data;
 	char *text;
-	struct ofono_sms_address addr;
+	union sms_filter_address addr;
 };
 
 struct sms_filter_chain_recv_text {
@@ -91,8 +132,8 @@ struct sms_filter_chain_recv_text {
 	struct ofono_uuid uuid;
 	char *text;
 	enum ofono_sms_class cls;
-	struct ofono_sms_address addr;
-	struct ofono_sms_scts scts;
+	union sms_filter_address addr;
+	union sms_filter_scts scts;
 };
 
 struct sms_filter_chain_recv_datagram {
@@ -103,8 +144,8 @@ struct sms_filter_chain_recv_datagram {
 	int src_port;
 	unsigned char *buf;
 	unsigned int len;
-	struct ofono_sms_address addr;
-	struct ofono_sms_scts scts;
+	union sms_filter_address addr;
+	union sms_filter_scts scts;
 };
 
 struct sms_filter_chain {
@@ -115,49 +156,6 @@ struct sms_filter_chain {
 
 static GSList *sms_filter_list = NULL;
 
-static void sms_filter_convert_sms_address(struct ofono_sms_address *dest,
-						const struct sms_address *src)
-{
-	dest->number_type = (enum ofono_sms_number_type)src->number_type;
-	dest->numbering_plan = (enum ofono_sms_numbering_plan)
-		src->numbering_plan;
-	strncpy(dest->address, src->address, sizeof(dest->address));
-};
-
-static void sms_filter_convert_sms_address_back(struct sms_address *dest,
-					const struct ofono_sms_address *src)
-{
-	dest->number_type = (enum sms_number_type)src->number_type;
-	dest->numbering_plan = (enum sms_numbering_plan)src->numbering_plan;
-	strncpy(dest->address, src->address, sizeof(dest->address));
-};
-
-static void sms_filter_convert_sms_scts(struct ofono_sms_scts *dest,
-						const struct sms_scts *src)
-{
-	dest->year = src->year;
-	dest->month = src->month;
-	dest->day = src->day;
-	dest->hour = src->hour;
-	dest->minute = src->minute;
-	dest->second = src->second;
-	dest->has_timezone = src->has_timezone;
-	dest->timezone = src->timezone;
-}
-
-static void sms_filter_convert_sms_scts_back(struct sms_scts *dest,
-					const struct ofono_sms_scts *src)
-{
-	dest->year = src->year;
-	dest->month = src->month;
-	dest->day = src->day;
-	dest->hour = src->hour;
-	dest->minute = src->minute;
-	dest->second = src->second;
-	dest->has_timezone = src->has_timezone;
-	dest->timezone = src->timezone;
-}
-
 static void sms_filter_message_init(struct sms_filter_message *msg,
 	struct sms_filter_chain *chain, const struct sms_filter_message_fn *fn)
 {
@@ -175,35 +173,6 @@ static void sms_filter_message_init(struct sms_filter_message *msg,
 	chain->msg_list = g_slist_append(chain->msg_list, msg);
 }
 
-static void sms_filter_message_process(struct sms_filter_message *msg)
-{
-	GSList *filter_link = msg->filter_link;
-	const struct ofono_sms_filter *filter = filter_link->data;
-	const struct sms_filter_message_fn *fn = msg->fn;
-
-	while (filter && !fn->can_process(filter)) {
-		filter_link = filter_link->next;
-		filter = filter_link ? filter_link->data : NULL;
-	}
-
-	if (filter) {
-		guint id;
-
-		/*
-		 * If fn->process returns zero, the message may have
-		 * already been deallocated. It's only guaranteed to
-		 * be alive if fn->process returns non-zero id.
-		 */
-		msg->filter_link = filter_link;
-		id = fn->process(filter, msg);
-		if (id) {
-			msg->pending_id = id;
-		}
-	} else {
-		fn->passthrough(msg);
-	}
-}
-
 static void sms_filter_message_destroy(struct sms_filter_message *msg)
 {
 	/*
@@ -283,6 +252,57 @@ static void sms_filter_message_free(struct sms_filter_message *msg)
 	}
 }
 
+static void sms_filter_message_passthrough(struct sms_filter_message *msg)
+{
+	msg->refcount++;
+	msg->fn->passthrough(msg);
+	sms_filter_message_free(msg);
+	sms_filter_message_unref(msg);
+}
+
+static void sms_filter_message_process(struct sms_filter_message *msg)
+{
+	GSList *filter_link = msg->filter_link;
+	const struct sms_filter_message_fn *fn = msg->fn;
+
+	/* Keep the message alive while the filters are looking at it */
+	msg->refcount++;
+
+	while (filter_link) {
+		const struct ofono_sms_filter *filter = filter_link->data;
+
+		if (fn->can_check(filter)) {
+			/* Synchronous verdict, move on right away */
+			msg->filter_link = filter_link;
+			if (fn->check(filter, msg) == OFONO_SMS_FILTER_DROP) {
+				DBG("%s dropping %s", filter->name, fn->name);
+				sms_filter_message_free(msg);
+				sms_filter_message_unref(msg);
+				return;
+			}
+		} else if (fn->can_process(filter)) {
+			guint id;
+
+			/*
+			 * If fn->process returns zero, the completion
+			 * callback has already been invoked and the rest
+			 * happens on a fresh stack.
+			 */
+			msg->filter_link = filter_link;
+			id = fn->process(filter, msg);
+			if (id) {
+				msg->pending_id = id;
+			}
+			sms_filter_message_unref(msg);
+			return;
+		}
+		filter_link = filter_link->next;
+	}
+
+	sms_filter_message_passthrough(msg);
+	sms_filter_message_unref(msg);
+}
+
 static void sms_filter_message_next(struct sms_filter_message *msg,
 							GSourceFunc fn)
 {
@@ -293,18 +313,10 @@ static void sms_filter_message_next(struct sms_filter_message *msg,
 static gboolean sms_filter_message_continue(gpointer data)
 {
 	struct sms_filter_message *msg = data;
-	const struct sms_filter_message_fn *fn = msg->fn;
 
 	msg->continue_id = 0;
 	msg->filter_link = msg->filter_link->next;
-	if (msg->filter_link) {
-		sms_filter_message_process(msg);
-	} else {
-		msg->refcount++;
-		fn->passthrough(msg);
-		sms_filter_message_free(msg);
-		sms_filter_message_unref(msg);
-	}
+	sms_filter_message_process(msg);
 	return G_SOURCE_REMOVE;
 }
 
@@ -359,8 +371,8 @@ static void sms_filter_chain_send_text_process_cb
 
 	if (res != OFONO_SMS_FILTER_DROP) {
 		/* Update the message */
-		if (&msg->addr != addr) {
-			msg->addr = *addr;
+		if (&msg->addr.ofono != addr) {
+			msg->addr.ofono = *addr;
 		}
 		if (msg->text != text) {
 			g_free(msg->text);
@@ -379,11 +391,28 @@ static guint sms_filter_chain_send_text_process
 		sms_filter_chain_send_text_cast(msg);
 	struct sms_filter_chain *chain = msg->chain;
 
-	return filter->filter_send_text(chain->modem, &send_msg->addr,
+	return filter->filter_send_text(chain->modem, &send_msg->addr.ofono,
 			send_msg->text, sms_filter_chain_send_text_process_cb,
 			send_msg);
 }
 
+static gboolean sms_filter_chain_send_text_can_check
+				(const struct ofono_sms_filter *filter)
+{
+	return filter->api_version >= 1 && filter->filter_send_text_sync;
+}
+
+static enum ofono_sms_filter_result sms_filter_chain_send_text_check
+				(const struct ofono_sms_filter *filter,
+					struct sms_filter_message *msg)
+{
+	struct sms_filter_chain_send_text *send_msg =
+		sms_filter_chain_send_text_cast(msg);
+
+	return filter->filter_send_text_sync(msg->chain->modem,
+				&send_msg->addr.ofono, send_msg->text);
+}
+
 static void sms_filter_chain_send_text_passthrough
 					(struct sms_filter_message *msg)
 {
@@ -391,12 +420,8 @@ static void sms_filter_chain_send_text_passthrough
 		sms_filter_chain_send_text_cast(msg);
 
 	if (send_msg->send) {
-		struct sms_filter_chain *chain = msg->chain;
-		struct sms_address addr;
-
-		sms_filter_convert_sms_address_back(&addr, &send_msg->addr);
-		send_msg->send(chain->sms, &addr, send_msg->text,
-							send_msg->data);
+		send_msg->send(msg->chain->sms, &send_msg->addr.sms,
+					send_msg->text, send_msg->data);
 	}
 }
 
@@ -428,6 +453,8 @@ static struct sms_filter_message *sms_filter_send_text_new
 		.name = "outgoing SMS text message",
 		.can_process = sms_filter_chain_send_text_can_process,
 		.process = sms_filter_chain_send_text_process,
+		.can_check = sms_filter_chain_send_text_can_check,
+		.check = sms_filter_chain_send_text_check,
 		.passthrough = sms_filter_chain_send_text_passthrough,
 		.destroy = sms_filter_chain_send_text_destroy,
 		.free = sms_filter_chain_send_text_free
@@ -437,7 +464,7 @@ static struct sms_filter_message *sms_filter_send_text_new
 		g_new0(struct sms_filter_chain_send_text, 1);
 
 	sms_filter_message_init(&send_msg->message, chain, &send_text_fn);
-	sms_filter_convert_sms_address(&send_msg->addr, addr);
+	send_msg->addr.sms = *addr;
 	send_msg->send = send;
 	send_msg->destroy = destroy;
 	send_msg->data = data;
@@ -477,11 +504,11 @@ static void sms_filter_chain_recv_text_process_cb
 			msg->text = g_strdup(text);
 		}
 		msg->cls = cls;
-		if (&msg->addr != addr) {
-			msg->addr = *addr;
+		if (&msg->addr.ofono != addr) {
+			msg->addr.ofono = *addr;
 		}
-		if (&msg->scts != scts) {
-			msg->scts = *scts;
+		if (&msg->scts.ofono != scts) {
+			msg->scts.ofono = *scts;
 		}
 	}
 
@@ -497,9 +524,27 @@ static guint sms_filter_chain_recv_text_process
 	struct sms_filter_chain *chain = msg->chain;
 
 	return filter->filter_recv_text(chain->modem, &recv_msg->uuid,
-			recv_msg->text, recv_msg->cls, &recv_msg->addr,
-			&recv_msg->scts, sms_filter_chain_recv_text_process_cb,
-			recv_msg);
+			recv_msg->text, recv_msg->cls, &recv_msg->addr.ofono,
+			&recv_msg->scts.ofono,
+			sms_filter_chain_recv_text_process_cb, recv_msg);
+}
+
+static gboolean sms_filter_chain_recv_text_can_check
+				(const struct ofono_sms_filter *filter)
+{
+	return filter->api_version >= 1 && filter->filter_recv_text_sync;
+}
+
+static enum ofono_sms_filter_result sms_filter_chain_recv_text_check
+				(const struct ofono_sms_filter *filter,
+					struct sms_filter_message *msg)
+{
+	struct sms_filter_chain_recv_text *recv_msg =
+		sms_filter_chain_recv_text_cast(msg);
+
+	return filter->filter_recv_text_sync(msg->chain->modem,
+			&recv_msg->uuid, recv_msg->text, recv_msg->cls,
+			&recv_msg->addr.ofono, &recv_msg->scts.ofono);
 }
 
 static void sms_filter_chain_recv_text_passthrough
@@ -509,14 +554,9 @@ static void sms_filter_chain_recv_text_passthrough
 		sms_filter_chain_recv_text_cast(msg);
 
 	if (recv_msg->default_handler) {
-		struct sms_filter_chain *chain = msg->chain;
-		struct sms_address addr;
-		struct sms_scts scts;
-
-		sms_filter_convert_sms_address_back(&addr, &recv_msg->addr);
-		sms_filter_convert_sms_scts_back(&scts, &recv_msg->scts);
-		recv_msg->default_handler(chain->sms, &recv_msg->uuid,
-				recv_msg->text, recv_msg->cls, &addr, &scts);
+		recv_msg->default_handler(msg->chain->sms, &recv_msg->uuid,
+				recv_msg->text, recv_msg->cls,
+				&recv_msg->addr.sms, &recv_msg->scts.sms);
 	}
 }
 
@@ -539,6 +579,8 @@ static struct sms_filter_message *sms_filter_chain_recv_text_new
 		.name = "incoming SMS text message",
 		.can_process = sms_filter_chain_recv_text_can_process,
 		.process = sms_filter_chain_recv_text_process,
+		.can_check = sms_filter_chain_recv_text_can_check,
+		.check = sms_filter_chain_recv_text_check,
 		.passthrough = sms_filter_chain_recv_text_passthrough,
 		.free = sms_filter_chain_recv_text_free
 	};
@@ -547,8 +589,8 @@ static struct sms_filter_message *sms_filter_chain_recv_text_new
 		g_new0(struct sms_filter_chain_recv_text, 1);
 
 	sms_filter_message_init(&recv_msg->message, chain, &recv_text_fn);
-	sms_filter_convert_sms_address(&recv_msg->addr, addr);
-	sms_filter_convert_sms_scts(&recv_msg->scts, scts);
+	recv_msg->addr.sms = *addr;
+	recv_msg->scts.sms = *scts;
 	recv_msg->default_handler = default_handler;
 	recv_msg->uuid = *uuid;
 	recv_msg->text = text;
@@ -590,11 +632,11 @@ static void sms_filter_chain_recv_datagram_process_cb
 			g_free(dg->buf);
 			dg->buf = g_memdup(buf, len);
 		}
-		if (&dg->addr != addr) {
-			dg->addr = *addr;
+		if (&dg->addr.ofono != addr) {
+			dg->addr.ofono = *addr;
 		}
-		if (&dg->scts != scts) {
-			dg->scts = *scts;
+		if (&dg->scts.ofono != scts) {
+			dg->scts.ofono = *scts;
 		}
 	}
 
@@ -611,10 +653,30 @@ static guint sms_filter_chain_recv_datagram_process
 
 	return filter->filter_recv_datagram(chain->modem, &recv_dg->uuid,
 			recv_dg->dst_port, recv_dg->src_port, recv_dg->buf,
-			recv_dg->len, &recv_dg->addr, &recv_dg->scts,
+			recv_dg->len, &recv_dg->addr.ofono,
+			&recv_dg->scts.ofono,
 			sms_filter_chain_recv_datagram_process_cb, recv_dg);
 }
 
+static gboolean sms_filter_chain_recv_datagram_can_check
+				(const struct ofono_sms_filter *filter)
+{
+	return filter->api_version >= 1 && filter->filter_recv_datagram_sync;
+}
+
+static enum ofono_sms_filter_result sms_filter_chain_recv_datagram_check
+				(const struct ofono_sms_filter *filter,
+					struct sms_filter_message *msg)
+{
+	struct sms_filter_chain_recv_datagram *recv_dg =
+		sms_filter_chain_recv_datagram_cast(msg);
+
+	return filter->filter_recv_datagram_sync(msg->chain->modem,
+			&recv_dg->uuid, recv_dg->dst_port, recv_dg->src_port,
+			recv_dg->buf, recv_dg->len, &recv_dg->addr.ofono,
+			&recv_dg->scts.ofono);
+}
+
 static void sms_filter_chain_recv_datagram_passthrough
 					(struct sms_filter_message *msg)
 {
@@ -622,15 +684,10 @@ static void sms_filter_chain_recv_datagram_passthrough
 		sms_filter_chain_recv_datagram_cast(msg);
 
 	if (recv_dg->default_handler) {
-		struct sms_filter_chain *chain = msg->chain;
-		struct sms_address addr;
-		struct sms_scts scts;
-
-		sms_filter_convert_sms_address_back(&addr, &recv_dg->addr);
-		sms_filter_convert_sms_scts_back(&scts, &recv_dg->scts);
-		recv_dg->default_handler(chain->sms, &recv_dg->uuid,
+		recv_dg->default_handler(msg->chain->sms, &recv_dg->uuid,
 				recv_dg->dst_port, recv_dg->src_port,
-				recv_dg->buf, recv_dg->len, &addr, &scts);
+				recv_dg->buf, recv_dg->len,
+				&recv_dg->addr.sms, &recv_dg->scts.sms);
 	}
 }
 
@@ -653,6 +710,8 @@ static struct sms_filter_message *sms_filter_chain_recv_datagram_new
 		.name = "incoming SMS datagram",
 		.can_process = sms_filter_chain_recv_datagram_can_process,
 		.process = sms_filter_chain_recv_datagram_process,
+		.can_check = sms_filter_chain_recv_datagram_can_check,
+		.check = sms_filter_chain_recv_datagram_check,
 		.passthrough = sms_filter_chain_recv_datagram_passthrough,
 		.free = sms_filter_chain_recv_datagram_free
 	};
@@ -661,8 +720,8 @@ static struct sms_filter_message *sms_filter_chain_recv_datagram_new
 		g_new0(struct sms_filter_chain_recv_datagram, 1);
 
 	sms_filter_message_init(&recv_dg->message, chain, &recv_datagram_fn);
-	sms_filter_convert_sms_address(&recv_dg->addr, addr);
-	sms_filter_convert_sms_scts(&recv_dg->scts, scts);
+	recv_dg->addr.sms = *addr;
+	recv_dg->scts.sms = *scts;
 	recv_dg->default_handler = default_handler;
 	recv_dg->uuid = *uuid;
 	recv_dg->dst_port = dst;
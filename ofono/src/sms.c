@@ -48,9 +48,13 @@
 #define SETTINGS_GROUP "Settings"
 
 #define TXQ_MAX_RETRIES 4
+#define TXQ_MAX_WINDOW 16
+#define TXQ_HIGH_WATERMARK 64
+#define TXQ_LOW_WATERMARK 16
 #define NETWORK_TIMEOUT 332
 
 static gboolean tx_next(gpointer user_data);
+static void tx_schedule_next(struct ofono_sms *sms);
 
 static GSList *g_drivers = NULL;
 
@@ -71,6 +75,9 @@ struct ofono_sms {
 	GQueue *txq;
 	unsigned long tx_counter;
 	guint tx_source;
+	GSList *tx_inflight;
+	unsigned int tx_window;
+	ofono_bool_t tx_congested;
 	struct ofono_message_waiting *mw;
 	unsigned int mw_watch;
 	ofono_bool_t registered;
@@ -91,16 +98,25 @@ struct ofono_sms {
 	struct ofono_watchlist *datagram_handlers;
 };
 
+enum pending_pdu_state {
+	PENDING_PDU_QUEUED = 0,
+	PENDING_PDU_IN_FLIGHT,
+	PENDING_PDU_SENT,
+};
+
 struct pending_pdu {
 	unsigned char pdu[176];
 	int tpdu_len;
 	int pdu_len;
+	enum pending_pdu_state state;
 };
 
 struct tx_queue_entry {
 	struct pending_pdu *pdus;
 	unsigned char num_pdus;
 	unsigned char cur_pdu;
+	unsigned char sent_pdus;
+	unsigned char inflight;
 	struct sms_address receiver;
 	struct ofono_uuid uuid;
 	unsigned int retry;
@@ -111,6 +127,17 @@ struct tx_queue_entry {
 	unsigned long id;
 };
 
+/*
+ * One of these is handed to the driver as the submit callback data, so
+ * that every +CMGS (or equivalent) reply can be matched with the queue
+ * entry and the PDU it belongs to, no matter how many are outstanding.
+ */
+struct tx_inflight {
+	struct ofono_sms *sms;
+	struct tx_queue_entry *entry;
+	unsigned char pdu;
+};
+
 static gboolean uuid_equal(gconstpointer v1, gconstpointer v2)
 {
 	return memcmp(v1, v2, OFONO_SHA1_UUID_LEN) == 0;
@@ -343,6 +370,8 @@ static DBusMessage *generate_get_properties_reply(struct ofono_sms *sms,
 	const char *sca;
 	const char *bearer;
 	const char *alphabet;
+	unsigned char window;
+	dbus_bool_t congested;
 
 	reply = dbus_message_new_method_return(msg);
 	if (reply == NULL)
@@ -368,6 +397,13 @@ static DBusMessage *generate_get_properties_reply(struct ofono_sms *sms,
 	alphabet = sms_alphabet_to_string(sms->alphabet);
 	ofono_dbus_dict_append(&dict, "Alphabet", DBUS_TYPE_STRING, &alphabet);
 
+	window = sms->tx_window;
+	ofono_dbus_dict_append(&dict, "SubmitWindow", DBUS_TYPE_BYTE, &window);
+
+	congested = sms->tx_congested;
+	ofono_dbus_dict_append(&dict, "Congested", DBUS_TYPE_BOOLEAN,
+				&congested);
+
 	dbus_message_iter_close_container(&iter, &dict);
 
 	return reply;
@@ -586,6 +622,32 @@ static DBusMessage *sms_set_property(DBusConnection *conn, DBusMessage *msg,
 		return NULL;
 	}
 
+	if (!strcmp(property, "SubmitWindow")) {
+		const char *path = __ofono_atom_get_path(sms->atom);
+		unsigned char value;
+
+		if (dbus_message_iter_get_arg_type(&var) != DBUS_TYPE_BYTE)
+			return __ofono_error_invalid_args(msg);
+
+		dbus_message_iter_get_basic(&var, &value);
+
+		if (value < 1 || value > TXQ_MAX_WINDOW)
+			return __ofono_error_invalid_format(msg);
+
+		g_dbus_send_reply(conn, msg, DBUS_TYPE_INVALID);
+
+		if (sms->tx_window != value) {
+			sms->tx_window = value;
+			ofono_dbus_signal_property_changed(conn, path,
+						OFONO_MESSAGE_MANAGER_INTERFACE,
+						"SubmitWindow",
+						DBUS_TYPE_BYTE, &value);
+			tx_schedule_next(sms);
+		}
+
+		return NULL;
+	}
+
 	if (!strcmp(property, "Alphabet")) {
 		const char *value;
 		enum sms_alphabet alphabet;
@@ -627,16 +689,51 @@ static void tx_queue_entry_destroy_foreach(gpointer _entry, gpointer unused)
 	tx_queue_entry_destroy(_entry);
 }
 
+static void sms_txq_update_congestion(struct ofono_sms *sms)
+{
+	DBusConnection *conn = ofono_dbus_get_connection();
+	const char *path = __ofono_atom_get_path(sms->atom);
+	unsigned int len = g_queue_get_length(sms->txq);
+	dbus_bool_t value;
+
+	if (sms->tx_congested == FALSE && len >= TXQ_HIGH_WATERMARK)
+		sms->tx_congested = TRUE;
+	else if (sms->tx_congested == TRUE && len <= TXQ_LOW_WATERMARK)
+		sms->tx_congested = FALSE;
+	else
+		return;
+
+	DBG("congested: %d (%u queued)", sms->tx_congested, len);
+
+	value = sms->tx_congested;
+	ofono_dbus_signal_property_changed(conn, path,
+					OFONO_MESSAGE_MANAGER_INTERFACE,
+					"Congested", DBUS_TYPE_BOOLEAN, &value);
+}
+
 static void sms_tx_queue_remove_entry(struct ofono_sms *sms, GList *entry_list,
 					enum message_state tx_state)
 {
 	struct tx_queue_entry *entry = entry_list->data;
 	struct ofono_modem *modem = __ofono_atom_get_modem(sms->atom);
+	GSList *l;
 
 	g_queue_delete_link(sms->txq, entry_list);
 
 	DBG("%p", entry);
 
+	/* Replies for PDUs still in flight are going to be ignored */
+	for (l = sms->tx_inflight; l && entry->inflight; l = l->next) {
+		struct tx_inflight *tx = l->data;
+
+		if (tx->entry == entry) {
+			tx->entry = NULL;
+			entry->inflight -= 1;
+		}
+	}
+
+	sms_txq_update_congestion(sms);
+
 	if (entry->cb)
 		entry->cb(tx_state == MESSAGE_STATE_SENT, entry->data);
 
@@ -683,22 +780,68 @@ done:
 	tx_queue_entry_destroy(entry);
 }
 
+/*
+ * Put a PDU back into the queue so that tx_next() submits it again.
+ * PDUs are always picked starting at cur_pdu, anything past it that is
+ * already in flight or sent is skipped.
+ */
+static void tx_requeue_pdu(struct tx_queue_entry *entry, unsigned char pdu)
+{
+	entry->pdus[pdu].state = PENDING_PDU_QUEUED;
+
+	if (pdu < entry->cur_pdu)
+		entry->cur_pdu = pdu;
+}
+
+static void tx_schedule_next(struct ofono_sms *sms)
+{
+	if (sms->registered == FALSE)
+		return;
+
+	if (sms->tx_source > 0)
+		return;
+
+	if (g_queue_peek_head(sms->txq) == NULL)
+		return;
+
+	if (g_slist_length(sms->tx_inflight) >= sms->tx_window)
+		return;
+
+	DBG("Scheduling next");
+	sms->tx_source = g_timeout_add(0, tx_next, sms);
+}
+
 static void tx_finished(const struct ofono_error *error, int mr, void *data)
 {
-	struct ofono_sms *sms = data;
-	struct tx_queue_entry *entry = g_queue_peek_head(sms->txq);
+	struct tx_inflight *tx = data;
+	struct ofono_sms *sms = tx->sms;
+	struct tx_queue_entry *entry = tx->entry;
+	unsigned char pdu = tx->pdu;
 	gboolean ok = error->type == OFONO_ERROR_TYPE_NO_ERROR;
 	enum message_state tx_state;
+	GList *entry_list;
+
+	DBG("tx_finished %p pdu %u mr %d", entry, pdu, mr);
+
+	sms->tx_inflight = g_slist_remove(sms->tx_inflight, tx);
+	g_free(tx);
 
-	DBG("tx_finished %p", entry);
+	if (sms->tx_inflight == NULL)
+		sms->flags &= ~MESSAGE_MANAGER_FLAG_TXQ_ACTIVE;
 
-	sms->flags &= ~MESSAGE_MANAGER_FLAG_TXQ_ACTIVE;
+	/* Entry was removed while this PDU was being submitted */
+	if (entry == NULL)
+		goto out;
+
+	entry->inflight -= 1;
 
 	if (ok == FALSE) {
 		/* Retry again when back in online mode */
 		/* Note this does not increment retry count */
-		if (sms->registered == FALSE)
+		if (sms->registered == FALSE) {
+			tx_requeue_pdu(entry, pdu);
 			return;
+		}
 
 		tx_state = MESSAGE_STATE_FAILED;
 
@@ -715,6 +858,12 @@ static void tx_finished(const struct ofono_error *error, int mr, void *data)
 		if (entry->retry < TXQ_MAX_RETRIES) {
 			DBG("Sending failed, retry in %d secs",
 					entry->retry * 5);
+
+			tx_requeue_pdu(entry, pdu);
+
+			if (sms->tx_source)
+				g_source_remove(sms->tx_source);
+
 			sms->tx_source = g_timeout_add_seconds(entry->retry * 5,
 								tx_next, sms);
 			return;
@@ -727,9 +876,10 @@ static void tx_finished(const struct ofono_error *error, int mr, void *data)
 	if (entry->flags & OFONO_SMS_SUBMIT_FLAG_EXPOSE_DBUS)
 		sms_tx_backup_remove(sms->imsi, entry->id, entry->flags,
 						ofono_uuid_to_str(&entry->uuid),
-						entry->cur_pdu);
+						pdu);
 
-	entry->cur_pdu += 1;
+	entry->pdus[pdu].state = PENDING_PDU_SENT;
+	entry->sent_pdus += 1;
 	entry->retry = 0;
 
 	if (entry->flags & OFONO_SMS_SUBMIT_FLAG_REQUEST_SR)
@@ -739,48 +889,92 @@ static void tx_finished(const struct ofono_error *error, int mr, void *data)
 							mr, time(NULL),
 							entry->num_pdus);
 
-	if (entry->cur_pdu < entry->num_pdus) {
-		sms->tx_source = g_timeout_add(0, tx_next, sms);
-		return;
-	}
+	if (entry->sent_pdus < entry->num_pdus)
+		goto out;
 
 	tx_state = MESSAGE_STATE_SENT;
 
 next_q:
-	sms_tx_queue_remove_entry(sms, g_queue_peek_head_link(sms->txq),
-					tx_state);
-
-	if (sms->registered == FALSE)
-		return;
+	entry_list = g_queue_find(sms->txq, entry);
+	sms_tx_queue_remove_entry(sms, entry_list, tx_state);
 
-	if (g_queue_peek_head(sms->txq)) {
-		DBG("Scheduling next");
-		sms->tx_source = g_timeout_add(0, tx_next, sms);
-	}
+out:
+	tx_schedule_next(sms);
 }
 
-static gboolean tx_next(gpointer user_data)
+static void tx_submit(struct ofono_sms *sms, GList *entry_list)
 {
-	struct ofono_sms *sms = user_data;
-	int send_mms = 0;
-	struct tx_queue_entry *entry = g_queue_peek_head(sms->txq);
+	struct tx_queue_entry *entry = entry_list->data;
 	struct pending_pdu *pdu = &entry->pdus[entry->cur_pdu];
+	struct tx_inflight *tx;
+	int send_mms = 0;
+	unsigned char i;
 
-	DBG("tx_next: %p", entry);
+	tx = g_new0(struct tx_inflight, 1);
+	tx->sms = sms;
+	tx->entry = entry;
+	tx->pdu = entry->cur_pdu;
 
-	sms->tx_source = 0;
+	pdu->state = PENDING_PDU_IN_FLIGHT;
+	entry->inflight += 1;
 
-	if (sms->registered == FALSE)
-		return FALSE;
+	/* Advance to the next PDU still waiting to be submitted */
+	for (i = entry->cur_pdu + 1; i < entry->num_pdus; i++)
+		if (entry->pdus[i].state == PENDING_PDU_QUEUED)
+			break;
 
-	if (g_queue_get_length(sms->txq) > 1
-			|| (entry->num_pdus - entry->cur_pdu) > 1)
+	entry->cur_pdu = i;
+
+	/* Keep the link up while there is more to send (TP-MMS) */
+	if (entry_list->next || entry->cur_pdu < entry->num_pdus)
 		send_mms = 1;
 
+	sms->tx_inflight = g_slist_append(sms->tx_inflight, tx);
 	sms->flags |= MESSAGE_MANAGER_FLAG_TXQ_ACTIVE;
 
+	DBG("entry %p pdu %u mms %d", entry, tx->pdu, send_mms);
+
 	sms->driver->submit(sms, pdu->pdu, pdu->pdu_len, pdu->tpdu_len,
-				send_mms, tx_finished, sms);
+				send_mms, tx_finished, tx);
+}
+
+static GList *tx_first_queued(struct ofono_sms *sms)
+{
+	GList *l;
+
+	for (l = g_queue_peek_head_link(sms->txq); l; l = l->next) {
+		struct tx_queue_entry *entry = l->data;
+
+		if (entry->cur_pdu < entry->num_pdus)
+			return l;
+	}
+
+	return NULL;
+}
+
+/*
+ * Submit queued PDUs, in queue order, until the in-flight window is
+ * full.  With the default window of one this is the classic stop and
+ * wait behaviour.  The queue is walked again after every submission
+ * as the driver may complete (and so dequeue) synchronously.
+ */
+static gboolean tx_next(gpointer user_data)
+{
+	struct ofono_sms *sms = user_data;
+	GList *l;
+
+	DBG("tx_next: %p", g_queue_peek_head(sms->txq));
+
+	sms->tx_source = 0;
+
+	while (sms->registered && sms->tx_source == 0 &&
+			g_slist_length(sms->tx_inflight) < sms->tx_window) {
+		l = tx_first_queued(sms);
+		if (l == NULL)
+			break;
+
+		tx_submit(sms, l);
+	}
 
 	return FALSE;
 }
@@ -1133,16 +1327,14 @@ int __ofono_sms_txq_cancel(struct ofono_sms *sms, const struct ofono_uuid *uuid)
 
 	entry = l->data;
 
-	if (entry == g_queue_peek_head(sms->txq)) {
-		/*
-		 * Fail if any pdu was already transmitted or if we are
-		 * waiting the answer from driver.
-		 */
-		if (entry->cur_pdu > 0)
-			return -EPERM;
+	/*
+	 * Fail if any pdu was already transmitted or if we are
+	 * waiting the answer from driver.
+	 */
+	if (entry->sent_pdus > 0 || entry->inflight > 0)
+		return -EPERM;
 
-		if (sms->flags & MESSAGE_MANAGER_FLAG_TXQ_ACTIVE)
-			return -EPERM;
+	if (entry == g_queue_peek_head(sms->txq)) {
 		/*
 		 * Make sure we don't call tx_next() if there are no entries
 		 * and that next entry doesn't have to wait a 'retry time'
@@ -1803,6 +1995,9 @@ static void sms_remove(struct ofono_atom *atom)
 		sms->tx_source = 0;
 	}
 
+	g_slist_free_full(sms->tx_inflight, g_free);
+	sms->tx_inflight = NULL;
+
 	if (sms->assembly) {
 		sms_assembly_free(sms->assembly);
 		sms->assembly = NULL;
@@ -1824,6 +2019,8 @@ static void sms_remove(struct ofono_atom *atom)
 					"Bearer", sms->bearer);
 		g_key_file_set_integer(sms->settings, SETTINGS_GROUP,
 					"Alphabet", sms->alphabet);
+		g_key_file_set_integer(sms->settings, SETTINGS_GROUP,
+					"SubmitWindow", sms->tx_window);
 
 		storage_close(sms->imsi, SETTINGS_STORE, sms->settings, TRUE);
 
@@ -1869,6 +2066,7 @@ struct ofono_sms *ofono_sms_create(struct ofono_modem *modem,
 
 	sms->sca.type = 129;
 	sms->ref = 1;
+	sms->tx_window = 1;
 	sms->txq = g_queue_new();
 	sms->messages = g_hash_table_new(uuid_hash, uuid_equal);
 
@@ -1961,6 +2159,17 @@ static void sms_load_settings(struct ofono_sms *sms, const char *imsi)
 		g_key_file_set_integer(sms->settings, SETTINGS_GROUP,
 					"Alphabet", sms->alphabet);
 	}
+
+	error = NULL;
+	sms->tx_window = g_key_file_get_integer(sms->settings, SETTINGS_GROUP,
+						"SubmitWindow", &error);
+
+	if (error || sms->tx_window < 1 || sms->tx_window > TXQ_MAX_WINDOW) {
+		g_error_free(error);
+		sms->tx_window = 1;
+		g_key_file_set_integer(sms->settings, SETTINGS_GROUP,
+					"SubmitWindow", sms->tx_window);
+	}
 }
 
 static void bearer_init_callback(const struct ofono_error *error, void *data)
@@ -2148,8 +2357,10 @@ int __ofono_sms_txq_submit(struct ofono_sms *sms, GSList *list,
 	entry->id = sms->tx_counter++;
 
 	g_queue_push_tail(sms->txq, entry);
+	sms_txq_update_congestion(sms);
 
-	if (sms->registered && g_queue_get_length(sms->txq) == 1)
+	if (sms->registered && sms->tx_source == 0 &&
+			g_slist_length(sms->tx_inflight) < sms->tx_window)
 		sms->tx_source = g_timeout_add(100, tx_next, sms);
 
 	if (uuid)
@@ -458,6 +458,30 @@ static void stk_menu_free(struct stk_menu *menu)
 	g_free(menu);
 }
 
+/*
+ * Reads every icon of the menu from the SIM in one go, so that they are
+ * rendered by the time the agent asks for them one by one.
+ */
+static void stk_menu_prefetch_icons(struct ofono_stk *stk,
+					const struct stk_menu *menu)
+{
+	struct ofono_modem *modem = __ofono_atom_get_modem(stk->atom);
+	struct ofono_sim *sim = __ofono_atom_find(OFONO_ATOM_TYPE_SIM, modem);
+	const struct stk_menu_item *item;
+	unsigned char ids[256];
+	unsigned int n = 0;
+
+	if (sim == NULL)
+		return;
+
+	ids[n++] = menu->icon.id;
+
+	for (item = menu->items; item->text && n < sizeof(ids); item++)
+		ids[n++] = item->icon_id;
+
+	__ofono_sim_prefetch_icons(sim, ids, n);
+}
+
 static void emit_menu_changed(struct ofono_stk *stk)
 {
 	static struct stk_menu_item end_item = {};
@@ -1226,6 +1250,9 @@ static gboolean handle_command_set_up_menu(const struct stk_command *cmd,
 
 	stk->main_menu = menu;
 
+	if (menu)
+		stk_menu_prefetch_icons(stk, menu);
+
 	emit_menu_changed(stk);
 
 	return TRUE;
@@ -1290,6 +1317,8 @@ static gboolean handle_command_select_item(const struct stk_command *cmd,
 		return TRUE;
 	}
 
+	stk_menu_prefetch_icons(stk, stk->select_item_menu);
+
 	/* We most likely got an out of memory error, tell SIM to retry */
 	if (stk_agent_request_selection(stk->current_agent,
 					stk->select_item_menu,
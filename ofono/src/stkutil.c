@@ -42,6 +42,12 @@ enum stk_data_object_flag {
 	DATAOBJ_FLAG_LIST =		8,
 };
 
+/* Longest list of data objects a command is parsed with */
+#define MAX_DATAOBJ_ENTRIES 16
+
+/* A SET UP MENU fits about 60 items, see parse_item_list */
+#define MAX_ITEMS 128
+
 struct stk_file_iter {
 	const unsigned char *start;
 	unsigned int pos;
@@ -2064,199 +2070,166 @@ static gboolean parse_dataobj_broadcast_network_info(
 	return TRUE;
 }
 
+/* Simple data object handlers, indexed by tag */
+static const dataobj_handler dataobj_handlers[] = {
+	[STK_DATA_OBJECT_TYPE_ADDRESS] = parse_dataobj_address,
+	[STK_DATA_OBJECT_TYPE_ALPHA_ID] = parse_dataobj_alpha_id,
+	[STK_DATA_OBJECT_TYPE_SUBADDRESS] = parse_dataobj_subaddress,
+	[STK_DATA_OBJECT_TYPE_CCP] = parse_dataobj_ccp,
+	[STK_DATA_OBJECT_TYPE_CBS_PAGE] = parse_dataobj_cbs_page,
+	[STK_DATA_OBJECT_TYPE_DURATION] = parse_dataobj_duration,
+	[STK_DATA_OBJECT_TYPE_ITEM] = parse_dataobj_item,
+	[STK_DATA_OBJECT_TYPE_ITEM_ID] = parse_dataobj_item_id,
+	[STK_DATA_OBJECT_TYPE_RESPONSE_LENGTH] = parse_dataobj_response_len,
+	[STK_DATA_OBJECT_TYPE_RESULT] = parse_dataobj_result,
+	[STK_DATA_OBJECT_TYPE_GSM_SMS_TPDU] = parse_dataobj_gsm_sms_tpdu,
+	[STK_DATA_OBJECT_TYPE_SS_STRING] = parse_dataobj_ss,
+	[STK_DATA_OBJECT_TYPE_TEXT] = parse_dataobj_text,
+	[STK_DATA_OBJECT_TYPE_TONE] = parse_dataobj_tone,
+	[STK_DATA_OBJECT_TYPE_USSD_STRING] = parse_dataobj_ussd,
+	[STK_DATA_OBJECT_TYPE_FILE_LIST] = parse_dataobj_file_list,
+	[STK_DATA_OBJECT_TYPE_LOCATION_INFO] = parse_dataobj_location_info,
+	[STK_DATA_OBJECT_TYPE_IMEI] = parse_dataobj_imei,
+	[STK_DATA_OBJECT_TYPE_HELP_REQUEST] = parse_dataobj_help_request,
+	[STK_DATA_OBJECT_TYPE_NETWORK_MEASUREMENT_RESULTS] =
+				parse_dataobj_network_measurement_results,
+	[STK_DATA_OBJECT_TYPE_DEFAULT_TEXT] = parse_dataobj_default_text,
+	[STK_DATA_OBJECT_TYPE_ITEMS_NEXT_ACTION_INDICATOR] =
+				parse_dataobj_items_next_action_indicator,
+	[STK_DATA_OBJECT_TYPE_EVENT_LIST] = parse_dataobj_event_list,
+	[STK_DATA_OBJECT_TYPE_CAUSE] = parse_dataobj_cause,
+	[STK_DATA_OBJECT_TYPE_LOCATION_STATUS] = parse_dataobj_location_status,
+	[STK_DATA_OBJECT_TYPE_TRANSACTION_ID] = parse_dataobj_transaction_id,
+	[STK_DATA_OBJECT_TYPE_BCCH_CHANNEL_LIST] =
+				parse_dataobj_bcch_channel_list,
+	[STK_DATA_OBJECT_TYPE_CALL_CONTROL_REQUESTED_ACTION] =
+				parse_dataobj_call_control_requested_action,
+	[STK_DATA_OBJECT_TYPE_ICON_ID] = parse_dataobj_icon_id,
+	[STK_DATA_OBJECT_TYPE_ITEM_ICON_ID_LIST] =
+				parse_dataobj_item_icon_id_list,
+	[STK_DATA_OBJECT_TYPE_CARD_READER_STATUS] =
+				parse_dataobj_card_reader_status,
+	[STK_DATA_OBJECT_TYPE_CARD_ATR] = parse_dataobj_card_atr,
+	[STK_DATA_OBJECT_TYPE_C_APDU] = parse_dataobj_c_apdu,
+	[STK_DATA_OBJECT_TYPE_R_APDU] = parse_dataobj_r_apdu,
+	[STK_DATA_OBJECT_TYPE_TIMER_ID] = parse_dataobj_timer_id,
+	[STK_DATA_OBJECT_TYPE_TIMER_VALUE] = parse_dataobj_timer_value,
+	[STK_DATA_OBJECT_TYPE_DATETIME_TIMEZONE] =
+				parse_dataobj_datetime_timezone,
+	[STK_DATA_OBJECT_TYPE_AT_COMMAND] = parse_dataobj_at_command,
+	[STK_DATA_OBJECT_TYPE_AT_RESPONSE] = parse_dataobj_at_response,
+	[STK_DATA_OBJECT_TYPE_BC_REPEAT_INDICATOR] =
+				parse_dataobj_bc_repeat_indicator,
+	[STK_DATA_OBJECT_TYPE_IMMEDIATE_RESPONSE] = parse_dataobj_imm_resp,
+	[STK_DATA_OBJECT_TYPE_DTMF_STRING] = parse_dataobj_dtmf_string,
+	[STK_DATA_OBJECT_TYPE_LANGUAGE] = parse_dataobj_language,
+	[STK_DATA_OBJECT_TYPE_BROWSER_ID] = parse_dataobj_browser_id,
+	[STK_DATA_OBJECT_TYPE_TIMING_ADVANCE] = parse_dataobj_timing_advance,
+	[STK_DATA_OBJECT_TYPE_URL] = parse_dataobj_url,
+	[STK_DATA_OBJECT_TYPE_BEARER] = parse_dataobj_bearer,
+	[STK_DATA_OBJECT_TYPE_PROVISIONING_FILE_REF] =
+				parse_dataobj_provisioning_file_reference,
+	[STK_DATA_OBJECT_TYPE_BROWSER_TERMINATION_CAUSE] =
+				parse_dataobj_browser_termination_cause,
+	[STK_DATA_OBJECT_TYPE_BEARER_DESCRIPTION] =
+				parse_dataobj_bearer_description,
+	[STK_DATA_OBJECT_TYPE_CHANNEL_DATA] = parse_dataobj_channel_data,
+	[STK_DATA_OBJECT_TYPE_CHANNEL_DATA_LENGTH] =
+				parse_dataobj_channel_data_length,
+	[STK_DATA_OBJECT_TYPE_BUFFER_SIZE] = parse_dataobj_buffer_size,
+	[STK_DATA_OBJECT_TYPE_CHANNEL_STATUS] = parse_dataobj_channel_status,
+	[STK_DATA_OBJECT_TYPE_CARD_READER_ID] = parse_dataobj_card_reader_id,
+	[STK_DATA_OBJECT_TYPE_OTHER_ADDRESS] = parse_dataobj_other_address,
+	[STK_DATA_OBJECT_TYPE_UICC_TE_INTERFACE] =
+				parse_dataobj_uicc_te_interface,
+	[STK_DATA_OBJECT_TYPE_AID] = parse_dataobj_aid,
+	[STK_DATA_OBJECT_TYPE_ACCESS_TECHNOLOGY] =
+				parse_dataobj_access_technology,
+	[STK_DATA_OBJECT_TYPE_DISPLAY_PARAMETERS] =
+				parse_dataobj_display_parameters,
+	[STK_DATA_OBJECT_TYPE_SERVICE_RECORD] = parse_dataobj_service_record,
+	[STK_DATA_OBJECT_TYPE_DEVICE_FILTER] = parse_dataobj_device_filter,
+	[STK_DATA_OBJECT_TYPE_SERVICE_SEARCH] = parse_dataobj_service_search,
+	[STK_DATA_OBJECT_TYPE_ATTRIBUTE_INFO] = parse_dataobj_attribute_info,
+	[STK_DATA_OBJECT_TYPE_SERVICE_AVAILABILITY] =
+				parse_dataobj_service_availability,
+	[STK_DATA_OBJECT_TYPE_REMOTE_ENTITY_ADDRESS] =
+				parse_dataobj_remote_entity_address,
+	[STK_DATA_OBJECT_TYPE_ESN] = parse_dataobj_esn,
+	[STK_DATA_OBJECT_TYPE_NETWORK_ACCESS_NAME] =
+				parse_dataobj_network_access_name,
+	[STK_DATA_OBJECT_TYPE_CDMA_SMS_TPDU] = parse_dataobj_cdma_sms_tpdu,
+	[STK_DATA_OBJECT_TYPE_TEXT_ATTRIBUTE] = parse_dataobj_text_attr,
+	[STK_DATA_OBJECT_TYPE_PDP_ACTIVATION_PARAMETER] =
+				parse_dataobj_pdp_act_par,
+	[STK_DATA_OBJECT_TYPE_ITEM_TEXT_ATTRIBUTE_LIST] =
+				parse_dataobj_item_text_attribute_list,
+	[STK_DATA_OBJECT_TYPE_UTRAN_MEASUREMENT_QUALIFIER] =
+				parse_dataobj_utran_meas_qualifier,
+	[STK_DATA_OBJECT_TYPE_IMEISV] = parse_dataobj_imeisv,
+	[STK_DATA_OBJECT_TYPE_NETWORK_SEARCH_MODE] =
+				parse_dataobj_network_search_mode,
+	[STK_DATA_OBJECT_TYPE_BATTERY_STATE] = parse_dataobj_battery_state,
+	[STK_DATA_OBJECT_TYPE_BROWSING_STATUS] = parse_dataobj_browsing_status,
+	[STK_DATA_OBJECT_TYPE_FRAME_LAYOUT] = parse_dataobj_frame_layout,
+	[STK_DATA_OBJECT_TYPE_FRAMES_INFO] = parse_dataobj_frames_info,
+	[STK_DATA_OBJECT_TYPE_FRAME_ID] = parse_dataobj_frame_id,
+	[STK_DATA_OBJECT_TYPE_MEID] = parse_dataobj_meid,
+	[STK_DATA_OBJECT_TYPE_MMS_REFERENCE] = parse_dataobj_mms_reference,
+	[STK_DATA_OBJECT_TYPE_MMS_ID] = parse_dataobj_mms_id,
+	[STK_DATA_OBJECT_TYPE_MMS_TRANSFER_STATUS] =
+				parse_dataobj_mms_transfer_status,
+	[STK_DATA_OBJECT_TYPE_MMS_CONTENT_ID] = parse_dataobj_mms_content_id,
+	[STK_DATA_OBJECT_TYPE_MMS_NOTIFICATION] =
+				parse_dataobj_mms_notification,
+	[STK_DATA_OBJECT_TYPE_LAST_ENVELOPE] = parse_dataobj_last_envelope,
+	[STK_DATA_OBJECT_TYPE_REGISTRY_APPLICATION_DATA] =
+				parse_dataobj_registry_application_data,
+	[STK_DATA_OBJECT_TYPE_ACTIVATE_DESCRIPTOR] =
+				parse_dataobj_activate_descriptor,
+	[STK_DATA_OBJECT_TYPE_BROADCAST_NETWORK_INFO] =
+				parse_dataobj_broadcast_network_info,
+};
+
 static dataobj_handler handler_for_type(enum stk_data_object_type type)
 {
-	switch (type) {
-	case STK_DATA_OBJECT_TYPE_ADDRESS:
-		return parse_dataobj_address;
-	case STK_DATA_OBJECT_TYPE_ALPHA_ID:
-		return parse_dataobj_alpha_id;
-	case STK_DATA_OBJECT_TYPE_SUBADDRESS:
-		return parse_dataobj_subaddress;
-	case STK_DATA_OBJECT_TYPE_CCP:
-		return parse_dataobj_ccp;
-	case STK_DATA_OBJECT_TYPE_CBS_PAGE:
-		return parse_dataobj_cbs_page;
-	case STK_DATA_OBJECT_TYPE_DURATION:
-		return parse_dataobj_duration;
-	case STK_DATA_OBJECT_TYPE_ITEM:
-		return parse_dataobj_item;
-	case STK_DATA_OBJECT_TYPE_ITEM_ID:
-		return parse_dataobj_item_id;
-	case STK_DATA_OBJECT_TYPE_RESPONSE_LENGTH:
-		return parse_dataobj_response_len;
-	case STK_DATA_OBJECT_TYPE_RESULT:
-		return parse_dataobj_result;
-	case STK_DATA_OBJECT_TYPE_GSM_SMS_TPDU:
-		return parse_dataobj_gsm_sms_tpdu;
-	case STK_DATA_OBJECT_TYPE_SS_STRING:
-		return parse_dataobj_ss;
-	case STK_DATA_OBJECT_TYPE_TEXT:
-		return parse_dataobj_text;
-	case STK_DATA_OBJECT_TYPE_TONE:
-		return parse_dataobj_tone;
-	case STK_DATA_OBJECT_TYPE_USSD_STRING:
-		return parse_dataobj_ussd;
-	case STK_DATA_OBJECT_TYPE_FILE_LIST:
-		return parse_dataobj_file_list;
-	case STK_DATA_OBJECT_TYPE_LOCATION_INFO:
-		return parse_dataobj_location_info;
-	case STK_DATA_OBJECT_TYPE_IMEI:
-		return parse_dataobj_imei;
-	case STK_DATA_OBJECT_TYPE_HELP_REQUEST:
-		return parse_dataobj_help_request;
-	case STK_DATA_OBJECT_TYPE_NETWORK_MEASUREMENT_RESULTS:
-		return parse_dataobj_network_measurement_results;
-	case STK_DATA_OBJECT_TYPE_DEFAULT_TEXT:
-		return parse_dataobj_default_text;
-	case STK_DATA_OBJECT_TYPE_ITEMS_NEXT_ACTION_INDICATOR:
-		return parse_dataobj_items_next_action_indicator;
-	case STK_DATA_OBJECT_TYPE_EVENT_LIST:
-		return parse_dataobj_event_list;
-	case STK_DATA_OBJECT_TYPE_CAUSE:
-		return parse_dataobj_cause;
-	case STK_DATA_OBJECT_TYPE_LOCATION_STATUS:
-		return parse_dataobj_location_status;
-	case STK_DATA_OBJECT_TYPE_TRANSACTION_ID:
-		return parse_dataobj_transaction_id;
-	case STK_DATA_OBJECT_TYPE_BCCH_CHANNEL_LIST:
-		return parse_dataobj_bcch_channel_list;
-	case STK_DATA_OBJECT_TYPE_CALL_CONTROL_REQUESTED_ACTION:
-		return parse_dataobj_call_control_requested_action;
-	case STK_DATA_OBJECT_TYPE_ICON_ID:
-		return parse_dataobj_icon_id;
-	case STK_DATA_OBJECT_TYPE_ITEM_ICON_ID_LIST:
-		return parse_dataobj_item_icon_id_list;
-	case STK_DATA_OBJECT_TYPE_CARD_READER_STATUS:
-		return parse_dataobj_card_reader_status;
-	case STK_DATA_OBJECT_TYPE_CARD_ATR:
-		return parse_dataobj_card_atr;
-	case STK_DATA_OBJECT_TYPE_C_APDU:
-		return parse_dataobj_c_apdu;
-	case STK_DATA_OBJECT_TYPE_R_APDU:
-		return parse_dataobj_r_apdu;
-	case STK_DATA_OBJECT_TYPE_TIMER_ID:
-		return parse_dataobj_timer_id;
-	case STK_DATA_OBJECT_TYPE_TIMER_VALUE:
-		return parse_dataobj_timer_value;
-	case STK_DATA_OBJECT_TYPE_DATETIME_TIMEZONE:
-		return parse_dataobj_datetime_timezone;
-	case STK_DATA_OBJECT_TYPE_AT_COMMAND:
-		return parse_dataobj_at_command;
-	case STK_DATA_OBJECT_TYPE_AT_RESPONSE:
-		return parse_dataobj_at_response;
-	case STK_DATA_OBJECT_TYPE_BC_REPEAT_INDICATOR:
-		return parse_dataobj_bc_repeat_indicator;
-	case STK_DATA_OBJECT_TYPE_IMMEDIATE_RESPONSE:
-		return parse_dataobj_imm_resp;
-	case STK_DATA_OBJECT_TYPE_DTMF_STRING:
-		return parse_dataobj_dtmf_string;
-	case STK_DATA_OBJECT_TYPE_LANGUAGE:
-		return parse_dataobj_language;
-	case STK_DATA_OBJECT_TYPE_BROWSER_ID:
-		return parse_dataobj_browser_id;
-	case STK_DATA_OBJECT_TYPE_TIMING_ADVANCE:
-		return parse_dataobj_timing_advance;
-	case STK_DATA_OBJECT_TYPE_URL:
-		return parse_dataobj_url;
-	case STK_DATA_OBJECT_TYPE_BEARER:
-		return parse_dataobj_bearer;
-	case STK_DATA_OBJECT_TYPE_PROVISIONING_FILE_REF:
-		return parse_dataobj_provisioning_file_reference;
-	case STK_DATA_OBJECT_TYPE_BROWSER_TERMINATION_CAUSE:
-		return parse_dataobj_browser_termination_cause;
-	case STK_DATA_OBJECT_TYPE_BEARER_DESCRIPTION:
-		return parse_dataobj_bearer_description;
-	case STK_DATA_OBJECT_TYPE_CHANNEL_DATA:
-		return parse_dataobj_channel_data;
-	case STK_DATA_OBJECT_TYPE_CHANNEL_DATA_LENGTH:
-		return parse_dataobj_channel_data_length;
-	case STK_DATA_OBJECT_TYPE_BUFFER_SIZE:
-		return parse_dataobj_buffer_size;
-	case STK_DATA_OBJECT_TYPE_CHANNEL_STATUS:
-		return parse_dataobj_channel_status;
-	case STK_DATA_OBJECT_TYPE_CARD_READER_ID:
-		return parse_dataobj_card_reader_id;
-	case STK_DATA_OBJECT_TYPE_OTHER_ADDRESS:
-		return parse_dataobj_other_address;
-	case STK_DATA_OBJECT_TYPE_UICC_TE_INTERFACE:
-		return parse_dataobj_uicc_te_interface;
-	case STK_DATA_OBJECT_TYPE_AID:
-		return parse_dataobj_aid;
-	case STK_DATA_OBJECT_TYPE_ACCESS_TECHNOLOGY:
-		return parse_dataobj_access_technology;
-	case STK_DATA_OBJECT_TYPE_DISPLAY_PARAMETERS:
-		return parse_dataobj_display_parameters;
-	case STK_DATA_OBJECT_TYPE_SERVICE_RECORD:
-		return parse_dataobj_service_record;
-	case STK_DATA_OBJECT_TYPE_DEVICE_FILTER:
-		return parse_dataobj_device_filter;
-	case STK_DATA_OBJECT_TYPE_SERVICE_SEARCH:
-		return parse_dataobj_service_search;
-	case STK_DATA_OBJECT_TYPE_ATTRIBUTE_INFO:
-		return parse_dataobj_attribute_info;
-	case STK_DATA_OBJECT_TYPE_SERVICE_AVAILABILITY:
-		return parse_dataobj_service_availability;
-	case STK_DATA_OBJECT_TYPE_REMOTE_ENTITY_ADDRESS:
-		return parse_dataobj_remote_entity_address;
-	case STK_DATA_OBJECT_TYPE_ESN:
-		return parse_dataobj_esn;
-	case STK_DATA_OBJECT_TYPE_NETWORK_ACCESS_NAME:
-		return parse_dataobj_network_access_name;
-	case STK_DATA_OBJECT_TYPE_CDMA_SMS_TPDU:
-		return parse_dataobj_cdma_sms_tpdu;
-	case STK_DATA_OBJECT_TYPE_TEXT_ATTRIBUTE:
-		return parse_dataobj_text_attr;
-	case STK_DATA_OBJECT_TYPE_PDP_ACTIVATION_PARAMETER:
-		return parse_dataobj_pdp_act_par;
-	case STK_DATA_OBJECT_TYPE_ITEM_TEXT_ATTRIBUTE_LIST:
-		return parse_dataobj_item_text_attribute_list;
-	case STK_DATA_OBJECT_TYPE_UTRAN_MEASUREMENT_QUALIFIER:
-		return parse_dataobj_utran_meas_qualifier;
-	case STK_DATA_OBJECT_TYPE_IMEISV:
-		return parse_dataobj_imeisv;
-	case STK_DATA_OBJECT_TYPE_NETWORK_SEARCH_MODE:
-		return parse_dataobj_network_search_mode;
-	case STK_DATA_OBJECT_TYPE_BATTERY_STATE:
-		return parse_dataobj_battery_state;
-	case STK_DATA_OBJECT_TYPE_BROWSING_STATUS:
-		return parse_dataobj_browsing_status;
-	case STK_DATA_OBJECT_TYPE_FRAME_LAYOUT:
-		return parse_dataobj_frame_layout;
-	case STK_DATA_OBJECT_TYPE_FRAMES_INFO:
-		return parse_dataobj_frames_info;
-	case STK_DATA_OBJECT_TYPE_FRAME_ID:
-		return parse_dataobj_frame_id;
-	case STK_DATA_OBJECT_TYPE_MEID:
-		return parse_dataobj_meid;
-	case STK_DATA_OBJECT_TYPE_MMS_REFERENCE:
-		return parse_dataobj_mms_reference;
-	case STK_DATA_OBJECT_TYPE_MMS_ID:
-		return parse_dataobj_mms_id;
-	case STK_DATA_OBJECT_TYPE_MMS_TRANSFER_STATUS:
-		return parse_dataobj_mms_transfer_status;
-	case STK_DATA_OBJECT_TYPE_MMS_CONTENT_ID:
-		return parse_dataobj_mms_content_id;
-	case STK_DATA_OBJECT_TYPE_MMS_NOTIFICATION:
-		return parse_dataobj_mms_notification;
-	case STK_DATA_OBJECT_TYPE_LAST_ENVELOPE:
-		return parse_dataobj_last_envelope;
-	case STK_DATA_OBJECT_TYPE_REGISTRY_APPLICATION_DATA:
-		return parse_dataobj_registry_application_data;
-	case STK_DATA_OBJECT_TYPE_ACTIVATE_DESCRIPTOR:
-		return parse_dataobj_activate_descriptor;
-	case STK_DATA_OBJECT_TYPE_BROADCAST_NETWORK_INFO:
-		return parse_dataobj_broadcast_network_info;
-	default:
+	if ((unsigned int) type >= G_N_ELEMENTS(dataobj_handlers))
 		return NULL;
-	}
+
+	return dataobj_handlers[type];
 }
 
-static void destroy_stk_item(gpointer pointer)
+/*
+ * A list of items lives in a single block: the list nodes, then the
+ * items, then their texts.  The block starts with the first node, so
+ * freeing the list head frees everything.
+ */
+static GSList *item_list_new(const struct stk_item *items, unsigned int n,
+				gsize text_len)
 {
-	struct stk_item *item = pointer;
-	g_free(item->text);
-	g_free(item);
+	GSList *nodes;
+	struct stk_item *arena;
+	char *text;
+	unsigned int i;
+
+	nodes = g_malloc(n * (sizeof(GSList) + sizeof(struct stk_item)) +
+				text_len);
+	arena = (struct stk_item *) (nodes + n);
+	text = (char *) (arena + n);
+
+	for (i = 0; i < n; i++) {
+		gsize len = strlen(items[i].text) + 1;
+
+		memcpy(text, items[i].text, len);
+		arena[i].id = items[i].id;
+		arena[i].text = text;
+		text += len;
+
+		nodes[i].data = &arena[i];
+		nodes[i].next = i + 1 < n ? &nodes[i + 1] : NULL;
+	}
+
+	return nodes;
 }
 
 static gboolean parse_item_list(struct comprehension_tlv_iter *iter,
@@ -2265,9 +2238,12 @@ static gboolean parse_item_list(struct comprehension_tlv_iter *iter,
 	GSList **out = data;
 	unsigned short tag = STK_DATA_OBJECT_TYPE_ITEM;
 	struct comprehension_tlv_iter iter_old;
+	struct stk_item items[MAX_ITEMS];
 	struct stk_item item;
-	GSList *list = NULL;
 	unsigned int count = 0;
+	unsigned int n = 0;
+	unsigned int i;
+	gsize text_len = 0;
 	gboolean has_empty = FALSE;
 
 	do {
@@ -2281,23 +2257,32 @@ static gboolean parse_item_list(struct comprehension_tlv_iter *iter,
 				continue;
 			}
 
-			list = g_slist_prepend(list,
-						g_memdup(&item, sizeof(item)));
+			/* Can't happen within the 255 bytes of a command */
+			if (n == MAX_ITEMS) {
+				g_free(item.text);
+				continue;
+			}
+
+			text_len += strlen(item.text) + 1;
+			items[n++] = item;
 		}
 	} while (comprehension_tlv_iter_next(iter) == TRUE &&
 			comprehension_tlv_iter_get_tag(iter) == tag);
 
 	comprehension_tlv_iter_copy(&iter_old, iter);
 
-	if (!has_empty) {
-		*out = g_slist_reverse(list);
+	if (!has_empty && n > 0)
+		*out = item_list_new(items, n, text_len);
+
+	for (i = 0; i < n; i++)
+		g_free(items[i].text);
+
+	if (!has_empty)
 		return TRUE;
-	}
 
 	if (count == 1)
 		return TRUE;
 
-	g_slist_free_full(list, destroy_stk_item);
 	return FALSE;
 
 }
@@ -2344,14 +2329,17 @@ struct dataobj_handler_entry {
 	enum stk_data_object_type type;
 	int flags;
 	void *data;
+	dataobj_handler handler;
 };
 
 static enum stk_command_parse_result parse_dataobj(
 					struct comprehension_tlv_iter *iter,
 					enum stk_data_object_type type, ...)
 {
-	GSList *entries = NULL;
-	GSList *l;
+	struct dataobj_handler_entry entries[MAX_DATAOBJ_ENTRIES];
+	unsigned int count = 0;
+	unsigned int pos = 0;
+	unsigned int i;
 	va_list args;
 	gboolean minimum_set = TRUE;
 	gboolean parse_error = FALSE;
@@ -2361,66 +2349,58 @@ static enum stk_command_parse_result parse_dataobj(
 	while (type != STK_DATA_OBJECT_TYPE_INVALID) {
 		struct dataobj_handler_entry *entry;
 
-		entry = g_new0(struct dataobj_handler_entry, 1);
+		if (count == MAX_DATAOBJ_ENTRIES) {
+			va_end(args);
+			return STK_PARSE_RESULT_DATA_NOT_UNDERSTOOD;
+		}
 
+		entry = &entries[count++];
 		entry->type = type;
 		entry->flags = va_arg(args, int);
 		entry->data = va_arg(args, void *);
 
+		if (entry->flags & DATAOBJ_FLAG_LIST)
+			entry->handler = list_handler_for_type(type);
+		else
+			entry->handler = handler_for_type(type);
+
 		type = va_arg(args, enum stk_data_object_type);
-		entries = g_slist_prepend(entries, entry);
 	}
 
 	va_end(args);
 
-	entries = g_slist_reverse(entries);
-
-	l = entries;
 	while (comprehension_tlv_iter_next(iter) == TRUE) {
-		dataobj_handler handler;
-		struct dataobj_handler_entry *entry;
-		GSList *l2;
+		unsigned short tag = comprehension_tlv_iter_get_tag(iter);
 
-		for (l2 = l; l2; l2 = l2->next) {
-			entry = l2->data;
-
-			if (comprehension_tlv_iter_get_tag(iter) == entry->type)
+		for (i = pos; i < count; i++) {
+			if (tag == entries[i].type)
 				break;
 
 			/* Can't skip over mandatory objects */
-			if (entry->flags & DATAOBJ_FLAG_MANDATORY) {
-				l2 = NULL;
+			if (entries[i].flags & DATAOBJ_FLAG_MANDATORY) {
+				i = count;
 				break;
 			}
 		}
 
-		if (l2 == NULL) {
+		if (i == count) {
 			if (comprehension_tlv_get_cr(iter) == TRUE)
 				parse_error = TRUE;
 
 			continue;
 		}
 
-		if (entry->flags & DATAOBJ_FLAG_LIST)
-			handler = list_handler_for_type(entry->type);
-		else
-			handler = handler_for_type(entry->type);
-
-		if (handler(iter, entry->data) == FALSE)
+		if (entries[i].handler(iter, entries[i].data) == FALSE)
 			parse_error = TRUE;
 
-		l = l2->next;
+		pos = i + 1;
 	}
 
-	for (; l; l = l->next) {
-		struct dataobj_handler_entry *entry = l->data;
-
-		if (entry->flags & DATAOBJ_FLAG_MANDATORY)
+	for (i = pos; i < count; i++) {
+		if (entries[i].flags & DATAOBJ_FLAG_MANDATORY)
 			minimum_set = FALSE;
 	}
 
-	g_slist_free_full(entries, g_free);
-
 	if (minimum_set == FALSE)
 		return STK_PARSE_RESULT_MISSING_VALUE;
 	if (parse_error == TRUE)
@@ -2622,7 +2602,7 @@ static enum stk_command_parse_result parse_poll_interval(
 static void destroy_setup_menu(struct stk_command *command)
 {
 	g_free(command->setup_menu.alpha_id);
-	g_slist_free_full(command->setup_menu.items, destroy_stk_item);
+	g_free(command->setup_menu.items);
 }
 
 static enum stk_command_parse_result parse_setup_menu(
@@ -2667,7 +2647,7 @@ static enum stk_command_parse_result parse_setup_menu(
 static void destroy_select_item(struct stk_command *command)
 {
 	g_free(command->select_item.alpha_id);
-	g_slist_free_full(command->select_item.items, destroy_stk_item);
+	g_free(command->select_item.items);
 }
 
 static enum stk_command_parse_result parse_select_item(
@@ -6450,57 +6430,103 @@ static const char chars_table[] = {
 	'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p',
 	'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '+', '.' };
 
-char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
-			enum stk_img_scheme scheme, const unsigned char *clut,
-			unsigned short clut_len)
+struct stk_image_info {
+	unsigned int width;
+	unsigned int height;
+	unsigned int nbits;
+	unsigned int ncolors;
+	unsigned int pos;
+};
+
+/*
+ * Validates the image instance header (31.102 Section 4.6.1.1 and 4.6.1.2)
+ * and checks that the body holds width * height pixels of nbits each.
+ */
+static gboolean stk_image_parse_info(const unsigned char *img,
+					unsigned int len,
+					enum stk_img_scheme scheme,
+					const unsigned char *clut,
+					unsigned short clut_len,
+					struct stk_image_info *info)
 {
-	guint8 width, height;
-	unsigned int ncolors, nbits, entry, cpp;
-	unsigned int i, j;
-	int bit, k;
-	GString *xpm;
 	unsigned int pos = 0;
-	const char xpm_header[] = "/* XPM */\n";
-	const char declaration[] = "static char *xpm[] = {\n";
-	char c[3];
 
 	if (img == NULL)
-		return NULL;
+		return FALSE;
 
 	/* sanity check length */
 	if (len < 3)
-		return NULL;
+		return FALSE;
 
-	width = img[pos++];
-	height = img[pos++];
+	info->width = img[pos++];
+	info->height = img[pos++];
 
 	if (scheme == STK_IMG_SCHEME_BASIC) {
-		nbits = 1;
-		ncolors = 2;
+		info->nbits = 1;
+		info->ncolors = 2;
 	} else {
 		/* sanity check length */
 		if ((pos + 4 > len) || (clut == NULL))
-			return NULL;
+			return FALSE;
 
-		nbits = img[pos++];
-		ncolors = img[pos++];
+		info->nbits = img[pos++];
+		info->ncolors = img[pos++];
 
 		/* the value of zero should be interpreted as 256 */
-		if (ncolors == 0)
-			ncolors = 256;
+		if (info->ncolors == 0)
+			info->ncolors = 256;
 
 		/* skip clut offset bytes */
 		pos += 2;
 
-		if ((ncolors * 3) > clut_len)
-			return NULL;
+		if (info->nbits == 0 || info->nbits > 8)
+			return FALSE;
+
+		if ((info->ncolors * 3) > clut_len)
+			return FALSE;
 	}
 
-	if (pos + ((width * height + 7) / 8) > len)
+	if (pos + ((info->width * info->height * info->nbits + 7) / 8) > len)
+		return FALSE;
+
+	info->pos = pos;
+
+	return TRUE;
+}
+
+/* Pixels are packed MSB first, with no padding at the end of a row */
+static inline unsigned int stk_image_next_pixel(const unsigned char *img,
+						unsigned int nbits,
+						unsigned int *bitpos)
+{
+	unsigned int entry = 0;
+	unsigned int bit;
+
+	for (bit = 0; bit < nbits; bit++, (*bitpos)++)
+		entry = (entry << 1) |
+			((img[*bitpos >> 3] >> (7 - (*bitpos & 7))) & 0x1);
+
+	return entry;
+}
+
+char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
+			enum stk_img_scheme scheme, const unsigned char *clut,
+			unsigned short clut_len)
+{
+	struct stk_image_info info;
+	unsigned int cpp, entry, bitpos;
+	unsigned int i, j;
+	GString *xpm;
+	char *out;
+	const char xpm_header[] = "/* XPM */\n";
+	const char declaration[] = "static char *xpm[] = {\n";
+	char c[3];
+
+	if (!stk_image_parse_info(img, len, scheme, clut, clut_len, &info))
 		return NULL;
 
 	/* determine the number of chars need to represent the pixel */
-	cpp = ncolors > 64 ? 2 : 1;
+	cpp = info.ncolors > 64 ? 2 : 1;
 
 	/*
 	 * space needed:
@@ -6512,25 +6538,26 @@ char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
 	 *	end of assignment - 2 chars "};"
 	 */
 	xpm = g_string_sized_new(strlen(xpm_header) + strlen(declaration) +
-				19 + ((cpp + 14) * ncolors) +
-				(width * height * cpp) + (4 * height) + 2);
+				19 + ((cpp + 14) * info.ncolors) +
+				(info.width * info.height * cpp) +
+				(4 * info.height) + 2);
 	if (xpm == NULL)
 		return NULL;
 
 	/* add header, declaration, values */
 	g_string_append(xpm, xpm_header);
 	g_string_append(xpm, declaration);
-	g_string_append_printf(xpm, "\"%d %d %d %d\",\n", width, height,
-				ncolors, cpp);
+	g_string_append_printf(xpm, "\"%u %u %u %u\",\n", info.width,
+				info.height, info.ncolors, cpp);
 
 	/* create colors */
 	if (scheme == STK_IMG_SCHEME_BASIC) {
 		g_string_append(xpm, "\"0\tc #000000\",\n");
 		g_string_append(xpm, "\"1\tc #FFFFFF\",\n");
 	} else {
-		for (i = 0; i < ncolors; i++) {
+		for (i = 0; i < info.ncolors; i++) {
 			/* lookup char representation of this number */
-			if (ncolors > 64) {
+			if (info.ncolors > 64) {
 				c[0] = chars_table[i / 64];
 				c[1] = chars_table[i % 64];
 				c[2] = '\0';
@@ -6539,7 +6566,7 @@ char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
 				c[1] = '\0';
 			}
 
-			if ((i == (ncolors - 1)) &&
+			if ((i == (info.ncolors - 1)) &&
 					scheme == STK_IMG_SCHEME_TRANSPARENCY)
 				g_string_append_printf(xpm,
 					"\"%s\tc None\",\n", c);
@@ -6551,34 +6578,27 @@ char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
 		}
 	}
 
-	/* height rows of width pixels */
-	k = 7;
-	for (i = 0; i < height; i++) {
-		g_string_append(xpm, "\"");
-		for (j = 0; j < width; j++) {
-			entry = 0;
-			for (bit = nbits - 1; bit >= 0; bit--) {
-				entry |= (img[pos] >> k & 0x1) << bit;
-				k--;
-
-				/* see if we crossed a byte boundary */
-				if (k < 0) {
-					k = 7;
-					pos++;
-				}
-			}
+	/*
+	 * height rows of width pixels, written straight into the buffer
+	 * sized above instead of going through a format call per pixel
+	 */
+	bitpos = info.pos * 8;
+
+	for (i = 0; i < info.height; i++) {
+		g_string_append_c(xpm, '"');
+
+		j = xpm->len;
+		g_string_set_size(xpm, j + info.width * cpp);
+		out = xpm->str + j;
+
+		for (j = 0; j < info.width; j++) {
+			entry = stk_image_next_pixel(img, info.nbits, &bitpos);
 
 			/* lookup char representation of this number */
-			if (ncolors > 64) {
-				c[0] = chars_table[entry / 64];
-				c[1] = chars_table[entry % 64];
-				c[2] = '\0';
-			} else {
-				c[0] = chars_table[entry % 64];
-				c[1] = '\0';
-			}
+			if (cpp == 2)
+				*out++ = chars_table[entry / 64];
 
-			g_string_append_printf(xpm, "%s", c);
+			*out++ = chars_table[entry % 64];
 		}
 
 		g_string_append(xpm, "\",\n");
@@ -6589,3 +6609,55 @@ char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
 	/* Caller must free char data */
 	return g_string_free(xpm, FALSE);
 }
+
+unsigned char *stk_image_to_rgba(const unsigned char *img, unsigned int len,
+			enum stk_img_scheme scheme, const unsigned char *clut,
+			unsigned short clut_len, unsigned int *out_width,
+			unsigned int *out_height)
+{
+	struct stk_image_info info;
+	unsigned char palette[256][4];
+	unsigned char *rgba;
+	unsigned char *out;
+	unsigned int i, n, bitpos;
+
+	if (!stk_image_parse_info(img, len, scheme, clut, clut_len, &info))
+		return NULL;
+
+	/* Entries past the end of the CLUT come out fully transparent */
+	memset(palette, 0, sizeof(palette));
+
+	if (scheme == STK_IMG_SCHEME_BASIC) {
+		memcpy(palette[0], "\x00\x00\x00\xFF", 4);
+		memcpy(palette[1], "\xFF\xFF\xFF\xFF", 4);
+	} else {
+		for (i = 0; i < info.ncolors; i++, clut += 3) {
+			memcpy(palette[i], clut, 3);
+			palette[i][3] = 0xFF;
+		}
+
+		if (scheme == STK_IMG_SCHEME_TRANSPARENCY)
+			memset(palette[info.ncolors - 1], 0, 4);
+	}
+
+	/* One spare byte so that an empty image is not taken for a failure */
+	n = info.width * info.height;
+	rgba = g_try_malloc(n * 4 + 1);
+	if (rgba == NULL)
+		return NULL;
+
+	bitpos = info.pos * 8;
+
+	for (i = 0, out = rgba; i < n; i++, out += 4)
+		memcpy(out, palette[stk_image_next_pixel(img, info.nbits,
+							&bitpos)], 4);
+
+	if (out_width)
+		*out_width = info.width;
+
+	if (out_height)
+		*out_height = info.height;
+
+	/* Caller must free the pixels */
+	return rgba;
+}
@@ -1784,3 +1784,7 @@ char *stk_text_to_html(const char *text,
 char *stk_image_to_xpm(const unsigned char *img, unsigned int len,
 			enum stk_img_scheme scheme, const unsigned char *clut,
 			unsigned short clut_len);
+unsigned char *stk_image_to_rgba(const unsigned char *img, unsigned int len,
+			enum stk_img_scheme scheme, const unsigned char *clut,
+			unsigned short clut_len, unsigned int *out_width,
+			unsigned int *out_height);
@@ -40,6 +40,7 @@
 #include "ofono.h"
 
 static char* config_dir = NULL;
+static char *storage_dir = NULL;
 
 void __ofono_set_config_dir(const char *dir)
 {
@@ -52,9 +53,15 @@ const char *ofono_config_dir(void)
 	return config_dir ? config_dir : CONFIGDIR;
 }
 
+void __ofono_set_storage_dir(const char *dir)
+{
+	g_free(storage_dir);
+	storage_dir = g_strdup(dir);
+}
+
 const char *ofono_storage_dir(void)
 {
-	return STORAGEDIR;
+	return storage_dir ? storage_dir : STORAGEDIR;
 }
 
 int create_dirs(const char *filename, const mode_t mode)
@@ -190,9 +197,10 @@ GKeyFile *storage_open(const char *imsi, const char *store)
 		return NULL;
 
 	if (imsi)
-		path = g_strdup_printf(STORAGEDIR "/%s/%s", imsi, store);
+		path = g_strdup_printf("%s/%s/%s", ofono_storage_dir(), imsi,
+									store);
 	else
-		path = g_strdup_printf(STORAGEDIR "/%s", store);
+		path = g_strdup_printf("%s/%s", ofono_storage_dir(), store);
 
 	keyfile = g_key_file_new();
 
@@ -211,9 +219,10 @@ void storage_sync(const char *imsi, const char *store, GKeyFile *keyfile)
 	gsize length = 0;
 
 	if (imsi)
-		path = g_strdup_printf(STORAGEDIR "/%s/%s", imsi, store);
+		path = g_strdup_printf("%s/%s/%s", ofono_storage_dir(), imsi,
+									store);
 	else
-		path = g_strdup_printf(STORAGEDIR "/%s", store);
+		path = g_strdup_printf("%s/%s", ofono_storage_dir(), store);
 
 	if (path == NULL)
 		return;
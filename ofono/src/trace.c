@@ -0,0 +1,727 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include <glib.h>
+
+#include "ofono.h"
+#include "storage.h"
+#include "trace.h"
+#include "gatutil.h"
+
+/*
+ * The trace ring records DBG messages and transport data in binary form,
+ * leaving all the formatting to tools/trace-decode.  Writers claim a
+ * record with a single atomic increment and mark it complete by storing
+ * its sequence number last, so the dump code can tell torn or recycled
+ * records from good ones without any locking.
+ */
+
+#define TRACE_MIN_RECORDS	16
+#define TRACE_MAX_CHUNKS	16
+#define TRACE_STAGING_SIZE	(64 * 1024)
+#define TRACE_MAX_STRING	4096
+#define TRACE_CRASH_FILE	STORAGEDIR "/trace.crash"
+
+enum trace_length {
+	TRACE_LEN_NONE,
+	TRACE_LEN_SHORT,
+	TRACE_LEN_LONG,
+	TRACE_LEN_LONG_LONG,
+	TRACE_LEN_SIZE,
+	TRACE_LEN_PTRDIFF,
+	TRACE_LEN_LONG_DOUBLE,
+};
+
+static struct trace_record *trace_ring;
+static guint32 trace_mask;
+static volatile gint trace_head;
+static volatile gint trace_dumping;
+
+/* Only touched while dumping, allocated upfront to stay signal safe */
+static const void **trace_strings;
+static guint32 trace_strings_mask;
+static unsigned char *trace_staging;
+
+/* Transport data is also appended here while capturing */
+static int capture_fd = -1;
+static guint32 capture_seq;
+
+static struct trace_record *trace_record_begin(guint8 type, guint8 flags,
+						const void *id, guint32 *seq)
+{
+	guint32 index = (guint32) g_atomic_int_add(&trace_head, 1);
+	struct trace_record *rec = trace_ring + (index & trace_mask);
+
+	g_atomic_int_set((gint *) &rec->seq, 0);
+
+	rec->type = type;
+	rec->flags = flags;
+	rec->len = 0;
+	rec->timestamp = g_get_monotonic_time();
+	rec->id = (uintptr_t) id;
+
+	*seq = index + 1;
+
+	return rec;
+}
+
+static void trace_record_end(struct trace_record *rec, guint32 seq)
+{
+	g_atomic_int_set((gint *) &rec->seq, seq);
+}
+
+static gboolean trace_put_u64(struct trace_record *rec, char tag, guint64 v)
+{
+	if (rec->len + 1 + sizeof(v) > sizeof(rec->payload)) {
+		rec->flags |= TRACE_FLAG_TRUNCATED;
+		return FALSE;
+	}
+
+	rec->payload[rec->len++] = tag;
+	memcpy(rec->payload + rec->len, &v, sizeof(v));
+	rec->len += sizeof(v);
+
+	return TRUE;
+}
+
+static gboolean trace_put_double(struct trace_record *rec, double d)
+{
+	guint64 v;
+
+	memcpy(&v, &d, sizeof(v));
+
+	return trace_put_u64(rec, TRACE_ARG_DOUBLE, v);
+}
+
+static gboolean trace_put_string(struct trace_record *rec, const char *str)
+{
+	size_t avail;
+	size_t len;
+
+	if (str == NULL)
+		str = "(null)";
+
+	if (rec->len + 2 > sizeof(rec->payload)) {
+		rec->flags |= TRACE_FLAG_TRUNCATED;
+		return FALSE;
+	}
+
+	avail = MIN(sizeof(rec->payload) - rec->len - 2, G_MAXUINT8);
+	len = strnlen(str, avail + 1);
+
+	if (len > avail)
+		len = avail;
+
+	rec->payload[rec->len++] = TRACE_ARG_STRING;
+	rec->payload[rec->len++] = len;
+	memcpy(rec->payload + rec->len, str, len);
+	rec->len += len;
+
+	if (str[len] != '\0') {
+		rec->flags |= TRACE_FLAG_TRUNCATED;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static guint64 trace_va_int(va_list *va, enum trace_length length,
+							gboolean is_signed)
+{
+	switch (length) {
+	case TRACE_LEN_LONG:
+		return is_signed ? (guint64) va_arg(*va, long) :
+					(guint64) va_arg(*va, unsigned long);
+	case TRACE_LEN_LONG_LONG:
+		return is_signed ? (guint64) va_arg(*va, long long) :
+				(guint64) va_arg(*va, unsigned long long);
+	case TRACE_LEN_SIZE:
+		return is_signed ? (guint64) va_arg(*va, ssize_t) :
+					(guint64) va_arg(*va, size_t);
+	case TRACE_LEN_PTRDIFF:
+		return (guint64) va_arg(*va, ptrdiff_t);
+	default:
+		break;
+	}
+
+	/* char and short are promoted to int */
+	return is_signed ? (guint64) va_arg(*va, int) :
+					(guint64) va_arg(*va, unsigned int);
+}
+
+/*
+ * Walks the format string the same way printf does, storing the raw
+ * value of each argument.  Strings have to be copied since they are
+ * unlikely to outlive the call.
+ */
+static void trace_put_args(struct trace_record *rec, const char *format,
+								va_list *va)
+{
+	const char *p = format;
+	enum trace_length length;
+	gboolean ok = TRUE;
+
+	while (ok && (p = strchr(p, '%')) != NULL) {
+		p++;
+
+		if (*p == '%') {
+			p++;
+			continue;
+		}
+
+		while (*p && strchr("-+ #0'", *p))
+			p++;
+
+		if (*p == '*') {
+			int width = va_arg(*va, int);
+
+			ok = trace_put_u64(rec, TRACE_ARG_INT, width);
+			p++;
+		} else
+			while (g_ascii_isdigit(*p))
+				p++;
+
+		if (*p == '.') {
+			p++;
+
+			if (*p == '*') {
+				int precision = va_arg(*va, int);
+
+				ok = ok && trace_put_u64(rec, TRACE_ARG_INT,
+								precision);
+				p++;
+			} else
+				while (g_ascii_isdigit(*p))
+					p++;
+		}
+
+		length = TRACE_LEN_NONE;
+
+		switch (*p) {
+		case 'h':
+			length = TRACE_LEN_SHORT;
+			p += (p[1] == 'h') ? 2 : 1;
+			break;
+		case 'l':
+			length = (p[1] == 'l') ? TRACE_LEN_LONG_LONG :
+							TRACE_LEN_LONG;
+			p += (p[1] == 'l') ? 2 : 1;
+			break;
+		case 'q':
+		case 'j':
+			length = TRACE_LEN_LONG_LONG;
+			p++;
+			break;
+		case 'z':
+			length = TRACE_LEN_SIZE;
+			p++;
+			break;
+		case 't':
+			length = TRACE_LEN_PTRDIFF;
+			p++;
+			break;
+		case 'L':
+			length = TRACE_LEN_LONG_DOUBLE;
+			p++;
+			break;
+		}
+
+		if (!ok)
+			break;
+
+		switch (*p) {
+		case 'd':
+		case 'i':
+			ok = trace_put_u64(rec, TRACE_ARG_INT,
+					trace_va_int(va, length, TRUE));
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'c':
+			ok = trace_put_u64(rec, TRACE_ARG_INT,
+					trace_va_int(va, length, FALSE));
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (length == TRACE_LEN_LONG_DOUBLE)
+				ok = trace_put_double(rec,
+						va_arg(*va, long double));
+			else
+				ok = trace_put_double(rec,
+						va_arg(*va, double));
+			break;
+		case 's':
+			ok = trace_put_string(rec, va_arg(*va, const char *));
+			break;
+		case 'p':
+			ok = trace_put_u64(rec, TRACE_ARG_POINTER,
+					(uintptr_t) va_arg(*va, void *));
+			break;
+		case 'n':
+			(void) va_arg(*va, void *);
+			break;
+		case 'm':
+			ok = trace_put_u64(rec, TRACE_ARG_ERRNO, errno);
+			break;
+		default:
+			/* Nothing sensible can be done with the rest */
+			rec->flags |= TRACE_FLAG_TRUNCATED;
+			return;
+		}
+
+		p++;
+	}
+}
+
+static void trace_dbg(const struct ofono_debug_desc *desc,
+					const char *format, va_list ap)
+{
+	struct trace_record *rec;
+	guint32 seq;
+	va_list va;
+
+	if (trace_ring == NULL)
+		return;
+
+	rec = trace_record_begin(TRACE_RECORD_DBG, 0, format, &seq);
+
+	if (trace_put_u64(rec, TRACE_ARG_FILE, (uintptr_t) desc->file)) {
+		va_copy(va, ap);
+		trace_put_args(rec, format, &va);
+		va_end(va);
+	}
+
+	trace_record_end(rec, seq);
+}
+
+static int trace_write_all(int fd, const void *data, size_t len);
+
+static void trace_capture_data(const void *channel, guint8 type,
+				const unsigned char *buf, unsigned int len)
+{
+	struct trace_record rec;
+	guint8 flags = 0;
+	int err;
+
+	memset(&rec, 0, sizeof(rec));
+
+	/* Captures are meant for replay, so nothing gets truncated */
+	while (len > 0) {
+		rec.seq = ++capture_seq;
+		rec.type = type;
+		rec.flags = flags;
+		rec.len = MIN(len, sizeof(rec.payload));
+		rec.timestamp = g_get_monotonic_time();
+		rec.id = (uintptr_t) channel;
+		memcpy(rec.payload, buf, rec.len);
+		buf += rec.len;
+		len -= rec.len;
+
+		err = trace_write_all(capture_fd, &rec, sizeof(rec));
+		if (err < 0) {
+			ofono_error("Capture failed: %s", strerror(-err));
+			__ofono_trace_capture_stop();
+			return;
+		}
+
+		flags = TRACE_FLAG_CONTINUED;
+	}
+}
+
+void ofono_trace_data(const void *channel, int in, const void *data,
+							unsigned int len)
+{
+	const unsigned char *buf = data;
+	guint8 type = in ? TRACE_RECORD_DATA_IN : TRACE_RECORD_DATA_OUT;
+	guint8 flags = 0;
+	unsigned int chunks = 0;
+
+	if (capture_fd >= 0)
+		trace_capture_data(channel, type, buf, len);
+
+	if (trace_ring == NULL)
+		return;
+
+	while (len > 0) {
+		struct trace_record *rec;
+		unsigned int n;
+		guint32 seq;
+
+		rec = trace_record_begin(type, flags, channel, &seq);
+		n = MIN(len, sizeof(rec->payload));
+
+		memcpy(rec->payload, buf, n);
+		rec->len = n;
+		buf += n;
+		len -= n;
+
+		if (len > 0 && ++chunks == TRACE_MAX_CHUNKS) {
+			rec->flags |= TRACE_FLAG_TRUNCATED;
+			len = 0;
+		}
+
+		trace_record_end(rec, seq);
+		flags = TRACE_FLAG_CONTINUED;
+	}
+}
+
+static void trace_at_data(gpointer io, gboolean in, const void *data,
+								gsize len)
+{
+	ofono_trace_data(io, in, data, len);
+}
+
+static void trace_update_at_hook(void)
+{
+	if (trace_ring || capture_fd >= 0)
+		g_at_util_set_trace_func(trace_at_data);
+	else
+		g_at_util_set_trace_func(NULL);
+}
+
+/* Everything from here on has to be async signal safe */
+
+static int trace_write_all(int fd, const void *data, size_t len)
+{
+	const char *ptr = data;
+
+	while (len > 0) {
+		ssize_t written = write(fd, ptr, len);
+
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+
+			return -errno;
+		}
+
+		ptr += written;
+		len -= written;
+	}
+
+	return 0;
+}
+
+static int trace_stage(int fd, size_t *fill, const void *data, size_t len)
+{
+	int err;
+
+	if (*fill + len > TRACE_STAGING_SIZE) {
+		err = trace_write_all(fd, trace_staging, *fill);
+		*fill = 0;
+
+		if (err < 0)
+			return err;
+	}
+
+	memcpy(trace_staging + *fill, data, len);
+	*fill += len;
+
+	return 0;
+}
+
+static void trace_remember_string(const void *addr)
+{
+	guint32 i;
+
+	if (addr == NULL)
+		return;
+
+	i = ((uintptr_t) addr >> 3) * 2654435761u;
+
+	for (;; i++) {
+		i &= trace_strings_mask;
+
+		if (trace_strings[i] == addr)
+			return;
+
+		if (trace_strings[i] == NULL) {
+			trace_strings[i] = addr;
+			return;
+		}
+	}
+}
+
+static int trace_stage_record(int fd, size_t *fill, guint32 seq)
+{
+	const struct trace_record *src = trace_ring + ((seq - 1) & trace_mask);
+	struct trace_record *rec;
+	int err;
+
+	/* Make sure there is room for the whole record in one piece */
+	if (*fill + sizeof(*rec) > TRACE_STAGING_SIZE) {
+		err = trace_write_all(fd, trace_staging, *fill);
+		*fill = 0;
+
+		if (err < 0)
+			return err;
+	}
+
+	rec = (struct trace_record *) (trace_staging + *fill);
+	*fill += sizeof(*rec);
+
+	if ((guint32) g_atomic_int_get((gint *) &src->seq) == seq) {
+		memcpy(rec, src, sizeof(*rec));
+
+		/* Still the same record after copying? */
+		if ((guint32) g_atomic_int_get((gint *) &src->seq) == seq)
+			goto copied;
+	}
+
+	/* Torn or recycled while dumping, the decoder skips these */
+	memset(rec, 0, sizeof(*rec));
+	return 0;
+
+copied:
+	if (rec->type == TRACE_RECORD_DBG) {
+		guint64 file = 0;
+
+		if (rec->len >= 1 + sizeof(file) &&
+				rec->payload[0] == TRACE_ARG_FILE)
+			memcpy(&file, rec->payload + 1, sizeof(file));
+
+		trace_remember_string((const void *) (uintptr_t) rec->id);
+		trace_remember_string((const void *) (uintptr_t) file);
+	}
+
+	return 0;
+}
+
+int __ofono_trace_write(int fd)
+{
+	struct trace_file_header hdr;
+	guint32 head, first, seq, i;
+	size_t fill = 0;
+	int err;
+
+	if (trace_ring == NULL)
+		return -ENOENT;
+
+	if (!g_atomic_int_compare_and_exchange(&trace_dumping, 0, 1))
+		return -EBUSY;
+
+	head = (guint32) g_atomic_int_get(&trace_head);
+	first = head > trace_mask + 1 ? head - (trace_mask + 1) : 0;
+
+	memset(trace_strings, 0, sizeof(*trace_strings) *
+						(trace_strings_mask + 1));
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TRACE_MAGIC;
+	hdr.version = TRACE_VERSION;
+	hdr.record_size = sizeof(struct trace_record);
+	hdr.count = head - first;
+	hdr.dropped = first;
+	hdr.monotonic = g_get_monotonic_time();
+	hdr.realtime = g_get_real_time();
+
+	err = trace_stage(fd, &fill, &hdr, sizeof(hdr));
+
+	for (seq = first + 1; err == 0 && seq <= head; seq++)
+		err = trace_stage_record(fd, &fill, seq);
+
+	for (i = 0; err == 0 && i <= trace_strings_mask; i++) {
+		const char *str = trace_strings[i];
+		struct trace_string entry;
+
+		if (str == NULL)
+			continue;
+
+		entry.addr = (uintptr_t) str;
+		entry.len = strnlen(str, TRACE_MAX_STRING);
+
+		err = trace_stage(fd, &fill, &entry, sizeof(entry));
+		if (err == 0)
+			err = trace_stage(fd, &fill, str, entry.len);
+	}
+
+	if (err == 0)
+		err = trace_write_all(fd, trace_staging, fill);
+
+	g_atomic_int_set(&trace_dumping, 0);
+
+	return err;
+}
+
+int __ofono_trace_save(const char *path)
+{
+	int fd;
+	int err;
+
+	if (trace_ring == NULL)
+		return -ENOENT;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd < 0)
+		return -errno;
+
+	err = __ofono_trace_write(fd);
+	close(fd);
+
+	return err;
+}
+
+static void trace_crash(void)
+{
+	if (__ofono_trace_save(TRACE_CRASH_FILE) == 0)
+		ofono_error("Trace saved to %s", TRACE_CRASH_FILE);
+}
+
+/* Returns a readable file descriptor with a fresh dump, or -errno */
+int __ofono_trace_dump_fd(void)
+{
+	char *path;
+	int fd;
+	int err;
+
+	if (trace_ring == NULL)
+		return -ENOENT;
+
+	fd = g_file_open_tmp("ofono-trace-XXXXXX", &path, NULL);
+	if (fd < 0)
+		return -EIO;
+
+	unlink(path);
+	g_free(path);
+
+	err = __ofono_trace_write(fd);
+
+	if (err == 0 && lseek(fd, 0, SEEK_SET) < 0)
+		err = -errno;
+
+	if (err < 0) {
+		close(fd);
+		return err;
+	}
+
+	return fd;
+}
+
+int __ofono_trace_init(unsigned int kbytes)
+{
+	guint32 count = TRACE_MIN_RECORDS;
+
+	if (kbytes == 0)
+		return 0;
+
+	while ((guint64) count * 2 * TRACE_RECORD_SIZE <=
+						(guint64) kbytes * 1024)
+		count *= 2;
+
+	trace_mask = count - 1;
+	trace_head = 0;
+
+	/* At most two strings per record, keep the table half empty */
+	trace_strings_mask = count * 4 - 1;
+	trace_strings = g_new0(const void *, trace_strings_mask + 1);
+	trace_staging = g_malloc(TRACE_STAGING_SIZE);
+	trace_ring = g_new0(struct trace_record, count);
+
+	trace_update_at_hook();
+	__ofono_log_set_trace(trace_dbg, trace_crash);
+
+	return 0;
+}
+
+void __ofono_trace_cleanup(void)
+{
+	struct trace_record *ring = trace_ring;
+
+	if (ring == NULL)
+		return;
+
+	__ofono_log_set_trace(NULL, NULL);
+
+	/* Format strings of plugins are about to go away */
+	trace_ring = NULL;
+	trace_update_at_hook();
+
+	while (g_atomic_int_get(&trace_dumping))
+		g_usleep(1000);
+
+	g_free(ring);
+	g_free(trace_strings);
+	g_free(trace_staging);
+	trace_strings = NULL;
+	trace_staging = NULL;
+}
+
+int __ofono_trace_capture_start(const char *path)
+{
+	struct trace_file_header hdr;
+	int fd;
+	int err;
+
+	if (capture_fd >= 0)
+		return -EALREADY;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd < 0)
+		return -errno;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = TRACE_MAGIC;
+	hdr.version = TRACE_VERSION;
+	hdr.record_size = sizeof(struct trace_record);
+	hdr.count = TRACE_COUNT_STREAM;
+	hdr.monotonic = g_get_monotonic_time();
+	hdr.realtime = g_get_real_time();
+
+	err = trace_write_all(fd, &hdr, sizeof(hdr));
+	if (err < 0) {
+		close(fd);
+		return err;
+	}
+
+	capture_fd = fd;
+	capture_seq = 0;
+	trace_update_at_hook();
+
+	return 0;
+}
+
+void __ofono_trace_capture_stop(void)
+{
+	if (capture_fd < 0)
+		return;
+
+	close(capture_fd);
+	capture_fd = -1;
+	trace_update_at_hook();
+}
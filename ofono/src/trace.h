@@ -0,0 +1,88 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Binary layout of the trace ring and of its dumps, shared between
+ * ofonod and tools/trace-decode.  A dump is a trace_file_header followed
+ * by header.count records in the order they were written, followed by
+ * trace_string entries (up to EOF) for every format string and file
+ * name that the records refer to.  Everything is in host byte order.
+ *
+ * A capture (ofonod --capture) uses the same header and records but is
+ * written as the data flows, so its count is TRACE_COUNT_STREAM and the
+ * transport records simply run up to EOF.  The header times are those
+ * of the start of the capture, and there is no string table.
+ */
+
+#ifndef __OFONO_TRACE_H
+#define __OFONO_TRACE_H
+
+#include <stdint.h>
+
+#define TRACE_MAGIC		0x5254464f	/* "OFTR" */
+#define TRACE_VERSION		1
+#define TRACE_RECORD_SIZE	256
+#define TRACE_COUNT_STREAM	0xffffffff
+
+enum trace_record_type {
+	TRACE_RECORD_DBG = 1,
+	TRACE_RECORD_DATA_IN,
+	TRACE_RECORD_DATA_OUT,
+};
+
+#define TRACE_FLAG_CONTINUED	0x01	/* Continues the previous chunk */
+#define TRACE_FLAG_TRUNCATED	0x02	/* Didn't fit, the rest is lost */
+
+/*
+ * Arguments of a DBG record, in the order in which the format string
+ * consumes them.  Each one is a tag byte followed by either 8 bytes of
+ * value or, for strings, a length byte and that many bytes.
+ */
+#define TRACE_ARG_FILE		'F'	/* Pointer to the file name */
+#define TRACE_ARG_INT		'i'
+#define TRACE_ARG_DOUBLE	'f'
+#define TRACE_ARG_POINTER	'p'
+#define TRACE_ARG_STRING	's'
+#define TRACE_ARG_ERRNO		'e'	/* Value of errno for %m */
+
+struct trace_record {
+	uint32_t seq;		/* Zero while being written */
+	uint8_t type;
+	uint8_t flags;
+	uint16_t len;		/* Bytes of payload in use */
+	uint64_t timestamp;	/* CLOCK_MONOTONIC, microseconds */
+	uint64_t id;		/* Format pointer or transport channel */
+	uint8_t payload[TRACE_RECORD_SIZE - 24];
+};
+
+struct trace_file_header {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t record_size;
+	uint32_t count;
+	uint32_t dropped;	/* Records overwritten since start */
+	uint64_t monotonic;	/* Time of the dump, microseconds */
+	uint64_t realtime;
+};
+
+struct trace_string {
+	uint64_t addr;
+	uint32_t len;
+	/* followed by len bytes, not NUL terminated */
+} __attribute__((packed));
+
+#endif /* __OFONO_TRACE_H */
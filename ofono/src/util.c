@@ -868,6 +868,65 @@ out:
 	return encoded;
 }
 
+/*
+ * Value of each character as a hex digit.  Anything which is not a hex
+ * digit maps to 0x10, so that the decoder only needs to check the bits
+ * accumulated over the whole string once, at the end.
+ */
+static const unsigned char hex_nibble[256] = {
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+	0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+};
+
+/* Hex representation of each byte value */
+static const char hex_pairs[] =
+	"000102030405060708090A0B0C0D0E0F"
+	"101112131415161718191A1B1C1D1E1F"
+	"202122232425262728292A2B2C2D2E2F"
+	"303132333435363738393A3B3C3D3E3F"
+	"404142434445464748494A4B4C4D4E4F"
+	"505152535455565758595A5B5C5D5E5F"
+	"606162636465666768696A6B6C6D6E6F"
+	"707172737475767778797A7B7C7D7E7F"
+	"808182838485868788898A8B8C8D8E8F"
+	"909192939495969798999A9B9C9D9E9F"
+	"A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+	"B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+	"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+	"D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+	"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+	"F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
 /*!
  * Decodes the hex encoded data and converts to a byte array.  If terminator
  * is not 0, the terminator character is appended to the end of the result.
@@ -877,49 +936,39 @@ out:
  * Please note that this since GSM does allow embedded null characeters, use
  * of the terminator or the items_writen is encouraged to find the real size
  * of the result.
+ *
+ * NULL is returned if the input contains anything other than hex digits,
+ * the contents of buf are undefined in that case.
  */
 unsigned char *decode_hex_own_buf(const char *in, long len, long *items_written,
 					unsigned char terminator,
 					unsigned char *buf)
 {
-	long i, j;
-	char c;
-	unsigned char b;
+	const unsigned char *s = (const unsigned char *) in;
+	unsigned int invalid = 0;
+	long i;
 
 	if (len < 0)
 		len = strlen(in);
 
-	len &= ~0x1;
-
-	for (i = 0, j = 0; i < len; i++, j++) {
-		c = toupper(in[i]);
-
-		if (c >= '0' && c <= '9')
-			b = c - '0';
-		else if (c >= 'A' && c <= 'F')
-			b = 10 + c - 'A';
-		else
-			return NULL;
-
-		i += 1;
+	len >>= 1;
 
-		c = toupper(in[i]);
+	for (i = 0; i < len; i++, s += 2) {
+		unsigned int hi = hex_nibble[s[0]];
+		unsigned int lo = hex_nibble[s[1]];
 
-		if (c >= '0' && c <= '9')
-			b = b * 16 + c - '0';
-		else if (c >= 'A' && c <= 'F')
-			b = b * 16 + 10 + c - 'A';
-		else
-			return NULL;
-
-		buf[j] = b;
+		invalid |= hi | lo;
+		buf[i] = (hi << 4) | lo;
 	}
 
+	if (invalid & 0x10)
+		return NULL;
+
 	if (terminator)
-		buf[j] = terminator;
+		buf[i] = terminator;
 
 	if (items_written)
-		*items_written = j;
+		*items_written = i;
 
 	return buf;
 }
@@ -927,27 +976,18 @@ unsigned char *decode_hex_own_buf(const char *in, long len, long *items_written,
 unsigned char *decode_hex(const char *in, long len, long *items_written,
 				unsigned char terminator)
 {
-	long i;
-	char c;
 	unsigned char *buf;
 
 	if (len < 0)
 		len = strlen(in);
 
-	len &= ~0x1;
-
-	for (i = 0; i < len; i++) {
-		c = toupper(in[i]);
-
-		if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F'))
-			continue;
-
-		return NULL;
-	}
-
 	buf = g_new(unsigned char, (len >> 1) + (terminator ? 1 : 0));
 
-	return decode_hex_own_buf(in, len, items_written, terminator, buf);
+	if (decode_hex_own_buf(in, len, items_written, terminator, buf))
+		return buf;
+
+	g_free(buf);
+	return NULL;
 }
 
 /*!
@@ -959,8 +999,7 @@ unsigned char *decode_hex(const char *in, long len, long *items_written,
 char *encode_hex_own_buf(const unsigned char *in, long len,
 				unsigned char terminator, char *buf)
 {
-	long i, j;
-	char c;
+	long i;
 
 	if (len < 0) {
 		i = 0;
@@ -971,25 +1010,10 @@ char *encode_hex_own_buf(const unsigned char *in, long len,
 		len = i;
 	}
 
-	for (i = 0, j = 0; i < len; i++, j++) {
-		c = (in[i] >> 4) & 0xf;
-
-		if (c <= 9)
-			buf[j] = '0' + c;
-		else
-			buf[j] = 'A' + c - 10;
-
-		j += 1;
-
-		c = (in[i]) & 0xf;
-
-		if (c <= 9)
-			buf[j] = '0' + c;
-		else
-			buf[j] = 'A' + c - 10;
-	}
+	for (i = 0; i < len; i++)
+		memcpy(buf + i * 2, hex_pairs + in[i] * 2, 2);
 
-	buf[j] = '\0';
+	buf[len * 2] = '\0';
 
 	return buf;
 }
@@ -20,11 +20,19 @@
 #include <string.h>
 
 struct voicecall_filter_request;
+typedef void (*voicecall_filter_request_complete_fn)
+				(struct voicecall_filter_request *req);
+
 struct voicecall_filter_request_fn {
 	const char *name;
 	gboolean (*can_process)(const struct ofono_voicecall_filter *filter);
 	guint (*process)(const struct ofono_voicecall_filter *filter,
 					struct voicecall_filter_request *req);
+	gboolean (*can_check)(const struct ofono_voicecall_filter *filter);
+	/* Returns NULL to run the next filter */
+	voicecall_filter_request_complete_fn (*check)
+				(const struct ofono_voicecall_filter *filter,
+					struct voicecall_filter_request *req);
 	void (*allow)(struct voicecall_filter_request *req);
 	void (*free)(struct voicecall_filter_request *req);
 };
@@ -156,7 +164,7 @@ static void voicecall_filter_request_dequeue
 
 static void voicecall_filter_request_complete
 		(struct voicecall_filter_request *req,
-			void (*complete)(struct voicecall_filter_request *req))
+			voicecall_filter_request_complete_fn complete)
 {
 	voicecall_filter_request_ref(req);
 	complete(req);
@@ -169,21 +177,31 @@ static void voicecall_filter_request_process
 		(struct voicecall_filter_request *req)
 {
 	GSList *l = req->filter_link;
-	const struct ofono_voicecall_filter *f = l->data;
 	const struct voicecall_filter_request_fn *fn = req->fn;
+	voicecall_filter_request_complete_fn complete = fn->allow;
 
-	while (f && !fn->can_process(f)) {
+	voicecall_filter_request_ref(req);
+	while (l) {
+		const struct ofono_voicecall_filter *f = l->data;
+
+		if (fn->can_check(f)) {
+			/* Synchronous verdict, no need to wait for it */
+			req->filter_link = l;
+			complete = fn->check(f, req);
+			if (complete)
+				break;
+
+			complete = fn->allow;
+		} else if (fn->can_process(f)) {
+			req->filter_link = l;
+			req->pending_id = fn->process(f, req);
+			voicecall_filter_request_unref(req);
+			return;
+		}
 		l = l->next;
-		f = l ? l->data : NULL;
 	}
 
-	voicecall_filter_request_ref(req);
-	if (f) {
-		req->filter_link = l;
-		req->pending_id = fn->process(f, req);
-	} else {
-		voicecall_filter_request_complete(req, fn->allow);
-	}
+	voicecall_filter_request_complete(req, complete);
 	voicecall_filter_request_unref(req);
 }
 
@@ -200,11 +218,7 @@ static gboolean voicecall_filter_request_continue_cb(gpointer data)
 
 	req->next_id = 0;
 	req->filter_link = req->filter_link->next;
-	if (req->filter_link) {
-		voicecall_filter_request_process(req);
-	} else {
-		voicecall_filter_request_complete(req, req->fn->allow);
-	}
+	voicecall_filter_request_process(req);
 	return G_SOURCE_REMOVE;
 }
 
@@ -239,26 +253,37 @@ static gboolean voicecall_filter_request_dial_block_cb(gpointer data)
 	return G_SOURCE_REMOVE;
 }
 
-static void voicecall_filter_request_dial_cb
-		(enum ofono_voicecall_filter_dial_result result, void *data)
+/* Returns NULL if the next filter has to be run */
+static voicecall_filter_request_complete_fn
+	voicecall_filter_request_dial_verdict
+		(struct voicecall_filter_request_dial *dial,
+			enum ofono_voicecall_filter_dial_result result)
 {
-	struct voicecall_filter_request_dial *dial = data;
 	struct voicecall_filter_request *req = &dial->req;
 	const struct ofono_voicecall_filter *filter = req->filter_link->data;
-	GSourceFunc next_cb;
 
 	if (result == OFONO_VOICECALL_FILTER_DIAL_BLOCK) {
 		ofono_info("%s is refusing to dial %s", filter->name,
 					phone_number_to_string(dial->number));
-		next_cb = voicecall_filter_request_dial_block_cb;
-	} else {
-		/* OFONO_VOICECALL_FILTER_DIAL_CONTINUE */
-		DBG("%s is ok with dialing %s", filter->name,
-					phone_number_to_string(dial->number));
-		next_cb = voicecall_filter_request_continue_cb;
+		return voicecall_filter_request_dial_block_complete_cb;
 	}
 
-	voicecall_filter_request_next(req, next_cb);
+	/* OFONO_VOICECALL_FILTER_DIAL_CONTINUE */
+	DBG("%s is ok with dialing %s", filter->name,
+				phone_number_to_string(dial->number));
+	return NULL;
+}
+
+static void voicecall_filter_request_dial_cb
+		(enum ofono_voicecall_filter_dial_result result, void *data)
+{
+	struct voicecall_filter_request_dial *dial = data;
+	struct voicecall_filter_request *req = &dial->req;
+
+	voicecall_filter_request_next(req,
+		voicecall_filter_request_dial_verdict(dial, result) ?
+				voicecall_filter_request_dial_block_cb :
+				voicecall_filter_request_continue_cb);
 }
 
 static gboolean voicecall_filter_request_dial_can_process
@@ -278,6 +303,24 @@ static guint voicecall_filter_request_dial_process
 				voicecall_filter_request_dial_cb, dial);
 }
 
+static gboolean voicecall_filter_request_dial_can_check
+				(const struct ofono_voicecall_filter *f)
+{
+	return f->api_version >= 1 && f->filter_dial_sync != NULL;
+}
+
+static voicecall_filter_request_complete_fn
+	voicecall_filter_request_dial_check
+				(const struct ofono_voicecall_filter *f,
+					struct voicecall_filter_request *req)
+{
+	struct voicecall_filter_request_dial *dial =
+				voicecall_filter_request_dial_cast(req);
+
+	return voicecall_filter_request_dial_verdict(dial,
+		f->filter_dial_sync(req->chain->vc, dial->number, dial->clir));
+}
+
 static void voicecall_filter_request_dial_allow
 					(struct voicecall_filter_request *req)
 {
@@ -304,6 +347,8 @@ static struct voicecall_filter_request *voicecall_filter_request_dial_new
 		.name = "dial",
 		.can_process = voicecall_filter_request_dial_can_process,
 		.process = voicecall_filter_request_dial_process,
+		.can_check = voicecall_filter_request_dial_can_check,
+		.check = voicecall_filter_request_dial_check,
 		.allow = voicecall_filter_request_dial_allow,
 		.free = voicecall_filter_request_dial_free
 	};
@@ -370,28 +415,46 @@ static gboolean voicecall_filter_request_incoming_ignore_cb(gpointer data)
 	return G_SOURCE_REMOVE;
 }
 
-static void voicecall_filter_request_incoming_cb
-		(enum ofono_voicecall_filter_incoming_result result, void *data)
+/* Returns NULL if the next filter has to be run */
+static voicecall_filter_request_complete_fn
+	voicecall_filter_request_incoming_verdict
+		(struct voicecall_filter_request *req,
+			enum ofono_voicecall_filter_incoming_result result)
 {
-	struct voicecall_filter_request_incoming *in = data;
-	struct voicecall_filter_request *req = &in->req;
 	const struct ofono_voicecall_filter *filter = req->filter_link->data;
-	GSourceFunc next_cb;
 
 	if (result == OFONO_VOICECALL_FILTER_INCOMING_HANGUP) {
 		ofono_info("%s hangs up incoming call from %s", filter->name,
 			phone_number_to_string(&req->call->phone_number));
-		next_cb = voicecall_filter_request_incoming_hangup_cb;
+		return voicecall_filter_request_incoming_hangup_complete_cb;
 	} else if (result == OFONO_VOICECALL_FILTER_INCOMING_IGNORE) {
 		ofono_info("%s ignores incoming call from %s", filter->name,
 			phone_number_to_string(&req->call->phone_number));
-		next_cb = voicecall_filter_request_incoming_ignore_cb;
-	} else {
-		/* OFONO_VOICECALL_FILTER_INCOMING_CONTINUE */
-		DBG("%s is ok with accepting %s", filter->name,
+		return voicecall_filter_request_incoming_ignore_complete_cb;
+	}
+
+	/* OFONO_VOICECALL_FILTER_INCOMING_CONTINUE */
+	DBG("%s is ok with accepting %s", filter->name,
 			phone_number_to_string(&req->call->phone_number));
+	return NULL;
+}
+
+static void voicecall_filter_request_incoming_cb
+		(enum ofono_voicecall_filter_incoming_result result, void *data)
+{
+	struct voicecall_filter_request_incoming *in = data;
+	struct voicecall_filter_request *req = &in->req;
+	voicecall_filter_request_complete_fn complete =
+			voicecall_filter_request_incoming_verdict(req, result);
+	GSourceFunc next_cb;
+
+	if (complete == voicecall_filter_request_incoming_hangup_complete_cb)
+		next_cb = voicecall_filter_request_incoming_hangup_cb;
+	else if (complete ==
+			voicecall_filter_request_incoming_ignore_complete_cb)
+		next_cb = voicecall_filter_request_incoming_ignore_cb;
+	else
 		next_cb = voicecall_filter_request_continue_cb;
-	}
 
 	voicecall_filter_request_next(req, next_cb);
 }
@@ -411,6 +474,21 @@ static guint voicecall_filter_request_incoming_process
 				voicecall_filter_request_incoming_cast(req));
 }
 
+static gboolean voicecall_filter_request_incoming_can_check
+				(const struct ofono_voicecall_filter *f)
+{
+	return f->api_version >= 1 && f->filter_incoming_sync != NULL;
+}
+
+static voicecall_filter_request_complete_fn
+	voicecall_filter_request_incoming_check
+				(const struct ofono_voicecall_filter *f,
+					struct voicecall_filter_request *req)
+{
+	return voicecall_filter_request_incoming_verdict(req,
+			f->filter_incoming_sync(req->chain->vc, req->call));
+}
+
 static void voicecall_filter_request_incoming_allow
 					(struct voicecall_filter_request *req)
 {
@@ -435,6 +513,8 @@ static struct voicecall_filter_request *voicecall_filter_request_incoming_new
 		.name = "incoming",
 		.can_process = voicecall_filter_request_incoming_can_process,
 		.process = voicecall_filter_request_incoming_process,
+		.can_check = voicecall_filter_request_incoming_can_check,
+		.check = voicecall_filter_request_incoming_check,
 		.allow = voicecall_filter_request_incoming_allow,
 		.free = voicecall_filter_request_incoming_free
 	};
@@ -1637,30 +1637,43 @@ static void filter_incoming_cb(enum ofono_voicecall_filter_incoming_result res,
 
 void ofono_voicecall_filter_notify(struct ofono_voicecall *vc)
 {
+	GSList *incoming;
+	GSList *calls;
 	GSList *l;
 	struct voicecall *v;
 
 	/* Cancel all active filtering requests */
 	__ofono_voicecall_filter_chain_cancel(vc->filters, NULL);
 
+	/*
+	 * Synchronous filters complete inline, and filter_incoming_cb
+	 * moves the call out of incoming_filter_list or destroys it
+	 * before we get to the next one. Walk copies of both lists.
+	 */
+	incoming = g_slist_copy(vc->incoming_filter_list);
+	calls = g_slist_copy(vc->call_list);
+
 	/* Re-check incoming_filter_list */
-	for (l = vc->incoming_filter_list; l; l = l->next) {
+	for (l = incoming; l; l = l->next) {
 		v = l->data;
 		__ofono_voicecall_filter_chain_incoming(vc->filters, v->call,
 						filter_incoming_cb, NULL, v);
 	}
 
 	/* Re-check the calls that have already passed the filter */
-	for (l = vc->call_list; l; l = l->next) {
+	for (l = calls; l; l = l->next) {
 		v = l->data;
 		if (v->call->direction == CALL_DIRECTION_MOBILE_ORIGINATED) {
 			__ofono_voicecall_filter_chain_dial_check(vc->filters,
 				v->call, filter_dial_check_cb, NULL, v);
-                } else {
+		} else {
 			__ofono_voicecall_filter_chain_incoming(vc->filters,
 				v->call, filter_incoming_check_cb, NULL, v);
-                }
+		}
 	}
+
+	g_slist_free(incoming);
+	g_slist_free(calls);
 }
 
 static void dial_filter_cb(enum ofono_voicecall_filter_dial_result result,
@@ -0,0 +1,1062 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+/*
+ * A stand-in for phonesim that simulates any number of modems at once,
+ * just enough of them for the phonesim driver and the atmodem atoms to
+ * bring up the SIM, network registration, voice calls, SMS, USSD and
+ * cell broadcasts.  Every connection to the port is a modem of its own,
+ * numbered in the order in which they connect, and its serial number
+ * (+CGSN) is "sim<number>".
+ *
+ * Network events are triggered by writing lines to stdin:
+ *
+ *	call MODEM [SEQ]	incoming call from +35840<SEQ>
+ *	hangup MODEM		remote end hangs up all calls
+ *	sms MODEM [SEQ]		new SMS saying "load <SEQ>"
+ *	ussd MODEM [SEQ]	network initiated USSD "load <SEQ>"
+ *	cbs MODEM [SEQ]		cell broadcast "load <SEQ>" on topic 50
+ *	creg MODEM		hand over to the next cell
+ *	csq MODEM		signal strength changes
+ *
+ * where MODEM is either a number or '*' for all of them.  Use --conf to
+ * generate a phonesim.conf for the modems.  See test/load-modems for a
+ * load generator driving all this.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include <glib.h>
+
+#include "gatserver.h"
+
+#define SIM_DEFAULT_PORT	12345
+#define SIM_SMS_SLOTS		16
+#define SIM_MAX_CALLS		7
+#define SIM_CBS_TOPIC		50
+#define SIM_SIGNAL_INDEX	2	/* Position of "signal" in +CIND */
+
+struct sim_call {
+	int id;
+	int dir;
+	int status;
+	char number[24];
+};
+
+struct sim_modem {
+	unsigned int index;
+	GAtServer *server;
+	int cfun;
+	int cops_format;
+	int cell;
+	int signal;
+	struct sim_call calls[SIM_MAX_CALLS];
+	char *sms[SIM_SMS_SLOTS];
+	unsigned int sms_len[SIM_SMS_SLOTS];
+};
+
+/* Commands that only need canned answers */
+struct sim_reply {
+	const char *prefix;
+	const char *query;	/* Answer to AT<prefix>? */
+	const char *support;	/* Answer to AT<prefix>=? */
+	const char *command;	/* Answer to AT<prefix> */
+};
+
+static const struct sim_reply sim_replies[] = {
+	{ "+CGMI", NULL, NULL, "oFono" },
+	{ "+CGMM", NULL, NULL, "Load simulator" },
+	{ "+CGMR", NULL, NULL, "1.0" },
+	{ "+GCAP", NULL, NULL, "+GCAP: +CGSM" },
+	{ "+CSCS", "+CSCS: \"GSM\"", "+CSCS: (\"GSM\")", NULL },
+	{ "+CBC", NULL, NULL, "+CBC: 0,80" },
+	{ "+SIMSTATE", "+SIMSTATE: 1", NULL, NULL },
+	{ "+CPIN", "+CPIN: READY", NULL, NULL },
+	{ "+CREG", NULL, "+CREG: (0-2)", NULL },
+	{ "+CIND", "+CIND: 5,3,1,0,0,0", "+CIND: (\"battchg\",(0-5)),"
+			"(\"signal\",(0-5)),(\"service\",(0,1)),"
+			"(\"call\",(0,1)),(\"roam\",(0,1)),"
+			"(\"smsfull\",(0,1))", NULL },
+	{ "+CMER", NULL, "+CMER: (0-3),(0),(0),(0-2),(0,1)", NULL },
+	{ "+CSMS", "+CSMS: 0,1,1,1", "+CSMS: (0)", NULL },
+	{ "+CMGF", "+CMGF: 0", "+CMGF: (0)", NULL },
+	{ "+CPMS", NULL, "+CPMS: (\"ME\"),(\"ME\"),(\"ME\")", NULL },
+	{ "+CNMI", NULL, "+CNMI: (0-3),(0-3),(0-3),(0-2),(0,1)", NULL },
+	{ "+CSCA", "+CSCA: \"+358501234567\",145", NULL, NULL },
+	{ "+CMGL", NULL, NULL, NULL },
+	{ "+CSCB", "+CSCB: 0,\"\",\"\"", "+CSCB: (0,1)", NULL },
+	{ "+CLIP", "+CLIP: 1,1", NULL, NULL },
+	{ "+CRC", NULL, NULL, NULL },
+	{ "+CDIP", NULL, NULL, NULL },
+	{ "+CNAP", NULL, NULL, NULL },
+	{ "+COLP", NULL, NULL, NULL },
+	{ "+CSSN", NULL, NULL, NULL },
+	{ "+CCWA", NULL, NULL, NULL },
+	{ "+CUSD", "+CUSD: 1", "+CUSD: (0-2)", NULL },
+	{ "+CNMA", NULL, NULL, NULL },
+	{ NULL }
+};
+
+/* Transparent EFs of the SIM, everything else is not found */
+struct sim_ef {
+	int id;
+	unsigned int len;
+	const unsigned char *data;
+};
+
+static const unsigned char ef_iccid[] = {
+	0x98, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+};
+static const unsigned char ef_ad[] = { 0x00, 0x00, 0x00, 0x02 };
+static const unsigned char ef_spn[] = {
+	0x01, 'o', 'F', 'o', 'n', 'o', 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+static const struct sim_ef sim_efs[] = {
+	{ 0x2fe2, sizeof(ef_iccid), ef_iccid },
+	{ 0x6fad, sizeof(ef_ad), ef_ad },
+	{ 0x6f46, sizeof(ef_spn), ef_spn },
+	{ 0 }
+};
+
+static gboolean option_version = FALSE;
+static gint option_port = SIM_DEFAULT_PORT;
+static gint option_conf = 0;
+static gboolean option_debug = FALSE;
+
+static GPtrArray *modems;
+static GMainLoop *main_loop;
+
+static void reply(GAtServer *server, const char *line)
+{
+	if (line)
+		g_at_server_send_info(server, line, TRUE);
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void canned_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	const struct sim_reply *r = user;
+
+	switch (type) {
+	case G_AT_SERVER_REQUEST_TYPE_QUERY:
+		if (r->query == NULL)
+			break;
+
+		reply(server, r->query);
+		return;
+	case G_AT_SERVER_REQUEST_TYPE_SUPPORT:
+		if (r->support == NULL)
+			break;
+
+		reply(server, r->support);
+		return;
+	case G_AT_SERVER_REQUEST_TYPE_COMMAND_ONLY:
+	case G_AT_SERVER_REQUEST_TYPE_SET:
+		reply(server, r->command);
+		return;
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+}
+
+static const struct sim_reply *find_reply(const char *prefix)
+{
+	const struct sim_reply *r;
+
+	for (r = sim_replies; r->prefix; r++)
+		if (g_str_equal(r->prefix, prefix))
+			break;
+
+	return r;
+}
+
+static gboolean next_set_number(GAtResultIter *iter, GAtResult *cmd,
+								int *out)
+{
+	g_at_result_iter_init(iter, cmd);
+	g_at_result_iter_next(iter, "");
+
+	return g_at_result_iter_next_number(iter, out);
+}
+
+static void cgsn_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	char buf[16];
+
+	snprintf(buf, sizeof(buf), "sim%u", modem->index);
+	reply(server, buf);
+}
+
+static void cimi_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	char buf[16];
+
+	snprintf(buf, sizeof(buf), "24499%010u", modem->index);
+	reply(server, buf);
+}
+
+static void cfun_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	GAtResultIter iter;
+	char buf[16];
+
+	switch (type) {
+	case G_AT_SERVER_REQUEST_TYPE_QUERY:
+		snprintf(buf, sizeof(buf), "+CFUN: %d", modem->cfun);
+		reply(server, buf);
+		return;
+	case G_AT_SERVER_REQUEST_TYPE_SUPPORT:
+		reply(server, "+CFUN: (0,1,4)");
+		return;
+	case G_AT_SERVER_REQUEST_TYPE_SET:
+		if (!next_set_number(&iter, cmd, &modem->cfun))
+			break;
+
+		reply(server, NULL);
+		return;
+	default:
+		break;
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+}
+
+static void format_creg(struct sim_modem *modem, const char *prefix,
+						char *buf, size_t len)
+{
+	snprintf(buf, len, "%s1,\"%04X\",\"%04X\",7", prefix,
+				0x1000 + modem->index, 0x2000 + modem->cell);
+}
+
+static void creg_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	char buf[64];
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_QUERY)
+		return canned_cb(server, type, cmd,
+					(gpointer) find_reply("+CREG"));
+
+	format_creg(modem, "+CREG: 2,", buf, sizeof(buf));
+	reply(server, buf);
+}
+
+static void cops_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	GAtResultIter iter;
+	int mode;
+
+	switch (type) {
+	case G_AT_SERVER_REQUEST_TYPE_QUERY:
+		reply(server, modem->cops_format == 2 ?
+				"+COPS: 0,2,\"24499\",7" :
+				"+COPS: 0,0,\"oFono\",7");
+		return;
+	case G_AT_SERVER_REQUEST_TYPE_SUPPORT:
+		reply(server, "+COPS: (2,\"oFono\",\"oFono\",\"24499\",7),,"
+				"(0-4),(0-2)");
+		return;
+	case G_AT_SERVER_REQUEST_TYPE_SET:
+		if (!next_set_number(&iter, cmd, &mode))
+			break;
+
+		if (mode == 3 && !g_at_result_iter_next_number(&iter,
+							&modem->cops_format))
+			break;
+
+		reply(server, NULL);
+		return;
+	default:
+		break;
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+}
+
+static void csq_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	char buf[16];
+
+	snprintf(buf, sizeof(buf), "+CSQ: %d,99", modem->signal * 6);
+	reply(server, buf);
+}
+
+static void cpms_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	unsigned int used = 0;
+	unsigned int i;
+	char buf[64];
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_SET)
+		return canned_cb(server, type, cmd,
+					(gpointer) find_reply("+CPMS"));
+
+	for (i = 0; i < SIM_SMS_SLOTS; i++)
+		if (modem->sms[i])
+			used++;
+
+	snprintf(buf, sizeof(buf), "+CPMS: %u,%u,%u,%u,%u,%u", used,
+			SIM_SMS_SLOTS, used, SIM_SMS_SLOTS, used,
+			SIM_SMS_SLOTS);
+	reply(server, buf);
+}
+
+static void cmgr_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	GAtResultIter iter;
+	char buf[32];
+	int index;
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_SET ||
+			!next_set_number(&iter, cmd, &index) ||
+			index < 0 || index >= SIM_SMS_SLOTS ||
+			modem->sms[index] == NULL) {
+		g_at_server_send_ext_final(server, "+CMS ERROR: 321");
+		return;
+	}
+
+	snprintf(buf, sizeof(buf), "+CMGR: 0,,%u", modem->sms_len[index]);
+	g_at_server_send_info(server, buf, FALSE);
+	g_at_server_send_info(server, modem->sms[index], TRUE);
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void cmgd_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	GAtResultIter iter;
+	int index;
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_SET ||
+			!next_set_number(&iter, cmd, &index) ||
+			index < 0 || index >= SIM_SMS_SLOTS) {
+		g_at_server_send_ext_final(server, "+CMS ERROR: 321");
+		return;
+	}
+
+	g_free(modem->sms[index]);
+	modem->sms[index] = NULL;
+	reply(server, NULL);
+}
+
+static void crsm_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	const struct sim_ef *ef;
+	GAtResultIter iter;
+	int command, fileid;
+	int p1 = 0, p2 = 0, p3 = 0;
+	GString *out;
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_SET ||
+			!next_set_number(&iter, cmd, &command) ||
+			!g_at_result_iter_next_number(&iter, &fileid)) {
+		g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+		return;
+	}
+
+	g_at_result_iter_next_number(&iter, &p1);
+	g_at_result_iter_next_number(&iter, &p2);
+	g_at_result_iter_next_number(&iter, &p3);
+
+	for (ef = sim_efs; ef->id; ef++)
+		if (ef->id == fileid)
+			break;
+
+	out = g_string_new("+CRSM: ");
+
+	if (ef->id == 0) {
+		/* 6A82, file not found */
+		g_string_append(out, "106,130");
+	} else if (command == 192) {
+		/* GSM 11.11 response to GET RESPONSE of a transparent EF */
+		g_string_append_printf(out, "144,0,0000%04X%04X040000000001"
+						"020000", ef->len, ef->id);
+	} else if (command == 176 && (unsigned int) ((p1 << 8) | p2) +
+							p3 <= ef->len) {
+		unsigned int offset = (p1 << 8) | p2;
+		unsigned int len = p3 ? (unsigned int) p3 : ef->len - offset;
+		unsigned int i;
+
+		g_string_append(out, "144,0,");
+
+		for (i = 0; i < len; i++)
+			g_string_append_printf(out, "%02X",
+						ef->data[offset + i]);
+	} else {
+		/* 6B00, wrong parameters */
+		g_string_append(out, "107,0");
+	}
+
+	reply(server, out->str);
+	g_string_free(out, TRUE);
+}
+
+static struct sim_call *find_call(struct sim_modem *modem, int status)
+{
+	unsigned int i;
+
+	for (i = 0; i < SIM_MAX_CALLS; i++)
+		if (modem->calls[i].id && (status < 0 ||
+					modem->calls[i].status == status))
+			return modem->calls + i;
+
+	return NULL;
+}
+
+static struct sim_call *new_call(struct sim_modem *modem, int dir,
+				int status, const char *number)
+{
+	unsigned int i;
+
+	for (i = 0; i < SIM_MAX_CALLS; i++) {
+		struct sim_call *call = modem->calls + i;
+
+		if (call->id)
+			continue;
+
+		call->id = i + 1;
+		call->dir = dir;
+		call->status = status;
+		g_strlcpy(call->number, number, sizeof(call->number));
+		return call;
+	}
+
+	return NULL;
+}
+
+static void clcc_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	unsigned int i;
+
+	for (i = 0; i < SIM_MAX_CALLS; i++) {
+		struct sim_call *call = modem->calls + i;
+		char buf[64];
+
+		if (call->id == 0)
+			continue;
+
+		snprintf(buf, sizeof(buf), "+CLCC: %d,%d,%d,0,0,\"%s\",145",
+				call->id, call->dir, call->status,
+				call->number);
+		g_at_server_send_info(server, buf, TRUE);
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void dial_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	GAtResultIter iter;
+	const char *str;
+	char number[24];
+
+	g_at_result_iter_init(&iter, cmd);
+	g_at_result_iter_next(&iter, "");
+
+	str = g_at_result_iter_raw_line(&iter);
+	if (str == NULL || *str == '\0') {
+		g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+		return;
+	}
+
+	g_strlcpy(number, str, sizeof(number));
+	number[strcspn(number, ";")] = '\0';
+
+	/* The other end answers right away */
+	if (new_call(modem, 0, 0, number) == NULL) {
+		g_at_server_send_final(server, G_AT_SERVER_RESULT_BUSY);
+		return;
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void answer_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	struct sim_call *call = find_call(modem, 4);
+
+	if (call == NULL) {
+		g_at_server_send_final(server,
+					G_AT_SERVER_RESULT_NO_CARRIER);
+		return;
+	}
+
+	call->status = 0;
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void chup_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+
+	memset(modem->calls, 0, sizeof(modem->calls));
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void chld_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	struct sim_modem *modem = user;
+	GAtResultIter iter;
+	unsigned int i;
+	int op;
+
+	if (type == G_AT_SERVER_REQUEST_TYPE_SUPPORT) {
+		reply(server, "+CHLD: (0,1,1x,2,2x,3,4)");
+		return;
+	}
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_SET ||
+			!next_set_number(&iter, cmd, &op)) {
+		g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+		return;
+	}
+
+	/* Only the releases matter to the load tests */
+	for (i = 0; i < SIM_MAX_CALLS; i++) {
+		struct sim_call *call = modem->calls + i;
+
+		if (call->id == 0)
+			continue;
+
+		if ((op == 0 && call->status != 0) ||
+				(op == 1 && call->status == 0) ||
+				op == 10 + call->id)
+			memset(call, 0, sizeof(*call));
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+}
+
+static void cusd_cb(GAtServer *server, GAtServerRequestType type,
+					GAtResult *cmd, gpointer user)
+{
+	GAtResultIter iter;
+	const char *str;
+	int mode;
+
+	if (type != G_AT_SERVER_REQUEST_TYPE_SET)
+		return canned_cb(server, type, cmd,
+					(gpointer) find_reply("+CUSD"));
+
+	if (!next_set_number(&iter, cmd, &mode)) {
+		g_at_server_send_final(server, G_AT_SERVER_RESULT_ERROR);
+		return;
+	}
+
+	g_at_server_send_final(server, G_AT_SERVER_RESULT_OK);
+
+	/* Every request gets the same answer */
+	if (g_at_result_iter_next_string(&iter, &str))
+		g_at_server_send_unsolicited(server,
+					"+CUSD: 0,\"Balance: 42\",15");
+}
+
+/* GSM 7 bit default alphabet matches ASCII for the text we send */
+static unsigned int pack_7bit(const char *text, unsigned int septets,
+							unsigned char *out)
+{
+	unsigned int bits = 0;
+	unsigned int len = 0;
+	unsigned int acc = 0;
+	unsigned int i;
+
+	for (i = 0; i < septets; i++) {
+		acc |= (text[i] & 0x7f) << bits;
+		bits += 7;
+
+		while (bits >= 8) {
+			out[len++] = acc & 0xff;
+			acc >>= 8;
+			bits -= 8;
+		}
+	}
+
+	if (bits)
+		out[len++] = acc & 0xff;
+
+	return len;
+}
+
+static char *to_hex(const unsigned char *data, unsigned int len)
+{
+	char *hex = g_malloc(len * 2 + 1);
+	unsigned int i;
+
+	for (i = 0; i < len; i++)
+		sprintf(hex + i * 2, "%02X", data[i]);
+
+	hex[len * 2] = '\0';
+
+	return hex;
+}
+
+static void event_sms(struct sim_modem *modem, unsigned int seq)
+{
+	/* No SMSC address, SMS-DELIVER from +35840123456 */
+	static const unsigned char head[] = {
+		0x00, 0x04, 0x0b, 0x91, 0x53, 0x48, 0x10, 0x32, 0x54, 0xf6,
+		0x00, 0x00, 0x62, 0x01, 0x91, 0x21, 0x00, 0x00, 0x00
+	};
+	unsigned char pdu[sizeof(head) + 1 + 140];
+	char text[32];
+	char buf[32];
+	unsigned int septets;
+	unsigned int len;
+	int slot;
+
+	for (slot = 0; slot < SIM_SMS_SLOTS; slot++)
+		if (modem->sms[slot] == NULL)
+			break;
+
+	if (slot == SIM_SMS_SLOTS) {
+		g_printerr("sim%u: SMS storage full\n", modem->index);
+		return;
+	}
+
+	septets = snprintf(text, sizeof(text), "load %u", seq);
+	memcpy(pdu, head, sizeof(head));
+	pdu[sizeof(head)] = septets;
+	len = sizeof(head) + 1 + pack_7bit(text, septets,
+						pdu + sizeof(head) + 1);
+
+	modem->sms[slot] = to_hex(pdu, len);
+	modem->sms_len[slot] = len - 1;
+
+	snprintf(buf, sizeof(buf), "+CMTI: \"ME\",%d", slot);
+	g_at_server_send_unsolicited(modem->server, buf);
+}
+
+static void event_cbs(struct sim_modem *modem, unsigned int seq)
+{
+	unsigned char pdu[88];
+	char text[94];
+	char *hex;
+	char *line;
+	unsigned int len;
+
+	/* The message code changes, so that these aren't duplicates */
+	pdu[0] = (seq >> 4) & 0x3f;
+	pdu[1] = (seq << 4) & 0xf0;
+	pdu[2] = SIM_CBS_TOPIC >> 8;
+	pdu[3] = SIM_CBS_TOPIC & 0xff;
+	pdu[4] = 0x0f;
+	pdu[5] = 0x11;
+
+	len = snprintf(text, sizeof(text), "load %u", seq);
+	memset(text + len, '\r', sizeof(text) - len);
+	pack_7bit(text, 93, pdu + 6);
+
+	hex = to_hex(pdu, sizeof(pdu));
+	line = g_strdup_printf("+CBM: %u\r\n%s", (unsigned int) sizeof(pdu),
+									hex);
+	g_at_server_send_unsolicited(modem->server, line);
+	g_free(line);
+	g_free(hex);
+}
+
+static void event_call(struct sim_modem *modem, unsigned int seq)
+{
+	char number[24];
+	char buf[48];
+
+	snprintf(number, sizeof(number), "+35840%u", seq);
+
+	if (new_call(modem, 1, 4, number) == NULL) {
+		g_printerr("sim%u: too many calls\n", modem->index);
+		return;
+	}
+
+	g_at_server_send_unsolicited(modem->server, "+CRING: VOICE");
+	snprintf(buf, sizeof(buf), "+CLIP: \"%s\",145,,,,0", number);
+	g_at_server_send_unsolicited(modem->server, buf);
+}
+
+static void event_hangup(struct sim_modem *modem)
+{
+	if (find_call(modem, -1) == NULL)
+		return;
+
+	memset(modem->calls, 0, sizeof(modem->calls));
+	g_at_server_send_unsolicited(modem->server, "NO CARRIER");
+}
+
+static void event_ussd(struct sim_modem *modem, unsigned int seq)
+{
+	char buf[48];
+
+	snprintf(buf, sizeof(buf), "+CUSD: 0,\"load %u\",15", seq);
+	g_at_server_send_unsolicited(modem->server, buf);
+}
+
+static void event_creg(struct sim_modem *modem)
+{
+	char buf[48];
+
+	modem->cell = (modem->cell + 1) & 0xfff;
+	format_creg(modem, "+CREG: ", buf, sizeof(buf));
+	g_at_server_send_unsolicited(modem->server, buf);
+}
+
+static void event_csq(struct sim_modem *modem)
+{
+	char buf[16];
+
+	modem->signal = modem->signal % 5 + 1;
+	snprintf(buf, sizeof(buf), "+CIEV: %d,%d", SIM_SIGNAL_INDEX,
+							modem->signal);
+	g_at_server_send_unsolicited(modem->server, buf);
+}
+
+static void modem_event(struct sim_modem *modem, const char *event,
+							unsigned int seq)
+{
+	if (modem->server == NULL)
+		return;
+
+	if (g_str_equal(event, "call"))
+		event_call(modem, seq);
+	else if (g_str_equal(event, "hangup"))
+		event_hangup(modem);
+	else if (g_str_equal(event, "sms"))
+		event_sms(modem, seq);
+	else if (g_str_equal(event, "ussd"))
+		event_ussd(modem, seq);
+	else if (g_str_equal(event, "cbs"))
+		event_cbs(modem, seq);
+	else if (g_str_equal(event, "creg"))
+		event_creg(modem);
+	else if (g_str_equal(event, "csq"))
+		event_csq(modem);
+	else
+		g_printerr("Unknown event %s\n", event);
+}
+
+static void control_line(const char *line)
+{
+	char **argv = g_strsplit_set(line, " \t\r\n", 0);
+	unsigned int argc = g_strv_length(argv);
+	unsigned int seq = 0;
+	unsigned int i;
+
+	if (argc < 2 || argv[0][0] == '\0') {
+		g_strfreev(argv);
+		return;
+	}
+
+	if (argc > 2)
+		seq = strtoul(argv[2], NULL, 10);
+
+	if (g_str_equal(argv[1], "*")) {
+		for (i = 0; i < modems->len; i++)
+			modem_event(modems->pdata[i], argv[0], seq);
+	} else {
+		i = strtoul(argv[1], NULL, 10);
+
+		if (i < modems->len)
+			modem_event(modems->pdata[i], argv[0], seq);
+		else
+			g_printerr("No modem %s\n", argv[1]);
+	}
+
+	g_strfreev(argv);
+}
+
+static gboolean control_event(GIOChannel *io, GIOCondition cond,
+							gpointer user)
+{
+	GIOStatus status;
+	gchar *line;
+
+	if (cond & (G_IO_HUP | G_IO_ERR))
+		goto quit;
+
+	status = g_io_channel_read_line(io, &line, NULL, NULL, NULL);
+
+	if (status == G_IO_STATUS_AGAIN)
+		return TRUE;
+
+	if (status != G_IO_STATUS_NORMAL)
+		goto quit;
+
+	control_line(line);
+	g_free(line);
+
+	return TRUE;
+
+quit:
+	g_main_loop_quit(main_loop);
+	return FALSE;
+}
+
+static void server_debug(const char *str, gpointer user)
+{
+	g_print("%s: %s\n", (const char *) user, str);
+}
+
+static void modem_disconnect(gpointer user)
+{
+	struct sim_modem *modem = user;
+	unsigned int i;
+
+	g_print("sim%u disconnected\n", modem->index);
+
+	g_at_server_unref(modem->server);
+	modem->server = NULL;
+
+	for (i = 0; i < SIM_SMS_SLOTS; i++) {
+		g_free(modem->sms[i]);
+		modem->sms[i] = NULL;
+	}
+
+	memset(modem->calls, 0, sizeof(modem->calls));
+}
+
+static void modem_register(struct sim_modem *modem)
+{
+	GAtServer *server = modem->server;
+	const struct sim_reply *r;
+
+	for (r = sim_replies; r->prefix; r++)
+		g_at_server_register(server, r->prefix, canned_cb,
+							(gpointer) r, NULL);
+
+	g_at_server_register(server, "+CGSN", cgsn_cb, modem, NULL);
+	g_at_server_register(server, "+CIMI", cimi_cb, modem, NULL);
+	g_at_server_register(server, "+CFUN", cfun_cb, modem, NULL);
+	g_at_server_register(server, "+COPS", cops_cb, modem, NULL);
+	g_at_server_register(server, "+CSQ", csq_cb, modem, NULL);
+	g_at_server_register(server, "+CPMS", cpms_cb, modem, NULL);
+	g_at_server_register(server, "+CMGR", cmgr_cb, modem, NULL);
+	g_at_server_register(server, "+CMGD", cmgd_cb, modem, NULL);
+	g_at_server_register(server, "+CRSM", crsm_cb, modem, NULL);
+	g_at_server_register(server, "+CLCC", clcc_cb, modem, NULL);
+	g_at_server_register(server, "+CHUP", chup_cb, modem, NULL);
+	g_at_server_register(server, "+CHLD", chld_cb, modem, NULL);
+	g_at_server_register(server, "D", dial_cb, modem, NULL);
+	g_at_server_register(server, "A", answer_cb, modem, NULL);
+	g_at_server_register(server, "H", chup_cb, modem, NULL);
+
+	/* These replace the canned answers of some requests */
+	g_at_server_register(server, "+CREG", creg_cb, modem, NULL);
+	g_at_server_register(server, "+CUSD", cusd_cb, modem, NULL);
+}
+
+static gboolean new_connection(GIOChannel *io, GIOCondition cond,
+							gpointer user)
+{
+	struct sim_modem *modem;
+	GIOChannel *client;
+	int fd;
+
+	fd = accept(g_io_channel_unix_get_fd(io), NULL, NULL);
+	if (fd < 0)
+		return TRUE;
+
+	client = g_io_channel_unix_new(fd);
+	g_io_channel_set_close_on_unref(client, TRUE);
+
+	modem = g_new0(struct sim_modem, 1);
+	modem->index = modems->len;
+	modem->cfun = 0;
+	modem->signal = 3;
+	modem->server = g_at_server_new(client);
+	g_io_channel_unref(client);
+
+	if (modem->server == NULL) {
+		g_free(modem);
+		return TRUE;
+	}
+
+	g_ptr_array_add(modems, modem);
+
+	g_at_server_set_echo(modem->server, FALSE);
+	g_at_server_set_disconnect_function(modem->server,
+						modem_disconnect, modem);
+
+	if (option_debug)
+		g_at_server_set_debug(modem->server, server_debug,
+					g_strdup_printf("sim%u", modem->index));
+
+	modem_register(modem);
+
+	g_print("sim%u connected\n", modem->index);
+
+	return TRUE;
+}
+
+static GIOChannel *listen_port(int port)
+{
+	struct sockaddr_in addr;
+	GIOChannel *io;
+	int one = 1;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return NULL;
+
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+
+	if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+			listen(fd, 128) < 0) {
+		g_printerr("Unable to listen on port %d: %s\n", port,
+							strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	io = g_io_channel_unix_new(fd);
+	g_io_channel_set_close_on_unref(io, TRUE);
+
+	return io;
+}
+
+static void print_conf(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		printf("[load%d]\nAddress=127.0.0.1\nPort=%d\n"
+				"Driver=phonesim\n\n", i, option_port);
+}
+
+static void modem_free(gpointer data)
+{
+	struct sim_modem *modem = data;
+
+	if (modem->server) {
+		g_at_server_set_disconnect_function(modem->server,
+								NULL, NULL);
+		modem_disconnect(modem);
+	}
+
+	g_free(modem);
+}
+
+static GOptionEntry options[] = {
+	{ "version", 'v', 0, G_OPTION_ARG_NONE, &option_version,
+				"Show version information and exit" },
+	{ "port", 'p', 0, G_OPTION_ARG_INT, &option_port,
+				"TCP port to listen on", "PORT" },
+	{ "conf", 'c', 0, G_OPTION_ARG_INT, &option_conf,
+				"Print phonesim.conf for N modems and exit",
+				"N" },
+	{ "debug", 'd', 0, G_OPTION_ARG_NONE, &option_debug,
+				"Show the AT traffic" },
+	{ NULL },
+};
+
+int main(int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	GIOChannel *listener;
+	GIOChannel *control;
+
+	context = g_option_context_new(NULL);
+	g_option_context_add_main_entries(context, options, NULL);
+
+	if (g_option_context_parse(context, &argc, &argv, &error) == FALSE) {
+		if (error != NULL) {
+			g_printerr("%s\n", error->message);
+			g_error_free(error);
+		} else
+			g_printerr("An unknown error occurred\n");
+		exit(1);
+	}
+
+	g_option_context_free(context);
+
+	if (option_version == TRUE) {
+		printf("%s\n", VERSION);
+		exit(0);
+	}
+
+	if (option_conf > 0) {
+		print_conf(option_conf);
+		exit(0);
+	}
+
+	/* Whoever drives us waits for the connection messages */
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	listener = listen_port(option_port);
+	if (listener == NULL)
+		exit(1);
+
+	modems = g_ptr_array_new_with_free_func(modem_free);
+	main_loop = g_main_loop_new(NULL, FALSE);
+
+	g_io_add_watch(listener, G_IO_IN, new_connection, NULL);
+
+	control = g_io_channel_unix_new(STDIN_FILENO);
+	g_io_add_watch(control, G_IO_IN | G_IO_HUP | G_IO_ERR,
+						control_event, NULL);
+
+	g_main_loop_run(main_loop);
+
+	g_io_channel_unref(control);
+	g_io_channel_unref(listener);
+	g_ptr_array_free(modems, TRUE);
+	g_main_loop_unref(main_loop);
+
+	return 0;
+}
@@ -0,0 +1,595 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Plays the modem side of a capture taken with ofonod --capture.  The
+ * modem is configured to talk to the replay endpoint instead of the
+ * hardware (e.g. phonesim.conf pointing at a tcp: endpoint, or the
+ * socket of a slot in ril_subscription.conf), and every transport channel
+ * of the capture is mapped to the connections in the order in which they
+ * appear.  The modem output is then fed back either as fast as ofonod
+ * takes it or at the recorded pace, and whatever ofonod sends is checked
+ * against the capture.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+
+#include <glib.h>
+
+#include "src/trace.h"
+
+#define REPLAY_MAX_CHANNELS	16
+#define REPLAY_SHOW_BYTES	32
+
+struct channel {
+	guint64 id;
+	unsigned int index;
+	int fd;
+	int pty_slave;
+	GByteArray *rx;
+};
+
+struct unit {
+	struct channel *channel;
+	gboolean in;
+	guint64 timestamp;
+	GByteArray *data;
+};
+
+static gboolean option_version = FALSE;
+static gboolean option_pace = FALSE;
+static gboolean option_nocheck = FALSE;
+static gchar *option_listen = NULL;
+static gint option_timeout = 10;
+
+static struct channel channels[REPLAY_MAX_CHANNELS];
+static unsigned int n_channels;
+static GPtrArray *units;
+static int listen_fd = -1;
+
+static struct channel *channel_get(guint64 id)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_channels; i++)
+		if (channels[i].id == id)
+			return channels + i;
+
+	if (n_channels == REPLAY_MAX_CHANNELS)
+		return NULL;
+
+	channels[n_channels].id = id;
+	channels[n_channels].index = n_channels;
+	channels[n_channels].fd = -1;
+	channels[n_channels].pty_slave = -1;
+	channels[n_channels].rx = g_byte_array_new();
+
+	return channels + n_channels++;
+}
+
+static void unit_free(gpointer data)
+{
+	struct unit *unit = data;
+
+	g_byte_array_free(unit->data, TRUE);
+	g_free(unit);
+}
+
+/* Glues the chunks of each transfer back together */
+static gboolean load(const char *path)
+{
+	const struct trace_file_header *hdr;
+	const struct trace_record *records;
+	struct unit *last = NULL;
+	GError *error = NULL;
+	gsize length;
+	gchar *data;
+	guint32 count;
+	guint32 i;
+
+	if (!g_file_get_contents(path, &data, &length, &error)) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	hdr = (const struct trace_file_header *) data;
+
+	if (length < sizeof(*hdr) || hdr->magic != TRACE_MAGIC ||
+				hdr->version != TRACE_VERSION ||
+				hdr->record_size != TRACE_RECORD_SIZE) {
+		g_printerr("%s: not a capture file\n", path);
+		g_free(data);
+		return FALSE;
+	}
+
+	if (hdr->count == TRACE_COUNT_STREAM)
+		count = (length - sizeof(*hdr)) / TRACE_RECORD_SIZE;
+	else
+		count = MIN(hdr->count,
+				(length - sizeof(*hdr)) / TRACE_RECORD_SIZE);
+
+	records = (const struct trace_record *) (hdr + 1);
+	units = g_ptr_array_new_with_free_func(unit_free);
+
+	for (i = 0; i < count; i++) {
+		const struct trace_record *rec = records + i;
+		gboolean in = rec->type == TRACE_RECORD_DATA_IN;
+		struct channel *channel;
+
+		if (rec->seq == 0 || rec->len > sizeof(rec->payload) ||
+				(rec->type != TRACE_RECORD_DATA_IN &&
+				rec->type != TRACE_RECORD_DATA_OUT))
+			continue;
+
+		if (rec->flags & TRACE_FLAG_TRUNCATED) {
+			g_printerr("%s: record %u is truncated\n", path,
+								rec->seq);
+			g_free(data);
+			return FALSE;
+		}
+
+		channel = channel_get(rec->id);
+		if (channel == NULL) {
+			g_printerr("%s: too many channels\n", path);
+			g_free(data);
+			return FALSE;
+		}
+
+		if (!(rec->flags & TRACE_FLAG_CONTINUED) || last == NULL ||
+				last->channel != channel || last->in != in) {
+			last = g_new0(struct unit, 1);
+			last->channel = channel;
+			last->in = in;
+			last->timestamp = rec->timestamp;
+			last->data = g_byte_array_new();
+			g_ptr_array_add(units, last);
+		}
+
+		g_byte_array_append(last->data, rec->payload, rec->len);
+	}
+
+	g_free(data);
+
+	if (units->len == 0) {
+		g_printerr("%s: no transport data\n", path);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static int open_listener(const char *addr)
+{
+	int fd;
+
+	if (g_str_has_prefix(addr, "unix:")) {
+		struct sockaddr_un sun;
+
+		memset(&sun, 0, sizeof(sun));
+		sun.sun_family = AF_UNIX;
+		g_strlcpy(sun.sun_path, addr + 5, sizeof(sun.sun_path));
+		unlink(sun.sun_path);
+
+		fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			return -errno;
+
+		if (bind(fd, (struct sockaddr *) &sun, sizeof(sun)) < 0)
+			goto error;
+	} else if (g_str_has_prefix(addr, "tcp:")) {
+		struct sockaddr_in sin;
+		int one = 1;
+
+		memset(&sin, 0, sizeof(sin));
+		sin.sin_family = AF_INET;
+		sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		sin.sin_port = htons(atoi(addr + 4));
+
+		fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			return -errno;
+
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+		if (bind(fd, (struct sockaddr *) &sin, sizeof(sin)) < 0)
+			goto error;
+	} else
+		return -EINVAL;
+
+	if (listen(fd, REPLAY_MAX_CHANNELS) < 0)
+		goto error;
+
+	return fd;
+
+error:
+	close(fd);
+	return -errno;
+}
+
+/* One pseudo terminal per channel, for drivers that open a device node */
+static gboolean open_ptys(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < n_channels; i++) {
+		struct termios ti;
+		int slave;
+		int fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+		if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+			g_printerr("Unable to open a pty: %s\n",
+							strerror(errno));
+			return FALSE;
+		}
+
+		/* Keeps the master from seeing hangups while ofonod reopens */
+		slave = open(ptsname(fd), O_RDWR | O_NOCTTY | O_CLOEXEC);
+		if (slave < 0) {
+			g_printerr("Unable to open %s: %s\n", ptsname(fd),
+							strerror(errno));
+			return FALSE;
+		}
+
+		tcgetattr(slave, &ti);
+		cfmakeraw(&ti);
+		tcsetattr(slave, TCSANOW, &ti);
+
+		channels[i].fd = fd;
+		channels[i].pty_slave = slave;
+		g_print("Channel %u: %s\n", i, ptsname(fd));
+	}
+
+	return TRUE;
+}
+
+static gint64 deadline(void)
+{
+	return g_get_monotonic_time() + (gint64) option_timeout *
+							G_USEC_PER_SEC;
+}
+
+/*
+ * Waits for whatever ofonod has to say until the deadline, or until
+ * the channel has been connected when one is given.
+ */
+static gboolean pump(struct channel *connect, gint64 until)
+{
+	struct pollfd fds[REPLAY_MAX_CHANNELS + 1];
+	struct channel *owner[REPLAY_MAX_CHANNELS + 1];
+	gint64 now = g_get_monotonic_time();
+	unsigned int n = 0;
+	unsigned int i;
+	int timeout;
+
+	for (i = 0; i < n_channels; i++) {
+		if (channels[i].fd < 0)
+			continue;
+
+		fds[n].fd = channels[i].fd;
+		fds[n].events = POLLIN;
+		owner[n++] = channels + i;
+	}
+
+	if (connect) {
+		fds[n].fd = listen_fd;
+		fds[n].events = POLLIN;
+		owner[n++] = NULL;
+	}
+
+	timeout = until > now ? (until - now + 999) / 1000 : 0;
+
+	if (poll(fds, n, timeout) < 0)
+		return errno == EINTR;
+
+	for (i = 0; i < n; i++) {
+		unsigned char buf[4096];
+		ssize_t len;
+
+		if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+			continue;
+
+		if (owner[i] == NULL) {
+			connect->fd = accept4(listen_fd, NULL, NULL,
+							SOCK_CLOEXEC);
+			continue;
+		}
+
+		len = read(fds[i].fd, buf, sizeof(buf));
+
+		if (len > 0) {
+			g_byte_array_append(owner[i]->rx, buf, len);
+		} else if (len == 0 || errno != EAGAIN) {
+			g_printerr("Channel %u closed by ofonod\n",
+							owner[i]->index);
+			close(owner[i]->fd);
+			owner[i]->fd = -1;
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean connect_channel(struct channel *channel)
+{
+	gint64 until = deadline();
+
+	while (channel->fd < 0) {
+		if (g_get_monotonic_time() >= until) {
+			g_printerr("Channel %u never connected\n",
+							channel->index);
+			return FALSE;
+		}
+
+		if (!pump(channel, until))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean send_all(struct channel *channel, const GByteArray *data)
+{
+	guint off = 0;
+
+	while (off < data->len) {
+		ssize_t n = write(channel->fd, data->data + off,
+							data->len - off);
+
+		if (n < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+
+			g_printerr("Channel %u: %s\n", channel->index,
+							strerror(errno));
+			return FALSE;
+		}
+
+		off += n;
+	}
+
+	return TRUE;
+}
+
+static void show(const char *what, const guint8 *data, guint len)
+{
+	GString *out = g_string_new(what);
+	guint i;
+
+	for (i = 0; i < len && i < REPLAY_SHOW_BYTES; i++)
+		g_string_append_printf(out, " %02x", data[i]);
+
+	if (len > REPLAY_SHOW_BYTES)
+		g_string_append(out, " ...");
+
+	g_printerr("%s\n", out->str);
+	g_string_free(out, TRUE);
+}
+
+static gboolean expect(struct channel *channel, const GByteArray *data)
+{
+	gint64 until = deadline();
+
+	while (channel->rx->len < data->len) {
+		if (g_get_monotonic_time() >= until) {
+			g_printerr("Channel %u: timed out after %u of %u "
+					"bytes\n", channel->index,
+					channel->rx->len, data->len);
+			show("expected:", data->data, data->len);
+			show("received:", channel->rx->data, channel->rx->len);
+			return FALSE;
+		}
+
+		if (!pump(NULL, until))
+			return FALSE;
+	}
+
+	if (!option_nocheck && memcmp(channel->rx->data, data->data,
+							data->len)) {
+		g_printerr("Channel %u: unexpected data\n", channel->index);
+		show("expected:", data->data, data->len);
+		show("received:", channel->rx->data, data->len);
+		return FALSE;
+	}
+
+	g_byte_array_remove_range(channel->rx, 0, data->len);
+
+	return TRUE;
+}
+
+static gboolean replay(void)
+{
+	gint64 start = g_get_monotonic_time();
+	gint64 last_real = start;
+	gint64 last_in = 0;
+	guint64 last_rec = ((struct unit *) units->pdata[0])->timestamp;
+	guint64 bytes_in = 0;
+	guint64 bytes_out = 0;
+	gint64 latency_sum = 0;
+	gint64 latency_max = 0;
+	unsigned int responses = 0;
+	gint64 elapsed;
+	unsigned int i;
+
+	for (i = 0; i < units->len; i++) {
+		struct unit *unit = units->pdata[i];
+		gint64 now;
+
+		if (!connect_channel(unit->channel))
+			return FALSE;
+
+		if (unit->in) {
+			gint64 target = last_real + (gint64)
+					(unit->timestamp - last_rec);
+
+			while (option_pace &&
+					g_get_monotonic_time() < target)
+				if (!pump(NULL, target))
+					return FALSE;
+
+			if (!send_all(unit->channel, unit->data))
+				return FALSE;
+
+			bytes_in += unit->data->len;
+			now = g_get_monotonic_time();
+			last_in = now;
+		} else {
+			if (!expect(unit->channel, unit->data))
+				return FALSE;
+
+			bytes_out += unit->data->len;
+			now = g_get_monotonic_time();
+
+			/* Only the first response to each input counts */
+			if (last_in) {
+				gint64 latency = now - last_in;
+
+				latency_sum += latency;
+				latency_max = MAX(latency_max, latency);
+				responses++;
+				last_in = 0;
+			}
+		}
+
+		last_real = now;
+		last_rec = unit->timestamp;
+	}
+
+	elapsed = g_get_monotonic_time() - start;
+
+	g_print("Replayed %u transfers on %u channels in %.3f s\n",
+			units->len, n_channels, elapsed / 1000000.0);
+	g_print("%llu bytes to ofonod, %llu bytes from ofonod\n",
+			(unsigned long long) bytes_in,
+			(unsigned long long) bytes_out);
+
+	if (responses)
+		g_print("%u responses, latency avg %.3f ms max %.3f ms\n",
+				responses, latency_sum / 1000.0 / responses,
+				latency_max / 1000.0);
+
+	for (i = 0; i < n_channels; i++)
+		if (channels[i].rx->len)
+			g_print("Channel %u: %u more bytes than captured\n",
+					i, channels[i].rx->len);
+
+	return TRUE;
+}
+
+static GOptionEntry options[] = {
+	{ "version", 'v', 0, G_OPTION_ARG_NONE, &option_version,
+				"Show version information and exit" },
+	{ "listen", 'l', 0, G_OPTION_ARG_STRING, &option_listen,
+				"Endpoint for ofonod, unix:PATH, tcp:PORT "
+				"or pty", "ADDR" },
+	{ "pace", 'p', 0, G_OPTION_ARG_NONE, &option_pace,
+				"Keep the recorded timing of the modem" },
+	{ "nocheck", 'n', 0, G_OPTION_ARG_NONE, &option_nocheck,
+				"Only count what ofonod sends" },
+	{ "timeout", 't', 0, G_OPTION_ARG_INT, &option_timeout,
+				"Seconds to wait for each response", "SEC" },
+	{ NULL },
+};
+
+int main(int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	gboolean ok;
+	unsigned int i;
+
+	context = g_option_context_new("FILE");
+	g_option_context_add_main_entries(context, options, NULL);
+
+	if (g_option_context_parse(context, &argc, &argv, &error) == FALSE) {
+		if (error != NULL) {
+			g_printerr("%s\n", error->message);
+			g_error_free(error);
+		} else
+			g_printerr("An unknown error occurred\n");
+		exit(1);
+	}
+
+	g_option_context_free(context);
+
+	if (option_version == TRUE) {
+		printf("%s\n", VERSION);
+		exit(0);
+	}
+
+	if (argc != 2) {
+		g_printerr("No capture file specified\n");
+		exit(1);
+	}
+
+	if (option_listen == NULL)
+		option_listen = g_strdup("tcp:12345");
+
+	if (!load(argv[1]))
+		exit(1);
+
+	if (g_str_equal(option_listen, "pty")) {
+		if (!open_ptys())
+			exit(1);
+	} else {
+		listen_fd = open_listener(option_listen);
+		if (listen_fd < 0) {
+			g_printerr("Unable to listen on %s: %s\n",
+					option_listen, strerror(-listen_fd));
+			exit(1);
+		}
+
+		g_print("Waiting for %u channels on %s\n", n_channels,
+								option_listen);
+	}
+
+	ok = replay();
+
+	for (i = 0; i < n_channels; i++) {
+		if (channels[i].fd >= 0)
+			close(channels[i].fd);
+
+		if (channels[i].pty_slave >= 0)
+			close(channels[i].pty_slave);
+
+		g_byte_array_free(channels[i].rx, TRUE);
+	}
+
+	if (listen_fd >= 0)
+		close(listen_fd);
+
+	g_ptr_array_free(units, TRUE);
+	g_free(option_listen);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,431 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+
+#include "src/trace.h"
+
+struct arg_reader {
+	const guint8 *ptr;
+	const guint8 *end;
+};
+
+struct arg {
+	char tag;
+	guint64 value;
+	char *str;
+};
+
+static gboolean option_version = FALSE;
+static gboolean option_hex = FALSE;
+
+static GHashTable *strings;
+
+static gboolean next_arg(struct arg_reader *r, struct arg *arg)
+{
+	g_free(arg->str);
+	arg->str = NULL;
+
+	if (r->ptr >= r->end)
+		return FALSE;
+
+	arg->tag = *r->ptr++;
+
+	if (arg->tag == TRACE_ARG_STRING) {
+		guint8 len;
+
+		if (r->ptr >= r->end)
+			return FALSE;
+
+		len = *r->ptr++;
+
+		if (r->ptr + len > r->end)
+			return FALSE;
+
+		arg->str = g_strndup((const char *) r->ptr, len);
+		r->ptr += len;
+		return TRUE;
+	}
+
+	if (r->ptr + sizeof(arg->value) > r->end)
+		return FALSE;
+
+	memcpy(&arg->value, r->ptr, sizeof(arg->value));
+	r->ptr += sizeof(arg->value);
+
+	return TRUE;
+}
+
+static const char *lookup_string(guint64 addr)
+{
+	return g_hash_table_lookup(strings, &addr);
+}
+
+/*
+ * Does what printf would have done with the original arguments, one
+ * conversion at a time.  Length modifiers are dropped since all the
+ * integers were stored as 64 bits.
+ */
+static void format_message(GString *out, const char *format,
+						struct arg_reader *r)
+{
+	struct arg arg = { 0, 0, NULL };
+	const char *p = format;
+
+	while (*p) {
+		GString *spec;
+		char conv;
+
+		if (*p != '%') {
+			g_string_append_c(out, *p++);
+			continue;
+		}
+
+		p++;
+
+		if (*p == '%') {
+			g_string_append_c(out, *p++);
+			continue;
+		}
+
+		spec = g_string_new("%");
+
+		while (*p && strchr("-+ #0'", *p))
+			g_string_append_c(spec, *p++);
+
+		if (*p == '*') {
+			if (!next_arg(r, &arg))
+				goto truncated;
+
+			g_string_append_printf(spec, "%d", (int) arg.value);
+			p++;
+		} else
+			while (g_ascii_isdigit(*p))
+				g_string_append_c(spec, *p++);
+
+		if (*p == '.') {
+			g_string_append_c(spec, *p++);
+
+			if (*p == '*') {
+				if (!next_arg(r, &arg))
+					goto truncated;
+
+				g_string_append_printf(spec, "%d",
+							(int) arg.value);
+				p++;
+			} else
+				while (g_ascii_isdigit(*p))
+					g_string_append_c(spec, *p++);
+		}
+
+		while (*p && strchr("hlqjztL", *p))
+			p++;
+
+		conv = *p;
+
+		if (conv == '\0') {
+			g_string_free(spec, TRUE);
+			break;
+		}
+
+		p++;
+
+		if (conv == 'n') {
+			g_string_free(spec, TRUE);
+			continue;
+		}
+
+		if (!next_arg(r, &arg))
+			goto truncated;
+
+		switch (conv) {
+		case 'd':
+		case 'i':
+			g_string_append(spec, "lld");
+			g_string_append_printf(out, spec->str,
+						(long long) arg.value);
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			g_string_append(spec, "ll");
+			g_string_append_c(spec, conv);
+			g_string_append_printf(out, spec->str,
+					(unsigned long long) arg.value);
+			break;
+		case 'c':
+			g_string_append_c(spec, 'c');
+			g_string_append_printf(out, spec->str, (int) arg.value);
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+		{
+			double d;
+
+			memcpy(&d, &arg.value, sizeof(d));
+			g_string_append_c(spec, conv);
+			g_string_append_printf(out, spec->str, d);
+			break;
+		}
+		case 's':
+			g_string_append_c(spec, 's');
+			g_string_append_printf(out, spec->str,
+						arg.str ? arg.str : "");
+			break;
+		case 'p':
+			g_string_append_printf(out, "0x%llx",
+					(unsigned long long) arg.value);
+			break;
+		case 'm':
+			g_string_append(out, g_strerror((int) arg.value));
+			break;
+		default:
+			g_string_append_printf(out, "%%%c", conv);
+			break;
+		}
+
+		g_string_free(spec, TRUE);
+	}
+
+	g_free(arg.str);
+	return;
+
+truncated:
+	g_string_append(out, "...");
+	g_free(arg.str);
+}
+
+static void print_dbg(GString *out, const struct trace_record *rec)
+{
+	struct arg_reader r = { rec->payload, rec->payload + rec->len };
+	struct arg arg = { 0, 0, NULL };
+	const char *format = lookup_string(rec->id);
+	const char *file = NULL;
+
+	if (next_arg(&r, &arg) && arg.tag == TRACE_ARG_FILE)
+		file = lookup_string(arg.value);
+
+	g_string_append_printf(out, "%s:", file ? file : "?");
+
+	if (format)
+		format_message(out, format, &r);
+	else
+		g_string_append_printf(out, "<unknown format 0x%llx>",
+					(unsigned long long) rec->id);
+
+	g_free(arg.str);
+}
+
+static void print_data(GString *out, const struct trace_record *rec)
+{
+	char dir = rec->type == TRACE_RECORD_DATA_IN ? '<' : '>';
+	unsigned int i;
+
+	g_string_append_printf(out, "[%llx] %c%c ",
+				(unsigned long long) rec->id, dir,
+				rec->flags & TRACE_FLAG_CONTINUED ? '+' : ' ');
+
+	for (i = 0; i < rec->len; i++) {
+		guint8 c = rec->payload[i];
+
+		if (option_hex)
+			g_string_append_printf(out, "%02x", c);
+		else if (c == '\r')
+			g_string_append(out, "\\r");
+		else if (c == '\n')
+			g_string_append(out, "\\n");
+		else if (c == '\\')
+			g_string_append(out, "\\\\");
+		else if (g_ascii_isprint(c))
+			g_string_append_c(out, c);
+		else
+			g_string_append_printf(out, "\\x%02x", c);
+	}
+}
+
+static gboolean decode(const char *path)
+{
+	const struct trace_file_header *hdr;
+	const struct trace_record *records;
+	GString *out = g_string_new(NULL);
+	GError *error = NULL;
+	const guint8 *ptr;
+	const guint8 *end;
+	unsigned int skipped = 0;
+	gsize length;
+	gchar *data;
+	guint32 count;
+	guint32 i;
+
+	if (!g_file_get_contents(path, &data, &length, &error)) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	hdr = (const struct trace_file_header *) data;
+
+	if (length < sizeof(*hdr) || hdr->magic != TRACE_MAGIC ||
+				hdr->version != TRACE_VERSION ||
+				hdr->record_size != TRACE_RECORD_SIZE) {
+		g_printerr("%s: not a trace file\n", path);
+		g_free(data);
+		return FALSE;
+	}
+
+	/* A capture has no string table, a killed one may end mid record */
+	if (hdr->count == TRACE_COUNT_STREAM)
+		count = (length - sizeof(*hdr)) / TRACE_RECORD_SIZE;
+	else
+		count = hdr->count;
+
+	if (length < sizeof(*hdr) + (gsize) count * TRACE_RECORD_SIZE) {
+		g_printerr("%s: not a trace file\n", path);
+		g_free(data);
+		return FALSE;
+	}
+
+	records = (const struct trace_record *) (hdr + 1);
+	ptr = (const guint8 *) (records + count);
+	end = (const guint8 *) data + length;
+
+	strings = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+							g_free, g_free);
+
+	while (ptr + sizeof(struct trace_string) <= end) {
+		struct trace_string entry;
+
+		memcpy(&entry, ptr, sizeof(entry));
+		ptr += sizeof(entry);
+
+		if (ptr + entry.len > end)
+			break;
+
+		g_hash_table_insert(strings, g_memdup(&entry.addr,
+							sizeof(entry.addr)),
+				g_strndup((const char *) ptr, entry.len));
+		ptr += entry.len;
+	}
+
+	if (hdr->dropped)
+		g_print("(%u older records were overwritten)\n", hdr->dropped);
+
+	for (i = 0; i < count; i++) {
+		const struct trace_record *rec = records + i;
+		gint64 age = (gint64) (hdr->monotonic - rec->timestamp);
+		gint64 realtime = (gint64) hdr->realtime - age;
+		time_t sec = realtime / G_USEC_PER_SEC;
+		char stamp[32];
+
+		if (rec->seq == 0 || rec->len > sizeof(rec->payload)) {
+			skipped++;
+			continue;
+		}
+
+		strftime(stamp, sizeof(stamp), "%H:%M:%S", localtime(&sec));
+		g_string_printf(out, "%s.%06u ", stamp,
+				(unsigned int) (realtime % G_USEC_PER_SEC));
+
+		switch (rec->type) {
+		case TRACE_RECORD_DBG:
+			print_dbg(out, rec);
+			break;
+		case TRACE_RECORD_DATA_IN:
+		case TRACE_RECORD_DATA_OUT:
+			print_data(out, rec);
+			break;
+		default:
+			skipped++;
+			continue;
+		}
+
+		if (rec->flags & TRACE_FLAG_TRUNCATED)
+			g_string_append(out, " [truncated]");
+
+		g_print("%s\n", out->str);
+	}
+
+	if (skipped)
+		g_print("(%u records were incomplete)\n", skipped);
+
+	g_hash_table_destroy(strings);
+	g_string_free(out, TRUE);
+	g_free(data);
+
+	return TRUE;
+}
+
+static GOptionEntry options[] = {
+	{ "version", 'v', 0, G_OPTION_ARG_NONE, &option_version,
+				"Show version information and exit" },
+	{ "hex", 'x', 0, G_OPTION_ARG_NONE, &option_hex,
+				"Show transport data as hex" },
+	{ NULL },
+};
+
+int main(int argc, char **argv)
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	int i;
+
+	context = g_option_context_new("FILE...");
+	g_option_context_add_main_entries(context, options, NULL);
+
+	if (g_option_context_parse(context, &argc, &argv, &error) == FALSE) {
+		if (error != NULL) {
+			g_printerr("%s\n", error->message);
+			g_error_free(error);
+		} else
+			g_printerr("An unknown error occurred\n");
+		exit(1);
+	}
+
+	g_option_context_free(context);
+
+	if (option_version == TRUE) {
+		printf("%s\n", VERSION);
+		exit(0);
+	}
+
+	if (argc < 2) {
+		g_printerr("No trace file specified\n");
+		exit(1);
+	}
+
+	for (i = 1; i < argc; i++)
+		if (!decode(argv[i]))
+			exit(1);
+
+	return 0;
+}
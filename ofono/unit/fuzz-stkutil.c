@@ -0,0 +1,51 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+/*
+ * libFuzzer target for the proactive command parser, built with
+ * --enable-fuzzing.  A seed corpus can be produced from the unit test
+ * data with:
+ *
+ *	STKUTIL_CORPUS=corpus unit/test-stkutil -m perf -p /teststk/Benchmark
+ *	unit/fuzz-stkutil corpus
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <glib.h>
+
+#include <ofono/types.h>
+#include "smsutil.h"
+#include "stkutil.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct stk_command *command;
+
+	command = stk_command_new_from_pdu(data, size);
+	if (command)
+		stk_command_free(command);
+
+	return 0;
+}
@@ -0,0 +1,285 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <glib.h>
+
+#include <ofono/netreg.h>
+#include <ofono/devmon.h>
+
+#include "ofono.h"
+#include "gatchat.h"
+
+#include "drivers/atmodem/atmodem.h"
+
+#define TEST_TIMEOUT_SEC	10
+
+/* Fake ofono_netreg */
+
+struct ofono_netreg {
+	void *data;
+};
+
+static const struct ofono_netreg_driver *test_driver;
+
+int ofono_netreg_driver_register(const struct ofono_netreg_driver *d)
+{
+	g_assert(!test_driver);
+	test_driver = d;
+	return 0;
+}
+
+void ofono_netreg_driver_unregister(const struct ofono_netreg_driver *d)
+{
+	g_assert(test_driver == d);
+	test_driver = NULL;
+}
+
+void ofono_netreg_set_data(struct ofono_netreg *netreg, void *data)
+{
+	netreg->data = data;
+}
+
+void *ofono_netreg_get_data(struct ofono_netreg *netreg)
+{
+	return netreg->data;
+}
+
+void ofono_netreg_register(struct ofono_netreg *netreg)
+{
+}
+
+void ofono_netreg_remove(struct ofono_netreg *netreg)
+{
+	g_assert_not_reached();
+}
+
+void ofono_netreg_status_notify(struct ofono_netreg *netreg, int status,
+					int lac, int ci, int tech)
+{
+}
+
+void ofono_netreg_strength_notify(struct ofono_netreg *netreg, int strength)
+{
+}
+
+void ofono_netreg_time_notify(struct ofono_netreg *netreg,
+				struct ofono_network_time *info)
+{
+}
+
+void ofono_devmon_indication_notify(void)
+{
+}
+
+/* ==== mute ==== */
+
+/*
+ * The modem side of the initialization.  Each command the driver sends
+ * has to match the next step, which is answered with its response.
+ */
+struct test_step {
+	const char *cmd;
+	const char *rsp;
+};
+
+struct test_mute {
+	const char *name;
+	const struct test_step *steps;
+	const char *mute_at; /* Mute while this command is pending */
+	unsigned int muted;
+};
+
+static const struct test_step test_mute_creg_steps[] = {
+	{ "AT+CREG=?", "+CREG: (0-2)" },
+	{ "AT+CREG=1", NULL },
+	{ }
+};
+
+static const struct test_step test_mute_cmer_steps[] = {
+	{ "AT+CREG=?", "+CREG: (0-2)" },
+	{ "AT+CREG=2", NULL },
+	{ "AT+CIND=?", "+CIND: (\"service\",(0-1)),(\"signal\",(0-5))" },
+	{ "AT+CIND=0,1", NULL },
+	{ "AT+CMER=?", "+CMER: (0-3),(0),(0),(0-2),(0)" },
+	{ "AT+CMER=3,0,0,0", NULL },
+	{ }
+};
+
+static const struct test_mute test_mute_tests[] = {
+	{
+		"creg",
+		test_mute_creg_steps,
+		"AT+CREG=?",
+		OFONO_DEVMON_IND_LOCATION
+	},{
+		"cmer",
+		test_mute_cmer_steps,
+		"AT+CMER=?",
+		OFONO_DEVMON_IND_SIGNAL_STRENGTH
+	}
+};
+
+struct test_data {
+	const struct test_mute *test;
+	const struct test_step *step;
+	GMainLoop *loop;
+	struct ofono_netreg netreg;
+	GIOChannel *modem;
+	GString *buf;
+	gboolean timed_out;
+};
+
+static gboolean test_timeout(gpointer user_data)
+{
+	struct test_data *data = user_data;
+
+	data->timed_out = TRUE;
+	g_main_loop_quit(data->loop);
+
+	return FALSE;
+}
+
+static void test_reply(struct test_data *data, const char *rsp)
+{
+	char *str = rsp ? g_strdup_printf("\r\n%s\r\n\r\nOK\r\n", rsp) :
+						g_strdup("\r\nOK\r\n");
+	gsize len = strlen(str);
+
+	g_assert(write(g_io_channel_unix_get_fd(data->modem), str, len) ==
+								(ssize_t) len);
+	g_free(str);
+}
+
+static void test_command(struct test_data *data, const char *cmd)
+{
+	const struct test_step *step = data->step++;
+
+	g_assert_cmpstr(cmd, ==, step->cmd);
+
+	if (!g_strcmp0(cmd, data->test->mute_at))
+		test_driver->mute_indications(&data->netreg,
+						data->test->muted);
+
+	if (!data->step->cmd)
+		g_main_loop_quit(data->loop);
+	else
+		test_reply(data, step->rsp);
+}
+
+static gboolean test_modem_read(GIOChannel *io, GIOCondition cond,
+						gpointer user_data)
+{
+	struct test_data *data = user_data;
+	char buf[256];
+	ssize_t len;
+	char *eol;
+
+	len = read(g_io_channel_unix_get_fd(io), buf, sizeof(buf));
+	g_assert(len > 0);
+	g_string_append_len(data->buf, buf, len);
+
+	while ((eol = strchr(data->buf->str, '\r')) != NULL) {
+		gsize n = eol - data->buf->str;
+		char *cmd = g_strndup(data->buf->str, n);
+
+		g_string_erase(data->buf, 0, n + 1);
+		test_command(data, cmd);
+		g_free(cmd);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void test_mute(gconstpointer test_data)
+{
+	const struct test_mute *test = test_data;
+	struct test_data data;
+	GAtSyntax *syntax;
+	GIOChannel *io;
+	GAtChat *chat;
+	guint timeout;
+	guint watch;
+	int fd[2];
+
+	memset(&data, 0, sizeof(data));
+	data.test = test;
+	data.step = test->steps;
+	data.loop = g_main_loop_new(NULL, FALSE);
+	data.buf = g_string_new(NULL);
+
+	g_assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, fd));
+
+	io = g_io_channel_unix_new(fd[0]);
+	syntax = g_at_syntax_new_gsm_permissive();
+	chat = g_at_chat_new(io, syntax);
+	g_at_syntax_unref(syntax);
+	g_io_channel_unref(io);
+	g_assert(chat);
+
+	data.modem = g_io_channel_unix_new(fd[1]);
+	watch = g_io_add_watch(data.modem, G_IO_IN, test_modem_read, &data);
+
+	at_netreg_init();
+	g_assert(test_driver);
+	g_assert(!test_driver->probe(&data.netreg, 0, chat));
+
+	timeout = g_timeout_add_seconds(TEST_TIMEOUT_SEC, test_timeout, &data);
+	g_main_loop_run(data.loop);
+	g_assert(!data.timed_out);
+	g_assert(!data.step->cmd);
+	g_source_remove(timeout);
+
+	test_driver->remove(&data.netreg);
+	at_netreg_exit();
+
+	g_source_remove(watch);
+	g_io_channel_unref(data.modem);
+	g_at_chat_unref(chat);
+	close(fd[0]);
+	close(fd[1]);
+
+	g_string_free(data.buf, TRUE);
+	g_main_loop_unref(data.loop);
+}
+
+#define TEST_(name) "/atmodem-netreg/" name
+
+int main(int argc, char **argv)
+{
+	guint i;
+
+	g_test_init(&argc, &argv, NULL);
+
+	__ofono_log_init("test-atmodem-netreg", g_test_verbose() ? "*" : NULL,
+								FALSE, FALSE);
+
+	for (i = 0; i < G_N_ELEMENTS(test_mute_tests); i++) {
+		const struct test_mute *test = test_mute_tests + i;
+		char *path = g_strconcat(TEST_("mute-"), test->name, NULL);
+
+		g_test_add_data_func(path, test, test_mute);
+		g_free(path);
+	}
+
+	return g_test_run();
+}
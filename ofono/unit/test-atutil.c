@@ -0,0 +1,305 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <ofono/types.h>
+
+#include "gatchat.h"
+#include "gatresult.h"
+
+#include "drivers/atmodem/atutil.h"
+#include "drivers/atmodem/vendor.h"
+
+static void result_init(GAtResult *result, const char **lines)
+{
+	result->lines = NULL;
+	result->final_or_pdu = "OK";
+
+	while (*lines)
+		result->lines = g_slist_append(result->lines,
+						(char *) *lines++);
+}
+
+/* ==== clcc ==== */
+
+struct test_clcc_call {
+	unsigned int id;
+	int direction;
+	int status;
+	const char *number;
+	int number_type;
+	int clip_validity;
+};
+
+struct test_clcc {
+	const char *name;
+	const char *lines[8];
+	const struct test_clcc_call *calls; /* Sorted by id */
+	unsigned int ncalls;
+	unsigned int mpty_ids;
+};
+
+static const struct test_clcc_call test_clcc_calls_basic[] = {
+	{ 1, 0, 0, "+358401234567", 145, 0 },
+	{ 2, 1, 5, "", 129, 2 },
+	{ 3, 1, 4, "0401234567", 129, 0 },
+};
+
+static const struct test_clcc_call test_clcc_calls_optional[] = {
+	{ 1, 1, 4, "0401234567", 129, 0 },
+	{ 2, 1, 5, "", 128, 2 },
+};
+
+static const struct test_clcc_call test_clcc_calls_malformed[] = {
+	{ 2, 0, 1, "112", 129, 0 },
+};
+
+static const struct test_clcc test_clcc_tests[] = {
+	{
+		"basic",
+		{
+			"+CLCC: 3,1,4,0,1,\"0401234567\",129",
+			"+CLCC: 1,0,0,0,0,\"+358401234567\",145",
+			"+CLCC: 2,1,5,0,1",
+			NULL
+		},
+		test_clcc_calls_basic,
+		G_N_ELEMENTS(test_clcc_calls_basic),
+		(1 << 2) | (1 << 3)
+	},{
+		/* Number and type are optional, so is anything after them */
+		"optional",
+		{
+			"+CLCC: 1,1,4,0,0,\"0401234567\"",
+			"+CLCC: 2,1,5,0,0,\"\",128,\"Alice\",0",
+			NULL
+		},
+		test_clcc_calls_optional,
+		G_N_ELEMENTS(test_clcc_calls_optional),
+		0
+	},{
+		/* Id 0, an unknown status and truncated lines are skipped */
+		"malformed",
+		{
+			"+CLCC: 0,0,0,0,0,\"0401234567\",129",
+			"+CLCC: 3,1,6,0,0",
+			"+CLCC: 4,0,x",
+			"+CLCC: 5,0,0,0",
+			"+CLCC: ",
+			"RING",
+			"+CLCC: 2,0,1,0,0,\"112\"",
+			NULL
+		},
+		test_clcc_calls_malformed,
+		G_N_ELEMENTS(test_clcc_calls_malformed),
+		0
+	},{
+		"none",
+		{
+			"+CLCC: 1,0,0,0",
+			NULL
+		},
+		NULL, 0, 0
+	}
+};
+
+static void test_clcc(gconstpointer test_data)
+{
+	const struct test_clcc *test = test_data;
+	GAtResult result;
+	unsigned int mpty_ids = 0xffff;
+	unsigned int i;
+	GSList *calls;
+	GSList *l;
+
+	result_init(&result, test->lines);
+	calls = at_util_parse_clcc(&result, &mpty_ids);
+
+	g_assert_cmpuint(g_slist_length(calls), ==, test->ncalls);
+	g_assert_cmpuint(mpty_ids, ==, test->mpty_ids);
+
+	for (l = calls, i = 0; l; l = l->next, i++) {
+		const struct ofono_call *call = l->data;
+		const struct test_clcc_call *expect = test->calls + i;
+
+		g_assert_cmpuint(call->id, ==, expect->id);
+		g_assert_cmpint(call->direction, ==, expect->direction);
+		g_assert_cmpint(call->status, ==, expect->status);
+		g_assert_cmpint(call->type, ==, 0);
+		g_assert_cmpstr(call->phone_number.number, ==, expect->number);
+		g_assert_cmpint(call->phone_number.type, ==,
+							expect->number_type);
+		g_assert_cmpint(call->clip_validity, ==, expect->clip_validity);
+	}
+
+	g_slist_free_full(calls, g_free);
+	g_slist_free(result.lines);
+}
+
+/* ==== reg ==== */
+
+struct test_reg {
+	const char *name;
+	const char *line;
+	const char *prefix;
+	unsigned int vendor;
+	gboolean unsolicited;
+	gboolean ok;
+	int mode;
+	int status;
+	int lac;
+	int ci;
+	int tech;
+};
+
+static const struct test_reg test_reg_tests[] = {
+	{
+		"full", "+CREG: 2,1,\"0A1B\",\"01C2D3E4\",7", "+CREG:",
+		0, FALSE, TRUE, 2, 1, 0x0a1b, 0x01c2d3e4, 7
+	},{
+		"no-tech", "+CGREG: 2,5,\"FFFE\",\"1\"", "+CGREG:",
+		0, FALSE, TRUE, 2, 5, 0xfffe, 0x1, -1
+	},{
+		"prefixed", "+CREG: 2,1,\"0x0A1B\",\" 01C2D3E4\",7", "+CREG:",
+		0, FALSE, TRUE, 2, 1, 0x0a1b, 0x01c2d3e4, 7
+	},{
+		"no-ci", "+CREG: 2,5,\"0A1B\"", "+CREG:",
+		0, FALSE, TRUE, 2, 5, 0x0a1b, -1, -1
+	},{
+		"status-only", "+CEREG: 2,0", "+CEREG:",
+		0, FALSE, TRUE, 2, 0, -1, -1, -1
+	},{
+		/* Location reported while searching is not trusted */
+		"searching", "+CREG: 0,2,\"0A1B\",\"01C2D3E4\",7", "+CREG:",
+		0, FALSE, TRUE, 0, 2, -1, -1, -1
+	},{
+		"no-status", "+CREG: 1", "+CREG:",
+		0, FALSE, FALSE
+	},{
+		"empty", "+CREG: ", "+CREG:",
+		0, FALSE, FALSE
+	},{
+		"bad-status", "+CREG: 2,x", "+CREG:",
+		0, FALSE, FALSE
+	},{
+		"other-prefix", "+CGREG: 2,1", "+CREG:",
+		0, FALSE, FALSE
+	},{
+		"unquoted", "+CREG: 2,1,0A1B,01C2D3E4,7", "+CREG:",
+		OFONO_VENDOR_HUAWEI, FALSE, TRUE, 2, 1, 0x0a1b, 0x01c2d3e4, 7
+	},{
+		"unquoted-no-tech", "+CGREG: 2,1,A1B,1C2D3E4", "+CGREG:",
+		OFONO_VENDOR_ZTE, FALSE, TRUE, 2, 1, 0x0a1b, 0x01c2d3e4, -1
+	},{
+		"unquoted-searching", "+CREG: 2,2,0A1B,01C2D3E4", "+CREG:",
+		OFONO_VENDOR_NOVATEL, FALSE, TRUE, 2, 2, -1, -1, -1
+	},{
+		"unquoted-bad-status", "+CREG: 2,11,0A1B,01C2D3E4", "+CREG:",
+		OFONO_VENDOR_HUAWEI, FALSE, FALSE
+	},{
+		"unsolicited-full",
+		"+CREG: 1,\"0A1B\",\"01C2D3E4\",2", "+CREG:",
+		0, TRUE, TRUE, 0, 1, 0x0a1b, 0x01c2d3e4, 2
+	},{
+		"unsolicited-no-tech", "+CGREG: 5,\"FFFE\",\"1\"", "+CGREG:",
+		0, TRUE, TRUE, 0, 5, 0xfffe, 0x1, -1
+	},{
+		"unsolicited-status-only", "+CREG: 0", "+CREG:",
+		0, TRUE, TRUE, 0, 0, -1, -1, -1
+	},{
+		"unsolicited-denied",
+		"+CREG: 3,\"0A1B\",\"01C2D3E4\"", "+CREG:",
+		0, TRUE, TRUE, 0, 3, -1, -1, -1
+	},{
+		"unsolicited-bad-status", "+CREG: x", "+CREG:",
+		0, TRUE, FALSE
+	},{
+		"unsolicited-unquoted", "+CREG: 1,0A1B,01C2D3E4,2", "+CREG:",
+		OFONO_VENDOR_ZTE, TRUE, TRUE, 0, 1, 0x0a1b, 0x01c2d3e4, 2
+	},{
+		"unsolicited-unquoted-no-tech", "+CREG: 5,0A1B,1", "+CREG:",
+		OFONO_VENDOR_GOBI, TRUE, TRUE, 0, 5, 0x0a1b, 0x1, -1
+	}
+};
+
+static void test_reg(gconstpointer test_data)
+{
+	const struct test_reg *test = test_data;
+	const char *lines[] = { test->line, NULL };
+	GAtResult result;
+	int mode = 0;
+	int status = -2;
+	int lac = -2;
+	int ci = -2;
+	int tech = -2;
+	gboolean ok;
+
+	result_init(&result, lines);
+
+	if (test->unsolicited)
+		ok = at_util_parse_reg_unsolicited(&result, test->prefix,
+						&status, &lac, &ci, &tech,
+						test->vendor);
+	else
+		ok = at_util_parse_reg(&result, test->prefix, &mode,
+						&status, &lac, &ci, &tech,
+						test->vendor);
+
+	g_assert_cmpint(ok, ==, test->ok);
+
+	if (ok) {
+		g_assert_cmpint(mode, ==, test->mode);
+		g_assert_cmpint(status, ==, test->status);
+		g_assert_cmpint(lac, ==, test->lac);
+		g_assert_cmpint(ci, ==, test->ci);
+		g_assert_cmpint(tech, ==, test->tech);
+	}
+
+	g_slist_free(result.lines);
+}
+
+#define TEST_(name) "/atutil/" name
+
+int main(int argc, char **argv)
+{
+	guint i;
+
+	g_test_init(&argc, &argv, NULL);
+
+	for (i = 0; i < G_N_ELEMENTS(test_clcc_tests); i++) {
+		const struct test_clcc *test = test_clcc_tests + i;
+		char *path = g_strconcat(TEST_("clcc-"), test->name, NULL);
+
+		g_test_add_data_func(path, test, test_clcc);
+		g_free(path);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS(test_reg_tests); i++) {
+		const struct test_reg *test = test_reg_tests + i;
+		char *path = g_strconcat(TEST_("reg-"), test->name, NULL);
+
+		g_test_add_data_func(path, test, test_reg);
+		g_free(path);
+	}
+
+	return g_test_run();
+}
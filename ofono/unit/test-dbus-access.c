@@ -34,6 +34,15 @@ static enum ofono_dbus_access deny_method_access(const char *sender,
 	return OFONO_DBUS_ACCESS_DENY;
 }
 
+static int count_method_access_calls = 0;
+static enum ofono_dbus_access count_method_access(const char *sender,
+	enum ofono_dbus_access_intf intf, int method, const char *arg)
+{
+	count_method_access_calls++;
+	return g_strcmp0(arg, "deny") ? OFONO_DBUS_ACCESS_ALLOW :
+						OFONO_DBUS_ACCESS_DENY;
+}
+
 struct ofono_dbus_access_plugin access_inval;
 struct ofono_dbus_access_plugin access_dontcare = {
 	.name = "DontCare",
@@ -50,6 +59,11 @@ struct ofono_dbus_access_plugin access_deny = {
 	.priority = OFONO_DBUS_ACCESS_PRIORITY_LOW,
 	.method_access = deny_method_access
 };
+struct ofono_dbus_access_plugin access_count = {
+	.name = "Count",
+	.priority = OFONO_DBUS_ACCESS_PRIORITY_DEFAULT,
+	.method_access = count_method_access
+};
 
 /*==========================================================================*
  * Tests
@@ -162,6 +176,96 @@ static void test_register()
 	ofono_dbus_access_plugin_unregister(&access_dontcare);
 }
 
+static void test_cache()
+{
+	unsigned int hits0, misses0, hits, misses;
+	char sender[16];
+	int i;
+
+	count_method_access_calls = 0;
+	__ofono_dbus_access_cache_stats(&hits0, &misses0);
+	g_assert(!ofono_dbus_access_plugin_register(&access_count));
+
+	/* Only the first call reaches the plugin */
+	for (i = 0; i < 3; i++) {
+		g_assert(__ofono_dbus_access_method_allowed(":1.0", 0, 1,
+								"allow"));
+		g_assert(!__ofono_dbus_access_method_allowed(":1.0", 0, 1,
+								"deny"));
+	}
+	g_assert(count_method_access_calls == 2);
+	__ofono_dbus_access_cache_stats(&hits, &misses);
+	g_assert(hits - hits0 == 4);
+	g_assert(misses - misses0 == 2);
+
+	/* Different method, sender and argument are separate entries */
+	g_assert(__ofono_dbus_access_method_allowed(":1.0", 0, 2, "allow"));
+	g_assert(__ofono_dbus_access_method_allowed(":1.1", 0, 1, "allow"));
+	g_assert(__ofono_dbus_access_method_allowed(":1.0", 0, 1, NULL));
+	g_assert(count_method_access_calls == 5);
+
+	/* Peer leaves the bus */
+	__ofono_dbus_access_peer_gone(":1.0");
+	g_assert(__ofono_dbus_access_method_allowed(":1.1", 0, 1, "allow"));
+	g_assert(count_method_access_calls == 5);
+	g_assert(__ofono_dbus_access_method_allowed(":1.0", 0, 1, "allow"));
+	g_assert(count_method_access_calls == 6);
+
+	/* Policy change */
+	ofono_dbus_access_invalidate();
+	g_assert(__ofono_dbus_access_method_allowed(":1.1", 0, 1, "allow"));
+	g_assert(count_method_access_calls == 7);
+
+	/* The cache is bounded, the oldest entries go first */
+	for (i = 0; i < 1000; i++) {
+		g_snprintf(sender, sizeof(sender), ":2.%d", i);
+		g_assert(__ofono_dbus_access_method_allowed(sender, 0, 1,
+								NULL));
+	}
+	g_assert(count_method_access_calls == 1007);
+	g_assert(__ofono_dbus_access_method_allowed(sender, 0, 1, NULL));
+	g_assert(count_method_access_calls == 1007);
+	g_assert(__ofono_dbus_access_method_allowed(":2.0", 0, 1, NULL));
+	g_assert(count_method_access_calls == 1008);
+
+	ofono_dbus_access_plugin_unregister(&access_count);
+}
+
+static void test_cache_benchmark()
+{
+	const int n = 100000;
+	gint64 start, cached, uncached;
+	int i;
+
+	g_assert(!ofono_dbus_access_plugin_register(&access_count));
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < n; i++) {
+		__ofono_dbus_access_method_allowed(":1.0",
+				OFONO_DBUS_ACCESS_INTF_CONNCTX,
+				OFONO_DBUS_ACCESS_CONNCTX_SET_PROPERTY,
+				"Active");
+	}
+	cached = g_get_monotonic_time() - start;
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < n; i++) {
+		ofono_dbus_access_invalidate();
+		__ofono_dbus_access_method_allowed(":1.0",
+				OFONO_DBUS_ACCESS_INTF_CONNCTX,
+				OFONO_DBUS_ACCESS_CONNCTX_SET_PROPERTY,
+				"Active");
+	}
+	uncached = g_get_monotonic_time() - start;
+
+	if (g_test_verbose()) {
+		g_print("%d calls: %d us cached, %d us uncached\n", n,
+					(int) cached, (int) uncached);
+	}
+
+	ofono_dbus_access_plugin_unregister(&access_count);
+}
+
 #define TEST_(test) "/dbus-access/" test
 
 int main(int argc, char *argv[])
@@ -183,6 +287,8 @@ int main(int argc, char *argv[])
 		g_free(name);
 	}
 	g_test_add_func(TEST_("register"), test_register);
+	g_test_add_func(TEST_("cache"), test_cache);
+	g_test_add_func(TEST_("cache_benchmark"), test_cache_benchmark);
 	return g_test_run();
 }
 
@@ -0,0 +1,337 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd. All rights reserved.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include "test-dbus.h"
+
+#include <ofono/dbus.h>
+
+#include "ofono.h"
+
+#include <gutil_log.h>
+#include <gutil_macros.h>
+
+#define TEST_TIMEOUT                    (10)   /* seconds */
+#define TEST_DBUS_INTERFACE            "test.interface"
+#define TEST_DBUS_PATH                 "/test"
+
+static gboolean test_debug;
+
+struct test_properties_data {
+	struct test_dbus_context dbus;
+	dbus_int32_t value;
+	int appended;
+};
+
+/* ==== common ==== */
+
+static gboolean test_timeout(gpointer param)
+{
+	g_assert(!"TIMEOUT");
+	return G_SOURCE_REMOVE;
+}
+
+static guint test_setup_timeout(void)
+{
+	if (test_debug) {
+		return 0;
+	} else {
+		return g_timeout_add_seconds(TEST_TIMEOUT, test_timeout, NULL);
+	}
+}
+
+static void test_append_properties(DBusMessageIter *dict, void *data)
+{
+	struct test_properties_data *test = data;
+
+	test->appended++;
+	ofono_dbus_dict_append(dict, "Value", DBUS_TYPE_INT32, &test->value);
+}
+
+static DBusMessage *test_get_properties(DBusConnection *conn,
+						DBusMessage *msg, void *data)
+{
+	return __ofono_dbus_properties_reply(msg, TEST_DBUS_PATH,
+						TEST_DBUS_INTERFACE);
+}
+
+static const GDBusMethodTable test_methods[] = {
+	{ GDBUS_METHOD("GetProperties",
+			NULL, GDBUS_ARGS({ "properties", "a{sv}" }),
+			test_get_properties) },
+	{ }
+};
+
+static void test_register(struct test_properties_data *test)
+{
+	g_assert(g_dbus_register_interface(ofono_dbus_get_connection(),
+				TEST_DBUS_PATH, TEST_DBUS_INTERFACE,
+				test_methods, NULL, NULL, test, NULL));
+	__ofono_dbus_properties_register(TEST_DBUS_PATH, TEST_DBUS_INTERFACE,
+					test_append_properties, test);
+}
+
+static void test_unregister(void)
+{
+	__ofono_dbus_properties_unregister(TEST_DBUS_PATH,
+						TEST_DBUS_INTERFACE);
+	g_assert(g_dbus_unregister_interface(ofono_dbus_get_connection(),
+				TEST_DBUS_PATH, TEST_DBUS_INTERFACE));
+}
+
+/* Checks that a{sv} holds nothing but the expected Value */
+static void test_check_properties(DBusMessageIter *it, dbus_int32_t value)
+{
+	DBusMessageIter dict, entry, var;
+
+	g_assert(dbus_message_iter_get_arg_type(it) == DBUS_TYPE_ARRAY);
+	dbus_message_iter_recurse(it, &dict);
+	dbus_message_iter_next(it);
+
+	g_assert(dbus_message_iter_get_arg_type(&dict) ==
+							DBUS_TYPE_DICT_ENTRY);
+	dbus_message_iter_recurse(&dict, &entry);
+	dbus_message_iter_next(&dict);
+	g_assert(dbus_message_iter_get_arg_type(&dict) == DBUS_TYPE_INVALID);
+
+	g_assert(!g_strcmp0(test_dbus_get_string(&entry), "Value"));
+	g_assert(dbus_message_iter_get_arg_type(&entry) == DBUS_TYPE_VARIANT);
+	dbus_message_iter_recurse(&entry, &var);
+	g_assert(test_dbus_get_int32(&var) == value);
+}
+
+static void test_call(struct test_dbus_context *dbus, const char *path,
+				const char *interface, const char *method,
+				DBusPendingCallNotifyFunction fn)
+{
+	DBusPendingCall *call;
+	DBusMessage *msg = dbus_message_new_method_call(NULL, path,
+							interface, method);
+
+	g_assert(dbus_connection_send_with_reply(dbus->client_connection,
+					msg, &call, DBUS_TIMEOUT_INFINITE));
+	dbus_pending_call_set_notify(call, fn, dbus, NULL);
+	dbus_message_unref(msg);
+}
+
+static void test_run(struct test_properties_data *test,
+			void (*start)(struct test_dbus_context *dbus))
+{
+	guint timeout = test_setup_timeout();
+
+	memset(test, 0, sizeof(*test));
+	test_dbus_setup(&test->dbus);
+	test->dbus.start = start;
+
+	g_main_loop_run(test->dbus.loop);
+
+	test_dbus_shutdown(&test->dbus);
+	if (timeout) {
+		g_source_remove(timeout);
+	}
+}
+
+/* ==== snapshot ==== */
+
+static void test_snapshot_get(struct test_dbus_context *dbus,
+					DBusPendingCallNotifyFunction fn)
+{
+	test_call(dbus, TEST_DBUS_PATH, TEST_DBUS_INTERFACE, "GetProperties",
+									fn);
+}
+
+static void test_snapshot_check(DBusPendingCall *call,
+				struct test_properties_data *test)
+{
+	DBusMessage *reply = dbus_pending_call_steal_reply(call);
+	DBusMessageIter it;
+
+	g_assert(dbus_message_get_type(reply) ==
+					DBUS_MESSAGE_TYPE_METHOD_RETURN);
+	dbus_message_iter_init(reply, &it);
+	test_check_properties(&it, test->value);
+	g_assert(dbus_message_iter_get_arg_type(&it) == DBUS_TYPE_INVALID);
+	dbus_message_unref(reply);
+}
+
+static void test_snapshot_3(DBusPendingCall *call, void *dbus)
+{
+	struct test_properties_data *test =
+		G_CAST(dbus, struct test_properties_data, dbus);
+	unsigned int hits, misses;
+
+	DBG("");
+	test_snapshot_check(call, test);
+	g_assert(test->appended == 2);
+
+	__ofono_dbus_properties_stats(&hits, &misses);
+	g_assert(hits == 1);
+	g_assert(misses == 2);
+
+	test_unregister();
+	g_main_loop_quit(test->dbus.loop);
+}
+
+static void test_snapshot_2(DBusPendingCall *call, void *dbus)
+{
+	struct test_properties_data *test =
+		G_CAST(dbus, struct test_properties_data, dbus);
+
+	DBG("");
+	test_snapshot_check(call, test);
+
+	/* Served from the snapshot */
+	g_assert(test->appended == 1);
+
+	/* The signal makes it stale */
+	test->value = 2;
+	ofono_dbus_signal_property_changed(ofono_dbus_get_connection(),
+				TEST_DBUS_PATH, TEST_DBUS_INTERFACE,
+				"Value", DBUS_TYPE_INT32, &test->value);
+	test_snapshot_get(dbus, test_snapshot_3);
+}
+
+static void test_snapshot_1(DBusPendingCall *call, void *dbus)
+{
+	struct test_properties_data *test =
+		G_CAST(dbus, struct test_properties_data, dbus);
+
+	DBG("");
+	test_snapshot_check(call, test);
+	g_assert(test->appended == 1);
+	test_snapshot_get(dbus, test_snapshot_2);
+}
+
+static void test_snapshot_start(struct test_dbus_context *dbus)
+{
+	struct test_properties_data *test =
+		G_CAST(dbus, struct test_properties_data, dbus);
+
+	test->value = 1;
+	test_register(test);
+	test_snapshot_get(dbus, test_snapshot_1);
+}
+
+static void test_snapshot(void)
+{
+	struct test_properties_data test;
+
+	test_run(&test, test_snapshot_start);
+}
+
+/* ==== objects ==== */
+
+static void test_objects_reply(DBusPendingCall *call, void *dbus)
+{
+	struct test_properties_data *test =
+		G_CAST(dbus, struct test_properties_data, dbus);
+	DBusMessage *reply = dbus_pending_call_steal_reply(call);
+	DBusMessageIter it, objects, object, ifaces, iface;
+	gboolean found = FALSE;
+
+	DBG("");
+	g_assert(dbus_message_get_type(reply) ==
+					DBUS_MESSAGE_TYPE_METHOD_RETURN);
+	dbus_message_iter_init(reply, &it);
+	g_assert(dbus_message_iter_get_arg_type(&it) == DBUS_TYPE_ARRAY);
+	dbus_message_iter_recurse(&it, &objects);
+
+	while (dbus_message_iter_get_arg_type(&objects) ==
+						DBUS_TYPE_DICT_ENTRY) {
+		dbus_message_iter_recurse(&objects, &object);
+		dbus_message_iter_next(&objects);
+
+		if (g_strcmp0(test_dbus_get_object_path(&object),
+							TEST_DBUS_PATH))
+			continue;
+
+		dbus_message_iter_recurse(&object, &ifaces);
+
+		while (dbus_message_iter_get_arg_type(&ifaces) ==
+						DBUS_TYPE_DICT_ENTRY) {
+			dbus_message_iter_recurse(&ifaces, &iface);
+			dbus_message_iter_next(&ifaces);
+
+			if (g_strcmp0(test_dbus_get_string(&iface),
+							TEST_DBUS_INTERFACE))
+				continue;
+
+			test_check_properties(&iface, test->value);
+			found = TRUE;
+		}
+	}
+
+	g_assert(found);
+	dbus_message_unref(reply);
+
+	test_unregister();
+	g_assert(g_dbus_detach_object_manager(ofono_dbus_get_connection()));
+	g_main_loop_quit(test->dbus.loop);
+}
+
+static void test_objects_start(struct test_dbus_context *dbus)
+{
+	struct test_properties_data *test =
+		G_CAST(dbus, struct test_properties_data, dbus);
+
+	test->value = 42;
+	g_assert(g_dbus_attach_object_manager(ofono_dbus_get_connection()));
+	test_register(test);
+	test_call(dbus, "/", "org.freedesktop.DBus.ObjectManager",
+				"GetManagedObjects", test_objects_reply);
+}
+
+static void test_objects(void)
+{
+	struct test_properties_data test;
+
+	test_run(&test, test_objects_start);
+}
+
+#define TEST_(name) "/dbus-properties/" name
+
+int main(int argc, char *argv[])
+{
+	int i;
+
+	g_test_init(&argc, &argv, NULL);
+	for (i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (!strcmp(arg, "-d") || !strcmp(arg, "--debug")) {
+			test_debug = TRUE;
+		} else {
+			GWARN("Unsupported command line option %s", arg);
+		}
+	}
+
+	gutil_log_timestamp = FALSE;
+	gutil_log_default.level = g_test_verbose() ?
+		GLOG_LEVEL_VERBOSE : GLOG_LEVEL_NONE;
+	__ofono_log_init("test-dbus-properties",
+				g_test_verbose() ? "*" : NULL,
+				FALSE, FALSE);
+
+	g_test_add_func(TEST_("snapshot"), test_snapshot);
+	g_test_add_func(TEST_("objects"), test_objects);
+
+	return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 8
+ * indent-tabs-mode: t
+ * End:
+ */
@@ -0,0 +1,329 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <glib.h>
+
+#include <ofono/handsfree-audio.h>
+
+#include "ofono.h"
+#include "gatchat.h"
+
+#define TEST_TIMEOUT_SEC	10
+
+/* Fake ofono_modem and ofono_atom */
+
+struct ofono_modem {
+	int unused;
+};
+
+struct ofono_atom {
+	struct ofono_modem *modem;
+	void *data;
+	void (*destruct)(struct ofono_atom *atom);
+	void (*unregister)(struct ofono_atom *atom);
+};
+
+struct ofono_atom *__ofono_modem_add_atom_offline(struct ofono_modem *modem,
+					enum ofono_atom_type type,
+					void (*destruct)(struct ofono_atom *),
+					void *data)
+{
+	struct ofono_atom *atom = g_new0(struct ofono_atom, 1);
+
+	atom->modem = modem;
+	atom->data = data;
+	atom->destruct = destruct;
+	return atom;
+}
+
+struct ofono_atom *__ofono_modem_find_atom(struct ofono_modem *modem,
+						enum ofono_atom_type type)
+{
+	return NULL;
+}
+
+void *__ofono_atom_get_data(struct ofono_atom *atom)
+{
+	return atom->data;
+}
+
+struct ofono_modem *__ofono_atom_get_modem(struct ofono_atom *atom)
+{
+	return atom->modem;
+}
+
+void __ofono_atom_register(struct ofono_atom *atom,
+				void (*unregister)(struct ofono_atom *))
+{
+	atom->unregister = unregister;
+}
+
+void __ofono_atom_free(struct ofono_atom *atom)
+{
+	if (atom->unregister)
+		atom->unregister(atom);
+
+	if (atom->destruct)
+		atom->destruct(atom);
+
+	g_free(atom);
+}
+
+/* Nothing below is reached by the HFP indicators */
+
+struct ofono_call *__ofono_voicecall_find_call_with_status(
+				struct ofono_voicecall *vc, int status)
+{
+	return NULL;
+}
+
+void __ofono_private_network_release(int id)
+{
+}
+
+ofono_bool_t __ofono_private_network_request(ofono_private_network_cb_t cb,
+						int *id, void *data)
+{
+	return FALSE;
+}
+
+int ofono_handsfree_card_register(struct ofono_handsfree_card *card)
+{
+	return 0;
+}
+
+void ofono_handsfree_card_remove(struct ofono_handsfree_card *card)
+{
+}
+
+ofono_bool_t ofono_handsfree_card_set_codec(struct ofono_handsfree_card *card,
+							unsigned char codec)
+{
+	return FALSE;
+}
+
+ofono_bool_t ofono_handsfree_audio_has_wideband(void)
+{
+	return FALSE;
+}
+
+int ofono_handsfree_card_connect_sco(struct ofono_handsfree_card *card)
+{
+	return -ENOSYS;
+}
+
+/* ==== ciev ==== */
+
+/*
+ * Indicators are numbered from 1 in the order of AT+CIND=?, which is
+ * service, call, callsetup, callheld, signal, roam and battchg.
+ */
+struct test_ind {
+	const char *name;
+	int value;
+};
+
+/*
+ * Each indicator that changed within a burst is reported once with its
+ * last value, in the order the indicators first changed.
+ */
+struct test_burst {
+	const struct test_ind *inds; /* set within one main loop iteration */
+	const char *expect; /* +CIEV index,value pairs received after it */
+};
+
+static const struct test_ind test_burst_1[] = {
+	{ OFONO_EMULATOR_IND_SIGNAL, 1 },
+	{ OFONO_EMULATOR_IND_SIGNAL, 2 },
+	{ OFONO_EMULATOR_IND_SERVICE, 1 },
+	{ OFONO_EMULATOR_IND_SIGNAL, 3 },
+	{ OFONO_EMULATOR_IND_BATTERY, 4 },
+	{ OFONO_EMULATOR_IND_SIGNAL, 4 },
+	{ OFONO_EMULATOR_IND_BATTERY, 3 },
+	{ OFONO_EMULATOR_IND_SIGNAL, 5 },
+	{ }
+};
+
+static const struct test_ind test_burst_2[] = {
+	{ OFONO_EMULATOR_IND_SIGNAL, 2 },
+	{ }
+};
+
+static const struct test_ind test_burst_3[] = {
+	{ OFONO_EMULATOR_IND_ROAMING, 1 },
+	{ OFONO_EMULATOR_IND_SERVICE, 0 },
+	{ OFONO_EMULATOR_IND_SIGNAL, 0 },
+	{ OFONO_EMULATOR_IND_SERVICE, 1 },
+	{ OFONO_EMULATOR_IND_SIGNAL, 4 },
+	{ }
+};
+
+static const struct test_ind test_burst_4[] = {
+	{ OFONO_EMULATOR_IND_CALLHELD, 1 },
+	{ OFONO_EMULATOR_IND_CALLSETUP, 2 },
+	{ OFONO_EMULATOR_IND_CALLSETUP, 3 },
+	{ }
+};
+
+static const struct test_burst test_bursts[] = {
+	{ test_burst_1, "5,5 1,1 7,3 " },
+	{ test_burst_2, "5,5 1,1 7,3 5,2 " },
+	{ test_burst_3, "5,5 1,1 7,3 5,2 6,1 1,1 5,4 " },
+	{ test_burst_4, "5,5 1,1 7,3 5,2 6,1 1,1 5,4 4,1 3,3 " },
+};
+
+struct test_data {
+	GMainLoop *loop;
+	struct ofono_modem modem;
+	struct ofono_emulator *em;
+	GAtChat *chat;
+	int fd[2];
+	GString *received;
+	guint burst;
+	gboolean slc;
+	gboolean timed_out;
+};
+
+static gboolean test_timeout(gpointer user_data)
+{
+	struct test_data *test = user_data;
+
+	test->timed_out = TRUE;
+	g_main_loop_quit(test->loop);
+
+	return FALSE;
+}
+
+static void test_send_burst(struct test_data *test)
+{
+	const struct test_ind *ind;
+
+	for (ind = test_bursts[test->burst].inds; ind->name; ind++)
+		ofono_emulator_set_indicator(test->em, ind->name, ind->value);
+}
+
+static void test_ciev_notify(GAtResult *result, gpointer user_data)
+{
+	struct test_data *test = user_data;
+	const struct test_burst *burst = test_bursts + test->burst;
+	GAtResultIter iter;
+	int index;
+	int value;
+
+	g_assert(test->slc);
+
+	g_at_result_iter_init(&iter, result);
+	g_assert(g_at_result_iter_next(&iter, "+CIEV:"));
+	g_assert(g_at_result_iter_next_number(&iter, &index));
+	g_assert(g_at_result_iter_next_number(&iter, &value));
+	g_string_append_printf(test->received, "%d,%d ", index, value);
+
+	/*
+	 * A value reported for each intermediate update would come first
+	 * and make the received lines differ from the expected ones.
+	 */
+	if (test->received->len < strlen(burst->expect))
+		return;
+
+	g_assert_cmpstr(test->received->str, ==, burst->expect);
+
+	if (++test->burst == G_N_ELEMENTS(test_bursts))
+		g_main_loop_quit(test->loop);
+	else
+		test_send_burst(test);
+}
+
+static void test_cmer_cb(gboolean ok, GAtResult *result, gpointer user_data)
+{
+	struct test_data *test = user_data;
+
+	g_assert(ok);
+
+	/* The HF doesn't support three way calling, so that's the SLC */
+	test->slc = TRUE;
+	test_send_burst(test);
+}
+
+static void test_brsf_cb(gboolean ok, GAtResult *result, gpointer user_data)
+{
+	g_assert(ok);
+}
+
+static void test_ciev(void)
+{
+	struct test_data test;
+	GAtSyntax *syntax;
+	GIOChannel *io;
+	guint timeout;
+
+	memset(&test, 0, sizeof(test));
+	g_assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, test.fd));
+
+	test.loop = g_main_loop_new(NULL, FALSE);
+	test.received = g_string_new(NULL);
+
+	test.em = ofono_emulator_create(OFONO_EMULATOR_TYPE_HFP);
+	g_assert(test.em);
+	ofono_emulator_add_modem(test.em, &test.modem);
+	ofono_emulator_register(test.em, test.fd[0]);
+
+	io = g_io_channel_unix_new(test.fd[1]);
+	syntax = g_at_syntax_new_gsm_permissive();
+	test.chat = g_at_chat_new(io, syntax);
+	g_at_syntax_unref(syntax);
+	g_io_channel_unref(io);
+	g_assert(test.chat);
+
+	g_at_chat_register(test.chat, "+CIEV:", test_ciev_notify, FALSE,
+								&test, NULL);
+	g_at_chat_send(test.chat, "AT+BRSF=0", NULL, test_brsf_cb,
+								&test, NULL);
+	g_at_chat_send(test.chat, "AT+CMER=3,0,0,1", NULL, test_cmer_cb,
+								&test, NULL);
+
+	timeout = g_timeout_add_seconds(TEST_TIMEOUT_SEC, test_timeout, &test);
+	g_main_loop_run(test.loop);
+	g_assert(!test.timed_out);
+	g_source_remove(timeout);
+
+	ofono_emulator_remove(test.em);
+	g_at_chat_unref(test.chat);
+	close(test.fd[0]);
+	close(test.fd[1]);
+
+	g_string_free(test.received, TRUE);
+	g_main_loop_unref(test.loop);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	__ofono_log_init("test-emulator", g_test_verbose() ? "*" : NULL,
+							FALSE, FALSE);
+
+	g_test_add_func("/emulator/ciev", test_ciev);
+
+	return g_test_run();
+}
@@ -0,0 +1,318 @@
+/*
+ *
+ *  AT chat library with GLib integration
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <glib.h>
+
+#include "gatchat.h"
+
+#define TEST_TIMEOUT_SEC	10
+#define URC_COUNT		200
+
+struct test_modem {
+	GAtChat *chat;
+	int peer;
+	int received;
+	int sent;
+	gint64 latency_sum;
+	gint64 latency_max;
+};
+
+struct test_data {
+	GMainLoop *loop;
+	struct test_modem *modems;
+	int count;
+	int done;
+	guint timeout_id;
+	gboolean timed_out;
+};
+
+static gboolean test_timeout(gpointer user_data)
+{
+	struct test_data *test = user_data;
+
+	test->timed_out = TRUE;
+	test->timeout_id = 0;
+	g_main_loop_quit(test->loop);
+
+	return FALSE;
+}
+
+static void urc_notify(GAtResult *result, gpointer user_data)
+{
+	struct test_data *test = user_data;
+	GAtResultIter iter;
+	struct test_modem *m;
+	gint64 now = g_get_monotonic_time();
+	gint64 latency;
+	int index, seq;
+	const char *stamp;
+
+	g_at_result_iter_init(&iter, result);
+	g_assert(g_at_result_iter_next(&iter, "+TURC:"));
+	g_assert(g_at_result_iter_next_number(&iter, &index));
+	g_assert(g_at_result_iter_next_number(&iter, &seq));
+	g_assert(g_at_result_iter_next_unquoted_string(&iter, &stamp));
+
+	g_assert(index >= 0 && index < test->count);
+	m = test->modems + index;
+
+	/* URCs must arrive in order and exactly once */
+	g_assert(seq == m->received);
+	m->received++;
+
+	latency = now - g_ascii_strtoll(stamp, NULL, 10);
+	m->latency_sum += latency;
+	m->latency_max = MAX(m->latency_max, latency);
+
+	if (m->received == URC_COUNT && ++test->done == test->count)
+		g_main_loop_quit(test->loop);
+}
+
+static gboolean send_urcs(gpointer user_data)
+{
+	struct test_data *test = user_data;
+	gboolean more = FALSE;
+	int i;
+
+	/* Interleave the modems, a few URCs each per main loop iteration */
+	for (i = 0; i < test->count; i++) {
+		struct test_modem *m = test->modems + i;
+		int n;
+
+		for (n = 0; n < 4 && m->sent < URC_COUNT; n++) {
+			char *urc = g_strdup_printf("\r\n+TURC: %d,%d,%"
+						G_GINT64_FORMAT "\r\n",
+						i, m->sent,
+						g_get_monotonic_time());
+			gsize len = strlen(urc);
+
+			g_assert(write(m->peer, urc, len) == (ssize_t) len);
+			g_free(urc);
+			m->sent++;
+		}
+
+		if (m->sent < URC_COUNT)
+			more = TRUE;
+	}
+
+	return more;
+}
+
+static void test_modems_init(struct test_data *test, int count,
+							gboolean threaded)
+{
+	int i;
+
+	memset(test, 0, sizeof(*test));
+	test->loop = g_main_loop_new(NULL, FALSE);
+	test->count = count;
+	test->modems = g_new0(struct test_modem, count);
+	test->timeout_id = g_timeout_add_seconds(TEST_TIMEOUT_SEC,
+							test_timeout, test);
+
+	for (i = 0; i < count; i++) {
+		struct test_modem *m = test->modems + i;
+		GAtSyntax *syntax;
+		GIOChannel *io;
+		int fd[2];
+
+		g_assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, fd));
+
+		io = g_io_channel_unix_new(fd[0]);
+		g_io_channel_set_close_on_unref(io, TRUE);
+		syntax = g_at_syntax_new_gsmv1();
+
+		if (threaded)
+			m->chat = g_at_chat_new_threaded(io, syntax);
+		else
+			m->chat = g_at_chat_new(io, syntax);
+
+		g_assert(m->chat);
+		g_at_syntax_unref(syntax);
+		g_io_channel_unref(io);
+
+		m->peer = fd[1];
+		g_at_chat_register(m->chat, "+TURC:", urc_notify, FALSE,
+								test, NULL);
+	}
+}
+
+static void test_modems_cleanup(struct test_data *test)
+{
+	int i;
+
+	for (i = 0; i < test->count; i++) {
+		g_at_chat_unref(test->modems[i].chat);
+		close(test->modems[i].peer);
+	}
+
+	if (test->timeout_id)
+		g_source_remove(test->timeout_id);
+
+	g_main_loop_unref(test->loop);
+	g_free(test->modems);
+}
+
+static void run_urc_test(int count, gboolean threaded)
+{
+	struct test_data test;
+	gint64 sum = 0, max = 0;
+	int i;
+
+	test_modems_init(&test, count, threaded);
+	g_idle_add(send_urcs, &test);
+	g_main_loop_run(test.loop);
+
+	g_assert(!test.timed_out);
+
+	for (i = 0; i < count; i++) {
+		g_assert(test.modems[i].received == URC_COUNT);
+		sum += test.modems[i].latency_sum;
+		max = MAX(max, test.modems[i].latency_max);
+	}
+
+	if (g_test_verbose())
+		g_print("%s %d modem(s): average URC latency %" G_GINT64_FORMAT
+			" us, max %" G_GINT64_FORMAT " us\n",
+			threaded ? "threaded" : "main loop", count,
+			sum / (count * URC_COUNT), max);
+
+	test_modems_cleanup(&test);
+}
+
+static void test_urc(gconstpointer data)
+{
+	run_urc_test(GPOINTER_TO_INT(data), FALSE);
+}
+
+static void test_urc_threaded(gconstpointer data)
+{
+	run_urc_test(GPOINTER_TO_INT(data), TRUE);
+}
+
+static guint peer_watch;
+
+static gboolean peer_respond(GIOChannel *channel, GIOCondition cond,
+							gpointer user_data)
+{
+	static const char response[] = "\r\nTEST\r\n\r\nOK\r\n";
+	int fd = g_io_channel_unix_get_fd(channel);
+	char buf[64];
+	ssize_t len = read(fd, buf, sizeof(buf));
+
+	if (len <= 0) {
+		peer_watch = 0;
+		return FALSE;
+	}
+
+	g_assert(!strncmp(buf, "AT+CGMI\r", len));
+	g_assert(write(fd, response, sizeof(response) - 1) ==
+						sizeof(response) - 1);
+
+	return TRUE;
+}
+
+static void cgmi_cb(gboolean ok, GAtResult *result, gpointer user_data)
+{
+	struct test_data *test = user_data;
+	GAtResultIter iter;
+
+	g_assert(ok);
+
+	g_at_result_iter_init(&iter, result);
+	g_assert(g_at_result_iter_next(&iter, ""));
+	g_assert_cmpstr(g_at_result_iter_raw_line(&iter), ==, "TEST");
+
+	/* Now make the peer go away */
+	shutdown(test->modems[0].peer, SHUT_RDWR);
+}
+
+static void chat_disconnect(gpointer user_data)
+{
+	struct test_data *test = user_data;
+
+	test->done++;
+	g_main_loop_quit(test->loop);
+}
+
+static void test_command_threaded(void)
+{
+	struct test_data test;
+	GIOChannel *peer;
+
+	test_modems_init(&test, 1, TRUE);
+
+	peer = g_io_channel_unix_new(test.modems[0].peer);
+	peer_watch = g_io_add_watch(peer, G_IO_IN, peer_respond, NULL);
+
+	g_at_chat_set_disconnect_function(test.modems[0].chat,
+						chat_disconnect, &test);
+	g_assert(g_at_chat_send(test.modems[0].chat, "AT+CGMI", NULL,
+						cgmi_cb, &test, NULL));
+	g_main_loop_run(test.loop);
+
+	g_assert(!test.timed_out);
+	g_assert(test.done == 1);
+
+	if (peer_watch)
+		g_source_remove(peer_watch);
+
+	g_io_channel_unref(peer);
+	test_modems_cleanup(&test);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_data_func("/testgatio/URC", GINT_TO_POINTER(1), test_urc);
+	g_test_add_data_func("/testgatio/URC threaded", GINT_TO_POINTER(1),
+						test_urc_threaded);
+	g_test_add_func("/testgatio/Command threaded", test_command_threaded);
+
+	if (g_test_perf()) {
+		static const int modems[] = { 4, 16, 64 };
+		unsigned int i;
+
+		for (i = 0; i < G_N_ELEMENTS(modems); i++) {
+			char *name;
+
+			name = g_strdup_printf("/testgatio/URC %d", modems[i]);
+			g_test_add_data_func(name, GINT_TO_POINTER(modems[i]),
+						test_urc);
+			g_free(name);
+
+			name = g_strdup_printf("/testgatio/URC threaded %d",
+								modems[i]);
+			g_test_add_data_func(name, GINT_TO_POINTER(modems[i]),
+						test_urc_threaded);
+			g_free(name);
+		}
+	}
+
+	return g_test_run();
+}
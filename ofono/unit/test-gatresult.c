@@ -0,0 +1,427 @@
+/*
+ *
+ *  AT chat library with GLib integration
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "gatresult.h"
+
+#define BENCHMARK_SECONDS	0.25
+
+struct test_fields {
+	int n[6];
+	char s[3][48];
+};
+
+#define OPT	G_AT_FIELD_OPTIONAL
+#define N(i, f)	G_AT_FIELD(NUMBER, f, struct test_fields, n[i])
+#define X(i, f)	G_AT_FIELD(HEX, f, struct test_fields, n[i])
+#define S(i, f)	G_AT_FIELD(STRING, f, struct test_fields, s[i])
+#define U(i, f)	G_AT_FIELD(UNQUOTED_STRING, f, struct test_fields, s[i])
+#define SKIP(f)	{ G_AT_FIELD_SKIP, f, 0, 0 }
+
+static const GAtField csq_fields[] = { N(0, 0), N(1, 0) };
+static const GAtField creg_fields[] = {
+	N(0, 0), N(1, 0), X(2, OPT), X(3, OPT), N(4, OPT)
+};
+static const GAtField creg_urc_fields[] = {
+	N(0, 0), X(1, OPT), X(2, OPT), N(3, OPT)
+};
+static const GAtField clcc_fields[] = {
+	N(0, 0), N(1, 0), N(2, 0), N(3, 0), N(4, 0), S(0, OPT), N(5, OPT)
+};
+static const GAtField cmgl_fields[] = { N(0, 0), N(1, 0), S(0, OPT), N(2, 0) };
+static const GAtField cops_fields[] = { N(0, 0), N(1, OPT), S(0, OPT),
+					N(2, OPT) };
+static const GAtField cpin_fields[] = { U(0, 0) };
+static const GAtField cmti_fields[] = { S(0, 0), N(0, 0) };
+static const GAtField cusd_fields[] = { N(0, 0), S(0, OPT), N(1, OPT) };
+static const GAtField csca_fields[] = { S(0, 0), N(0, OPT) };
+static const GAtField cnum_fields[] = { S(0, 0), S(1, 0), N(0, 0) };
+static const GAtField cpbr_fields[] = { N(0, 0), S(0, 0), N(1, 0), S(1, 0) };
+static const GAtField cgact_fields[] = { N(0, 0), N(1, 0) };
+static const GAtField cgdcont_fields[] = {
+	N(0, 0), S(0, 0), S(1, 0), S(2, OPT), N(1, OPT), N(2, OPT)
+};
+static const GAtField crsm_fields[] = { N(0, 0), N(1, 0), S(0, OPT) };
+static const GAtField cind_fields[] = {
+	N(0, 0), N(1, 0), N(2, 0), N(3, 0), N(4, 0), N(5, 0)
+};
+static const GAtField ccwa_fields[] = { S(0, 0), N(0, 0), N(1, 0) };
+static const GAtField clip_fields[] = {
+	S(0, 0), N(0, 0), SKIP(OPT), SKIP(OPT), S(1, OPT), N(1, OPT)
+};
+
+struct response_test {
+	const char *name;
+	const char *prefix;
+	const char *line;
+	GAtGrammar grammar;
+	gint parsed;
+};
+
+#define RESPONSE(name, prefix, line, fields, parsed) \
+	{ name, prefix, line, G_AT_GRAMMAR(fields), parsed }
+
+/* The response types the atmodem drivers see the most of */
+static const struct response_test responses[] = {
+	RESPONSE("CSQ", "+CSQ:", "+CSQ: 21,99", csq_fields, 2),
+	RESPONSE("CREG", "+CREG:", "+CREG: 2,1,\"0A1B\",\"01C2D3E4\",7",
+			creg_fields, 5),
+	RESPONSE("CREG URC", "+CREG:", "+CREG: 5,\"0A1B\",\"01C2D3E4\",2",
+			creg_urc_fields, 4),
+	RESPONSE("CGREG", "+CGREG:", "+CGREG: 2,5,\"0A1B\",\"01C2D3E4\",2",
+			creg_fields, 5),
+	RESPONSE("CEREG", "+CEREG:", "+CEREG: 2,0", creg_fields, 2),
+	RESPONSE("CLCC", "+CLCC:", "+CLCC: 1,0,0,0,0,\"+358401234567\",145",
+			clcc_fields, 7),
+	RESPONSE("CMGL", "+CMGL:", "+CMGL: 3,1,,24", cmgl_fields, 4),
+	RESPONSE("COPS", "+COPS:", "+COPS: 0,2,\"24412\",7", cops_fields, 4),
+	RESPONSE("CPIN", "+CPIN:", "+CPIN: READY", cpin_fields, 1),
+	RESPONSE("CMTI", "+CMTI:", "+CMTI: \"SM\",5", cmti_fields, 2),
+	RESPONSE("CUSD", "+CUSD:", "+CUSD: 0,\"Balance 10.00 EUR\",15",
+			cusd_fields, 3),
+	RESPONSE("CSCA", "+CSCA:", "+CSCA: \"+358405202000\",145",
+			csca_fields, 2),
+	RESPONSE("CNUM", "+CNUM:", "+CNUM: \"Own\",\"+358401234567\",145",
+			cnum_fields, 3),
+	RESPONSE("CPBR", "+CPBR:", "+CPBR: 1,\"+358401234567\",145,\"Alice\"",
+			cpbr_fields, 4),
+	RESPONSE("CGACT", "+CGACT:", "+CGACT: 1,1", cgact_fields, 2),
+	RESPONSE("CGDCONT", "+CGDCONT:",
+			"+CGDCONT: 1,\"IP\",\"internet\",\"0.0.0.0\",0,0",
+			cgdcont_fields, 6),
+	RESPONSE("CRSM", "+CRSM:", "+CRSM: 144,0,\"62178202412183026F\"",
+			crsm_fields, 3),
+	RESPONSE("CIND", "+CIND:", "+CIND: 5,99,1,0,0,1", cind_fields, 6),
+	RESPONSE("CCWA", "+CCWA:", "+CCWA: \"+358401234567\",145,1",
+			ccwa_fields, 3),
+	RESPONSE("CLIP", "+CLIP:", "+CLIP: \"+358401234567\",145,,,\"Alice\",0",
+			clip_fields, 6),
+};
+
+/* The same grammar, parsed the way the drivers do with the iterator */
+static gint iter_parse_fields(GAtResultIter *iter, const GAtGrammar *grammar,
+				struct test_fields *out)
+{
+	guint i;
+
+	for (i = 0; i < grammar->num_fields; i++) {
+		const GAtField *field = &grammar->fields[i];
+		char *member = (char *) out + field->offset;
+		const char *str;
+		gboolean ok = FALSE;
+
+		switch (field->type) {
+		case G_AT_FIELD_NUMBER:
+			ok = g_at_result_iter_next_number(iter,
+							(gint *) member);
+			break;
+		case G_AT_FIELD_HEX:
+			ok = g_at_result_iter_next_string(iter, &str);
+			if (ok)
+				*(gint *) member = strtol(str, NULL, 16);
+			break;
+		case G_AT_FIELD_STRING:
+			ok = g_at_result_iter_next_string(iter, &str);
+			if (ok)
+				g_strlcpy(member, str, field->size);
+			break;
+		case G_AT_FIELD_UNQUOTED_STRING:
+			ok = g_at_result_iter_next_unquoted_string(iter, &str);
+			if (ok)
+				g_strlcpy(member, str, field->size);
+			break;
+		case G_AT_FIELD_SKIP:
+			ok = g_at_result_iter_skip_next(iter);
+			break;
+		}
+
+		if (!ok)
+			return (field->flags & G_AT_FIELD_OPTIONAL) ? i : -1;
+	}
+
+	return i;
+}
+
+static gint iter_parse(GAtResultIter *iter, const char *prefix,
+			const GAtGrammar *grammar, struct test_fields *out)
+{
+	gint r;
+
+	while (g_at_result_iter_next(iter, prefix)) {
+		r = iter_parse_fields(iter, grammar, out);
+		if (r >= 0)
+			return r;
+	}
+
+	return -1;
+}
+
+static void result_init(GAtResult *result, const char *line)
+{
+	result->lines = g_slist_append(NULL, (char *) line);
+	result->final_or_pdu = "OK";
+}
+
+static void test_response(gconstpointer data)
+{
+	const struct response_test *test = data;
+	struct test_fields iter_out;
+	struct test_fields out;
+	GAtResultIter iter;
+	GAtResult result;
+
+	result_init(&result, test->line);
+
+	memset(&iter_out, 0, sizeof(iter_out));
+	g_at_result_iter_init(&iter, &result);
+	g_assert(iter_parse(&iter, test->prefix, &test->grammar,
+				&iter_out) == test->parsed);
+
+	memset(&out, 0, sizeof(out));
+	g_at_result_iter_init(&iter, &result);
+	g_assert(g_at_result_iter_parse(&iter, test->prefix, &test->grammar,
+						&out) == test->parsed);
+	g_assert(g_at_result_iter_parse(&iter, test->prefix, &test->grammar,
+						&out) == -1);
+
+	g_assert(memcmp(&out, &iter_out, sizeof(out)) == 0);
+
+	memset(&out, 0, sizeof(out));
+	g_assert(g_at_result_parse_line(test->line, test->prefix,
+					&test->grammar, &out) == test->parsed);
+	g_assert(memcmp(&out, &iter_out, sizeof(out)) == 0);
+
+	g_slist_free(result.lines);
+}
+
+static const GAtGrammar creg_grammar = G_AT_GRAMMAR(creg_fields);
+
+static void test_optional(void)
+{
+	struct test_fields out;
+
+	/* Absent optional fields are left alone */
+	memset(&out, 0xff, sizeof(out));
+	g_assert(g_at_result_parse_line("+CREG: 2,0", "+CREG:",
+						&creg_grammar, &out) == 2);
+	g_assert(out.n[0] == 2);
+	g_assert(out.n[1] == 0);
+	g_assert(out.n[2] == -1);
+
+	/* Unquoted <lac> doesn't parse as HEX, which ends the line there */
+	memset(&out, 0xff, sizeof(out));
+	g_assert(g_at_result_parse_line("+CREG: 2,1,0A1B,01C2D3E4",
+					"+CREG:", &creg_grammar, &out) == 2);
+	g_assert(out.n[1] == 1);
+	g_assert(out.n[2] == -1);
+
+	/* Empty HEX is 0, same as strtol("") */
+	g_assert(g_at_result_parse_line("+CREG: 2,1,,\"FF\",7",
+					"+CREG:", &creg_grammar, &out) == 5);
+	g_assert(out.n[2] == 0);
+	g_assert(out.n[3] == 0xff);
+	g_assert(out.n[4] == 7);
+
+	/* Whatever strtol() accepts */
+	g_assert(g_at_result_parse_line("+CREG: 2,1,\" 0A1B\",\"0x01C2D3E4\"",
+					"+CREG:", &creg_grammar, &out) == 4);
+	g_assert(out.n[2] == 0x0a1b);
+	g_assert(out.n[3] == 0x01c2d3e4);
+
+	g_assert(g_at_result_parse_line("+CREG: 2,1,\"0X1B \",\"zz\"",
+					"+CREG:", &creg_grammar, &out) == 4);
+	g_assert(out.n[2] == 0x1b);
+	g_assert(out.n[3] == 0);
+
+	/* Mandatory fields missing */
+	g_assert(g_at_result_parse_line("+CREG: 1", "+CREG:",
+						&creg_grammar, &out) == -1);
+	g_assert(g_at_result_parse_line("+CREG: 1,\"0A1B\"", "+CREG:",
+						&creg_grammar, &out) == -1);
+	g_assert(g_at_result_parse_line("+CGREG: 2,1", "+CREG:",
+						&creg_grammar, &out) == -1);
+}
+
+struct short_string {
+	char s[4];
+	int n;
+};
+
+static const GAtField short_fields[] = {
+	G_AT_FIELD(STRING, 0, struct short_string, s),
+	G_AT_FIELD(NUMBER, 0, struct short_string, n),
+};
+
+static const GAtGrammar short_grammar = G_AT_GRAMMAR(short_fields);
+
+static void test_truncate(void)
+{
+	struct short_string out;
+
+	g_assert(g_at_result_parse_line("+CSCA: \"+358405202000\",145",
+					"+CSCA:", &short_grammar, &out) == 2);
+	g_assert(!strcmp(out.s, "+35"));
+	g_assert(out.n == 145);
+
+	g_assert(g_at_result_parse_line("+CSCA: \"+358", "+CSCA:",
+						&short_grammar, &out) == -1);
+}
+
+static const GAtGrammar clcc_grammar = G_AT_GRAMMAR(clcc_fields);
+
+static void test_iter(void)
+{
+	static const char *lines[] = {
+		"+CLCC: 1,0,0,0,0,\"+358401234567\",145",
+		"+CLCC: x",
+		"RING",
+		"+CLCC: 2,1,5,0,1",
+	};
+	struct test_fields out;
+	GAtResultIter iter;
+	GAtResult result;
+	const char *str;
+	unsigned int i;
+
+	result.lines = NULL;
+	result.final_or_pdu = "OK";
+
+	for (i = 0; i < G_N_ELEMENTS(lines); i++)
+		result.lines = g_slist_append(result.lines, (char *) lines[i]);
+
+	memset(&out, 0, sizeof(out));
+	g_at_result_iter_init(&iter, &result);
+
+	g_assert(g_at_result_iter_parse(&iter, "+CLCC:", &clcc_grammar,
+						&out) == 7);
+	g_assert(out.n[0] == 1);
+	g_assert(!strcmp(out.s[0], "+358401234567"));
+	g_assert(out.n[5] == 145);
+
+	/* The whole line is consumed */
+	g_assert(!g_at_result_iter_next_number(&iter, NULL));
+	g_assert(!g_at_result_iter_next_string(&iter, &str));
+
+	/* Malformed and unrelated lines are skipped */
+	g_assert(g_at_result_iter_parse(&iter, "+CLCC:", &clcc_grammar,
+						&out) == 5);
+	g_assert(out.n[0] == 2);
+	g_assert(out.n[2] == 5);
+	g_assert(out.n[4] == 1);
+
+	g_assert(g_at_result_iter_parse(&iter, "+CLCC:", &clcc_grammar,
+						&out) == -1);
+	g_assert(g_at_result_iter_parse(&iter, "+CLCC:", &clcc_grammar,
+						&out) == -1);
+
+	/* And the iterator still works after it */
+	g_at_result_iter_init(&iter, &result);
+	g_assert(g_at_result_iter_parse(&iter, "+CLCC:", &clcc_grammar,
+						&out) == 7);
+	g_assert(g_at_result_iter_next(&iter, "RING"));
+
+	g_slist_free(result.lines);
+}
+
+static void test_benchmark(void)
+{
+	struct test_fields out;
+	GAtResultIter iter;
+	GAtResult result;
+	unsigned long parsed;
+	gdouble elapsed;
+	gdouble iter_rate;
+	gdouble rate;
+	unsigned int i, j;
+
+	for (i = 0; i < G_N_ELEMENTS(responses); i++) {
+		const struct response_test *test = &responses[i];
+
+		result_init(&result, test->line);
+
+		parsed = 0;
+		g_test_timer_start();
+
+		do {
+			for (j = 0; j < 1000; j++) {
+				g_at_result_iter_init(&iter, &result);
+				iter_parse(&iter, test->prefix,
+						&test->grammar, &out);
+			}
+
+			parsed += 1000;
+		} while ((elapsed = g_test_timer_elapsed()) <
+							BENCHMARK_SECONDS);
+
+		iter_rate = parsed / elapsed;
+
+		parsed = 0;
+		g_test_timer_start();
+
+		do {
+			for (j = 0; j < 1000; j++) {
+				g_at_result_iter_init(&iter, &result);
+				g_at_result_iter_parse(&iter, test->prefix,
+						&test->grammar, &out);
+			}
+
+			parsed += 1000;
+		} while ((elapsed = g_test_timer_elapsed()) <
+							BENCHMARK_SECONDS);
+
+		rate = parsed / elapsed;
+
+		g_test_maximized_result(rate, "%-8s %10.0f lines/s iterator, "
+					"%10.0f lines/s grammar (x%.1f)",
+					test->name, iter_rate, rate,
+					rate / iter_rate);
+
+		g_slist_free(result.lines);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int i;
+
+	g_test_init(&argc, &argv, NULL);
+
+	for (i = 0; i < G_N_ELEMENTS(responses); i++) {
+		char *name = g_strdup_printf("/testgatresult/Parse %s",
+						responses[i].name);
+
+		g_test_add_data_func(name, &responses[i], test_response);
+		g_free(name);
+	}
+
+	g_test_add_func("/testgatresult/Optional fields", test_optional);
+	g_test_add_func("/testgatresult/Truncate", test_truncate);
+	g_test_add_func("/testgatresult/Iterate", test_iter);
+
+	if (g_test_perf())
+		g_test_add_func("/testgatresult/Benchmark", test_benchmark);
+
+	return g_test_run();
+}
@@ -1084,6 +1084,147 @@ static void test_priorities2(void)
 	test_common_deinit();
 }
 
+/* ==== sync ==== */
+
+#define TEST_SYNC_COUNT (10000)
+
+static ofono_bool_t filter_activate_sync_allow(struct ofono_gprs_context *gc,
+				const struct ofono_gprs_primary_context *ctx)
+{
+	test_filter_activate_count++;
+	return TRUE;
+}
+
+static ofono_bool_t filter_activate_sync_disallow
+			(struct ofono_gprs_context *gc,
+				const struct ofono_gprs_primary_context *ctx)
+{
+	test_filter_activate_count++;
+	return FALSE;
+}
+
+static ofono_bool_t filter_check_sync_allow(struct ofono_gprs *gprs)
+{
+	test_filter_check_count++;
+	return TRUE;
+}
+
+static void test_sync(void)
+{
+	static struct ofono_gprs_filter filter1 = {
+		.name = "sync1",
+		.api_version = OFONO_GPRS_FILTER_API_VERSION,
+		.priority = OFONO_GPRS_FILTER_PRIORITY_HIGH,
+		.filter_activate_sync = filter_activate_sync_allow,
+		.filter_check_sync = filter_check_sync_allow
+	};
+
+	static struct ofono_gprs_filter filter2 = {
+		.name = "sync2",
+		.api_version = OFONO_GPRS_FILTER_API_VERSION,
+		.priority = OFONO_GPRS_FILTER_PRIORITY_DEFAULT,
+		.filter_check_sync = filter_check_sync_allow
+	};
+
+	int count = 0;
+	struct ofono_gprs gprs;
+	struct ofono_gprs_context gc;
+	struct ofono_gprs_primary_context *ctx = &gc.ctx;
+	gint64 start;
+	int i;
+
+	test_common_init();
+	test_gprs_init(&gprs, &gc);
+
+	g_assert(ofono_gprs_filter_register(&filter1) == 0);
+	g_assert(ofono_gprs_filter_register(&filter2) == 0);
+	g_assert((gprs.chain = __ofono_gprs_filter_chain_new(&gprs)) != NULL);
+
+	/* Both requests get completed before the calls return */
+	__ofono_gprs_filter_chain_activate(gprs.chain, &gc, ctx,
+				test_activate_expect_allow, test_inc, &count);
+	g_assert(test_filter_activate_count == 1);
+	g_assert(count == 2);
+	count = 0;
+
+	__ofono_gprs_filter_chain_check(gprs.chain, test_check_expect_allow,
+							test_inc, &count);
+	g_assert(test_filter_check_count == 2);
+	g_assert(count == 2);
+	count = 0;
+
+	/* No main loop iterations per request */
+	test_clear_counts();
+	start = g_get_monotonic_time();
+	for (i = 0; i < TEST_SYNC_COUNT; i++) {
+		__ofono_gprs_filter_chain_check(gprs.chain,
+				test_check_expect_allow, NULL, &count);
+	}
+	DBG("%d requests in %d us", TEST_SYNC_COUNT,
+				(int)(g_get_monotonic_time() - start));
+	g_assert(test_filter_check_count == 2 * TEST_SYNC_COUNT);
+	g_assert(count == TEST_SYNC_COUNT);
+
+	__ofono_gprs_filter_chain_free(gprs.chain);
+	ofono_gprs_filter_unregister(&filter1);
+	ofono_gprs_filter_unregister(&filter2);
+	test_common_deinit();
+}
+
+/* ==== sync_disallow ==== */
+
+static void test_sync_disallow(void)
+{
+	static struct ofono_gprs_filter filter1 = {
+		.name = "sync_disallow",
+		.api_version = OFONO_GPRS_FILTER_API_VERSION,
+		.priority = OFONO_GPRS_FILTER_PRIORITY_HIGH,
+		.filter_activate_sync = filter_activate_sync_disallow,
+		/* The sync callback takes precedence */
+		.filter_activate = filter_activate_continue
+	};
+
+	static struct ofono_gprs_filter filter2 = {
+		.name = "async",
+		.api_version = OFONO_GPRS_FILTER_API_VERSION,
+		.priority = OFONO_GPRS_FILTER_PRIORITY_DEFAULT,
+		/* Never gets called */
+		.filter_activate = filter_activate_continue_later
+	};
+
+	/* API version 1 doesn't have the sync callbacks */
+	static struct ofono_gprs_filter filter3 = {
+		.name = "v1",
+		.api_version = 1,
+		.priority = OFONO_GPRS_FILTER_PRIORITY_HIGH + 1,
+		.filter_activate_sync = filter_activate_sync_disallow
+	};
+
+	int count = 0;
+	struct ofono_gprs gprs;
+	struct ofono_gprs_context gc;
+	struct ofono_gprs_primary_context *ctx = &gc.ctx;
+
+	test_common_init();
+	test_gprs_init(&gprs, &gc);
+
+	g_assert(ofono_gprs_filter_register(&filter1) == 0);
+	g_assert(ofono_gprs_filter_register(&filter2) == 0);
+	g_assert(ofono_gprs_filter_register(&filter3) == 0);
+	g_assert((gprs.chain = __ofono_gprs_filter_chain_new(&gprs)) != NULL);
+
+	__ofono_gprs_filter_chain_activate(gprs.chain, &gc, ctx,
+			test_activate_expect_disallow, test_inc, &count);
+	g_assert(test_filter_activate_count == 1);
+	g_assert(count == 2);
+
+	__ofono_gprs_filter_chain_free(gprs.chain);
+	ofono_gprs_filter_unregister(&filter1);
+	ofono_gprs_filter_unregister(&filter2);
+	ofono_gprs_filter_unregister(&filter3);
+	test_common_deinit();
+}
+
 #define TEST_(name) "/gprs-filter/" name
 
 int main(int argc, char *argv[])
@@ -1120,6 +1261,8 @@ int main(int argc, char *argv[])
 	g_test_add_func(TEST_("cancel6"), test_cancel6);
 	g_test_add_func(TEST_("priorities1"), test_priorities1);
 	g_test_add_func(TEST_("priorities2"), test_priorities2);
+	g_test_add_func(TEST_("sync"), test_sync);
+	g_test_add_func(TEST_("sync_disallow"), test_sync_disallow);
 
 	return g_test_run();
 }
@@ -0,0 +1,151 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <glib.h>
+
+#include <ofono/types.h>
+#include <gril.h>
+
+#include "ril_constants.h"
+#include "rilmodem-test-engine.h"
+
+/*
+ * Every record is an unsolicited RIL_UNSOL_CELL_INFO_LIST whose payload
+ * is filled with a pattern derived from the record index.  The sizes
+ * are picked so that several records arrive in a single read, one of
+ * them wraps around the end of the GRil ring buffer and the ones after
+ * the odd sized record are not 4-byte aligned.
+ */
+static const unsigned int record_sizes[] = {
+	5000, 5000, 8, 12, 1025, 4096, 3000, 2048, 6000, 16
+};
+
+#define RECORD_COUNT G_N_ELEMENTS(record_sizes)
+
+struct test_data {
+	struct engine_data *engined;
+	GRil *ril;
+	unsigned int received;
+};
+
+static guchar pattern(unsigned int record, unsigned int pos)
+{
+	return (guchar) (record * 31 + pos);
+}
+
+static void unsol_notify(struct ril_msg *message, gpointer user_data)
+{
+	struct test_data *td = user_data;
+	const struct rilmodem_test_step *step;
+	unsigned int expected = record_sizes[td->received] - 8;
+	unsigned int i;
+
+	step = rilmodem_test_engine_get_current_step(td->engined);
+	g_assert(step->type == TST_EVENT_CALL);
+
+	g_assert(message->unsolicited);
+	g_assert(message->req == RIL_UNSOL_CELL_INFO_LIST);
+	g_assert(message->buf_len == expected);
+
+	if (expected == 0)
+		g_assert(message->buf == NULL);
+
+	for (i = 0; i < expected; i++)
+		g_assert(((guchar *) message->buf)[i] ==
+						pattern(td->received, i));
+
+	td->received++;
+	rilmodem_test_engine_next_step(td->engined);
+}
+
+static void server_connect_cb(gpointer data)
+{
+	struct test_data *td = data;
+	GByteArray *bytes = g_byte_array_new();
+	unsigned int i, j;
+
+	for (i = 0; i < RECORD_COUNT; i++) {
+		uint32_t len = htonl(record_sizes[i]);
+		int32_t unsol = 1;
+		int32_t req = RIL_UNSOL_CELL_INFO_LIST;
+
+		g_byte_array_append(bytes, (guint8 *) &len, sizeof(len));
+		g_byte_array_append(bytes, (guint8 *) &unsol, sizeof(unsol));
+		g_byte_array_append(bytes, (guint8 *) &req, sizeof(req));
+
+		for (j = 0; j < record_sizes[i] - 8; j++) {
+			guint8 b = pattern(i, j);
+
+			g_byte_array_append(bytes, &b, 1);
+		}
+	}
+
+	rilmodem_test_engine_write_socket(td->engined, bytes->data, bytes->len);
+	g_byte_array_free(bytes, TRUE);
+}
+
+static void test_records(void)
+{
+	struct rilmodem_test_step steps[RECORD_COUNT];
+	struct rilmodem_test_data data;
+	struct test_data td;
+	unsigned int i;
+
+	memset(&td, 0, sizeof(td));
+	memset(steps, 0, sizeof(steps));
+
+	for (i = 0; i < RECORD_COUNT; i++) {
+		steps[i].type = TST_EVENT_CALL;
+		steps[i].call_func = (void (*)(void)) unsol_notify;
+	}
+
+	data.steps = steps;
+	data.num_steps = RECORD_COUNT;
+
+	td.engined = rilmodem_test_engine_create(server_connect_cb, &data,
+									&td);
+	td.ril = g_ril_new(rilmodem_test_engine_get_socket_name(td.engined),
+							OFONO_RIL_VENDOR_AOSP);
+	g_assert(td.ril != NULL);
+
+	g_ril_register(td.ril, RIL_UNSOL_CELL_INFO_LIST, unsol_notify, &td);
+
+	rilmodem_test_engine_start(td.engined);
+
+	g_assert(td.received == RECORD_COUNT);
+
+	g_ril_unref(td.ril);
+	rilmodem_test_engine_remove(td.engined);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+#if BYTE_ORDER == LITTLE_ENDIAN
+	g_test_add_func("/test-gril/records", test_records);
+#endif
+	return g_test_run();
+}
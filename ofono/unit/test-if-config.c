@@ -0,0 +1,252 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <glib.h>
+
+#include "if-config.h"
+
+/*
+ * The loopback interface of a fresh network namespace starts out down
+ * and without addresses, which makes it a convenient test subject.
+ */
+static gboolean enter_netns(void)
+{
+	if (unshare(CLONE_NEWNET) == 0)
+		return TRUE;
+
+	return unshare(CLONE_NEWUSER | CLONE_NEWNET) == 0;
+}
+
+static gboolean link_get(const char *ifname, int *flags, int *mtu)
+{
+	struct ifreq ifr;
+	int sk = socket(PF_INET, SOCK_DGRAM, 0);
+	gboolean ok;
+
+	g_assert(sk >= 0);
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+
+	ok = ioctl(sk, SIOCGIFFLAGS, &ifr) == 0;
+	*flags = ifr.ifr_flags;
+
+	ok = ok && ioctl(sk, SIOCGIFMTU, &ifr) == 0;
+	*mtu = ifr.ifr_mtu;
+
+	close(sk);
+	return ok;
+}
+
+static gboolean has_address(const char *ifname, const char *address)
+{
+	struct ifaddrs *list;
+	struct ifaddrs *ifa;
+	gboolean found = FALSE;
+
+	g_assert(getifaddrs(&list) == 0);
+
+	for (ifa = list; ifa && !found; ifa = ifa->ifa_next) {
+		char buf[INET6_ADDRSTRLEN];
+		const void *addr;
+
+		if (ifa->ifa_addr == NULL || strcmp(ifa->ifa_name, ifname))
+			continue;
+
+		if (ifa->ifa_addr->sa_family == AF_INET)
+			addr = &((struct sockaddr_in *)
+					ifa->ifa_addr)->sin_addr;
+		else if (ifa->ifa_addr->sa_family == AF_INET6)
+			addr = &((struct sockaddr_in6 *)
+					ifa->ifa_addr)->sin6_addr;
+		else
+			continue;
+
+		inet_ntop(ifa->ifa_addr->sa_family, addr, buf, sizeof(buf));
+		found = !strcmp(buf, address);
+	}
+
+	freeifaddrs(list);
+	return found;
+}
+
+static gboolean file_contains(const char *path, const char *str)
+{
+	gchar *data;
+	gboolean found;
+
+	g_assert(g_file_get_contents(path, &data, NULL, NULL));
+	found = strstr(data, str) != NULL;
+	g_free(data);
+
+	return found;
+}
+
+static void send_packet(const char *address, unsigned int size)
+{
+	struct sockaddr_in sin;
+	char buf[512];
+	int sk = socket(PF_INET, SOCK_DGRAM, 0);
+
+	g_assert(sk >= 0);
+	g_assert(size <= sizeof(buf));
+	memset(buf, 0, sizeof(buf));
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(9);
+	inet_pton(AF_INET, address, &sin.sin_addr);
+
+	g_assert(sendto(sk, buf, size, 0, (struct sockaddr *) &sin,
+						sizeof(sin)) == (int) size);
+	close(sk);
+}
+
+static void test_invalid(void)
+{
+	struct if_counters counters;
+	struct if_config *conf;
+
+	g_assert(if_config_get_counters(NULL, &counters) == -ENODEV);
+	g_assert(if_config_get_counters("nosuchif0", &counters) == -ENODEV);
+
+	g_assert(if_config_new(NULL) == NULL);
+	g_assert(if_config_new("nosuchif0") == NULL);
+
+	conf = if_config_new("lo");
+	g_assert(conf);
+
+	g_assert(if_config_add_address(conf, NULL, 32) == -EINVAL);
+	g_assert(if_config_add_address(conf, "10.0.0", 32) == -EINVAL);
+	g_assert(if_config_add_address(conf, "10.0.0.1", 33) == -EINVAL);
+	g_assert(if_config_add_address(conf, "fd00::1", 129) == -EINVAL);
+	g_assert(if_config_del_address(conf, "proxy.example.com", 32) ==
+								-EINVAL);
+	g_assert(if_config_add_route(conf, "10.0.0.1", -1, NULL) == -EINVAL);
+	g_assert(if_config_add_route(conf, "10.0.0.0", 8, "fd00::1") ==
+								-EINVAL);
+	g_assert(if_config_add_route(conf, "fd00::", 64, "gateway") == -EINVAL);
+
+	/* Nothing was queued */
+	g_assert(if_config_commit(conf) == 0);
+	g_assert(if_config_get_stats(conf)->steps == 0);
+
+	if_config_free(conf);
+	if_config_free(NULL);
+}
+
+static void test_apply(void)
+{
+	const struct if_config_stats *stats;
+	struct if_counters before;
+	struct if_counters after;
+	struct if_config *conf;
+	int flags;
+	int mtu;
+	int i;
+
+	if (!enter_netns()) {
+		g_test_message("Can't create a network namespace: %s",
+							strerror(errno));
+		return;
+	}
+
+	g_assert(link_get("lo", &flags, &mtu));
+	g_assert(!(flags & IFF_UP));
+
+	conf = if_config_new("lo");
+	g_assert(conf);
+
+	if_config_set_mtu(conf, 1400);
+	if_config_set_up(conf, TRUE);
+	g_assert(if_config_add_address(conf, "10.1.2.3", 32) == 0);
+	g_assert(if_config_add_address(conf, "fd00::5", 128) == 0);
+	g_assert(if_config_add_route(conf, "10.9.9.9", 32, NULL) == 0);
+	g_assert(if_config_add_route(conf, "fd00:1::", 64, NULL) == 0);
+	g_assert(if_config_commit(conf) == 0);
+
+	stats = if_config_get_stats(conf);
+	g_assert(stats->steps == 6);
+	g_assert(stats->failed == 0);
+	g_assert(stats->total_us >= stats->send_us);
+
+	g_assert(link_get("lo", &flags, &mtu));
+	g_assert(flags & IFF_UP);
+	g_assert(mtu == 1400);
+	g_assert(has_address("lo", "10.1.2.3"));
+	g_assert(has_address("lo", "fd00::5"));
+	g_assert(file_contains("/proc/net/route", "lo\t0909090A"));
+	g_assert(file_contains("/proc/net/ipv6_route",
+				"fd000001000000000000000000000000 40"));
+
+	/* Loopback counts each packet both ways */
+	g_assert(if_config_get_counters("lo", &before) == 0);
+	send_packet("10.1.2.3", 500);
+	g_assert(if_config_get_counters("lo", &after) == 0);
+	g_assert(after.tx_packets > before.tx_packets);
+	g_assert(after.rx_packets > before.rx_packets);
+	g_assert(after.tx_bytes > before.tx_bytes + 500);
+	g_assert(after.rx_bytes > before.rx_bytes + 500);
+
+	/* A failing change doesn't stop the ones after it */
+	g_assert(if_config_del_address(conf, "10.7.7.7", 32) == 0);
+	g_assert(if_config_del_address(conf, "10.1.2.3", 32) == 0);
+	if_config_set_up(conf, FALSE);
+	g_assert(if_config_commit(conf) < 0);
+
+	stats = if_config_get_stats(conf);
+	g_assert(stats->steps == 3);
+	g_assert(stats->failed == 1);
+
+	g_assert(link_get("lo", &flags, &mtu));
+	g_assert(!(flags & IFF_UP));
+	g_assert(!has_address("lo", "10.1.2.3"));
+
+	/* The batch has a fixed size */
+	for (i = 0; i < 16; i++)
+		if_config_set_mtu(conf, 1500);
+
+	g_assert(if_config_add_route(conf, "10.9.9.9", 32, NULL) == -ENOSPC);
+	g_assert(if_config_commit(conf) == 0);
+	g_assert(if_config_get_stats(conf)->steps == 16);
+
+	if_config_free(conf);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/testifconfig/Invalid", test_invalid);
+	g_test_add_func("/testifconfig/Apply", test_apply);
+
+	return g_test_run();
+}
@@ -29,10 +29,18 @@
 
 #include <ell/ell.h>
 
+#include <ofono/log.h>
+
 #include "drivers/mbimmodem/mbim.h"
 #include "drivers/mbimmodem/mbim-message.h"
 #include "drivers/mbimmodem/mbim-private.h"
 
+/* Stub for the transport tracing in mbim.c */
+void ofono_trace_data(const void *channel, int in, const void *data,
+							unsigned int len)
+{
+}
+
 struct message_data {
 	uint32_t tid;
 	const unsigned char *binary;
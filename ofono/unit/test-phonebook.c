@@ -0,0 +1,758 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#include "test-dbus.h"
+
+#include "ofono.h"
+#include "simutil.h"
+
+#include <gutil_log.h>
+#include <gutil_macros.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_TIMEOUT                    (10)   /* seconds */
+#define TEST_MODEM_PATH                 "/test"
+#define TEST_IMSI                       "244120000000029"
+#define TEST_ICCID                      "8935812000000000290"
+#define TEST_ADN_RECORDS                (3)
+#define TEST_ADN_RECORD_LEN             (14)
+#define TEST_DRIVER                     "test"
+#define TEST_ENTRIES                    (1000)
+#define TEST_MERGE_EVERY                (10)
+
+static gboolean test_debug;
+
+/* Fake ofono_sim */
+
+struct ofono_sim {
+	const char *imsi;
+	const char *iccid;
+	enum ofono_sim_phase phase;
+	int adn_serial; /* changes the contents of EFadn */
+	ofono_sim_file_changed_cb_t changed;
+	void *changed_data;
+};
+
+struct ofono_sim_context {
+	struct ofono_sim *sim;
+};
+
+const char *ofono_sim_get_imsi(struct ofono_sim *sim)
+{
+	return sim->imsi;
+}
+
+enum ofono_sim_phase ofono_sim_get_phase(struct ofono_sim *sim)
+{
+	return sim->phase;
+}
+
+unsigned int ofono_sim_add_iccid_watch(struct ofono_sim *sim,
+				ofono_sim_iccid_event_cb_t cb, void *data,
+				ofono_destroy_func destroy)
+{
+	cb(sim->iccid, data);
+	return 1;
+}
+
+void ofono_sim_remove_iccid_watch(struct ofono_sim *sim, unsigned int id)
+{
+	g_assert_cmpuint(id, ==, 1);
+}
+
+struct ofono_sim_context *ofono_sim_context_create(struct ofono_sim *sim)
+{
+	struct ofono_sim_context *context = g_new0(struct ofono_sim_context, 1);
+
+	context->sim = sim;
+	return context;
+}
+
+void ofono_sim_context_free(struct ofono_sim_context *context)
+{
+	context->sim->changed = NULL;
+	context->sim->changed_data = NULL;
+	g_free(context);
+}
+
+unsigned int ofono_sim_add_file_watch(struct ofono_sim_context *context,
+					int id, ofono_sim_file_changed_cb_t cb,
+					void *userdata,
+					ofono_destroy_func destroy)
+{
+	/* All watches share the callback */
+	context->sim->changed = cb;
+	context->sim->changed_data = userdata;
+	return id;
+}
+
+int ofono_sim_read(struct ofono_sim_context *context, int id,
+			enum ofono_sim_file_structure expected,
+			ofono_sim_file_read_cb_t cb, void *data)
+{
+	unsigned char record[TEST_ADN_RECORD_LEN];
+	int i;
+
+	g_assert(expected == OFONO_SIM_FILE_STRUCTURE_FIXED);
+
+	/* There is no EFext1 on the card */
+	if (id != SIM_EFADN_FILEID) {
+		cb(0, 0, 0, NULL, 0, data);
+		return 0;
+	}
+
+	for (i = 1; i <= TEST_ADN_RECORDS; i++) {
+		memset(record, 0xff, sizeof(record));
+		record[0] = i;
+		record[1] = context->sim->adn_serial;
+		cb(1, sizeof(record) * TEST_ADN_RECORDS, i, record,
+						sizeof(record), data);
+	}
+
+	return 0;
+}
+
+/* Fake ofono_modem and ofono_atom */
+
+struct ofono_modem {
+	const char *path;
+	struct ofono_sim sim;
+	struct ofono_atom *sim_atom;
+};
+
+struct ofono_atom {
+	enum ofono_atom_type type;
+	struct ofono_modem *modem;
+	void *data;
+	void (*destruct)(struct ofono_atom *atom);
+	void (*unregister)(struct ofono_atom *atom);
+};
+
+struct ofono_atom *__ofono_modem_add_atom(struct ofono_modem *modem,
+					enum ofono_atom_type type,
+					void (*destruct)(struct ofono_atom *),
+					void *data)
+{
+	struct ofono_atom *atom = g_new0(struct ofono_atom, 1);
+
+	atom->type = type;
+	atom->modem = modem;
+	atom->data = data;
+	atom->destruct = destruct;
+	return atom;
+}
+
+struct ofono_atom *__ofono_modem_find_atom(struct ofono_modem *modem,
+						enum ofono_atom_type type)
+{
+	return type == OFONO_ATOM_TYPE_SIM ? modem->sim_atom : NULL;
+}
+
+void *__ofono_atom_get_data(struct ofono_atom *atom)
+{
+	return atom->data;
+}
+
+const char *__ofono_atom_get_path(struct ofono_atom *atom)
+{
+	return atom->modem->path;
+}
+
+struct ofono_modem *__ofono_atom_get_modem(struct ofono_atom *atom)
+{
+	return atom->modem;
+}
+
+void __ofono_atom_register(struct ofono_atom *atom,
+				void (*unregister)(struct ofono_atom *))
+{
+	atom->unregister = unregister;
+}
+
+void __ofono_atom_free(struct ofono_atom *atom)
+{
+	if (atom->unregister)
+		atom->unregister(atom);
+
+	if (atom->destruct)
+		atom->destruct(atom);
+
+	g_free(atom);
+}
+
+void ofono_modem_add_interface(struct ofono_modem *modem, const char *iface)
+{
+}
+
+void ofono_modem_remove_interface(struct ofono_modem *modem,
+							const char *iface)
+{
+}
+
+/* Fake phonebook driver */
+
+static int test_exports;
+static gboolean test_fail_sm;
+
+struct test_export {
+	struct ofono_phonebook *pb;
+	char *storage;
+	ofono_phonebook_cb_t cb;
+	void *data;
+};
+
+static gboolean test_export_entries_cb(gpointer user_data)
+{
+	struct test_export *exp = user_data;
+	struct ofono_error error;
+	int i;
+
+	/* Every TEST_MERGE_EVERY contact has two numbers to merge */
+	for (i = 0; !strcmp(exp->storage, "SM") && !test_fail_sm &&
+						i < TEST_ENTRIES; i++) {
+		char number[32];
+		char text[32];
+
+		snprintf(number, sizeof(number), "+3584000%05d", i);
+
+		if (i % TEST_MERGE_EVERY) {
+			snprintf(text, sizeof(text), "Contact %d", i);
+			ofono_phonebook_entry(exp->pb, i, number, 145, text,
+					0, NULL, NULL, 0, NULL,
+					"test@example.com", NULL, NULL);
+			continue;
+		}
+
+		snprintf(text, sizeof(text), "Contact %d/m", i);
+		ofono_phonebook_entry(exp->pb, i, number, 145, text, 0,
+					NULL, NULL, 0, NULL, NULL, NULL, NULL);
+
+		snprintf(number, sizeof(number), "+3589000%05d", i);
+		snprintf(text, sizeof(text), "Contact %d/h", i);
+		ofono_phonebook_entry(exp->pb, i, number, 145, text, 0,
+					NULL, NULL, 0, NULL, NULL, NULL, NULL);
+	}
+
+	if (test_fail_sm && !strcmp(exp->storage, "SM"))
+		error.type = OFONO_ERROR_TYPE_FAILURE;
+	else
+		error.type = OFONO_ERROR_TYPE_NO_ERROR;
+
+	error.error = 0;
+	exp->cb(&error, exp->data);
+
+	g_free(exp->storage);
+	g_free(exp);
+	return G_SOURCE_REMOVE;
+}
+
+static void test_export_entries(struct ofono_phonebook *pb,
+				const char *storage,
+				ofono_phonebook_cb_t cb, void *data)
+{
+	struct test_export *exp = g_new0(struct test_export, 1);
+
+	DBG("%s", storage);
+	test_exports++;
+
+	exp->pb = pb;
+	exp->storage = g_strdup(storage);
+	exp->cb = cb;
+	exp->data = data;
+	g_idle_add(test_export_entries_cb, exp);
+}
+
+static int test_probe(struct ofono_phonebook *pb, unsigned int vendor,
+								void *data)
+{
+	return 0;
+}
+
+static const struct ofono_phonebook_driver test_driver = {
+	.name           = TEST_DRIVER,
+	.probe          = test_probe,
+	.export_entries = test_export_entries,
+};
+
+/* ==== common ==== */
+
+enum test_step_type {
+	TEST_STEP_IMPORT,
+	TEST_STEP_IMPORT_FD,
+	TEST_STEP_IMPORT_FAILED,
+	TEST_STEP_SIM_CHANGED,
+	TEST_STEP_RESTART,
+	TEST_STEP_RESTART_EDITED,
+};
+
+struct test_step {
+	enum test_step_type type;
+	int exports; /* Expected number of driver calls when done */
+};
+
+struct test_data {
+	struct test_dbus_context dbus;
+	struct ofono_modem modem;
+	struct ofono_atom sim_atom;
+	struct ofono_phonebook *pb;
+	char *dir;
+	char *cache_path;
+	const struct test_step *steps;
+	guint nsteps;
+	guint step;
+	char *vcards;
+	GString *fd_data;
+	gboolean fd_eof;
+	gboolean fd_reply;
+	gint64 start;
+};
+
+static gboolean test_timeout(gpointer param)
+{
+	g_assert(!"TIMEOUT");
+	return G_SOURCE_REMOVE;
+}
+
+static guint test_setup_timeout(void)
+{
+	if (test_debug)
+		return 0;
+	else
+		return g_timeout_add_seconds(TEST_TIMEOUT, test_timeout, NULL);
+}
+
+static const char *test_step_name(enum test_step_type type)
+{
+	switch (type) {
+	case TEST_STEP_IMPORT:
+		return "Import";
+	case TEST_STEP_IMPORT_FD:
+		return "ImportFd";
+	case TEST_STEP_IMPORT_FAILED:
+		return "Import (failed)";
+	case TEST_STEP_SIM_CHANGED:
+		return "SIM changed";
+	case TEST_STEP_RESTART:
+		return "Restart";
+	case TEST_STEP_RESTART_EDITED:
+		return "Restart (edited)";
+	}
+
+	return NULL;
+}
+
+static void test_phonebook_create(struct test_data *test)
+{
+	test->pb = ofono_phonebook_create(&test->modem, 0, TEST_DRIVER, NULL);
+	g_assert(test->pb);
+	ofono_phonebook_register(test->pb);
+}
+
+static guint test_count_vcards(const char *vcards)
+{
+	guint count = 0;
+	const char *ptr = vcards;
+
+	while ((ptr = strstr(ptr, "BEGIN:VCARD")) != NULL) {
+		count++;
+		ptr++;
+	}
+
+	return count;
+}
+
+static void test_next_step(struct test_data *test);
+
+static void test_step_done(struct test_data *test, const char *vcards)
+{
+	const struct test_step *step = test->steps + test->step;
+
+	if (g_test_verbose())
+		g_print("%s: %" G_GINT64_FORMAT " us\n",
+				test_step_name(step->type),
+				g_get_monotonic_time() - test->start);
+
+	g_assert_cmpint(test_exports, ==, step->exports);
+
+	if (vcards) {
+		if (test->vcards) {
+			g_assert_cmpstr(vcards, ==, test->vcards);
+		} else {
+			g_assert_cmpuint(test_count_vcards(vcards), ==,
+							TEST_ENTRIES);
+			test->vcards = g_strdup(vcards);
+		}
+	}
+
+	test->step++;
+	test_next_step(test);
+}
+
+static void test_import_reply(DBusPendingCall *call, void *data)
+{
+	struct test_data *test = data;
+	DBusMessage *reply = dbus_pending_call_steal_reply(call);
+	DBusMessageIter it;
+
+	g_assert(dbus_message_get_type(reply) ==
+					DBUS_MESSAGE_TYPE_METHOD_RETURN);
+
+	dbus_message_iter_init(reply, &it);
+	test_step_done(test, test_dbus_get_string(&it));
+
+	dbus_message_unref(reply);
+	dbus_pending_call_unref(call);
+}
+
+static void test_import_failed_reply(DBusPendingCall *call, void *data)
+{
+	struct test_data *test = data;
+	DBusMessage *reply = dbus_pending_call_steal_reply(call);
+
+	g_assert(dbus_message_get_type(reply) ==
+					DBUS_MESSAGE_TYPE_METHOD_RETURN);
+
+	/* Nothing is kept from a partial export */
+	test_fail_sm = FALSE;
+	g_assert(access(test->cache_path, F_OK) < 0);
+	test_step_done(test, NULL);
+
+	dbus_message_unref(reply);
+	dbus_pending_call_unref(call);
+}
+
+static void test_import_fd_check_done(struct test_data *test)
+{
+	if (test->fd_eof && test->fd_reply) {
+		char *vcards = g_string_free(test->fd_data, FALSE);
+
+		test->fd_data = NULL;
+		test_step_done(test, vcards);
+		g_free(vcards);
+	}
+}
+
+static void test_import_fd_reply(DBusPendingCall *call, void *data)
+{
+	struct test_data *test = data;
+
+	test_dbus_check_empty_reply(call, NULL);
+	test->fd_reply = TRUE;
+	test_import_fd_check_done(test);
+}
+
+static gboolean test_import_fd_read(GIOChannel *io, GIOCondition cond,
+							gpointer data)
+{
+	struct test_data *test = data;
+	char buf[4096];
+	ssize_t len = read(g_io_channel_unix_get_fd(io), buf, sizeof(buf));
+
+	if (len > 0) {
+		g_string_append_len(test->fd_data, buf, len);
+		return G_SOURCE_CONTINUE;
+	}
+
+	g_assert(len == 0);
+	test->fd_eof = TRUE;
+	test_import_fd_check_done(test);
+	return G_SOURCE_REMOVE;
+}
+
+static void test_call(struct test_data *test, const char *method, int fd,
+					DBusPendingCallNotifyFunction fn)
+{
+	DBusConnection *conn = test->dbus.client_connection;
+	DBusPendingCall *call;
+	DBusMessage *msg;
+
+	msg = dbus_message_new_method_call(NULL, TEST_MODEM_PATH,
+					OFONO_PHONEBOOK_INTERFACE, method);
+
+	if (fd >= 0)
+		dbus_message_append_args(msg, DBUS_TYPE_UNIX_FD, &fd,
+						DBUS_TYPE_INVALID);
+
+	g_assert(dbus_connection_send_with_reply(conn, msg, &call,
+						DBUS_TIMEOUT_INFINITE));
+	dbus_pending_call_set_notify(call, fn, test, NULL);
+	dbus_message_unref(msg);
+}
+
+static gboolean test_run_step(gpointer data)
+{
+	struct test_data *test = data;
+	const struct test_step *step;
+	GIOChannel *io;
+	int fd[2];
+
+	if (test->step == test->nsteps) {
+		g_main_loop_quit(test->dbus.loop);
+		return G_SOURCE_REMOVE;
+	}
+
+	step = test->steps + test->step;
+	test->start = g_get_monotonic_time();
+
+	switch (step->type) {
+	case TEST_STEP_IMPORT:
+		test_call(test, "Import", -1, test_import_reply);
+		break;
+	case TEST_STEP_IMPORT_FD:
+		g_assert(!pipe(fd));
+		test->fd_data = g_string_new(NULL);
+		test->fd_eof = FALSE;
+		test->fd_reply = FALSE;
+
+		io = g_io_channel_unix_new(fd[0]);
+		g_io_channel_set_close_on_unref(io, TRUE);
+		g_io_add_watch(io, G_IO_IN | G_IO_HUP, test_import_fd_read,
+									test);
+		g_io_channel_unref(io);
+
+		/* The message holds its own duplicate of the fd */
+		test_call(test, "ImportFd", fd[1], test_import_fd_reply);
+		close(fd[1]);
+		break;
+	case TEST_STEP_IMPORT_FAILED:
+		test_fail_sm = TRUE;
+		test_call(test, "Import", -1, test_import_failed_reply);
+		break;
+	case TEST_STEP_SIM_CHANGED:
+		g_assert(test->modem.sim.changed);
+		test->modem.sim.adn_serial++;
+		test->modem.sim.changed(SIM_EFADN_FILEID,
+					test->modem.sim.changed_data);
+		g_assert(access(test->cache_path, F_OK) < 0);
+		test_step_done(test, NULL);
+		break;
+	case TEST_STEP_RESTART:
+		g_assert(access(test->cache_path, F_OK) == 0);
+		ofono_phonebook_remove(test->pb);
+		test_phonebook_create(test);
+		g_assert(access(test->cache_path, F_OK) == 0);
+		test_step_done(test, NULL);
+		break;
+	case TEST_STEP_RESTART_EDITED:
+		/* EFadn is written while ofonod is not running */
+		g_assert(access(test->cache_path, F_OK) == 0);
+		ofono_phonebook_remove(test->pb);
+		test->modem.sim.adn_serial++;
+		test_phonebook_create(test);
+		g_assert(access(test->cache_path, F_OK) < 0);
+		test_step_done(test, NULL);
+		break;
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+static void test_next_step(struct test_data *test)
+{
+	g_idle_add(test_run_step, test);
+}
+
+static void test_start(struct test_dbus_context *dbus)
+{
+	struct test_data *test = G_CAST(dbus, struct test_data, dbus);
+
+	test_phonebook_create(test);
+	test_next_step(test);
+}
+
+static void test_run_phase(const struct test_step *steps,
+					enum ofono_sim_phase phase)
+{
+	struct test_data test;
+	guint timeout = test_setup_timeout();
+
+	memset(&test, 0, sizeof(test));
+	test.steps = steps;
+
+	while (steps[test.nsteps].exports)
+		test.nsteps++;
+
+	test.modem.path = TEST_MODEM_PATH;
+	test.modem.sim.imsi = TEST_IMSI;
+	test.modem.sim.iccid = TEST_ICCID;
+	test.modem.sim.phase = phase;
+	test.modem.sim_atom = &test.sim_atom;
+	test.sim_atom.type = OFONO_ATOM_TYPE_SIM;
+	test.sim_atom.modem = &test.modem;
+	test.sim_atom.data = &test.modem.sim;
+	test_exports = 0;
+	test_fail_sm = FALSE;
+
+	test.dir = g_dir_make_tmp("test-phonebook-XXXXXX", NULL);
+	g_assert(test.dir);
+	test.cache_path = g_build_filename(test.dir, TEST_IMSI, "phonebook",
+									NULL);
+	__ofono_set_storage_dir(test.dir);
+
+	test_dbus_setup(&test.dbus);
+	test.dbus.start = test_start;
+
+	g_assert(!ofono_phonebook_driver_register(&test_driver));
+	g_main_loop_run(test.dbus.loop);
+	g_assert_cmpuint(test.step, ==, test.nsteps);
+
+	ofono_phonebook_remove(test.pb);
+	ofono_phonebook_driver_unregister(&test_driver);
+	test_dbus_shutdown(&test.dbus);
+	g_free(test.vcards);
+
+	__ofono_set_storage_dir(NULL);
+	unlink(test.cache_path);
+	g_free(test.cache_path);
+	test.cache_path = g_build_filename(test.dir, TEST_IMSI, NULL);
+	rmdir(test.cache_path);
+	rmdir(test.dir);
+	g_free(test.cache_path);
+	g_free(test.dir);
+
+	if (timeout)
+		g_source_remove(timeout);
+}
+
+static void test_run(gconstpointer data)
+{
+	test_run_phase(data, OFONO_SIM_PHASE_2G);
+}
+
+static void test_run_usim(gconstpointer data)
+{
+	test_run_phase(data, OFONO_SIM_PHASE_3G);
+}
+
+/*
+ * A full export goes through two storages, SM and ME.  Once the SM entries
+ * are cached, only the ME storage is read.
+ */
+
+static const struct test_step test_cache[] = {
+	{ TEST_STEP_IMPORT, 2 },
+	{ TEST_STEP_IMPORT, 3 },
+	{ TEST_STEP_SIM_CHANGED, 3 },
+	{ TEST_STEP_IMPORT, 5 },
+	{ TEST_STEP_IMPORT, 6 },
+	{ }
+};
+
+static const struct test_step test_persist[] = {
+	{ TEST_STEP_IMPORT, 2 },
+	{ TEST_STEP_RESTART, 2 },
+	{ TEST_STEP_IMPORT, 3 },
+	{ }
+};
+
+static const struct test_step test_stale[] = {
+	{ TEST_STEP_IMPORT, 2 },
+	{ TEST_STEP_RESTART_EDITED, 2 },
+	{ TEST_STEP_IMPORT, 4 },
+	{ TEST_STEP_RESTART, 4 },
+	{ TEST_STEP_IMPORT, 5 },
+	{ }
+};
+
+static const struct test_step test_failed[] = {
+	{ TEST_STEP_IMPORT_FAILED, 2 },
+	{ TEST_STEP_IMPORT, 4 },
+	{ TEST_STEP_RESTART, 4 },
+	{ TEST_STEP_IMPORT, 5 },
+	{ }
+};
+
+static const struct test_step test_fd[] = {
+	{ TEST_STEP_IMPORT_FD, 2 },
+	{ TEST_STEP_IMPORT, 3 },
+	{ TEST_STEP_IMPORT_FD, 4 },
+	{ TEST_STEP_SIM_CHANGED, 4 },
+	{ TEST_STEP_IMPORT_FD, 6 },
+	{ }
+};
+
+/*
+ * The files of a USIM phonebook aren't watched, so its SM entries are
+ * read on every export.
+ */
+static const struct test_step test_usim[] = {
+	{ TEST_STEP_IMPORT, 2 },
+	{ TEST_STEP_IMPORT, 4 },
+	{ TEST_STEP_IMPORT_FD, 6 },
+	{ TEST_STEP_IMPORT, 8 },
+	{ }
+};
+
+static const struct test_step test_benchmark[] = {
+	{ TEST_STEP_IMPORT, 2 },
+	{ TEST_STEP_IMPORT, 3 },
+	{ TEST_STEP_IMPORT_FD, 4 },
+	{ TEST_STEP_RESTART, 4 },
+	{ TEST_STEP_IMPORT, 5 },
+	{ TEST_STEP_IMPORT_FD, 6 },
+	{ TEST_STEP_SIM_CHANGED, 6 },
+	{ TEST_STEP_IMPORT_FD, 8 },
+	{ }
+};
+
+#define TEST_(name) "/phonebook/" name
+
+int main(int argc, char *argv[])
+{
+	int i;
+
+	g_test_init(&argc, &argv, NULL);
+	for (i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		if (!strcmp(arg, "-d") || !strcmp(arg, "--debug")) {
+			test_debug = TRUE;
+		} else {
+			GWARN("Unsupported command line option %s", arg);
+		}
+	}
+
+	gutil_log_timestamp = FALSE;
+	gutil_log_default.level = g_test_verbose() ?
+		GLOG_LEVEL_VERBOSE : GLOG_LEVEL_NONE;
+	__ofono_log_init("test-phonebook",
+				g_test_verbose() ? "*" : NULL,
+				FALSE, FALSE);
+
+	g_test_add_data_func(TEST_("cache"), test_cache, test_run);
+	g_test_add_data_func(TEST_("persist"), test_persist, test_run);
+	g_test_add_data_func(TEST_("stale"), test_stale, test_run);
+	g_test_add_data_func(TEST_("failed"), test_failed, test_run);
+	g_test_add_data_func(TEST_("fd"), test_fd, test_run);
+	g_test_add_data_func(TEST_("usim"), test_usim, test_run_usim);
+
+	if (g_test_perf())
+		g_test_add_data_func(TEST_("benchmark"), test_benchmark,
+								test_run);
+
+	return g_test_run();
+}
+
+/*
+ * Local Variables:
+ * mode: C
+ * c-basic-offset: 8
+ * indent-tabs-mode: t
+ * End:
+ */
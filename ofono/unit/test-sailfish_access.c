@@ -25,6 +25,7 @@
 #include <errno.h>
 
 static GUtilIdlePool* peer_pool;
+static int peer_get_count;
 
 extern struct ofono_plugin_desc __ofono_builtin_sailfish_access;
 extern const char *sailfish_access_config_file;
@@ -47,6 +48,7 @@ extern const char *sailfish_access_config_file;
 
 DAPeer *da_peer_get(DA_BUS bus, const char *name)
 {
+	peer_get_count++;
 	if (name && g_strcmp0(name, INVALID_SENDER)) {
 		gsize len = strlen(name);
 		DAPeer *peer = g_malloc0(sizeof(DAPeer) + len + 1);
@@ -147,6 +149,60 @@ static void test_default()
 	sailfish_access_config_file = default_config_file;
 }
 
+static void test_cache()
+{
+	const char *default_config_file = sailfish_access_config_file;
+	const int n = 100000;
+	gint64 start, cached, uncached;
+	int i;
+
+	sailfish_access_config_file = "/no such file";
+	g_assert(__ofono_builtin_sailfish_access.init() == 0);
+
+	/* The peer is only looked up once */
+	peer_get_count = 0;
+	start = g_get_monotonic_time();
+	for (i = 0; i < n; i++) {
+		g_assert(!__ofono_dbus_access_method_allowed(
+				NON_PRIVILEGED_SENDER,
+				OFONO_DBUS_ACCESS_INTF_VOICECALLMGR,
+				OFONO_DBUS_ACCESS_VOICECALLMGR_DIAL, NULL));
+	}
+	cached = g_get_monotonic_time() - start;
+	g_assert(peer_get_count == 1);
+
+	/* Until the peer leaves the bus */
+	__ofono_dbus_access_peer_gone(NON_PRIVILEGED_SENDER);
+	g_assert(!__ofono_dbus_access_method_allowed(NON_PRIVILEGED_SENDER,
+				OFONO_DBUS_ACCESS_INTF_VOICECALLMGR,
+				OFONO_DBUS_ACCESS_VOICECALLMGR_DIAL, NULL));
+	g_assert(peer_get_count == 2);
+
+	/* Same thing without the cache */
+	peer_get_count = 0;
+	start = g_get_monotonic_time();
+	for (i = 0; i < n; i++) {
+		ofono_dbus_access_invalidate();
+		g_assert(!__ofono_dbus_access_method_allowed(
+				NON_PRIVILEGED_SENDER,
+				OFONO_DBUS_ACCESS_INTF_VOICECALLMGR,
+				OFONO_DBUS_ACCESS_VOICECALLMGR_DIAL, NULL));
+	}
+	uncached = g_get_monotonic_time() - start;
+	g_assert(peer_get_count == n);
+
+	if (g_test_verbose()) {
+		g_print("%d calls: %d us cached, %d us uncached\n", n,
+					(int) cached, (int) uncached);
+	}
+
+	__ofono_builtin_sailfish_access.exit();
+	gutil_idle_pool_drain(peer_pool);
+
+	/* Restore the defaults */
+	sailfish_access_config_file = default_config_file;
+}
+
 struct test_config_data {
 	gboolean allowed;
 	const char *sender;
@@ -281,6 +337,7 @@ int main(int argc, char *argv[])
 
 	g_test_add_func(TEST_("register"), test_register);
 	g_test_add_func(TEST_("default"), test_default);
+	g_test_add_func(TEST_("cache"), test_cache);
 	for (i = 0; i < G_N_ELEMENTS(config_tests); i++) {
 		char* name = g_strdup_printf(TEST_("config/%d"), i + 1);
 		const struct test_config_data *test = config_tests + i;
@@ -134,6 +134,7 @@ static struct sailfish_manager_dbus {
 	void (*fn_signal)(struct sailfish_manager_dbus *d,
 					enum sailfish_manager_dbus_signal m);
 	int signals;
+	int data_switch_index;
 } fake_sailfish_manager_dbus;
 
 struct sailfish_manager_dbus *sailfish_manager_dbus_new
@@ -181,6 +182,11 @@ void sailfish_manager_dbus_signal_error(struct sailfish_manager_dbus *d,
 				const char *id, const char *message) {}
 void sailfish_manager_dbus_signal_modem_error(struct sailfish_manager_dbus *d,
 				int index, const char *id, const char *msg) {}
+void sailfish_manager_dbus_signal_data_switch(struct sailfish_manager_dbus *d,
+			int index, const struct sailfish_data_switch_timings *t)
+{
+	d->data_switch_index = index;
+}
 
 /* Fake sailfish_sim_info */
 
@@ -1098,10 +1104,14 @@ static void test_auto_data_sim(gconstpointer option)
 
 static gboolean test_data_sim_done(gpointer user_data)
 {
+	static const struct sailfish_data_switch_timings switched = {
+		100000, 0, 200000, 300000
+	};
 	test_slot_manager *sm = user_data;
 	test_slot *s = sm->slot;
 	struct sailfish_manager *m = fake_sailfish_manager_dbus.m;
 	struct ofono_watch *w = ofono_watch_new(TEST_PATH);
+	struct sailfish_data_switch_timings timings;
 	struct ofono_modem modem;
 	struct ofono_sim sim;
 
@@ -1159,6 +1169,18 @@ static gboolean test_data_sim_done(gpointer user_data)
 	g_assert(!g_strcmp0(m->default_data_imsi, TEST_IMSI_1));
 	g_assert(!m->default_data_path);
 
+	/* Data switch timings reported by the driver */
+	g_assert(!fake_sailfish_manager_dbus.cb.get_data_switch(m, &timings));
+	sailfish_manager_data_switch_done(NULL, &switched);
+	sailfish_manager_data_switch_done(s->handle, NULL);
+	g_assert(!fake_sailfish_manager_dbus.cb.get_data_switch(m, &timings));
+	fake_sailfish_manager_dbus.data_switch_index = -1;
+	sailfish_manager_data_switch_done(s->handle, &switched);
+	g_assert(fake_sailfish_manager_dbus.data_switch_index == 0);
+	g_assert(fake_sailfish_manager_dbus.cb.get_data_switch(m, &timings) ==
+								m->slots[0]);
+	g_assert(!memcmp(&timings, &switched, sizeof(timings)));
+
 	ofono_watch_unref(w);
 	g_main_loop_quit(test_loop);
 	return G_SOURCE_REMOVE;
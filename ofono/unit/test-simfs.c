@@ -0,0 +1,439 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "ofono.h"
+#include "simfs.h"
+
+#define TEST_IMSI		"244120000000049"
+#define TEST_TRANSPARENT_ID	0x6F46
+#define TEST_TRANSPARENT_LEN	1000
+#define TEST_FIXED_ID		0x6F3C
+#define TEST_RECORD_LEN		176
+#define TEST_RECORDS		10
+
+/* Fake ofono_sim */
+
+struct ofono_sim {
+	int info_reads;
+	int data_reads;
+};
+
+const char *ofono_sim_get_imsi(struct ofono_sim *sim)
+{
+	return TEST_IMSI;
+}
+
+enum ofono_sim_phase ofono_sim_get_phase(struct ofono_sim *sim)
+{
+	return OFONO_SIM_PHASE_3G;
+}
+
+struct ofono_sim_aid_session *__ofono_sim_get_session_by_aid(
+			struct ofono_sim *sim, unsigned char *aid)
+{
+	return NULL;
+}
+
+unsigned int __ofono_sim_add_session_watch(
+			struct ofono_sim_aid_session *session,
+			ofono_sim_session_event_cb_t notify, void *data,
+			ofono_destroy_func destroy)
+{
+	return 0;
+}
+
+void __ofono_sim_remove_session_watch(struct ofono_sim_aid_session *session,
+					unsigned int id)
+{
+}
+
+/* Fake driver, serves the two files straight away */
+
+static const struct ofono_error test_ok = {
+	.type = OFONO_ERROR_TYPE_NO_ERROR
+};
+
+/* Update, invalidate and rehabilitate are all NEVER, so simfs caches */
+static const unsigned char test_access[3] = { 0x0F, 0xFF, 0xFF };
+
+static unsigned char test_byte(int i)
+{
+	return (i * 7) ^ (i >> 8);
+}
+
+static void test_read_file_info(struct ofono_sim *sim, int fileid,
+				const unsigned char *path,
+				unsigned int path_len,
+				ofono_sim_file_info_cb_t cb, void *data)
+{
+	sim->info_reads++;
+
+	if (fileid == TEST_TRANSPARENT_ID)
+		cb(&test_ok, TEST_TRANSPARENT_LEN,
+			OFONO_SIM_FILE_STRUCTURE_TRANSPARENT, 0,
+			test_access, 0, data);
+	else
+		cb(&test_ok, TEST_RECORD_LEN * TEST_RECORDS,
+			OFONO_SIM_FILE_STRUCTURE_FIXED, TEST_RECORD_LEN,
+			test_access, 0, data);
+}
+
+static void test_read_file_transparent(struct ofono_sim *sim, int fileid,
+				int start, int length,
+				const unsigned char *path,
+				unsigned int path_len,
+				ofono_sim_read_cb_t cb, void *data)
+{
+	unsigned char buf[256];
+	int i;
+
+	g_assert(fileid == TEST_TRANSPARENT_ID);
+	g_assert(length <= (int) sizeof(buf));
+	g_assert(start + length <= TEST_TRANSPARENT_LEN);
+
+	sim->data_reads++;
+
+	for (i = 0; i < length; i++)
+		buf[i] = test_byte(start + i);
+
+	cb(&test_ok, buf, length, data);
+}
+
+static void test_read_file_linear(struct ofono_sim *sim, int fileid,
+				int record, int length,
+				const unsigned char *path,
+				unsigned int path_len,
+				ofono_sim_read_cb_t cb, void *data)
+{
+	unsigned char buf[TEST_RECORD_LEN];
+	int i;
+
+	g_assert(fileid == TEST_FIXED_ID);
+	g_assert(length == TEST_RECORD_LEN);
+
+	sim->data_reads++;
+
+	for (i = 0; i < length; i++)
+		buf[i] = test_byte((record - 1) * TEST_RECORD_LEN + i);
+
+	cb(&test_ok, buf, length, data);
+}
+
+static const struct ofono_sim_driver test_driver = {
+	.name			= "test",
+	.read_file_info		= test_read_file_info,
+	.read_file_transparent	= test_read_file_transparent,
+	.read_file_linear	= test_read_file_linear,
+};
+
+/* Collects what the read delivers */
+
+struct test_read {
+	GMainLoop *loop;
+	GByteArray *data;
+	int chunks;
+	int last_chunk;
+	int total;
+	int chunk_len[8];
+};
+
+static void test_read_init(struct test_read *read)
+{
+	memset(read, 0, sizeof(*read));
+	read->loop = g_main_loop_new(NULL, FALSE);
+	read->data = g_byte_array_new();
+}
+
+static void test_read_check(struct test_read *read, int len)
+{
+	int i;
+
+	g_assert(read->total == len);
+	g_assert(read->data->len == (guint) len);
+
+	for (i = 0; i < len; i++)
+		g_assert(read->data->data[i] == test_byte(i));
+
+	g_byte_array_free(read->data, TRUE);
+	g_main_loop_unref(read->loop);
+}
+
+static void test_read_cb(int ok, int total_length, int record,
+				const unsigned char *data,
+				int record_length, void *userdata)
+{
+	struct test_read *read = userdata;
+
+	g_assert(ok);
+
+	/* Chunks come in order, numbered from 1 */
+	g_assert(record == read->last_chunk + 1);
+	read->last_chunk = record;
+
+	if (read->chunks < (int) G_N_ELEMENTS(read->chunk_len))
+		read->chunk_len[read->chunks] = record_length;
+
+	read->chunks++;
+	read->total = total_length;
+	g_byte_array_append(read->data, data, record_length);
+
+	if ((int) read->data->len >= total_length)
+		g_main_loop_quit(read->loop);
+}
+
+static void test_read_whole_cb(int ok, int total_length, int record,
+				const unsigned char *data,
+				int record_length, void *userdata)
+{
+	struct test_read *read = userdata;
+
+	g_assert(ok);
+	g_assert(record == 0);
+
+	read->chunks++;
+	read->total = total_length;
+	g_byte_array_append(read->data, data, total_length);
+	g_main_loop_quit(read->loop);
+}
+
+static struct sim_fs *test_fs_new(struct ofono_sim *sim)
+{
+	struct sim_fs *fs;
+
+	memset(sim, 0, sizeof(*sim));
+	fs = sim_fs_new(sim, &test_driver);
+	g_assert(fs);
+
+	sim_fs_check_version(fs);
+	sim_fs_cache_flush(fs);
+
+	return fs;
+}
+
+static void test_stream_transparent(void)
+{
+	struct ofono_sim sim;
+	struct sim_fs *fs = test_fs_new(&sim);
+	struct ofono_sim_context *context = sim_fs_context_new(fs);
+	struct test_read read;
+	int pass;
+
+	/* From the SIM, and then once more from the cache */
+	for (pass = 0; pass < 2; pass++) {
+		test_read_init(&read);
+		g_assert(sim_fs_read_stream(context, TEST_TRANSPARENT_ID,
+				OFONO_SIM_FILE_STRUCTURE_TRANSPARENT,
+				NULL, 0, test_read_cb, &read) == 0);
+		g_main_loop_run(read.loop);
+
+		g_assert(read.chunks == 4);
+		g_assert(read.chunk_len[0] == 256);
+		g_assert(read.chunk_len[1] == 256);
+		g_assert(read.chunk_len[2] == 256);
+		g_assert(read.chunk_len[3] == TEST_TRANSPARENT_LEN - 768);
+		test_read_check(&read, TEST_TRANSPARENT_LEN);
+
+		g_assert(sim.info_reads == 1);
+		g_assert(sim.data_reads == 4);
+	}
+
+	/* The buffered read gets the same bytes out of the cache */
+	test_read_init(&read);
+	g_assert(sim_fs_read(context, TEST_TRANSPARENT_ID,
+				OFONO_SIM_FILE_STRUCTURE_TRANSPARENT, 0, 0,
+				NULL, 0, test_read_whole_cb, &read) == 0);
+	g_main_loop_run(read.loop);
+	g_assert(read.chunks == 1);
+	test_read_check(&read, TEST_TRANSPARENT_LEN);
+	g_assert(sim.data_reads == 4);
+
+	sim_fs_cache_flush(fs);
+	sim_fs_free(fs);
+}
+
+static void test_stream_fixed(void)
+{
+	struct ofono_sim sim;
+	struct sim_fs *fs = test_fs_new(&sim);
+	struct ofono_sim_context *context = sim_fs_context_new(fs);
+	struct test_read read;
+	int i;
+
+	test_read_init(&read);
+	g_assert(sim_fs_read_stream(context, TEST_FIXED_ID,
+				OFONO_SIM_FILE_STRUCTURE_FIXED,
+				NULL, 0, test_read_cb, &read) == 0);
+	g_main_loop_run(read.loop);
+
+	g_assert(read.chunks == TEST_RECORDS);
+
+	for (i = 0; i < (int) G_N_ELEMENTS(read.chunk_len); i++)
+		g_assert(read.chunk_len[i] == TEST_RECORD_LEN);
+
+	test_read_check(&read, TEST_RECORD_LEN * TEST_RECORDS);
+	g_assert(sim.data_reads == TEST_RECORDS);
+
+	sim_fs_cache_flush(fs);
+	sim_fs_free(fs);
+}
+
+/* Reads what sim_fs_read_fd writes to the socket */
+
+struct test_fd {
+	struct test_read read;
+	int fd;
+	int reclen;
+	gboolean close_early;
+};
+
+static gboolean test_fd_read(GIOChannel *io, GIOCondition cond,
+							gpointer user_data)
+{
+	struct test_fd *test = user_data;
+	unsigned char buf[128];
+	ssize_t len;
+
+	len = read(test->fd, buf, sizeof(buf));
+	g_assert(len >= 0);
+
+	if (len == 0) {
+		close(test->fd);
+		test->fd = -1;
+		g_main_loop_quit(test->read.loop);
+		return FALSE;
+	}
+
+	g_byte_array_append(test->read.data, buf, len);
+	return TRUE;
+}
+
+static void test_fd_cb(int ok, int fd, int total_length, int record_length,
+							void *userdata)
+{
+	struct test_fd *test = userdata;
+	GIOChannel *io;
+	unsigned char buf[256];
+
+	g_assert(ok);
+	g_assert(fd >= 0);
+
+	test->fd = fd;
+	test->read.total = total_length;
+	test->reclen = record_length;
+
+	if (test->close_early) {
+		/* The first block is in, the rest is still to come */
+		g_assert(read(fd, buf, sizeof(buf)) == sizeof(buf));
+		g_byte_array_append(test->read.data, buf, sizeof(buf));
+		close(fd);
+		test->fd = -1;
+		return;
+	}
+
+	io = g_io_channel_unix_new(fd);
+	g_io_add_watch(io, G_IO_IN | G_IO_HUP, test_fd_read, test);
+	g_io_channel_unref(io);
+}
+
+static void test_read_fd(void)
+{
+	struct ofono_sim sim;
+	struct sim_fs *fs = test_fs_new(&sim);
+	struct ofono_sim_context *context = sim_fs_context_new(fs);
+	struct test_fd test;
+
+	memset(&test, 0, sizeof(test));
+	test_read_init(&test.read);
+	test.fd = -1;
+
+	g_assert(sim_fs_read_fd(context, TEST_FIXED_ID,
+				OFONO_SIM_FILE_STRUCTURE_FIXED,
+				NULL, 0, test_fd_cb, &test) == 0);
+	g_main_loop_run(test.read.loop);
+
+	g_assert(test.reclen == TEST_RECORD_LEN);
+	test_read_check(&test.read, TEST_RECORD_LEN * TEST_RECORDS);
+	g_assert(sim.data_reads == TEST_RECORDS);
+
+	sim_fs_cache_flush(fs);
+	sim_fs_free(fs);
+}
+
+static void test_read_fd_closed(void)
+{
+	struct ofono_sim sim;
+	struct sim_fs *fs = test_fs_new(&sim);
+	struct ofono_sim_context *context = sim_fs_context_new(fs);
+	struct test_fd test;
+	struct test_read read;
+	int i;
+
+	memset(&test, 0, sizeof(test));
+	test_read_init(&test.read);
+	test.fd = -1;
+	test.close_early = TRUE;
+
+	g_assert(sim_fs_read_fd(context, TEST_TRANSPARENT_ID,
+				OFONO_SIM_FILE_STRUCTURE_TRANSPARENT,
+				NULL, 0, test_fd_cb, &test) == 0);
+
+	/*
+	 * Queued behind the stream, so it completes once the blocks after
+	 * the close have been sent to the closed socket without a SIGPIPE.
+	 */
+	test_read_init(&read);
+	g_assert(sim_fs_read(context, TEST_TRANSPARENT_ID,
+				OFONO_SIM_FILE_STRUCTURE_TRANSPARENT, 0, 0,
+				NULL, 0, test_read_whole_cb, &read) == 0);
+	g_main_loop_run(read.loop);
+
+	g_assert(test.reclen == 0);
+	g_assert(test.read.total == TEST_TRANSPARENT_LEN);
+	g_assert(test.read.data->len == 256);
+
+	for (i = 0; i < 256; i++)
+		g_assert(test.read.data->data[i] == test_byte(i));
+
+	g_byte_array_free(test.read.data, TRUE);
+	g_main_loop_unref(test.read.loop);
+	test_read_check(&read, TEST_TRANSPARENT_LEN);
+	g_assert(sim.data_reads == 4);
+
+	sim_fs_cache_flush(fs);
+	sim_fs_free(fs);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/testsimfs/Stream transparent",
+					test_stream_transparent);
+	g_test_add_func("/testsimfs/Stream fixed", test_stream_fixed);
+	g_test_add_func("/testsimfs/Read fd", test_read_fd);
+	g_test_add_func("/testsimfs/Read fd closed", test_read_fd_closed);
+
+	return g_test_run();
+}
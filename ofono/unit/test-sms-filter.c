@@ -1138,6 +1138,172 @@ static void test_early_free(void)
 	test_common_deinit();
 }
 
+/* ==== sync ==== */
+
+#define TEST_SYNC_COUNT (10000)
+
+static int test_sync_filter_count = 0;
+
+static enum ofono_sms_filter_result test_sync_recv_text(
+		struct ofono_modem *modem, const struct ofono_uuid *uuid,
+		const char *message, enum ofono_sms_class cls,
+		const struct ofono_sms_address *addr,
+		const struct ofono_sms_scts *scts)
+{
+	test_sync_filter_count++;
+	g_assert(!g_strcmp0(addr->address, "1234"));
+	g_assert(scts->year == 17);
+	return OFONO_SMS_FILTER_CONTINUE;
+}
+
+static enum ofono_sms_filter_result test_sync_recv_datagram(
+		struct ofono_modem *modem, const struct ofono_uuid *uuid,
+		int dst_port, int src_port, const unsigned char *buf,
+		unsigned int len, const struct ofono_sms_address *addr,
+		const struct ofono_sms_scts *scts)
+{
+	test_sync_filter_count++;
+	return OFONO_SMS_FILTER_DROP;
+}
+
+static void test_sync(void)
+{
+	static struct ofono_sms_filter sync1 = {
+		.name = "sync1",
+		.api_version = OFONO_SMS_FILTER_API_VERSION,
+		.priority = 2,
+		.filter_recv_text_sync = test_sync_recv_text,
+		.filter_recv_datagram_sync = test_sync_recv_datagram
+	};
+
+	static struct ofono_sms_filter sync2 = {
+		.name = "sync2",
+		.api_version = OFONO_SMS_FILTER_API_VERSION,
+		.priority = 1,
+		.filter_recv_text_sync = test_sync_recv_text,
+		/* Never gets there, sync1 drops datagrams */
+		.filter_recv_datagram = test_recv_datagram_filter
+	};
+
+	struct sms_filter_chain *chain;
+	struct ofono_modem modem;
+	struct ofono_sms sms;
+	struct ofono_uuid uuid;
+	struct sms_address addr;
+	struct sms_scts scts;
+	gint64 start;
+	int i;
+
+	test_common_init();
+	test_sync_filter_count = 0;
+	test_recv_datagram_filter_count = 0;
+	memset(&modem, 0, sizeof(modem));
+	memset(&sms, 0, sizeof(sms));
+	memset(&uuid, 0, sizeof(uuid));
+	memset(&addr, 0, sizeof(addr));
+	memset(&scts, 0, sizeof(scts));
+	strcpy(addr.address, "1234");
+	scts.year = 17;
+
+	g_assert(ofono_sms_filter_register(&sync1) == 0);
+	g_assert(ofono_sms_filter_register(&sync2) == 0);
+	chain = __ofono_sms_filter_chain_new(&sms, &modem);
+
+	/* Both filters and the handler run before we get back here */
+	__ofono_sms_filter_chain_recv_text(chain, &uuid, g_strdup("test"),
+			0, &addr, &scts, test_default_dispatch_recv_message);
+	g_assert(test_sync_filter_count == 2);
+	g_assert(sms.msg_count == 1);
+
+	__ofono_sms_filter_chain_recv_datagram(chain, &uuid, 0, 0, NULL, 0,
+				&addr, &scts, test_default_dispatch_datagram);
+	g_assert(test_sync_filter_count == 3);
+	g_assert(!test_recv_datagram_filter_count);
+	g_assert(!sms.dg_count);
+
+	/* No main loop iterations per message */
+	start = g_get_monotonic_time();
+	for (i = 0; i < TEST_SYNC_COUNT; i++) {
+		__ofono_sms_filter_chain_recv_text(chain, &uuid, NULL, 0,
+			&addr, &scts, test_default_dispatch_recv_message);
+	}
+	DBG("%d messages in %d us", TEST_SYNC_COUNT,
+				(int)(g_get_monotonic_time() - start));
+
+	g_assert(test_sync_filter_count == 3 + 2 * TEST_SYNC_COUNT);
+	g_assert(sms.msg_count == 1 + TEST_SYNC_COUNT);
+
+	__ofono_sms_filter_chain_free(chain);
+	ofono_sms_filter_unregister(&sync1);
+	ofono_sms_filter_unregister(&sync2);
+	test_common_deinit();
+}
+
+/* ==== sync_async ==== */
+
+static void test_sync_async(void)
+{
+	static struct ofono_sms_filter sync = {
+		.name = "sync",
+		.api_version = OFONO_SMS_FILTER_API_VERSION,
+		.priority = 2,
+		.filter_recv_text_sync = test_sync_recv_text
+	};
+
+	static struct ofono_sms_filter async = {
+		.name = "async",
+		.priority = 1,
+		.filter_recv_text = test_recv_message_filter
+	};
+
+	/* API version 0 doesn't have the sync callbacks */
+	static struct ofono_sms_filter old = {
+		.name = "old",
+		.filter_recv_text_sync = test_sync_recv_text
+	};
+
+	struct sms_filter_chain *chain;
+	struct ofono_modem modem;
+	struct ofono_sms sms;
+	struct ofono_uuid uuid;
+	struct sms_address addr;
+	struct sms_scts scts;
+
+	test_common_init();
+	test_sync_filter_count = 0;
+	test_recv_message_filter_count = 0;
+	memset(&modem, 0, sizeof(modem));
+	memset(&sms, 0, sizeof(sms));
+	memset(&uuid, 0, sizeof(uuid));
+	memset(&addr, 0, sizeof(addr));
+	memset(&scts, 0, sizeof(scts));
+	strcpy(addr.address, "1234");
+	scts.year = 17;
+
+	g_assert(ofono_sms_filter_register(&sync) == 0);
+	g_assert(ofono_sms_filter_register(&async) == 0);
+	g_assert(ofono_sms_filter_register(&old) == 0);
+	chain = __ofono_sms_filter_chain_new(&sms, &modem);
+
+	/* The async filter completes on a fresh stack */
+	__ofono_sms_filter_chain_recv_text(chain, &uuid, g_strdup("test"),
+			0, &addr, &scts, test_default_dispatch_recv_message);
+	g_assert(test_sync_filter_count == 1);
+	g_assert(test_recv_message_filter_count == 1);
+	g_assert(!sms.msg_count);
+
+	g_main_loop_run(test_loop);
+
+	g_assert(test_sync_filter_count == 1);
+	g_assert(sms.msg_count == 1);
+
+	__ofono_sms_filter_chain_free(chain);
+	ofono_sms_filter_unregister(&sync);
+	ofono_sms_filter_unregister(&async);
+	ofono_sms_filter_unregister(&old);
+	test_common_deinit();
+}
+
 #define TEST_(name) "/smsfilter/" name
 
 int main(int argc, char *argv[])
@@ -1169,6 +1335,8 @@ int main(int argc, char *argv[])
 	g_test_add_func(TEST_("recv_message3"), test_recv_message3);
 	g_test_add_func(TEST_("recv_message_drop"), test_recv_message_drop);
 	g_test_add_func(TEST_("early_free"), test_early_free);
+	g_test_add_func(TEST_("sync"), test_sync);
+	g_test_add_func(TEST_("sync_async"), test_sync_async);
 
 	return g_test_run();
 }
@@ -22274,6 +22274,909 @@ static void test_img_to_xpm(gconstpointer data)
 	g_free(xpm);
 }
 
+struct img_rgba_test {
+	const struct img_xpm_test *img;
+	unsigned int width;
+	unsigned int height;
+	unsigned int min_len;
+	const char *pixels;		/* indices into colors, row by row */
+	unsigned char colors[3][4];
+};
+
+static struct img_rgba_test rgba_test_1 = {
+	.img = &xpm_test_1,
+	.width = 5,
+	.height = 5,
+	.min_len = 6,
+	.pixels = "11111" "11011" "10101" "11011" "11111",
+	.colors = { { 0x00, 0x00, 0x00, 0xFF }, { 0xFF, 0xFF, 0xFF, 0xFF } },
+};
+
+static struct img_rgba_test rgba_test_2 = {
+	.img = &xpm_test_6,
+	.width = 8,
+	.height = 8,
+	.min_len = 22,
+	.pixels = "22222222" "20000002" "20111002" "20011002"
+		"20011002" "20011102" "20000002" "22222222",
+	.colors = { { 0xFF, 0x00, 0x00, 0xFF }, { 0x00, 0xFF, 0x00, 0xFF },
+			{ 0x00, 0x00, 0x00, 0x00 } },
+};
+
+static void test_img_to_rgba(gconstpointer data)
+{
+	const struct img_rgba_test *test = data;
+	const struct img_xpm_test *img = test->img;
+	unsigned int width, height, i;
+	unsigned char *rgba;
+
+	rgba = stk_image_to_rgba(img->img, img->len, img->scheme,
+					img->clut, img->clut_len,
+					&width, &height);
+	g_assert(rgba);
+	g_assert(width == test->width);
+	g_assert(height == test->height);
+
+	for (i = 0; i < width * height; i++)
+		g_assert(!memcmp(rgba + i * 4,
+				test->colors[test->pixels[i] - '0'], 4));
+
+	g_free(rgba);
+
+	/* The last pixel must be there */
+	g_assert(!stk_image_to_rgba(img->img, test->min_len - 1, img->scheme,
+					img->clut, img->clut_len,
+					&width, &height));
+	rgba = stk_image_to_rgba(img->img, test->min_len, img->scheme,
+					img->clut, img->clut_len,
+					&width, &height);
+	g_assert(rgba);
+	g_free(rgba);
+}
+
+struct pdu_test {
+	const unsigned char *pdu;
+	unsigned int pdu_len;
+};
+
+/* Proactive commands parsed by the benchmark and used as fuzzing seeds */
+static const struct pdu_test command_corpus[] = {
+	{ display_text_111, sizeof(display_text_111) },
+	{ display_text_131, sizeof(display_text_131) },
+	{ display_text_141, sizeof(display_text_141) },
+	{ display_text_151, sizeof(display_text_151) },
+	{ display_text_161, sizeof(display_text_161) },
+	{ display_text_171, sizeof(display_text_171) },
+	{ display_text_511, sizeof(display_text_511) },
+	{ display_text_521, sizeof(display_text_521) },
+	{ display_text_531, sizeof(display_text_531) },
+	{ display_text_611, sizeof(display_text_611) },
+	{ display_text_711, sizeof(display_text_711) },
+	{ display_text_811, sizeof(display_text_811) },
+	{ display_text_821, sizeof(display_text_821) },
+	{ display_text_831, sizeof(display_text_831) },
+	{ display_text_841, sizeof(display_text_841) },
+	{ display_text_851, sizeof(display_text_851) },
+	{ display_text_861, sizeof(display_text_861) },
+	{ display_text_871, sizeof(display_text_871) },
+	{ display_text_881, sizeof(display_text_881) },
+	{ display_text_891, sizeof(display_text_891) },
+	{ display_text_911, sizeof(display_text_911) },
+	{ display_text_1011, sizeof(display_text_1011) },
+	{ get_inkey_111, sizeof(get_inkey_111) },
+	{ get_inkey_121, sizeof(get_inkey_121) },
+	{ get_inkey_131, sizeof(get_inkey_131) },
+	{ get_inkey_141, sizeof(get_inkey_141) },
+	{ get_inkey_151, sizeof(get_inkey_151) },
+	{ get_inkey_161, sizeof(get_inkey_161) },
+	{ get_inkey_211, sizeof(get_inkey_211) },
+	{ get_inkey_311, sizeof(get_inkey_311) },
+	{ get_inkey_321, sizeof(get_inkey_321) },
+	{ get_inkey_411, sizeof(get_inkey_411) },
+	{ get_inkey_511, sizeof(get_inkey_511) },
+	{ get_inkey_512, sizeof(get_inkey_512) },
+	{ get_inkey_611, sizeof(get_inkey_611) },
+	{ get_inkey_621, sizeof(get_inkey_621) },
+	{ get_inkey_631, sizeof(get_inkey_631) },
+	{ get_inkey_641, sizeof(get_inkey_641) },
+	{ get_inkey_711, sizeof(get_inkey_711) },
+	{ get_inkey_712, sizeof(get_inkey_712) },
+	{ get_inkey_811, sizeof(get_inkey_811) },
+	{ get_inkey_911, sizeof(get_inkey_911) },
+	{ get_inkey_912, sizeof(get_inkey_912) },
+	{ get_inkey_921, sizeof(get_inkey_921) },
+	{ get_inkey_922, sizeof(get_inkey_922) },
+	{ get_inkey_931, sizeof(get_inkey_931) },
+	{ get_inkey_932, sizeof(get_inkey_932) },
+	{ get_inkey_941, sizeof(get_inkey_941) },
+	{ get_inkey_942, sizeof(get_inkey_942) },
+	{ get_inkey_943, sizeof(get_inkey_943) },
+	{ get_inkey_951, sizeof(get_inkey_951) },
+	{ get_inkey_952, sizeof(get_inkey_952) },
+	{ get_inkey_953, sizeof(get_inkey_953) },
+	{ get_inkey_961, sizeof(get_inkey_961) },
+	{ get_inkey_962, sizeof(get_inkey_962) },
+	{ get_inkey_963, sizeof(get_inkey_963) },
+	{ get_inkey_971, sizeof(get_inkey_971) },
+	{ get_inkey_972, sizeof(get_inkey_972) },
+	{ get_inkey_973, sizeof(get_inkey_973) },
+	{ get_inkey_981, sizeof(get_inkey_981) },
+	{ get_inkey_982, sizeof(get_inkey_982) },
+	{ get_inkey_983, sizeof(get_inkey_983) },
+	{ get_inkey_991, sizeof(get_inkey_991) },
+	{ get_inkey_992a, sizeof(get_inkey_992a) },
+	{ get_inkey_992b, sizeof(get_inkey_992b) },
+	{ get_inkey_993, sizeof(get_inkey_993) },
+	{ get_inkey_9101, sizeof(get_inkey_9101) },
+	{ get_inkey_9102, sizeof(get_inkey_9102) },
+	{ get_inkey_1011, sizeof(get_inkey_1011) },
+	{ get_inkey_1021, sizeof(get_inkey_1021) },
+	{ get_inkey_1111, sizeof(get_inkey_1111) },
+	{ get_inkey_1211, sizeof(get_inkey_1211) },
+	{ get_inkey_1221, sizeof(get_inkey_1221) },
+	{ get_inkey_1311, sizeof(get_inkey_1311) },
+	{ get_input_111, sizeof(get_input_111) },
+	{ get_input_121, sizeof(get_input_121) },
+	{ get_input_131, sizeof(get_input_131) },
+	{ get_input_141, sizeof(get_input_141) },
+	{ get_input_151, sizeof(get_input_151) },
+	{ get_input_161, sizeof(get_input_161) },
+	{ get_input_171, sizeof(get_input_171) },
+	{ get_input_181, sizeof(get_input_181) },
+	{ get_input_191, sizeof(get_input_191) },
+	{ get_input_1101, sizeof(get_input_1101) },
+	{ get_input_211, sizeof(get_input_211) },
+	{ get_input_311, sizeof(get_input_311) },
+	{ get_input_321, sizeof(get_input_321) },
+	{ get_input_411, sizeof(get_input_411) },
+	{ get_input_421, sizeof(get_input_421) },
+	{ get_input_511, sizeof(get_input_511) },
+	{ get_input_521, sizeof(get_input_521) },
+	{ get_input_611, sizeof(get_input_611) },
+	{ get_input_621, sizeof(get_input_621) },
+	{ get_input_631, sizeof(get_input_631) },
+	{ get_input_641, sizeof(get_input_641) },
+	{ get_input_711, sizeof(get_input_711) },
+	{ get_input_811, sizeof(get_input_811) },
+	{ get_input_812, sizeof(get_input_812) },
+	{ get_input_821, sizeof(get_input_821) },
+	{ get_input_822, sizeof(get_input_822) },
+	{ get_input_831, sizeof(get_input_831) },
+	{ get_input_832, sizeof(get_input_832) },
+	{ get_input_841, sizeof(get_input_841) },
+	{ get_input_842, sizeof(get_input_842) },
+	{ get_input_843, sizeof(get_input_843) },
+	{ get_input_851, sizeof(get_input_851) },
+	{ get_input_852, sizeof(get_input_852) },
+	{ get_input_853, sizeof(get_input_853) },
+	{ get_input_861, sizeof(get_input_861) },
+	{ get_input_862, sizeof(get_input_862) },
+	{ get_input_863, sizeof(get_input_863) },
+	{ get_input_871, sizeof(get_input_871) },
+	{ get_input_872, sizeof(get_input_872) },
+	{ get_input_873, sizeof(get_input_873) },
+	{ get_input_881, sizeof(get_input_881) },
+	{ get_input_882, sizeof(get_input_882) },
+	{ get_input_883, sizeof(get_input_883) },
+	{ get_input_891, sizeof(get_input_891) },
+	{ get_input_892, sizeof(get_input_892) },
+	{ get_input_893, sizeof(get_input_893) },
+	{ get_input_8101, sizeof(get_input_8101) },
+	{ get_input_8102, sizeof(get_input_8102) },
+	{ get_input_911, sizeof(get_input_911) },
+	{ get_input_921, sizeof(get_input_921) },
+	{ get_input_1011, sizeof(get_input_1011) },
+	{ get_input_1021, sizeof(get_input_1021) },
+	{ get_input_1111, sizeof(get_input_1111) },
+	{ get_input_1121, sizeof(get_input_1121) },
+	{ get_input_1211, sizeof(get_input_1211) },
+	{ get_input_1221, sizeof(get_input_1221) },
+	{ more_time_111, sizeof(more_time_111) },
+	{ play_tone_111, sizeof(play_tone_111) },
+	{ play_tone_112, sizeof(play_tone_112) },
+	{ play_tone_113, sizeof(play_tone_113) },
+	{ play_tone_114, sizeof(play_tone_114) },
+	{ play_tone_115, sizeof(play_tone_115) },
+	{ play_tone_116, sizeof(play_tone_116) },
+	{ play_tone_117, sizeof(play_tone_117) },
+	{ play_tone_118, sizeof(play_tone_118) },
+	{ play_tone_119, sizeof(play_tone_119) },
+	{ play_tone_1110, sizeof(play_tone_1110) },
+	{ play_tone_1111, sizeof(play_tone_1111) },
+	{ play_tone_1112, sizeof(play_tone_1112) },
+	{ play_tone_1113, sizeof(play_tone_1113) },
+	{ play_tone_1114, sizeof(play_tone_1114) },
+	{ play_tone_1115, sizeof(play_tone_1115) },
+	{ play_tone_211, sizeof(play_tone_211) },
+	{ play_tone_212, sizeof(play_tone_212) },
+	{ play_tone_213, sizeof(play_tone_213) },
+	{ play_tone_311, sizeof(play_tone_311) },
+	{ play_tone_321, sizeof(play_tone_321) },
+	{ play_tone_331, sizeof(play_tone_331) },
+	{ play_tone_341, sizeof(play_tone_341) },
+	{ play_tone_411, sizeof(play_tone_411) },
+	{ play_tone_412, sizeof(play_tone_412) },
+	{ play_tone_421, sizeof(play_tone_421) },
+	{ play_tone_422, sizeof(play_tone_422) },
+	{ play_tone_431, sizeof(play_tone_431) },
+	{ play_tone_432, sizeof(play_tone_432) },
+	{ play_tone_441, sizeof(play_tone_441) },
+	{ play_tone_442, sizeof(play_tone_442) },
+	{ play_tone_443, sizeof(play_tone_443) },
+	{ play_tone_451, sizeof(play_tone_451) },
+	{ play_tone_452, sizeof(play_tone_452) },
+	{ play_tone_453, sizeof(play_tone_453) },
+	{ play_tone_461, sizeof(play_tone_461) },
+	{ play_tone_462, sizeof(play_tone_462) },
+	{ play_tone_463, sizeof(play_tone_463) },
+	{ play_tone_471, sizeof(play_tone_471) },
+	{ play_tone_472, sizeof(play_tone_472) },
+	{ play_tone_473, sizeof(play_tone_473) },
+	{ play_tone_481, sizeof(play_tone_481) },
+	{ play_tone_482, sizeof(play_tone_482) },
+	{ play_tone_483, sizeof(play_tone_483) },
+	{ play_tone_491, sizeof(play_tone_491) },
+	{ play_tone_492, sizeof(play_tone_492) },
+	{ play_tone_493, sizeof(play_tone_493) },
+	{ play_tone_4101, sizeof(play_tone_4101) },
+	{ play_tone_4102, sizeof(play_tone_4102) },
+	{ play_tone_511, sizeof(play_tone_511) },
+	{ play_tone_512, sizeof(play_tone_512) },
+	{ play_tone_513, sizeof(play_tone_513) },
+	{ play_tone_611, sizeof(play_tone_611) },
+	{ play_tone_612, sizeof(play_tone_612) },
+	{ play_tone_613, sizeof(play_tone_613) },
+	{ poll_interval_111, sizeof(poll_interval_111) },
+	{ setup_menu_111, sizeof(setup_menu_111) },
+	{ setup_menu_112, sizeof(setup_menu_112) },
+	{ setup_menu_113, sizeof(setup_menu_113) },
+	{ setup_menu_121, sizeof(setup_menu_121) },
+	{ setup_menu_122, sizeof(setup_menu_122) },
+	{ setup_menu_123, sizeof(setup_menu_123) },
+	{ setup_menu_211, sizeof(setup_menu_211) },
+	{ setup_menu_311, sizeof(setup_menu_311) },
+	{ setup_menu_411, sizeof(setup_menu_411) },
+	{ setup_menu_421, sizeof(setup_menu_421) },
+	{ setup_menu_511, sizeof(setup_menu_511) },
+	{ setup_menu_611, sizeof(setup_menu_611) },
+	{ setup_menu_612, sizeof(setup_menu_612) },
+	{ setup_menu_621, sizeof(setup_menu_621) },
+	{ setup_menu_622, sizeof(setup_menu_622) },
+	{ setup_menu_631, sizeof(setup_menu_631) },
+	{ setup_menu_632, sizeof(setup_menu_632) },
+	{ setup_menu_641, sizeof(setup_menu_641) },
+	{ setup_menu_642, sizeof(setup_menu_642) },
+	{ setup_menu_643, sizeof(setup_menu_643) },
+	{ setup_menu_651, sizeof(setup_menu_651) },
+	{ setup_menu_661, sizeof(setup_menu_661) },
+	{ setup_menu_671, sizeof(setup_menu_671) },
+	{ setup_menu_681, sizeof(setup_menu_681) },
+	{ setup_menu_691, sizeof(setup_menu_691) },
+	{ setup_menu_6101, sizeof(setup_menu_6101) },
+	{ setup_menu_711, sizeof(setup_menu_711) },
+	{ setup_menu_712, sizeof(setup_menu_712) },
+	{ setup_menu_713, sizeof(setup_menu_713) },
+	{ setup_menu_811, sizeof(setup_menu_811) },
+	{ setup_menu_812, sizeof(setup_menu_812) },
+	{ setup_menu_813, sizeof(setup_menu_813) },
+	{ setup_menu_911, sizeof(setup_menu_911) },
+	{ setup_menu_912, sizeof(setup_menu_912) },
+	{ setup_menu_913, sizeof(setup_menu_913) },
+	{ setup_menu_neg_1, sizeof(setup_menu_neg_1) },
+	{ setup_menu_neg_2, sizeof(setup_menu_neg_2) },
+	{ setup_menu_neg_3, sizeof(setup_menu_neg_3) },
+	{ setup_menu_neg_4, sizeof(setup_menu_neg_4) },
+	{ select_item_111, sizeof(select_item_111) },
+	{ select_item_121, sizeof(select_item_121) },
+	{ select_item_131, sizeof(select_item_131) },
+	{ select_item_141, sizeof(select_item_141) },
+	{ select_item_151, sizeof(select_item_151) },
+	{ select_item_161, sizeof(select_item_161) },
+	{ select_item_211, sizeof(select_item_211) },
+	{ select_item_311, sizeof(select_item_311) },
+	{ select_item_411, sizeof(select_item_411) },
+	{ select_item_511, sizeof(select_item_511) },
+	{ select_item_521, sizeof(select_item_521) },
+	{ select_item_611, sizeof(select_item_611) },
+	{ select_item_621, sizeof(select_item_621) },
+	{ select_item_711, sizeof(select_item_711) },
+	{ select_item_811, sizeof(select_item_811) },
+	{ select_item_911, sizeof(select_item_911) },
+	{ select_item_912, sizeof(select_item_912) },
+	{ select_item_921, sizeof(select_item_921) },
+	{ select_item_922, sizeof(select_item_922) },
+	{ select_item_931, sizeof(select_item_931) },
+	{ select_item_932, sizeof(select_item_932) },
+	{ select_item_941, sizeof(select_item_941) },
+	{ select_item_942, sizeof(select_item_942) },
+	{ select_item_943, sizeof(select_item_943) },
+	{ select_item_951, sizeof(select_item_951) },
+	{ select_item_952, sizeof(select_item_952) },
+	{ select_item_953, sizeof(select_item_953) },
+	{ select_item_961, sizeof(select_item_961) },
+	{ select_item_962, sizeof(select_item_962) },
+	{ select_item_963, sizeof(select_item_963) },
+	{ select_item_971, sizeof(select_item_971) },
+	{ select_item_972, sizeof(select_item_972) },
+	{ select_item_973, sizeof(select_item_973) },
+	{ select_item_981, sizeof(select_item_981) },
+	{ select_item_982, sizeof(select_item_982) },
+	{ select_item_983, sizeof(select_item_983) },
+	{ select_item_991, sizeof(select_item_991) },
+	{ select_item_992, sizeof(select_item_992) },
+	{ select_item_993, sizeof(select_item_993) },
+	{ select_item_9101, sizeof(select_item_9101) },
+	{ select_item_9102, sizeof(select_item_9102) },
+	{ select_item_1011, sizeof(select_item_1011) },
+	{ select_item_1021, sizeof(select_item_1021) },
+	{ select_item_1031, sizeof(select_item_1031) },
+	{ select_item_1111, sizeof(select_item_1111) },
+	{ select_item_1211, sizeof(select_item_1211) },
+	{ select_item_1221, sizeof(select_item_1221) },
+	{ select_item_1231, sizeof(select_item_1231) },
+	{ send_sms_111, sizeof(send_sms_111) },
+	{ send_sms_121, sizeof(send_sms_121) },
+	{ send_sms_131, sizeof(send_sms_131) },
+	{ send_sms_141, sizeof(send_sms_141) },
+	{ send_sms_151, sizeof(send_sms_151) },
+	{ send_sms_161, sizeof(send_sms_161) },
+	{ send_sms_171, sizeof(send_sms_171) },
+	{ send_sms_181, sizeof(send_sms_181) },
+	{ send_sms_211, sizeof(send_sms_211) },
+	{ send_sms_212, sizeof(send_sms_212) },
+	{ send_sms_213, sizeof(send_sms_213) },
+	{ send_sms_311, sizeof(send_sms_311) },
+	{ send_sms_321, sizeof(send_sms_321) },
+	{ send_sms_411, sizeof(send_sms_411) },
+	{ send_sms_412, sizeof(send_sms_412) },
+	{ send_sms_421, sizeof(send_sms_421) },
+	{ send_sms_422, sizeof(send_sms_422) },
+	{ send_sms_431, sizeof(send_sms_431) },
+	{ send_sms_432, sizeof(send_sms_432) },
+	{ send_sms_441, sizeof(send_sms_441) },
+	{ send_sms_442, sizeof(send_sms_442) },
+	{ send_sms_443, sizeof(send_sms_443) },
+	{ send_sms_451, sizeof(send_sms_451) },
+	{ send_sms_452, sizeof(send_sms_452) },
+	{ send_sms_453, sizeof(send_sms_453) },
+	{ send_sms_461, sizeof(send_sms_461) },
+	{ send_sms_462, sizeof(send_sms_462) },
+	{ send_sms_463, sizeof(send_sms_463) },
+	{ send_sms_471, sizeof(send_sms_471) },
+	{ send_sms_472, sizeof(send_sms_472) },
+	{ send_sms_473, sizeof(send_sms_473) },
+	{ send_sms_481, sizeof(send_sms_481) },
+	{ send_sms_482, sizeof(send_sms_482) },
+	{ send_sms_483, sizeof(send_sms_483) },
+	{ send_sms_491, sizeof(send_sms_491) },
+	{ send_sms_492, sizeof(send_sms_492) },
+	{ send_sms_493, sizeof(send_sms_493) },
+	{ send_sms_4101, sizeof(send_sms_4101) },
+	{ send_sms_4102, sizeof(send_sms_4102) },
+	{ send_sms_511, sizeof(send_sms_511) },
+	{ send_sms_512, sizeof(send_sms_512) },
+	{ send_sms_513, sizeof(send_sms_513) },
+	{ send_sms_611, sizeof(send_sms_611) },
+	{ send_sms_612, sizeof(send_sms_612) },
+	{ send_sms_613, sizeof(send_sms_613) },
+	{ send_ss_111, sizeof(send_ss_111) },
+	{ send_ss_141, sizeof(send_ss_141) },
+	{ send_ss_151, sizeof(send_ss_151) },
+	{ send_ss_161, sizeof(send_ss_161) },
+	{ send_ss_211, sizeof(send_ss_211) },
+	{ send_ss_221, sizeof(send_ss_221) },
+	{ send_ss_231, sizeof(send_ss_231) },
+	{ send_ss_241, sizeof(send_ss_241) },
+	{ send_ss_311, sizeof(send_ss_311) },
+	{ send_ss_411, sizeof(send_ss_411) },
+	{ send_ss_412, sizeof(send_ss_412) },
+	{ send_ss_421, sizeof(send_ss_421) },
+	{ send_ss_422, sizeof(send_ss_422) },
+	{ send_ss_431, sizeof(send_ss_431) },
+	{ send_ss_432, sizeof(send_ss_432) },
+	{ send_ss_441, sizeof(send_ss_441) },
+	{ send_ss_442, sizeof(send_ss_442) },
+	{ send_ss_443, sizeof(send_ss_443) },
+	{ send_ss_451, sizeof(send_ss_451) },
+	{ send_ss_452, sizeof(send_ss_452) },
+	{ send_ss_453, sizeof(send_ss_453) },
+	{ send_ss_461, sizeof(send_ss_461) },
+	{ send_ss_462, sizeof(send_ss_462) },
+	{ send_ss_463, sizeof(send_ss_463) },
+	{ send_ss_471, sizeof(send_ss_471) },
+	{ send_ss_472, sizeof(send_ss_472) },
+	{ send_ss_473, sizeof(send_ss_473) },
+	{ send_ss_481, sizeof(send_ss_481) },
+	{ send_ss_482, sizeof(send_ss_482) },
+	{ send_ss_483, sizeof(send_ss_483) },
+	{ send_ss_491, sizeof(send_ss_491) },
+	{ send_ss_492, sizeof(send_ss_492) },
+	{ send_ss_493, sizeof(send_ss_493) },
+	{ send_ss_4101, sizeof(send_ss_4101) },
+	{ send_ss_4102, sizeof(send_ss_4102) },
+	{ send_ss_511, sizeof(send_ss_511) },
+	{ send_ss_611, sizeof(send_ss_611) },
+	{ send_ussd_111, sizeof(send_ussd_111) },
+	{ send_ussd_121, sizeof(send_ussd_121) },
+	{ send_ussd_131, sizeof(send_ussd_131) },
+	{ send_ussd_161, sizeof(send_ussd_161) },
+	{ send_ussd_171, sizeof(send_ussd_171) },
+	{ send_ussd_181, sizeof(send_ussd_181) },
+	{ send_ussd_211, sizeof(send_ussd_211) },
+	{ send_ussd_221, sizeof(send_ussd_221) },
+	{ send_ussd_231, sizeof(send_ussd_231) },
+	{ send_ussd_241, sizeof(send_ussd_241) },
+	{ send_ussd_311, sizeof(send_ussd_311) },
+	{ send_ussd_411, sizeof(send_ussd_411) },
+	{ send_ussd_412, sizeof(send_ussd_412) },
+	{ send_ussd_421, sizeof(send_ussd_421) },
+	{ send_ussd_422, sizeof(send_ussd_422) },
+	{ send_ussd_431, sizeof(send_ussd_431) },
+	{ send_ussd_432, sizeof(send_ussd_432) },
+	{ send_ussd_441, sizeof(send_ussd_441) },
+	{ send_ussd_442, sizeof(send_ussd_442) },
+	{ send_ussd_443, sizeof(send_ussd_443) },
+	{ send_ussd_451, sizeof(send_ussd_451) },
+	{ send_ussd_452, sizeof(send_ussd_452) },
+	{ send_ussd_453, sizeof(send_ussd_453) },
+	{ send_ussd_461, sizeof(send_ussd_461) },
+	{ send_ussd_462, sizeof(send_ussd_462) },
+	{ send_ussd_463, sizeof(send_ussd_463) },
+	{ send_ussd_471, sizeof(send_ussd_471) },
+	{ send_ussd_472, sizeof(send_ussd_472) },
+	{ send_ussd_473, sizeof(send_ussd_473) },
+	{ send_ussd_481, sizeof(send_ussd_481) },
+	{ send_ussd_482, sizeof(send_ussd_482) },
+	{ send_ussd_483, sizeof(send_ussd_483) },
+	{ send_ussd_491, sizeof(send_ussd_491) },
+	{ send_ussd_492, sizeof(send_ussd_492) },
+	{ send_ussd_493, sizeof(send_ussd_493) },
+	{ send_ussd_4101, sizeof(send_ussd_4101) },
+	{ send_ussd_4102, sizeof(send_ussd_4102) },
+	{ send_ussd_511, sizeof(send_ussd_511) },
+	{ send_ussd_611, sizeof(send_ussd_611) },
+	{ setup_call_111, sizeof(setup_call_111) },
+	{ setup_call_141, sizeof(setup_call_141) },
+	{ setup_call_151, sizeof(setup_call_151) },
+	{ setup_call_181, sizeof(setup_call_181) },
+	{ setup_call_191, sizeof(setup_call_191) },
+	{ setup_call_1101, sizeof(setup_call_1101) },
+	{ setup_call_1111, sizeof(setup_call_1111) },
+	{ setup_call_1121, sizeof(setup_call_1121) },
+	{ setup_call_211, sizeof(setup_call_211) },
+	{ setup_call_311, sizeof(setup_call_311) },
+	{ setup_call_321, sizeof(setup_call_321) },
+	{ setup_call_331, sizeof(setup_call_331) },
+	{ setup_call_341, sizeof(setup_call_341) },
+	{ setup_call_411, sizeof(setup_call_411) },
+	{ setup_call_412, sizeof(setup_call_412) },
+	{ setup_call_421, sizeof(setup_call_421) },
+	{ setup_call_422, sizeof(setup_call_422) },
+	{ setup_call_431, sizeof(setup_call_431) },
+	{ setup_call_432, sizeof(setup_call_432) },
+	{ setup_call_441, sizeof(setup_call_441) },
+	{ setup_call_442, sizeof(setup_call_442) },
+	{ setup_call_443, sizeof(setup_call_443) },
+	{ setup_call_451, sizeof(setup_call_451) },
+	{ setup_call_452, sizeof(setup_call_452) },
+	{ setup_call_453, sizeof(setup_call_453) },
+	{ setup_call_461, sizeof(setup_call_461) },
+	{ setup_call_462, sizeof(setup_call_462) },
+	{ setup_call_463, sizeof(setup_call_463) },
+	{ setup_call_471, sizeof(setup_call_471) },
+	{ setup_call_472, sizeof(setup_call_472) },
+	{ setup_call_473, sizeof(setup_call_473) },
+	{ setup_call_481, sizeof(setup_call_481) },
+	{ setup_call_482, sizeof(setup_call_482) },
+	{ setup_call_483, sizeof(setup_call_483) },
+	{ setup_call_491, sizeof(setup_call_491) },
+	{ setup_call_492, sizeof(setup_call_492) },
+	{ setup_call_493, sizeof(setup_call_493) },
+	{ setup_call_4101, sizeof(setup_call_4101) },
+	{ setup_call_4102, sizeof(setup_call_4102) },
+	{ setup_call_511, sizeof(setup_call_511) },
+	{ setup_call_521, sizeof(setup_call_521) },
+	{ setup_call_611, sizeof(setup_call_611) },
+	{ setup_call_621, sizeof(setup_call_621) },
+	{ setup_call_711, sizeof(setup_call_711) },
+	{ setup_call_721, sizeof(setup_call_721) },
+	{ refresh_121, sizeof(refresh_121) },
+	{ refresh_151, sizeof(refresh_151) },
+	{ polling_off_112, sizeof(polling_off_112) },
+	{ provide_local_info_121, sizeof(provide_local_info_121) },
+	{ provide_local_info_141, sizeof(provide_local_info_141) },
+	{ provide_local_info_151, sizeof(provide_local_info_151) },
+	{ provide_local_info_181, sizeof(provide_local_info_181) },
+	{ provide_local_info_191, sizeof(provide_local_info_191) },
+	{ provide_local_info_1111, sizeof(provide_local_info_1111) },
+	{ setup_event_list_111, sizeof(setup_event_list_111) },
+	{ setup_event_list_121, sizeof(setup_event_list_121) },
+	{ setup_event_list_122, sizeof(setup_event_list_122) },
+	{ setup_event_list_131, sizeof(setup_event_list_131) },
+	{ setup_event_list_132, sizeof(setup_event_list_132) },
+	{ setup_event_list_141, sizeof(setup_event_list_141) },
+	{ perform_card_apdu_111, sizeof(perform_card_apdu_111) },
+	{ perform_card_apdu_112, sizeof(perform_card_apdu_112) },
+	{ perform_card_apdu_121, sizeof(perform_card_apdu_121) },
+	{ perform_card_apdu_122, sizeof(perform_card_apdu_122) },
+	{ perform_card_apdu_123, sizeof(perform_card_apdu_123) },
+	{ perform_card_apdu_124, sizeof(perform_card_apdu_124) },
+	{ perform_card_apdu_125, sizeof(perform_card_apdu_125) },
+	{ perform_card_apdu_151, sizeof(perform_card_apdu_151) },
+	{ perform_card_apdu_211, sizeof(perform_card_apdu_211) },
+	{ get_reader_status_111, sizeof(get_reader_status_111) },
+	{ timer_mgmt_111, sizeof(timer_mgmt_111) },
+	{ timer_mgmt_112, sizeof(timer_mgmt_112) },
+	{ timer_mgmt_113, sizeof(timer_mgmt_113) },
+	{ timer_mgmt_114, sizeof(timer_mgmt_114) },
+	{ timer_mgmt_121, sizeof(timer_mgmt_121) },
+	{ timer_mgmt_122, sizeof(timer_mgmt_122) },
+	{ timer_mgmt_123, sizeof(timer_mgmt_123) },
+	{ timer_mgmt_124, sizeof(timer_mgmt_124) },
+	{ timer_mgmt_131, sizeof(timer_mgmt_131) },
+	{ timer_mgmt_132, sizeof(timer_mgmt_132) },
+	{ timer_mgmt_133, sizeof(timer_mgmt_133) },
+	{ timer_mgmt_134, sizeof(timer_mgmt_134) },
+	{ timer_mgmt_141, sizeof(timer_mgmt_141) },
+	{ timer_mgmt_142, sizeof(timer_mgmt_142) },
+	{ timer_mgmt_143, sizeof(timer_mgmt_143) },
+	{ timer_mgmt_144, sizeof(timer_mgmt_144) },
+	{ timer_mgmt_145, sizeof(timer_mgmt_145) },
+	{ timer_mgmt_146, sizeof(timer_mgmt_146) },
+	{ timer_mgmt_147, sizeof(timer_mgmt_147) },
+	{ timer_mgmt_148, sizeof(timer_mgmt_148) },
+	{ timer_mgmt_151, sizeof(timer_mgmt_151) },
+	{ timer_mgmt_152, sizeof(timer_mgmt_152) },
+	{ timer_mgmt_153, sizeof(timer_mgmt_153) },
+	{ timer_mgmt_154, sizeof(timer_mgmt_154) },
+	{ timer_mgmt_155, sizeof(timer_mgmt_155) },
+	{ timer_mgmt_156, sizeof(timer_mgmt_156) },
+	{ timer_mgmt_157, sizeof(timer_mgmt_157) },
+	{ timer_mgmt_158, sizeof(timer_mgmt_158) },
+	{ timer_mgmt_161, sizeof(timer_mgmt_161) },
+	{ timer_mgmt_162, sizeof(timer_mgmt_162) },
+	{ timer_mgmt_163, sizeof(timer_mgmt_163) },
+	{ timer_mgmt_164, sizeof(timer_mgmt_164) },
+	{ timer_mgmt_165, sizeof(timer_mgmt_165) },
+	{ timer_mgmt_166, sizeof(timer_mgmt_166) },
+	{ timer_mgmt_167, sizeof(timer_mgmt_167) },
+	{ timer_mgmt_168, sizeof(timer_mgmt_168) },
+	{ timer_mgmt_211, sizeof(timer_mgmt_211) },
+	{ timer_mgmt_221, sizeof(timer_mgmt_221) },
+	{ setup_idle_mode_text_111, sizeof(setup_idle_mode_text_111) },
+	{ setup_idle_mode_text_121, sizeof(setup_idle_mode_text_121) },
+	{ setup_idle_mode_text_131, sizeof(setup_idle_mode_text_131) },
+	{ setup_idle_mode_text_171, sizeof(setup_idle_mode_text_171) },
+	{ setup_idle_mode_text_211, sizeof(setup_idle_mode_text_211) },
+	{ setup_idle_mode_text_221, sizeof(setup_idle_mode_text_221) },
+	{ setup_idle_mode_text_231, sizeof(setup_idle_mode_text_231) },
+	{ setup_idle_mode_text_241, sizeof(setup_idle_mode_text_241) },
+	{ setup_idle_mode_text_311, sizeof(setup_idle_mode_text_311) },
+	{ setup_idle_mode_text_411, sizeof(setup_idle_mode_text_411) },
+	{ setup_idle_mode_text_412, sizeof(setup_idle_mode_text_412) },
+	{ setup_idle_mode_text_421, sizeof(setup_idle_mode_text_421) },
+	{ setup_idle_mode_text_422, sizeof(setup_idle_mode_text_422) },
+	{ setup_idle_mode_text_431, sizeof(setup_idle_mode_text_431) },
+	{ setup_idle_mode_text_432, sizeof(setup_idle_mode_text_432) },
+	{ setup_idle_mode_text_441, sizeof(setup_idle_mode_text_441) },
+	{ setup_idle_mode_text_442, sizeof(setup_idle_mode_text_442) },
+	{ setup_idle_mode_text_443, sizeof(setup_idle_mode_text_443) },
+	{ setup_idle_mode_text_451, sizeof(setup_idle_mode_text_451) },
+	{ setup_idle_mode_text_452, sizeof(setup_idle_mode_text_452) },
+	{ setup_idle_mode_text_453, sizeof(setup_idle_mode_text_453) },
+	{ setup_idle_mode_text_461, sizeof(setup_idle_mode_text_461) },
+	{ setup_idle_mode_text_462, sizeof(setup_idle_mode_text_462) },
+	{ setup_idle_mode_text_463, sizeof(setup_idle_mode_text_463) },
+	{ setup_idle_mode_text_471, sizeof(setup_idle_mode_text_471) },
+	{ setup_idle_mode_text_472, sizeof(setup_idle_mode_text_472) },
+	{ setup_idle_mode_text_473, sizeof(setup_idle_mode_text_473) },
+	{ setup_idle_mode_text_481, sizeof(setup_idle_mode_text_481) },
+	{ setup_idle_mode_text_482, sizeof(setup_idle_mode_text_482) },
+	{ setup_idle_mode_text_483, sizeof(setup_idle_mode_text_483) },
+	{ setup_idle_mode_text_491, sizeof(setup_idle_mode_text_491) },
+	{ setup_idle_mode_text_492, sizeof(setup_idle_mode_text_492) },
+	{ setup_idle_mode_text_493, sizeof(setup_idle_mode_text_493) },
+	{ setup_idle_mode_text_4101, sizeof(setup_idle_mode_text_4101) },
+	{ setup_idle_mode_text_4102, sizeof(setup_idle_mode_text_4102) },
+	{ setup_idle_mode_text_511, sizeof(setup_idle_mode_text_511) },
+	{ setup_idle_mode_text_611, sizeof(setup_idle_mode_text_611) },
+	{ run_at_command_111, sizeof(run_at_command_111) },
+	{ run_at_command_121, sizeof(run_at_command_121) },
+	{ run_at_command_131, sizeof(run_at_command_131) },
+	{ run_at_command_211, sizeof(run_at_command_211) },
+	{ run_at_command_221, sizeof(run_at_command_221) },
+	{ run_at_command_231, sizeof(run_at_command_231) },
+	{ run_at_command_241, sizeof(run_at_command_241) },
+	{ run_at_command_251, sizeof(run_at_command_251) },
+	{ run_at_command_311, sizeof(run_at_command_311) },
+	{ run_at_command_312, sizeof(run_at_command_312) },
+	{ run_at_command_321, sizeof(run_at_command_321) },
+	{ run_at_command_322, sizeof(run_at_command_322) },
+	{ run_at_command_331, sizeof(run_at_command_331) },
+	{ run_at_command_332, sizeof(run_at_command_332) },
+	{ run_at_command_341, sizeof(run_at_command_341) },
+	{ run_at_command_342, sizeof(run_at_command_342) },
+	{ run_at_command_343, sizeof(run_at_command_343) },
+	{ run_at_command_351, sizeof(run_at_command_351) },
+	{ run_at_command_352, sizeof(run_at_command_352) },
+	{ run_at_command_353, sizeof(run_at_command_353) },
+	{ run_at_command_361, sizeof(run_at_command_361) },
+	{ run_at_command_362, sizeof(run_at_command_362) },
+	{ run_at_command_363, sizeof(run_at_command_363) },
+	{ run_at_command_371, sizeof(run_at_command_371) },
+	{ run_at_command_372, sizeof(run_at_command_372) },
+	{ run_at_command_373, sizeof(run_at_command_373) },
+	{ run_at_command_381, sizeof(run_at_command_381) },
+	{ run_at_command_382, sizeof(run_at_command_382) },
+	{ run_at_command_383, sizeof(run_at_command_383) },
+	{ run_at_command_391, sizeof(run_at_command_391) },
+	{ run_at_command_392, sizeof(run_at_command_392) },
+	{ run_at_command_393, sizeof(run_at_command_393) },
+	{ run_at_command_3101, sizeof(run_at_command_3101) },
+	{ run_at_command_3102, sizeof(run_at_command_3102) },
+	{ run_at_command_411, sizeof(run_at_command_411) },
+	{ run_at_command_511, sizeof(run_at_command_511) },
+	{ run_at_command_611, sizeof(run_at_command_611) },
+	{ send_dtmf_111, sizeof(send_dtmf_111) },
+	{ send_dtmf_121, sizeof(send_dtmf_121) },
+	{ send_dtmf_131, sizeof(send_dtmf_131) },
+	{ send_dtmf_211, sizeof(send_dtmf_211) },
+	{ send_dtmf_221, sizeof(send_dtmf_221) },
+	{ send_dtmf_231, sizeof(send_dtmf_231) },
+	{ send_dtmf_311, sizeof(send_dtmf_311) },
+	{ send_dtmf_411, sizeof(send_dtmf_411) },
+	{ send_dtmf_412, sizeof(send_dtmf_412) },
+	{ send_dtmf_421, sizeof(send_dtmf_421) },
+	{ send_dtmf_422, sizeof(send_dtmf_422) },
+	{ send_dtmf_431, sizeof(send_dtmf_431) },
+	{ send_dtmf_432, sizeof(send_dtmf_432) },
+	{ send_dtmf_441, sizeof(send_dtmf_441) },
+	{ send_dtmf_442, sizeof(send_dtmf_442) },
+	{ send_dtmf_443, sizeof(send_dtmf_443) },
+	{ send_dtmf_451, sizeof(send_dtmf_451) },
+	{ send_dtmf_452, sizeof(send_dtmf_452) },
+	{ send_dtmf_453, sizeof(send_dtmf_453) },
+	{ send_dtmf_461, sizeof(send_dtmf_461) },
+	{ send_dtmf_462, sizeof(send_dtmf_462) },
+	{ send_dtmf_463, sizeof(send_dtmf_463) },
+	{ send_dtmf_471, sizeof(send_dtmf_471) },
+	{ send_dtmf_472, sizeof(send_dtmf_472) },
+	{ send_dtmf_473, sizeof(send_dtmf_473) },
+	{ send_dtmf_481, sizeof(send_dtmf_481) },
+	{ send_dtmf_482, sizeof(send_dtmf_482) },
+	{ send_dtmf_483, sizeof(send_dtmf_483) },
+	{ send_dtmf_491, sizeof(send_dtmf_491) },
+	{ send_dtmf_492, sizeof(send_dtmf_492) },
+	{ send_dtmf_493, sizeof(send_dtmf_493) },
+	{ send_dtmf_4101, sizeof(send_dtmf_4101) },
+	{ send_dtmf_4102, sizeof(send_dtmf_4102) },
+	{ send_dtmf_511, sizeof(send_dtmf_511) },
+	{ send_dtmf_611, sizeof(send_dtmf_611) },
+	{ language_notification_111, sizeof(language_notification_111) },
+	{ language_notification_121, sizeof(language_notification_121) },
+	{ launch_browser_111, sizeof(launch_browser_111) },
+	{ launch_browser_121, sizeof(launch_browser_121) },
+	{ launch_browser_131, sizeof(launch_browser_131) },
+	{ launch_browser_141, sizeof(launch_browser_141) },
+	{ launch_browser_211, sizeof(launch_browser_211) },
+	{ launch_browser_221, sizeof(launch_browser_221) },
+	{ launch_browser_231, sizeof(launch_browser_231) },
+	{ launch_browser_311, sizeof(launch_browser_311) },
+	{ launch_browser_411, sizeof(launch_browser_411) },
+	{ launch_browser_421, sizeof(launch_browser_421) },
+	{ launch_browser_511, sizeof(launch_browser_511) },
+	{ launch_browser_512, sizeof(launch_browser_512) },
+	{ launch_browser_521, sizeof(launch_browser_521) },
+	{ launch_browser_522, sizeof(launch_browser_522) },
+	{ launch_browser_531, sizeof(launch_browser_531) },
+	{ launch_browser_532, sizeof(launch_browser_532) },
+	{ launch_browser_541, sizeof(launch_browser_541) },
+	{ launch_browser_542, sizeof(launch_browser_542) },
+	{ launch_browser_543, sizeof(launch_browser_543) },
+	{ launch_browser_551, sizeof(launch_browser_551) },
+	{ launch_browser_552, sizeof(launch_browser_552) },
+	{ launch_browser_553, sizeof(launch_browser_553) },
+	{ launch_browser_561, sizeof(launch_browser_561) },
+	{ launch_browser_562, sizeof(launch_browser_562) },
+	{ launch_browser_563, sizeof(launch_browser_563) },
+	{ launch_browser_571, sizeof(launch_browser_571) },
+	{ launch_browser_572, sizeof(launch_browser_572) },
+	{ launch_browser_573, sizeof(launch_browser_573) },
+	{ launch_browser_581, sizeof(launch_browser_581) },
+	{ launch_browser_582, sizeof(launch_browser_582) },
+	{ launch_browser_583, sizeof(launch_browser_583) },
+	{ launch_browser_591, sizeof(launch_browser_591) },
+	{ launch_browser_592, sizeof(launch_browser_592) },
+	{ launch_browser_593, sizeof(launch_browser_593) },
+	{ launch_browser_5101, sizeof(launch_browser_5101) },
+	{ launch_browser_5102, sizeof(launch_browser_5102) },
+	{ launch_browser_611, sizeof(launch_browser_611) },
+	{ launch_browser_711, sizeof(launch_browser_711) },
+	{ close_channel_111, sizeof(close_channel_111) },
+	{ close_channel_211, sizeof(close_channel_211) },
+	{ receive_data_111, sizeof(receive_data_111) },
+	{ receive_data_211, sizeof(receive_data_211) },
+	{ send_data_111, sizeof(send_data_111) },
+	{ send_data_121, sizeof(send_data_121) },
+	{ send_data_211, sizeof(send_data_211) },
+	{ get_channel_status_111, sizeof(get_channel_status_111) },
+};
+
+#define BENCHMARK_MENU_ITEMS 50
+
+/* SET UP MENU with the most items that fit into a command */
+static unsigned int build_large_menu(unsigned char *pdu)
+{
+	static const unsigned char header[] = {
+		0xD0, 0x81, 0x00, 0x81, 0x03, 0x01, 0x25, 0x00,
+		0x82, 0x02, 0x81, 0x82, 0x85, 0x04, 0x4D, 0x65,
+		0x6E, 0x75,
+	};
+	unsigned int len = sizeof(header);
+	unsigned int i;
+
+	memcpy(pdu, header, len);
+
+	for (i = 1; i <= BENCHMARK_MENU_ITEMS; i++) {
+		pdu[len++] = 0x8F;
+		pdu[len++] = 0x02;
+		pdu[len++] = i;
+		pdu[len++] = 'A' + i % 26;
+	}
+
+	pdu[2] = len - 3;
+
+	return len;
+}
+
+static void dump_corpus(const char *dir, const unsigned char *menu,
+				unsigned int menu_len)
+{
+	unsigned int i;
+
+	g_mkdir_with_parents(dir, 0755);
+
+	for (i = 0; i <= G_N_ELEMENTS(command_corpus); i++) {
+		const struct pdu_test *test;
+		char *path = g_strdup_printf("%s/%04u", dir, i);
+
+		if (i < G_N_ELEMENTS(command_corpus)) {
+			test = command_corpus + i;
+			g_file_set_contents(path, (const char *) test->pdu,
+						test->pdu_len, NULL);
+		} else
+			g_file_set_contents(path, (const char *) menu,
+						menu_len, NULL);
+
+		g_free(path);
+	}
+}
+
+/*
+ * Parses the whole proactive command corpus, and then a large menu, for
+ * a second each.  Set STKUTIL_CORPUS to a directory to also store the
+ * corpus there as seeds for unit/fuzz-stkutil.
+ */
+static void test_benchmark(void)
+{
+	unsigned char menu[256];
+	unsigned int menu_len = build_large_menu(menu);
+	struct stk_command *command;
+	const char *dir = g_getenv("STKUTIL_CORPUS");
+	unsigned long parsed = 0;
+	gdouble elapsed;
+	unsigned int i;
+
+	command = stk_command_new_from_pdu(menu, menu_len);
+	g_assert(command);
+	g_assert(command->status == STK_PARSE_RESULT_OK);
+	g_assert(g_slist_length(command->setup_menu.items) ==
+						BENCHMARK_MENU_ITEMS);
+	stk_command_free(command);
+
+	if (dir)
+		dump_corpus(dir, menu, menu_len);
+
+	g_test_timer_start();
+
+	do {
+		for (i = 0; i < G_N_ELEMENTS(command_corpus); i++) {
+			const struct pdu_test *test = command_corpus + i;
+
+			command = stk_command_new_from_pdu(test->pdu,
+								test->pdu_len);
+			if (command)
+				stk_command_free(command);
+		}
+
+		parsed += G_N_ELEMENTS(command_corpus);
+	} while ((elapsed = g_test_timer_elapsed()) < 1.0);
+
+	g_test_maximized_result(parsed / elapsed,
+				"%.0f commands/s over %u PDUs",
+				parsed / elapsed,
+				(unsigned int) G_N_ELEMENTS(command_corpus));
+
+	parsed = 0;
+	g_test_timer_start();
+
+	do {
+		for (i = 0; i < 1000; i++) {
+			command = stk_command_new_from_pdu(menu, menu_len);
+			stk_command_free(command);
+		}
+
+		parsed += 1000;
+	} while ((elapsed = g_test_timer_elapsed()) < 1.0);
+
+	g_test_maximized_result(parsed / elapsed,
+				"%.0f %u-item menus/s", parsed / elapsed,
+				BENCHMARK_MENU_ITEMS);
+}
+
+#define BENCHMARK_IMG_SIZE 64
+
+/*
+ * Renders the largest colour image a menu is likely to carry, 8 bits
+ * per pixel with a full CLUT, into XPM and into RGBA for a second each.
+ */
+static void test_render_benchmark(void)
+{
+	unsigned int len = 6 + BENCHMARK_IMG_SIZE * BENCHMARK_IMG_SIZE;
+	unsigned char *img = g_malloc(len);
+	unsigned char clut[256 * 3];
+	unsigned long rendered = 0;
+	unsigned int width, height;
+	gdouble elapsed;
+	unsigned int i;
+
+	img[0] = BENCHMARK_IMG_SIZE;
+	img[1] = BENCHMARK_IMG_SIZE;
+	img[2] = 8;
+	img[3] = 0;
+	img[4] = 0;
+	img[5] = 0;
+
+	for (i = 6; i < len; i++)
+		img[i] = i * 7;
+
+	for (i = 0; i < sizeof(clut); i++)
+		clut[i] = i;
+
+	g_test_timer_start();
+
+	do {
+		for (i = 0; i < 100; i++)
+			g_free(stk_image_to_xpm(img, len, STK_IMG_SCHEME_COLOR,
+						clut, sizeof(clut)));
+
+		rendered += 100;
+	} while ((elapsed = g_test_timer_elapsed()) < 1.0);
+
+	g_test_maximized_result(rendered / elapsed,
+				"%.0f %ux%u XPM renders/s", rendered / elapsed,
+				BENCHMARK_IMG_SIZE, BENCHMARK_IMG_SIZE);
+
+	rendered = 0;
+	g_test_timer_start();
+
+	do {
+		for (i = 0; i < 100; i++)
+			g_free(stk_image_to_rgba(img, len,
+						STK_IMG_SCHEME_COLOR,
+						clut, sizeof(clut),
+						&width, &height));
+
+		rendered += 100;
+	} while ((elapsed = g_test_timer_elapsed()) < 1.0);
+
+	g_test_maximized_result(rendered / elapsed,
+				"%.0f %ux%u RGBA renders/s", rendered / elapsed,
+				BENCHMARK_IMG_SIZE, BENCHMARK_IMG_SIZE);
+
+	g_free(img);
+}
+
 int main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
@@ -24385,6 +25288,17 @@ int main(int argc, char **argv)
 				&xpm_test_5, test_img_to_xpm);
 	g_test_add_data_func("/teststk/IMG to XPM Test 6",
 				&xpm_test_6, test_img_to_xpm);
+	g_test_add_data_func("/teststk/IMG to RGBA Test 1",
+				&rgba_test_1, test_img_to_rgba);
+	g_test_add_data_func("/teststk/IMG to RGBA Test 2",
+				&rgba_test_2, test_img_to_rgba);
+
+	if (g_test_perf())
+		g_test_add_func("/teststk/Benchmark", test_benchmark);
+
+	if (g_test_perf())
+		g_test_add_func("/teststk/Render Benchmark",
+					test_render_benchmark);
 
 	return g_test_run();
 }
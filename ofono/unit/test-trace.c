@@ -0,0 +1,268 @@
+/*
+ *
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "ofono.h"
+#include "trace.h"
+
+/* 16 KiB gives a ring of 64 records */
+#define TEST_KBYTES	16
+#define TEST_RECORDS	64
+
+static struct ofono_debug_desc test_desc = {
+	.file = "unit/test-trace.c",
+	.flags = OFONO_DEBUG_FLAG_TRACE,
+};
+
+static const char test_format[] = "%s() %d %-4s %.*f %p %zu";
+
+struct dump {
+	gchar *data;
+	gsize length;
+	const struct trace_file_header *hdr;
+	const struct trace_record *records;
+};
+
+static void dump_read(struct dump *dump)
+{
+	char *path;
+	int fd;
+
+	fd = g_file_open_tmp("test-trace-XXXXXX", &path, NULL);
+	g_assert(fd >= 0);
+	g_assert(__ofono_trace_write(fd) == 0);
+	close(fd);
+
+	g_assert(g_file_get_contents(path, &dump->data, &dump->length, NULL));
+	g_unlink(path);
+	g_free(path);
+
+	g_assert(dump->length >= sizeof(struct trace_file_header));
+	dump->hdr = (const struct trace_file_header *) dump->data;
+	dump->records = (const struct trace_record *) (dump->hdr + 1);
+
+	g_assert(dump->hdr->magic == TRACE_MAGIC);
+	g_assert(dump->hdr->version == TRACE_VERSION);
+	g_assert(dump->hdr->record_size == sizeof(struct trace_record));
+	g_assert(dump->length >= sizeof(struct trace_file_header) +
+			dump->hdr->count * sizeof(struct trace_record));
+}
+
+static gboolean dump_has_string(const struct dump *dump, const char *str)
+{
+	const guint8 *ptr = (const guint8 *) (dump->records + dump->hdr->count);
+	const guint8 *end = (const guint8 *) dump->data + dump->length;
+
+	while (ptr + sizeof(struct trace_string) <= end) {
+		struct trace_string entry;
+
+		memcpy(&entry, ptr, sizeof(entry));
+		ptr += sizeof(entry);
+
+		if (entry.addr == (uintptr_t) str) {
+			g_assert(entry.len == strlen(str));
+			g_assert(!memcmp(ptr, str, entry.len));
+			return TRUE;
+		}
+
+		ptr += entry.len;
+	}
+
+	return FALSE;
+}
+
+static const guint8 *check_u64(const guint8 *p, char tag, guint64 expected)
+{
+	guint64 v;
+
+	g_assert(*p == tag);
+	memcpy(&v, p + 1, sizeof(v));
+	g_assert(v == expected);
+
+	return p + 1 + sizeof(v);
+}
+
+static const guint8 *check_string(const guint8 *p, const char *expected)
+{
+	g_assert(*p == TRACE_ARG_STRING);
+	g_assert(p[1] == strlen(expected));
+	g_assert(!memcmp(p + 2, expected, p[1]));
+
+	return p + 2 + p[1];
+}
+
+static void test_dbg(void)
+{
+	const struct trace_record *rec;
+	struct dump dump;
+	const guint8 *p;
+	double d = 2.5;
+	guint64 dv;
+
+	g_assert(__ofono_trace_init(TEST_KBYTES) == 0);
+
+	ofono_dbg(&test_desc, test_format, "func", -42, "ab", 1, d,
+						&test_desc, (size_t) 7);
+	ofono_trace_data(&test_desc, TRUE, "AT+CSQ\r", 7);
+
+	dump_read(&dump);
+	g_assert(dump.hdr->count == 2);
+	g_assert(dump.hdr->dropped == 0);
+
+	rec = dump.records;
+	g_assert(rec->seq == 1);
+	g_assert(rec->type == TRACE_RECORD_DBG);
+	g_assert(rec->flags == 0);
+	g_assert(rec->id == (uintptr_t) test_format);
+
+	memcpy(&dv, &d, sizeof(dv));
+	p = check_u64(rec->payload, TRACE_ARG_FILE, (uintptr_t) test_desc.file);
+	p = check_string(p, "func");
+	p = check_u64(p, TRACE_ARG_INT, (guint64) -42);
+	p = check_string(p, "ab");
+	p = check_u64(p, TRACE_ARG_INT, 1);
+	p = check_u64(p, TRACE_ARG_DOUBLE, dv);
+	p = check_u64(p, TRACE_ARG_POINTER, (uintptr_t) &test_desc);
+	p = check_u64(p, TRACE_ARG_INT, 7);
+	g_assert(p == rec->payload + rec->len);
+
+	rec++;
+	g_assert(rec->seq == 2);
+	g_assert(rec->type == TRACE_RECORD_DATA_IN);
+	g_assert(rec->id == (uintptr_t) &test_desc);
+	g_assert(rec->len == 7);
+	g_assert(!memcmp(rec->payload, "AT+CSQ\r", 7));
+
+	g_assert(dump_has_string(&dump, test_format));
+	g_assert(dump_has_string(&dump, test_desc.file));
+
+	g_free(dump.data);
+	__ofono_trace_cleanup();
+}
+
+static void test_wrap(void)
+{
+	guint8 data[TRACE_RECORD_SIZE * 3];
+	struct dump dump;
+	unsigned int last = 999;
+	unsigned int i;
+
+	memset(data, 'x', sizeof(data));
+	g_assert(__ofono_trace_init(TEST_KBYTES) == 0);
+
+	for (i = 0; i < 1000; i++)
+		ofono_trace_data(NULL, FALSE, &i, sizeof(i));
+
+	/* Spans several records */
+	ofono_trace_data(NULL, TRUE, data, sizeof(data));
+
+	dump_read(&dump);
+	g_assert(dump.hdr->count == TEST_RECORDS);
+	g_assert(dump.hdr->dropped == 1004 - TEST_RECORDS);
+
+	for (i = 0; i < TEST_RECORDS; i++)
+		g_assert(dump.records[i].seq == 1004 - TEST_RECORDS + i + 1);
+
+	i = TEST_RECORDS - 5;
+	g_assert(dump.records[i].type == TRACE_RECORD_DATA_OUT);
+	g_assert(dump.records[i].len == sizeof(last));
+	g_assert(!memcmp(dump.records[i].payload, &last, sizeof(last)));
+
+	for (i = TEST_RECORDS - 4; i < TEST_RECORDS; i++) {
+		g_assert(dump.records[i].type == TRACE_RECORD_DATA_IN);
+		g_assert(!(dump.records[i].flags & TRACE_FLAG_TRUNCATED));
+		g_assert(!!(dump.records[i].flags & TRACE_FLAG_CONTINUED) ==
+						(i != TEST_RECORDS - 4));
+	}
+
+	g_free(dump.data);
+	__ofono_trace_cleanup();
+
+	/* Nothing to dump without the ring */
+	g_assert(__ofono_trace_write(STDOUT_FILENO) < 0);
+}
+
+static void test_capture(void)
+{
+	const struct trace_file_header *hdr;
+	const struct trace_record *rec;
+	guint8 data[TRACE_RECORD_SIZE];
+	gsize length;
+	gchar *file;
+	char *path;
+	int fd;
+
+	memset(data, 'x', sizeof(data));
+	fd = g_file_open_tmp("test-capture-XXXXXX", &path, NULL);
+	g_assert(fd >= 0);
+	close(fd);
+
+	/* Works without the ring */
+	g_assert(__ofono_trace_capture_start(path) == 0);
+	g_assert(__ofono_trace_capture_start(path) == -EALREADY);
+	ofono_trace_data(&test_desc, FALSE, "AT\r", 3);
+	ofono_trace_data(&test_desc, TRUE, data, sizeof(data));
+	__ofono_trace_capture_stop();
+
+	/* Not recorded anymore */
+	ofono_trace_data(&test_desc, TRUE, "OK", 2);
+
+	g_assert(g_file_get_contents(path, &file, &length, NULL));
+	g_assert(length == sizeof(*hdr) + 3 * sizeof(*rec));
+	g_unlink(path);
+	g_free(path);
+
+	hdr = (const struct trace_file_header *) file;
+	g_assert(hdr->magic == TRACE_MAGIC);
+	g_assert(hdr->count == TRACE_COUNT_STREAM);
+
+	rec = (const struct trace_record *) (hdr + 1);
+	g_assert(rec[0].seq == 1);
+	g_assert(rec[0].type == TRACE_RECORD_DATA_OUT);
+	g_assert(rec[0].id == (uintptr_t) &test_desc);
+	g_assert(rec[0].len == 3);
+	g_assert(!memcmp(rec[0].payload, "AT\r", 3));
+
+	g_assert(rec[1].type == TRACE_RECORD_DATA_IN);
+	g_assert(rec[1].flags == 0);
+	g_assert(rec[1].len == sizeof(rec->payload));
+	g_assert(rec[2].flags == TRACE_FLAG_CONTINUED);
+	g_assert(rec[2].len == sizeof(data) - sizeof(rec->payload));
+	g_assert(rec[2].timestamp >= rec[0].timestamp);
+
+	g_free(file);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/testtrace/DBG", test_dbg);
+	g_test_add_func("/testtrace/Wrap", test_wrap);
+	g_test_add_func("/testtrace/Capture", test_capture);
+
+	return g_test_run();
+}
@@ -25,6 +25,7 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>
 #include <assert.h>
 #include <glib.h>
 
@@ -1012,6 +1013,139 @@ static void test_unicode_to_gsm(void)
 	}
 }
 
+static void test_hex(void)
+{
+	unsigned char bytes[256];
+	unsigned char out[257];
+	char hex[513];
+	long n;
+	int i;
+
+	for (i = 0; i < 256; i++)
+		bytes[i] = i;
+
+	/* Every byte value survives the round trip */
+	g_assert(encode_hex_own_buf(bytes, 256, 0, hex) == hex);
+	g_assert(strlen(hex) == 512);
+	g_assert(!strncmp(hex, "000102030405060708090A0B0C0D0E0F", 32));
+	g_assert(!strcmp(hex + 480, "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF"));
+	g_assert(decode_hex_own_buf(hex, -1, &n, 0, out) == out);
+	g_assert(n == 256);
+	g_assert(!memcmp(out, bytes, 256));
+
+	/* Lower case, terminator and the odd trailing character */
+	g_assert(decode_hex_own_buf("a0fF1", -1, &n, 0x55, out) == out);
+	g_assert(n == 2);
+	g_assert(out[0] == 0xa0 && out[1] == 0xff && out[2] == 0x55);
+
+	/* Anything but hex digits is rejected, wherever it is */
+	g_assert(!decode_hex_own_buf("G0", -1, NULL, 0, out));
+	g_assert(!decode_hex_own_buf("0g", -1, NULL, 0, out));
+	g_assert(!decode_hex_own_buf("00112233 4", -1, NULL, 0, out));
+	g_assert(!decode_hex_own_buf("0011\xff" "0", 6, NULL, 0, out));
+	g_assert(!decode_hex("001:", -1, NULL, 0));
+	g_assert(!decode_hex("@@", 2, NULL, 0));
+
+	/* But only within len */
+	g_assert(decode_hex_own_buf("0011xx", 4, &n, 0, out) == out);
+	g_assert(n == 2);
+
+	/* Encoding up to the terminator */
+	g_assert(!strcmp(encode_hex_own_buf((const unsigned char *) "\x01\xab",
+							-1, 0, hex), "01AB"));
+}
+
+/* What the hex codec used to look like */
+static unsigned char *test_decode_hex_ref(const char *in, long len,
+						unsigned char *buf)
+{
+	long i, j;
+	char c;
+	unsigned char b;
+
+	for (i = 0, j = 0; i < len; i++, j++) {
+		c = toupper(in[i]);
+
+		if (c >= '0' && c <= '9')
+			b = c - '0';
+		else if (c >= 'A' && c <= 'F')
+			b = 10 + c - 'A';
+		else
+			return NULL;
+
+		i += 1;
+		c = toupper(in[i]);
+
+		if (c >= '0' && c <= '9')
+			b = b * 16 + c - '0';
+		else if (c >= 'A' && c <= 'F')
+			b = b * 16 + 10 + c - 'A';
+		else
+			return NULL;
+
+		buf[j] = b;
+	}
+
+	return buf;
+}
+
+static char *test_encode_hex_ref(const unsigned char *in, long len,
+								char *buf)
+{
+	long i, j;
+	char c;
+
+	for (i = 0, j = 0; i < len; i++, j++) {
+		c = (in[i] >> 4) & 0xf;
+		buf[j] = (c <= 9) ? ('0' + c) : ('A' + c - 10);
+		j += 1;
+		c = in[i] & 0xf;
+		buf[j] = (c <= 9) ? ('0' + c) : ('A' + c - 10);
+	}
+
+	buf[j] = '\0';
+	return buf;
+}
+
+#define TEST_HEX_PDU_SIZE	176	/* The largest SMS PDU */
+#define TEST_HEX_COUNT		100000
+
+static void test_hex_benchmark(void)
+{
+	unsigned char pdu[TEST_HEX_PDU_SIZE];
+	unsigned char out[TEST_HEX_PDU_SIZE];
+	char hex[2 * TEST_HEX_PDU_SIZE + 1];
+	gint64 ref, lut, start;
+	int i;
+
+	for (i = 0; i < TEST_HEX_PDU_SIZE; i++)
+		pdu[i] = i * 37;
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < TEST_HEX_COUNT; i++) {
+		test_encode_hex_ref(pdu, sizeof(pdu), hex);
+		g_assert(test_decode_hex_ref(hex, sizeof(hex) - 1, out));
+	}
+	ref = g_get_monotonic_time() - start;
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < TEST_HEX_COUNT; i++) {
+		encode_hex_own_buf(pdu, sizeof(pdu), 0, hex);
+		g_assert(decode_hex_own_buf(hex, sizeof(hex) - 1, NULL, 0,
+									out));
+	}
+	lut = g_get_monotonic_time() - start;
+
+	g_assert(!memcmp(out, pdu, sizeof(pdu)));
+
+	if (g_test_verbose())
+		g_print("%d x %d bytes: %d ms per-character, %d ms table "
+			"(%.1f MB/s)\n", TEST_HEX_COUNT, TEST_HEX_PDU_SIZE,
+			(int) (ref / 1000), (int) (lut / 1000),
+			lut ? (2.0 * TEST_HEX_COUNT * TEST_HEX_PDU_SIZE / lut) :
+									0.0);
+}
+
 int main(int argc, char **argv)
 {
 	g_test_init(&argc, &argv, NULL);
@@ -1028,6 +1162,8 @@ int main(int argc, char **argv)
 	g_test_add_func("/testutil/SIM conversions", test_sim);
 	g_test_add_func("/testutil/Valid Unicode to GSM Conversion",
 			test_unicode_to_gsm);
+	g_test_add_func("/testutil/Hex", test_hex);
+	g_test_add_func("/testutil/Hex Benchmark", test_hex_benchmark);
 
 	return g_test_run();
 }
@@ -1163,6 +1163,207 @@ static void test_cancel6(void)
 	test_common_deinit();
 }
 
+/* ==== sync ==== */
+
+#define TEST_SYNC_COUNT (10000)
+
+static enum ofono_voicecall_filter_dial_result filter_dial_sync_continue
+		(struct ofono_voicecall *vc,
+			const struct ofono_phone_number *number,
+			enum ofono_clir_option clir)
+{
+	test_filter_dial_count++;
+	return OFONO_VOICECALL_FILTER_DIAL_CONTINUE;
+}
+
+static enum ofono_voicecall_filter_dial_result filter_dial_sync_block
+		(struct ofono_voicecall *vc,
+			const struct ofono_phone_number *number,
+			enum ofono_clir_option clir)
+{
+	test_filter_dial_count++;
+	return strcmp(number->number, "112") ?
+		OFONO_VOICECALL_FILTER_DIAL_BLOCK :
+		OFONO_VOICECALL_FILTER_DIAL_CONTINUE;
+}
+
+static enum ofono_voicecall_filter_incoming_result
+	filter_incoming_sync_continue(struct ofono_voicecall *vc,
+					const struct ofono_call *call)
+{
+	test_filter_incoming_count++;
+	return OFONO_VOICECALL_FILTER_INCOMING_CONTINUE;
+}
+
+static enum ofono_voicecall_filter_incoming_result
+	filter_incoming_sync_ignore(struct ofono_voicecall *vc,
+					const struct ofono_call *call)
+{
+	test_filter_incoming_count++;
+	return OFONO_VOICECALL_FILTER_INCOMING_IGNORE;
+}
+
+static void test_dial_expect_block_inc
+		(enum ofono_voicecall_filter_dial_result result, void *data)
+{
+	g_assert(result == OFONO_VOICECALL_FILTER_DIAL_BLOCK);
+	(*(int*)data)++;
+}
+
+static void test_incoming_expect_ignore_inc
+	(enum ofono_voicecall_filter_incoming_result result, void *data)
+{
+	g_assert(result == OFONO_VOICECALL_FILTER_INCOMING_IGNORE);
+	(*(int*)data)++;
+}
+
+static void test_sync(void)
+{
+	static struct ofono_voicecall_filter filter1 = {
+		.name = "sync1",
+		.api_version = OFONO_VOICECALL_FILTER_API_VERSION,
+		.priority = OFONO_VOICECALL_FILTER_PRIORITY_HIGH,
+		.filter_dial_sync = filter_dial_sync_continue,
+		.filter_incoming_sync = filter_incoming_sync_continue
+	};
+
+	static struct ofono_voicecall_filter filter2 = {
+		.name = "sync2",
+		.api_version = OFONO_VOICECALL_FILTER_API_VERSION,
+		.priority = OFONO_VOICECALL_FILTER_PRIORITY_DEFAULT,
+		.filter_dial_sync = filter_dial_sync_block,
+		.filter_incoming_sync = filter_incoming_sync_ignore,
+		/* The sync callback takes precedence */
+		.filter_dial = filter_dial_block
+	};
+
+	static struct ofono_voicecall_filter filter3 = {
+		.name = "sync3",
+		.api_version = OFONO_VOICECALL_FILTER_API_VERSION,
+		.priority = OFONO_VOICECALL_FILTER_PRIORITY_LOW,
+		/* Never gets called */
+		.filter_incoming = filter_incoming_hangup
+	};
+
+	struct ofono_voicecall vc;
+	struct ofono_phone_number number;
+	struct ofono_call call;
+	int count = 0;
+	gint64 start;
+	int i;
+
+	test_common_init();
+	test_voicecall_init(&vc);
+	ofono_call_init(&call);
+	string_to_phone_number("911", &call.phone_number);
+	string_to_phone_number("112", &number);
+
+	g_assert(ofono_voicecall_filter_register(&filter1) == 0);
+	g_assert(ofono_voicecall_filter_register(&filter2) == 0);
+	g_assert(ofono_voicecall_filter_register(&filter3) == 0);
+	g_assert((vc.chain = __ofono_voicecall_filter_chain_new(&vc)) != NULL);
+
+	/* All verdicts are taken before the calls return */
+	__ofono_voicecall_filter_chain_dial(vc.chain, &number,
+			OFONO_CLIR_OPTION_DEFAULT,
+			test_dial_expect_continue_inc,
+			test_inc, &count);
+	g_assert(test_filter_dial_count == 2);
+	g_assert(count == 2);
+	count = 0;
+
+	__ofono_voicecall_filter_chain_dial_check(vc.chain, &call,
+			test_dial_expect_block_inc,
+			test_inc, &count);
+	g_assert(test_filter_dial_count == 4);
+	g_assert(count == 2);
+	count = 0;
+
+	__ofono_voicecall_filter_chain_incoming(vc.chain, &call,
+			test_incoming_expect_ignore_inc,
+			test_inc, &count);
+	g_assert(test_filter_incoming_count == 2);
+	g_assert(count == 2);
+	count = 0;
+
+	/* No main loop iterations per request */
+	test_clear_counts();
+	start = g_get_monotonic_time();
+	for (i = 0; i < TEST_SYNC_COUNT; i++) {
+		__ofono_voicecall_filter_chain_dial(vc.chain, &number,
+				OFONO_CLIR_OPTION_DEFAULT,
+				test_dial_expect_continue_inc,
+				NULL, &count);
+	}
+	DBG("%d requests in %d us", TEST_SYNC_COUNT,
+				(int)(g_get_monotonic_time() - start));
+	g_assert(test_filter_dial_count == 2 * TEST_SYNC_COUNT);
+	g_assert(count == TEST_SYNC_COUNT);
+
+	__ofono_voicecall_filter_chain_free(vc.chain);
+	ofono_voicecall_filter_unregister(&filter1);
+	ofono_voicecall_filter_unregister(&filter2);
+	ofono_voicecall_filter_unregister(&filter3);
+	test_common_deinit();
+}
+
+/* ==== sync_async ==== */
+
+static void test_sync_async(void)
+{
+	static struct ofono_voicecall_filter filter1 = {
+		.name = "sync",
+		.api_version = OFONO_VOICECALL_FILTER_API_VERSION,
+		.priority = OFONO_VOICECALL_FILTER_PRIORITY_HIGH,
+		.filter_dial_sync = filter_dial_sync_continue
+	};
+
+	static struct ofono_voicecall_filter filter2 = {
+		.name = "async",
+		.api_version = OFONO_VOICECALL_FILTER_API_VERSION,
+		.priority = OFONO_VOICECALL_FILTER_PRIORITY_DEFAULT,
+		.filter_dial = filter_dial_block_later
+	};
+
+	/* API version 0 doesn't have the sync callbacks */
+	static struct ofono_voicecall_filter filter3 = {
+		.name = "old",
+		.priority = OFONO_VOICECALL_FILTER_PRIORITY_LOW,
+		.filter_dial_sync = filter_dial_sync_continue
+	};
+
+	struct ofono_voicecall vc;
+	struct ofono_phone_number number;
+	int count = 0;
+
+	test_common_init();
+	test_voicecall_init(&vc);
+	string_to_phone_number("112", &number);
+
+	g_assert(ofono_voicecall_filter_register(&filter1) == 0);
+	g_assert(ofono_voicecall_filter_register(&filter2) == 0);
+	g_assert(ofono_voicecall_filter_register(&filter3) == 0);
+	g_assert((vc.chain = __ofono_voicecall_filter_chain_new(&vc)) != NULL);
+
+	/* The async filter has the final say */
+	__ofono_voicecall_filter_chain_dial(vc.chain, &number,
+			OFONO_CLIR_OPTION_DEFAULT,
+			test_dial_expect_block_and_quit,
+			test_inc, &count);
+	g_assert(test_filter_dial_count == 1);
+	g_assert(!count);
+
+	g_main_loop_run(test_loop);
+	g_assert(test_filter_dial_count == 2);
+	g_assert(count == 1);
+
+	__ofono_voicecall_filter_chain_free(vc.chain);
+	ofono_voicecall_filter_unregister(&filter1);
+	ofono_voicecall_filter_unregister(&filter2);
+	ofono_voicecall_filter_unregister(&filter3);
+	test_common_deinit();
+}
+
 #define TEST_(name) "/voicecall-filter/" name
 
 int main(int argc, char *argv[])
@@ -1197,6 +1398,8 @@ int main(int argc, char *argv[])
 	g_test_add_func(TEST_("cancel4"), test_cancel4);
 	g_test_add_func(TEST_("cancel5"), test_cancel5);
 	g_test_add_func(TEST_("cancel6"), test_cancel6);
+	g_test_add_func(TEST_("sync"), test_sync);
+	g_test_add_func(TEST_("sync_async"), test_sync_async);
 
 	return g_test_run();
 }
@@ -0,0 +1,600 @@
+/*
+ *  oFono - Open Source Telephony
+ *
+ *  Copyright (C) 2026 Jolla Ltd.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2 as
+ *  published by the Free Software Foundation.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <gdbus.h>
+
+#include "ofono.h"
+#include "common.h"
+#include "voicecallagent.h"
+
+#define TEST_PATH	"/test"
+
+/* Fake ofono_modem and ofono_atom */
+
+struct ofono_modem {
+	int unused;
+};
+
+struct ofono_atom {
+	struct ofono_modem *modem;
+	void *data;
+	void (*destruct)(struct ofono_atom *atom);
+	void (*unregister)(struct ofono_atom *atom);
+};
+
+struct ofono_atom *__ofono_modem_add_atom(struct ofono_modem *modem,
+					enum ofono_atom_type type,
+					void (*destruct)(struct ofono_atom *),
+					void *data)
+{
+	struct ofono_atom *atom = g_new0(struct ofono_atom, 1);
+
+	atom->modem = modem;
+	atom->data = data;
+	atom->destruct = destruct;
+	return atom;
+}
+
+struct ofono_atom *__ofono_modem_find_atom(struct ofono_modem *modem,
+						enum ofono_atom_type type)
+{
+	return NULL;
+}
+
+void __ofono_modem_foreach_registered_atom(struct ofono_modem *modem,
+						enum ofono_atom_type type,
+						ofono_atom_func callback,
+						void *data)
+{
+}
+
+unsigned int __ofono_modem_add_atom_watch(struct ofono_modem *modem,
+					enum ofono_atom_type type,
+					ofono_atom_watch_func notify,
+					void *data, ofono_destroy_func destroy)
+{
+	return 1;
+}
+
+gboolean __ofono_modem_remove_atom_watch(struct ofono_modem *modem,
+						unsigned int id)
+{
+	return TRUE;
+}
+
+void *__ofono_atom_get_data(struct ofono_atom *atom)
+{
+	return atom->data;
+}
+
+const char *__ofono_atom_get_path(struct ofono_atom *atom)
+{
+	return TEST_PATH;
+}
+
+struct ofono_modem *__ofono_atom_get_modem(struct ofono_atom *atom)
+{
+	return atom->modem;
+}
+
+void __ofono_atom_register(struct ofono_atom *atom,
+				void (*unregister)(struct ofono_atom *))
+{
+	atom->unregister = unregister;
+}
+
+void __ofono_atom_free(struct ofono_atom *atom)
+{
+	if (atom->unregister)
+		atom->unregister(atom);
+
+	if (atom->destruct)
+		atom->destruct(atom);
+
+	g_free(atom);
+}
+
+void ofono_modem_add_interface(struct ofono_modem *modem,
+				const char *interface)
+{
+}
+
+void ofono_modem_remove_interface(struct ofono_modem *modem,
+					const char *interface)
+{
+}
+
+ofono_bool_t ofono_modem_get_online(struct ofono_modem *modem)
+{
+	return TRUE;
+}
+
+unsigned int __ofono_modem_callid_next(struct ofono_modem *modem)
+{
+	return 1;
+}
+
+void __ofono_modem_callid_hold(struct ofono_modem *modem, int id)
+{
+}
+
+void __ofono_modem_callid_release(struct ofono_modem *modem, int id)
+{
+}
+
+void __ofono_modem_inc_emergency_mode(struct ofono_modem *modem)
+{
+}
+
+void __ofono_modem_dec_emergency_mode(struct ofono_modem *modem)
+{
+}
+
+/* Fake D-Bus objects */
+
+struct test_object {
+	char *path;
+	char *interface;
+	void *data;
+	GDBusDestroyFunction destroy;
+};
+
+static GSList *test_objects;
+
+gboolean g_dbus_register_interface(DBusConnection *connection,
+					const char *path, const char *name,
+					const GDBusMethodTable *methods,
+					const GDBusSignalTable *signals,
+					const GDBusPropertyTable *properties,
+					void *user_data,
+					GDBusDestroyFunction destroy)
+{
+	struct test_object *obj = g_new0(struct test_object, 1);
+
+	obj->path = g_strdup(path);
+	obj->interface = g_strdup(name);
+	obj->data = user_data;
+	obj->destroy = destroy;
+	test_objects = g_slist_append(test_objects, obj);
+	return TRUE;
+}
+
+gboolean g_dbus_unregister_interface(DBusConnection *connection,
+					const char *path, const char *name)
+{
+	GSList *l;
+
+	for (l = test_objects; l; l = l->next) {
+		struct test_object *obj = l->data;
+
+		if (strcmp(obj->path, path) || strcmp(obj->interface, name))
+			continue;
+
+		test_objects = g_slist_delete_link(test_objects, l);
+
+		if (obj->destroy)
+			obj->destroy(obj->data);
+
+		g_free(obj->path);
+		g_free(obj->interface);
+		g_free(obj);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+gboolean g_dbus_send_message(DBusConnection *connection, DBusMessage *message)
+{
+	dbus_message_unref(message);
+	return TRUE;
+}
+
+gboolean g_dbus_emit_signal(DBusConnection *connection,
+				const char *path, const char *interface,
+				const char *name, int type, ...)
+{
+	return TRUE;
+}
+
+DBusConnection *ofono_dbus_get_connection(void)
+{
+	return NULL;
+}
+
+void ofono_dbus_dict_append(DBusMessageIter *dict, const char *key, int type,
+				const void *value)
+{
+}
+
+void ofono_dbus_dict_append_array(DBusMessageIter *dict, const char *key,
+					int type, const void *val)
+{
+}
+
+int ofono_dbus_signal_property_changed(DBusConnection *conn, const char *path,
+					const char *interface, const char *name,
+					int type, const void *value)
+{
+	return 0;
+}
+
+int ofono_dbus_signal_array_property_changed(DBusConnection *conn,
+						const char *path,
+						const char *interface,
+						const char *name, int type,
+						const void *value)
+{
+	return 0;
+}
+
+void __ofono_dbus_pending_reply(DBusMessage **msg, DBusMessage *reply)
+{
+	g_assert_not_reached();
+}
+
+gboolean __ofono_dbus_access_method_allowed(const char *sender,
+					enum ofono_dbus_access_intf iface,
+					int method, const char *arg)
+{
+	return TRUE;
+}
+
+/* Nothing below is reached without D-Bus method calls, SIM and HFP */
+
+DBusMessage *__ofono_error_invalid_args(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_invalid_format(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_not_implemented(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_failed(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_busy(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_not_found(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_not_available(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_access_denied(DBusMessage *msg)
+{
+	return NULL;
+}
+
+DBusMessage *__ofono_error_from_error(const struct ofono_error *error,
+						DBusMessage *msg)
+{
+	return NULL;
+}
+
+void __ofono_history_call_ended(struct ofono_modem *modem,
+				const struct ofono_call *call,
+				time_t start, time_t end)
+{
+}
+
+void __ofono_history_call_missed(struct ofono_modem *modem,
+				const struct ofono_call *call, time_t when)
+{
+}
+
+const struct ofono_phone_number *__ofono_message_waiting_get_mbdn(
+					struct ofono_message_waiting *mw,
+					unsigned int index)
+{
+	return NULL;
+}
+
+const char *ofono_sim_get_imsi(struct ofono_sim *sim)
+{
+	return NULL;
+}
+
+enum ofono_sim_state ofono_sim_get_state(struct ofono_sim *sim)
+{
+	return OFONO_SIM_STATE_NOT_PRESENT;
+}
+
+unsigned int ofono_sim_add_state_watch(struct ofono_sim *sim,
+					ofono_sim_state_event_cb_t cb,
+					void *data, ofono_destroy_func destroy)
+{
+	return 0;
+}
+
+void ofono_sim_remove_state_watch(struct ofono_sim *sim, unsigned int id)
+{
+}
+
+struct ofono_sim_context *ofono_sim_context_create(struct ofono_sim *sim)
+{
+	return NULL;
+}
+
+void ofono_sim_context_free(struct ofono_sim_context *context)
+{
+}
+
+int ofono_sim_read(struct ofono_sim_context *context, int id,
+			enum ofono_sim_file_structure expected,
+			ofono_sim_file_read_cb_t cb, void *data)
+{
+	return -1;
+}
+
+unsigned int ofono_sim_add_file_watch(struct ofono_sim_context *context,
+					int id, ofono_sim_file_changed_cb_t cb,
+					void *userdata,
+					ofono_destroy_func destroy)
+{
+	return 0;
+}
+
+ofono_bool_t ofono_emulator_add_handler(struct ofono_emulator *em,
+					const char *prefix,
+					ofono_emulator_request_cb_t cb,
+					void *data, ofono_destroy_func destroy)
+{
+	return FALSE;
+}
+
+ofono_bool_t ofono_emulator_remove_handler(struct ofono_emulator *em,
+						const char *prefix)
+{
+	return FALSE;
+}
+
+ofono_bool_t ofono_emulator_request_next_number(
+					struct ofono_emulator_request *req,
+					int *number)
+{
+	return FALSE;
+}
+
+const char *ofono_emulator_request_get_raw(struct ofono_emulator_request *req)
+{
+	return NULL;
+}
+
+enum ofono_emulator_request_type ofono_emulator_request_get_type(
+					struct ofono_emulator_request *req)
+{
+	return OFONO_EMULATOR_REQUEST_TYPE_COMMAND_ONLY;
+}
+
+void ofono_emulator_send_final(struct ofono_emulator *em,
+				const struct ofono_error *final)
+{
+}
+
+void ofono_emulator_send_info(struct ofono_emulator *em, const char *line,
+				ofono_bool_t last)
+{
+}
+
+void ofono_emulator_set_indicator(struct ofono_emulator *em,
+					const char *name, int value)
+{
+}
+
+void __ofono_emulator_set_indicator_forced(struct ofono_emulator *em,
+						const char *name, int value)
+{
+}
+
+void __ofono_emulator_slc_condition(struct ofono_emulator *em,
+					enum ofono_emulator_slc_condition cond)
+{
+}
+
+void voicecall_agent_ringback_tone(struct voicecall_agent *agent,
+					const ofono_bool_t playTone)
+{
+}
+
+void voicecall_agent_set_removed_notify(struct voicecall_agent *agent,
+					ofono_destroy_func removed_cb,
+					void *user_data)
+{
+}
+
+void voicecall_agent_free(struct voicecall_agent *agent)
+{
+}
+
+ofono_bool_t voicecall_agent_matches(struct voicecall_agent *agent,
+					const char *path, const char *sender)
+{
+	return FALSE;
+}
+
+struct voicecall_agent *voicecall_agent_new(const char *path,
+						const char *sender)
+{
+	return NULL;
+}
+
+/* Driver */
+
+static unsigned int test_released; /* Bit mask of call ids */
+
+static int test_driver_probe(struct ofono_voicecall *vc, unsigned int vendor,
+								void *data)
+{
+	return 0;
+}
+
+static void test_driver_remove(struct ofono_voicecall *vc)
+{
+}
+
+static void test_driver_release_specific(struct ofono_voicecall *vc, int id,
+					ofono_voicecall_cb_t cb, void *data)
+{
+	test_released |= 1 << id;
+}
+
+static const struct ofono_voicecall_driver test_driver = {
+	.name			= "test",
+	.probe			= test_driver_probe,
+	.remove			= test_driver_remove,
+	.release_specific	= test_driver_release_specific,
+};
+
+/* Filter */
+
+static unsigned int test_filter_held;
+static enum ofono_voicecall_filter_incoming_result test_filter_verdict;
+
+static unsigned int test_filter_hold(struct ofono_voicecall *vc,
+				const struct ofono_call *call,
+				ofono_voicecall_filter_incoming_cb_t cb,
+				void *data)
+{
+	/* Never completes, the call waits until the filter is cancelled */
+	return ++test_filter_held;
+}
+
+static void test_filter_cancel(unsigned int id)
+{
+	g_assert(id && id <= test_filter_held);
+}
+
+static enum ofono_voicecall_filter_incoming_result test_filter_sync(
+				struct ofono_voicecall *vc,
+				const struct ofono_call *call)
+{
+	return test_filter_verdict;
+}
+
+static struct ofono_voicecall_filter test_filter = {
+	.name = "test",
+	.api_version = OFONO_VOICECALL_FILTER_API_VERSION,
+	.filter_cancel = test_filter_cancel,
+	.filter_incoming = test_filter_hold
+};
+
+/* ==== filter_notify ==== */
+
+struct test_filter_notify {
+	enum ofono_voicecall_filter_incoming_result verdict;
+	unsigned int released;
+	guint objects; /* Calls on D-Bus afterwards */
+};
+
+static const struct test_filter_notify test_filter_notify_accept = {
+	OFONO_VOICECALL_FILTER_INCOMING_CONTINUE, 0, 2
+};
+
+static const struct test_filter_notify test_filter_notify_reject = {
+	OFONO_VOICECALL_FILTER_INCOMING_HANGUP, (1 << 1) | (1 << 2), 0
+};
+
+static void test_notify_incoming(struct ofono_voicecall *vc,
+						unsigned int id, int status)
+{
+	struct ofono_call call;
+
+	ofono_call_init(&call);
+	call.id = id;
+	call.direction = OFONO_CALL_DIRECTION_MOBILE_TERMINATED;
+	call.status = status;
+	ofono_voicecall_notify(vc, &call);
+}
+
+static void test_filter_notify(gconstpointer test_data)
+{
+	const struct test_filter_notify *test = test_data;
+	struct ofono_modem modem;
+	struct ofono_voicecall *vc;
+
+	test_released = 0;
+	test_filter_held = 0;
+	test_filter_verdict = test->verdict;
+	test_filter.filter_incoming_sync = NULL;
+
+	g_assert(!ofono_voicecall_driver_register(&test_driver));
+	g_assert(!ofono_voicecall_filter_register(&test_filter));
+
+	vc = ofono_voicecall_create(&modem, 0, "test", NULL);
+	g_assert(vc);
+	ofono_voicecall_register(vc);
+	g_assert_cmpuint(g_slist_length(test_objects), ==, 1);
+
+	/* Both calls get queued behind the asynchronous filter */
+	test_notify_incoming(vc, 1, OFONO_CALL_STATUS_INCOMING);
+	test_notify_incoming(vc, 2, OFONO_CALL_STATUS_WAITING);
+	g_assert_cmpuint(test_filter_held, ==, 2);
+	g_assert_cmpuint(g_slist_length(test_objects), ==, 1);
+
+	/* Then the filter switches to making up its mind on the spot */
+	test_filter.filter_incoming_sync = test_filter_sync;
+	ofono_voicecall_filter_notify(vc);
+
+	g_assert_cmpuint(test_filter_held, ==, 2);
+	g_assert_cmpuint(test_released, ==, test->released);
+	g_assert_cmpuint(g_slist_length(test_objects), ==, 1 + test->objects);
+
+	ofono_voicecall_remove(vc);
+	g_assert(!test_objects);
+
+	ofono_voicecall_filter_unregister(&test_filter);
+	ofono_voicecall_driver_unregister(&test_driver);
+}
+
+#define TEST_(name) "/voicecall/" name
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	__ofono_log_init("test-voicecall", g_test_verbose() ? "*" : NULL,
+								FALSE, FALSE);
+
+	g_test_add_data_func(TEST_("filter_notify_accept"),
+			&test_filter_notify_accept, test_filter_notify);
+	g_test_add_data_func(TEST_("filter_notify_reject"),
+			&test_filter_notify_reject, test_filter_notify);
+
+	return g_test_run();
+}